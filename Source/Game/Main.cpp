@@ -18,8 +18,16 @@
 #include "Light/RotatingPointLight.h"
 #include "Model/Model.h"
 #include "Renderer/Skybox.h"
+#include "Scene/HeightMap.h"
 #include "Scene/Scene.h"
+#include "Scene/SceneLoadHandle.h"
+#include "Scene/SceneSnapshot.h"
+#include "Scene/TerrainGenerator.h"
 #include "Scene/Voxel.h"
+#include "Shader/HorizonVoxelVertexShader.h"
+#include "Shader/LightVoxelVertexShader.h"
+#include "Shader/PackedVoxelVertexShader.h"
+#include "Shader/SkinningVertexShader.h"
 #include "Shader/SkyMapVertexShader.h"
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -47,11 +55,31 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 
     std::unique_ptr<library::Game> game = std::make_unique<library::Game>(L"Game Graphics Programming Assignment 3: Cube Mapping");
 
-    std::ofstream sceneFile;
-    sceneFile.open("HeightMap.txt");
     constexpr const UINT MAP_WIDTH = 0;
     constexpr const UINT MAP_HEIGHT = 0;
     constexpr const UINT MAP_DEPTH = 0;
+    constexpr const BOOL USE_VOXEL_CHUNK_MESHES = FALSE;
+    constexpr const BOOL USE_VOXEL_STREAMING = FALSE;
+    constexpr const BOOL USE_PACKED_VOXEL_INSTANCES = FALSE;
+    constexpr const BOOL USE_VOXEL_RUNS = FALSE;
+    constexpr const BOOL USE_VOXEL_EDITING = FALSE;
+    constexpr const BOOL USE_VOXEL_BRICK_MAP = FALSE;
+    constexpr const BOOL USE_RUN_LENGTH_COLUMNS = FALSE;
+    constexpr const BOOL USE_ASYNC_SCENE_LOADING = FALSE;
+    constexpr const BOOL USE_TERRAIN_EXPORT = FALSE;
+    constexpr const BOOL USE_SCENE_SNAPSHOT = FALSE;
+    constexpr const BOOL USE_VOXEL_RAY_CASTING = FALSE;
+    constexpr const BOOL USE_HEIGHT_PYRAMID = FALSE;
+    constexpr const BOOL USE_CAMERA_COLLISION = FALSE;
+    constexpr const BOOL USE_HORIZON_LIGHTING = FALSE;
+    constexpr const BOOL USE_VOXEL_LIGHTING = FALSE;
+    constexpr const BOOL USE_SKINNED_MODEL = FALSE;
+    constexpr const BOOL USE_POSE_CACHE = FALSE;
+    constexpr const BOOL USE_BENCHMARKS = FALSE;
+    // The features measure themselves against their brute-force
+    // counterparts only when the benchmarks are enabled
+    constexpr const UINT NUM_BENCHMARK_QUERIES = USE_BENCHMARKS ? 1u << 16u : 0u;
+    constexpr const UINT NUM_BENCHMARK_UPDATES = USE_BENCHMARKS ? 1u << 10u : 0u;
     XMFLOAT4 aColors[] =
     {
         XMFLOAT4(0.0f,      0.666f, 0.0f,   1.0f),  // GRASSLAND
@@ -71,334 +99,421 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         XMFLOAT4(0.15f,     0.372f, 0.15f,  1.0f),  // TROPICAL_RAIN_FOREST
     };
 
-    sceneFile << MAP_WIDTH << " " << MAP_HEIGHT << " " << MAP_DEPTH << ' ' << ARRAYSIZE(aColors) << '\n';
+    if (USE_BENCHMARKS)
+    {
+        library::Scene::BenchmarkPerlin2dBatch(1u << 20u, library::TerrainGenerator::DEFAULT_NOISE_DEPTH);
+        library::Model::BenchmarkKeyLookup(1u << 16u);
+    }
 
-    for (UINT colorIdx = 0; colorIdx < ARRAYSIZE(aColors); ++colorIdx)
+    // The terrain is generated straight into the height map the scene
+    // builds its voxels from, writing it to disk is optional
+    library::TerrainDesc terrainDesc =
     {
-        sceneFile << aColors[colorIdx].x << ' ' <<
-            aColors[colorIdx].y << ' ' <<
-            aColors[colorIdx].z << '\n';
+        .uWidth = MAP_WIDTH,
+        .uHeight = MAP_HEIGHT,
+        .uDepth = MAP_DEPTH,
+        .uNumOctaves = library::TerrainGenerator::DEFAULT_NUM_OCTAVES,
+        .uNoiseDepth = library::TerrainGenerator::DEFAULT_NOISE_DEPTH,
+        .Frequency = library::TerrainGenerator::DEFAULT_FREQUENCY,
+        .MoistureOffset = library::TerrainGenerator::DEFAULT_MOISTURE_OFFSET,
+        .uTileSize = library::TerrainGenerator::DEFAULT_TILE_SIZE,
+        .uNumWorkers = 0u
+    };
+
+    // The snapshot of the built scene is keyed by everything the terrain
+    // output depends on, so changing the number of workers keeps it
+    // valid. A valid snapshot skips the generation, the instance build
+    // and the import of the static models
+    constexpr const BOOL USE_SNAPSHOT = USE_SCENE_SNAPSHOT && !USE_ASYNC_SCENE_LOADING && !USE_VOXEL_STREAMING;
+    UINT64 ullSnapshotHash = library::SceneSnapshot::HashTerrainDesc(terrainDesc);
+    ullSnapshotHash = library::SceneSnapshot::HashBytes(aColors, sizeof(aColors), ullSnapshotHash);
+    std::shared_ptr<library::SceneSnapshot> snapshot;
+    if (USE_SNAPSHOT)
+    {
+        snapshot = std::make_shared<library::SceneSnapshot>();
+        if (snapshot->Load(L"Scene.snapshot", ullSnapshotHash) != S_OK)
+        {
+            snapshot.reset();
+        }
     }
 
-    for (UINT z = 0u; z < MAP_DEPTH; ++z)
+    std::shared_ptr<library::HeightMap> heightMap = std::make_shared<library::HeightMap>();
+    if (!snapshot)
     {
-        for (UINT x = 0u; x < MAP_WIDTH; ++x)
+        library::TerrainGenerator terrainGenerator(terrainDesc);
+        if (FAILED(terrainGenerator.Generate(std::vector<XMFLOAT4>(std::begin(aColors), std::end(aColors)), *heightMap)))
+        {
+            return 0;
+        }
+        if (USE_TERRAIN_EXPORT && FAILED(heightMap->SaveBinary(L"HeightMap.hmap")))
         {
-            FLOAT height = 0.0f;
+            return 0;
+        }
+    }
 
-            FLOAT frequencySum = 0.0f;
-            for (UINT i = 0; i < 4; ++i)
-            {
-                FLOAT frequency = pow(2.0f, static_cast<FLOAT>(i));
-                frequencySum += 1.0f / frequency;
-                height += library::Scene::GetPerlin2d(frequency * static_cast<FLOAT>(x), frequency * static_cast<FLOAT>(z), 0.1f, 4u) / frequency;
-            }
-            height /= frequencySum;
-            height = pow(height * 1.2f, 1.25f);
+    library::VoxelStreamingDesc streamingDesc =
+    {
+        .uChunkSize = library::VoxelStreamer::DEFAULT_CHUNK_SIZE,
+        .uLoadRadius = library::VoxelStreamer::DEFAULT_LOAD_RADIUS,
+        .ullMemoryBudgetBytes = library::VoxelStreamer::DEFAULT_MEMORY_BUDGET_BYTES,
+        .uNumWorkers = 0u,
+        .bPackedInstances = USE_PACKED_VOXEL_INSTANCES,
+        .bCollapseRuns = USE_VOXEL_RUNS
+    };
+    // The horizons and the light of the faces are kept per instance
+    // matrix, which the packed and the streamed voxels do not have
+    constexpr const BOOL USE_HORIZON_VOXELS = USE_HORIZON_LIGHTING && !USE_PACKED_VOXEL_INSTANCES && !USE_VOXEL_STREAMING;
+    constexpr const BOOL USE_LIGHT_MAP_VOXELS = USE_VOXEL_LIGHTING && !USE_PACKED_VOXEL_INSTANCES && !USE_VOXEL_STREAMING;
 
-            assert(height >= 0.0f);
+    // Everything added to the scene before the renderer initializes it
+    // only touches memory, so an asynchronous load runs it on the
+    // loading thread
+    auto prepareScene = [](library::Scene& scene) -> HRESULT
+    {
+        if (USE_VOXEL_CHUNK_MESHES && FAILED(scene.BuildVoxelChunkMeshes(library::VoxelMesher::DEFAULT_CHUNK_SIZE)))
+        {
+            return E_FAIL;
+        }
+        if (USE_PACKED_VOXEL_INSTANCES && !USE_VOXEL_STREAMING && FAILED(scene.BuildPackedVoxels(USE_VOXEL_RUNS)))
+        {
+            return E_FAIL;
+        }
+        if (USE_VOXEL_RUNS && !USE_PACKED_VOXEL_INSTANCES && !USE_VOXEL_STREAMING && FAILED(scene.BuildVoxelRuns()))
+        {
+            return E_FAIL;
+        }
+        if (USE_VOXEL_EDITING && FAILED(scene.EnableVoxelEditing()))
+        {
+            return E_FAIL;
+        }
+        if (USE_VOXEL_BRICK_MAP && FAILED(scene.BuildVoxelBrickMap(NUM_BENCHMARK_QUERIES)))
+        {
+            return E_FAIL;
+        }
+        if (USE_RUN_LENGTH_COLUMNS && FAILED(scene.BuildRunLengthColumns(L"HeightMap.rle")))
+        {
+            return E_FAIL;
+        }
+        if (USE_VOXEL_RAY_CASTING && FAILED(scene.BuildVoxelRayCaster(NUM_BENCHMARK_QUERIES)))
+        {
+            return E_FAIL;
+        }
+        if (USE_HEIGHT_PYRAMID && FAILED(scene.BuildHeightPyramid(NUM_BENCHMARK_QUERIES)))
+        {
+            return E_FAIL;
+        }
+        if (USE_CAMERA_COLLISION && FAILED(scene.BuildVoxelCollider(NUM_BENCHMARK_QUERIES)))
+        {
+            return E_FAIL;
+        }
+        if (USE_HORIZON_VOXELS && FAILED(scene.BuildHorizonLighting(NUM_BENCHMARK_UPDATES)))
+        {
+            return E_FAIL;
+        }
+        if (USE_VOXEL_LIGHTING && FAILED(scene.BuildVoxelLighting(NUM_BENCHMARK_UPDATES)))
+        {
+            return E_FAIL;
+        }
 
-            FLOAT moisture = 0.0f;
+        // Phong
+        std::shared_ptr<library::VertexShader> phongVertexShader = std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSPhong", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"PhongShader", phongVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Voxel
+        std::shared_ptr<library::VertexShader> voxelVertexShader = std::make_shared<library::VertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxel", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"VoxelShader", voxelVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Packed Voxel
+        std::shared_ptr<library::VertexShader> packedVoxelVertexShader = std::make_shared<library::PackedVoxelVertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxelPacked", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"PackedVoxelShader", packedVoxelVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Horizon Voxel
+        std::shared_ptr<library::VertexShader> horizonVoxelVertexShader = std::make_shared<library::HorizonVoxelVertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxelHorizon", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"HorizonVoxelShader", horizonVoxelVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Light Map Voxel
+        std::shared_ptr<library::VertexShader> lightVoxelVertexShader = std::make_shared<library::LightVoxelVertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxelLight", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"LightVoxelShader", lightVoxelVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Voxel Chunk Mesh
+        std::shared_ptr<library::VertexShader> voxelMeshVertexShader = std::make_shared<library::VertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxelMesh", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"VoxelMeshShader", voxelMeshVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Light Cube
+        std::shared_ptr<library::VertexShader> lightVertexShader = std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSLightCube", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"LightShader", lightVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Cube Map
+        std::shared_ptr<library::SkyMapVertexShader> cubeMapVertexShader = std::make_shared<library::SkyMapVertexShader>(L"Shaders/CubeMap.fxh", "VSCubeMap", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"CubeMapShader", cubeMapVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Environment Map
+        std::shared_ptr<library::VertexShader> environmentMapVertexShader = std::make_shared<library::VertexShader>(L"Shaders/EnvironmentShaders.fxh", "VSEnvironmentMap", "vs_5_0");
+        if (FAILED(scene.AddVertexShader(L"EnvironmentMapShader", environmentMapVertexShader)))
+        {
+            return E_FAIL;
+        }
+        // Phong
+        std::shared_ptr<library::PixelShader> phongPixelShader = std::make_shared<library::PixelShader>(L"Shaders/PhongShaders.fxh", "PSPhong", "ps_5_0");
+        if (FAILED(scene.AddPixelShader(L"PhongShader", phongPixelShader)))
+        {
+            return E_FAIL;
+        }
+        // Voxel
+        std::shared_ptr<library::PixelShader> voxelPixelShader = std::make_shared<library::PixelShader>(L"Shaders/VoxelShaders.fxh", "PSVoxel", "ps_5_0");
+        if (FAILED(scene.AddPixelShader(L"VoxelShader", voxelPixelShader)))
+        {
+            return E_FAIL;
+        }
+        // Light Cube
+        std::shared_ptr<library::PixelShader> lightPixelShader = std::make_shared<library::PixelShader>(L"Shaders/PhongShaders.fxh", "PSLightCube", "ps_5_0");
+        if (FAILED(scene.AddPixelShader(L"LightShader", lightPixelShader)))
+        {
+            return E_FAIL;
+        }
+        // Cube Map
+        std::shared_ptr<library::PixelShader> cubeMapPixelShader = std::make_shared<library::PixelShader>(L"Shaders/CubeMap.fxh", "PSCubeMap", "ps_5_0");
+        if (FAILED(scene.AddPixelShader(L"CubeMapShader", cubeMapPixelShader)))
+        {
+            return E_FAIL;
+        }
+        // Environment Map
+        std::shared_ptr<library::PixelShader> environmentMapPixelShader = std::make_shared<library::PixelShader>(L"Shaders/EnvironmentShaders.fxh", "PSEnvironmentMap", "ps_5_0");
+        if (FAILED(scene.AddPixelShader(L"EnvironmentMapShader", environmentMapPixelShader)))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetVertexShaderOfVoxel(USE_PACKED_VOXEL_INSTANCES ? L"PackedVoxelShader" : (USE_LIGHT_MAP_VOXELS ? L"LightVoxelShader" : (USE_HORIZON_VOXELS ? L"HorizonVoxelShader" : L"VoxelShader")))))
+        {
+            return E_FAIL;
+        }
 
-            frequencySum = 0.0f;
-            for (UINT i = 0; i < 4; ++i)
-            {
-                FLOAT frequency = pow(2.0f, static_cast<FLOAT>(i));
-                frequencySum += 1.0f / frequency;
-                moisture += library::Scene::GetPerlin2d(frequency * static_cast<FLOAT>(x), frequency * static_cast<FLOAT>(z), 0.1f, 4u) / frequency;
-            }
-            moisture /= frequencySum;
-            moisture = pow(moisture * 1.2f, 1.25f);
+        if (FAILED(scene.SetPixelShaderOfVoxel(L"VoxelShader")))
+        {
+            return E_FAIL;
+        }
 
-            library::eBlockType blockType = library::eBlockType::GRASSLAND;
+        if (FAILED(scene.SetVertexShaderOfVoxelChunkMeshes(L"VoxelMeshShader")))
+        {
+            return E_FAIL;
+        }
 
-            if (height < 0.1f)
-            {
-                blockType = library::eBlockType::OCEAN;
-            }
-            else if (height < 0.12f)
-            {
-                blockType = library::eBlockType::SAND;
-            }
-            else if (height > 0.8f)
-            {
-                if (moisture < 0.1f)
-                {
-                    blockType = library::eBlockType::SCORCHED;
-                }
-                else if (moisture < 0.2f)
-                {
-                    blockType = library::eBlockType::BARE;
-                }
-                else if (moisture < 0.5f)
-                {
-                    blockType = library::eBlockType::TUNDRA;
-                }
-                else
-                {
-                    blockType = library::eBlockType::SNOW;
-                }
-            }
-            else if (height > 0.6f)
-            {
-                if (moisture < 0.33f)
-                {
-                    blockType = library::eBlockType::TEMPERATE_DESERT;
-                }
-                else if (moisture < 0.66f)
-                {
-                    blockType = library::eBlockType::SHRUBLAND;
-                }
-                else
-                {
-                    blockType = library::eBlockType::TAIGA;
-                }
-            }
-            else if (height > 0.3f)
-            {
-                if (moisture < 0.16f)
-                {
-                    blockType = library::eBlockType::TEMPERATE_DESERT;
-                }
-                else if (moisture < 0.5f)
-                {
-                    blockType = library::eBlockType::GRASSLAND;
-                }
-                else if (moisture < 0.83f)
-                {
-                    blockType = library::eBlockType::TEMPERATE_DECIDUOUS_FOREST;
-                }
-                else
-                {
-                    blockType = library::eBlockType::TEMPERATE_RAIN_FOREST;
-                }
-            }
-            else
-            {
+        if (FAILED(scene.SetPixelShaderOfVoxelChunkMeshes(L"VoxelShader")))
+        {
+            return E_FAIL;
+        }
 
-                if (moisture < 0.16f)
-                {
-                    blockType = library::eBlockType::SUBTROPICAL_DESERT;
-                }
-                else if (moisture < 0.33f)
-                {
-                    blockType = library::eBlockType::GRASSLAND;
-                }
-                else if (moisture < 0.66f)
-                {
-                    blockType = library::eBlockType::TROPICAL_SEASONAL_FOREST;
-                }
-                else
-                {
-                    blockType = library::eBlockType::TROPICAL_RAIN_FOREST;
-                }
-            }
+        std::shared_ptr<library::Skybox> skybox = std::make_shared<library::Skybox>(L"Content/Common/Maskonaive2_1024.dds", 800.0f);
+        skybox->SetVertexShader(cubeMapVertexShader);
+        skybox->SetPixelShader(cubeMapPixelShader);
+        if (FAILED(scene.AddSkyBox(skybox)))
+        {
+            return E_FAIL;
+        }
 
-            sceneFile << static_cast<CHAR>(blockType);
+        XMFLOAT4 color;
+        XMStoreFloat4(&color, Colors::Orange);
 
-            sceneFile << height << ' ';
+        std::shared_ptr<library::PointLight> directionalLight = std::make_shared<library::PointLight>(
+            XMFLOAT4(0.f, 30.f, 0.f, 1.0f),
+            color,
+            45.0f
+            );
+        if (FAILED(scene.AddPointLight(0, directionalLight)))
+        {
+            return E_FAIL;
         }
-        sceneFile << '\n';
-    }
-    sceneFile << std::endl;
-    sceneFile.close();
-
-    std::shared_ptr<library::Scene> mainScene = std::make_shared<library::Scene>(L"HeightMap.txt");
 
-    // Phong
-    std::shared_ptr<library::VertexShader> phongVertexShader = std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSPhong", "vs_5_0");
-    if (FAILED(mainScene->AddVertexShader(L"PhongShader", phongVertexShader)))
-    {
-        return 0;
-    }
-    // Voxel
-    std::shared_ptr<library::VertexShader> voxelVertexShader = std::make_shared<library::VertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxel", "vs_5_0");
-    if (FAILED(mainScene->AddVertexShader(L"VoxelShader", voxelVertexShader)))
-    {
-        return 0;
-    }
-    // Light Cube
-    std::shared_ptr<library::VertexShader> lightVertexShader = std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSLightCube", "vs_5_0");
-    if (FAILED(mainScene->AddVertexShader(L"LightShader", lightVertexShader)))
-    {
-        return 0;
-    }
-    // Cube Map
-    std::shared_ptr<library::SkyMapVertexShader> cubeMapVertexShader = std::make_shared<library::SkyMapVertexShader>(L"Shaders/CubeMap.fxh", "VSCubeMap", "vs_5_0");
-    if (FAILED(mainScene->AddVertexShader(L"CubeMapShader", cubeMapVertexShader)))
-    {
-        return 0;
-    }
-    // Environment Map
-    std::shared_ptr<library::VertexShader> environmentMapVertexShader = std::make_shared<library::VertexShader>(L"Shaders/EnvironmentShaders.fxh", "VSEnvironmentMap", "vs_5_0");
-    if (FAILED(mainScene->AddVertexShader(L"EnvironmentMapShader", environmentMapVertexShader)))
-    {
-        return 0;
-    }
-    // Phong
-    std::shared_ptr<library::PixelShader> phongPixelShader = std::make_shared<library::PixelShader>(L"Shaders/PhongShaders.fxh", "PSPhong", "ps_5_0");
-    if (FAILED(mainScene->AddPixelShader(L"PhongShader", phongPixelShader)))
-    {
-        return 0;
-    }
-    // Voxel
-    std::shared_ptr<library::PixelShader> voxelPixelShader = std::make_shared<library::PixelShader>(L"Shaders/VoxelShaders.fxh", "PSVoxel", "ps_5_0");
-    if (FAILED(mainScene->AddPixelShader(L"VoxelShader", voxelPixelShader)))
-    {
-        return 0;
-    }
-    // Light Cube
-    std::shared_ptr<library::PixelShader> lightPixelShader = std::make_shared<library::PixelShader>(L"Shaders/PhongShaders.fxh", "PSLightCube", "ps_5_0");
-    if (FAILED(mainScene->AddPixelShader(L"LightShader", lightPixelShader)))
-    {
-        return 0;
-    }
-    // Cube Map
-    std::shared_ptr<library::PixelShader> cubeMapPixelShader = std::make_shared<library::PixelShader>(L"Shaders/CubeMap.fxh", "PSCubeMap", "ps_5_0");
-    if (FAILED(mainScene->AddPixelShader(L"CubeMapShader", cubeMapPixelShader)))
-    {
-        return 0;
-    }
-    // Environment Map
-    std::shared_ptr<library::PixelShader> environmentMapPixelShader = std::make_shared<library::PixelShader>(L"Shaders/EnvironmentShaders.fxh", "PSEnvironmentMap", "ps_5_0");
-    if (FAILED(mainScene->AddPixelShader(L"EnvironmentMapShader", environmentMapPixelShader)))
-    {
-        return 0;
-    }
-    if (FAILED(mainScene->SetVertexShaderOfVoxel(L"VoxelShader")))
-    {
-        return 0;
-    }
+        std::shared_ptr<Cube> pointLight = std::make_shared<Cube>(color);
+        pointLight->Translate(XMVectorSet(0.0f, 30.0f, 0.0f, 0.0f));
+        if (FAILED(scene.AddRenderable(L"PointLight", pointLight)))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetVertexShaderOfRenderable(L"PointLight", L"LightShader")))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetPixelShaderOfRenderable(L"PointLight", L"LightShader")))
+        {
+            return E_FAIL;
+        }
 
-    if (FAILED(mainScene->SetPixelShaderOfVoxel(L"VoxelShader")))
-    {
-        return 0;
-    }
-    
-    std::shared_ptr<library::Skybox> skybox = std::make_shared<library::Skybox>(L"Content/Common/Maskonaive2_1024.dds", 800.0f);
-    skybox->SetVertexShader(cubeMapVertexShader);
-    skybox->SetPixelShader(cubeMapPixelShader);
-    if (FAILED(mainScene->AddSkyBox(skybox)))
-    {
-        return 0;
-    }
+        XMStoreFloat4(&color, Colors::White);
+        std::shared_ptr<RotatingPointLight> rotatingDirectionalLight = std::make_shared<RotatingPointLight>(
+            XMFLOAT4(0.0f, 300.0f, 0.0f, 1.0f),
+            color,
+            400.0f
+            );
+        if (FAILED(scene.AddPointLight(1, rotatingDirectionalLigh
+            t)))
+        {
+            return E_FAIL;
+        }
 
-    XMFLOAT4 color;
-    XMStoreFloat4(&color, Colors::Orange);
+        std::shared_ptr<RotatingCube> rotatingCube = std::make_shared<RotatingCube>(color);
+        if (FAILED(scene.AddRenderable(L"RotatingCube", rotatingCube)))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetVertexShaderOfRenderable(L"RotatingCube", L"LightShader")))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetPixelShaderOfRenderable(L"RotatingCube", L"LightShader")))
+        {
+            return E_FAIL;
+        }
 
-    std::shared_ptr<library::PointLight> directionalLight = std::make_shared<library::PointLight>(
-        XMFLOAT4(0.f, 30.f, 0.f, 1.0f),
-        color,
-        45.0f
-        );
-    if (FAILED(mainScene->AddPointLight(0, directionalLight)))
-    {
-        return 0;
-    }
+        /*
+        std::shared_ptr<Cube> floorCube = std::make_shared<Cube>(color);
+        floorCube->Translate(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+        floorCube->Scale(80.0f, 0.1f, 80.0f);
+        if (FAILED(scene.AddRenderable(L"FloorCube", floorCube)))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetVertexShaderOfRenderable(L"FloorCube", L"PhongShader")))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetPixelShaderOfRenderable(L"FloorCube", L"PhongShader")))
+        {
+            return E_FAIL;
+        }
 
-    std::shared_ptr<Cube> pointLight = std::make_shared<Cube>(color);
-    pointLight->Translate(XMVectorSet(0.0f, 30.0f, 0.0f, 0.0f));
-    if (FAILED(mainScene->AddRenderable(L"PointLight", pointLight)))
-    {
-        return 0;
-    }
-    if (FAILED(mainScene->SetVertexShaderOfRenderable(L"PointLight", L"LightShader")))
-    {
-        return 0;
-    }
-    if (FAILED(mainScene->SetPixelShaderOfRenderable(L"PointLight", L"LightShader")))
-    {
-        return 0;
-    }
+        std::shared_ptr<library::Material> floorMaterial = std::make_shared<library::Material>(L"FloorMat");
+        floorMaterial->pDiffuse = std::make_shared<library::Texture>("Content/plane.jpg");
+        if (FAILED(scene.AddMaterial(floorMaterial)))
+        {
+            return E_FAIL;
+        }
+        floorCube->AddMaterial(floorMaterial);
 
-    XMStoreFloat4(&color, Colors::White);
-    std::shared_ptr<RotatingPointLight> rotatingDirectionalLight = std::make_shared<RotatingPointLight>(
-        XMFLOAT4(0.0f, 300.0f, 0.0f, 1.0f),
-        color,
-        400.0f
-        );
-    if (FAILED(mainScene->AddPointLight(1, rotatingDirectionalLigh
-        t)))
-    {
-        return 0;
-    }
+        std::shared_ptr<library::Model> nanosuit = std::make_shared<library::Model>(L"Content/Nanosuit/nanosuit.obj");
 
-    if (FAILED(game->GetRenderer()->AddScene(L"VoxelMap", mainScene)))
-    {
-        return 0;
-    }
+        if (FAILED(scene.AddModel(L"Nanosuit", nanosuit)))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetVertexShaderOfModel(L"Nanosuit", L"PhongShader")))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetPixelShaderOfModel(L"Nanosuit", L"PhongShader")))
+        {
+            return E_FAIL;
+        }
+        */
 
-    if (FAILED(game->GetRenderer()->SetMainScene(L"VoxelMap")))
-    {
-        return 0;
-    }
+        std::shared_ptr<Cube> ENVCube = std::make_shared<Cube>(color);
+        ENVCube->Translate(XMVectorSet(0.0f, 3.0f, 0.0f, 1.0f));
+        if (FAILED(scene.AddRenderable(L"ENVCube", ENVCube)))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetVertexShaderOfRenderable(L"ENVCube", L"EnvironmentMapShader")))
+        {
+            return E_FAIL;
+        }
+        if (FAILED(scene.SetPixelShaderOfRenderable(L"ENVCube", L"EnvironmentMapShader")))
+        {
+            return E_FAIL;
+        }
 
-    std::shared_ptr<RotatingCube> rotatingCube = std::make_shared<RotatingCube>(color);
-    if (FAILED(mainScene->AddRenderable(L"RotatingCube", rotatingCube)))
-    {
-        return 0;
-    }
-    if (FAILED(mainScene->SetVertexShaderOfRenderable(L"RotatingCube", L"LightShader")))
-    {
-        return 0;
-    }
-    if (FAILED(mainScene->SetPixelShaderOfRenderable(L"RotatingCube", L"LightShader")))
-    {
-        return 0;
-    }
+        // The skeleton of the animated model is flattened at load and its
+        // per-frame pose measured against the hierarchy walk
+        if (USE_SKINNED_MODEL)
+        {
+            std::shared_ptr<library::VertexShader> skinningVertexShader = std::make_shared<library::SkinningVertexShader>(L"Shaders/SkinningShaders.fxh", "VSPhong", "vs_5_0");
+            if (FAILED(scene.AddVertexShader(L"SkinningShader", skinningVertexShader)))
+            {
+                return E_FAIL;
+            }
 
-    /*
-    std::shared_ptr<Cube> floorCube = std::make_shared<Cube>(color);
-    floorCube->Translate(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f));
-    floorCube->Scale(80.0f, 0.1f, 80.0f);
-    if (FAILED(mainScene->AddRenderable(L"FloorCube", floorCube)))
-    {
-        return 0;
-    }
-    if (FAILED(mainScene->SetVertexShaderOfRenderable(L"FloorCube", L"PhongShader")))
-    {
-        return 0;
-    }
-    if (FAILED(mainScene->SetPixelShaderOfRenderable(L"FloorCube", L"PhongShader")))
-    {
-        return 0;
-    }
+            std::shared_ptr<library::Model> bobLamp = std::make_shared<library::Model>(L"Content/BobLampClean/boblampclean.md5mesh");
+            bobLamp->SetAnimationBenchmark(NUM_BENCHMARK_UPDATES);
+            if (USE_POSE_CACHE)
+            {
+                library::PoseCacheDesc poseCacheDesc =
+                {
+                    .FramesPerSecond = 30.0f,
+                    .ullBudgetBytes = 1ull << 20u,
+                    .bInterpolate = TRUE
+                };
+                bobLamp->SetPoseCache(poseCacheDesc);
+            }
+            if (FAILED(scene.AddModel(L"BobLamp", bobLamp)))
+            {
+                return E_FAIL;
+            }
+            if (FAILED(scene.SetVertexShaderOfModel(L"BobLamp", L"SkinningShader")))
+            {
+                return E_FAIL;
+            }
+            if (FAILED(scene.SetPixelShaderOfModel(L"BobLamp", L"PhongShader")))
+            {
+                return E_FAIL;
+            }
+        }
 
-    std::shared_ptr<library::Material> floorMaterial = std::make_shared<library::Material>(L"FloorMat");
-    floorMaterial->pDiffuse = std::make_shared<library::Texture>("Content/plane.jpg");
-    if (FAILED(mainScene->AddMaterial(floorMaterial)))
-    {
-        return 0;
-    }
-    floorCube->AddMaterial(floorMaterial);
-    
-    std::shared_ptr<library::Model> nanosuit = std::make_shared<library::Model>(L"Content/Nanosuit/nanosuit.obj");
+        return S_OK;
+    };
 
-    if (FAILED(mainScene->AddModel(L"Nanosuit", nanosuit)))
+    if (USE_ASYNC_SCENE_LOADING)
     {
-        return 0;
-    }
-    if (FAILED(mainScene->SetVertexShaderOfModel(L"Nanosuit", L"PhongShader")))
-    {
-        return 0;
+        library::SceneLoadCallbacks callbacks =
+        {
+            .OnProgress = [](library::eSceneLoadStage stage, FLOAT progress)
+            {
+                WCHAR szProgress[64];
+                swprintf_s(szProgress, L"Loading the scene: stage %u, %.0f%%\n", static_cast<UINT>(stage), progress * 100.0f);
+                OutputDebugString(szProgress);
+            }
+        };
+        std::shared_ptr<library::SceneLoadHandle> loadHandle = library::SceneLoadHandle::Start(heightMap, USE_VOXEL_STREAMING ? &streamingDesc : nullptr, prepareScene, callbacks);
+        if (FAILED(game->GetRenderer()->AddSceneAsync(L"VoxelMap", loadHandle)))
+        {
+            return 0;
+        }
     }
-    if (FAILED(mainScene->SetPixelShaderOfModel(L"Nanosuit", L"PhongShader")))
+    else
     {
-        return 0;
-    }
-    */
+        std::shared_ptr<library::Scene> mainScene = snapshot
+            ? std::make_shared<library::Scene>(snapshot)
+            : std::make_shared<library::Scene>(heightMap, USE_VOXEL_STREAMING ? &streamingDesc : nullptr);
+        if (USE_SNAPSHOT)
+        {
+            mainScene->SetSnapshotCache(L"Scene.snapshot", ullSnapshotHash);
+        }
+        if (FAILED(mainScene->GetLoadStatus()) || FAILED(prepareScene(*mainScene)))
+        {
+            return 0;
+        }
 
-    std::shared_ptr<Cube> ENVCube = std::make_shared<Cube>(color);
-    ENVCube->Translate(XMVectorSet(0.0f, 3.0f, 0.0f, 1.0f));
-    if (FAILED(mainScene->AddRenderable(L"ENVCube", ENVCube)))
-    {
-        return 0;
-    }
-    if (FAILED(mainScene->SetVertexShaderOfRenderable(L"ENVCube", L"EnvironmentMapShader")))
-    {
-        return 0;
+        if (FAILED(game->GetRenderer()->AddScene(L"VoxelMap", mainScene)))
+        {
+            return 0;
+        }
     }
-    if (FAILED(mainScene->SetPixelShaderOfRenderable(L"ENVCube", L"EnvironmentMapShader")))
+
+    if (FAILED(game->GetRenderer()->SetMainScene(L"VoxelMap")))
     {
         return 0;
     }
@@ -10,7 +10,7 @@ namespace library
       Modifies: [m_yaw, m_pitch, m_moveLeftRight, m_moveBackForward,
                  m_moveUpDown, m_travelSpeed, m_rotationSpeed, 
                  m_padding, m_cameraForward, m_cameraRight, m_cameraUp, 
-                 m_eye, m_at, m_up, m_rotation, m_view].
+                 m_eye, m_at, m_up, m_rotation, m_view, m_collider].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Camera::Camera(_In_ const XMVECTOR& position)
         : m_cbChangeOnCameraMovement(nullptr),
@@ -29,7 +29,8 @@ namespace library
         m_at(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)),
         m_up(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)),
         m_rotation(XMMATRIX()),
-        m_view(XMMATRIX())
+        m_view(XMMATRIX()),
+        m_collider(nullptr)
     { }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -97,6 +98,24 @@ namespace library
         return m_cbChangeOnCameraMovement;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Camera::SetCollider
+
+      Summary:  Sets the collider the camera moves through. The camera
+                is a box of COLLISION_HALF_EXTENTS around the eye that
+                slides along the terrain instead of passing through it.
+                An empty collider lets the camera fly freely
+
+      Args:     const std::shared_ptr<VoxelCollider>& collider
+                  Collider of the terrain, may be empty
+
+      Modifies: [m_collider].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Camera::SetCollider(_In_ const std::shared_ptr<VoxelCollider>& collider)
+    {
+        m_collider = collider;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Camera::HandleInput
 
@@ -214,9 +233,25 @@ namespace library
         m_cameraForward = XMVector3TransformCoord(DEFAULT_FORWARD, RotateYTempMatrix);
 
         //new eye, at, up
-        m_eye += m_moveLeftRight * m_cameraRight;
-        m_eye += m_moveBackForward * m_cameraForward;
-        m_eye += m_moveUpDown * m_cameraUp;
+        XMVECTOR movement = m_moveLeftRight * m_cameraRight;
+        movement += m_moveBackForward * m_cameraForward;
+        movement += m_moveUpDown * m_cameraUp;
+
+        //slide along the terrain instead of passing through it
+        if (m_collider)
+        {
+            XMFLOAT3 eye;
+            XMFLOAT3 halfExtents;
+            XMFLOAT3 displacement;
+            XMStoreFloat3(&eye, m_eye);
+            XMStoreFloat3(&halfExtents, COLLISION_HALF_EXTENTS);
+            XMStoreFloat3(&displacement, movement);
+
+            VoxelCollision collision;
+            m_collider->MoveBox(eye, halfExtents, displacement, collision);
+            movement = XMVectorSet(collision.Position.x - eye.x, collision.Position.y - eye.y, collision.Position.z - eye.z, 0.0f);
+        }
+        m_eye += movement;
 
         m_at = m_eye + m_at;
 
@@ -14,6 +14,7 @@
 #include "Common.h"
 
 #include "Renderer/DataTypes.h"
+#include "Scene/VoxelCollider.h"
 
 namespace library
 {
@@ -33,6 +34,9 @@ namespace library
                   Getter for the view transform matrix
                 GetConstantBuffer
                   Get the constant buffer containing the view transform
+                SetCollider
+                  Set the collider that keeps the camera out of the
+                  terrain
                 HandleInput
                   Handles the keyboard / mouse input
                 Initialize
@@ -60,6 +64,7 @@ namespace library
         const XMVECTOR& GetUp() const;
         const XMMATRIX& GetView() const;
         ComPtr<ID3D11Buffer>& GetConstantBuffer();
+        void SetCollider(_In_ const std::shared_ptr<VoxelCollider>& collider);
 
         virtual void HandleInput(_In_ const DirectionsInput& directions, _In_ const MouseRelativeMovement& mouseRelativeMovement, _In_ FLOAT deltaTime);
         virtual HRESULT Initialize(_In_ ID3D11Device* device);
@@ -68,6 +73,7 @@ namespace library
         static constexpr const XMVECTORF32 DEFAULT_FORWARD = { 0.0f, 0.0f, 1.0f, 0.0f };
         static constexpr const XMVECTORF32 DEFAULT_RIGHT = { 1.0f, 0.0f, 0.0f, 0.0f };
         static constexpr const XMVECTORF32 DEFAULT_UP = { 0.0f, 1.0f, 0.0f, 0.0f };
+        static constexpr const XMVECTORF32 COLLISION_HALF_EXTENTS = { 0.4f, 0.4f, 0.4f, 0.0f };
 
         ComPtr<ID3D11Buffer> m_cbChangeOnCameraMovement;
 
@@ -93,5 +99,7 @@ namespace library
 
         XMMATRIX m_rotation;
         XMMATRIX m_view;
+
+        std::shared_ptr<VoxelCollider> m_collider;
     };
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "Game/Benchmark.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkRandom::BenchmarkRandom
+
+      Summary:  Constructor
+
+      Args:     UINT uSeed
+                  Seed of the sequence
+
+      Modifies: [m_uSeed].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BenchmarkRandom::BenchmarkRandom(_In_ UINT uSeed)
+        : m_uSeed(uSeed)
+    { }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkRandom::GetFloat
+
+      Summary:  Returns a number in [0, 1) from the 24 high bits of the
+                next state
+
+      Modifies: [m_uSeed].
+
+      Returns:  FLOAT
+                  Number in [0, 1)
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT BenchmarkRandom::GetFloat()
+    {
+        return static_cast<FLOAT>(next()) / static_cast<FLOAT>(1u << 24u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkRandom::GetUint
+
+      Summary:  Returns a number in [0, uRange), scaling the 24 high
+                bits of the next state rather than taking a modulo
+
+      Args:     UINT uRange
+                  Number of values
+
+      Modifies: [m_uSeed].
+
+      Returns:  UINT
+                  Number in [0, uRange)
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT BenchmarkRandom::GetUint(_In_ UINT uRange)
+    {
+        return static_cast<UINT>((static_cast<UINT64>(next()) * uRange) >> 24u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkRandom::next
+
+      Summary:  Advances the generator
+
+      Modifies: [m_uSeed].
+
+      Returns:  UINT
+                  24 high bits of the new state
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT BenchmarkRandom::next()
+    {
+        m_uSeed = m_uSeed * 1664525u + 1013904223u;
+        return m_uSeed >> 8u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkTimer::BenchmarkTimer
+
+      Summary:  Constructor. Starts measuring
+
+      Modifies: [m_frequency, m_startTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BenchmarkTimer::BenchmarkTimer()
+        : m_frequency()
+        , m_startTime()
+    {
+        QueryPerformanceFrequency(&m_frequency);
+        Start();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkTimer::Start
+
+      Summary:  Starts measuring from now
+
+      Modifies: [m_startTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BenchmarkTimer::Start()
+    {
+        QueryPerformanceCounter(&m_startTime);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkTimer::GetSeconds
+
+      Summary:  Returns the seconds since the start
+
+      Returns:  FLOAT
+                  Elapsed seconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT BenchmarkTimer::GetSeconds() const
+    {
+        LARGE_INTEGER endTime;
+        QueryPerformanceCounter(&endTime);
+        return static_cast<FLOAT>(endTime.QuadPart - m_startTime.QuadPart) / static_cast<FLOAT>(m_frequency.QuadPart);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkTimer::GetMilliseconds
+
+      Summary:  Returns the milliseconds since the start
+
+      Returns:  FLOAT
+                  Elapsed milliseconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT BenchmarkTimer::GetMilliseconds() const
+    {
+        return GetSeconds() * 1000.0f;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BenchmarkTimer::GetMegaPerSecond
+
+      Summary:  Returns the millions of operations per second of a
+                number of operations done since the start
+
+      Args:     UINT64 ullCount
+                  Number of operations
+
+      Returns:  FLOAT
+                  Millions of operations per second, 0 if no time was
+                  measured
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT BenchmarkTimer::GetMegaPerSecond(_In_ UINT64 ullCount) const
+    {
+        FLOAT seconds = GetSeconds();
+        return seconds > 0.0f ? static_cast<FLOAT>(ullCount) / seconds / 1.0e6f : 0.0f;
+    }
+}
\ No newline at end of file
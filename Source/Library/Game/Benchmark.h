@@ -0,0 +1,95 @@
+/*+===================================================================
+  File:      BENCHMARK.H
+
+  Summary:   Benchmark header file contains declarations of
+             BenchmarkRandom class that draws the inputs of the
+             benchmarks from a fixed seed, and BenchmarkTimer class
+             that measures them.
+
+  Classes: BenchmarkRandom, BenchmarkTimer
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    BenchmarkRandom
+
+      Summary:  Linear congruential generator. Every benchmark starts
+                from the same seed, so that the inputs of two runs are
+                the same and their measures comparable
+
+      Methods:  GetFloat
+                  Returns a number in [0, 1)
+                GetUint
+                  Returns a number in [0, uRange)
+                BenchmarkRandom
+                  Constructor.
+                ~BenchmarkRandom
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class BenchmarkRandom
+    {
+    public:
+        static constexpr const UINT DEFAULT_SEED = 0x9E3779B9u;
+
+        explicit BenchmarkRandom(_In_ UINT uSeed = DEFAULT_SEED);
+        BenchmarkRandom(const BenchmarkRandom& other) = delete;
+        BenchmarkRandom(BenchmarkRandom&& other) = delete;
+        BenchmarkRandom& operator=(const BenchmarkRandom& other) = delete;
+        BenchmarkRandom& operator=(BenchmarkRandom&& other) = delete;
+        ~BenchmarkRandom() = default;
+
+        FLOAT GetFloat();
+        UINT GetUint(_In_ UINT uRange);
+
+    private:
+        UINT next();
+
+    private:
+        UINT m_uSeed;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    BenchmarkTimer
+
+      Summary:  Measures the time since it was last started with the
+                performance counter
+
+      Methods:  Start
+                  Starts measuring
+                GetSeconds
+                  Returns the seconds since the start
+                GetMilliseconds
+                  Returns the milliseconds since the start
+                GetMegaPerSecond
+                  Returns millions of operations per second
+                BenchmarkTimer
+                  Constructor.
+                ~BenchmarkTimer
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class BenchmarkTimer
+    {
+    public:
+        BenchmarkTimer();
+        BenchmarkTimer(const BenchmarkTimer& other) = delete;
+        BenchmarkTimer(BenchmarkTimer&& other) = delete;
+        BenchmarkTimer& operator=(const BenchmarkTimer& other) = delete;
+        BenchmarkTimer& operator=(BenchmarkTimer&& other) = delete;
+        ~BenchmarkTimer() = default;
+
+        void Start();
+        FLOAT GetSeconds() const;
+        FLOAT GetMilliseconds() const;
+        FLOAT GetMegaPerSecond(_In_ UINT64 ullCount) const;
+
+    private:
+        LARGE_INTEGER m_frequency;
+        LARGE_INTEGER m_startTime;
+    };
+}
\ No newline at end of file
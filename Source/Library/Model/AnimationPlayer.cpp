@@ -0,0 +1,752 @@
+#include "Model/AnimationPlayer.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::AnimationPlayer
+
+      Summary:  Constructor. Nothing plays until Play or AddLayer
+
+      Args:     const std::vector<ModelAnimation>& aAnimations
+                  Clips of the model, kept by reference
+
+      Modifies: [m_aAnimations, m_aBindPoses, m_aLayers,
+                 m_aOverrideSamples, m_aAdditiveSamples, m_uNextLayerId].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AnimationPlayer::AnimationPlayer(_In_ const std::vector<ModelAnimation>& aAnimations)
+        : m_aAnimations(aAnimations)
+        , m_aBindPoses()
+        , m_aLayers()
+        , m_aOverrideSamples()
+        , m_aAdditiveSamples()
+        , m_uNextLayerId(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::SetBindPose
+
+      Summary:  Sets the local pose of the skeleton used where no
+                override layer plays, laid out like a key of the
+                streams of the clips
+
+      Args:     const std::vector<XMVECTOR>& aBindPoses
+                  Bind pose in blocks of four nodes
+
+      Modifies: [m_aBindPoses].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void AnimationPlayer::SetBindPose(_In_ const std::vector<XMVECTOR>& aBindPoses)
+    {
+        m_aBindPoses = aBindPoses;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::Play
+
+      Summary:  Cross-fades from the override layers playing to a clip:
+                they fade out and are removed while a new override
+                layer fades in over the same time
+
+      Args:     UINT uClip
+                  Index of the clip
+                FLOAT fadeSeconds
+                  Length of the cross-fade, 0 to cut
+                BOOL bLoop
+                  Whether the clip loops
+
+      Modifies: [m_aLayers, m_uNextLayerId].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if there is no such clip
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT AnimationPlayer::Play(_In_ UINT uClip, _In_ FLOAT fadeSeconds, _In_ BOOL bLoop)
+    {
+        if (uClip >= m_aAnimations.size())
+        {
+            return E_INVALIDARG;
+        }
+
+        for (AnimationLayer& layer : m_aLayers)
+        {
+            if (layer.BlendMode == eAnimationBlendMode::OVERRIDE)
+            {
+                layer.TargetWeight = 0.0f;
+                layer.FadeRate = fadeSeconds > 0.0f ? layer.Weight / fadeSeconds : 0.0f;
+                layer.bStopping = TRUE;
+                if (fadeSeconds <= 0.0f)
+                {
+                    layer.Weight = 0.0f;
+                }
+            }
+        }
+
+        std::erase_if(
+            m_aLayers,
+            [](const AnimationLayer& layer)
+            {
+                return layer.bStopping && layer.Weight <= 0.0f;
+            }
+        );
+
+        return AddLayer(uClip, eAnimationBlendMode::OVERRIDE, 1.0f, fadeSeconds, bLoop, nullptr);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::AddLayer
+
+      Summary:  Starts a layer playing a clip from its beginning, fading
+                its weight in from 0
+
+      Args:     UINT uClip
+                  Index of the clip
+                eAnimationBlendMode blendMode
+                  How the layer is blended
+                FLOAT weight
+                  Weight the layer fades to
+                FLOAT fadeSeconds
+                  Length of the fade, 0 to start at full weight
+                BOOL bLoop
+                  Whether the clip loops
+                UINT* puOutLayerId
+                  Identifier of the layer, may be nullptr
+
+      Modifies: [m_aLayers, m_uNextLayerId].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if there is no such clip
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT AnimationPlayer::AddLayer(_In_ UINT uClip, _In_ eAnimationBlendMode blendMode, _In_ FLOAT weight, _In_ FLOAT fadeSeconds, _In_ BOOL bLoop, _Out_opt_ UINT* puOutLayerId)
+    {
+        if (uClip >= m_aAnimations.size() || blendMode >= eAnimationBlendMode::COUNT)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_aLayers.push_back(
+            AnimationLayer{
+                .uId = m_uNextLayerId,
+                .uClip = uClip,
+                .BlendMode = blendMode,
+                .Time = 0.0f,
+                .Speed = 1.0f,
+                .Weight = fadeSeconds > 0.0f ? 0.0f : weight,
+                .TargetWeight = weight,
+                .FadeRate = fadeSeconds > 0.0f ? weight / fadeSeconds : 0.0f,
+                .bLoop = bLoop,
+                .bStopping = FALSE,
+                .uCursor = 0u,
+            }
+        );
+
+        if (puOutLayerId)
+        {
+            *puOutLayerId = m_uNextLayerId;
+        }
+        ++m_uNextLayerId;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::SetLayerWeight
+
+      Summary:  Fades the weight of a layer
+
+      Args:     UINT uLayerId
+                  Identifier of the layer
+                FLOAT weight
+                  Weight to fade to
+                FLOAT fadeSeconds
+                  Length of the fade, 0 to set the weight at once
+
+      Modifies: [m_aLayers].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if there is no such layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT AnimationPlayer::SetLayerWeight(_In_ UINT uLayerId, _In_ FLOAT weight, _In_ FLOAT fadeSeconds)
+    {
+        AnimationLayer* pLayer = findLayer(uLayerId);
+        if (!pLayer)
+        {
+            return E_INVALIDARG;
+        }
+
+        pLayer->TargetWeight = weight;
+        if (fadeSeconds > 0.0f)
+        {
+            pLayer->FadeRate = std::abs(weight - pLayer->Weight) / fadeSeconds;
+        }
+        else
+        {
+            pLayer->Weight = weight;
+            pLayer->FadeRate = 0.0f;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::SetLayerSpeed
+
+      Summary:  Sets the playback speed of a layer, negative to play
+                backwards
+
+      Args:     UINT uLayerId
+                  Identifier of the layer
+                FLOAT speed
+                  Seconds of the clip played per second
+
+      Modifies: [m_aLayers].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if there is no such layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT AnimationPlayer::SetLayerSpeed(_In_ UINT uLayerId, _In_ FLOAT speed)
+    {
+        AnimationLayer* pLayer = findLayer(uLayerId);
+        if (!pLayer)
+        {
+            return E_INVALIDARG;
+        }
+
+        pLayer->Speed = speed;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::StopLayer
+
+      Summary:  Fades a layer out and removes it once its weight is 0
+
+      Args:     UINT uLayerId
+                  Identifier of the layer
+                FLOAT fadeSeconds
+                  Length of the fade, 0 to remove it at once
+
+      Modifies: [m_aLayers].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if there is no such layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT AnimationPlayer::StopLayer(_In_ UINT uLayerId, _In_ FLOAT fadeSeconds)
+    {
+        HRESULT hr = SetLayerWeight(uLayerId, 0.0f, fadeSeconds);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        AnimationLayer* pLayer = findLayer(uLayerId);
+        pLayer->bStopping = TRUE;
+        if (pLayer->Weight <= 0.0f)
+        {
+            m_aLayers.erase(m_aLayers.begin() + (pLayer - m_aLayers.data()));
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::Update
+
+      Summary:  Advances the time of every layer, wrapping looping clips
+                and holding the others at their ends, moves the weights
+                toward their targets, and removes the layers stopped
+                that have faded out
+
+      Args:     FLOAT deltaTime
+                  Seconds since the last update
+
+      Modifies: [m_aLayers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void AnimationPlayer::Update(_In_ FLOAT deltaTime)
+    {
+        for (AnimationLayer& layer : m_aLayers)
+        {
+            const ModelAnimation& animation = m_aAnimations[layer.uClip];
+            const FLOAT length = animation.TicksPerSecond > 0.0f ? animation.Duration / animation.TicksPerSecond : 0.0f;
+
+            layer.Time += deltaTime * layer.Speed;
+            if (layer.bLoop && length > 0.0f)
+            {
+                layer.Time = std::fmod(layer.Time, length);
+                if (layer.Time < 0.0f)
+                {
+                    layer.Time += length;
+                }
+            }
+            else
+            {
+                layer.Time = std::clamp<FLOAT>(layer.Time, 0.0f, length);
+            }
+
+            if (layer.Weight < layer.TargetWeight)
+            {
+                layer.Weight = std::min<FLOAT>(layer.Weight + layer.FadeRate * deltaTime, layer.TargetWeight);
+            }
+            else
+            {
+                layer.Weight = std::max<FLOAT>(layer.Weight - layer.FadeRate * deltaTime, layer.TargetWeight);
+            }
+        }
+
+        std::erase_if(
+            m_aLayers,
+            [](const AnimationLayer& layer)
+            {
+                return layer.bStopping && layer.Weight <= 0.0f;
+            }
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::Evaluate
+
+      Summary:  Blends the local poses of the layers one block of four
+                nodes at a time. Each layer only finds its key once; its
+                keys are then lerped component by component straight
+                into the blend of the block, which stays in registers.
+                The override layers are averaged by their weights, with
+                each rotation flipped into the hemisphere of the blend
+                so far, and fall back to the bind pose when none plays.
+                Every additive layer then adds its translation from its
+                first key and scales by its scaling relative to it, and
+                turns the rotation by its rotation from the first key,
+                taken toward the identity by its weight. A scaling whose
+                first key is within MIN_REFERENCE_SCALE of zero has no
+                ratio and is left out. The bind pose has to hold unit
+                rotations for the blend to stay unit
+
+      Args:     std::vector<XMVECTOR>& aOutPoses
+                  Local poses in blocks of four nodes, resized to the
+                  bind pose
+
+      Modifies: [m_aLayers, m_aOverrideSamples, m_aAdditiveSamples].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void AnimationPlayer::Evaluate(_Inout_ std::vector<XMVECTOR>& aOutPoses)
+    {
+        constexpr const UINT P = ModelAnimationStream::POSITION;
+        constexpr const UINT R = ModelAnimationStream::ROTATION;
+        constexpr const UINT S = ModelAnimationStream::SCALING;
+        constexpr const UINT NUM_COMPONENTS = ModelAnimationStream::NUM_COMPONENTS;
+
+        const size_t uNumVectors = m_aBindPoses.size();
+        const UINT uNumBlocks = static_cast<UINT>(uNumVectors / NUM_COMPONENTS);
+        aOutPoses.resize(uNumVectors);
+
+        m_aOverrideSamples.clear();
+        m_aAdditiveSamples.clear();
+        FLOAT totalWeight = 0.0f;
+        for (AnimationLayer& layer : m_aLayers)
+        {
+            const ModelAnimation& animation = m_aAnimations[layer.uClip];
+            const ModelAnimationStream& stream = animation.Stream;
+            if (layer.Weight <= 0.0f || stream.aTimes.empty() || stream.uNumBlocks != uNumBlocks)
+            {
+                continue;
+            }
+
+            FLOAT factor = 0.0f;
+            const UINT uKey = findStreamKey(stream, layer.Time * animation.TicksPerSecond, layer.uCursor, factor);
+            const XMVECTOR* pStart = stream.aKeys.data() + uKey * uNumVectors;
+            const LayerSample sample =
+            {
+                .pStart = pStart,
+                .pEnd = stream.aTimes.size() > 1u ? pStart + uNumVectors : pStart,
+                .pReference = stream.aKeys.data(),
+                .Factor = XMVectorReplicate(factor),
+                .Weight = XMVectorReplicate(layer.Weight),
+            };
+
+            if (layer.BlendMode == eAnimationBlendMode::OVERRIDE)
+            {
+                m_aOverrideSamples.push_back(sample);
+                totalWeight += layer.Weight;
+            }
+            else
+            {
+                m_aAdditiveSamples.push_back(sample);
+            }
+        }
+
+        const BOOL bOverride = totalWeight > 0.0f;
+        const XMVECTOR invTotalWeight = XMVectorReplicate(bOverride ? 1.0f / totalWeight : 0.0f);
+        const XMVECTOR one = XMVectorSplatOne();
+        const XMVECTOR minReferenceScale = XMVectorReplicate(MIN_REFERENCE_SCALE);
+        for (UINT b = 0u; b < uNumBlocks; ++b)
+        {
+            const size_t uOffset = static_cast<size_t>(b) * NUM_COMPONENTS;
+            XMVECTOR aBlend[NUM_COMPONENTS];
+            XMVECTOR aValue[NUM_COMPONENTS];
+
+            if (bOverride)
+            {
+                for (UINT i = 0u; i < NUM_COMPONENTS; ++i)
+                {
+                    aBlend[i] = XMVectorZero();
+                }
+
+                for (const LayerSample& sample : m_aOverrideSamples)
+                {
+                    for (UINT i = 0u; i < NUM_COMPONENTS; ++i)
+                    {
+                        aValue[i] = XMVectorLerpV(sample.pStart[uOffset + i], sample.pEnd[uOffset + i], sample.Factor);
+                    }
+
+                    XMVECTOR dot = XMVectorMultiply(aBlend[R], aValue[R]);
+                    dot = XMVectorMultiplyAdd(aBlend[R + 1u], aValue[R + 1u], dot);
+                    dot = XMVectorMultiplyAdd(aBlend[R + 2u], aValue[R + 2u], dot);
+                    dot = XMVectorMultiplyAdd(aBlend[R + 3u], aValue[R + 3u], dot);
+                    const XMVECTOR flip = XMVectorLess(dot, XMVectorZero());
+                    for (UINT i = R; i < R + 4u; ++i)
+                    {
+                        aValue[i] = XMVectorSelect(aValue[i], XMVectorNegate(aValue[i]), flip);
+                    }
+
+                    for (UINT i = 0u; i < NUM_COMPONENTS; ++i)
+                    {
+                        aBlend[i] = XMVectorMultiplyAdd(aValue[i], sample.Weight, aBlend[i]);
+                    }
+                }
+
+                for (UINT i = 0u; i < 3u; ++i)
+                {
+                    aBlend[P + i] = XMVectorMultiply(aBlend[P + i], invTotalWeight);
+                    aBlend[S + i] = XMVectorMultiply(aBlend[S + i], invTotalWeight);
+                }
+                normalizeQuaternions(aBlend + R);
+            }
+            else
+            {
+                for (UINT i = 0u; i < NUM_COMPONENTS; ++i)
+                {
+                    aBlend[i] = m_aBindPoses[uOffset + i];
+                }
+            }
+
+            for (const LayerSample& sample : m_aAdditiveSamples)
+            {
+                const XMVECTOR* pReference = sample.pReference + uOffset;
+                for (UINT i = 0u; i < NUM_COMPONENTS; ++i)
+                {
+                    aValue[i] = XMVectorLerpV(sample.pStart[uOffset + i], sample.pEnd[uOffset + i], sample.Factor);
+                }
+
+                for (UINT i = 0u; i < 3u; ++i)
+                {
+                    aBlend[P + i] = XMVectorMultiplyAdd(XMVectorSubtract(aValue[P + i], pReference[P + i]), sample.Weight, aBlend[P + i]);
+                    const XMVECTOR bScaled = XMVectorGreater(XMVectorAbs(pReference[S + i]), minReferenceScale);
+                    const XMVECTOR ratio = XMVectorDivide(aValue[S + i], XMVectorSelect(one, pReference[S + i], bScaled));
+                    const XMVECTOR scale = XMVectorMultiplyAdd(XMVectorSubtract(ratio, one), sample.Weight, one);
+                    aBlend[S + i] = XMVectorMultiply(aBlend[S + i], XMVectorSelect(one, scale, bScaled));
+                }
+
+                // Rotation from the first key, taken the short way and
+                // weighted by a normalized lerp from the identity. Only
+                // this one is normalized: turning the unit rotation of
+                // the blend by it keeps it unit
+                const XMVECTOR aConjugate[4] =
+                {
+                    XMVectorNegate(pReference[R]),
+                    XMVectorNegate(pReference[R + 1u]),
+                    XMVectorNegate(pReference[R + 2u]),
+                    pReference[R + 3u],
+                };
+                XMVECTOR aDelta[4];
+                multiplyQuaternions(aValue + R, aConjugate, aDelta);
+
+                const XMVECTOR flip = XMVectorLess(aDelta[3], XMVectorZero());
+                for (UINT i = 0u; i < 4u; ++i)
+                {
+                    aDelta[i] = XMVectorMultiply(XMVectorSelect(aDelta[i], XMVectorNegate(aDelta[i]), flip), sample.Weight);
+                }
+                aDelta[3] = XMVectorAdd(aDelta[3], XMVectorSubtract(one, sample.Weight));
+                normalizeQuaternions(aDelta);
+
+                XMVECTOR aRotation[4];
+                multiplyQuaternions(aDelta, aBlend + R, aRotation);
+                for (UINT i = 0u; i < 4u; ++i)
+                {
+                    aBlend[R + i] = aRotation[i];
+                }
+            }
+
+            for (UINT i = 0u; i < NUM_COMPONENTS; ++i)
+            {
+                aOutPoses[uOffset + i] = aBlend[i];
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::GetLayers
+
+      Summary:  Returns the layers playing
+
+      Returns:  const std::vector<AnimationLayer>&
+                  Layers in the order they were added
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<AnimationLayer>& AnimationPlayer::GetLayers() const
+    {
+        return m_aLayers;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::SampleStream
+
+      Summary:  Interpolates the local pose of every node from the
+                stream of one clip, four nodes per instruction: one key
+                lookup for the whole clip, then a lerp of every
+                component and a normalization of the rotations over
+                blocks of four lanes
+
+      Args:     const ModelAnimationStream& stream
+                  Stream of the clip
+                FLOAT animationTimeTicks
+                  Animation time
+                UINT& uCursor
+                  Key found for the previous frame, updated
+                XMVECTOR* pOutPoses
+                  Local poses in blocks of four nodes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void AnimationPlayer::SampleStream(_In_ const ModelAnimationStream& stream, _In_ FLOAT animationTimeTicks, _Inout_ UINT& uCursor, _Out_writes_(stream.uNumBlocks * ModelAnimationStream::NUM_COMPONENTS) XMVECTOR* pOutPoses)
+    {
+        constexpr const UINT NUM_COMPONENTS = ModelAnimationStream::NUM_COMPONENTS;
+
+        if (stream.aTimes.empty())
+        {
+            return;
+        }
+
+        FLOAT factor = 0.0f;
+        const UINT uKey = findStreamKey(stream, animationTimeTicks, uCursor, factor);
+        const size_t uStride = static_cast<size_t>(stream.uNumBlocks) * NUM_COMPONENTS;
+        const XMVECTOR* pStart = stream.aKeys.data() + uKey * uStride;
+        const XMVECTOR* pEnd = stream.aTimes.size() > 1u ? pStart + uStride : pStart;
+        XMVECTOR* pOut = pOutPoses;
+        const XMVECTOR lerpFactor = XMVectorReplicate(factor);
+        for (UINT b = 0u; b < stream.uNumBlocks; ++b, pStart += NUM_COMPONENTS, pEnd += NUM_COMPONENTS, pOut += NUM_COMPONENTS)
+        {
+            for (UINT uComponent = 0u; uComponent < NUM_COMPONENTS; ++uComponent)
+            {
+                pOut[uComponent] = XMVectorLerpV(pStart[uComponent], pEnd[uComponent], lerpFactor);
+            }
+            normalizeQuaternions(pOut + ModelAnimationStream::ROTATION);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::Benchmark
+
+      Summary:  Measures blending layers against sampling one clip.
+                Half the layers override and half are additive, all
+                playing the clips in turn from staggered times so their
+                keys differ, and the player is updated every frame at
+                60 frames per second
+
+      Args:     const std::vector<ModelAnimation>& aAnimations
+                  Clips of the model
+                const std::vector<XMVECTOR>& aBindPoses
+                  Bind pose in blocks of four nodes
+                UINT uNumLayers
+                  Number of layers blended
+                UINT uNumFrames
+                  Number of poses measured
+
+      Returns:  AnimationBlendStats
+                  Cost of sampling and of blending per pose
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AnimationBlendStats AnimationPlayer::Benchmark(
+        _In_ const std::vector<ModelAnimation>& aAnimations,
+        _In_ const std::vector<XMVECTOR>& aBindPoses,
+        _In_ UINT uNumLayers,
+        _In_ UINT uNumFrames
+    )
+    {
+        constexpr const FLOAT FRAME_SECONDS = 1.0f / 60.0f;
+
+        AnimationBlendStats stats =
+        {
+            .uNumLayers = uNumLayers,
+            .uNumFrames = uNumFrames,
+            .SampleMicrosecondsPerPose = 0.0f,
+            .BlendMicrosecondsPerPose = 0.0f,
+        };
+        if (aAnimations.empty() || uNumFrames == 0u)
+        {
+            return stats;
+        }
+
+        AnimationPlayer player(aAnimations);
+        player.SetBindPose(aBindPoses);
+        for (UINT l = 0u; l < uNumLayers; ++l)
+        {
+            const UINT uClip = l % static_cast<UINT>(aAnimations.size());
+            const ModelAnimation& animation = aAnimations[uClip];
+            const eAnimationBlendMode blendMode = l % 2u == 0u ? eAnimationBlendMode::OVERRIDE : eAnimationBlendMode::ADDITIVE;
+            player.AddLayer(uClip, blendMode, 1.0f / static_cast<FLOAT>(l + 1u), 0.0f, TRUE, nullptr);
+            if (animation.TicksPerSecond > 0.0f)
+            {
+                player.m_aLayers.back().Time = animation.Duration / animation.TicksPerSecond * static_cast<FLOAT>(l) / static_cast<FLOAT>(uNumLayers);
+            }
+        }
+
+        BenchmarkTimer timer;
+        const ModelAnimation& animation = aAnimations[0];
+        std::vector<XMVECTOR> aPoses(std::max<size_t>(aBindPoses.size(), static_cast<size_t>(animation.Stream.uNumBlocks) * ModelAnimationStream::NUM_COMPONENTS));
+        UINT uCursor = 0u;
+        timer.Start();
+        for (UINT i = 0u; i < uNumFrames; ++i)
+        {
+            const FLOAT timeTicks = std::fmod(static_cast<FLOAT>(i) * FRAME_SECONDS * animation.TicksPerSecond, std::max<FLOAT>(animation.Duration, 1.0f));
+            SampleStream(animation.Stream, timeTicks, uCursor, aPoses.data());
+        }
+        stats.SampleMicrosecondsPerPose = timer.GetSeconds() * 1.0e6f / static_cast<FLOAT>(uNumFrames);
+
+        timer.Start();
+        for (UINT i = 0u; i < uNumFrames; ++i)
+        {
+            player.Update(FRAME_SECONDS);
+            player.Evaluate(aPoses);
+        }
+        stats.BlendMicrosecondsPerPose = timer.GetSeconds() * 1.0e6f / static_cast<FLOAT>(uNumFrames);
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"AnimationPlayer: %u layers, sample %.2f us per pose, blend %.2f us per pose (%.2fx)\n",
+            stats.uNumLayers,
+            stats.SampleMicrosecondsPerPose,
+            stats.BlendMicrosecondsPerPose,
+            stats.SampleMicrosecondsPerPose > 0.0f ? stats.BlendMicrosecondsPerPose / stats.SampleMicrosecondsPerPose : 0.0f
+        );
+        OutputDebugString(szReport);
+
+        return stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::findLayer
+
+      Summary:  Returns a layer by its identifier
+
+      Args:     UINT uLayerId
+                  Identifier of the layer
+
+      Returns:  AnimationLayer*
+                  Layer, nullptr if it was removed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AnimationLayer* AnimationPlayer::findLayer(_In_ UINT uLayerId)
+    {
+        for (AnimationLayer& layer : m_aLayers)
+        {
+            if (layer.uId == uLayerId)
+            {
+                return &layer;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::findStreamKey
+
+      Summary:  Returns the time of a stream right before a time and how
+                far the time is toward the next one. Past the last time
+                the last two are used at the end
+
+      Args:     const ModelAnimationStream& stream
+                  Stream of a clip
+                FLOAT animationTimeTicks
+                  Animation time
+                UINT& uCursor
+                  Key found for the previous frame, updated
+                FLOAT& outFactor
+                  Interpolation factor from 0 to 1
+
+      Returns:  UINT
+                  Index of the time
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT AnimationPlayer::findStreamKey(_In_ const ModelAnimationStream& stream, _In_ FLOAT animationTimeTicks, _Inout_ UINT& uCursor, _Out_ FLOAT& outFactor)
+    {
+        const UINT uNumTimes = static_cast<UINT>(stream.aTimes.size());
+        outFactor = 0.0f;
+        if (uNumTimes < 2u)
+        {
+            return 0u;
+        }
+
+        if (animationTimeTicks >= stream.aTimes.back())
+        {
+            outFactor = 1.0f;
+            return uNumTimes - 2u;
+        }
+
+        const UINT uKey = FindKey(animationTimeTicks, stream.aTimes, uCursor);
+        outFactor = std::clamp<FLOAT>((animationTimeTicks - stream.aTimes[uKey]) / (stream.aTimes[uKey + 1u] - stream.aTimes[uKey]), 0.0f, 1.0f);
+
+        return uKey;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::multiplyQuaternions
+
+      Summary:  Multiplies four pairs of quaternions stored as vectors
+                of their x, y, z and w components. The rotation of B is
+                applied first, as in A B
+
+      Args:     const XMVECTOR* pA
+                  Left quaternions
+                const XMVECTOR* pB
+                  Right quaternions
+                XMVECTOR* pOut
+                  Products, must not alias the arguments
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void AnimationPlayer::multiplyQuaternions(_In_reads_(4) const XMVECTOR* pA, _In_reads_(4) const XMVECTOR* pB, _Out_writes_(4) XMVECTOR* pOut)
+    {
+        pOut[0] = XMVectorMultiply(pA[3], pB[0]);
+        pOut[0] = XMVectorMultiplyAdd(pA[0], pB[3], pOut[0]);
+        pOut[0] = XMVectorMultiplyAdd(pA[1], pB[2], pOut[0]);
+        pOut[0] = XMVectorSubtract(pOut[0], XMVectorMultiply(pA[2], pB[1]));
+
+        pOut[1] = XMVectorMultiply(pA[3], pB[1]);
+        pOut[1] = XMVectorMultiplyAdd(pA[1], pB[3], pOut[1]);
+        pOut[1] = XMVectorMultiplyAdd(pA[2], pB[0], pOut[1]);
+        pOut[1] = XMVectorSubtract(pOut[1], XMVectorMultiply(pA[0], pB[2]));
+
+        pOut[2] = XMVectorMultiply(pA[3], pB[2]);
+        pOut[2] = XMVectorMultiplyAdd(pA[2], pB[3], pOut[2]);
+        pOut[2] = XMVectorMultiplyAdd(pA[0], pB[1], pOut[2]);
+        pOut[2] = XMVectorSubtract(pOut[2], XMVectorMultiply(pA[1], pB[0]));
+
+        pOut[3] = XMVectorMultiply(pA[3], pB[3]);
+        pOut[3] = XMVectorSubtract(pOut[3], XMVectorMultiply(pA[0], pB[0]));
+        pOut[3] = XMVectorSubtract(pOut[3], XMVectorMultiply(pA[1], pB[1]));
+        pOut[3] = XMVectorSubtract(pOut[3], XMVectorMultiply(pA[2], pB[2]));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   AnimationPlayer::normalizeQuaternions
+
+      Summary:  Normalizes four quaternions stored as vectors of their
+                x, y, z and w components
+
+      Args:     XMVECTOR* pQuaternions
+                  Quaternions, normalized in place
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void AnimationPlayer::normalizeQuaternions(_Inout_updates_(4) XMVECTOR* pQuaternions)
+    {
+        XMVECTOR lengthSq = XMVectorMultiply(pQuaternions[0], pQuaternions[0]);
+        lengthSq = XMVectorMultiplyAdd(pQuaternions[1], pQuaternions[1], lengthSq);
+        lengthSq = XMVectorMultiplyAdd(pQuaternions[2], pQuaternions[2], lengthSq);
+        lengthSq = XMVectorMultiplyAdd(pQuaternions[3], pQuaternions[3], lengthSq);
+        const XMVECTOR invLength = XMVectorReciprocalSqrt(lengthSq);
+        for (UINT i = 0u; i < 4u; ++i)
+        {
+            pQuaternions[i] = XMVectorMultiply(pQuaternions[i], invLength);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+/*+===================================================================
+  File:      ANIMATIONPLAYER.H
+
+  Summary:   AnimationPlayer header file contains declarations of
+             AnimationPlayer class that plays layers of the animations
+             of a model and blends their local poses.
+
+  Classes: AnimationPlayer
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Game/Benchmark.h"
+#include "Model/ModelAnimation.h"
+
+namespace library
+{
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+        Enum:     eAnimationBlendMode
+
+        Summary:  How a layer is blended. Override layers are averaged
+                  by their weights, additive layers then add how far
+                  their clip moved from its first key, scaled by their
+                  weight
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eAnimationBlendMode : UINT
+    {
+        OVERRIDE = 0u,
+        ADDITIVE,
+        COUNT,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   AnimationLayer
+
+        Summary:  Clip played by a layer, how it is blended, its time in
+                  seconds and playback speed, its weight and the weight
+                  it fades to at FadeRate per second, whether it loops,
+                  whether it is removed once faded out, and the key
+                  found for the previous frame
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct AnimationLayer
+    {
+        UINT uId;
+        UINT uClip;
+        eAnimationBlendMode BlendMode;
+        FLOAT Time;
+        FLOAT Speed;
+        FLOAT Weight;
+        FLOAT TargetWeight;
+        FLOAT FadeRate;
+        BOOL bLoop;
+        BOOL bStopping;
+        UINT uCursor;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   AnimationBlendStats
+
+        Summary:  Cost of sampling one clip against blending layers of
+                  clips into a pose, in microseconds per pose
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct AnimationBlendStats
+    {
+        UINT uNumLayers;
+        UINT uNumFrames;
+        FLOAT SampleMicrosecondsPerPose;
+        FLOAT BlendMicrosecondsPerPose;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    AnimationPlayer
+
+      Summary:  Plays the animations of a model in layers and blends
+                their local poses, structure of arrays four nodes at a
+                time. Every layer is sampled straight into the blend,
+                so no pose of a layer is ever stored: blending a layer
+                costs about as much as sampling its clip. Override
+                layers cross-fade by fading their weights, and the
+                rotations they give are added in one hemisphere and
+                normalized. Additive layers are applied on top. Works on
+                the CPU only, so it runs without a device
+
+      Methods:  SetBindPose
+                  Sets the pose used where no override layer plays
+                Play
+                  Cross-fades from the override layers to a clip
+                AddLayer
+                  Starts a layer playing a clip
+                SetLayerWeight
+                  Fades the weight of a layer
+                SetLayerSpeed
+                  Sets the playback speed of a layer
+                StopLayer
+                  Fades a layer out and removes it
+                Update
+                  Advances the time and the weights of the layers
+                Evaluate
+                  Blends the local poses of the layers
+                GetLayers
+                  Returns the layers playing
+                SampleStream
+                  Samples the local poses of one clip
+                Benchmark
+                  Measures blending layers against sampling one clip
+                findLayer
+                  Returns a layer by its identifier
+                findStreamKey
+                  Returns the key of a stream before a time
+                multiplyQuaternions
+                  Multiplies four pairs of quaternions
+                normalizeQuaternions
+                  Normalizes four quaternions
+                AnimationPlayer
+                  Constructor.
+                ~AnimationPlayer
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class AnimationPlayer
+    {
+    public:
+        static constexpr const FLOAT MIN_REFERENCE_SCALE = 1.0e-6f;
+
+        AnimationPlayer(_In_ const std::vector<ModelAnimation>& aAnimations);
+        AnimationPlayer(const AnimationPlayer& other) = delete;
+        AnimationPlayer(AnimationPlayer&& other) = delete;
+        AnimationPlayer& operator=(const AnimationPlayer& other) = delete;
+        AnimationPlayer& operator=(AnimationPlayer&& other) = delete;
+        ~AnimationPlayer() = default;
+
+        void SetBindPose(_In_ const std::vector<XMVECTOR>& aBindPoses);
+        HRESULT Play(_In_ UINT uClip, _In_ FLOAT fadeSeconds, _In_ BOOL bLoop);
+        HRESULT AddLayer(_In_ UINT uClip, _In_ eAnimationBlendMode blendMode, _In_ FLOAT weight, _In_ FLOAT fadeSeconds, _In_ BOOL bLoop, _Out_opt_ UINT* puOutLayerId);
+        HRESULT SetLayerWeight(_In_ UINT uLayerId, _In_ FLOAT weight, _In_ FLOAT fadeSeconds);
+        HRESULT SetLayerSpeed(_In_ UINT uLayerId, _In_ FLOAT speed);
+        HRESULT StopLayer(_In_ UINT uLayerId, _In_ FLOAT fadeSeconds);
+        void Update(_In_ FLOAT deltaTime);
+        void Evaluate(_Inout_ std::vector<XMVECTOR>& aOutPoses);
+
+        const std::vector<AnimationLayer>& GetLayers() const;
+
+        static void SampleStream(_In_ const ModelAnimationStream& stream, _In_ FLOAT animationTimeTicks, _Inout_ UINT& uCursor, _Out_writes_(stream.uNumBlocks * ModelAnimationStream::NUM_COMPONENTS) XMVECTOR* pOutPoses);
+        static AnimationBlendStats Benchmark(
+            _In_ const std::vector<ModelAnimation>& aAnimations,
+            _In_ const std::vector<XMVECTOR>& aBindPoses,
+            _In_ UINT uNumLayers,
+            _In_ UINT uNumFrames
+        );
+
+    private:
+        struct LayerSample
+        {
+            const XMVECTOR* pStart;
+            const XMVECTOR* pEnd;
+            const XMVECTOR* pReference;
+            XMVECTOR Factor;
+            XMVECTOR Weight;
+        };
+
+        AnimationLayer* findLayer(_In_ UINT uLayerId);
+
+        static UINT findStreamKey(_In_ const ModelAnimationStream& stream, _In_ FLOAT animationTimeTicks, _Inout_ UINT& uCursor, _Out_ FLOAT& outFactor);
+        static void multiplyQuaternions(_In_reads_(4) const XMVECTOR* pA, _In_reads_(4) const XMVECTOR* pB, _Out_writes_(4) XMVECTOR* pOut);
+        static void normalizeQuaternions(_Inout_updates_(4) XMVECTOR* pQuaternions);
+
+    private:
+        const std::vector<ModelAnimation>& m_aAnimations;
+        std::vector<XMVECTOR> m_aBindPoses;
+        std::vector<AnimationLayer> m_aLayers;
+        std::vector<LayerSample> m_aOverrideSamples;
+        std::vector<LayerSample> m_aAdditiveSamples;
+        UINT m_uNextLayerId;
+    };
+}
\ No newline at end of file
@@ -57,7 +57,24 @@ namespace library
     }
 
 
-    std::unique_ptr<Assimp::Importer> Model::sm_pImporter = std::make_unique<Assimp::Importer>();
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GetRotationAngle
+      Summary:  Returns the angle of the rotation between two unit
+                quaternions, from the length of their difference so
+                that small angles keep their precision
+      Returns:  FLOAT
+                  Angle in radians
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT GetRotationAngle(_In_ const XMFLOAT4& a, _In_ const XMFLOAT4& b)
+    {
+        FLOAT sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f ? -1.0f : 1.0f;
+        FLOAT dx = a.x - sign * b.x;
+        FLOAT dy = a.y - sign * b.y;
+        FLOAT dz = a.z - sign * b.z;
+        FLOAT dw = a.w - sign * b.w;
+        FLOAT halfLength = 0.5f * sqrtf(dx * dx + dy * dy + dz * dz + dw * dw);
+        return 4.0f * asinf(std::min<FLOAT>(halfLength, 1.0f));
+    }
 
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -69,7 +86,12 @@ namespace library
                 m_skinningConstantBuffer, m_aVertices, m_aAnimationData,
                 m_aIndices, m_aBoneData, m_aBoneInfo, m_aTransforms,
                 m_aBoneInfo, m_aTransforms, m_boneNameToIndexMap,
-                m_pScene, m_timeSinceLoaded, m_globalInverseTransform].
+                m_skeleton, m_aAnimations, m_animationPlayer,
+                m_aKeyCursors, m_aBindPoses, m_aLocalPoses, m_uStreamCursor,
+                m_aGlobalTransforms, m_animationStats, m_uNumBenchmarkFrames,
+                m_poseCache, m_poseCacheDesc, m_poseCacheStats, m_pScene,
+                m_bRestoredGeometry, m_bLoaded, m_timeSinceLoaded,
+                m_globalInverseTransform].
    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Model::Model(_In_ const std::filesystem::path& filePath)
         : Renderable(XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)),
@@ -83,7 +105,22 @@ namespace library
         m_aBoneInfo(std::vector<BoneInfo>()),
         m_aTransforms(std::vector<XMMATRIX>()),
         m_boneNameToIndexMap(std::unordered_map<std::string, UINT>()),
+        m_skeleton(),
+        m_aAnimations(),
+        m_animationPlayer(m_aAnimations),
+        m_aKeyCursors(),
+        m_aBindPoses(),
+        m_aLocalPoses(),
+        m_uStreamCursor(0u),
+        m_aGlobalTransforms(),
+        m_animationStats(),
+        m_uNumBenchmarkFrames(0u),
+        m_poseCache(),
+        m_poseCacheDesc(),
+        m_poseCacheStats(),
         m_pScene(nullptr),
+        m_bRestoredGeometry(FALSE),
+        m_bLoaded(FALSE),
         m_timeSinceLoaded(0.0f),
         m_globalInverseTransform(XMMATRIX())
     { }
@@ -95,48 +132,28 @@ namespace library
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::Initialize
-      Summary:  Load and initialize the 3d model and create buffers
+      Summary:  Load the 3d model unless Load was called beforehand,
+                and create buffers
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
                 ID3D11DeviceContext* pImmediateContext
                   The Direct3D context to set buffers
-      Modifies: [m_pScene, m_globalInverseTransform, m_animationBuffer,
-                 m_skinningConstantBuffer].
+      Modifies: [m_animationBuffer, m_skinningConstantBuffer].
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Model::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
     {
-        HRESULT hr = S_OK;
-
-        // Create the buffers for the vertices attributes
-        //Read the 3d model file using Assimp importer, and store the read scene
-        m_pScene = sm_pImporter->ReadFile(
-            m_filePath.string().c_str(),
-            ASSIMP_LOAD_FLAGS
-        );
-
-        m_pScene = sm_pImporter->GetOrphanedScene();
-
-        //If a valid scene is returned,
-        if (m_pScene)
+        HRESULT hr = Load();
+        if (FAILED(hr))
         {
-            //set matrix from world space to model space
-            XMMATRIX rootNodeTransform = ConvertMatrix(m_pScene->mRootNode->mTransformation);
-            XMVECTOR pDeterminant = XMMatrixDeterminant(rootNodeTransform);
-            m_globalInverseTransform = XMMatrixInverse(&pDeterminant, rootNodeTransform);
-
-            //Initialize the model
-            hr = initFromScene(pDevice, pImmediateContext, m_pScene, m_filePath);
+            return hr;
         }
-        else
+
+        hr = initialize(pDevice, pImmediateContext);
+        if (FAILED(hr))
         {
-            hr = E_FAIL;
-            OutputDebugString(L"Error parsing ");
-            OutputDebugString(m_filePath.c_str());
-            OutputDebugString(L": ");
-            OutputDebugStringA(sm_pImporter->GetErrorString());
-            OutputDebugString(L"\n");
+            return hr;
         }
 
         //Create the vertex buffer
@@ -189,37 +206,115 @@ namespace library
     }
 
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::Load
+      Summary:  Import the 3d model, unless its geometry was restored
+                from a snapshot, and decode its textures without the
+                device, so that a scene loading on a worker only leaves
+                the buffers to Initialize. The node hierarchy and the
+                animations are copied into a flat skeleton, after which
+                the Assimp scene is freed, the clips are baked into the
+                pose cache if one was set, and the first animation
+                starts looping. Does nothing once the model is loaded
+      Modifies: [m_pScene, m_globalInverseTransform, m_skeleton,
+                 m_aAnimations, m_animationPlayer, m_animationStats,
+                 m_poseCache, m_poseCacheStats, m_bLoaded].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Model::Load()
+    {
+        // Geometry restored from a snapshot already holds everything the
+        // import would produce
+        if (m_bRestoredGeometry || m_bLoaded)
+        {
+            return S_OK;
+        }
+
+        // An importer per load, scenes load on several workers at once
+        Assimp::Importer importer;
+        importer.ReadFile(
+            m_filePath.string().c_str(),
+            ASSIMP_LOAD_FLAGS
+        );
+
+        m_pScene = importer.GetOrphanedScene();
+        if (!m_pScene)
+        {
+            OutputDebugString(L"Error parsing ");
+            OutputDebugString(m_filePath.c_str());
+            OutputDebugString(L": ");
+            OutputDebugStringA(importer.GetErrorString());
+            OutputDebugString(L"\n");
+            return E_FAIL;
+        }
+
+        //set matrix from world space to model space
+        XMMATRIX rootNodeTransform = ConvertMatrix(m_pScene->mRootNode->mTransformation);
+        XMVECTOR pDeterminant = XMMatrixDeterminant(rootNodeTransform);
+        m_globalInverseTransform = XMMatrixInverse(&pDeterminant, rootNodeTransform);
+
+        //Initialize the model
+        HRESULT hr = initFromScene(m_pScene, m_filePath);
+
+        initSkeleton(m_pScene);
+        initAnimations(m_pScene);
+        m_animationStats.ullSceneBytes = getSceneMemoryUsage(m_pScene);
+        benchmarkAnimation();
+
+        // Poses are computed from the skeleton from now on
+        delete m_pScene;
+        m_pScene = nullptr;
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        // The cache is optional, without it poses are sampled live
+        if (m_poseCacheDesc.FramesPerSecond > 0.0f && FAILED(bakePoseCache()))
+        {
+            OutputDebugString(L"Model: pose cache not baked, sampling animations live\n");
+        }
+
+        m_animationPlayer.SetBindPose(m_aBindPoses);
+        if (!m_aAnimations.empty())
+        {
+            m_animationPlayer.Play(0u, 0.0f, TRUE);
+        }
+
+        m_bLoaded = TRUE;
+        return hr;
+    }
+
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::Update
-      Summary:  Update bone transformations
+      Summary:  Update bone transformations from the layers of the
+                animation player. A clip playing alone is read from the
+                pose cache when it is baked
       Args:     FLOAT deltaTime
                   Time difference of a frame
-      Modifies: [m_aTransforms].
+      Modifies: [m_timeSinceLoaded, m_animationPlayer, m_aLocalPoses,
+                 m_aGlobalTransforms, m_aTransforms].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     void Model::Update(_In_ FLOAT deltaTime)
     {
         m_timeSinceLoaded += deltaTime;
 
-        if (m_pScene->HasAnimations())
+        if (!m_aAnimations.empty() && !m_skeleton.aParents.empty())
         {
-            //Calculate the current animation time to play, using ticks per second and duration of animation
-            FLOAT ticksPerSecond = static_cast<FLOAT>(m_pScene->mAnimations[0]->mTicksPerSecond != 0.0f
-                ? m_pScene->mAnimations[0]->mTicksPerSecond : 25.0f);
-            FLOAT timeInTicks = m_timeSinceLoaded * ticksPerSecond;
-            FLOAT animationTimeTicks = fmod(timeInTicks, static_cast<FLOAT>(m_pScene->mAnimations[0]->mDuration));
-            if (m_pScene->mRootNode)
-            {
-                //Calcuate the bone transform matrics
-                XMMATRIX identity = XMMatrixIdentity();
-                readNodeHierarchy(animationTimeTicks, m_pScene->mRootNode, identity);
-
-                m_aTransforms.resize(m_aBoneInfo.size());
+            m_animationPlayer.Update(deltaTime);
 
-                //Store each final transformations in the bone information
-                for (UINT i = 0u; i < m_aBoneInfo.size(); ++i)
-                {
-                    m_aTransforms[i] = m_aBoneInfo[i].FinalTransformation;
-                }
+            const std::vector<AnimationLayer>& aLayers = m_animationPlayer.GetLayers();
+            if (!m_poseCache.IsEmpty() && aLayers.size() == 1u && aLayers[0].BlendMode == eAnimationBlendMode::OVERRIDE && aLayers[0].Weight > 0.0f)
+            {
+                m_aTransforms.resize(m_poseCache.GetNumBones());
+                m_poseCache.Sample(aLayers[0].uClip, aLayers[0].Time, m_poseCacheDesc.bInterpolate, m_aTransforms.data());
+            }
+            else
+            {
+                m_animationPlayer.Evaluate(m_aLocalPoses);
+                computePose();
             }
         }
     }
@@ -291,6 +386,678 @@ namespace library
     }
 
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::ExportGeometry
+
+      Summary:  Copies the geometry and the texture paths of the
+                imported model. The skeleton and the animations of an
+                animated model are not part of the geometry, so it is
+                left out and imported again on the next launch
+
+      Args:     ModelGeometry& geometry
+                  Receives the geometry
+
+      Returns:  HRESULT
+                  S_OK if the geometry was copied, S_FALSE if the model
+                  is animated, E_FAIL if it is not imported yet
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Model::ExportGeometry(_Out_ ModelGeometry& geometry) const
+    {
+        geometry = ModelGeometry();
+
+        if (!m_aAnimations.empty())
+        {
+            return S_FALSE;
+        }
+        if (m_aVertices.empty() || m_aAnimationData.size() != m_aVertices.size())
+        {
+            return E_FAIL;
+        }
+
+        geometry.aVertices = m_aVertices;
+        geometry.aAnimationData = m_aAnimationData;
+        geometry.aNormalData = m_aNormalData;
+        geometry.aIndices = m_aIndices;
+
+        geometry.aMeshes.reserve(m_aMeshes.size());
+        for (const BasicMeshEntry& mesh : m_aMeshes)
+        {
+            geometry.aMeshes.push_back(
+                ModelMeshEntry
+                {
+                    .uNumIndices = mesh.uNumIndices,
+                    .uBaseVertex = mesh.uBaseVertex,
+                    .uBaseIndex = mesh.uBaseIndex,
+                    .uMaterialIndex = mesh.uMaterialIndex
+                }
+            );
+        }
+
+        geometry.aMaterials.reserve(m_aMaterials.size());
+        for (const std::shared_ptr<Material>& material : m_aMaterials)
+        {
+            geometry.aMaterials.push_back(
+                ModelMaterialTextures
+                {
+                    .DiffusePath = material->pDiffuse ? material->pDiffuse->GetFilePath() : std::filesystem::path(),
+                    .SpecularPath = material->pSpecularExponent ? material->pSpecularExponent->GetFilePath() : std::filesystem::path(),
+                    .NormalPath = material->pNormal ? material->pNormal->GetFilePath() : std::filesystem::path()
+                }
+            );
+        }
+        geometry.bHasNormalMap = m_bHasNormalMap;
+
+        return S_OK;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::RestoreGeometry
+
+      Summary:  Takes geometry exported earlier so that Initialize only
+                creates the buffers. The materials are created from the
+                paths of their textures, which the scene loads when it
+                initializes its materials
+
+      Args:     ModelGeometry&& geometry
+                  Geometry to take
+
+      Modifies: [m_aVertices, m_aAnimationData, m_aNormalData,
+                 m_aIndices, m_aMeshes, m_aMaterials, m_bHasNormalMap,
+                 m_bRestoredGeometry].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::RestoreGeometry(_Inout_ ModelGeometry&& geometry)
+    {
+        m_aVertices = std::move(geometry.aVertices);
+        m_aAnimationData = std::move(geometry.aAnimationData);
+        m_aNormalData = std::move(geometry.aNormalData);
+        m_aIndices = std::move(geometry.aIndices);
+
+        m_aMeshes.clear();
+        m_aMeshes.reserve(geometry.aMeshes.size());
+        for (const ModelMeshEntry& mesh : geometry.aMeshes)
+        {
+            BasicMeshEntry entry;
+            entry.uNumIndices = mesh.uNumIndices;
+            entry.uBaseVertex = mesh.uBaseVertex;
+            entry.uBaseIndex = mesh.uBaseIndex;
+            entry.uMaterialIndex = mesh.uMaterialIndex;
+            m_aMeshes.push_back(entry);
+        }
+
+        // Materials are named as in initMaterials
+        m_aMaterials.clear();
+        m_aMaterials.reserve(geometry.aMaterials.size());
+        for (size_t i = 0u; i < geometry.aMaterials.size(); ++i)
+        {
+            std::string szName = m_filePath.string() + std::to_string(i);
+            std::wstring pwszName(szName.length(), L' ');
+            std::copy(szName.begin(), szName.end(), pwszName.begin());
+            std::shared_ptr<Material> material = std::make_shared<Material>(pwszName);
+
+            const ModelMaterialTextures& textures = geometry.aMaterials[i];
+            if (!textures.DiffusePath.empty())
+            {
+                material->pDiffuse = std::make_shared<Texture>(textures.DiffusePath);
+            }
+            if (!textures.SpecularPath.empty())
+            {
+                material->pSpecularExponent = std::make_shared<Texture>(textures.SpecularPath);
+            }
+            if (!textures.NormalPath.empty())
+            {
+                material->pNormal = std::make_shared<Texture>(textures.NormalPath);
+            }
+            m_aMaterials.push_back(material);
+        }
+
+        m_bHasNormalMap = geometry.bHasNormalMap;
+        m_bRestoredGeometry = TRUE;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::GetFilePath
+
+      Summary:  Returns the path of the model file
+
+      Returns:  const std::filesystem::path&
+                  Path of the model file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::filesystem::path& Model::GetFilePath() const
+    {
+        return m_filePath;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::SetAnimationBenchmark
+
+      Summary:  Sets the number of poses computed both from the flat
+                skeleton and from the node hierarchy of the Assimp
+                scene when the model is imported, before the scene is
+                freed. Call before Initialize
+
+      Args:     UINT uNumFrames
+                  Number of poses, 0 to skip the benchmark
+
+      Modifies: [m_uNumBenchmarkFrames].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::SetAnimationBenchmark(_In_ UINT uNumFrames)
+    {
+        m_uNumBenchmarkFrames = uNumFrames;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::GetAnimationStats
+
+      Summary:  Returns the statistics of the skeleton
+
+      Returns:  const ModelAnimationStats&
+                  Size of the skeleton and cost of a pose update
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const ModelAnimationStats& Model::GetAnimationStats() const
+    {
+        return m_animationStats;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::GetAnimationPlayer
+
+      Summary:  Returns the player of the animations, to play, fade and
+                layer the clips of the model
+
+      Returns:  AnimationPlayer&
+                  Animation player
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AnimationPlayer& Model::GetAnimationPlayer()
+    {
+        return m_animationPlayer;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::SetPoseCache
+
+      Summary:  Sets the rate and the memory budget the clips are baked
+                at into palettes of bone transforms when the model is
+                imported. Call before Initialize
+
+      Args:     const PoseCacheDesc& desc
+                  Rate, budget and interpolation, a rate of 0 to sample
+                  the animations live
+
+      Modifies: [m_poseCacheDesc].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::SetPoseCache(_In_ const PoseCacheDesc& desc)
+    {
+        m_poseCacheDesc = desc;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::GetPoseCacheStats
+
+      Summary:  Returns the statistics of the pose cache
+
+      Returns:  const PoseCacheStats&
+                  Size of the cache, its cost and its error against
+                  live sampling
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const PoseCacheStats& Model::GetPoseCacheStats() const
+    {
+        return m_poseCacheStats;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::BenchmarkKeyLookup
+
+      Summary:  Plays clips of growing length at 24 ticks per second
+                and 60 frames per second, looping and seeking to a new
+                time every few hundred frames, and finds the keys of
+                every frame by scanning from the first key and with a
+                key cursor
+
+      Args:     UINT uNumFrames
+                  Number of frames played per clip
+
+      Returns:  ModelKeyLookupStats
+                  Cost of a lookup for every clip length
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ModelKeyLookupStats Model::BenchmarkKeyLookup(_In_ UINT uNumFrames)
+    {
+        constexpr const FLOAT TICKS_PER_FRAME = 24.0f / 60.0f;
+        constexpr const UINT FRAMES_PER_SEEK = 256u;
+
+        ModelKeyLookupStats stats =
+        {
+            .auNumKeys = { 16u, 64u, 256u, 1024u, 4096u, 16384u },
+            .aLinearNanosecondsPerLookup = { 0.0f, },
+            .aCursorNanosecondsPerLookup = { 0.0f, },
+            .uNumFrames = uNumFrames,
+            .bIdentical = TRUE
+        };
+
+        BenchmarkTimer timer;
+        std::vector<FLOAT> aTimes(uNumFrames);
+        std::vector<UINT> aLinearKeys(uNumFrames);
+        std::vector<UINT> aCursorKeys(uNumFrames);
+        for (UINT uClip = 0u; uClip < ModelKeyLookupStats::NUM_CLIP_LENGTHS; ++uClip)
+        {
+            // Keys one tick apart with a jitter, as exported from a
+            // sampled clip
+            const UINT uNumKeys = stats.auNumKeys[uClip];
+            std::vector<ModelVectorKey> aKeys(uNumKeys);
+            for (UINT i = 0u; i < uNumKeys; ++i)
+            {
+                aKeys[i].Time = static_cast<FLOAT>(i) + (i > 0u ? static_cast<FLOAT>((i * 7u) % 5u) * 0.1f : 0.0f);
+                aKeys[i].Value = XMFLOAT3(static_cast<FLOAT>(i), 0.0f, 0.0f);
+            }
+
+            const FLOAT duration = aKeys.back().Time;
+            FLOAT time = 0.0f;
+            BenchmarkRandom random(12345u);
+            for (UINT i = 0u; i < uNumFrames; ++i)
+            {
+                if (i % FRAMES_PER_SEEK == FRAMES_PER_SEEK - 1u)
+                {
+                    time = duration * random.GetFloat();
+                }
+                aTimes[i] = time;
+                time = fmod(time + TICKS_PER_FRAME, duration);
+            }
+
+            timer.Start();
+            for (UINT i = 0u; i < uNumFrames; ++i)
+            {
+                aLinearKeys[i] = FindKeyLinear(aTimes[i], aKeys);
+            }
+            FLOAT seconds = timer.GetSeconds();
+            stats.aLinearNanosecondsPerLookup[uClip] = seconds * 1.0e9f / static_cast<FLOAT>(std::max<UINT>(uNumFrames, 1u));
+
+            UINT uCursor = 0u;
+            timer.Start();
+            for (UINT i = 0u; i < uNumFrames; ++i)
+            {
+                aCursorKeys[i] = FindKey(aTimes[i], aKeys, uCursor);
+            }
+            seconds = timer.GetSeconds();
+            stats.aCursorNanosecondsPerLookup[uClip] = seconds * 1.0e9f / static_cast<FLOAT>(std::max<UINT>(uNumFrames, 1u));
+
+            if (aLinearKeys != aCursorKeys)
+            {
+                stats.bIdentical = FALSE;
+            }
+
+            WCHAR szReport[256];
+            swprintf_s(
+                szReport,
+                L"Model: key lookup over %u keys, scan %.1f ns, cursor %.1f ns, %s\n",
+                uNumKeys,
+                stats.aLinearNanosecondsPerLookup[uClip],
+                stats.aCursorNanosecondsPerLookup[uClip],
+                aLinearKeys == aCursorKeys ? L"identical" : L"MISMATCH"
+            );
+            OutputDebugString(szReport);
+        }
+
+        return stats;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::bakePoseCache
+
+      Summary:  Samples every clip at the frames of the pose cache into
+                its palettes, then measures reading the cache against
+                sampling the clips live and the largest difference of
+                their bone transforms halfway between frames, where the
+                cache strays furthest
+
+      Modifies: [m_poseCache, m_poseCacheStats, m_uStreamCursor,
+                 m_aLocalPoses, m_aGlobalTransforms, m_aTransforms].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Model::bakePoseCache()
+    {
+        BenchmarkTimer timer;
+
+        m_poseCacheStats = PoseCacheStats();
+        std::vector<FLOAT> aClipSeconds;
+        aClipSeconds.reserve(m_aAnimations.size());
+        for (const ModelAnimation& animation : m_aAnimations)
+        {
+            aClipSeconds.push_back(animation.TicksPerSecond > 0.0f ? animation.Duration / animation.TicksPerSecond : 0.0f);
+        }
+
+        HRESULT hr = m_poseCache.Allocate(aClipSeconds, static_cast<UINT>(m_aBoneInfo.size()), m_poseCacheDesc.FramesPerSecond, m_poseCacheDesc.ullBudgetBytes);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        const UINT uNumClips = static_cast<UINT>(m_aAnimations.size());
+        const UINT uNumBones = m_poseCache.GetNumBones();
+        for (UINT c = 0u; c < uNumClips; ++c)
+        {
+            const ModelAnimation& animation = m_aAnimations[c];
+            for (UINT f = 0u; f < m_poseCache.GetNumFrames(c); ++f)
+            {
+                AnimationPlayer::SampleStream(animation.Stream, m_poseCache.GetFrameTime(c, f) * animation.TicksPerSecond, m_uStreamCursor, m_aLocalPoses.data());
+                computePose();
+                std::copy(m_aTransforms.begin(), m_aTransforms.begin() + uNumBones, m_poseCache.GetPalette(c, f));
+            }
+        }
+
+        m_poseCacheStats.BakeMilliseconds = timer.GetMilliseconds();
+        m_poseCacheStats.uNumClips = uNumClips;
+        m_poseCacheStats.uNumFrames = m_poseCache.GetNumFrames();
+        m_poseCacheStats.uNumBones = uNumBones;
+        m_poseCacheStats.FramesPerSecond = m_poseCache.GetFramesPerSecond();
+        m_poseCacheStats.ullMemoryBytes = m_poseCache.GetMemoryUsage();
+        m_poseCacheStats.ullBudgetBytes = m_poseCacheDesc.ullBudgetBytes;
+
+        auto getMiddleTime = [this](UINT uClip, UINT uFrame)
+        {
+            return 0.5f * (m_poseCache.GetFrameTime(uClip, uFrame) + m_poseCache.GetFrameTime(uClip, uFrame + 1u));
+        };
+
+        UINT uNumSamples = 0u;
+        timer.Start();
+        for (UINT c = 0u; c < uNumClips; ++c)
+        {
+            const ModelAnimation& animation = m_aAnimations[c];
+            for (UINT f = 0u; f + 1u < m_poseCache.GetNumFrames(c); ++f)
+            {
+                AnimationPlayer::SampleStream(animation.Stream, getMiddleTime(c, f) * animation.TicksPerSecond, m_uStreamCursor, m_aLocalPoses.data());
+                computePose();
+                ++uNumSamples;
+            }
+        }
+        m_poseCacheStats.LiveMicrosecondsPerUpdate = timer.GetSeconds() * 1.0e6f / static_cast<FLOAT>(uNumSamples);
+
+        std::vector<XMMATRIX> aCachedTransforms(uNumBones);
+        timer.Start();
+        for (UINT c = 0u; c < uNumClips; ++c)
+        {
+            for (UINT f = 0u; f + 1u < m_poseCache.GetNumFrames(c); ++f)
+            {
+                m_poseCache.Sample(c, getMiddleTime(c, f), m_poseCacheDesc.bInterpolate, aCachedTransforms.data());
+            }
+        }
+        m_poseCacheStats.CachedMicrosecondsPerUpdate = timer.GetSeconds() * 1.0e6f / static_cast<FLOAT>(uNumSamples);
+
+        for (UINT c = 0u; c < uNumClips; ++c)
+        {
+            const ModelAnimation& animation = m_aAnimations[c];
+            for (UINT f = 0u; f + 1u < m_poseCache.GetNumFrames(c); ++f)
+            {
+                AnimationPlayer::SampleStream(animation.Stream, getMiddleTime(c, f) * animation.TicksPerSecond, m_uStreamCursor, m_aLocalPoses.data());
+                computePose();
+                m_poseCache.Sample(c, getMiddleTime(c, f), m_poseCacheDesc.bInterpolate, aCachedTransforms.data());
+                for (UINT uBone = 0u; uBone < uNumBones; ++uBone)
+                {
+                    XMFLOAT4X4 live;
+                    XMFLOAT4X4 cached;
+                    XMStoreFloat4x4(&live, m_aTransforms[uBone]);
+                    XMStoreFloat4x4(&cached, aCachedTransforms[uBone]);
+                    for (UINT uRow = 0u; uRow < 3u; ++uRow)
+                    {
+                        for (UINT uColumn = 0u; uColumn < 3u; ++uColumn)
+                        {
+                            m_poseCacheStats.MaxRotationError = std::max<FLOAT>(m_poseCacheStats.MaxRotationError, fabsf(live.m[uRow][uColumn] - cached.m[uRow][uColumn]));
+                        }
+                        m_poseCacheStats.MaxTranslationError = std::max<FLOAT>(m_poseCacheStats.MaxTranslationError, fabsf(live.m[3][uRow] - cached.m[3][uRow]));
+                    }
+                }
+            }
+        }
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"Model: pose cache of %u clips, %u frames of %u bones at %.1f fps, %llu of %llu bytes, bake %.2f ms, %.2f us per update against %.2f us live, error %.2e rotation, %.2e translation\n",
+            m_poseCacheStats.uNumClips,
+            m_poseCacheStats.uNumFrames,
+            m_poseCacheStats.uNumBones,
+            m_poseCacheStats.FramesPerSecond,
+            m_poseCacheStats.ullMemoryBytes,
+            m_poseCacheStats.ullBudgetBytes,
+            m_poseCacheStats.BakeMilliseconds,
+            m_poseCacheStats.CachedMicrosecondsPerUpdate,
+            m_poseCacheStats.LiveMicrosecondsPerUpdate,
+            m_poseCacheStats.MaxRotationError,
+            m_poseCacheStats.MaxTranslationError
+        );
+        OutputDebugString(szReport);
+
+        return S_OK;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::benchmarkAnimation
+
+      Summary:  Computes m_uNumBenchmarkFrames poses spread over the
+                first animation from the flat skeleton and measures
+                them. Then measures sampling the key streams against
+                interpolating one channel at a time and compares the
+                local poses they give. Last, measures blending BENCHMARK_BLEND_LAYERS
+                layers against sampling one clip, and checks that a
+                single layer of the animation player gives the pose of
+                its clip
+
+      Modifies: [m_animationStats, m_aKeyCursors, m_uStreamCursor,
+                 m_aLocalPoses, m_aGlobalTransforms, m_aTransforms].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::benchmarkAnimation()
+    {
+        if (m_uNumBenchmarkFrames == 0u || m_aAnimations.empty())
+        {
+            return;
+        }
+
+        const ModelAnimation& animation = m_aAnimations[0];
+        const UINT uNumFrames = m_uNumBenchmarkFrames;
+        auto getFrameTime = [&animation, uNumFrames](UINT uFrame)
+        {
+            return animation.Duration * static_cast<FLOAT>(uFrame) / static_cast<FLOAT>(uNumFrames);
+        };
+
+        BenchmarkTimer timer;
+        for (UINT i = 0u; i < uNumFrames; ++i)
+        {
+            AnimationPlayer::SampleStream(animation.Stream, getFrameTime(i), m_uStreamCursor, m_aLocalPoses.data());
+            computePose();
+        }
+        FLOAT seconds = timer.GetSeconds();
+        m_animationStats.MicrosecondsPerUpdate = seconds * 1.0e6f / static_cast<FLOAT>(uNumFrames);
+
+        m_animationStats.uNumFrames = uNumFrames;
+
+        const FLOAT numBones = static_cast<FLOAT>(animation.aChannels.size()) * static_cast<FLOAT>(uNumFrames);
+        timer.Start();
+        for (UINT i = 0u; i < uNumFrames; ++i)
+        {
+            AnimationPlayer::SampleStream(animation.Stream, getFrameTime(i), m_uStreamCursor, m_aLocalPoses.data());
+        }
+        seconds = timer.GetSeconds();
+        m_animationStats.StreamBonesPerMicrosecond = seconds > 0.0f ? numBones / (seconds * 1.0e6f) : 0.0f;
+
+        timer.Start();
+        for (UINT i = 0u; i < uNumFrames; ++i)
+        {
+            sampleChannels(animation, getFrameTime(i));
+        }
+        seconds = timer.GetSeconds();
+        m_animationStats.ChannelBonesPerMicrosecond = seconds > 0.0f ? numBones / (seconds * 1.0e6f) : 0.0f;
+
+        m_animationStats.MaxRotationError = 0.0f;
+        m_animationStats.MaxTranslationError = 0.0f;
+        std::vector<XMVECTOR> aChannelPoses(m_aLocalPoses.size());
+        for (UINT i = 0u; i < uNumFrames; ++i)
+        {
+            sampleChannels(animation, getFrameTime(i));
+            std::copy(m_aLocalPoses.begin(), m_aLocalPoses.end(), aChannelPoses.begin());
+            AnimationPlayer::SampleStream(animation.Stream, getFrameTime(i), m_uStreamCursor, m_aLocalPoses.data());
+
+            const FLOAT* pChannelPoses = reinterpret_cast<const FLOAT*>(aChannelPoses.data());
+            const FLOAT* pStreamPoses = reinterpret_cast<const FLOAT*>(m_aLocalPoses.data());
+            for (size_t uNode = 0u; uNode < animation.aNodeChannels.size(); ++uNode)
+            {
+                if (animation.aNodeChannels[uNode] < 0)
+                {
+                    continue;
+                }
+
+                const size_t uLane = (uNode / 4u) * ModelAnimationStream::NUM_COMPONENTS * 4u + uNode % 4u;
+                const FLOAT* pExpected = pChannelPoses + uLane;
+                const FLOAT* pActual = pStreamPoses + uLane;
+                for (UINT uComponent = ModelAnimationStream::POSITION; uComponent < ModelAnimationStream::POSITION + 3u; ++uComponent)
+                {
+                    m_animationStats.MaxTranslationError = std::max<FLOAT>(m_animationStats.MaxTranslationError, fabsf(pActual[uComponent * 4u] - pExpected[uComponent * 4u]));
+                }
+
+                const UINT r = ModelAnimationStream::ROTATION * 4u;
+                XMFLOAT4 expected(pExpected[r], pExpected[r + 4u], pExpected[r + 8u], pExpected[r + 12u]);
+                XMFLOAT4 actual(pActual[r], pActual[r + 4u], pActual[r + 8u], pActual[r + 12u]);
+                m_animationStats.MaxRotationError = std::max<FLOAT>(m_animationStats.MaxRotationError, GetRotationAngle(actual, expected));
+            }
+        }
+        m_animationStats.bWithinTolerance = m_animationStats.MaxRotationError <= NLERP_TOLERANCE;
+
+        // A single layer at full weight is the clip itself, sampled at
+        // the time the player reached
+        AnimationPlayer player(m_aAnimations);
+        player.SetBindPose(m_aBindPoses);
+        player.Play(0u, 0.0f, TRUE);
+        std::vector<XMVECTOR> aBlendedPoses;
+        const FLOAT frameSeconds = animation.Duration / animation.TicksPerSecond / static_cast<FLOAT>(uNumFrames);
+        m_animationStats.bBlendIdentical = TRUE;
+        for (UINT i = 0u; i < uNumFrames && m_animationStats.bBlendIdentical; ++i)
+        {
+            player.Update(frameSeconds);
+            player.Evaluate(aBlendedPoses);
+            AnimationPlayer::SampleStream(animation.Stream, player.GetLayers()[0].Time * animation.TicksPerSecond, m_uStreamCursor, m_aLocalPoses.data());
+
+            const FLOAT* pBlended = reinterpret_cast<const FLOAT*>(aBlendedPoses.data());
+            const FLOAT* pSampled = reinterpret_cast<const FLOAT*>(m_aLocalPoses.data());
+            for (size_t uNode = 0u; uNode < animation.aNodeChannels.size(); ++uNode)
+            {
+                const size_t uLane = (uNode / 4u) * ModelAnimationStream::NUM_COMPONENTS * 4u + uNode % 4u;
+                for (UINT uComponent = 0u; uComponent < ModelAnimationStream::NUM_COMPONENTS; ++uComponent)
+                {
+                    if (fabsf(pBlended[uLane + uComponent * 4u] - pSampled[uLane + uComponent * 4u]) > 1.0e-5f)
+                    {
+                        m_animationStats.bBlendIdentical = FALSE;
+                    }
+                }
+            }
+        }
+
+        AnimationBlendStats blendStats = AnimationPlayer::Benchmark(m_aAnimations, m_aBindPoses, BENCHMARK_BLEND_LAYERS, uNumFrames);
+        m_animationStats.uNumBlendLayers = blendStats.uNumLayers;
+        m_animationStats.SampleMicrosecondsPerPose = blendStats.SampleMicrosecondsPerPose;
+        m_animationStats.BlendMicrosecondsPerPose = blendStats.BlendMicrosecondsPerPose;
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"Model: %u nodes, %u bones, %u keys, %llu bytes kept, scene %llu bytes, %.2f us per pose\n",
+            m_animationStats.uNumNodes,
+            m_animationStats.uNumBones,
+            m_animationStats.uNumKeys,
+            m_animationStats.ullAnimationBytes,
+            m_animationStats.ullSceneBytes,
+            m_animationStats.MicrosecondsPerUpdate
+        );
+        OutputDebugString(szReport);
+
+        swprintf_s(
+            szReport,
+            L"Model: streams of %u times, %llu bytes, %.1f bones/us against %.1f bones/us a channel at a time, rotation error %.2e rad, translation error %.2e, %s\n",
+            m_animationStats.uNumStreamTimes,
+            m_animationStats.ullStreamBytes,
+            m_animationStats.StreamBonesPerMicrosecond,
+            m_animationStats.ChannelBonesPerMicrosecond,
+            m_animationStats.MaxRotationError,
+            m_animationStats.MaxTranslationError,
+            m_animationStats.bWithinTolerance ? L"within tolerance" : L"OUT OF TOLERANCE"
+        );
+        OutputDebugString(szReport);
+
+        swprintf_s(
+            szReport,
+            L"Model: %u layers blended in %.2f us per pose against %.2f us sampling one clip, single layer %s\n",
+            m_animationStats.uNumBlendLayers,
+            m_animationStats.BlendMicrosecondsPerPose,
+            m_animationStats.SampleMicrosecondsPerPose,
+            m_animationStats.bBlendIdentical ? L"identical" : L"MISMATCH"
+        );
+        OutputDebugString(szReport);
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::computePose
+
+      Summary:  Computes the bone transforms of a pose in one pass over
+                the flat skeleton from the local poses sampled last.
+                Parents come before their children, so the global
+                transform of the parent of a node is always ready when
+                the node is reached. Nodes no animation moves keep
+                their bind transform
+
+      Modifies: [m_aGlobalTransforms, m_aTransforms].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::computePose()
+    {
+        const size_t uNumNodes = m_skeleton.aParents.size();
+        m_aGlobalTransforms.resize(uNumNodes);
+        m_aTransforms.resize(m_aBoneInfo.size());
+        const FLOAT* pLocalPoses = reinterpret_cast<const FLOAT*>(m_aLocalPoses.data());
+
+        for (size_t i = 0u; i < uNumNodes; ++i)
+        {
+            XMMATRIX nodeTransformation;
+            if (m_skeleton.abAnimated[i])
+            {
+                // Lane of the node in its block of four
+                const FLOAT* pLanes = pLocalPoses + (i / 4u) * ModelAnimationStream::NUM_COMPONENTS * 4u + i % 4u;
+                auto getComponent = [pLanes](UINT uComponent)
+                {
+                    return pLanes[uComponent * 4u];
+                };
+
+                constexpr const UINT P = ModelAnimationStream::POSITION;
+                constexpr const UINT R = ModelAnimationStream::ROTATION;
+                constexpr const UINT S = ModelAnimationStream::SCALING;
+                nodeTransformation = XMMatrixScaling(getComponent(S), getComponent(S + 1u), getComponent(S + 2u)) *
+                    XMMatrixRotationQuaternion(XMVectorSet(getComponent(R), getComponent(R + 1u), getComponent(R + 2u), getComponent(R + 3u))) *
+                    XMMatrixTranslation(getComponent(P), getComponent(P + 1u), getComponent(P + 2u));
+            }
+            else
+            {
+                nodeTransformation = XMLoadFloat4x4(&m_skeleton.aLocalTransforms[i]);
+            }
+
+            INT iParent = m_skeleton.aParents[i];
+            m_aGlobalTransforms[i] = iParent >= 0 ? nodeTransformation * m_aGlobalTransforms[iParent] : nodeTransformation;
+
+            INT iBone = m_skeleton.aBoneSlots[i];
+            if (iBone >= 0)
+            {
+                m_aTransforms[iBone] = m_aBoneInfo[iBone].OffsetMatrix * m_aGlobalTransforms[i] * m_globalInverseTransform;
+            }
+        }
+    }
+
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
         Method:   Model::countVerticesAndIndices
         Summary:  Fill the BasicMeshEntry information
@@ -318,27 +1085,29 @@ namespace library
 
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-        Method:   Model::findNodeAnimOrNull
-        Summary:  Find the aiNodeAnim with the givne node name in the given animation
+        Method:   Model::findChannel
+        Summary:  Find the channel whose node name is exactly the given
+                  node name in the given animation
         Args:     const aiAnimation* pAnimation
                     Pointer to an assimp animation object
                   PCSTR pszNodeName
                     Node name to find
-        Returns:  aiNodeAnim* or nullptr
+        Returns:  INT
+                    Index of the channel or -1
      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    const aiNodeAnim* Model::findNodeAnimOrNull(_In_ const aiAnimation* pAnimation, _In_ PCSTR pszNodeName)
+    INT Model::findChannel(_In_ const aiAnimation* pAnimation, _In_ PCSTR pszNodeName)
     {
         for (UINT i = 0u; i < pAnimation->mNumChannels; ++i)
         {
             const aiNodeAnim* pNodeAnim = pAnimation->mChannels[i];
 
-            if (strncmp(pNodeAnim->mNodeName.data, pszNodeName, pNodeAnim->mNodeName.length) == 0)
+            if (strcmp(pNodeAnim->mNodeName.C_Str(), pszNodeName) == 0)
             {
-                return pNodeAnim;
+                return static_cast<INT>(i);
             }
         }
 
-        return nullptr;
+        return -1;
     }
 
 
@@ -347,26 +1116,19 @@ namespace library
         Summary:  Find the index of the position key right before the given animation time
         Args:     FLOAT animationTimeTicks
                     Animation time
-                  const aiNodeAnim* pNodeAnim
-                     Pointer to an assimp node anim object
+                  const ModelAnimationChannel& channel
+                     Keys of the node
+                  UINT& uCursor
+                     Key found for the previous frame
+        Modifies: [uCursor].
         Returns:  UINT
                     Index of the key
      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    UINT Model::findPosition(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    UINT Model::findPosition(_In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ UINT& uCursor)
     {
-        assert(pNodeAnim->mNumPositionKeys > 0);
-
-        for (UINT i = 0; i < pNodeAnim->mNumPositionKeys - 1; ++i)
-        {
-            FLOAT t = static_cast<FLOAT>(pNodeAnim->mPositionKeys[i + 1].mTime);
-
-            if (animationTimeTicks < t)
-            {
-                return i;
-            }
-        }
+        assert(!channel.aPositionKeys.empty());
 
-        return 0u;
+        return FindKey(animationTimeTicks, channel.aPositionKeys, uCursor);
     }
 
 
@@ -375,120 +1137,415 @@ namespace library
         Summary:  Find the index of the rotation key right before the given animation time
         Args:     FLOAT animationTimeTicks
                     Animation time
-                  const aiNodeAnim* pNodeAnim
-                     Pointer to an assimp node anim object
+                  const ModelAnimationChannel& channel
+                     Keys of the node
+                  UINT& uCursor
+                     Key found for the previous frame
+        Modifies: [uCursor].
+        Returns:  UINT
+                    Index of the key
+     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT Model::findRotation(_In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ UINT& uCursor)
+    {
+        assert(!channel.aRotationKeys.empty());
+
+        return FindKey(animationTimeTicks, channel.aRotationKeys, uCursor);
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+        Method:   Model::findScaling
+        Summary:  Find the index of the scaling key right before the given animation time
+        Args:     FLOAT animationTimeTicks
+                    Animation time
+                  const ModelAnimationChannel& channel
+                     Keys of the node
+                  UINT& uCursor
+                     Key found for the previous frame
+        Modifies: [uCursor].
         Returns:  UINT
                     Index of the key
      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    UINT Model::findRotation(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    UINT Model::findScaling(_In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ UINT& uCursor)
     {
-        assert(pNodeAnim->mNumRotationKeys > 0);
+        assert(!channel.aScalingKeys.empty());
+
+        return FindKey(animationTimeTicks, channel.aScalingKeys, uCursor);
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+        Method:   Model::getBoneId
+        Summary:  Find the the index of the bone
+        Args:      const aiBone* pBone
+                     Pointer to an assimp bone object
+        Modifies: [m_boneNameToIndexMap].
+        Returns:  UINT
+                    Index of the bone
+     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT Model::getBoneId(_In_ const aiBone* pBone)
+    {
+        UINT uBoneIndex = 0u;
+        PCSTR pszBoneName = pBone->mName.C_Str();
+        if (!m_boneNameToIndexMap.contains(pszBoneName))
+        {
+            uBoneIndex = static_cast<UINT>(m_boneNameToIndexMap.size());
+            m_boneNameToIndexMap[pszBoneName] = uBoneIndex;
+        }
+        else
+        {
+            uBoneIndex = m_boneNameToIndexMap[pszBoneName];
+        }
+
+        return uBoneIndex;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::getVertices
+      Summary:  Returns the vertices data
+      Returns:  const SimpleVertex*
+                  Array of vertices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const SimpleVertex* Model::getVertices() const
+    {
+        return m_aVertices.data();
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::getIndices
+      Summary:  Returns the indices data
+      Returns:  const WORD*
+                  Array of indices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const WORD* Model::getIndices() const
+    {
+        return m_aIndices.data();
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::initAllMeshes
+      Summary:  Initialize all meshes in a given assimp scene
+      Args:     const aiScene* pScene
+                  Assimp scene
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::initAllMeshes(_In_ const aiScene* pScene)
+    {
+        for (UINT i = 0u; i < m_aMeshes.size(); ++i)
+        {
+            const aiMesh* pMesh = pScene->mMeshes[i];
+            initSingleMesh(i, pMesh);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::initAnimations
+
+      Summary:  Copies the keys of every animation of a given assimp
+                scene and resolves, for every node of the skeleton, the
+                channel that moves it, so that no name is looked up
+                after the import, marks the nodes any animation moves,
+                converts the keys into streams, and makes room for the
+                key cursors of the channels and the local poses of the
+                nodes. Call after initSkeleton
+
+      Args:     const aiScene* pScene
+                  Assimp scene
+
+      Modifies: [m_aAnimations, m_skeleton, m_aKeyCursors, m_aBindPoses,
+                 m_aLocalPoses, m_uStreamCursor, m_animationStats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::initAnimations(_In_ const aiScene* pScene)
+    {
+        m_aAnimations.clear();
+        m_aAnimations.reserve(pScene->mNumAnimations);
+        m_aKeyCursors.clear();
+        m_uStreamCursor = 0u;
+        m_animationStats = ModelAnimationStats();
+        m_skeleton.abAnimated.assign(m_skeleton.aParents.size(), FALSE);
+        initBindPose();
+        m_aLocalPoses = m_aBindPoses;
+
+        UINT64 ullBytes = m_skeleton.aParents.size() * (sizeof(INT) + sizeof(XMFLOAT4X4) + sizeof(INT) + sizeof(std::string) + sizeof(BOOL));
+        for (const std::string& name : m_skeleton.aNames)
+        {
+            ullBytes += name.capacity();
+        }
+
+        for (UINT i = 0u; i < pScene->mNumAnimations; ++i)
+        {
+            const aiAnimation* pAnimation = pScene->mAnimations[i];
+            ModelAnimation animation =
+            {
+                .aChannels = std::vector<ModelAnimationChannel>(pAnimation->mNumChannels),
+                .aNodeChannels = std::vector<INT>(m_skeleton.aParents.size(), -1),
+                .Duration = static_cast<FLOAT>(pAnimation->mDuration),
+                .TicksPerSecond = static_cast<FLOAT>(pAnimation->mTicksPerSecond != 0.0f ? pAnimation->mTicksPerSecond : 25.0f)
+            };
+
+            for (UINT j = 0u; j < pAnimation->mNumChannels; ++j)
+            {
+                const aiNodeAnim* pNodeAnim = pAnimation->mChannels[j];
+                ModelAnimationChannel& channel = animation.aChannels[j];
+
+                channel.aPositionKeys.reserve(pNodeAnim->mNumPositionKeys);
+                for (UINT k = 0u; k < pNodeAnim->mNumPositionKeys; ++k)
+                {
+                    const aiVectorKey& key = pNodeAnim->mPositionKeys[k];
+                    channel.aPositionKeys.push_back({ static_cast<FLOAT>(key.mTime), ConvertVector3dToFloat3(key.mValue) });
+                }
+
+                channel.aRotationKeys.reserve(pNodeAnim->mNumRotationKeys);
+                for (UINT k = 0u; k < pNodeAnim->mNumRotationKeys; ++k)
+                {
+                    const aiQuatKey& key = pNodeAnim->mRotationKeys[k];
+                    channel.aRotationKeys.push_back({ static_cast<FLOAT>(key.mTime), XMFLOAT4(key.mValue.x, key.mValue.y, key.mValue.z, key.mValue.w) });
+                }
+
+                channel.aScalingKeys.reserve(pNodeAnim->mNumScalingKeys);
+                for (UINT k = 0u; k < pNodeAnim->mNumScalingKeys; ++k)
+                {
+                    const aiVectorKey& key = pNodeAnim->mScalingKeys[k];
+                    channel.aScalingKeys.push_back({ static_cast<FLOAT>(key.mTime), ConvertVector3dToFloat3(key.mValue) });
+                }
+
+                m_animationStats.uNumKeys += pNodeAnim->mNumPositionKeys + pNodeAnim->mNumRotationKeys + pNodeAnim->mNumScalingKeys;
+                ullBytes += sizeof(ModelAnimationChannel) +
+                    (channel.aPositionKeys.capacity() + channel.aScalingKeys.capacity()) * sizeof(ModelVectorKey) +
+                    channel.aRotationKeys.capacity() * sizeof(ModelQuaternionKey);
+            }
+
+            for (size_t j = 0u; j < m_skeleton.aNames.size(); ++j)
+            {
+                animation.aNodeChannels[j] = findChannel(pAnimation, m_skeleton.aNames[j].c_str());
+                if (animation.aNodeChannels[j] >= 0)
+                {
+                    m_skeleton.abAnimated[j] = TRUE;
+                }
+            }
+
+            m_animationStats.uNumChannels += pAnimation->mNumChannels;
+            m_aKeyCursors.resize(std::max<size_t>(m_aKeyCursors.size(), pAnimation->mNumChannels), KeyCursor());
+
+            initAnimationStream(animation);
+            m_animationStats.uNumStreamTimes += static_cast<UINT>(animation.Stream.aTimes.size());
+            m_animationStats.ullStreamBytes += animation.Stream.aTimes.capacity() * sizeof(FLOAT) + animation.Stream.aKeys.capacity() * sizeof(XMVECTOR);
+            ullBytes += sizeof(ModelAnimation) + animation.aNodeChannels.size() * sizeof(INT);
+            m_aAnimations.push_back(std::move(animation));
+        }
+
+        m_animationStats.uNumNodes = static_cast<UINT>(m_skeleton.aParents.size());
+        m_animationStats.uNumBones = static_cast<UINT>(m_aBoneInfo.size());
+        m_animationStats.ullAnimationBytes = ullBytes;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::initAnimationStream
+
+      Summary:  Samples every channel of an animation at the times of
+                all its keys into a stream, in the lanes of the nodes
+                they move; the other nodes hold their bind pose, so
+                that the streams of all the animations line up for
+                blending. Between two times every
+                channel moves along a single segment of its keys, so a
+                lerp of the stream gives back the positions and the
+                scalings exactly. A normalized lerp of the rotations
+                strays furthest from their slerp about a fifth of the
+                way along; where it strays more than NLERP_TOLERANCE for
+                a channel the interval is halved. Successive rotations
+                of a lane are kept in the same hemisphere so that no
+                sign has to be checked when sampling
+
+      Args:     ModelAnimation& animation
+                  Animation whose channels and node channels are
+                  resolved already. Call after initBindPose
+
+      Modifies: [animation].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::initAnimationStream(_Inout_ ModelAnimation& animation)
+    {
+        constexpr const FLOAT NLERP_PEAK = 0.2113249f;
+
+        struct Interval
+        {
+            FLOAT Start;
+            FLOAT End;
+            UINT uDepth;
+        };
+
+        ModelAnimationStream& stream = animation.Stream;
+        const UINT uNumChannels = static_cast<UINT>(animation.aChannels.size());
+        stream.aTimes.clear();
+        stream.aKeys.clear();
+        stream.uNumBlocks = static_cast<UINT>(m_aBindPoses.size() / ModelAnimationStream::NUM_COMPONENTS);
+        if (uNumChannels == 0u)
+        {
+            return;
+        }
 
-        for (UINT i = 0u; i < pNodeAnim->mNumRotationKeys - 1; ++i)
+        std::vector<FLOAT> aKeyTimes;
+        for (const ModelAnimationChannel& channel : animation.aChannels)
         {
-            FLOAT t = static_cast<FLOAT>(pNodeAnim->mRotationKeys[i + 1].mTime);
-
-            if (animationTimeTicks < t)
+            for (const ModelVectorKey& key : channel.aPositionKeys)
+            {
+                aKeyTimes.push_back(key.Time);
+            }
+            for (const ModelQuaternionKey& key : channel.aRotationKeys)
             {
-                return i;
+                aKeyTimes.push_back(key.Time);
+            }
+            for (const ModelVectorKey& key : channel.aScalingKeys)
+            {
+                aKeyTimes.push_back(key.Time);
             }
         }
+        std::sort(aKeyTimes.begin(), aKeyTimes.end());
+        aKeyTimes.erase(std::unique(aKeyTimes.begin(), aKeyTimes.end()), aKeyTimes.end());
+        if (aKeyTimes.empty())
+        {
+            return;
+        }
 
-        return 0u;
-    }
-
+        std::vector<KeyCursor> aCursors(uNumChannels, KeyCursor());
+        auto getRotation = [this, &animation, &aCursors](UINT uChannel, FLOAT time)
+        {
+            XMFLOAT3 translate;
+            XMVECTOR quaternion;
+            XMFLOAT3 scale;
+            sampleChannel(animation.aChannels[uChannel], nullptr, time, aCursors[uChannel], translate, quaternion, scale);
+
+            XMFLOAT4 rotation;
+            XMStoreFloat4(&rotation, quaternion);
+            return rotation;
+        };
+        auto getNlerpError = [&](FLOAT start, FLOAT end)
+        {
+            FLOAT maxError = 0.0f;
+            for (UINT c = 0u; c < uNumChannels; ++c)
+            {
+                if (animation.aChannels[c].aRotationKeys.size() < 2u)
+                {
+                    continue;
+                }
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-        Method:   Model::findScaling
-        Summary:  Find the index of the scaling key right before the given animation time
-        Args:     FLOAT animationTimeTicks
-                    Animation time
-                  const aiNodeAnim* pNodeAnim
-                     Pointer to an assimp node anim object
-        Returns:  UINT
-                    Index of the key
-     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    UINT Model::findScaling(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
-    {
-        assert(pNodeAnim->mNumScalingKeys > 0);
+                XMFLOAT4 a = getRotation(c, start);
+                XMFLOAT4 b = getRotation(c, end);
+                XMFLOAT4 exact = getRotation(c, start + NLERP_PEAK * (end - start));
+                FLOAT sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f ? -1.0f : 1.0f;
+                XMFLOAT4 nlerp(
+                    a.x + NLERP_PEAK * (sign * b.x - a.x),
+                    a.y + NLERP_PEAK * (sign * b.y - a.y),
+                    a.z + NLERP_PEAK * (sign * b.z - a.z),
+                    a.w + NLERP_PEAK * (sign * b.w - a.w)
+                );
+                FLOAT invLength = 1.0f / sqrtf(nlerp.x * nlerp.x + nlerp.y * nlerp.y + nlerp.z * nlerp.z + nlerp.w * nlerp.w);
+                nlerp = XMFLOAT4(nlerp.x * invLength, nlerp.y * invLength, nlerp.z * invLength, nlerp.w * invLength);
+                maxError = std::max<FLOAT>(maxError, GetRotationAngle(nlerp, exact));
+            }
+            return maxError;
+        };
 
-        for (UINT i = 0u; i < pNodeAnim->mNumScalingKeys - 1; ++i)
+        // Intervals are split depth first, left half first, so the
+        // times come out sorted
+        std::vector<Interval> aIntervals;
+        stream.aTimes.push_back(aKeyTimes[0]);
+        for (size_t i = 1u; i < aKeyTimes.size(); ++i)
         {
-            FLOAT t = static_cast<FLOAT>(pNodeAnim->mScalingKeys[i + 1].mTime);
-
-            if (animationTimeTicks < t)
+            aIntervals.push_back({ aKeyTimes[i - 1u], aKeyTimes[i], 0u });
+            while (!aIntervals.empty())
             {
-                return i;
+                Interval interval = aIntervals.back();
+                aIntervals.pop_back();
+                if (interval.uDepth < MAX_STREAM_SUBDIVISIONS && getNlerpError(interval.Start, interval.End) > NLERP_TOLERANCE)
+                {
+                    FLOAT middle = 0.5f * (interval.Start + interval.End);
+                    aIntervals.push_back({ middle, interval.End, interval.uDepth + 1u });
+                    aIntervals.push_back({ interval.Start, middle, interval.uDepth + 1u });
+                    continue;
+                }
+
+                stream.aTimes.push_back(interval.End);
             }
         }
 
-        return 0u;
-    }
-
-
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-        Method:   Model::getBoneId
-        Summary:  Find the the index of the bone
-        Args:      const aiBone* pBone
-                     Pointer to an assimp bone object
-        Modifies: [m_boneNameToIndexMap].
-        Returns:  UINT
-                    Index of the bone
-     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    UINT Model::getBoneId(_In_ const aiBone* pBone)
-    {
-        UINT uBoneIndex = 0u;
-        PCSTR pszBoneName = pBone->mName.C_Str();
-        if (!m_boneNameToIndexMap.contains(pszBoneName))
+        const size_t uStride = m_aBindPoses.size();
+        stream.aKeys.resize(stream.aTimes.size() * uStride);
+        for (size_t k = 0u; k < stream.aTimes.size(); ++k)
         {
-            uBoneIndex = static_cast<UINT>(m_boneNameToIndexMap.size());
-            m_boneNameToIndexMap[pszBoneName] = uBoneIndex;
+            std::copy(m_aBindPoses.begin(), m_aBindPoses.end(), stream.aKeys.begin() + k * uStride);
         }
-        else
+
+        const FLOAT* pBindPoses = reinterpret_cast<const FLOAT*>(m_aBindPoses.data());
+        FLOAT* pKeys = reinterpret_cast<FLOAT*>(stream.aKeys.data());
+        for (size_t k = 0u; k < stream.aTimes.size(); ++k)
         {
-            uBoneIndex = m_boneNameToIndexMap[pszBoneName];
-        }
+            for (size_t uNode = 0u; uNode < animation.aNodeChannels.size(); ++uNode)
+            {
+                INT iChannel = animation.aNodeChannels[uNode];
+                if (iChannel < 0)
+                {
+                    continue;
+                }
 
-        return uBoneIndex;
-    }
+                FLOAT* pLanes = pKeys + (k * uStride + (uNode / 4u) * ModelAnimationStream::NUM_COMPONENTS) * 4u + uNode % 4u;
+                XMFLOAT3 translate;
+                XMVECTOR quaternion;
+                XMFLOAT3 scale;
+                sampleChannel(animation.aChannels[iChannel], pBindPoses + (uNode / 4u) * ModelAnimationStream::NUM_COMPONENTS * 4u + uNode % 4u, stream.aTimes[k], aCursors[iChannel], translate, quaternion, scale);
 
+                XMFLOAT4 rotation;
+                XMStoreFloat4(&rotation, quaternion);
+                if (k > 0u)
+                {
+                    const FLOAT* pPrevious = pLanes - uStride * 4u + ModelAnimationStream::ROTATION * 4u;
+                    if (pPrevious[0] * rotation.x + pPrevious[4] * rotation.y + pPrevious[8] * rotation.z + pPrevious[12] * rotation.w < 0.0f)
+                    {
+                        rotation = XMFLOAT4(-rotation.x, -rotation.y, -rotation.z, -rotation.w);
+                    }
+                }
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Model::getVertices
-      Summary:  Returns the vertices data
-      Returns:  const SimpleVertex*
-                  Array of vertices
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    const SimpleVertex* Model::getVertices() const
-    {
-        return m_aVertices.data();
+                storeLanes(pLanes, translate, rotation, scale);
+            }
+        }
     }
 
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Model::getIndices
-      Summary:  Returns the indices data
-      Returns:  const WORD*
-                  Array of indices
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    const WORD* Model::getIndices() const
-    {
-        return m_aIndices.data();
-    }
+      Method:   Model::initBindPose
 
+      Summary:  Decomposes the bind transform of every node of the
+                skeleton into the lanes of a key of the streams. Lanes
+                past the last node hold the identity
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Model::initAllMeshes
-      Summary:  Initialize all meshes in a given assimp scene
-      Args:     const aiScene* pScene
-                  Assimp scene
+      Modifies: [m_aBindPoses].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::initAllMeshes(_In_ const aiScene* pScene)
+    void Model::initBindPose()
     {
-        for (UINT i = 0u; i < m_aMeshes.size(); ++i)
+        const size_t uNumNodes = m_skeleton.aParents.size();
+        const size_t uNumBlocks = (uNumNodes + 3u) / 4u;
+        m_aBindPoses.assign(uNumBlocks * ModelAnimationStream::NUM_COMPONENTS, XMVectorZero());
+
+        FLOAT* pBindPoses = reinterpret_cast<FLOAT*>(m_aBindPoses.data());
+        for (size_t uNode = 0u; uNode < uNumBlocks * 4u; ++uNode)
         {
-            const aiMesh* pMesh = pScene->mMeshes[i];
-            initSingleMesh(i, pMesh);
+            XMFLOAT3 translate(0.0f, 0.0f, 0.0f);
+            XMFLOAT4 rotation(0.0f, 0.0f, 0.0f, 1.0f);
+            XMFLOAT3 scale(1.0f, 1.0f, 1.0f);
+            XMVECTOR scaleVector;
+            XMVECTOR rotationQuaternion;
+            XMVECTOR translateVector;
+            if (uNode < uNumNodes &&
+                XMMatrixDecompose(&scaleVector, &rotationQuaternion, &translateVector, XMLoadFloat4x4(&m_skeleton.aLocalTransforms[uNode])))
+            {
+                XMStoreFloat3(&translate, translateVector);
+                XMStoreFloat4(&rotation, rotationQuaternion);
+                XMStoreFloat3(&scale, scaleVector);
+            }
+
+            storeLanes(pBindPoses + (uNode / 4u) * ModelAnimationStream::NUM_COMPONENTS * 4u + uNode % 4u, translate, rotation, scale);
         }
     }
 
@@ -498,11 +1555,7 @@ namespace library
 
       Summary:  Initialize all meshes in a given assimp scene
 
-      Args:     ID3D11Device* pDevice
-                  The Direct3D device to create the buffers
-                ID3D11DeviceContext* pImmediateContext
-                  The Direct3D context to set buffers
-                const aiScene* pScene
+      Args:     const aiScene* pScene
                   Assimp scene
                 const std::filesystem::path& filePath
                   Path to the model
@@ -511,8 +1564,6 @@ namespace library
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Model::initFromScene(
-        _In_ ID3D11Device* pDevice,
-        _In_ ID3D11DeviceContext* pImmediateContext,
         _In_ const aiScene* pScene,
         _In_ const std::filesystem::path& filePath
     )
@@ -530,7 +1581,7 @@ namespace library
 
         initAllMeshes(pScene);
 
-        hr = initMaterials(pDevice, pImmediateContext, pScene, filePath);
+        hr = initMaterials(pScene, filePath);
         if (FAILED(hr))
         {
             return hr;
@@ -547,12 +1598,6 @@ namespace library
             );
         }
 
-        hr = initialize(pDevice, pImmediateContext);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-
         return hr;
     }
 
@@ -562,11 +1607,7 @@ namespace library
 
       Summary:  Initialize all materials in a given assimp scene
 
-      Args:     ID3D11Device* pDevice
-                  The Direct3D device to create the buffers
-                ID3D11DeviceContext* pImmediateContext
-                  The Direct3D context to set buffers
-                const aiScene* pScene
+      Args:     const aiScene* pScene
                   Assimp scene
                 const std::filesystem::path& filePath
                   Path to the model
@@ -575,8 +1616,6 @@ namespace library
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Model::initMaterials(
-        _In_ ID3D11Device* pDevice,
-        _In_ ID3D11DeviceContext* pImmediateContext,
         _In_ const aiScene* pScene,
         _In_ const std::filesystem::path& filePath
     )
@@ -596,7 +1635,7 @@ namespace library
             std::copy(szName.begin(), szName.end(), pwszName.begin());
             m_aMaterials.push_back(std::make_shared<Material>(pwszName));
 
-            loadTextures(pDevice, pImmediateContext, parentDirectory, pMaterial, i);
+            loadTextures(parentDirectory, pMaterial, i);
         }
 
         return hr;
@@ -703,6 +1742,53 @@ namespace library
         initMeshBones(uMeshIndex, pMesh);
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::initSkeleton
+
+      Summary:  Flattens the node hierarchy of a given assimp scene in
+                depth-first order, so that every parent comes before
+                its children, and looks up once the bone moved by every
+                node
+
+      Args:     const aiScene* pScene
+                  Assimp scene
+
+      Modifies: [m_skeleton, m_aGlobalTransforms].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::initSkeleton(_In_ const aiScene* pScene)
+    {
+        m_skeleton = ModelSkeleton();
+        if (!pScene->mRootNode)
+        {
+            return;
+        }
+
+        std::vector<std::pair<const aiNode*, INT>> aStack = { { pScene->mRootNode, -1 } };
+        while (!aStack.empty())
+        {
+            auto [pNode, iParent] = aStack.back();
+            aStack.pop_back();
+
+            INT iNode = static_cast<INT>(m_skeleton.aParents.size());
+            XMFLOAT4X4 localTransform;
+            XMStoreFloat4x4(&localTransform, ConvertMatrix(pNode->mTransformation));
+            auto itBone = m_boneNameToIndexMap.find(pNode->mName.C_Str());
+
+            m_skeleton.aParents.push_back(iParent);
+            m_skeleton.aLocalTransforms.push_back(localTransform);
+            m_skeleton.aBoneSlots.push_back(itBone != m_boneNameToIndexMap.end() ? static_cast<INT>(itBone->second) : -1);
+            m_skeleton.aNames.push_back(pNode->mName.C_Str());
+
+            // Children are pushed in reverse to be visited in order
+            for (UINT i = pNode->mNumChildren; i > 0u; --i)
+            {
+                aStack.push_back({ pNode->mChildren[i - 1u], iNode });
+            }
+        }
+
+        m_aGlobalTransforms.resize(m_skeleton.aParents.size());
+    }
+
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::interpolatePosition
@@ -711,30 +1797,36 @@ namespace library
                   Translate vector
                 FLOAT animationTimeTicks
                   Animation time
-                const aiNodeAnim* pNodeAnim
-                  Pointer to an assimp node anim object
+                const ModelAnimationChannel& channel
+                  Keys of the node
+                KeyCursor& cursor
+                  Keys found for the previous frame
+      Modifies: [cursor].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::interpolatePosition(_Inout_ XMFLOAT3& outTranslate, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    void Model::interpolatePosition(_Inout_ XMFLOAT3& outTranslate, _In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ KeyCursor& cursor)
     {
-        if (pNodeAnim->mNumPositionKeys == 1)
+        if (channel.aPositionKeys.size() == 1)
         {
-            outTranslate = ConvertVector3dToFloat3(pNodeAnim->mPositionKeys[0].mValue);
+            outTranslate = channel.aPositionKeys[0].Value;
             return;
         }
 
-        UINT uPositionIndex = findPosition(animationTimeTicks, pNodeAnim);
+        UINT uPositionIndex = findPosition(animationTimeTicks, channel, cursor.uPosition);
         UINT uNextPositionIndex = uPositionIndex + 1u;
-        assert(uNextPositionIndex < pNodeAnim->mNumPositionKeys);
+        assert(uNextPositionIndex < channel.aPositionKeys.size());
 
-        FLOAT t1 = static_cast<FLOAT>(pNodeAnim->mPositionKeys[uPositionIndex].mTime);
-        FLOAT t2 = static_cast<FLOAT>(pNodeAnim->mPositionKeys[uNextPositionIndex].mTime);
+        FLOAT t1 = channel.aPositionKeys[uPositionIndex].Time;
+        FLOAT t2 = channel.aPositionKeys[uNextPositionIndex].Time;
         FLOAT deltaTime = t2 - t1;
         FLOAT factor = (animationTimeTicks - t1) / deltaTime;
         assert(factor >= 0.0f && factor <= 1.0f);
-        const aiVector3D& start = pNodeAnim->mPositionKeys[uPositionIndex].mValue;
-        const aiVector3D& end = pNodeAnim->mPositionKeys[uNextPositionIndex].mValue;
-        aiVector3D delta = end - start;
-        outTranslate = ConvertVector3dToFloat3(start + factor * delta);
+        const XMFLOAT3& start = channel.aPositionKeys[uPositionIndex].Value;
+        const XMFLOAT3& end = channel.aPositionKeys[uNextPositionIndex].Value;
+        outTranslate = XMFLOAT3(
+            start.x + factor * (end.x - start.x),
+            start.y + factor * (end.y - start.y),
+            start.z + factor * (end.z - start.z)
+        );
     }
 
 
@@ -745,29 +1837,34 @@ namespace library
                   Quaternion vector
                 FLOAT animationTimeTicks
                   Animation time
-                const aiNodeAnim* pNodeAnim
-                  Pointer to an assimp node anim object
+                const ModelAnimationChannel& channel
+                  Keys of the node
+                KeyCursor& cursor
+                  Keys found for the previous frame
+      Modifies: [cursor].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::interpolateRotation(_Inout_ XMVECTOR& outQuaternion, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    void Model::interpolateRotation(_Inout_ XMVECTOR& outQuaternion, _In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ KeyCursor& cursor)
     {
         aiQuaternion ret;
-        if (pNodeAnim->mNumRotationKeys == 1)
+        if (channel.aRotationKeys.size() == 1)
         {
-            outQuaternion = ConvertQuaternionToVector(pNodeAnim->mRotationKeys[0].mValue);
+            outQuaternion = XMLoadFloat4(&channel.aRotationKeys[0].Value);
             return;
         }
 
-        UINT uRotationIndex = findRotation(animationTimeTicks, pNodeAnim);
+        UINT uRotationIndex = findRotation(animationTimeTicks, channel, cursor.uRotation);
         UINT uNextRotationIndex = uRotationIndex + 1u;
-        assert(uNextRotationIndex < pNodeAnim->mNumRotationKeys);
+        assert(uNextRotationIndex < channel.aRotationKeys.size());
 
-        FLOAT t1 = static_cast<FLOAT>(pNodeAnim->mRotationKeys[uRotationIndex].mTime);
-        FLOAT t2 = static_cast<FLOAT>(pNodeAnim->mRotationKeys[uNextRotationIndex].mTime);
+        FLOAT t1 = channel.aRotationKeys[uRotationIndex].Time;
+        FLOAT t2 = channel.aRotationKeys[uNextRotationIndex].Time;
         FLOAT deltaTime = t2 - t1;
         FLOAT factor = (animationTimeTicks - t1) / deltaTime;
         assert(factor >= 0.0f && factor <= 1.0f);
-        const aiQuaternion& start = pNodeAnim->mRotationKeys[uRotationIndex].mValue;
-        const aiQuaternion& end = pNodeAnim->mRotationKeys[uNextRotationIndex].mValue;
+        const XMFLOAT4& startValue = channel.aRotationKeys[uRotationIndex].Value;
+        const XMFLOAT4& endValue = channel.aRotationKeys[uNextRotationIndex].Value;
+        const aiQuaternion start(startValue.w, startValue.x, startValue.y, startValue.z);
+        const aiQuaternion end(endValue.w, endValue.x, endValue.y, endValue.z);
 
         aiQuaternion::Interpolate(ret, start, end, factor);
         ret.Normalize();
@@ -782,41 +1879,43 @@ namespace library
                   Scaling vector
                 FLOAT animationTimeTicks
                   Animation time
-                const aiNodeAnim* pNodeAnim
-                  Pointer to an assimp node anim object
+                const ModelAnimationChannel& channel
+                  Keys of the node
+                KeyCursor& cursor
+                  Keys found for the previous frame
+      Modifies: [cursor].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::interpolateScaling(_Inout_ XMFLOAT3& outScale, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    void Model::interpolateScaling(_Inout_ XMFLOAT3& outScale, _In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ KeyCursor& cursor)
     {
-        if (pNodeAnim->mNumScalingKeys == 1)
+        if (channel.aScalingKeys.size() == 1)
         {
-            outScale = ConvertVector3dToFloat3(pNodeAnim->mScalingKeys[0].mValue);
+            outScale = channel.aScalingKeys[0].Value;
             return;
         }
 
-        UINT uScalingIndex = findPosition(animationTimeTicks, pNodeAnim);
+        UINT uScalingIndex = findScaling(animationTimeTicks, channel, cursor.uScaling);
         UINT uNextScalingIndex = uScalingIndex + 1u;
-        assert(uNextScalingIndex < pNodeAnim->mNumScalingKeys);
+        assert(uNextScalingIndex < channel.aScalingKeys.size());
 
-        FLOAT t1 = static_cast<FLOAT>(pNodeAnim->mScalingKeys[uScalingIndex].mTime);
-        FLOAT t2 = static_cast<FLOAT>(pNodeAnim->mScalingKeys[uNextScalingIndex].mTime);
+        FLOAT t1 = channel.aScalingKeys[uScalingIndex].Time;
+        FLOAT t2 = channel.aScalingKeys[uNextScalingIndex].Time;
         FLOAT deltaTime = t2 - t1;
         FLOAT factor = (animationTimeTicks - t1) / deltaTime;
         assert(factor >= 0.0f && factor <= 1.0f);
-        const aiVector3D& start = pNodeAnim->mScalingKeys[uScalingIndex].mValue;
-        const aiVector3D& end = pNodeAnim->mScalingKeys[uNextScalingIndex].mValue;
-        aiVector3D delta = end - start;
-        outScale = ConvertVector3dToFloat3(start + factor * delta);
+        const XMFLOAT3& start = channel.aScalingKeys[uScalingIndex].Value;
+        const XMFLOAT3& end = channel.aScalingKeys[uNextScalingIndex].Value;
+        outScale = XMFLOAT3(
+            start.x + factor * (end.x - start.x),
+            start.y + factor * (end.y - start.y),
+            start.z + factor * (end.z - start.z)
+        );
     }
 
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::loadDiffuseTexture
-      Summary:  Load a diffuse texture from given path
-      Args:     ID3D11Device* pDevice
-                  The Direct3D device to create the buffers
-                ID3D11DeviceContext* pImmediateContext
-                  The Direct3D context to set buffers
-                const std::filesystem::path& parentDirectory
+      Summary:  Decode a diffuse texture from given path
+      Args:     const std::filesystem::path& parentDirectory
                   Parent path to the model
                 const aiMaterial* pMaterial
                   Pointer to an assimp material object
@@ -824,8 +1923,6 @@ namespace library
                   Index to a material
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Model::loadDiffuseTexture(
-        _In_ ID3D11Device* pDevice,
-        _In_ ID3D11DeviceContext* pImmediateContext,
         _In_ const std::filesystem::path& parentDirectory,
         _In_ const aiMaterial* pMaterial,
         _In_ UINT uIndex
@@ -851,7 +1948,7 @@ namespace library
 
                 m_aMaterials[uIndex]->pDiffuse = std::make_shared<Texture>(fullPath);
 
-                hr = m_aMaterials[uIndex]->pDiffuse->Initialize(pDevice, pImmediateContext);
+                hr = m_aMaterials[uIndex]->pDiffuse->Load();
                 if (FAILED(hr))
                 {
                     OutputDebugString(L"Error loading diffuse texture \"");
@@ -873,12 +1970,8 @@ namespace library
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
        Method:   Model::loadSpecularTexture
-       Summary:  Load a specular texture from given path
-       Args:     ID3D11Device* pDevice
-                   The Direct3D device to create the buffers
-                 ID3D11DeviceContext* pImmediateContext
-                   The Direct3D context to set buffers
-                 const std::filesystem::path& parentDirectory
+       Summary:  Decode a specular texture from given path
+       Args:     const std::filesystem::path& parentDirectory
                    Parent path to the model
                  const aiMaterial* pMaterial
                    Pointer to an assimp material object
@@ -886,8 +1979,6 @@ namespace library
                    Index to a material
      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Model::loadSpecularTexture(
-        _In_ ID3D11Device* pDevice,
-        _In_ ID3D11DeviceContext* pImmediateContext,
         _In_ const std::filesystem::path& parentDirectory,
         _In_ const aiMaterial* pMaterial,
         _In_ UINT uIndex
@@ -913,7 +2004,7 @@ namespace library
 
                 m_aMaterials[uIndex]->pSpecularExponent = std::make_shared<Texture>(fullPath);
 
-                hr = m_aMaterials[uIndex]->pSpecularExponent->Initialize(pDevice, pImmediateContext);
+                hr = m_aMaterials[uIndex]->pSpecularExponent->Load();
                 if (FAILED(hr))
                 {
                     OutputDebugString(L"Error loading specular texture \"");
@@ -936,20 +2027,16 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::loadNormalTexture
 
-      Summary:  Load a normal texture from given path
+      Summary:  Decode a normal texture from given path
 
-      Args:     ID3D11Device* pDevice
-                  The Direct3D device to create the buffers
-                ID3D11DeviceContext* pImmediateContext
-                  The Direct3D context to set buffers
-                const std::filesystem::path& parentDirectory
+      Args:     const std::filesystem::path& parentDirectory
                   Parent path to the model
                 const aiMaterial* pMaterial
                   Pointer to an assimp material object
                 UINT uIndex
                   Index to a material
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    HRESULT Model::loadNormalTexture(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext, _In_ const std::filesystem::path& parentDirectory, _In_ const aiMaterial* pMaterial, _In_ UINT uIndex)
+    HRESULT Model::loadNormalTexture(_In_ const std::filesystem::path& parentDirectory, _In_ const aiMaterial* pMaterial, _In_ UINT uIndex)
     {
         HRESULT hr = S_OK;
         m_aMaterials[uIndex]->pNormal = nullptr;
@@ -972,6 +2059,7 @@ namespace library
                 m_aMaterials[uIndex]->pNormal = std::make_shared<Texture>(fullPath);
                 m_bHasNormalMap = true;
 
+                hr = m_aMaterials[uIndex]->pNormal->Load();
                 if (FAILED(hr))
                 {
                     OutputDebugString(L"Error loading normal texture \"");
@@ -996,32 +2084,28 @@ namespace library
 
       Summary:  Load a specular texture from given path
 
-      Args:     ID3D11Device* pDevice
-                  The Direct3D device to create the buffers
-                ID3D11DeviceContext* pImmediateContext
-                  The Direct3D context to set buffers
-                const std::filesystem::path& parentDirectory
+      Args:     const std::filesystem::path& parentDirectory
                   Parent path to the model
                 const aiMaterial* pMaterial
                   Pointer to an assimp material object
                 UINT uIndex
                   Index to a material
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    HRESULT Model::loadTextures(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext, _In_ const std::filesystem::path& parentDirectory, _In_ const aiMaterial* pMaterial, _In_ UINT uIndex)
+    HRESULT Model::loadTextures(_In_ const std::filesystem::path& parentDirectory, _In_ const aiMaterial* pMaterial, _In_ UINT uIndex)
     {
-        HRESULT hr = loadDiffuseTexture(pDevice, pImmediateContext, parentDirectory, pMaterial, uIndex);
+        HRESULT hr = loadDiffuseTexture(parentDirectory, pMaterial, uIndex);
         if (FAILED(hr))
         {
             return hr;
         }
 
-        hr = loadSpecularTexture(pDevice, pImmediateContext, parentDirectory, pMaterial, uIndex);
+        hr = loadSpecularTexture(parentDirectory, pMaterial, uIndex);
         if (FAILED(hr))
         {
             return hr;
         }
 
-        hr = loadNormalTexture(pDevice, pImmediateContext, parentDirectory, pMaterial, uIndex);
+        hr = loadNormalTexture(parentDirectory, pMaterial, uIndex);
         if (FAILED(hr))
         {
             return hr;
@@ -1032,70 +2116,258 @@ namespace library
 
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Model::readNodeHierarchy
-      Summary:  Calculate bone transformation of the given assimp node
-      Args:     FLOAT animationTimeTicks
+      Method:   Model::reserveSpace
+      Summary:  Reserve space for vertices and indices vectors
+      Args:     UINT uNumVertices
+                  Number of vertices
+                UINT uNumIndices
+                  Number of indices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::reserveSpace(_In_ UINT uNumVertices, _In_ UINT uNumIndices)
+    {
+        m_aVertices.reserve(uNumVertices);
+        m_aIndices.reserve(uNumIndices);
+        m_aBoneData.resize(uNumVertices);
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::sampleChannel
+      Summary:  Interpolate the keys of a channel at a time, holding the
+                first and the last keys outside of them. A component
+                without keys keeps the bind transform of the node
+      Args:     const ModelAnimationChannel& channel
+                  Keys of the node
+                const FLOAT* pBindLanes
+                  Lane of the node in the bind poses, or nullptr for a
+                  channel that moves no node of the skeleton, which
+                  then falls back to the identity
+                FLOAT animationTimeTicks
                   Animation time
-               const aiNode* pNode
-                  Pointer to an assimp node object
-                const XMMATRIX& parentTransform
-                  Parent transform in hierarchy
+                KeyCursor& cursor
+                  Keys found for the previous sample
+                XMFLOAT3& outTranslate
+                  Translate vector
+                XMVECTOR& outQuaternion
+                  Quaternion vector
+                XMFLOAT3& outScale
+                  Scaling vector
+      Modifies: [cursor].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::readNodeHierarchy(
+    void Model::sampleChannel(
+        _In_ const ModelAnimationChannel& channel,
+        _In_opt_ const FLOAT* pBindLanes,
         _In_ FLOAT animationTimeTicks,
-        _In_ const aiNode* pNode,
-        _In_ const XMMATRIX& parentTransform)
+        _Inout_ KeyCursor& cursor,
+        _Out_ XMFLOAT3& outTranslate,
+        _Out_ XMVECTOR& outQuaternion,
+        _Out_ XMFLOAT3& outScale)
+    {
+        if (channel.aPositionKeys.empty())
+        {
+            outTranslate = pBindLanes ? XMFLOAT3(
+                pBindLanes[ModelAnimationStream::POSITION * 4u],
+                pBindLanes[(ModelAnimationStream::POSITION + 1u) * 4u],
+                pBindLanes[(ModelAnimationStream::POSITION + 2u) * 4u]
+            ) : XMFLOAT3(0.0f, 0.0f, 0.0f);
+        }
+        else if (animationTimeTicks <= channel.aPositionKeys.front().Time || animationTimeTicks >= channel.aPositionKeys.back().Time)
+        {
+            outTranslate = animationTimeTicks <= channel.aPositionKeys.front().Time ? channel.aPositionKeys.front().Value : channel.aPositionKeys.back().Value;
+        }
+        else
+        {
+            interpolatePosition(outTranslate, animationTimeTicks, channel, cursor);
+        }
+
+        if (channel.aRotationKeys.empty())
+        {
+            outQuaternion = pBindLanes ? XMVectorSet(
+                pBindLanes[ModelAnimationStream::ROTATION * 4u],
+                pBindLanes[(ModelAnimationStream::ROTATION + 1u) * 4u],
+                pBindLanes[(ModelAnimationStream::ROTATION + 2u) * 4u],
+                pBindLanes[(ModelAnimationStream::ROTATION + 3u) * 4u]
+            ) : XMQuaternionIdentity();
+        }
+        else if (animationTimeTicks <= channel.aRotationKeys.front().Time || animationTimeTicks >= channel.aRotationKeys.back().Time)
+        {
+            outQuaternion = XMLoadFloat4(animationTimeTicks <= channel.aRotationKeys.front().Time ? &channel.aRotationKeys.front().Value : &channel.aRotationKeys.back().Value);
+        }
+        else
+        {
+            interpolateRotation(outQuaternion, animationTimeTicks, channel, cursor);
+        }
+
+        if (channel.aScalingKeys.empty())
+        {
+            outScale = pBindLanes ? XMFLOAT3(
+                pBindLanes[ModelAnimationStream::SCALING * 4u],
+                pBindLanes[(ModelAnimationStream::SCALING + 1u) * 4u],
+                pBindLanes[(ModelAnimationStream::SCALING + 2u) * 4u]
+            ) : XMFLOAT3(1.0f, 1.0f, 1.0f);
+        }
+        else if (animationTimeTicks <= channel.aScalingKeys.front().Time || animationTimeTicks >= channel.aScalingKeys.back().Time)
+        {
+            outScale = animationTimeTicks <= channel.aScalingKeys.front().Time ? channel.aScalingKeys.front().Value : channel.aScalingKeys.back().Value;
+        }
+        else
+        {
+            interpolateScaling(outScale, animationTimeTicks, channel, cursor);
+        }
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::sampleChannels
+      Summary:  Interpolate the local pose of every channel of an
+                animation one channel at a time into the lanes of the
+                nodes they move, the other nodes taking their bind pose
+      Args:     const ModelAnimation& animation
+                  Animation to sample
+                FLOAT animationTimeTicks
+                  Animation time
+      Modifies: [m_aKeyCursors, m_aLocalPoses].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::sampleChannels(_In_ const ModelAnimation& animation, _In_ FLOAT animationTimeTicks)
     {
-        XMMATRIX nodeTransformation = ConvertMatrix(pNode->mTransformation);
-        const aiNodeAnim* pNodeAnim = findNodeAnimOrNull(m_pScene->mAnimations[0], pNode->mName.C_Str());
-        if (pNodeAnim)
+        std::copy(m_aBindPoses.begin(), m_aBindPoses.end(), m_aLocalPoses.begin());
+
+        const FLOAT* pBindPoses = reinterpret_cast<const FLOAT*>(m_aBindPoses.data());
+        FLOAT* pLocalPoses = reinterpret_cast<FLOAT*>(m_aLocalPoses.data());
+        for (size_t uNode = 0u; uNode < animation.aNodeChannels.size(); ++uNode)
         {
+            INT iChannel = animation.aNodeChannels[uNode];
+            if (iChannel < 0)
+            {
+                continue;
+            }
+
+            XMFLOAT3 translate;
+            XMVECTOR quaternion;
+            XMFLOAT3 scale;
+            const size_t uLane = (uNode / 4u) * ModelAnimationStream::NUM_COMPONENTS * 4u + uNode % 4u;
+            sampleChannel(animation.aChannels[iChannel], pBindPoses + uLane, animationTimeTicks, m_aKeyCursors[iChannel], translate, quaternion, scale);
+
+            XMFLOAT4 rotation;
+            XMStoreFloat4(&rotation, quaternion);
+            storeLanes(pLocalPoses + uLane, translate, rotation, scale);
+        }
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::getSceneMemoryUsage
 
-            XMMATRIX scalingMatrix = XMMATRIX();
-            XMFLOAT3 outScaling = XMFLOAT3();
-            interpolateScaling(outScaling, animationTimeTicks, pNodeAnim);
-            scalingMatrix = XMMatrixScaling(outScaling.x, outScaling.y, outScaling.z);
+      Summary:  Returns the approximate size of an Assimp scene: its
+                meshes, materials, embedded textures, animations and
+                nodes
 
-            XMMATRIX rotationMatrix = XMMATRIX();
-            XMVECTOR outQuaternion = XMVECTOR();
-            interpolateRotation(outQuaternion, animationTimeTicks, pNodeAnim);
-            rotationMatrix = XMMatrixRotationQuaternion(outQuaternion);
+      Args:     const aiScene* pScene
+                  Assimp scene
+
+      Returns:  UINT64
+                  Size in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 Model::getSceneMemoryUsage(_In_ const aiScene* pScene)
+    {
+        UINT64 ullBytes = sizeof(aiScene);
+
+        for (UINT i = 0u; i < pScene->mNumMeshes; ++i)
+        {
+            const aiMesh* pMesh = pScene->mMeshes[i];
+            UINT64 ullNumVertices = pMesh->mNumVertices;
+            UINT uNumStreams = (pMesh->mVertices ? 1u : 0u) + (pMesh->mNormals ? 1u : 0u) + (pMesh->mTangents ? 1u : 0u) + (pMesh->mBitangents ? 1u : 0u);
+            for (UINT j = 0u; j < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++j)
+            {
+                uNumStreams += pMesh->mTextureCoords[j] ? 1u : 0u;
+            }
+            ullBytes += sizeof(aiMesh) + ullNumVertices * uNumStreams * sizeof(aiVector3D);
+            for (UINT j = 0u; j < AI_MAX_NUMBER_OF_COLOR_SETS; ++j)
+            {
+                ullBytes += pMesh->mColors[j] ? ullNumVertices * sizeof(aiColor4D) : 0ull;
+            }
+            for (UINT j = 0u; j < pMesh->mNumFaces; ++j)
+            {
+                ullBytes += sizeof(aiFace) + pMesh->mFaces[j].mNumIndices * sizeof(UINT);
+            }
+            for (UINT j = 0u; j < pMesh->mNumBones; ++j)
+            {
+                ullBytes += sizeof(aiBone) + pMesh->mBones[j]->mNumWeights * sizeof(aiVertexWeight);
+            }
+        }
 
-            XMMATRIX translationMatrix = XMMATRIX();
-            XMFLOAT3 outTranslate = XMFLOAT3();
-            interpolatePosition(outTranslate, animationTimeTicks, pNodeAnim);
-            translationMatrix = XMMatrixTranslation(outTranslate.x, outTranslate.y, outTranslate.z);
+        for (UINT i = 0u; i < pScene->mNumMaterials; ++i)
+        {
+            const aiMaterial* pMaterial = pScene->mMaterials[i];
+            ullBytes += sizeof(aiMaterial);
+            for (UINT j = 0u; j < pMaterial->mNumProperties; ++j)
+            {
+                ullBytes += sizeof(aiMaterialProperty) + pMaterial->mProperties[j]->mDataLength;
+            }
+        }
 
-            nodeTransformation = scalingMatrix * rotationMatrix * translationMatrix;
+        for (UINT i = 0u; i < pScene->mNumTextures; ++i)
+        {
+            const aiTexture* pTexture = pScene->mTextures[i];
+            ullBytes += sizeof(aiTexture) + (pTexture->mHeight > 0u ? static_cast<UINT64>(pTexture->mWidth) * pTexture->mHeight * sizeof(aiTexel) : pTexture->mWidth);
         }
-        XMMATRIX globalTransformation = nodeTransformation * parentTransform;
 
-        if (m_boneNameToIndexMap.count(pNode->mName.C_Str()) > 0)
+        for (UINT i = 0u; i < pScene->mNumAnimations; ++i)
         {
-            UINT boneIndex = m_boneNameToIndexMap.find(pNode->mName.C_Str())->second;
-            m_aBoneInfo[boneIndex].FinalTransformation = m_aBoneInfo[boneIndex].OffsetMatrix * globalTransformation * m_globalInverseTransform;
+            const aiAnimation* pAnimation = pScene->mAnimations[i];
+            ullBytes += sizeof(aiAnimation);
+            for (UINT j = 0u; j < pAnimation->mNumChannels; ++j)
+            {
+                const aiNodeAnim* pNodeAnim = pAnimation->mChannels[j];
+                ullBytes += sizeof(aiNodeAnim) +
+                    (static_cast<UINT64>(pNodeAnim->mNumPositionKeys) + pNodeAnim->mNumScalingKeys) * sizeof(aiVectorKey) +
+                    static_cast<UINT64>(pNodeAnim->mNumRotationKeys) * sizeof(aiQuatKey);
+            }
         }
 
-        for (UINT i = 0u; i < pNode->mNumChildren; ++i)
+        std::vector<const aiNode*> aNodes;
+        if (pScene->mRootNode)
+        {
+            aNodes.push_back(pScene->mRootNode);
+        }
+        while (!aNodes.empty())
         {
-            readNodeHierarchy(animationTimeTicks, pNode->mChildren[i], globalTransformation);
+            const aiNode* pNode = aNodes.back();
+            aNodes.pop_back();
+            ullBytes += sizeof(aiNode) + pNode->mNumChildren * sizeof(aiNode*) + pNode->mNumMeshes * sizeof(UINT);
+            aNodes.insert(aNodes.end(), pNode->mChildren, pNode->mChildren + pNode->mNumChildren);
         }
+
+        return ullBytes;
     }
 
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Model::reserveSpace
-      Summary:  Reserve space for vertices and indices vectors
-      Args:     UINT uNumVertices
-                  Number of vertices
-                UINT uNumIndices
-                  Number of indices
+      Method:   Model::storeLanes
+
+      Summary:  Writes the local pose of a node into its lane of a
+                block of four nodes
+
+      Args:     FLOAT* pLanes
+                  First component of the lane
+                const XMFLOAT3& translate
+                  Translate vector
+                const XMFLOAT4& rotation
+                  Rotation quaternion
+                const XMFLOAT3& scale
+                  Scale vector
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::reserveSpace(_In_ UINT uNumVertices, _In_ UINT uNumIndices)
+    void Model::storeLanes(_Out_ FLOAT* pLanes, _In_ const XMFLOAT3& translate, _In_ const XMFLOAT4& rotation, _In_ const XMFLOAT3& scale)
     {
-        m_aVertices.reserve(uNumVertices);
-        m_aIndices.reserve(uNumIndices);
-        m_aBoneData.resize(uNumVertices);
+        const FLOAT aComponents[ModelAnimationStream::NUM_COMPONENTS] =
+        {
+            translate.x, translate.y, translate.z,
+            rotation.x, rotation.y, rotation.z, rotation.w,
+            scale.x, scale.y, scale.z
+        };
+        for (UINT uComponent = 0u; uComponent < ModelAnimationStream::NUM_COMPONENTS; ++uComponent)
+        {
+            pLanes[uComponent * 4u] = aComponents[uComponent];
+        }
     }
-
 }
\ No newline at end of file
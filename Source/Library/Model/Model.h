@@ -12,6 +12,9 @@
 #pragma once
 
 #include "Common.h"
+#include "Game/Benchmark.h"
+#include "Model/AnimationPlayer.h"
+#include "Model/PoseCache.h"
 #include "Renderer/DataTypes.h"
 #include "Renderer/Renderable.h"
 #include "Shader/PixelShader.h"
@@ -26,13 +29,131 @@ struct aiBone;
 struct aiNode;
 struct aiNodeAnim;
 
-namespace Assimp
-{
-    class Importer;
-}
-
 namespace library
 {
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelMeshEntry
+
+        Summary:  Range of indices and base vertex of one mesh of a
+                  model, and the index of its material
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelMeshEntry
+    {
+        UINT uNumIndices;
+        UINT uBaseVertex;
+        UINT uBaseIndex;
+        UINT uMaterialIndex;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelMaterialTextures
+
+        Summary:  Paths of the textures of one material of a model, empty
+                  when the material has no such texture
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelMaterialTextures
+    {
+        std::filesystem::path DiffusePath;
+        std::filesystem::path SpecularPath;
+        std::filesystem::path NormalPath;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelGeometry
+
+        Summary:  CPU side state of a model once its file is imported:
+                  the vertices with their bone indices and weights and
+                  their tangent frames, the indices, the meshes and the
+                  textures of the materials
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelGeometry
+    {
+        std::vector<SimpleVertex> aVertices;
+        std::vector<AnimationData> aAnimationData;
+        std::vector<NormalData> aNormalData;
+        std::vector<WORD> aIndices;
+        std::vector<ModelMeshEntry> aMeshes;
+        std::vector<ModelMaterialTextures> aMaterials;
+        BOOL bHasNormalMap;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelSkeleton
+
+        Summary:  Node hierarchy of a model flattened so that every
+                  parent comes before its children: the index of the
+                  parent of every node or -1 for the root, its transform
+                  relative to the parent in the bind pose, the bone it
+                  moves or -1, its name, and whether any animation
+                  moves it
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelSkeleton
+    {
+        std::vector<INT> aParents;
+        std::vector<XMFLOAT4X4> aLocalTransforms;
+        std::vector<INT> aBoneSlots;
+        std::vector<std::string> aNames;
+        std::vector<BOOL> abAnimated;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelAnimationStats
+
+        Summary:  Size of the skeleton and the animations kept after the
+                  import against the Assimp scene they replace, and the
+                  cost of a pose update walking the flat skeleton. Then
+                  the size of the key streams, the throughput of sampling
+                  them four channels at a time against interpolating
+                  one channel at a time in bones per microsecond, the
+                  largest difference of their rotations in radians and
+                  of their translations, and whether the rotations
+                  stayed within NLERP_TOLERANCE. Last, the cost of
+                  sampling one clip against blending layers of clips in
+                  microseconds per pose, and whether a single layer of
+                  the animation player gave the pose of its clip
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelAnimationStats
+    {
+        UINT uNumNodes;
+        UINT uNumBones;
+        UINT uNumChannels;
+        UINT uNumKeys;
+        UINT64 ullAnimationBytes;
+        UINT64 ullSceneBytes;
+        UINT uNumFrames;
+        FLOAT MicrosecondsPerUpdate;
+        UINT uNumStreamTimes;
+        UINT64 ullStreamBytes;
+        FLOAT StreamBonesPerMicrosecond;
+        FLOAT ChannelBonesPerMicrosecond;
+        FLOAT MaxRotationError;
+        FLOAT MaxTranslationError;
+        BOOL bWithinTolerance;
+        UINT uNumBlendLayers;
+        FLOAT SampleMicrosecondsPerPose;
+        FLOAT BlendMicrosecondsPerPose;
+        BOOL bBlendIdentical;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelKeyLookupStats
+
+        Summary:  Cost of finding the keys around the time of a frame
+                  in nanoseconds, scanning from the first key against
+                  advancing a cached cursor, for clips of growing
+                  length, and whether both found the same keys
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelKeyLookupStats
+    {
+        static constexpr const UINT NUM_CLIP_LENGTHS = 6u;
+
+        UINT auNumKeys[NUM_CLIP_LENGTHS];
+        FLOAT aLinearNanosecondsPerLookup[NUM_CLIP_LENGTHS];
+        FLOAT aCursorNanosecondsPerLookup[NUM_CLIP_LENGTHS];
+        UINT uNumFrames;
+        BOOL bIdentical;
+    };
+
     /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
       Class:    Model
 
@@ -40,6 +161,8 @@ namespace library
 
       Methods:  Initialize
                   Pure virtual function that initializes the object
+                Load
+                  Imports the model file without the device
                 Update
                   Pure virtual function that updates the object each
                   frame
@@ -57,6 +180,26 @@ namespace library
                 GetNumIndices
                   Pure virtual function that returns the number of
                   indices
+                ExportGeometry
+                  Copies the imported geometry of a static model
+                RestoreGeometry
+                  Takes geometry saved earlier so that Initialize
+                  skips the import
+                GetFilePath
+                  Returns the path of the model file
+                SetAnimationBenchmark
+                  Sets the number of poses benchmarked at load
+                GetAnimationStats
+                  Returns the statistics of the skeleton
+                GetAnimationPlayer
+                  Returns the player of the animations
+                SetPoseCache
+                  Sets how the clips are baked into bone transforms at
+                  load
+                GetPoseCacheStats
+                  Returns the statistics of the pose cache
+                BenchmarkKeyLookup
+                  Measures the key lookup over clips of growing length
                 Model
                   Constructor.
                 ~Model
@@ -65,6 +208,10 @@ namespace library
     class Model : public Renderable
     {
     public:
+        static constexpr const FLOAT NLERP_TOLERANCE = 1.0e-3f;
+        static constexpr const UINT MAX_STREAM_SUBDIVISIONS = 8u;
+        static constexpr const UINT BENCHMARK_BLEND_LAYERS = 4u;
+
         Model() = delete;
         Model(_In_ const std::filesystem::path& filePath);
         Model(const Model& other) = delete;
@@ -74,6 +221,7 @@ namespace library
         virtual ~Model();
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+        HRESULT Load();
         virtual void Update(_In_ FLOAT deltaTime) override;
 
         ComPtr<ID3D11Buffer>& GetAnimationBuffer();
@@ -85,6 +233,18 @@ namespace library
         std::vector<XMMATRIX>& GetBoneTransforms();
         const std::unordered_map<std::string, UINT>& GetBoneNameToIndexMap() const;
 
+        HRESULT ExportGeometry(_Out_ ModelGeometry& geometry) const;
+        void RestoreGeometry(_Inout_ ModelGeometry&& geometry);
+        const std::filesystem::path& GetFilePath() const;
+
+        void SetAnimationBenchmark(_In_ UINT uNumFrames);
+        const ModelAnimationStats& GetAnimationStats() const;
+        AnimationPlayer& GetAnimationPlayer();
+        void SetPoseCache(_In_ const PoseCacheDesc& desc);
+        const PoseCacheStats& GetPoseCacheStats() const;
+
+        static ModelKeyLookupStats BenchmarkKeyLookup(_In_ UINT uNumFrames);
+
     protected:
         struct VertexBoneData
         {
@@ -104,7 +264,7 @@ namespace library
                 aBoneIds[uNumBones] = uBoneId;
                 aWeights[uNumBones] = weight;
 
-                static CHAR szDebugMessage[256];
+                CHAR szDebugMessage[256];
                 sprintf_s(szDebugMessage, "\t\t\tBone %d, weight: %f, index %u\n", uBoneId, weight, uNumBones);
                 OutputDebugStringA(szDebugMessage);
 
@@ -121,74 +281,83 @@ namespace library
             BoneInfo() = default;
             BoneInfo(const XMMATRIX& Offset)
                 : OffsetMatrix(Offset)
-                , FinalTransformation()
             {
             }
 
             XMMATRIX OffsetMatrix;
-            XMMATRIX FinalTransformation;
         };
 
+        struct KeyCursor
+        {
+            UINT uPosition;
+            UINT uRotation;
+            UINT uScaling;
+        };
+
+        HRESULT bakePoseCache();
+        void benchmarkAnimation();
+        void computePose();
         void countVerticesAndIndices(_Inout_ UINT& uOutNumVertices, _Inout_ UINT& uOutNumIndices, _In_ const aiScene* pScene);
-        const aiNodeAnim* findNodeAnimOrNull(_In_ const aiAnimation* pAnimation, _In_ PCSTR pszNodeName);
-        UINT findPosition(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
-        UINT findRotation(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
-        UINT findScaling(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
+        INT findChannel(_In_ const aiAnimation* pAnimation, _In_ PCSTR pszNodeName);
+        UINT findPosition(_In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ UINT& uCursor);
+        UINT findRotation(_In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ UINT& uCursor);
+        UINT findScaling(_In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ UINT& uCursor);
         UINT getBoneId(_In_ const aiBone* pBone);
         const virtual SimpleVertex* getVertices() const override;
         virtual const WORD* getIndices() const override;
         void initAllMeshes(_In_ const aiScene* pScene);
+        void initAnimations(_In_ const aiScene* pScene);
+        void initAnimationStream(_Inout_ ModelAnimation& animation);
+        void initBindPose();
         HRESULT initFromScene(
-            _In_ ID3D11Device* pDevice,
-            _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const aiScene* pScene,
             _In_ const std::filesystem::path& filePath
         );
         HRESULT initMaterials(
-            _In_ ID3D11Device* pDevice,
-            _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const aiScene* pScene,
             _In_ const std::filesystem::path& filePath
         );
         void initMeshBones(_In_ UINT uMeshIndex, _In_ const aiMesh* pMesh);
         void initMeshSingleBone(_In_ UINT uBoneIndex, _In_ const aiBone* pBone);
         virtual void initSingleMesh(_In_ UINT uMeshIndex, _In_ const aiMesh* pMesh);
-        void interpolatePosition(_Inout_ XMFLOAT3& outTranslate, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
-        void interpolateRotation(_Inout_ XMVECTOR& outQuaternion, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
-        void interpolateScaling(_Inout_ XMFLOAT3& outScale, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
+        void initSkeleton(_In_ const aiScene* pScene);
+        void interpolatePosition(_Inout_ XMFLOAT3& outTranslate, _In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ KeyCursor& cursor);
+        void interpolateRotation(_Inout_ XMVECTOR& outQuaternion, _In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ KeyCursor& cursor);
+        void interpolateScaling(_Inout_ XMFLOAT3& outScale, _In_ FLOAT animationTimeTicks, _In_ const ModelAnimationChannel& channel, _Inout_ KeyCursor& cursor);
         HRESULT loadDiffuseTexture(
-            _In_ ID3D11Device* pDevice,
-            _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const std::filesystem::path& parentDirectory,
             _In_ const aiMaterial* pMaterial,
             _In_ UINT uIndex
         );
         HRESULT loadSpecularTexture(
-            _In_ ID3D11Device* pDevice,
-            _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const std::filesystem::path& parentDirectory,
             _In_ const aiMaterial* pMaterial,
             _In_ UINT uIndex
         );
         HRESULT loadNormalTexture(
-            _In_ ID3D11Device* pDevice,
-            _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const std::filesystem::path& parentDirectory,
             _In_ const aiMaterial* pMaterial,
             _In_ UINT uIndex
         );
         HRESULT loadTextures(
-            _In_ ID3D11Device* pDevice,
-            _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const std::filesystem::path& parentDirectory,
             _In_ const aiMaterial* pMaterial,
             _In_ UINT uIndex
         );
-        void readNodeHierarchy(_In_ FLOAT animationTimeTicks, _In_ const aiNode* pNode, _In_ const XMMATRIX& parentTransform);
         void reserveSpace(_In_ UINT uNumVertices, _In_ UINT uNumIndices);
+        void sampleChannel(
+            _In_ const ModelAnimationChannel& channel,
+            _In_opt_ const FLOAT* pBindLanes,
+            _In_ FLOAT animationTimeTicks,
+            _Inout_ KeyCursor& cursor,
+            _Out_ XMFLOAT3& outTranslate,
+            _Out_ XMVECTOR& outQuaternion,
+            _Out_ XMFLOAT3& outScale
+        );
+        void sampleChannels(_In_ const ModelAnimation& animation, _In_ FLOAT animationTimeTicks);
 
-    protected:
-        static std::unique_ptr<Assimp::Importer> sm_pImporter;
+        static UINT64 getSceneMemoryUsage(_In_ const aiScene* pScene);
+        static void storeLanes(_Out_ FLOAT* pLanes, _In_ const XMFLOAT3& translate, _In_ const XMFLOAT4& rotation, _In_ const XMFLOAT3& scale);
 
     protected:
         std::filesystem::path m_filePath;
@@ -204,7 +373,23 @@ namespace library
         std::vector<XMMATRIX> m_aTransforms;
         std::unordered_map<std::string, UINT> m_boneNameToIndexMap;
 
+        ModelSkeleton m_skeleton;
+        std::vector<ModelAnimation> m_aAnimations;
+        AnimationPlayer m_animationPlayer;
+        std::vector<KeyCursor> m_aKeyCursors;
+        std::vector<XMVECTOR> m_aBindPoses;
+        std::vector<XMVECTOR> m_aLocalPoses;
+        UINT m_uStreamCursor;
+        std::vector<XMMATRIX> m_aGlobalTransforms;
+        ModelAnimationStats m_animationStats;
+        UINT m_uNumBenchmarkFrames;
+        PoseCache m_poseCache;
+        PoseCacheDesc m_poseCacheDesc;
+        PoseCacheStats m_poseCacheStats;
+
         const aiScene* m_pScene;
+        BOOL m_bRestoredGeometry;
+        BOOL m_bLoaded;
 
         float m_timeSinceLoaded;
 
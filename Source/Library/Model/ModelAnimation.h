@@ -0,0 +1,207 @@
+/*+===================================================================
+  File:      MODELANIMATION.H
+
+  Summary:   ModelAnimation header file contains declarations of the
+             keys, channels and streams of the animations of a model
+             and the key lookups shared by the model and its
+             animation player.
+
+  Structs: ModelVectorKey, ModelQuaternionKey, ModelAnimationChannel,
+           ModelAnimationStream, ModelAnimation
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace library
+{
+    constexpr const UINT MAX_KEY_CURSOR_STEPS = 4u;
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelVectorKey
+
+        Summary:  Position or scaling of a node at a time in ticks
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelVectorKey
+    {
+        FLOAT Time;
+        XMFLOAT3 Value;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelQuaternionKey
+
+        Summary:  Rotation of a node at a time in ticks
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelQuaternionKey
+    {
+        FLOAT Time;
+        XMFLOAT4 Value;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelAnimationChannel
+
+        Summary:  Keys of one node moved by an animation
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelAnimationChannel
+    {
+        std::vector<ModelVectorKey> aPositionKeys;
+        std::vector<ModelQuaternionKey> aRotationKeys;
+        std::vector<ModelVectorKey> aScalingKeys;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelAnimationStream
+
+        Summary:  Local pose of every node of the skeleton sampled at
+                  the same times, stored structure of arrays: for every
+                  time, blocks of four nodes, each holding a vector of
+                  four lanes per component of the position, the
+                  rotation and the scaling. Nodes the animation leaves
+                  alone hold their bind pose. The times are those of
+                  all the keys of the channels, with more added where a
+                  normalized lerp of the rotations strays too far from
+                  the slerp of the keys
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelAnimationStream
+    {
+        static constexpr const UINT POSITION = 0u;
+        static constexpr const UINT ROTATION = 3u;
+        static constexpr const UINT SCALING = 7u;
+        static constexpr const UINT NUM_COMPONENTS = 10u;
+
+        std::vector<FLOAT> aTimes;
+        std::vector<XMVECTOR> aKeys;
+        UINT uNumBlocks;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ModelAnimation
+
+        Summary:  Channels of an animation, the index of the channel of
+                  every node of the skeleton or -1 when the animation
+                  leaves it in its bind pose, the length of the
+                  animation in ticks and its keys as a stream sampled
+                  four nodes at a time
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelAnimation
+    {
+        std::vector<ModelAnimationChannel> aChannels;
+        std::vector<INT> aNodeChannels;
+        FLOAT Duration;
+        FLOAT TicksPerSecond;
+        ModelAnimationStream Stream;
+    };
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GetKeyTime
+
+      Summary:  Returns the time of a key, or a time kept on its own
+
+      Returns:  FLOAT
+                  Time in ticks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    inline FLOAT GetKeyTime(_In_ FLOAT time)
+    {
+        return time;
+    }
+
+    template <class Key>
+    FLOAT GetKeyTime(_In_ const Key& key)
+    {
+        return key.Time;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FindKeyLinear
+
+      Summary:  Find the index of the key right before the given time by
+                scanning from the first key. 0 past the last key
+
+      Args:     FLOAT animationTimeTicks
+                  Animation time
+                const std::vector<Key>& aKeys
+                  Keys sorted by time
+
+      Returns:  UINT
+                  Index of the key
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class Key>
+    UINT FindKeyLinear(_In_ FLOAT animationTimeTicks, _In_ const std::vector<Key>& aKeys)
+    {
+        for (UINT i = 0u; i + 1u < aKeys.size(); ++i)
+        {
+            if (animationTimeTicks < GetKeyTime(aKeys[i + 1u]))
+            {
+                return i;
+            }
+        }
+
+        return 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FindKey
+
+      Summary:  Find the same key as FindKeyLinear starting from the key
+                found for the previous frame. Playback moves the time
+                forward by a key or less a frame, so the cursor is kept
+                or stepped a few keys ahead; a seek backwards, a wrap
+                of the loop or a jump further ahead falls back to a
+                binary search
+
+      Args:     FLOAT animationTimeTicks
+                  Animation time
+                const std::vector<Key>& aKeys
+                  Keys sorted by time
+                UINT& uCursor
+                  Key found for the previous frame, updated
+
+      Returns:  UINT
+                  Index of the key
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class Key>
+    UINT FindKey(_In_ FLOAT animationTimeTicks, _In_ const std::vector<Key>& aKeys, _Inout_ UINT& uCursor)
+    {
+        const UINT uLastKey = static_cast<UINT>(aKeys.size()) - 1u;
+
+        // The cursor is the first key whose successor comes after the
+        // time as long as the time has not gone back before it
+        UINT i = uCursor;
+        if (i < uLastKey && (i == 0u || GetKeyTime(aKeys[i]) <= animationTimeTicks))
+        {
+            for (UINT uStep = 0u; uStep < MAX_KEY_CURSOR_STEPS && i < uLastKey; ++uStep, ++i)
+            {
+                if (animationTimeTicks < GetKeyTime(aKeys[i + 1u]))
+                {
+                    uCursor = i;
+                    return i;
+                }
+            }
+        }
+
+        auto next = std::upper_bound(
+            aKeys.begin() + 1,
+            aKeys.end(),
+            animationTimeTicks,
+            [](FLOAT time, const Key& key)
+            {
+                return time < GetKeyTime(key);
+            }
+        );
+        i = static_cast<UINT>(next - aKeys.begin()) - 1u;
+        if (i >= uLastKey)
+        {
+            i = 0u;
+        }
+
+        uCursor = i;
+        return i;
+    }
+}
\ No newline at end of file
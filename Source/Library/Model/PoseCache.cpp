@@ -0,0 +1,289 @@
+#include "Model/PoseCache.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::PoseCache
+
+      Summary:  Constructor. Nothing is baked until Allocate
+
+      Modifies: [m_aPalettes, m_aClips, m_uNumBones, m_framesPerSecond].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    PoseCache::PoseCache()
+        : m_aPalettes()
+        , m_aClips()
+        , m_uNumBones(0u)
+        , m_framesPerSecond(0.0f)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::Allocate
+
+      Summary:  Makes room for the frames of every clip at a rate. A
+                clip takes its length times the rate plus one frames,
+                and at least two. When they do not fit the budget the
+                rate is lowered so that they do: a clip takes at most
+                two frames more than its length times the rate
+
+      Args:     const std::vector<FLOAT>& aClipSeconds
+                  Length of every clip in seconds
+                UINT uNumBones
+                  Number of bones of a palette, up to MAX_NUM_BONES
+                FLOAT framesPerSecond
+                  Frames per second of the clips
+                UINT64 ullBudgetBytes
+                  Most bytes the palettes may take
+
+      Modifies: [m_aPalettes, m_aClips, m_uNumBones, m_framesPerSecond].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if the bones do not fit a
+                  palette of CBSkinning or there is no rate, and
+                  E_OUTOFMEMORY if two frames of every clip do not fit
+                  the budget
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT PoseCache::Allocate(_In_ const std::vector<FLOAT>& aClipSeconds, _In_ UINT uNumBones, _In_ FLOAT framesPerSecond, _In_ UINT64 ullBudgetBytes)
+    {
+        Clear();
+        if (aClipSeconds.empty() || uNumBones == 0u || uNumBones > MAX_NUM_BONES || framesPerSecond <= 0.0f)
+        {
+            return E_INVALIDARG;
+        }
+
+        const UINT64 ullNumClips = aClipSeconds.size();
+        const UINT64 ullClipBytes = ullNumClips * sizeof(ClipFrames);
+        const UINT64 ullMaxPalettes = ullBudgetBytes > ullClipBytes ? (ullBudgetBytes - ullClipBytes) / (static_cast<UINT64>(uNumBones) * sizeof(XMMATRIX)) : 0u;
+        if (ullMaxPalettes < 2u * ullNumClips)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        auto getNumFrames = [](FLOAT seconds, FLOAT rate)
+        {
+            return std::max<UINT>(static_cast<UINT>(std::ceil(std::max<FLOAT>(seconds, 0.0f) * rate)) + 1u, 2u);
+        };
+        auto countPalettes = [&aClipSeconds, &getNumFrames](FLOAT rate)
+        {
+            UINT64 ullNumPalettes = 0u;
+            for (FLOAT seconds : aClipSeconds)
+            {
+                ullNumPalettes += getNumFrames(seconds, rate);
+            }
+            return ullNumPalettes;
+        };
+
+        FLOAT rate = framesPerSecond;
+        if (countPalettes(rate) > ullMaxPalettes)
+        {
+            FLOAT totalSeconds = 0.0f;
+            for (FLOAT seconds : aClipSeconds)
+            {
+                totalSeconds += std::max<FLOAT>(seconds, 0.0f);
+            }
+            rate = static_cast<FLOAT>(ullMaxPalettes - 2u * ullNumClips) / totalSeconds;
+        }
+
+        size_t uNumPalettes = 0u;
+        m_aClips.reserve(aClipSeconds.size());
+        for (FLOAT seconds : aClipSeconds)
+        {
+            const UINT uNumFrames = getNumFrames(seconds, rate);
+            m_aClips.push_back(
+                ClipFrames{
+                    .uFirstPalette = uNumPalettes,
+                    .uNumFrames = uNumFrames,
+                    .FramesPerSecond = seconds > 0.0f ? static_cast<FLOAT>(uNumFrames - 1u) / seconds : 0.0f,
+                }
+            );
+            uNumPalettes += uNumFrames;
+        }
+
+        m_aPalettes.resize(uNumPalettes * uNumBones);
+        m_uNumBones = uNumBones;
+        m_framesPerSecond = rate;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::Clear
+
+      Summary:  Frees the palettes
+
+      Modifies: [m_aPalettes, m_aClips, m_uNumBones, m_framesPerSecond].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void PoseCache::Clear()
+    {
+        m_aPalettes.clear();
+        m_aPalettes.shrink_to_fit();
+        m_aClips.clear();
+        m_uNumBones = 0u;
+        m_framesPerSecond = 0.0f;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::GetPalette
+
+      Summary:  Returns a frame of a clip to bake its bone transforms
+                into
+
+      Args:     UINT uClip
+                  Index of the clip
+                UINT uFrame
+                  Index of the frame
+
+      Returns:  XMMATRIX*
+                  First of the bone transforms of the frame
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMMATRIX* PoseCache::GetPalette(_In_ UINT uClip, _In_ UINT uFrame)
+    {
+        return m_aPalettes.data() + (m_aClips[uClip].uFirstPalette + uFrame) * m_uNumBones;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::Sample
+
+      Summary:  Gives the bone transforms of a clip at a time, copying
+                the nearest frame or lerping the two frames around it
+                matrix row by matrix row. A lerp of two rotations is
+                not a rotation, so the transforms shrink a little
+                between frames far apart; the bake reports by how much
+
+      Args:     UINT uClip
+                  Index of the clip
+                FLOAT timeSeconds
+                  Time in the clip, held at its ends
+                BOOL bInterpolate
+                  Whether to lerp the frames around the time
+                XMMATRIX* pOutTransforms
+                  Bone transforms
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void PoseCache::Sample(_In_ UINT uClip, _In_ FLOAT timeSeconds, _In_ BOOL bInterpolate, _Out_writes_(m_uNumBones) XMMATRIX* pOutTransforms) const
+    {
+        const ClipFrames& clip = m_aClips[uClip];
+        const FLOAT frame = std::clamp<FLOAT>(timeSeconds * clip.FramesPerSecond, 0.0f, static_cast<FLOAT>(clip.uNumFrames - 1u));
+        const XMMATRIX* pPalette = m_aPalettes.data() + clip.uFirstPalette * m_uNumBones;
+
+        if (!bInterpolate)
+        {
+            const XMMATRIX* pNearest = pPalette + static_cast<size_t>(frame + 0.5f) * m_uNumBones;
+            std::copy(pNearest, pNearest + m_uNumBones, pOutTransforms);
+            return;
+        }
+
+        const UINT uFrame = std::min<UINT>(static_cast<UINT>(frame), clip.uNumFrames - 2u);
+        const FLOAT factor = frame - static_cast<FLOAT>(uFrame);
+        const XMMATRIX* pStart = pPalette + static_cast<size_t>(uFrame) * m_uNumBones;
+        const XMMATRIX* pEnd = pStart + m_uNumBones;
+        for (UINT i = 0u; i < m_uNumBones; ++i)
+        {
+            for (UINT uRow = 0u; uRow < 4u; ++uRow)
+            {
+                pOutTransforms[i].r[uRow] = XMVectorLerp(pStart[i].r[uRow], pEnd[i].r[uRow], factor);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::IsEmpty
+
+      Summary:  Returns whether nothing is baked
+
+      Returns:  BOOL
+                  TRUE until Allocate succeeds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL PoseCache::IsEmpty() const
+    {
+        return m_aClips.empty();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::GetNumFrames
+
+      Summary:  Returns the number of frames of all the clips
+
+      Returns:  UINT
+                  Number of palettes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT PoseCache::GetNumFrames() const
+    {
+        return m_uNumBones > 0u ? static_cast<UINT>(m_aPalettes.size() / m_uNumBones) : 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::GetNumFrames
+
+      Summary:  Returns the number of frames of a clip
+
+      Args:     UINT uClip
+                  Index of the clip
+
+      Returns:  UINT
+                  Number of palettes of the clip
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT PoseCache::GetNumFrames(_In_ UINT uClip) const
+    {
+        return m_aClips[uClip].uNumFrames;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::GetNumBones
+
+      Summary:  Returns the number of bones of a palette
+
+      Returns:  UINT
+                  Number of bone transforms per frame
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT PoseCache::GetNumBones() const
+    {
+        return m_uNumBones;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::GetFrameTime
+
+      Summary:  Returns the time of a frame of a clip
+
+      Args:     UINT uClip
+                  Index of the clip
+                UINT uFrame
+                  Index of the frame
+
+      Returns:  FLOAT
+                  Time in seconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT PoseCache::GetFrameTime(_In_ UINT uClip, _In_ UINT uFrame) const
+    {
+        const ClipFrames& clip = m_aClips[uClip];
+        return clip.FramesPerSecond > 0.0f ? static_cast<FLOAT>(uFrame) / clip.FramesPerSecond : 0.0f;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::GetFramesPerSecond
+
+      Summary:  Returns the rate the clips were allocated at, lower
+                than the one asked for when the budget was too small
+
+      Returns:  FLOAT
+                  Frames per second
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT PoseCache::GetFramesPerSecond() const
+    {
+        return m_framesPerSecond;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PoseCache::GetMemoryUsage
+
+      Summary:  Returns the size of the palettes and of the frame
+                ranges of the clips
+
+      Returns:  UINT64
+                  Size in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 PoseCache::GetMemoryUsage() const
+    {
+        return m_aPalettes.capacity() * sizeof(XMMATRIX) + m_aClips.capacity() * sizeof(ClipFrames);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+/*+===================================================================
+  File:      POSECACHE.H
+
+  Summary:   PoseCache header file contains declarations of PoseCache
+             class that keeps the bone transforms of the animations of
+             a model baked at a fixed rate.
+
+  Classes: PoseCache
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/DataTypes.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   PoseCacheDesc
+
+        Summary:  Frames baked per second of every clip, the most bytes
+                  the palettes may take, and whether a pose between two
+                  frames is lerped or taken from the nearest frame
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct PoseCacheDesc
+    {
+        FLOAT FramesPerSecond;
+        UINT64 ullBudgetBytes;
+        BOOL bInterpolate;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   PoseCacheStats
+
+        Summary:  Clips, frames and bones baked, the rate they were
+                  baked at once fitted to the budget, the size of the
+                  palettes and the time to bake them, the cost of an
+                  update from the cache against sampling the clip live,
+                  and the largest difference of the bone transforms
+                  between them, in the rotation and scaling part and
+                  in the translation
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct PoseCacheStats
+    {
+        UINT uNumClips;
+        UINT uNumFrames;
+        UINT uNumBones;
+        FLOAT FramesPerSecond;
+        UINT64 ullMemoryBytes;
+        UINT64 ullBudgetBytes;
+        FLOAT BakeMilliseconds;
+        FLOAT LiveMicrosecondsPerUpdate;
+        FLOAT CachedMicrosecondsPerUpdate;
+        FLOAT MaxRotationError;
+        FLOAT MaxTranslationError;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    PoseCache
+
+      Summary:  Palettes of final bone transforms, one per frame of
+                every clip, laid out like the bone transforms of
+                CBSkinning so a frame is copied as it is. The frames of
+                a clip are spread evenly from its start to its end, at
+                least the rate asked for unless the budget forces it
+                lower
+
+      Methods:  Allocate
+                  Makes room for the frames of the clips within a budget
+                Clear
+                  Frees the palettes
+                GetPalette
+                  Returns a frame of a clip to bake into
+                Sample
+                  Copies or lerps the frames of a clip around a time
+                IsEmpty
+                  Returns whether nothing is baked
+                GetNumFrames
+                  Returns the number of frames of all the clips
+                GetNumBones
+                  Returns the number of bones of a palette
+                GetFrameTime
+                  Returns the time of a frame of a clip
+                GetFramesPerSecond
+                  Returns the rate the clips were allocated at
+                GetMemoryUsage
+                  Returns the size of the palettes in bytes
+                PoseCache
+                  Constructor.
+                ~PoseCache
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class PoseCache
+    {
+    public:
+        PoseCache();
+        PoseCache(const PoseCache& other) = delete;
+        PoseCache(PoseCache&& other) = delete;
+        PoseCache& operator=(const PoseCache& other) = delete;
+        PoseCache& operator=(PoseCache&& other) = delete;
+        ~PoseCache() = default;
+
+        HRESULT Allocate(_In_ const std::vector<FLOAT>& aClipSeconds, _In_ UINT uNumBones, _In_ FLOAT framesPerSecond, _In_ UINT64 ullBudgetBytes);
+        void Clear();
+        XMMATRIX* GetPalette(_In_ UINT uClip, _In_ UINT uFrame);
+        void Sample(_In_ UINT uClip, _In_ FLOAT timeSeconds, _In_ BOOL bInterpolate, _Out_writes_(m_uNumBones) XMMATRIX* pOutTransforms) const;
+
+        BOOL IsEmpty() const;
+        UINT GetNumFrames() const;
+        UINT GetNumFrames(_In_ UINT uClip) const;
+        UINT GetNumBones() const;
+        FLOAT GetFrameTime(_In_ UINT uClip, _In_ UINT uFrame) const;
+        FLOAT GetFramesPerSecond() const;
+        UINT64 GetMemoryUsage() const;
+
+    private:
+        struct ClipFrames
+        {
+            size_t uFirstPalette;
+            UINT uNumFrames;
+            FLOAT FramesPerSecond;
+        };
+
+        std::vector<XMMATRIX> m_aPalettes;
+        std::vector<ClipFrames> m_aClips;
+        UINT m_uNumBones;
+        FLOAT m_framesPerSecond;
+    };
+}
\ No newline at end of file
@@ -20,6 +20,28 @@ namespace library
 		XMMATRIX Transformation;
 	};
 
+	struct PackedInstanceData
+	{
+		INT16 X;
+		INT16 Y;
+		INT16 Z;
+		BYTE BlockType;
+		BYTE RunLength;
+	};
+	static_assert(sizeof(PackedInstanceData) == 8u);
+
+	struct InstanceHorizonData
+	{
+		BYTE aElevations[8];
+	};
+	static_assert(sizeof(InstanceHorizonData) == 8u);
+
+	struct InstanceLightData
+	{
+		BYTE aFaceLights[8];
+	};
+	static_assert(sizeof(InstanceLightData) == 8u);
+
 	struct AnimationData
 	{
 		XMUINT4 aBoneIndices;
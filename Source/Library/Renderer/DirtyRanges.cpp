@@ -0,0 +1,153 @@
+#include "Renderer/DirtyRanges.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRanges::DirtyRanges
+
+      Summary:  Constructor
+
+      Modifies: [m_aRanges].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    DirtyRanges::DirtyRanges()
+        : m_aRanges()
+    { }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRanges::Mark
+
+      Summary:  Marks the elements [uBegin, uEnd) as changed, merging
+                the range with the ranges it overlaps or touches
+
+      Args:     UINT uBegin
+                  First changed element
+                UINT uEnd
+                  Element following the last changed element
+
+      Modifies: [m_aRanges].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void DirtyRanges::Mark(_In_ UINT uBegin, _In_ UINT uEnd)
+    {
+        if (uBegin >= uEnd)
+        {
+            return;
+        }
+
+        // First range ending at or after uBegin, then every range it
+        // touches is folded into the new one
+        auto first = std::lower_bound(
+            m_aRanges.begin(),
+            m_aRanges.end(),
+            uBegin,
+            [](const DirtyRange& range, UINT uIndex)
+            {
+                return range.uEnd < uIndex;
+            }
+        );
+        auto last = first;
+        DirtyRange merged = { .uBegin = uBegin, .uEnd = uEnd };
+        while (last != m_aRanges.end() && last->uBegin <= uEnd)
+        {
+            merged.uBegin = std::min<UINT>(merged.uBegin, last->uBegin);
+            merged.uEnd = std::max<UINT>(merged.uEnd, last->uEnd);
+            ++last;
+        }
+
+        if (first == last)
+        {
+            m_aRanges.insert(first, merged);
+        }
+        else
+        {
+            *first = merged;
+            m_aRanges.erase(first + 1, last);
+        }
+
+        if (m_aRanges.size() > MAX_RANGES)
+        {
+            DirtyRange span = { .uBegin = m_aRanges.front().uBegin, .uEnd = m_aRanges.back().uEnd };
+            m_aRanges.assign(1u, span);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRanges::Clip
+
+      Summary:  Drops the elements at or past uCount, for when the
+                buffer shrank after they were marked
+
+      Args:     UINT uCount
+                  Number of elements left in the buffer
+
+      Modifies: [m_aRanges].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void DirtyRanges::Clip(_In_ UINT uCount)
+    {
+        while (!m_aRanges.empty() && m_aRanges.back().uBegin >= uCount)
+        {
+            m_aRanges.pop_back();
+        }
+
+        if (!m_aRanges.empty())
+        {
+            m_aRanges.back().uEnd = std::min<UINT>(m_aRanges.back().uEnd, uCount);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRanges::Clear
+
+      Summary:  Forgets every range, once they have been uploaded
+
+      Modifies: [m_aRanges].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void DirtyRanges::Clear()
+    {
+        m_aRanges.clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRanges::IsEmpty
+
+      Summary:  Returns whether no element is marked
+
+      Returns:  BOOL
+                  TRUE if there is nothing to upload
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL DirtyRanges::IsEmpty() const
+    {
+        return m_aRanges.empty();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRanges::GetRanges
+
+      Summary:  Returns the marked ranges, sorted and disjoint
+
+      Returns:  const std::vector<DirtyRange>&
+                  Marked ranges
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<DirtyRange>& DirtyRanges::GetRanges() const
+    {
+        return m_aRanges;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRanges::GetNumDirty
+
+      Summary:  Returns the number of marked elements
+
+      Returns:  UINT
+                  Number of elements a flush uploads
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT DirtyRanges::GetNumDirty() const
+    {
+        UINT uNumDirty = 0u;
+        for (const DirtyRange& range : m_aRanges)
+        {
+            uNumDirty += range.uEnd - range.uBegin;
+        }
+
+        return uNumDirty;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*+===================================================================
+  File:      DIRTYRANGES.H
+
+  Summary:   DirtyRanges header file contains declarations of
+             DirtyRanges class that tracks the elements of a buffer
+             changed since its last upload.
+
+  Classes: DirtyRanges
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <algorithm>
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   DirtyRange
+
+        Summary:  Half-open range [uBegin, uEnd) of element indices
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct DirtyRange
+    {
+        UINT uBegin;
+        UINT uEnd;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    DirtyRanges
+
+      Summary:  Sorted set of disjoint ranges of changed elements.
+                Overlapping and adjacent ranges are merged as they are
+                marked, and past MAX_RANGES the ranges collapse into
+                the one range spanning them, so a flush never issues
+                more than MAX_RANGES copies. It does not touch the
+                device
+
+      Methods:  Mark
+                  Marks a range of elements as changed
+                Clip
+                  Drops the elements at or past a given count
+                Clear
+                  Forgets every range
+                IsEmpty
+                  Returns whether no element is marked
+                GetRanges
+                  Returns the marked ranges
+                GetNumDirty
+                  Returns the number of marked elements
+                DirtyRanges
+                  Constructor.
+                ~DirtyRanges
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class DirtyRanges
+    {
+    public:
+        static constexpr const size_t MAX_RANGES = 64u;
+
+        DirtyRanges();
+        DirtyRanges(const DirtyRanges& other) = delete;
+        DirtyRanges(DirtyRanges&& other) = delete;
+        DirtyRanges& operator=(const DirtyRanges& other) = delete;
+        DirtyRanges& operator=(DirtyRanges&& other) = delete;
+        ~DirtyRanges() = default;
+
+        void Mark(_In_ UINT uBegin, _In_ UINT uEnd);
+        void Clip(_In_ UINT uCount);
+        void Clear();
+
+        BOOL IsEmpty() const;
+        const std::vector<DirtyRange>& GetRanges() const;
+        UINT GetNumDirty() const;
+
+    private:
+        std::vector<DirtyRange> m_aRanges;
+    };
+}
\ No newline at end of file
@@ -14,6 +14,14 @@ namespace library
         : Renderable(outputColor),
         m_instanceBuffer(nullptr),
         m_aInstanceData(std::vector<InstanceData>()),
+        m_horizonBuffer(nullptr),
+        m_aInstanceHorizons(),
+        m_bHasInstanceHorizons(FALSE),
+        m_lightBuffer(nullptr),
+        m_aInstanceLights(),
+        m_bHasInstanceLights(FALSE),
+        m_uInstanceCapacity(0u),
+        m_dirtyInstances(),
         m_padding()
     { }
 
@@ -27,28 +35,403 @@ namespace library
                 const XMFLOAT4& outputColor
                   Default color of the renderable
 
-      Modifies: [m_instanceBuffer, m_aInstanceData].
+      Modifies: [m_instanceBuffer, m_aInstanceData, m_horizonBuffer,
+                 m_aInstanceHorizons, m_bHasInstanceHorizons,
+                 m_lightBuffer, m_aInstanceLights, m_bHasInstanceLights,
+                 m_uInstanceCapacity, m_dirtyInstances].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     InstancedRenderable::InstancedRenderable(_In_ std::vector<InstanceData>&& aInstanceData, _In_ const XMFLOAT4& outputColor)
         : Renderable(outputColor),
         m_instanceBuffer(nullptr),
-        m_aInstanceData(aInstanceData),
+        m_aInstanceData(std::move(aInstanceData)),
+        m_horizonBuffer(nullptr),
+        m_aInstanceHorizons(),
+        m_bHasInstanceHorizons(FALSE),
+        m_lightBuffer(nullptr),
+        m_aInstanceLights(),
+        m_bHasInstanceLights(FALSE),
+        m_uInstanceCapacity(0u),
+        m_dirtyInstances(),
         m_padding()
     { }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   InstancedRenderable::SetInstanceData
 
-      Summary:  Sets the instance data
+      Summary:  Sets the instance data, all of which is uploaded by the
+                next UpdateInstanceBuffer. The horizons and the light
+                no longer match the instances and are dropped
 
       Args:     std::vector<InstanceData>&& aInstanceData
                   Instance data
 
-      Modifies: [m_aInstanceData].
+      Modifies: [m_aInstanceData, m_horizonBuffer, m_aInstanceHorizons,
+                 m_bHasInstanceHorizons, m_lightBuffer, m_aInstanceLights,
+                 m_bHasInstanceLights, m_dirtyInstances].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     void InstancedRenderable::SetInstanceData(_In_ std::vector<InstanceData>&& aInstanceData)
     {
-        m_aInstanceData = aInstanceData;
+        m_aInstanceData = std::move(aInstanceData);
+        m_horizonBuffer.Reset();
+        m_aInstanceHorizons.clear();
+        m_bHasInstanceHorizons = FALSE;
+        m_lightBuffer.Reset();
+        m_aInstanceLights.clear();
+        m_bHasInstanceLights = FALSE;
+        m_dirtyInstances.Clear();
+        m_dirtyInstances.Mark(0u, static_cast<UINT>(m_aInstanceData.size()));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::AddInstance
+
+      Summary:  Appends an instance and marks it for upload. When the
+                instances have horizons, the new one sees the open sky
+                until its horizons are set, and when they have light,
+                it stays dark until its light is set
+
+      Args:     const InstanceData& instance
+                  Instance to append
+
+      Modifies: [m_aInstanceData, m_aInstanceHorizons, m_aInstanceLights,
+                 m_dirtyInstances].
+
+      Returns:  UINT
+                  Index of the new instance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT InstancedRenderable::AddInstance(_In_ const InstanceData& instance)
+    {
+        UINT uIndex = static_cast<UINT>(m_aInstanceData.size());
+        m_aInstanceData.push_back(instance);
+        if (m_bHasInstanceHorizons)
+        {
+            m_aInstanceHorizons.push_back(InstanceHorizonData());
+        }
+        if (m_bHasInstanceLights)
+        {
+            m_aInstanceLights.push_back(InstanceLightData());
+        }
+        m_dirtyInstances.Mark(uIndex, uIndex + 1u);
+
+        return uIndex;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::RemoveInstance
+
+      Summary:  Removes an instance by moving the last instance into
+                its slot, so only that slot has to be uploaded. The
+                instance that was last now has index uIndex, and its
+                horizons and light follow it
+
+      Args:     UINT uIndex
+                  Index of the instance to remove
+
+      Modifies: [m_aInstanceData, m_aInstanceHorizons, m_aInstanceLights,
+                 m_dirtyInstances].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::RemoveInstance(_In_ UINT uIndex)
+    {
+        assert(uIndex < m_aInstanceData.size());
+
+        UINT uLastIdx = static_cast<UINT>(m_aInstanceData.size()) - 1u;
+        if (uIndex != uLastIdx)
+        {
+            m_aInstanceData[uIndex] = m_aInstanceData[uLastIdx];
+            if (m_bHasInstanceHorizons)
+            {
+                m_aInstanceHorizons[uIndex] = m_aInstanceHorizons[uLastIdx];
+            }
+            if (m_bHasInstanceLights)
+            {
+                m_aInstanceLights[uIndex] = m_aInstanceLights[uLastIdx];
+            }
+            m_dirtyInstances.Mark(uIndex, uIndex + 1u);
+        }
+        m_aInstanceData.pop_back();
+        if (m_bHasInstanceHorizons)
+        {
+            m_aInstanceHorizons.pop_back();
+        }
+        if (m_bHasInstanceLights)
+        {
+            m_aInstanceLights.pop_back();
+        }
+        m_dirtyInstances.Clip(uLastIdx);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::SetInstanceHorizons
+
+      Summary:  Sets the horizons of every instance, uploaded with the
+                instances by the next UpdateInstanceBuffer. From then
+                on instances added or removed carry their horizons
+                along, until SetInstanceData replaces the instances
+
+      Args:     std::vector<InstanceHorizonData>&& aInstanceHorizons
+                  Horizons, one per instance
+
+      Modifies: [m_aInstanceHorizons, m_bHasInstanceHorizons,
+                 m_dirtyInstances].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::SetInstanceHorizons(_In_ std::vector<InstanceHorizonData>&& aInstanceHorizons)
+    {
+        assert(aInstanceHorizons.size() == m_aInstanceData.size());
+
+        m_aInstanceHorizons = std::move(aInstanceHorizons);
+        m_aInstanceHorizons.resize(m_aInstanceData.size());
+        m_bHasInstanceHorizons = TRUE;
+        m_dirtyInstances.Mark(0u, static_cast<UINT>(m_aInstanceData.size()));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::SetInstanceHorizon
+
+      Summary:  Sets the horizons of an instance and marks it for
+                upload
+
+      Args:     UINT uIndex
+                  Index of the instance
+                const InstanceHorizonData& horizon
+                  Horizons of the instance
+
+      Modifies: [m_aInstanceHorizons, m_dirtyInstances].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::SetInstanceHorizon(_In_ UINT uIndex, _In_ const InstanceHorizonData& horizon)
+    {
+        assert(uIndex < m_aInstanceHorizons.size());
+
+        m_aInstanceHorizons[uIndex] = horizon;
+        m_dirtyInstances.Mark(uIndex, uIndex + 1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::SetInstanceLights
+
+      Summary:  Sets the light of the faces of every instance, uploaded
+                with the instances by the next UpdateInstanceBuffer.
+                From then on instances added or removed carry their
+                light along, until SetInstanceData replaces the
+                instances
+
+      Args:     std::vector<InstanceLightData>&& aInstanceLights
+                  Light of the faces, one per instance
+
+      Modifies: [m_aInstanceLights, m_bHasInstanceLights,
+                 m_dirtyInstances].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::SetInstanceLights(_In_ std::vector<InstanceLightData>&& aInstanceLights)
+    {
+        assert(aInstanceLights.size() == m_aInstanceData.size());
+
+        m_aInstanceLights = std::move(aInstanceLights);
+        m_aInstanceLights.resize(m_aInstanceData.size());
+        m_bHasInstanceLights = TRUE;
+        m_dirtyInstances.Mark(0u, static_cast<UINT>(m_aInstanceData.size()));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::SetInstanceLight
+
+      Summary:  Sets the light of the faces of an instance and marks it
+                for upload
+
+      Args:     UINT uIndex
+                  Index of the instance
+                const InstanceLightData& light
+                  Light of the faces of the instance
+
+      Modifies: [m_aInstanceLights, m_dirtyInstances].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::SetInstanceLight(_In_ UINT uIndex, _In_ const InstanceLightData& light)
+    {
+        assert(uIndex < m_aInstanceLights.size());
+
+        m_aInstanceLights[uIndex] = light;
+        m_dirtyInstances.Mark(uIndex, uIndex + 1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::UpdateInstanceBuffer
+
+      Summary:  Uploads the instances changed since the last update.
+                Each dirty range is copied into the instance buffer
+                with UpdateSubresource, and the buffer is recreated
+                half again as large when the instances outgrow it. The
+                horizons and the light, when there are, follow the same
+                ranges
+
+      Args:     ID3D11Device* pDevice
+                  Pointer to a Direct3D 11 device
+                ID3D11DeviceContext* pImmediateContext
+                  Pointer to a Direct3D 11 device context
+
+      Modifies: [m_instanceBuffer, m_horizonBuffer, m_lightBuffer,
+                 m_uInstanceCapacity, m_dirtyInstances].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT InstancedRenderable::UpdateInstanceBuffer(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (m_dirtyInstances.IsEmpty())
+        {
+            return S_OK;
+        }
+
+        UINT uStride = static_cast<UINT>(sizeof(InstanceData));
+        if (!m_instanceBuffer || GetNumInstances() > m_uInstanceCapacity)
+        {
+            UINT uCapacity = std::max<UINT>(GetNumInstances(), m_uInstanceCapacity + m_uInstanceCapacity / 2u);
+            D3D11_BUFFER_DESC bd =
+            {
+                .ByteWidth = uStride * uCapacity,
+                .Usage = D3D11_USAGE_DEFAULT,
+                .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+                .CPUAccessFlags = 0
+            };
+
+            ComPtr<ID3D11Buffer> instanceBuffer;
+            HRESULT hr = pDevice->CreateBuffer(&bd, nullptr, instanceBuffer.GetAddressOf());
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            m_instanceBuffer = instanceBuffer;
+            m_uInstanceCapacity = uCapacity;
+            m_horizonBuffer.Reset();
+            m_lightBuffer.Reset();
+            m_dirtyInstances.Clear();
+            m_dirtyInstances.Mark(0u, GetNumInstances());
+        }
+
+        if (m_bHasInstanceHorizons && !m_horizonBuffer)
+        {
+            HRESULT hr = createHorizonBuffer(pDevice);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        if (m_bHasInstanceLights && !m_lightBuffer)
+        {
+            HRESULT hr = createLightBuffer(pDevice);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        for (const DirtyRange& range : m_dirtyInstances.GetRanges())
+        {
+            D3D11_BOX box =
+            {
+                .left = range.uBegin * uStride,
+                .top = 0u,
+                .front = 0u,
+                .right = range.uEnd * uStride,
+                .bottom = 1u,
+                .back = 1u
+            };
+            pImmediateContext->UpdateSubresource(m_instanceBuffer.Get(), 0u, &box, &m_aInstanceData[range.uBegin], 0u, 0u);
+
+            if (m_horizonBuffer)
+            {
+                box.left = range.uBegin * static_cast<UINT>(sizeof(InstanceHorizonData));
+                box.right = range.uEnd * static_cast<UINT>(sizeof(InstanceHorizonData));
+                pImmediateContext->UpdateSubresource(m_horizonBuffer.Get(), 0u, &box, &m_aInstanceHorizons[range.uBegin], 0u, 0u);
+            }
+
+            if (m_lightBuffer)
+            {
+                box.left = range.uBegin * static_cast<UINT>(sizeof(InstanceLightData));
+                box.right = range.uEnd * static_cast<UINT>(sizeof(InstanceLightData));
+                pImmediateContext->UpdateSubresource(m_lightBuffer.Get(), 0u, &box, &m_aInstanceLights[range.uBegin], 0u, 0u);
+            }
+        }
+        m_dirtyInstances.Clear();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetDirtyInstances
+
+      Summary:  Returns the instances changed since the last update
+
+      Returns:  const DirtyRanges&
+                  Ranges of changed instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const DirtyRanges& InstancedRenderable::GetDirtyInstances() const
+    {
+        return m_dirtyInstances;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetInstanceData
+
+      Summary:  Returns the instances
+
+      Returns:  const std::vector<InstanceData>&
+                  Instances of the renderable
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<InstanceData>& InstancedRenderable::GetInstanceData() const
+    {
+        return m_aInstanceData;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetInstanceHorizons
+
+      Summary:  Returns the horizons of the instances
+
+      Returns:  const std::vector<InstanceHorizonData>&
+                  Horizons, one per instance, or none
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<InstanceHorizonData>& InstancedRenderable::GetInstanceHorizons() const
+    {
+        return m_aInstanceHorizons;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::HasInstanceHorizons
+
+      Summary:  Returns whether the instances have horizons
+
+      Returns:  BOOL
+                  TRUE once SetInstanceHorizons was called
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL InstancedRenderable::HasInstanceHorizons() const
+    {
+        return m_bHasInstanceHorizons;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetInstanceLights
+
+      Summary:  Returns the light of the faces of the instances
+
+      Returns:  const std::vector<InstanceLightData>&
+                  Light of the faces, one per instance, or none
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<InstanceLightData>& InstancedRenderable::GetInstanceLights() const
+    {
+        return m_aInstanceLights;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::HasInstanceLights
+
+      Summary:  Returns whether the instances have light
+
+      Returns:  BOOL
+                  TRUE once SetInstanceLights was called
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL InstancedRenderable::HasInstanceLights() const
+    {
+        return m_bHasInstanceLights;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -64,6 +447,33 @@ namespace library
         return m_instanceBuffer;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetHorizonBuffer
+
+      Summary:  Returns the buffer of the horizons
+
+      Returns:  ComPtr<ID3D11Buffer>&
+                  Horizon buffer, empty unless the instances have
+                  horizons
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ComPtr<ID3D11Buffer>& InstancedRenderable::GetHorizonBuffer()
+    {
+        return m_horizonBuffer;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetLightBuffer
+
+      Summary:  Returns the buffer of the light of the faces
+
+      Returns:  ComPtr<ID3D11Buffer>&
+                  Light buffer, empty unless the instances have light
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ComPtr<ID3D11Buffer>& InstancedRenderable::GetLightBuffer()
+    {
+        return m_lightBuffer;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   InstancedRenderable::GetNumInstances
 
@@ -77,6 +487,19 @@ namespace library
         return m_aInstanceData.size();
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetInstanceStride
+
+      Summary:  Returns the size of an instance in the instance buffer
+
+      Returns:  UINT
+                  Size of an instance in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT InstancedRenderable::GetInstanceStride() const
+    {
+        return static_cast<UINT>(sizeof(InstanceData));
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   InstancedRenderable::initializeInstance
 
@@ -85,7 +508,8 @@ namespace library
       Args:     ID3D11Device* pDevice
                   Pointer to a Direct3D 11 device
 
-      Modifies: [m_instanceBuffer].
+      Modifies: [m_instanceBuffer, m_horizonBuffer, m_lightBuffer,
+                 m_uInstanceCapacity, m_dirtyInstances].
 
       Returns:  HRESULT
                   Status code
@@ -94,10 +518,13 @@ namespace library
     {
         HRESULT hr = S_OK;
 
-        //Create the instance buffer from the instance data array
+        //Create the instance buffer from the instance data array. An
+        //empty voxel still gets room for one instance so that blocks
+        //can be placed into it later
+        m_uInstanceCapacity = std::max<UINT>(GetNumInstances(), 1u);
         D3D11_BUFFER_DESC bd =
         {
-            .ByteWidth = sizeof(InstanceData) * GetNumInstances(),
+            .ByteWidth = static_cast<UINT>(sizeof(InstanceData)) * m_uInstanceCapacity,
             .Usage = D3D11_USAGE_DEFAULT,
             .BindFlags = D3D11_BIND_VERTEX_BUFFER,
             .CPUAccessFlags = 0
@@ -110,7 +537,7 @@ namespace library
 
         hr = pDevice->CreateBuffer(
             &bd,
-            &initData,
+            m_aInstanceData.empty() ? nullptr : &initData,
             m_instanceBuffer.GetAddressOf()
         );
         if (FAILED(hr))
@@ -118,6 +545,98 @@ namespace library
             return hr;
         }
 
+        if (m_bHasInstanceHorizons)
+        {
+            hr = createHorizonBuffer(pDevice);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        if (m_bHasInstanceLights)
+        {
+            hr = createLightBuffer(pDevice);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+        m_dirtyInstances.Clear();
+
         return S_OK;
     }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::createHorizonBuffer
+
+      Summary:  Creates the buffer of the horizons with the capacity of
+                the instance buffer, filled with the current horizons
+
+      Args:     ID3D11Device* pDevice
+                  Pointer to a Direct3D 11 device
+
+      Modifies: [m_horizonBuffer].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT InstancedRenderable::createHorizonBuffer(_In_ ID3D11Device* pDevice)
+    {
+        D3D11_BUFFER_DESC bd =
+        {
+            .ByteWidth = static_cast<UINT>(sizeof(InstanceHorizonData)) * std::max<UINT>(m_uInstanceCapacity, 1u),
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = 0
+        };
+
+        D3D11_SUBRESOURCE_DATA initData =
+        {
+            .pSysMem = m_aInstanceHorizons.data()
+        };
+
+        return pDevice->CreateBuffer(
+            &bd,
+            m_aInstanceHorizons.empty() || m_aInstanceHorizons.size() > m_uInstanceCapacity ? nullptr : &initData,
+            m_horizonBuffer.ReleaseAndGetAddressOf()
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::createLightBuffer
+
+      Summary:  Creates the buffer of the light of the faces with the
+                capacity of the instance buffer, filled with the
+                current light
+
+      Args:     ID3D11Device* pDevice
+                  Pointer to a Direct3D 11 device
+
+      Modifies: [m_lightBuffer].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT InstancedRenderable::createLightBuffer(_In_ ID3D11Device* pDevice)
+    {
+        D3D11_BUFFER_DESC bd =
+        {
+            .ByteWidth = static_cast<UINT>(sizeof(InstanceLightData)) * std::max<UINT>(m_uInstanceCapacity, 1u),
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = 0
+        };
+
+        D3D11_SUBRESOURCE_DATA initData =
+        {
+            .pSysMem = m_aInstanceLights.data()
+        };
+
+        return pDevice->CreateBuffer(
+            &bd,
+            m_aInstanceLights.empty() || m_aInstanceLights.size() > m_uInstanceCapacity ? nullptr : &initData,
+            m_lightBuffer.ReleaseAndGetAddressOf()
+        );
+    }
 }
\ No newline at end of file
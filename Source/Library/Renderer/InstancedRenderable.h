@@ -14,6 +14,7 @@
 #include "Common.h"
 
 #include "Renderer/DataTypes.h"
+#include "Renderer/DirtyRanges.h"
 #include "Renderer/Renderable.h"
 
 namespace library
@@ -25,12 +26,56 @@ namespace library
 
       Methods:  SetInstanceData
                   Sets the instance data
+                AddInstance
+                  Appends an instance and marks it for upload
+                RemoveInstance
+                  Removes an instance by moving the last one into its
+                  slot
+                SetInstanceHorizons
+                  Sets the horizons of every instance, which then keep
+                  in step with the instances
+                SetInstanceHorizon
+                  Sets the horizons of an instance and marks it for
+                  upload
+                SetInstanceLights
+                  Sets the light of the faces of every instance, which
+                  then keeps in step with the instances
+                SetInstanceLight
+                  Sets the light of the faces of an instance and marks
+                  it for upload
+                UpdateInstanceBuffer
+                  Uploads the instances changed since the last update
+                GetDirtyInstances
+                  Returns the instances changed since the last update
+                GetInstanceData
+                  Returns the instances
+                GetInstanceHorizons
+                  Returns the horizons of the instances
+                HasInstanceHorizons
+                  Returns whether the instances have horizons
+                GetInstanceLights
+                  Returns the light of the faces of the instances
+                HasInstanceLights
+                  Returns whether the instances have light
                 GetInstanceBuffer
                   Returns a instance buffer
+                GetHorizonBuffer
+                  Returns the buffer of the horizons, empty unless they
+                  are set
+                GetLightBuffer
+                  Returns the buffer of the light, empty unless it is
+                  set
                 GetNumInstances
                   Returns the number of instance data
+                GetInstanceStride
+                  Returns the size of an instance in the instance
+                  buffer
                 initializeInstance
                   Initialize the instance buffer
+                createHorizonBuffer
+                  Creates the buffer of the horizons
+                createLightBuffer
+                  Creates the buffer of the light
                 InstancedRenderable
                   Constructor.
                 ~InstancedRenderable
@@ -51,9 +96,25 @@ namespace library
         virtual void Update(_In_ FLOAT deltaTime) override = 0;
 
         void SetInstanceData(_In_ std::vector<InstanceData>&& aInstanceData);
+        UINT AddInstance(_In_ const InstanceData& instance);
+        void RemoveInstance(_In_ UINT uIndex);
+        void SetInstanceHorizons(_In_ std::vector<InstanceHorizonData>&& aInstanceHorizons);
+        void SetInstanceHorizon(_In_ UINT uIndex, _In_ const InstanceHorizonData& horizon);
+        void SetInstanceLights(_In_ std::vector<InstanceLightData>&& aInstanceLights);
+        void SetInstanceLight(_In_ UINT uIndex, _In_ const InstanceLightData& light);
+        HRESULT UpdateInstanceBuffer(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+        const DirtyRanges& GetDirtyInstances() const;
+        const std::vector<InstanceData>& GetInstanceData() const;
+        const std::vector<InstanceHorizonData>& GetInstanceHorizons() const;
+        BOOL HasInstanceHorizons() const;
+        const std::vector<InstanceLightData>& GetInstanceLights() const;
+        BOOL HasInstanceLights() const;
 
         virtual ComPtr<ID3D11Buffer>& GetInstanceBuffer();
+        ComPtr<ID3D11Buffer>& GetHorizonBuffer();
+        ComPtr<ID3D11Buffer>& GetLightBuffer();
         virtual UINT GetNumInstances() const;
+        virtual UINT GetInstanceStride() const;
 
         UINT GetNumVertices() const override = 0;
         UINT GetNumIndices() const override = 0;
@@ -63,10 +124,20 @@ namespace library
         const WORD* getIndices() const override = 0;
 
         virtual HRESULT initializeInstance(_In_ ID3D11Device* pDevice);
+        HRESULT createHorizonBuffer(_In_ ID3D11Device* pDevice);
+        HRESULT createLightBuffer(_In_ ID3D11Device* pDevice);
 
     protected:
         ComPtr<ID3D11Buffer> m_instanceBuffer;
         std::vector<InstanceData> m_aInstanceData;
+        ComPtr<ID3D11Buffer> m_horizonBuffer;
+        std::vector<InstanceHorizonData> m_aInstanceHorizons;
+        BOOL m_bHasInstanceHorizons;
+        ComPtr<ID3D11Buffer> m_lightBuffer;
+        std::vector<InstanceLightData> m_aInstanceLights;
+        BOOL m_bHasInstanceLights;
+        UINT m_uInstanceCapacity;
+        DirtyRanges m_dirtyInstances;
 
     private:
         BYTE m_padding[8];
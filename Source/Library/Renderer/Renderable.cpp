@@ -607,6 +607,17 @@ namespace library
     }
 
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::GetIndexFormat
+      Summary:  Returns the format of the index buffer
+      Returns:  DXGI_FORMAT
+                  DXGI_FORMAT_R16_UINT unless overridden
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    DXGI_FORMAT Renderable::GetIndexFormat() const
+    {
+        return DXGI_FORMAT_R16_UINT;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderable::GetNumMeshes
       Summary:  Returns the number of meshes
@@ -45,6 +45,8 @@ namespace library
                 GetNumIndices
                   Pure virtual function that returns the number of
                   indices
+                GetIndexFormat
+                  Returns the format of the index buffer
                 Renderable
                   Constructor.
                 ~Renderable
@@ -112,6 +114,7 @@ namespace library
 
         virtual UINT GetNumVertices() const = 0;
         virtual UINT GetNumIndices() const = 0;
+        virtual DXGI_FORMAT GetIndexFormat() const;
 
         UINT GetNumMeshes() const;
         UINT GetNumMaterials() const;
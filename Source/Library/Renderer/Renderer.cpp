@@ -11,7 +11,7 @@ namespace library
                   m_swapChain1, m_renderTargetView, m_depthStencil,
                   m_depthStencilView, m_cbChangeOnResize, m_cbShadowMatrix,
                   m_pszMainSceneName, m_camera, m_projection, m_scenes
-                  m_invalidTexture, m_shadowMapTexture, m_shadowVertexShader,
+                  m_pendingScenes, m_invalidTexture, m_shadowMapTexture, m_shadowVertexShader,
                   m_shadowPixelShader].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Renderer::Renderer()
@@ -34,6 +34,7 @@ namespace library
         , m_camera(XMVectorSet(0.0f, 3.0f, -6.0f, 0.0f))
         , m_projection()
         , m_scenes()
+        , m_pendingScenes()
         , m_invalidTexture(std::make_shared<Texture>(L"Content/Common/InvalidTexture.png"))
         , m_shadowMapTexture()
         , m_shadowVertexShader()
@@ -293,15 +294,20 @@ namespace library
 
         m_camera.Initialize(m_d3dDevice.Get());
 
-        if (!m_scenes.contains(m_pszMainSceneName))
+        // A main scene still loading is initialized by Update once its
+        // worker is done
+        if (!m_pendingScenes.contains(m_pszMainSceneName))
         {
-            return E_FAIL;
-        }
+            if (!m_scenes.contains(m_pszMainSceneName))
+            {
+                return E_FAIL;
+            }
 
-        hr = m_scenes[m_pszMainSceneName]->Initialize(m_d3dDevice.Get(), m_immediateContext.Get());
-        if (FAILED(hr))
-        {
-            return hr;
+            hr = m_scenes[m_pszMainSceneName]->Initialize(m_d3dDevice.Get(), m_immediateContext.Get());
+            if (FAILED(hr))
+            {
+                return hr;
+            }
         }
 
         hr = m_invalidTexture->Initialize(m_d3dDevice.Get(), m_immediateContext.Get());
@@ -338,6 +344,31 @@ namespace library
     }
 
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::AddSceneAsync
+      Summary:  Add a scene that is still loading. Update polls the
+                load and adds the scene once it is ready
+      Args:     PCWSTR pszSceneName
+                  The name of the scene
+                const std::shared_ptr<SceneLoadHandle>& loadHandle
+                  The handle to the load of the scene
+      Modifies: [m_pendingScenes].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::AddSceneAsync(_In_ PCWSTR pszSceneName, _In_ const std::shared_ptr<SceneLoadHandle>& loadHandle)
+    {
+        if (!loadHandle || m_scenes.contains(pszSceneName) || m_pendingScenes.contains(pszSceneName))
+        {
+            return E_FAIL;
+        }
+
+        m_pendingScenes[pszSceneName] = loadHandle;
+
+        return S_OK;
+    }
+
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderer::GetSceneOrNull
       Summary:  Return scene with the given name or null
@@ -362,18 +393,19 @@ namespace library
       Summary:  Set the main scene
       Args:     PCWSTR pszSceneName
                   The name of the scene
-      Modifies: [m_pszMainSceneName].
+      Modifies: [m_pszMainSceneName, m_camera].
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Renderer::SetMainScene(_In_ PCWSTR pszSceneName)
     {
-        if (!m_scenes.contains(pszSceneName))
+        if (!m_scenes.contains(pszSceneName) && !m_pendingScenes.contains(pszSceneName))
         {
             return E_FAIL;
         }
 
         m_pszMainSceneName = pszSceneName;
+        m_camera.SetCollider(m_scenes.contains(pszSceneName) ? m_scenes[pszSceneName]->GetVoxelCollider() : nullptr);
 
         return S_OK;
     }
@@ -409,15 +441,58 @@ namespace library
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderer::Update
-      Summary:  Update the renderables each frame
+      Summary:  Update the renderables each frame and finish the loads
+                of the pending scenes
       Args:     FLOAT deltaTime
                   Time difference of a frame
+      Modifies: [m_scenes, m_pendingScenes, m_camera].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     void Renderer::Update(_In_ FLOAT deltaTime)
     {
-        m_scenes[m_pszMainSceneName]->Update(deltaTime);
+        for (auto it = m_pendingScenes.begin(); it != m_pendingScenes.end();)
+        {
+            HRESULT hr = it->second->Poll(m_d3dDevice.Get(), m_immediateContext.Get());
+            if (hr == S_FALSE)
+            {
+                ++it;
+                continue;
+            }
+
+            if (SUCCEEDED(hr))
+            {
+                m_scenes[it->first] = it->second->GetScene();
+                if (m_pszMainSceneName && it->first == m_pszMainSceneName)
+                {
+                    m_camera.SetCollider(m_scenes[it->first]->GetVoxelCollider());
+                }
+            }
+            else
+            {
+                WCHAR szReport[256];
+                swprintf_s(szReport, L"Renderer: loading the scene %s failed (0x%08X)\n", it->first.c_str(), static_cast<UINT>(hr));
+                OutputDebugString(szReport);
+            }
+            it = m_pendingScenes.erase(it);
+        }
 
         m_camera.Update(deltaTime);
+
+        if (!m_scenes.contains(m_pszMainSceneName))
+        {
+            return;
+        }
+
+        m_scenes[m_pszMainSceneName]->Update(deltaTime);
+
+        if (FAILED(m_scenes[m_pszMainSceneName]->UpdateVoxelStreaming(m_camera.GetEye(), m_d3dDevice.Get(), m_immediateContext.Get())))
+        {
+            OutputDebugString(L"Renderer: failed to upload the streamed voxel chunks\n");
+        }
+
+        if (FAILED(m_scenes[m_pszMainSceneName]->FlushVoxelEdits(m_d3dDevice.Get(), m_immediateContext.Get())))
+        {
+            OutputDebugString(L"Renderer: failed to upload the edited voxel instances\n");
+        }
     }
 
 
@@ -507,7 +582,7 @@ namespace library
                 );
                 m_immediateContext->IASetIndexBuffer(
                     iRenderable->second->GetIndexBuffer().Get(),
-                    DXGI_FORMAT_R16_UINT,
+                    iRenderable->second->GetIndexFormat(),
                     0
                 );
                 m_immediateContext->IASetInputLayout(iRenderable->second->GetVertexLayout().Get());
@@ -642,21 +717,26 @@ namespace library
             std::vector<std::shared_ptr<Voxel>> voxel = iScene->second->GetVoxels();
             for (UINT i = 0; i < voxel.size(); i++)
             {
-                UINT uStrides[3] = {
+                UINT uStrides[5] = {
                     static_cast<UINT>(sizeof(SimpleVertex)),
                     static_cast<UINT>(sizeof(NormalData)),
-                    static_cast<UINT>(sizeof(InstanceData)) };
-                UINT uOffsets[3] = { 0u, 0u, 0u };
-                ComPtr<ID3D11Buffer> VoxelBuffers[3] = {
+                    voxel[i]->GetInstanceStride(),
+                    static_cast<UINT>(sizeof(InstanceHorizonData)),
+                    static_cast<UINT>(sizeof(InstanceLightData)) };
+                UINT uOffsets[5] = { 0u, 0u, 0u, 0u, 0u };
+                ComPtr<ID3D11Buffer> VoxelBuffers[5] = {
                     voxel[i]->GetVertexBuffer(),
                     voxel[i]->GetNormalBuffer(),
-                    voxel[i]->GetInstanceBuffer()
+                    voxel[i]->GetInstanceBuffer(),
+                    voxel[i]->GetHorizonBuffer(),
+                    voxel[i]->GetLightBuffer()
                 };
 
-                //Set the buffers, and input layout
+                //Set the buffers, and input layout. The horizons and the
+                //light of the instances follow them when they were baked
                 m_immediateContext->IASetVertexBuffers(
                     0u,
-                    3u,
+                    VoxelBuffers[4] ? 5u : (VoxelBuffers[3] ? 4u : 3u),
                     VoxelBuffers->GetAddressOf(),
                     uStrides,
                     uOffsets
@@ -19,6 +19,7 @@
 #include "Renderer/DataTypes.h"
 #include "Renderer/Renderable.h"
 #include "Scene/Scene.h"
+#include "Scene/SceneLoadHandle.h"
 #include "Shader/PixelShader.h"
 #include "Shader/VertexShader.h"
 #include "Window/MainWindow.h"
@@ -37,6 +38,8 @@ namespace library
                   Creates Direct3D device and swap chain
                 AddRenderable
                   Add a renderable object and initialize the object
+                AddSceneAsync
+                  Add a scene that is still loading
                 Update
                   Update the renderables each frame
                 Render
@@ -61,6 +64,7 @@ namespace library
         HRESULT Initialize(_In_ HWND hWnd);
 
         HRESULT AddScene(_In_ PCWSTR pszSceneName, _In_ const std::shared_ptr<Scene>& scene);
+        HRESULT AddSceneAsync(_In_ PCWSTR pszSceneName, _In_ const std::shared_ptr<SceneLoadHandle>& loadHandle);
         std::shared_ptr<Scene> GetSceneOrNull(_In_ PCWSTR pszSceneName);
         HRESULT SetMainScene(_In_ PCWSTR pszSceneName);
         void SetShadowMapShaders(_In_ std::shared_ptr<ShadowVertexShader> vertexShader, _In_ std::shared_ptr<PixelShader> pixelShader);
@@ -93,6 +97,7 @@ namespace library
         XMMATRIX m_projection;
 
         std::unordered_map<std::wstring, std::shared_ptr<Scene>> m_scenes;
+        std::unordered_map<std::wstring, std::shared_ptr<SceneLoadHandle>> m_pendingScenes;
         std::shared_ptr<Texture> m_invalidTexture;
         std::shared_ptr<RenderTexture> m_shadowMapTexture;
         std::shared_ptr<ShadowVertexShader> m_shadowVertexShader;
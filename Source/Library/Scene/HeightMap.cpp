@@ -0,0 +1,812 @@
+#include "Scene/HeightMap.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::ConvertTextToBinary
+
+      Summary:  Converts a height map written in the text format into
+                the binary format, unless the binary file is already at
+                least as recent as the text file
+
+      Args:     const std::filesystem::path& textFilePath
+                  Path to the text height map
+                const std::filesystem::path& binaryFilePath
+                  Path to the binary height map to write
+
+      Returns:  HRESULT
+                  Status code, S_FALSE if the binary file is up to date
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::ConvertTextToBinary(_In_ const std::filesystem::path& textFilePath, _In_ const std::filesystem::path& binaryFilePath)
+    {
+        std::error_code error;
+        const std::filesystem::file_time_type textTime = std::filesystem::last_write_time(textFilePath, error);
+        if (error)
+        {
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+        }
+
+        const std::filesystem::file_time_type binaryTime = std::filesystem::last_write_time(binaryFilePath, error);
+        if (!error && binaryTime >= textTime)
+        {
+            return S_FALSE;
+        }
+
+        HeightMap heightMap;
+
+        HRESULT hr = heightMap.loadText(textFilePath);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        return heightMap.SaveBinary(binaryFilePath);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::HeightMap
+
+      Summary:  Constructor
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aColumns,
+                 m_pColumns, m_ullFileSize, m_hFile, m_hFileMapping,
+                 m_pView].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HeightMap::HeightMap()
+        : m_uWidth(0u)
+        , m_uHeight(0u)
+        , m_uDepth(0u)
+        , m_aPalette()
+        , m_aColumns()
+        , m_pColumns(nullptr)
+        , m_ullFileSize(0ull)
+        , m_hFile(INVALID_HANDLE_VALUE)
+        , m_hFileMapping(nullptr)
+        , m_pView(nullptr)
+    { }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::~HeightMap
+
+      Summary:  Destructor. Unmaps the binary file if it is mapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HeightMap::~HeightMap()
+    {
+        reset();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::LoadFromFile
+
+      Summary:  Loads the height map. Files starting with the binary
+                magic number are memory-mapped, the others are parsed
+                as the text format
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the height map
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aColumns,
+                 m_pColumns, m_ullFileSize, m_hFile, m_hFileMapping,
+                 m_pView].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::LoadFromFile(_In_ const std::filesystem::path& filePath)
+    {
+        DWORD uMagic = 0u;
+        {
+            std::ifstream inputFile(filePath, std::ios::binary);
+            if (!inputFile.is_open())
+            {
+                return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+            }
+
+            inputFile.read(reinterpret_cast<CHAR*>(&uMagic), sizeof(uMagic));
+        }
+
+        if (uMagic == FILE_MAGIC)
+        {
+            return loadBinary(filePath);
+        }
+
+        return loadText(filePath);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::Assign
+
+      Summary:  Replaces the height map with columns built in memory,
+                taking ownership of them without a copy
+
+      Args:     UINT uWidth
+                  Number of columns along the x-axis
+                UINT uHeight
+                  Vertical dimension of the map
+                UINT uDepth
+                  Number of columns along the z-axis
+                const std::vector<XMFLOAT4>& aPalette
+                  Colors indexed from eBlockType::GRASSLAND
+                std::vector<HeightMapColumn>&& aColumns
+                  uWidth * uDepth columns, row by row along z
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aColumns,
+                 m_pColumns, m_ullFileSize, m_hFile, m_hFileMapping,
+                 m_pView].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::Assign(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth, _In_ const std::vector<XMFLOAT4>& aPalette, _Inout_ std::vector<HeightMapColumn>&& aColumns)
+    {
+        if (aColumns.size() != static_cast<size_t>(uWidth) * static_cast<size_t>(uDepth))
+        {
+            return E_INVALIDARG;
+        }
+
+        reset();
+
+        m_uWidth = uWidth;
+        m_uHeight = uHeight;
+        m_uDepth = uDepth;
+        m_aPalette = aPalette;
+        m_aColumns = std::move(aColumns);
+        m_pColumns = m_aColumns.data();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::SaveBinary
+
+      Summary:  Writes the height map in the binary format
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the binary file to write
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::SaveBinary(_In_ const std::filesystem::path& filePath) const
+    {
+        std::ofstream outputFile(filePath, std::ios::binary | std::ios::trunc);
+        if (!outputFile.is_open())
+        {
+            return E_FAIL;
+        }
+
+        UINT64 ullPaletteSize = static_cast<UINT64>(m_aPalette.size()) * sizeof(XMFLOAT3);
+
+        // Columns are aligned to 16 bytes so they can be read in place
+        HeightMapFileHeader header =
+        {
+            .uMagic = FILE_MAGIC,
+            .uVersion = FILE_VERSION,
+            .uWidth = m_uWidth,
+            .uHeight = m_uHeight,
+            .uDepth = m_uDepth,
+            .uNumColors = static_cast<UINT>(m_aPalette.size()),
+            .ullPaletteOffset = sizeof(HeightMapFileHeader),
+            .ullColumnsOffset = (sizeof(HeightMapFileHeader) + ullPaletteSize + 15ull) & ~15ull
+        };
+        outputFile.write(reinterpret_cast<const CHAR*>(&header), sizeof(header));
+
+        for (const XMFLOAT4& color : m_aPalette)
+        {
+            XMFLOAT3 rgb(color.x, color.y, color.z);
+            outputFile.write(reinterpret_cast<const CHAR*>(&rgb), sizeof(rgb));
+        }
+
+        const CHAR aPadding[16] = { 0, };
+        outputFile.write(aPadding, static_cast<std::streamsize>(header.ullColumnsOffset - header.ullPaletteOffset - ullPaletteSize));
+
+        outputFile.write(reinterpret_cast<const CHAR*>(m_pColumns), static_cast<std::streamsize>(GetNumColumns() * sizeof(HeightMapColumn)));
+
+        if (outputFile.fail())
+        {
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetWidth
+
+      Summary:  Returns the number of columns along the x-axis
+
+      Returns:  UINT
+                  Width of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT HeightMap::GetWidth() const
+    {
+        return m_uWidth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetHeight
+
+      Summary:  Returns the vertical dimension of the map
+
+      Returns:  UINT
+                  Height of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT HeightMap::GetHeight() const
+    {
+        return m_uHeight;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetDepth
+
+      Summary:  Returns the number of columns along the z-axis
+
+      Returns:  UINT
+                  Depth of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT HeightMap::GetDepth() const
+    {
+        return m_uDepth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetPalette
+
+      Summary:  Returns the colors of the block types
+
+      Returns:  const std::vector<XMFLOAT4>&
+                  Colors indexed from eBlockType::GRASSLAND
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<XMFLOAT4>& HeightMap::GetPalette() const
+    {
+        return m_aPalette;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetColumns
+
+      Summary:  Returns the array of columns, row by row along z
+
+      Returns:  const HeightMapColumn*
+                  Columns. Points into the mapped file when IsMapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const HeightMapColumn* HeightMap::GetColumns() const
+    {
+        return m_pColumns;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetColumn
+
+      Summary:  Returns the column at the given coordinate
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT z
+                  Index along the z-axis
+
+      Returns:  const HeightMapColumn&
+                  Column
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const HeightMapColumn& HeightMap::GetColumn(_In_ UINT x, _In_ UINT z) const
+    {
+        assert(x < m_uWidth && z < m_uDepth);
+
+        return m_pColumns[static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x)];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetNumColumns
+
+      Summary:  Returns the number of columns
+
+      Returns:  size_t
+                  Width times depth
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t HeightMap::GetNumColumns() const
+    {
+        return static_cast<size_t>(m_uWidth) * static_cast<size_t>(m_uDepth);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetVoxelPosition
+
+      Summary:  Returns the world position of the center of a voxel
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+
+      Returns:  XMFLOAT3
+                  Center of the voxel
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMFLOAT3 HeightMap::GetVoxelPosition(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        return XMFLOAT3(
+            2.0f * (static_cast<FLOAT>(x) - static_cast<FLOAT>(m_uWidth) / 2.0f),
+            2.0f * (static_cast<FLOAT>(y) - static_cast<FLOAT>(m_uHeight)) + (static_cast<FLOAT>(m_uHeight) * 0.75f),
+            2.0f * (static_cast<FLOAT>(z) - static_cast<FLOAT>(m_uDepth) / 2.0f)
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetGridTransform
+
+      Summary:  Returns the transform from grid space, where a cell
+                spans one unit, to world space. It maps the cell (x, y,
+                z) onto GetVoxelPosition(x, y, z)
+
+      Returns:  XMMATRIX
+                  Grid to world transform
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMMATRIX HeightMap::GetGridTransform() const
+    {
+        return XMMatrixScaling(2.0f, 2.0f, 2.0f) * XMMatrixTranslation(
+            -static_cast<FLOAT>(m_uWidth),
+            static_cast<FLOAT>(m_uHeight) * 0.75f - 2.0f * static_cast<FLOAT>(m_uHeight),
+            -static_cast<FLOAT>(m_uDepth)
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::IsMapped
+
+      Summary:  Returns whether the columns are read from a
+                memory-mapped binary file
+
+      Returns:  BOOL
+                  Whether the file is mapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightMap::IsMapped() const
+    {
+        return m_pView != nullptr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetFileSize
+
+      Summary:  Returns the size of the loaded file
+
+      Returns:  UINT64
+                  Size of the file in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 HeightMap::GetFileSize() const
+    {
+        return m_ullFileSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::loadBinary
+
+      Summary:  Memory-maps a binary height map and validates it. The
+                palette must fit the block types and every column must
+                name a block type that has a color
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the binary height map
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_pColumns,
+                 m_ullFileSize, m_hFile, m_hFileMapping, m_pView].
+
+      Returns:  HRESULT
+                  Status code, E_FAIL if the file is corrupt or truncated
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::loadBinary(_In_ const std::filesystem::path& filePath)
+    {
+        reset();
+
+        m_hFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(m_hFile, &fileSize))
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            reset();
+            return hr;
+        }
+
+        if (static_cast<UINT64>(fileSize.QuadPart) < sizeof(HeightMapFileHeader))
+        {
+            reset();
+            return E_FAIL;
+        }
+
+        m_hFileMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+        if (!m_hFileMapping)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            reset();
+            return hr;
+        }
+
+        m_pView = MapViewOfFile(m_hFileMapping, FILE_MAP_READ, 0u, 0u, 0u);
+        if (!m_pView)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            reset();
+            return hr;
+        }
+
+        const BYTE* pBytes = static_cast<const BYTE*>(m_pView);
+        const HeightMapFileHeader* pHeader = reinterpret_cast<const HeightMapFileHeader*>(pBytes);
+
+        const UINT64 ullFileSize = static_cast<UINT64>(fileSize.QuadPart);
+        const UINT64 ullNumColumns = static_cast<UINT64>(pHeader->uWidth) * static_cast<UINT64>(pHeader->uDepth);
+        if (pHeader->uMagic != FILE_MAGIC ||
+            pHeader->uVersion != FILE_VERSION ||
+            pHeader->uNumColors > MAX_NUM_COLORS ||
+            pHeader->ullPaletteOffset > ullFileSize ||
+            static_cast<UINT64>(pHeader->uNumColors) * sizeof(XMFLOAT3) > ullFileSize - pHeader->ullPaletteOffset ||
+            pHeader->ullColumnsOffset % alignof(HeightMapColumn) != 0ull ||
+            pHeader->ullColumnsOffset > ullFileSize ||
+            ullNumColumns > (ullFileSize - pHeader->ullColumnsOffset) / sizeof(HeightMapColumn))
+        {
+            reset();
+            return E_FAIL;
+        }
+
+        const HeightMapColumn* pColumns = reinterpret_cast<const HeightMapColumn*>(pBytes + pHeader->ullColumnsOffset);
+        for (UINT64 i = 0ull; i < ullNumColumns; ++i)
+        {
+            if (pColumns[i].BlockType < static_cast<CHAR>(eBlockType::GRASSLAND) ||
+                pColumns[i].BlockType >= static_cast<CHAR>(eBlockType::COUNT) ||
+                static_cast<UINT>(pColumns[i].BlockType - static_cast<CHAR>(eBlockType::GRASSLAND)) >= pHeader->uNumColors)
+            {
+                reset();
+                return E_FAIL;
+            }
+        }
+
+        m_uWidth = pHeader->uWidth;
+        m_uHeight = pHeader->uHeight;
+        m_uDepth = pHeader->uDepth;
+
+        const XMFLOAT3* pPalette = reinterpret_cast<const XMFLOAT3*>(pBytes + pHeader->ullPaletteOffset);
+        m_aPalette.reserve(pHeader->uNumColors);
+        for (UINT i = 0u; i < pHeader->uNumColors; ++i)
+        {
+            m_aPalette.push_back(XMFLOAT4(pPalette[i].x, pPalette[i].y, pPalette[i].z, 1.0f));
+        }
+
+        m_pColumns = pColumns;
+        m_ullFileSize = ullFileSize;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::loadText
+
+      Summary:  Reads a height map written in the text format at once
+                and parses its rows on worker threads
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the text height map
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aColumns,
+                 m_pColumns, m_ullFileSize].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::loadText(_In_ const std::filesystem::path& filePath)
+    {
+        reset();
+
+        std::string text;
+        {
+            std::ifstream inputFile(filePath, std::ios::binary);
+            if (!inputFile.is_open())
+            {
+                return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+            }
+
+            std::error_code errorCode;
+            UINT64 ullFileSize = static_cast<UINT64>(std::filesystem::file_size(filePath, errorCode));
+            if (errorCode)
+            {
+                return E_FAIL;
+            }
+
+            text.resize(static_cast<size_t>(ullFileSize));
+            inputFile.read(text.data(), static_cast<std::streamsize>(text.size()));
+            text.resize(static_cast<size_t>(inputFile.gcount()));
+        }
+        m_ullFileSize = text.size();
+
+        const CHAR* pCursor = text.data();
+        const CHAR* pEnd = text.data() + text.size();
+
+        UINT aDimension[4] = { 0u, };
+        UINT uDimensionIdx = 0u;
+        while (uDimensionIdx < ARRAYSIZE(aDimension))
+        {
+            pCursor = skipWhitespace(pCursor, pEnd);
+            if (pCursor == pEnd)
+            {
+                break;
+            }
+
+            std::from_chars_result result = std::from_chars(pCursor, pEnd, aDimension[uDimensionIdx]);
+            if (result.ec != std::errc())
+            {
+                pCursor = skipToken(pCursor, pEnd);
+            }
+            else
+            {
+                pCursor = result.ptr;
+                ++uDimensionIdx;
+            }
+        }
+
+        m_uWidth = aDimension[0];
+        m_uHeight = aDimension[1];
+        m_uDepth = aDimension[2];
+
+        XMFLOAT4 color;
+        while (m_aPalette.size() < aDimension[3])
+        {
+            if (!parseFloat(pCursor, pEnd, color.x) || !parseFloat(pCursor, pEnd, color.y) || !parseFloat(pCursor, pEnd, color.z))
+            {
+                if (pCursor == pEnd)
+                {
+                    break;
+                }
+                pCursor = skipToken(pCursor, pEnd);
+            }
+            else
+            {
+                color.w = 1.0f;
+                m_aPalette.push_back(color);
+            }
+        }
+
+        m_aColumns.assign(GetNumColumns(), HeightMapColumn{ .BlockType = static_cast<CHAR>(eBlockType::GRASSLAND), .Reserved = 0u, .uHeight = 0u });
+        m_pColumns = m_aColumns.data();
+        if (m_aColumns.empty())
+        {
+            return S_OK;
+        }
+
+        // Split the rows into line-aligned chunks, one per worker
+        size_t uNumChunks = std::clamp<size_t>(
+            static_cast<size_t>(pEnd - pCursor) / MIN_PARSE_CHUNK_SIZE,
+            1u,
+            std::max<size_t>(std::thread::hardware_concurrency(), 1u)
+        );
+        std::vector<const CHAR*> aChunkBounds(uNumChunks + 1u, pEnd);
+        aChunkBounds[0] = pCursor;
+        for (size_t i = 1u; i < uNumChunks; ++i)
+        {
+            const CHAR* pBound = std::max<const CHAR*>(aChunkBounds[i - 1u], pCursor + (pEnd - pCursor) * static_cast<ptrdiff_t>(i) / static_cast<ptrdiff_t>(uNumChunks));
+            pBound = std::find(pBound, pEnd, '\n');
+            aChunkBounds[i] = pBound == pEnd ? pEnd : pBound + 1;
+        }
+
+        std::vector<std::vector<HeightMapColumn>> aChunkColumns(uNumChunks);
+        {
+            std::vector<std::thread> aWorkers;
+            aWorkers.reserve(uNumChunks - 1u);
+            for (size_t i = 1u; i < uNumChunks; ++i)
+            {
+                aWorkers.emplace_back(parseRows, aChunkBounds[i], aChunkBounds[i + 1u], m_uHeight, std::ref(aChunkColumns[i]));
+            }
+            parseRows(aChunkBounds[0], aChunkBounds[1], m_uHeight, aChunkColumns[0]);
+
+            for (std::thread& worker : aWorkers)
+            {
+                worker.join();
+            }
+        }
+
+        // Chunks are written in file order so the columns wrap exactly
+        // as they would with a single pass over the file
+        size_t uColumnIdx = 0u;
+        for (const std::vector<HeightMapColumn>& aColumns : aChunkColumns)
+        {
+            for (const HeightMapColumn& column : aColumns)
+            {
+                m_aColumns[uColumnIdx] = column;
+
+                ++uColumnIdx;
+                if (uColumnIdx >= m_aColumns.size())
+                {
+                    uColumnIdx = 0u;
+                }
+            }
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::parseRows
+
+      Summary:  Parses the cells of a range of rows of the text format.
+                Each cell is a block type character followed by a
+                height. Unreadable tokens are skipped and cells of an
+                unknown block type are dropped
+
+      Args:     const CHAR* pBegin
+                  Beginning of the range, at the start of a line
+                const CHAR* pEnd
+                  End of the range
+                UINT uHeight
+                  Vertical dimension of the map
+                std::vector<HeightMapColumn>& aColumns
+                  Receives the parsed columns in order
+
+      Modifies: [aColumns].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::parseRows(_In_ const CHAR* pBegin, _In_ const CHAR* pEnd, _In_ UINT uHeight, _Out_ std::vector<HeightMapColumn>& aColumns)
+    {
+        // Every cell takes at least three characters
+        aColumns.reserve(static_cast<size_t>(pEnd - pBegin) / 3u);
+
+        const CHAR* pCursor = pBegin;
+        while (true)
+        {
+            pCursor = skipWhitespace(pCursor, pEnd);
+            if (pCursor == pEnd)
+            {
+                break;
+            }
+
+            CHAR voxelType = *pCursor++;
+            FLOAT height;
+            if (!parseFloat(pCursor, pEnd, height))
+            {
+                if (pCursor == pEnd)
+                {
+                    break;
+                }
+                pCursor = skipToken(pCursor, pEnd);
+            }
+            else if (static_cast<CHAR>(eBlockType::GRASSLAND) <= voxelType && voxelType < static_cast<CHAR>(eBlockType::COUNT))
+            {
+                // Quantize the height into the number of stacked voxels
+                FLOAT numVoxels = std::clamp(static_cast<FLOAT>(uHeight) * height, 0.0f, 65535.0f);
+
+                aColumns.push_back(
+                    HeightMapColumn
+                    {
+                        .BlockType = voxelType,
+                        .Reserved = 0u,
+                        .uHeight = static_cast<WORD>(numVoxels)
+                    }
+                );
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::parseFloat
+
+      Summary:  Skips the leading whitespace and parses a finite float
+
+      Args:     const CHAR*& pCursor
+                  Current position, advanced past the float on success
+                  and to the first non-whitespace character otherwise
+                const CHAR* pEnd
+                  End of the text
+                FLOAT& value
+                  Receives the parsed value
+
+      Returns:  BOOL
+                  TRUE if a finite float was parsed, FALSE for an
+                  infinity or a NaN as for any unreadable value
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightMap::parseFloat(_Inout_ const CHAR*& pCursor, _In_ const CHAR* pEnd, _Out_ FLOAT& value)
+    {
+        pCursor = skipWhitespace(pCursor, pEnd);
+
+        const CHAR* pNumber = pCursor;
+        if (pNumber != pEnd && *pNumber == '+')
+        {
+            ++pNumber;
+        }
+
+        // from_chars also reads inf and nan, which the stream the text
+        // format was read with rejects
+        std::from_chars_result result = std::from_chars(pNumber, pEnd, value);
+        if (result.ec != std::errc() || !std::isfinite(value))
+        {
+            return FALSE;
+        }
+
+        pCursor = result.ptr;
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::skipWhitespace
+
+      Summary:  Returns the first non-whitespace character
+
+      Args:     const CHAR* pCursor
+                  Current position
+                const CHAR* pEnd
+                  End of the text
+
+      Returns:  const CHAR*
+                  First non-whitespace character or pEnd
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const CHAR* HeightMap::skipWhitespace(_In_ const CHAR* pCursor, _In_ const CHAR* pEnd)
+    {
+        while (pCursor != pEnd && (*pCursor == ' ' || ('\t' <= *pCursor && *pCursor <= '\r')))
+        {
+            ++pCursor;
+        }
+
+        return pCursor;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::skipToken
+
+      Summary:  Skips the whitespace-delimited token at the cursor
+
+      Args:     const CHAR* pCursor
+                  Current position
+                const CHAR* pEnd
+                  End of the text
+
+      Returns:  const CHAR*
+                  Character following the token
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const CHAR* HeightMap::skipToken(_In_ const CHAR* pCursor, _In_ const CHAR* pEnd)
+    {
+        pCursor = skipWhitespace(pCursor, pEnd);
+        while (pCursor != pEnd && !(*pCursor == ' ' || ('\t' <= *pCursor && *pCursor <= '\r')))
+        {
+            ++pCursor;
+        }
+
+        return pCursor;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::reset
+
+      Summary:  Clears the height map and unmaps the binary file
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aColumns,
+                 m_pColumns, m_ullFileSize, m_hFile, m_hFileMapping,
+                 m_pView].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::reset()
+    {
+        if (m_pView)
+        {
+            UnmapViewOfFile(m_pView);
+            m_pView = nullptr;
+        }
+
+        if (m_hFileMapping)
+        {
+            CloseHandle(m_hFileMapping);
+            m_hFileMapping = nullptr;
+        }
+
+        if (m_hFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_hFile);
+            m_hFile = INVALID_HANDLE_VALUE;
+        }
+
+        m_uWidth = 0u;
+        m_uHeight = 0u;
+        m_uDepth = 0u;
+        m_aPalette.clear();
+        m_aColumns.clear();
+        m_pColumns = nullptr;
+        m_ullFileSize = 0ull;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+/*+===================================================================
+  File:      HEIGHTMAP.H
+
+  Summary:   HeightMap header file contains declarations of HeightMap
+             class that loads the voxel height map either from the
+             text format or from the memory-mapped binary format.
+
+  Classes: HeightMap
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   HeightMapColumn
+
+        Summary:  Packed column of the height map, the block type and
+                  the number of voxels stacked from the ground
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct HeightMapColumn
+    {
+        CHAR BlockType;
+        BYTE Reserved;
+        WORD uHeight;
+    };
+    static_assert(sizeof(HeightMapColumn) == 4u);
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   HeightMapFileHeader
+
+        Summary:  Header of the binary height map file. The palette
+                  (uNumColors XMFLOAT3) and the columns (uWidth * uDepth
+                  HeightMapColumn, row by row along z) follow at the
+                  given offsets
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct HeightMapFileHeader
+    {
+        DWORD uMagic;
+        DWORD uVersion;
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+        UINT uNumColors;
+        UINT64 ullPaletteOffset;
+        UINT64 ullColumnsOffset;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    HeightMap
+
+      Summary:  Grid of voxel columns loaded from a height map file or
+                built in memory. Binary files are memory-mapped and
+                their columns are read in place without being copied
+
+      Methods:  ConvertTextToBinary
+                  Converts a text height map into the binary format
+                LoadFromFile
+                  Loads a text or binary height map
+                Assign
+                  Takes columns built in memory
+                SaveBinary
+                  Writes the height map in the binary format
+                GetWidth
+                  Returns the number of columns along x
+                GetHeight
+                  Returns the vertical dimension of the map
+                GetDepth
+                  Returns the number of columns along z
+                GetPalette
+                  Returns the colors of the block types
+                GetColumns
+                  Returns the array of columns
+                GetColumn
+                  Returns the column at the given coordinate
+                GetNumColumns
+                  Returns the number of columns
+                GetVoxelPosition
+                  Returns the world position of a voxel
+                GetGridTransform
+                  Returns the transform from grid to world space
+                IsMapped
+                  Returns whether the columns are memory-mapped
+                GetFileSize
+                  Returns the size of the loaded file
+                HeightMap
+                  Constructor.
+                ~HeightMap
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class HeightMap
+    {
+    public:
+        static constexpr const DWORD FILE_MAGIC = 0x50414D48u; // "HMAP"
+        static constexpr const DWORD FILE_VERSION = 1u;
+        static constexpr const UINT MAX_NUM_COLORS = static_cast<UINT>(eBlockType::COUNT) - static_cast<UINT>(eBlockType::GRASSLAND);
+        static constexpr const size_t MIN_PARSE_CHUNK_SIZE = 64u * 1024u;
+
+        static HRESULT ConvertTextToBinary(_In_ const std::filesystem::path& textFilePath, _In_ const std::filesystem::path& binaryFilePath);
+
+        HeightMap();
+        HeightMap(const HeightMap& other) = delete;
+        HeightMap(HeightMap&& other) = delete;
+        HeightMap& operator=(const HeightMap& other) = delete;
+        HeightMap& operator=(HeightMap&& other) = delete;
+        ~HeightMap();
+
+        HRESULT LoadFromFile(_In_ const std::filesystem::path& filePath);
+        HRESULT Assign(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth, _In_ const std::vector<XMFLOAT4>& aPalette, _Inout_ std::vector<HeightMapColumn>&& aColumns);
+        HRESULT SaveBinary(_In_ const std::filesystem::path& filePath) const;
+
+        UINT GetWidth() const;
+        UINT GetHeight() const;
+        UINT GetDepth() const;
+        const std::vector<XMFLOAT4>& GetPalette() const;
+        const HeightMapColumn* GetColumns() const;
+        const HeightMapColumn& GetColumn(_In_ UINT x, _In_ UINT z) const;
+        size_t GetNumColumns() const;
+        XMFLOAT3 GetVoxelPosition(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+        XMMATRIX GetGridTransform() const;
+        BOOL IsMapped() const;
+        UINT64 GetFileSize() const;
+
+    private:
+        HRESULT loadBinary(_In_ const std::filesystem::path& filePath);
+        HRESULT loadText(_In_ const std::filesystem::path& filePath);
+        void reset();
+
+        static void parseRows(_In_ const CHAR* pBegin, _In_ const CHAR* pEnd, _In_ UINT uHeight, _Out_ std::vector<HeightMapColumn>& aColumns);
+        static BOOL parseFloat(_Inout_ const CHAR*& pCursor, _In_ const CHAR* pEnd, _Out_ FLOAT& value);
+        static const CHAR* skipWhitespace(_In_ const CHAR* pCursor, _In_ const CHAR* pEnd);
+        static const CHAR* skipToken(_In_ const CHAR* pCursor, _In_ const CHAR* pEnd);
+
+    private:
+        UINT m_uWidth;
+        UINT m_uHeight;
+        UINT m_uDepth;
+        std::vector<XMFLOAT4> m_aPalette;
+        std::vector<HeightMapColumn> m_aColumns;
+        const HeightMapColumn* m_pColumns;
+        UINT64 m_ullFileSize;
+
+        HANDLE m_hFile;
+        HANDLE m_hFileMapping;
+        LPVOID m_pView;
+    };
+}
\ No newline at end of file
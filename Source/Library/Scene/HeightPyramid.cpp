@@ -0,0 +1,1305 @@
+#include "Scene/HeightPyramid.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::HeightPyramid
+
+      Summary:  Constructor. Builds the pyramid from the height map
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map of the terrain
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Occupancy of the cells, read for edited columns
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_aLevels, m_gridOrigin,
+                 m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HeightPyramid::HeightPyramid(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_aLevels()
+        , m_gridOrigin()
+        , m_stats()
+    {
+        XMFLOAT3 firstCell = m_heightMap->GetVoxelPosition(0u, 0u, 0u);
+        m_gridOrigin = XMFLOAT3(firstCell.x - 1.0f, firstCell.y - 1.0f, firstCell.z - 1.0f);
+
+        build();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::IntersectRay
+
+      Summary:  Returns the first column a ray hits, as the cell of the
+                column the ray enters
+
+      Args:     const VoxelRay& ray
+                  Ray in world space
+                VoxelRayHit& hit
+                  Receives the hit
+                UINT* puNumNodes
+                  Receives the number of nodes visited
+
+      Returns:  BOOL
+                  TRUE if the ray hits the terrain within its maximum
+                  distance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::IntersectRay(_In_ const VoxelRay& ray, _Out_ VoxelRayHit& hit, _Out_opt_ UINT* puNumNodes) const
+    {
+        hit = {};
+        if (puNumNodes)
+        {
+            *puNumNodes = 0u;
+        }
+
+        GridRay gridRay;
+        ColumnHit columnHit;
+        if (!toGridRay(ray.Origin, ray.Direction, 0.0f, ray.MaxDistance, gridRay) || !intersect(gridRay, columnHit, puNumNodes))
+        {
+            return FALSE;
+        }
+
+        fillHit(gridRay, columnHit, hit);
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::IsInShadow
+
+      Summary:  Returns whether the terrain lies between a point and a
+                light. The segment starts SHADOW_BIAS away from the
+                point so that a point on the surface does not shadow
+                itself
+
+      Args:     const XMFLOAT3& point
+                  Point in world space
+                const XMFLOAT3& lightPosition
+                  Position of the light in world space
+
+      Returns:  BOOL
+                  TRUE if the light is hidden from the point
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::IsInShadow(_In_ const XMFLOAT3& point, _In_ const XMFLOAT3& lightPosition) const
+    {
+        XMFLOAT3 direction(lightPosition.x - point.x, lightPosition.y - point.y, lightPosition.z - point.z);
+        FLOAT length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+
+        GridRay gridRay;
+        ColumnHit columnHit;
+        return toGridRay(point, direction, SHADOW_BIAS, length, gridRay) && intersect(gridRay, columnHit, nullptr);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::IsBoxOccluded
+
+      Summary:  Returns whether the terrain hides every point of a box
+                from an eye. The solid block under the lowest column of
+                each node the sight line to the center of the box passes
+                over is tried as an occluder, coarsest level first. The
+                test is conservative: a box reported occluded is hidden,
+                a hidden box may be reported visible, for instance when
+                only several occluders together hide it
+
+      Args:     const XMFLOAT3& eye
+                  Position of the eye in world space
+                const XMFLOAT3& boxMin
+                  Lower corner of the box in world space
+                const XMFLOAT3& boxMax
+                  Upper corner of the box in world space
+
+      Returns:  BOOL
+                  TRUE if the box is hidden
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::IsBoxOccluded(_In_ const XMFLOAT3& eye, _In_ const XMFLOAT3& boxMin, _In_ const XMFLOAT3& boxMax) const
+    {
+        const FLOAT aEye[3] = { (eye.x - m_gridOrigin.x) * 0.5f, (eye.y - m_gridOrigin.y) * 0.5f, (eye.z - m_gridOrigin.z) * 0.5f };
+        const FLOAT aBoxMin[3] =
+        {
+            (std::min<FLOAT>(boxMin.x, boxMax.x) - m_gridOrigin.x) * 0.5f,
+            (std::min<FLOAT>(boxMin.y, boxMax.y) - m_gridOrigin.y) * 0.5f,
+            (std::min<FLOAT>(boxMin.z, boxMax.z) - m_gridOrigin.z) * 0.5f
+        };
+        const FLOAT aBoxMax[3] =
+        {
+            (std::max<FLOAT>(boxMin.x, boxMax.x) - m_gridOrigin.x) * 0.5f,
+            (std::max<FLOAT>(boxMin.y, boxMax.y) - m_gridOrigin.y) * 0.5f,
+            (std::max<FLOAT>(boxMin.z, boxMax.z) - m_gridOrigin.z) * 0.5f
+        };
+        if (m_aLevels.empty() ||
+            (aEye[0] >= aBoxMin[0] && aEye[0] <= aBoxMax[0] && aEye[1] >= aBoxMin[1] && aEye[1] <= aBoxMax[1] && aEye[2] >= aBoxMin[2] && aEye[2] <= aBoxMax[2]))
+        {
+            return FALSE;
+        }
+
+        // Sight line from the eye to the center of the box, t from 0 to 1
+        GridRay segment = {};
+        for (INT a = 0; a < 3; ++a)
+        {
+            segment.aOrigin[a] = aEye[a];
+            segment.aDirection[a] = (aBoxMin[a] + aBoxMax[a]) * 0.5f - aEye[a];
+            segment.aInverse[a] = segment.aDirection[a] != 0.0f ? 1.0f / segment.aDirection[a] : FLT_MAX;
+        }
+        segment.MinT = 0.0f;
+        segment.MaxT = 1.0f;
+
+        UINT uWidth = m_aLevels[0].uWidth;
+        UINT uDepth = m_aLevels[0].uDepth;
+        FLOAT tEnter = segment.MinT;
+        FLOAT tExit = segment.MaxT;
+        INT iAxis = -1;
+        if (!clipFootprint(segment, 0.0f, static_cast<FLOAT>(uWidth), 0.0f, static_cast<FLOAT>(uDepth), tEnter, tExit, iAxis))
+        {
+            return FALSE;
+        }
+
+        INT iStepX = segment.aDirection[0] > 0.0f ? 1 : (segment.aDirection[0] < 0.0f ? -1 : 0);
+        INT iStepZ = segment.aDirection[2] > 0.0f ? 1 : (segment.aDirection[2] < 0.0f ? -1 : 0);
+        for (INT iLevel = static_cast<INT>(m_aLevels.size()) - 1; iLevel >= 0; --iLevel)
+        {
+            const Level& level = m_aLevels[iLevel];
+            UINT uSize = 1u << static_cast<UINT>(iLevel);
+            FLOAT size = static_cast<FLOAT>(uSize);
+
+            INT x = std::clamp<INT>(static_cast<INT>(floorf((segment.aOrigin[0] + segment.aDirection[0] * tEnter) / size)), 0, static_cast<INT>(level.uWidth) - 1);
+            INT z = std::clamp<INT>(static_cast<INT>(floorf((segment.aOrigin[2] + segment.aDirection[2] * tEnter) / size)), 0, static_cast<INT>(level.uDepth) - 1);
+            for (;;)
+            {
+                const HeightRange& range = level.aRanges[static_cast<size_t>(z) * level.uWidth + static_cast<size_t>(x)];
+                if (range.uMin > 0u)
+                {
+                    const FLOAT aOccluderMin[3] = { static_cast<FLOAT>(x * uSize), 0.0f, static_cast<FLOAT>(z * uSize) };
+                    const FLOAT aOccluderMax[3] =
+                    {
+                        static_cast<FLOAT>(std::min<UINT>((x + 1) * uSize, uWidth)),
+                        static_cast<FLOAT>(range.uMin),
+                        static_cast<FLOAT>(std::min<UINT>((z + 1) * uSize, uDepth))
+                    };
+                    if (occludes(aEye, aBoxMin, aBoxMax, aOccluderMin, aOccluderMax))
+                    {
+                        return TRUE;
+                    }
+                }
+
+                FLOAT tNextX = iStepX != 0 ? (static_cast<FLOAT>(x + (iStepX > 0 ? 1 : 0)) * size - segment.aOrigin[0]) * segment.aInverse[0] : FLT_MAX;
+                FLOAT tNextZ = iStepZ != 0 ? (static_cast<FLOAT>(z + (iStepZ > 0 ? 1 : 0)) * size - segment.aOrigin[2]) * segment.aInverse[2] : FLT_MAX;
+                if (std::min<FLOAT>(tNextX, tNextZ) > tExit)
+                {
+                    break;
+                }
+                if (tNextX < tNextZ)
+                {
+                    x += iStepX;
+                }
+                else
+                {
+                    z += iStepZ;
+                }
+                if (x < 0 || x >= static_cast<INT>(level.uWidth) || z < 0 || z >= static_cast<INT>(level.uDepth))
+                {
+                    break;
+                }
+            }
+        }
+
+        return FALSE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::UpdateColumn
+
+      Summary:  Reads a column back from the occupancy grid after an
+                edit and refreshes the nodes above it, one per level.
+                The lowest height of the column becomes the run of
+                solid cells from the ground and its top one above its
+                highest solid cell, so a hole dug into the column makes
+                it occlude less and a block placed above it is still
+                hit by rays
+
+      Args:     UINT x
+                  Index of the column along the x-axis
+                UINT z
+                  Index of the column along the z-axis
+
+      Modifies: [m_aLevels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightPyramid::UpdateColumn(_In_ UINT x, _In_ UINT z)
+    {
+        if (m_aLevels.empty() || x >= m_aLevels[0].uWidth || z >= m_aLevels[0].uDepth)
+        {
+            return;
+        }
+
+        const UINT64* pWords = m_occupancyGrid->GetColumnWords(static_cast<INT>(x), static_cast<INT>(z));
+        const UINT uWordsPerColumn = m_occupancyGrid->GetWordsPerColumn();
+        UINT uSolidHeight = 0u;
+        for (UINT uWordIdx = 0u; uWordIdx < uWordsPerColumn; ++uWordIdx)
+        {
+            uSolidHeight += static_cast<UINT>(std::countr_one(pWords[uWordIdx]));
+            if (pWords[uWordIdx] != ~0ull)
+            {
+                break;
+            }
+        }
+        UINT uTopHeight = 0u;
+        for (UINT uWordIdx = uWordsPerColumn; uWordIdx > 0u; --uWordIdx)
+        {
+            if (pWords[uWordIdx - 1u] != 0ull)
+            {
+                uTopHeight = uWordIdx * OccupancyGrid::BITS_PER_WORD - static_cast<UINT>(std::countl_zero(pWords[uWordIdx - 1u]));
+                break;
+            }
+        }
+
+        m_aLevels[0].aRanges[static_cast<size_t>(z) * m_aLevels[0].uWidth + x] =
+        {
+            .uMin = static_cast<WORD>(std::min<UINT>(uSolidHeight, 0xFFFFu)),
+            .uMax = static_cast<WORD>(std::min<UINT>(uTopHeight, 0xFFFFu))
+        };
+        for (size_t uLevel = 1u; uLevel < m_aLevels.size(); ++uLevel)
+        {
+            x >>= 1u;
+            z >>= 1u;
+            m_aLevels[uLevel].aRanges[static_cast<size_t>(z) * m_aLevels[uLevel].uWidth + x] = mergeChildren(m_aLevels[uLevel - 1u], x, z);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::Benchmark
+
+      Summary:  Runs pseudo-random ray, shadow and occlusion queries
+                through the pyramid, then the first uNumBruteForceQueries
+                of each by marching every column along the way, and
+                compares the answers. Rays are cast at grazing angles
+                from above the terrain, shadows are tested from the tops
+                of columns to a low light, and boxes of one to four
+                cells are tested from eyes standing on the terrain
+
+      Args:     UINT uNumQueries
+                  Number of queries of each kind
+                UINT uNumBruteForceQueries
+                  Number of queries of each kind answered by marching
+
+      Modifies: [m_stats].
+
+      Returns:  const HeightPyramidStats&
+                  Statistics of the benchmark
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const HeightPyramidStats& HeightPyramid::Benchmark(_In_ UINT uNumQueries, _In_ UINT uNumBruteForceQueries)
+    {
+        // The build statistics are kept
+        HeightPyramidStats buildStats = m_stats;
+        m_stats = {};
+        m_stats.uNumLevels = buildStats.uNumLevels;
+        m_stats.ullMemoryBytes = buildStats.ullMemoryBytes;
+        m_stats.BuildMilliseconds = buildStats.BuildMilliseconds;
+        if (uNumQueries == 0u || m_aLevels.empty() || m_aLevels.back().aRanges[0].uMax == 0u)
+        {
+            return m_stats;
+        }
+        uNumBruteForceQueries = std::min<UINT>(uNumBruteForceQueries, uNumQueries);
+
+        const Level& columns = m_aLevels[0];
+        UINT uWidth = columns.uWidth;
+        UINT uDepth = columns.uDepth;
+        FLOAT maxHeight = static_cast<FLOAT>(m_aLevels.back().aRanges[0].uMax);
+        auto toWorld = [this](FLOAT x, FLOAT y, FLOAT z)
+        {
+            return XMFLOAT3(m_gridOrigin.x + 2.0f * x, m_gridOrigin.y + 2.0f * y, m_gridOrigin.z + 2.0f * z);
+        };
+
+        // Queries leave a fixed seed so that runs are comparable
+        BenchmarkRandom random;
+        auto randomColumn = [&random, &columns](UINT& x, UINT& z)
+        {
+            x = random.GetUint(columns.uWidth);
+            z = random.GetUint(columns.uDepth);
+            return static_cast<FLOAT>(columns.aRanges[static_cast<size_t>(z) * columns.uWidth + x].uMax);
+        };
+
+        std::vector<VoxelRay> aRays(uNumQueries);
+        for (VoxelRay& ray : aRays)
+        {
+            ray.Origin = toWorld(random.GetFloat() * static_cast<FLOAT>(uWidth), maxHeight + 2.0f, random.GetFloat() * static_cast<FLOAT>(uDepth));
+            ray.Direction = XMFLOAT3(random.GetFloat() * 2.0f - 1.0f, -0.05f - 0.45f * random.GetFloat(), random.GetFloat() * 2.0f - 1.0f);
+            ray.MaxDistance = 4.0f * static_cast<FLOAT>(uWidth + uDepth) + 4.0f * maxHeight;
+        }
+
+        XMFLOAT3 lightPosition = toWorld(1.5f * static_cast<FLOAT>(uWidth), 2.0f * maxHeight + 4.0f, 0.5f * static_cast<FLOAT>(uDepth));
+        std::vector<XMFLOAT3> aPoints(uNumQueries);
+        for (XMFLOAT3& point : aPoints)
+        {
+            UINT x, z;
+            FLOAT height = randomColumn(x, z);
+            point = toWorld(static_cast<FLOAT>(x) + 0.5f, height, static_cast<FLOAT>(z) + 0.5f);
+        }
+
+        std::vector<XMFLOAT3> aEyes(uNumQueries);
+        std::vector<XMFLOAT3> aBoxMins(uNumQueries);
+        std::vector<XMFLOAT3> aBoxMaxs(uNumQueries);
+        for (UINT i = 0u; i < uNumQueries; ++i)
+        {
+            UINT x, z;
+            FLOAT height = randomColumn(x, z);
+            aEyes[i] = toWorld(static_cast<FLOAT>(x) + 0.5f, height + 1.5f, static_cast<FLOAT>(z) + 0.5f);
+
+            height = randomColumn(x, z);
+            FLOAT size = static_cast<FLOAT>(1u + random.GetUint(4u));
+            FLOAT base = static_cast<FLOAT>(random.GetUint(static_cast<UINT>(height) + 3u));
+            aBoxMins[i] = toWorld(static_cast<FLOAT>(x), base, static_cast<FLOAT>(z));
+            aBoxMaxs[i] = toWorld(static_cast<FLOAT>(x) + size, base + size, static_cast<FLOAT>(z) + size);
+        }
+
+        BenchmarkTimer timer;
+
+        // Pyramid
+        std::vector<VoxelRayHit> aHits(uNumQueries);
+        UINT64 ullNumNodes = 0ull;
+        timer.Start();
+        for (UINT i = 0u; i < uNumQueries; ++i)
+        {
+            UINT uNumNodes = 0u;
+            m_stats.uNumRayHits += IntersectRay(aRays[i], aHits[i], &uNumNodes) ? 1u : 0u;
+            ullNumNodes += uNumNodes;
+        }
+        m_stats.MegaRaysPerSecond = timer.GetMegaPerSecond(uNumQueries);
+
+        std::vector<BOOL> abShadowed(uNumQueries);
+        timer.Start();
+        for (UINT i = 0u; i < uNumQueries; ++i)
+        {
+            abShadowed[i] = IsInShadow(aPoints[i], lightPosition);
+            m_stats.uNumShadowed += abShadowed[i] ? 1u : 0u;
+        }
+        m_stats.MegaShadowTestsPerSecond = timer.GetMegaPerSecond(uNumQueries);
+
+        std::vector<BOOL> abOccluded(uNumQueries);
+        UINT uNumOccluded = 0u;
+        timer.Start();
+        for (UINT i = 0u; i < uNumQueries; ++i)
+        {
+            abOccluded[i] = IsBoxOccluded(aEyes[i], aBoxMins[i], aBoxMaxs[i]);
+            uNumOccluded += abOccluded[i] ? 1u : 0u;
+        }
+        m_stats.MegaOcclusionTestsPerSecond = timer.GetMegaPerSecond(uNumQueries);
+
+        // Column by column
+        m_stats.bIdentical = TRUE;
+        UINT64 ullNumColumns = 0ull;
+        timer.Start();
+        for (UINT i = 0u; i < uNumBruteForceQueries; ++i)
+        {
+            GridRay gridRay;
+            ColumnHit columnHit;
+            VoxelRayHit hit = {};
+            UINT uNumColumns = 0u;
+            if (toGridRay(aRays[i].Origin, aRays[i].Direction, 0.0f, aRays[i].MaxDistance, gridRay) && marchColumns(gridRay, columnHit, &uNumColumns))
+            {
+                fillHit(gridRay, columnHit, hit);
+            }
+            ullNumColumns += uNumColumns;
+            if (hit.bHit != aHits[i].bHit ||
+                (hit.bHit && (hit.Cell.x != aHits[i].Cell.x || hit.Cell.y != aHits[i].Cell.y || hit.Cell.z != aHits[i].Cell.z || hit.Face != aHits[i].Face)))
+            {
+                m_stats.bIdentical = FALSE;
+            }
+        }
+        m_stats.BruteForceMegaRaysPerSecond = timer.GetMegaPerSecond(uNumBruteForceQueries);
+
+        timer.Start();
+        for (UINT i = 0u; i < uNumBruteForceQueries; ++i)
+        {
+            XMFLOAT3 direction(lightPosition.x - aPoints[i].x, lightPosition.y - aPoints[i].y, lightPosition.z - aPoints[i].z);
+            FLOAT length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+            GridRay gridRay;
+            ColumnHit columnHit;
+            BOOL bShadowed = toGridRay(aPoints[i], direction, SHADOW_BIAS, length, gridRay) && marchColumns(gridRay, columnHit, nullptr);
+            if (bShadowed != abShadowed[i])
+            {
+                m_stats.bIdentical = FALSE;
+            }
+        }
+        m_stats.BruteForceMegaShadowTestsPerSecond = timer.GetMegaPerSecond(uNumBruteForceQueries);
+
+        UINT uNumSampledOccluded = 0u;
+        UINT uNumConservativeOccluded = 0u;
+        timer.Start();
+        for (UINT i = 0u; i < uNumBruteForceQueries; ++i)
+        {
+            BOOL bOccluded = isBoxOccludedBruteForce(aEyes[i], aBoxMins[i], aBoxMaxs[i]);
+            uNumSampledOccluded += bOccluded ? 1u : 0u;
+            uNumConservativeOccluded += abOccluded[i] ? 1u : 0u;
+            if (abOccluded[i] && !bOccluded)
+            {
+                m_stats.bIdentical = FALSE;
+            }
+        }
+        m_stats.BruteForceMegaOcclusionTestsPerSecond = timer.GetMegaPerSecond(uNumBruteForceQueries);
+
+        m_stats.uNumQueries = uNumQueries;
+        m_stats.uNumBruteForceQueries = uNumBruteForceQueries;
+        m_stats.AverageNodesPerRay = static_cast<FLOAT>(static_cast<double>(ullNumNodes) / static_cast<double>(uNumQueries));
+        m_stats.AverageColumnsPerRay = uNumBruteForceQueries > 0u ? static_cast<FLOAT>(static_cast<double>(ullNumColumns) / static_cast<double>(uNumBruteForceQueries)) : 0.0f;
+        m_stats.OccludedFraction = uNumBruteForceQueries > 0u ? static_cast<FLOAT>(uNumConservativeOccluded) / static_cast<FLOAT>(uNumBruteForceQueries) : 0.0f;
+        m_stats.BruteForceOccludedFraction = uNumBruteForceQueries > 0u ? static_cast<FLOAT>(uNumSampledOccluded) / static_cast<FLOAT>(uNumBruteForceQueries) : 0.0f;
+
+        WCHAR szReport[512];
+        swprintf_s(
+            szReport,
+            L"HeightPyramid: %u levels in %.2f MB built in %.2f ms; rays %.2f M/s (%.1f nodes) against %.2f M/s (%.1f columns), "
+            L"shadows %.2f M/s against %.2f M/s, occlusion %.2f M/s against %.3f M/s culling %.1f%% of %.1f%%, %s\n",
+            m_stats.uNumLevels,
+            static_cast<double>(m_stats.ullMemoryBytes) / (1024.0 * 1024.0),
+            m_stats.BuildMilliseconds,
+            m_stats.MegaRaysPerSecond,
+            m_stats.AverageNodesPerRay,
+            m_stats.BruteForceMegaRaysPerSecond,
+            m_stats.AverageColumnsPerRay,
+            m_stats.MegaShadowTestsPerSecond,
+            m_stats.BruteForceMegaShadowTestsPerSecond,
+            m_stats.MegaOcclusionTestsPerSecond,
+            m_stats.BruteForceMegaOcclusionTestsPerSecond,
+            m_stats.OccludedFraction * 100.0f,
+            m_stats.BruteForceOccludedFraction * 100.0f,
+            m_stats.bIdentical ? L"identical" : L"MISMATCH"
+        );
+        OutputDebugString(szReport);
+
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::GetNumLevels
+
+      Summary:  Returns the number of levels, the columns being level 0
+
+      Returns:  UINT
+                  Number of levels
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT HeightPyramid::GetNumLevels() const
+    {
+        return static_cast<UINT>(m_aLevels.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::GetMinHeight
+
+      Summary:  Returns the height of the lowest column under a node
+
+      Args:     UINT uLevel
+                  Level of the node
+                UINT x
+                  Index of the node along the x-axis
+                UINT z
+                  Index of the node along the z-axis
+
+      Returns:  WORD
+                  Height of the lowest column, 0 outside the pyramid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    WORD HeightPyramid::GetMinHeight(_In_ UINT uLevel, _In_ UINT x, _In_ UINT z) const
+    {
+        if (uLevel >= m_aLevels.size() || x >= m_aLevels[uLevel].uWidth || z >= m_aLevels[uLevel].uDepth)
+        {
+            return 0u;
+        }
+
+        return m_aLevels[uLevel].aRanges[static_cast<size_t>(z) * m_aLevels[uLevel].uWidth + x].uMin;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::GetMaxHeight
+
+      Summary:  Returns the height of the highest column under a node
+
+      Args:     UINT uLevel
+                  Level of the node
+                UINT x
+                  Index of the node along the x-axis
+                UINT z
+                  Index of the node along the z-axis
+
+      Returns:  WORD
+                  Height of the highest column, 0 outside the pyramid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    WORD HeightPyramid::GetMaxHeight(_In_ UINT uLevel, _In_ UINT x, _In_ UINT z) const
+    {
+        if (uLevel >= m_aLevels.size() || x >= m_aLevels[uLevel].uWidth || z >= m_aLevels[uLevel].uDepth)
+        {
+            return 0u;
+        }
+
+        return m_aLevels[uLevel].aRanges[static_cast<size_t>(z) * m_aLevels[uLevel].uWidth + x].uMax;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::GetMemoryUsage
+
+      Summary:  Returns the size of the levels
+
+      Returns:  UINT64
+                  Size in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 HeightPyramid::GetMemoryUsage() const
+    {
+        UINT64 ullBytes = 0ull;
+        for (const Level& level : m_aLevels)
+        {
+            ullBytes += sizeof(Level) + level.aRanges.size() * sizeof(HeightRange);
+        }
+
+        return ullBytes;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::GetStats
+
+      Summary:  Returns the statistics of the build and the last
+                benchmark
+
+      Returns:  const HeightPyramidStats&
+                  Statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const HeightPyramidStats& HeightPyramid::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::build
+
+      Summary:  Fills level 0 with the heights of the columns, those
+                with an unknown block type counting as empty like in the
+                occupancy grid, then halves the levels until a single
+                node covers the map
+
+      Modifies: [m_aLevels, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightPyramid::build()
+    {
+        BenchmarkTimer timer;
+
+        m_aLevels.clear();
+        UINT uWidth = m_heightMap->GetWidth();
+        UINT uDepth = m_heightMap->GetDepth();
+        if (uWidth > 0u && uDepth > 0u)
+        {
+            Level columns = { .uWidth = uWidth, .uDepth = uDepth, .aRanges = std::vector<HeightRange>(static_cast<size_t>(uWidth) * uDepth) };
+            size_t uNumColors = m_heightMap->GetPalette().size();
+            for (size_t i = 0u; i < columns.aRanges.size(); ++i)
+            {
+                const HeightMapColumn& column = m_heightMap->GetColumns()[i];
+                size_t uColorIdx = static_cast<size_t>(column.BlockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+                WORD uHeight = column.BlockType >= static_cast<CHAR>(eBlockType::GRASSLAND) && uColorIdx < uNumColors ? column.uHeight : 0u;
+                columns.aRanges[i] = { .uMin = uHeight, .uMax = uHeight };
+            }
+            m_aLevels.push_back(std::move(columns));
+
+            while ((m_aLevels.back().uWidth > 1u || m_aLevels.back().uDepth > 1u) && m_aLevels.size() < MAX_LEVELS)
+            {
+                const Level& fine = m_aLevels.back();
+                Level coarse = { .uWidth = (fine.uWidth + 1u) / 2u, .uDepth = (fine.uDepth + 1u) / 2u, .aRanges = {} };
+                coarse.aRanges.resize(static_cast<size_t>(coarse.uWidth) * coarse.uDepth);
+                for (UINT z = 0u; z < coarse.uDepth; ++z)
+                {
+                    for (UINT x = 0u; x < coarse.uWidth; ++x)
+                    {
+                        coarse.aRanges[static_cast<size_t>(z) * coarse.uWidth + x] = mergeChildren(fine, x, z);
+                    }
+                }
+                m_aLevels.push_back(std::move(coarse));
+            }
+        }
+
+        FLOAT buildMilliseconds = timer.GetMilliseconds();
+
+        m_stats = {};
+        m_stats.uNumLevels = static_cast<UINT>(m_aLevels.size());
+        m_stats.ullMemoryBytes = GetMemoryUsage();
+        m_stats.BuildMilliseconds = buildMilliseconds;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::toGridRay
+
+      Summary:  Converts a world ray into the grid space of the columns,
+                where a column spans one unit
+
+      Args:     const XMFLOAT3& origin
+                  Origin in world space
+                const XMFLOAT3& direction
+                  Direction, not necessarily normalized
+                FLOAT minDistance
+                  Distance along the ray the query starts at
+                FLOAT maxDistance
+                  Distance along the ray the query ends at
+                GridRay& gridRay
+                  Receives the ray in grid space
+
+      Returns:  BOOL
+                  FALSE if the direction is null or the range is empty
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::toGridRay(_In_ const XMFLOAT3& origin, _In_ const XMFLOAT3& direction, _In_ FLOAT minDistance, _In_ FLOAT maxDistance, _Out_ GridRay& gridRay) const
+    {
+        gridRay = {};
+
+        FLOAT length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        if (length <= 0.0f || maxDistance <= minDistance)
+        {
+            return FALSE;
+        }
+
+        const FLOAT aOrigin[3] = { origin.x - m_gridOrigin.x, origin.y - m_gridOrigin.y, origin.z - m_gridOrigin.z };
+        const FLOAT aDirection[3] = { direction.x, direction.y, direction.z };
+        for (INT a = 0; a < 3; ++a)
+        {
+            gridRay.aOrigin[a] = aOrigin[a] * 0.5f;
+            gridRay.aDirection[a] = aDirection[a] / length;
+            gridRay.aInverse[a] = gridRay.aDirection[a] != 0.0f ? 1.0f / gridRay.aDirection[a] : FLT_MAX;
+        }
+        gridRay.MinT = minDistance * 0.5f;
+        gridRay.MaxT = maxDistance * 0.5f;
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::clipGrid
+
+      Summary:  Clips a ray to the box from the ground to the highest
+                column over the whole map
+
+      Args:     const GridRay& ray
+                  Ray in grid space
+                FLOAT& tEnter
+                  Start of the range, moved forward
+                FLOAT& tExit
+                  End of the range, moved back
+                INT& iAxis
+                  Axis the range starts on, -1 for none
+
+      Returns:  BOOL
+                  FALSE if the range is empty
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::clipGrid(_In_ const GridRay& ray, _Inout_ FLOAT& tEnter, _Inout_ FLOAT& tExit, _Inout_ INT& iAxis) const
+    {
+        if (m_aLevels.empty() || !clipFootprint(ray, 0.0f, static_cast<FLOAT>(m_aLevels[0].uWidth), 0.0f, static_cast<FLOAT>(m_aLevels[0].uDepth), tEnter, tExit, iAxis))
+        {
+            return FALSE;
+        }
+
+        FLOAT top = static_cast<FLOAT>(m_aLevels.back().aRanges[0].uMax);
+        if (ray.aDirection[1] == 0.0f)
+        {
+            return ray.aOrigin[1] >= 0.0f && ray.aOrigin[1] < top;
+        }
+
+        FLOAT t0 = -ray.aOrigin[1] * ray.aInverse[1];
+        FLOAT t1 = (top - ray.aOrigin[1]) * ray.aInverse[1];
+        if (t0 > t1)
+        {
+            std::swap(t0, t1);
+        }
+        if (t0 > tEnter)
+        {
+            tEnter = t0;
+            iAxis = 1;
+        }
+        tExit = std::min<FLOAT>(tExit, t1);
+
+        return tEnter <= tExit;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::clipFootprint
+
+      Summary:  Clips a ray to the columns of a rectangle of the map
+
+      Args:     const GridRay& ray
+                  Ray in grid space
+                FLOAT x0
+                  Lower bound along the x-axis
+                FLOAT x1
+                  Upper bound along the x-axis
+                FLOAT z0
+                  Lower bound along the z-axis
+                FLOAT z1
+                  Upper bound along the z-axis
+                FLOAT& tEnter
+                  Start of the range, moved forward
+                FLOAT& tExit
+                  End of the range, moved back
+                INT& iAxis
+                  Axis the range starts on, -1 for none
+
+      Returns:  BOOL
+                  FALSE if the range is empty
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::clipFootprint(_In_ const GridRay& ray, _In_ FLOAT x0, _In_ FLOAT x1, _In_ FLOAT z0, _In_ FLOAT z1, _Inout_ FLOAT& tEnter, _Inout_ FLOAT& tExit, _Inout_ INT& iAxis) const
+    {
+        const INT aAxes[2] = { 0, 2 };
+        const FLOAT aLower[2] = { x0, z0 };
+        const FLOAT aUpper[2] = { x1, z1 };
+        for (UINT i = 0u; i < 2u; ++i)
+        {
+            INT a = aAxes[i];
+            if (ray.aDirection[a] == 0.0f)
+            {
+                if (ray.aOrigin[a] < aLower[i] || ray.aOrigin[a] >= aUpper[i])
+                {
+                    return FALSE;
+                }
+                continue;
+            }
+
+            FLOAT t0 = (aLower[i] - ray.aOrigin[a]) * ray.aInverse[a];
+            FLOAT t1 = (aUpper[i] - ray.aOrigin[a]) * ray.aInverse[a];
+            if (t0 > t1)
+            {
+                std::swap(t0, t1);
+            }
+            if (t0 > tEnter)
+            {
+                tEnter = t0;
+                iAxis = a;
+            }
+            tExit = std::min<FLOAT>(tExit, t1);
+        }
+
+        return tEnter <= tExit;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::intersectColumn
+
+      Summary:  Intersects a ray, already clipped to the footprint of a
+                column, with the solid part of the column. A ray that
+                only grazes the column does not hit it. An edited column
+                with open cells below its top is left to intersectCells
+
+      Args:     const GridRay& ray
+                  Ray in grid space
+                UINT x
+                  Index of the column along the x-axis
+                UINT z
+                  Index of the column along the z-axis
+                FLOAT tEnter
+                  Start of the range over the column
+                FLOAT tExit
+                  End of the range over the column
+                INT iAxis
+                  Axis the range starts on, -1 for none
+                ColumnHit& hit
+                  Receives the hit
+
+      Returns:  BOOL
+                  TRUE if the ray enters the column
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::intersectColumn(_In_ const GridRay& ray, _In_ UINT x, _In_ UINT z, _In_ FLOAT tEnter, _In_ FLOAT tExit, _In_ INT iAxis, _Out_ ColumnHit& hit) const
+    {
+        hit = {};
+
+        const HeightRange& range = m_aLevels[0].aRanges[static_cast<size_t>(z) * m_aLevels[0].uWidth + x];
+        FLOAT height = static_cast<FLOAT>(range.uMax);
+        if (ray.aDirection[1] == 0.0f)
+        {
+            if (ray.aOrigin[1] < 0.0f || ray.aOrigin[1] >= height)
+            {
+                return FALSE;
+            }
+        }
+        else
+        {
+            FLOAT t0 = -ray.aOrigin[1] * ray.aInverse[1];
+            FLOAT t1 = (height - ray.aOrigin[1]) * ray.aInverse[1];
+            if (t0 > t1)
+            {
+                std::swap(t0, t1);
+            }
+            if (t0 > tEnter)
+            {
+                tEnter = t0;
+                iAxis = 1;
+            }
+            tExit = std::min<FLOAT>(tExit, t1);
+        }
+        if (tEnter >= tExit)
+        {
+            return FALSE;
+        }
+        if (range.uMin < range.uMax)
+        {
+            return intersectCells(ray, x, z, tEnter, tExit, iAxis, hit);
+        }
+
+        INT y = std::clamp<INT>(static_cast<INT>(floorf(ray.aOrigin[1] + ray.aDirection[1] * tEnter)), 0, static_cast<INT>(range.uMax) - 1);
+        hit = { .x = x, .y = y, .z = z, .t = tEnter, .iAxis = iAxis };
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::intersectCells
+
+      Summary:  Walks a ray, already clipped to an edited column below
+                its top, through the cells of the column until it enters
+                a solid one. The cells under the lowest height of the
+                column are solid, those above are read from the
+                occupancy grid
+
+      Args:     const GridRay& ray
+                  Ray in grid space
+                UINT x
+                  Index of the column along the x-axis
+                UINT z
+                  Index of the column along the z-axis
+                FLOAT tEnter
+                  Start of the range within the column
+                FLOAT tExit
+                  End of the range within the column
+                INT iAxis
+                  Axis the range starts on, -1 for none
+                ColumnHit& hit
+                  Receives the hit
+
+      Returns:  BOOL
+                  TRUE if the ray enters a solid cell
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::intersectCells(_In_ const GridRay& ray, _In_ UINT x, _In_ UINT z, _In_ FLOAT tEnter, _In_ FLOAT tExit, _In_ INT iAxis, _Out_ ColumnHit& hit) const
+    {
+        hit = {};
+
+        const HeightRange& range = m_aLevels[0].aRanges[static_cast<size_t>(z) * m_aLevels[0].uWidth + x];
+        INT iStepY = ray.aDirection[1] > 0.0f ? 1 : (ray.aDirection[1] < 0.0f ? -1 : 0);
+
+        // A ray going down that starts on the bound between two cells is
+        // in the lower one
+        FLOAT entryY = ray.aOrigin[1] + ray.aDirection[1] * tEnter;
+        INT y = std::clamp<INT>(iStepY < 0 ? static_cast<INT>(ceilf(entryY)) - 1 : static_cast<INT>(floorf(entryY)), 0, static_cast<INT>(range.uMax) - 1);
+        FLOAT t = tEnter;
+        for (;;)
+        {
+            if (y < static_cast<INT>(range.uMin) || m_occupancyGrid->IsOccupied(static_cast<INT>(x), y, static_cast<INT>(z)))
+            {
+                hit = { .x = x, .y = y, .z = z, .t = t, .iAxis = iAxis };
+                return TRUE;
+            }
+            if (iStepY == 0)
+            {
+                return FALSE;
+            }
+
+            FLOAT tNextY = (static_cast<FLOAT>(y + (iStepY > 0 ? 1 : 0)) - ray.aOrigin[1]) * ray.aInverse[1];
+            if (tNextY >= tExit)
+            {
+                return FALSE;
+            }
+            t = tNextY;
+            y += iStepY;
+            iAxis = 1;
+            if (y < 0 || y >= static_cast<INT>(range.uMax))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::mergeChildren
+
+      Summary:  Returns the lowest and highest column of the children of
+                a node
+
+      Args:     const Level& fine
+                  Level of the children
+                UINT x
+                  Index of the node along the x-axis
+                UINT z
+                  Index of the node along the z-axis
+
+      Returns:  HeightRange
+                  Range of heights under the node
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HeightPyramid::HeightRange HeightPyramid::mergeChildren(_In_ const Level& fine, _In_ UINT x, _In_ UINT z)
+    {
+        HeightRange range = { .uMin = 0xFFFFu, .uMax = 0u };
+        for (UINT uChild = 0u; uChild < 4u; ++uChild)
+        {
+            UINT uChildX = 2u * x + (uChild & 1u);
+            UINT uChildZ = 2u * z + (uChild >> 1u);
+            if (uChildX < fine.uWidth && uChildZ < fine.uDepth)
+            {
+                const HeightRange& child = fine.aRanges[static_cast<size_t>(uChildZ) * fine.uWidth + uChildX];
+                range.uMin = std::min<WORD>(range.uMin, child.uMin);
+                range.uMax = std::max<WORD>(range.uMax, child.uMax);
+            }
+        }
+
+        return range;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::intersect
+
+      Summary:  Walks the ray through the pyramid from the column it
+                enters. A node the ray stays above the highest column of
+                is stepped over whole and the walk climbs one level,
+                otherwise it descends into the child the ray is in.
+                Nodes are tracked by index rather than recomputed from
+                the position, so a ray on a bound never steps back
+
+      Args:     const GridRay& ray
+                  Ray in grid space
+                ColumnHit& hit
+                  Receives the hit
+                UINT* puNumNodes
+                  Receives the number of nodes visited
+
+      Returns:  BOOL
+                  TRUE if the ray hits a column
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::intersect(_In_ const GridRay& ray, _Out_ ColumnHit& hit, _Out_opt_ UINT* puNumNodes) const
+    {
+        hit = {};
+
+        FLOAT t = ray.MinT;
+        FLOAT tExit = ray.MaxT;
+        INT iAxis = -1;
+        if (!clipGrid(ray, t, tExit, iAxis))
+        {
+            return FALSE;
+        }
+
+        UINT uWidth = m_aLevels[0].uWidth;
+        UINT uDepth = m_aLevels[0].uDepth;
+        UINT uTopLevel = static_cast<UINT>(m_aLevels.size()) - 1u;
+        INT iStepX = ray.aDirection[0] > 0.0f ? 1 : (ray.aDirection[0] < 0.0f ? -1 : 0);
+        INT iStepZ = ray.aDirection[2] > 0.0f ? 1 : (ray.aDirection[2] < 0.0f ? -1 : 0);
+
+        // Short rays such as shadow rays end within a few columns, so
+        // the walk starts from the column the ray enters and climbs
+        UINT uLevel = 0u;
+        INT x = std::clamp<INT>(static_cast<INT>(floorf(ray.aOrigin[0] + ray.aDirection[0] * t)), 0, static_cast<INT>(uWidth) - 1);
+        INT z = std::clamp<INT>(static_cast<INT>(floorf(ray.aOrigin[2] + ray.aDirection[2] * t)), 0, static_cast<INT>(uDepth) - 1);
+        UINT uNumNodes = 0u;
+        BOOL bHit = FALSE;
+        for (;;)
+        {
+            ++uNumNodes;
+
+            const Level& level = m_aLevels[uLevel];
+            UINT uX0 = static_cast<UINT>(x) << uLevel;
+            UINT uX1 = std::min<UINT>((static_cast<UINT>(x) + 1u) << uLevel, uWidth);
+            UINT uZ0 = static_cast<UINT>(z) << uLevel;
+            UINT uZ1 = std::min<UINT>((static_cast<UINT>(z) + 1u) << uLevel, uDepth);
+            FLOAT tNextX = iStepX != 0 ? (static_cast<FLOAT>(iStepX > 0 ? uX1 : uX0) - ray.aOrigin[0]) * ray.aInverse[0] : FLT_MAX;
+            FLOAT tNextZ = iStepZ != 0 ? (static_cast<FLOAT>(iStepZ > 0 ? uZ1 : uZ0) - ray.aOrigin[2]) * ray.aInverse[2] : FLT_MAX;
+            FLOAT tNodeExit = std::min<FLOAT>(std::min<FLOAT>(tNextX, tNextZ), tExit);
+
+            // Compared in t like the column test, so that a ray grazing
+            // the top of a column gets the same answer at every level
+            FLOAT top = static_cast<FLOAT>(level.aRanges[static_cast<size_t>(z) * level.uWidth + static_cast<size_t>(x)].uMax);
+            BOOL bAbove = ray.aDirection[1] < 0.0f
+                ? tNodeExit <= (top - ray.aOrigin[1]) * ray.aInverse[1]
+                : (ray.aDirection[1] > 0.0f ? t >= (top - ray.aOrigin[1]) * ray.aInverse[1] : ray.aOrigin[1] >= top);
+            if (!bAbove && uLevel > 0u)
+            {
+                // Child holding the ray at t, found by comparing t with
+                // the crossing of the middle computed as the steps do, so
+                // a ray on the middle goes into the child it moves into
+                --uLevel;
+                FLOAT middleX = static_cast<FLOAT>((2u * static_cast<UINT>(x) + 1u) << uLevel);
+                FLOAT middleZ = static_cast<FLOAT>((2u * static_cast<UINT>(z) + 1u) << uLevel);
+                BOOL bUpperX = iStepX != 0
+                    ? ((t >= (middleX - ray.aOrigin[0]) * ray.aInverse[0]) == (iStepX > 0))
+                    : ray.aOrigin[0] >= middleX;
+                BOOL bUpperZ = iStepZ != 0
+                    ? ((t >= (middleZ - ray.aOrigin[2]) * ray.aInverse[2]) == (iStepZ > 0))
+                    : ray.aOrigin[2] >= middleZ;
+                x = 2 * x + (bUpperX ? 1 : 0);
+                z = 2 * z + (bUpperZ ? 1 : 0);
+                x = std::min<INT>(x, static_cast<INT>(m_aLevels[uLevel].uWidth) - 1);
+                z = std::min<INT>(z, static_cast<INT>(m_aLevels[uLevel].uDepth) - 1);
+                continue;
+            }
+            if (!bAbove)
+            {
+                FLOAT tColumnEnter = t;
+                FLOAT tColumnExit = tNodeExit;
+                INT iColumnAxis = iAxis;
+                if (clipFootprint(ray, static_cast<FLOAT>(uX0), static_cast<FLOAT>(uX1), static_cast<FLOAT>(uZ0), static_cast<FLOAT>(uZ1), tColumnEnter, tColumnExit, iColumnAxis) &&
+                    intersectColumn(ray, static_cast<UINT>(x), static_cast<UINT>(z), tColumnEnter, tColumnExit, iColumnAxis, hit))
+                {
+                    bHit = TRUE;
+                    break;
+                }
+            }
+
+            // Step over the node and climb back up a level
+            if (std::min<FLOAT>(tNextX, tNextZ) > tExit)
+            {
+                break;
+            }
+            t = std::max<FLOAT>(t, std::min<FLOAT>(tNextX, tNextZ));
+            if (tNextX < tNextZ)
+            {
+                x += iStepX;
+                iAxis = 0;
+            }
+            else
+            {
+                z += iStepZ;
+                iAxis = 2;
+            }
+            if (x < 0 || x >= static_cast<INT>(level.uWidth) || z < 0 || z >= static_cast<INT>(level.uDepth))
+            {
+                break;
+            }
+            if (uLevel < uTopLevel)
+            {
+                ++uLevel;
+                x >>= 1;
+                z >>= 1;
+            }
+        }
+
+        if (puNumNodes)
+        {
+            *puNumNodes = uNumNodes;
+        }
+
+        return bHit;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::marchColumns
+
+      Summary:  Visits every column the ray passes over, nearest first,
+                the reference the pyramid is measured against
+
+      Args:     const GridRay& ray
+                  Ray in grid space
+                ColumnHit& hit
+                  Receives the hit
+                UINT* puNumColumns
+                  Receives the number of columns visited
+
+      Returns:  BOOL
+                  TRUE if the ray hits a column
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::marchColumns(_In_ const GridRay& ray, _Out_ ColumnHit& hit, _Out_opt_ UINT* puNumColumns) const
+    {
+        hit = {};
+
+        FLOAT tEnter = ray.MinT;
+        FLOAT tExit = ray.MaxT;
+        INT iAxis = -1;
+        if (!clipGrid(ray, tEnter, tExit, iAxis))
+        {
+            return FALSE;
+        }
+
+        INT iWidth = static_cast<INT>(m_aLevels[0].uWidth);
+        INT iDepth = static_cast<INT>(m_aLevels[0].uDepth);
+        INT x = std::clamp<INT>(static_cast<INT>(floorf(ray.aOrigin[0] + ray.aDirection[0] * tEnter)), 0, iWidth - 1);
+        INT z = std::clamp<INT>(static_cast<INT>(floorf(ray.aOrigin[2] + ray.aDirection[2] * tEnter)), 0, iDepth - 1);
+        INT iStepX = ray.aDirection[0] > 0.0f ? 1 : (ray.aDirection[0] < 0.0f ? -1 : 0);
+        INT iStepZ = ray.aDirection[2] > 0.0f ? 1 : (ray.aDirection[2] < 0.0f ? -1 : 0);
+
+        UINT uNumColumns = 0u;
+        BOOL bHit = FALSE;
+        for (;;)
+        {
+            ++uNumColumns;
+
+            FLOAT tColumnEnter = tEnter;
+            FLOAT tColumnExit = tExit;
+            INT iColumnAxis = iAxis;
+            if (clipFootprint(ray, static_cast<FLOAT>(x), static_cast<FLOAT>(x + 1), static_cast<FLOAT>(z), static_cast<FLOAT>(z + 1), tColumnEnter, tColumnExit, iColumnAxis) &&
+                intersectColumn(ray, static_cast<UINT>(x), static_cast<UINT>(z), tColumnEnter, tColumnExit, iColumnAxis, hit))
+            {
+                bHit = TRUE;
+                break;
+            }
+
+            FLOAT tNextX = iStepX != 0 ? (static_cast<FLOAT>(x + (iStepX > 0 ? 1 : 0)) - ray.aOrigin[0]) * ray.aInverse[0] : FLT_MAX;
+            FLOAT tNextZ = iStepZ != 0 ? (static_cast<FLOAT>(z + (iStepZ > 0 ? 1 : 0)) - ray.aOrigin[2]) * ray.aInverse[2] : FLT_MAX;
+            if (std::min<FLOAT>(tNextX, tNextZ) > tExit)
+            {
+                break;
+            }
+            if (tNextX < tNextZ)
+            {
+                x += iStepX;
+            }
+            else
+            {
+                z += iStepZ;
+            }
+            if (x < 0 || x >= iWidth || z < 0 || z >= iDepth)
+            {
+                break;
+            }
+        }
+
+        if (puNumColumns)
+        {
+            *puNumColumns = uNumColumns;
+        }
+
+        return bHit;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::fillHit
+
+      Summary:  Fills a voxel hit from the column a ray enters. The cell
+                is the one of the column at the entry point, and the
+                face is that of the bound the range started on
+
+      Args:     const GridRay& ray
+                  Ray in grid space
+                const ColumnHit& columnHit
+                  Column hit
+                VoxelRayHit& hit
+                  Receives the voxel hit
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightPyramid::fillHit(_In_ const GridRay& ray, _In_ const ColumnHit& columnHit, _Out_ VoxelRayHit& hit) const
+    {
+        static constexpr const eVoxelFace NEGATIVE_FACES[3] = { eVoxelFace::NEGATIVE_X, eVoxelFace::NEGATIVE_Y, eVoxelFace::NEGATIVE_Z };
+        static constexpr const eVoxelFace POSITIVE_FACES[3] = { eVoxelFace::POSITIVE_X, eVoxelFace::POSITIVE_Y, eVoxelFace::POSITIVE_Z };
+
+        FLOAT distance = columnHit.t * 2.0f;
+        hit =
+        {
+            .Cell = XMINT3(static_cast<INT>(columnHit.x), columnHit.y, static_cast<INT>(columnHit.z)),
+            .Face = columnHit.iAxis < 0
+                ? eVoxelFace::NONE
+                : (ray.aDirection[columnHit.iAxis] > 0.0f ? NEGATIVE_FACES[columnHit.iAxis] : POSITIVE_FACES[columnHit.iAxis]),
+            .BlockType = m_heightMap->GetColumn(columnHit.x, columnHit.z).BlockType,
+            .Distance = distance,
+            .Position = XMFLOAT3(
+                m_gridOrigin.x + 2.0f * ray.aOrigin[0] + ray.aDirection[0] * distance,
+                m_gridOrigin.y + 2.0f * ray.aOrigin[1] + ray.aDirection[1] * distance,
+                m_gridOrigin.z + 2.0f * ray.aOrigin[2] + ray.aDirection[2] * distance
+            ),
+            .bHit = TRUE
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::isBoxOccludedBruteForce
+
+      Summary:  Marches the segments from an eye to a lattice of
+                OCCLUSION_SAMPLES_PER_AXIS points per axis of a box. The
+                box counts as hidden when every segment hits the terrain
+                before its point
+
+      Args:     const XMFLOAT3& eye
+                  Position of the eye in world space
+                const XMFLOAT3& boxMin
+                  Lower corner of the box in world space
+                const XMFLOAT3& boxMax
+                  Upper corner of the box in world space
+
+      Returns:  BOOL
+                  TRUE if no sample of the box is visible
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::isBoxOccludedBruteForce(_In_ const XMFLOAT3& eye, _In_ const XMFLOAT3& boxMin, _In_ const XMFLOAT3& boxMax) const
+    {
+        constexpr const FLOAT STEP = 1.0f / static_cast<FLOAT>(OCCLUSION_SAMPLES_PER_AXIS - 1u);
+        for (UINT k = 0u; k < OCCLUSION_SAMPLES_PER_AXIS; ++k)
+        {
+            for (UINT j = 0u; j < OCCLUSION_SAMPLES_PER_AXIS; ++j)
+            {
+                for (UINT i = 0u; i < OCCLUSION_SAMPLES_PER_AXIS; ++i)
+                {
+                    XMFLOAT3 sample(
+                        boxMin.x + (boxMax.x - boxMin.x) * static_cast<FLOAT>(i) * STEP,
+                        boxMin.y + (boxMax.y - boxMin.y) * static_cast<FLOAT>(j) * STEP,
+                        boxMin.z + (boxMax.z - boxMin.z) * static_cast<FLOAT>(k) * STEP
+                    );
+                    XMFLOAT3 direction(sample.x - eye.x, sample.y - eye.y, sample.z - eye.z);
+                    FLOAT length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+
+                    GridRay gridRay;
+                    ColumnHit columnHit;
+                    if (!toGridRay(eye, direction, 0.0f, length - SHADOW_BIAS, gridRay) || !marchColumns(gridRay, columnHit, nullptr))
+                    {
+                        return FALSE;
+                    }
+                }
+            }
+        }
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightPyramid::occludes
+
+      Summary:  Returns whether a solid box hides another box from an
+                eye, in grid space. For a face of the occluder turned
+                towards the eye with the box strictly behind its plane,
+                so that a box lying on the face stays visible, the eight
+                corners of the box are projected from the eye onto the
+                plane. Their convex hull holds the projection of the
+                whole box, so when they all fall inside the face every
+                sight line to the box goes through the occluder rather
+                than grazing it
+
+      Args:     const FLOAT* pEye
+                  Position of the eye
+                const FLOAT* pBoxMin
+                  Lower corner of the box
+                const FLOAT* pBoxMax
+                  Upper corner of the box
+                const FLOAT* pOccluderMin
+                  Lower corner of the occluder
+                const FLOAT* pOccluderMax
+                  Upper corner of the occluder
+
+      Returns:  BOOL
+                  TRUE if the box is hidden
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightPyramid::occludes(_In_reads_(3) const FLOAT* pEye, _In_reads_(3) const FLOAT* pBoxMin, _In_reads_(3) const FLOAT* pBoxMax, _In_reads_(3) const FLOAT* pOccluderMin, _In_reads_(3) const FLOAT* pOccluderMax)
+    {
+        for (INT a = 0; a < 3; ++a)
+        {
+            FLOAT plane;
+            if (pEye[a] < pOccluderMin[a] && pBoxMin[a] > pOccluderMin[a])
+            {
+                plane = pOccluderMin[a];
+            }
+            else if (pEye[a] > pOccluderMax[a] && pBoxMax[a] < pOccluderMax[a])
+            {
+                plane = pOccluderMax[a];
+            }
+            else
+            {
+                continue;
+            }
+
+            INT b = (a + 1) % 3;
+            INT c = (a + 2) % 3;
+            BOOL bInside = TRUE;
+            for (UINT uCorner = 0u; uCorner < 8u && bInside; ++uCorner)
+            {
+                const FLOAT aCorner[3] =
+                {
+                    (uCorner & 1u) ? pBoxMax[0] : pBoxMin[0],
+                    (uCorner & 2u) ? pBoxMax[1] : pBoxMin[1],
+                    (uCorner & 4u) ? pBoxMax[2] : pBoxMin[2]
+                };
+                FLOAT s = (plane - pEye[a]) / (aCorner[a] - pEye[a]);
+                FLOAT projectedB = pEye[b] + s * (aCorner[b] - pEye[b]);
+                FLOAT projectedC = pEye[c] + s * (aCorner[c] - pEye[c]);
+                bInside = projectedB > pOccluderMin[b] && projectedB < pOccluderMax[b] && projectedC > pOccluderMin[c] && projectedC < pOccluderMax[c];
+            }
+            if (bInside)
+            {
+                return TRUE;
+            }
+        }
+
+        return FALSE;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+/*+===================================================================
+  File:      HEIGHTPYRAMID.H
+
+  Summary:   HeightPyramid header file contains declarations of
+             HeightPyramid class that answers ray, shadow and occlusion
+             queries over the height map through a min/max pyramid.
+
+  Classes: HeightPyramid
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <cfloat>
+
+#include "Game/Benchmark.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/VoxelRayCaster.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   HeightPyramidStats
+
+        Summary:  Size and build time of the pyramid, and the throughput
+                  of its ray, shadow and occlusion queries against a
+                  column-by-column march, in millions of queries per
+                  second. The fractions of boxes found occluded by the
+                  conservative test and by sampling segments tell how
+                  much the test gives up, and bIdentical holds when the
+                  rays and shadows match and no box reported occluded
+                  has a visible sample
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct HeightPyramidStats
+    {
+        UINT uNumLevels;
+        UINT64 ullMemoryBytes;
+        FLOAT BuildMilliseconds;
+        UINT uNumQueries;
+        UINT uNumBruteForceQueries;
+        UINT uNumRayHits;
+        UINT uNumShadowed;
+        FLOAT AverageNodesPerRay;
+        FLOAT AverageColumnsPerRay;
+        FLOAT MegaRaysPerSecond;
+        FLOAT BruteForceMegaRaysPerSecond;
+        FLOAT MegaShadowTestsPerSecond;
+        FLOAT BruteForceMegaShadowTestsPerSecond;
+        FLOAT MegaOcclusionTestsPerSecond;
+        FLOAT BruteForceMegaOcclusionTestsPerSecond;
+        FLOAT OccludedFraction;
+        FLOAT BruteForceOccludedFraction;
+        BOOL bIdentical;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    HeightPyramid
+
+      Summary:  Pyramid of the lowest and highest column of every square
+                of 2^k by 2^k columns of the height map, down to a
+                single node over the whole map. A ray descends only into
+                the nodes it passes below the top of, nearest first, so
+                open sky and valleys are skipped in a few steps. Below
+                the lowest column of a node the terrain is solid, which
+                gives the boxes the occlusion test hides things behind.
+                An edited column keeps the solid run from the ground as
+                its lowest height and its highest solid cell as its top,
+                and rays walk its cells in between through the occupancy
+                grid
+
+      Methods:  IntersectRay
+                  Returns the first column a ray hits
+                IsInShadow
+                  Returns whether the terrain hides a light from a
+                  point
+                IsBoxOccluded
+                  Returns whether the terrain surely hides a box from
+                  an eye
+                UpdateColumn
+                  Refreshes a column and its nodes after an edit
+                Benchmark
+                  Measures the queries against a column-by-column march
+                GetNumLevels
+                  Returns the number of levels
+                GetMinHeight
+                  Returns the lowest column under a node
+                GetMaxHeight
+                  Returns the highest column under a node
+                GetMemoryUsage
+                  Returns the size of the pyramid in bytes
+                GetStats
+                  Returns the statistics of the build and the last
+                  benchmark
+                build
+                  Fills the levels from the height map
+                toGridRay
+                  Converts a world ray into grid space
+                clipGrid
+                  Clips a ray to the bounds of the terrain
+                clipFootprint
+                  Clips a ray to the columns of a rectangle
+                intersectColumn
+                  Intersects a ray with one column
+                intersectCells
+                  Intersects a ray with the cells of an edited column
+                intersect
+                  Descends the pyramid along a ray
+                marchColumns
+                  Visits every column along a ray
+                fillHit
+                  Fills a voxel hit from a column hit
+                isBoxOccludedBruteForce
+                  Tests segments to points of a box
+                mergeChildren
+                  Returns the range of heights under a node
+                occludes
+                  Returns whether a solid box hides another box
+                HeightPyramid
+                  Constructor.
+                ~HeightPyramid
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class HeightPyramid
+    {
+    public:
+        static constexpr const UINT MAX_LEVELS = 32u;
+        static constexpr const FLOAT SHADOW_BIAS = 1.0e-3f;
+        static constexpr const UINT OCCLUSION_SAMPLES_PER_AXIS = 3u;
+        static constexpr const UINT BENCHMARK_BRUTE_FORCE_QUERIES = 1u << 12u;
+
+        HeightPyramid(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid);
+        HeightPyramid(const HeightPyramid& other) = delete;
+        HeightPyramid(HeightPyramid&& other) = delete;
+        HeightPyramid& operator=(const HeightPyramid& other) = delete;
+        HeightPyramid& operator=(HeightPyramid&& other) = delete;
+        ~HeightPyramid() = default;
+
+        BOOL IntersectRay(_In_ const VoxelRay& ray, _Out_ VoxelRayHit& hit, _Out_opt_ UINT* puNumNodes = nullptr) const;
+        BOOL IsInShadow(_In_ const XMFLOAT3& point, _In_ const XMFLOAT3& lightPosition) const;
+        BOOL IsBoxOccluded(_In_ const XMFLOAT3& eye, _In_ const XMFLOAT3& boxMin, _In_ const XMFLOAT3& boxMax) const;
+        void UpdateColumn(_In_ UINT x, _In_ UINT z);
+        const HeightPyramidStats& Benchmark(_In_ UINT uNumQueries, _In_ UINT uNumBruteForceQueries);
+
+        UINT GetNumLevels() const;
+        WORD GetMinHeight(_In_ UINT uLevel, _In_ UINT x, _In_ UINT z) const;
+        WORD GetMaxHeight(_In_ UINT uLevel, _In_ UINT x, _In_ UINT z) const;
+        UINT64 GetMemoryUsage() const;
+        const HeightPyramidStats& GetStats() const;
+
+    private:
+        struct HeightRange
+        {
+            WORD uMin;
+            WORD uMax;
+        };
+
+        struct Level
+        {
+            UINT uWidth;
+            UINT uDepth;
+            std::vector<HeightRange> aRanges;
+        };
+
+        struct GridRay
+        {
+            FLOAT aOrigin[3];
+            FLOAT aDirection[3];
+            FLOAT aInverse[3];
+            FLOAT MinT;
+            FLOAT MaxT;
+        };
+
+        struct ColumnHit
+        {
+            UINT x;
+            INT y;
+            UINT z;
+            FLOAT t;
+            INT iAxis;
+        };
+
+        void build();
+        BOOL toGridRay(_In_ const XMFLOAT3& origin, _In_ const XMFLOAT3& direction, _In_ FLOAT minDistance, _In_ FLOAT maxDistance, _Out_ GridRay& gridRay) const;
+        BOOL clipGrid(_In_ const GridRay& ray, _Inout_ FLOAT& tEnter, _Inout_ FLOAT& tExit, _Inout_ INT& iAxis) const;
+        BOOL clipFootprint(_In_ const GridRay& ray, _In_ FLOAT x0, _In_ FLOAT x1, _In_ FLOAT z0, _In_ FLOAT z1, _Inout_ FLOAT& tEnter, _Inout_ FLOAT& tExit, _Inout_ INT& iAxis) const;
+        BOOL intersectColumn(_In_ const GridRay& ray, _In_ UINT x, _In_ UINT z, _In_ FLOAT tEnter, _In_ FLOAT tExit, _In_ INT iAxis, _Out_ ColumnHit& hit) const;
+        BOOL intersectCells(_In_ const GridRay& ray, _In_ UINT x, _In_ UINT z, _In_ FLOAT tEnter, _In_ FLOAT tExit, _In_ INT iAxis, _Out_ ColumnHit& hit) const;
+        BOOL intersect(_In_ const GridRay& ray, _Out_ ColumnHit& hit, _Out_opt_ UINT* puNumNodes) const;
+        BOOL marchColumns(_In_ const GridRay& ray, _Out_ ColumnHit& hit, _Out_opt_ UINT* puNumColumns) const;
+        void fillHit(_In_ const GridRay& ray, _In_ const ColumnHit& columnHit, _Out_ VoxelRayHit& hit) const;
+        BOOL isBoxOccludedBruteForce(_In_ const XMFLOAT3& eye, _In_ const XMFLOAT3& boxMin, _In_ const XMFLOAT3& boxMax) const;
+
+        static HeightRange mergeChildren(_In_ const Level& fine, _In_ UINT x, _In_ UINT z);
+        static BOOL occludes(_In_reads_(3) const FLOAT* pEye, _In_reads_(3) const FLOAT* pBoxMin, _In_reads_(3) const FLOAT* pBoxMax, _In_reads_(3) const FLOAT* pOccluderMin, _In_reads_(3) const FLOAT* pOccluderMax);
+
+    private:
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        std::vector<Level> m_aLevels;
+        XMFLOAT3 m_gridOrigin;
+        HeightPyramidStats m_stats;
+    };
+}
\ No newline at end of file
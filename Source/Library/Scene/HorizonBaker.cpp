@@ -0,0 +1,683 @@
+#include "Scene/HorizonBaker.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::HorizonBaker
+
+      Summary:  Constructor. The grid origin is the world position of
+                the lower corner of the cell (0, 0, 0), one cell spans
+                two world units
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map the voxels are placed with
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Occupancy of the cells the heights are read from
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_gridOrigin, m_aHeights,
+                 m_aColumnOffsets, m_aQueries, m_aaHorizons, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HorizonBaker::HorizonBaker(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_gridOrigin()
+        , m_aHeights()
+        , m_aColumnOffsets()
+        , m_aQueries()
+        , m_aaHorizons()
+        , m_stats()
+    {
+        XMFLOAT3 firstCell = m_heightMap->GetVoxelPosition(0u, 0u, 0u);
+        m_gridOrigin = XMFLOAT3(firstCell.x - 1.0f, firstCell.y - 1.0f, firstCell.z - 1.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::Bake
+
+      Summary:  Bakes the horizons of every instance of the voxels and
+                hands them to the voxels, which upload them with their
+                instances. An instance, which may be a vertical run of
+                cells, is seen from the top of its highest cell. The
+                lines of every direction are shared out in batches of
+                LINES_PER_BATCH between the workers, the first worker
+                being the calling thread. The horizons of the first
+                uNumBruteForceInstances instances are then found again
+                by visiting every column along each direction
+
+      Args:     const std::vector<std::shared_ptr<Voxel>>& voxels
+                  Voxels whose instances are baked
+                UINT uNumBruteForceInstances
+                  Number of instances checked against brute force
+                UINT uNumWorkers
+                  Number of workers, 0 for every hardware thread
+
+      Modifies: [m_aHeights, m_aColumnOffsets, m_aQueries, m_aaHorizons,
+                 m_stats].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HorizonBaker::Bake(_In_ const std::vector<std::shared_ptr<Voxel>>& voxels, _In_ UINT uNumBruteForceInstances, _In_ UINT uNumWorkers)
+    {
+        const INT iWidth = static_cast<INT>(m_occupancyGrid->GetWidth());
+        const INT iHeight = static_cast<INT>(m_occupancyGrid->GetHeight());
+        const INT iDepth = static_cast<INT>(m_occupancyGrid->GetDepth());
+        if (iWidth <= 0 || iDepth <= 0)
+        {
+            return E_FAIL;
+        }
+
+        BenchmarkTimer timer;
+
+        m_aHeights.assign(static_cast<size_t>(iWidth) * static_cast<size_t>(iDepth), 0u);
+        refreshHeights(0, 0, iWidth - 1, iDepth - 1);
+
+        // Queries grouped by column, the cell of an instance being read
+        // back from its transform
+        m_aColumnOffsets.assign(m_aHeights.size() + 1u, 0u);
+        m_aaHorizons.resize(voxels.size());
+        std::vector<XMINT3> aCells;
+        for (UINT uVoxelIdx = 0u; uVoxelIdx < voxels.size(); ++uVoxelIdx)
+        {
+            const std::vector<InstanceData>& aInstanceData = voxels[uVoxelIdx]->GetInstanceData();
+            m_aaHorizons[uVoxelIdx].assign(aInstanceData.size(), InstanceHorizonData());
+            for (const InstanceData& instance : aInstanceData)
+            {
+                XMFLOAT4X4 transform;
+                XMStoreFloat4x4(&transform, instance.Transformation);
+
+                FLOAT runLength = std::max<FLOAT>(transform.m[1][1], 1.0f);
+                XMINT3 cell(
+                    static_cast<INT>(floorf((transform.m[3][0] - m_gridOrigin.x) * 0.5f)),
+                    static_cast<INT>(floorf((transform.m[3][1] + runLength - 1.0f - m_gridOrigin.y) * 0.5f)),
+                    static_cast<INT>(floorf((transform.m[3][2] - m_gridOrigin.z) * 0.5f))
+                );
+                if (cell.x < 0 || cell.x >= iWidth || cell.y < 0 || cell.y >= iHeight || cell.z < 0 || cell.z >= iDepth)
+                {
+                    cell = XMINT3(-1, -1, -1);
+                }
+                else
+                {
+                    ++m_aColumnOffsets[static_cast<size_t>(cell.z) * static_cast<size_t>(iWidth) + static_cast<size_t>(cell.x) + 1u];
+                }
+                aCells.push_back(cell);
+            }
+        }
+        for (size_t i = 1u; i < m_aColumnOffsets.size(); ++i)
+        {
+            m_aColumnOffsets[i] += m_aColumnOffsets[i - 1u];
+        }
+
+        m_aQueries.resize(m_aColumnOffsets.back());
+        std::vector<UINT> aNextQueries(m_aColumnOffsets.begin(), m_aColumnOffsets.end() - 1);
+        size_t uCellIdx = 0u;
+        for (UINT uVoxelIdx = 0u; uVoxelIdx < voxels.size(); ++uVoxelIdx)
+        {
+            for (UINT uInstanceIdx = 0u; uInstanceIdx < m_aaHorizons[uVoxelIdx].size(); ++uInstanceIdx)
+            {
+                const XMINT3& cell = aCells[uCellIdx++];
+                if (cell.x >= 0)
+                {
+                    UINT& uQueryIdx = aNextQueries[static_cast<size_t>(cell.z) * static_cast<size_t>(iWidth) + static_cast<size_t>(cell.x)];
+                    m_aQueries[uQueryIdx++] = Query{ .uVoxelIdx = uVoxelIdx, .uInstanceIdx = uInstanceIdx, .uHeight = static_cast<UINT>(cell.y) + 1u, .uElevation = 0u };
+                }
+            }
+        }
+
+        // Every line of a direction ends on a column whose next one
+        // along the direction is off the grid
+        std::vector<Line> aLines;
+        for (UINT uDirection = 0u; uDirection < NUM_DIRECTIONS; ++uDirection)
+        {
+            for (INT z = 0; z < iDepth; ++z)
+            {
+                for (INT x = 0; x < iWidth; ++x)
+                {
+                    INT iNextX = x + DIRECTIONS[uDirection][0];
+                    INT iNextZ = z + DIRECTIONS[uDirection][1];
+                    if (iNextX < 0 || iNextX >= iWidth || iNextZ < 0 || iNextZ >= iDepth)
+                    {
+                        aLines.push_back(Line{ .uDirection = uDirection, .x = x, .z = z });
+                    }
+                }
+            }
+        }
+
+        UINT uNumBatches = (static_cast<UINT>(aLines.size()) + LINES_PER_BATCH - 1u) / LINES_PER_BATCH;
+        uNumWorkers = uNumWorkers > 0u ? uNumWorkers : std::thread::hardware_concurrency();
+        uNumWorkers = std::clamp<UINT>(uNumWorkers, 1u, std::max<UINT>(uNumBatches, 1u));
+
+        std::atomic<UINT> uNextBatch(0u);
+        std::vector<std::thread> aWorkers;
+        aWorkers.reserve(uNumWorkers - 1u);
+        for (UINT i = 1u; i < uNumWorkers; ++i)
+        {
+            aWorkers.emplace_back(&HorizonBaker::bakeLines, this, std::ref(uNextBatch), std::cref(aLines));
+        }
+        bakeLines(uNextBatch, aLines);
+
+        for (std::thread& worker : aWorkers)
+        {
+            worker.join();
+        }
+
+        m_stats.BakeMilliseconds = timer.GetMilliseconds();
+        m_stats.uNumInstances = static_cast<UINT>(aCells.size());
+        m_stats.uNumLines = static_cast<UINT>(aLines.size());
+        m_stats.uNumWorkers = uNumWorkers;
+
+        // Brute force over the first instances
+        uNumBruteForceInstances = std::min<UINT>(uNumBruteForceInstances, static_cast<UINT>(m_aQueries.size()));
+        m_stats.uNumBruteForceInstances = uNumBruteForceInstances;
+        m_stats.bIdentical = TRUE;
+        timer.Start();
+        for (INT z = 0; z < iDepth; ++z)
+        {
+            for (INT x = 0; x < iWidth; ++x)
+            {
+                size_t uColumnIdx = static_cast<size_t>(z) * static_cast<size_t>(iWidth) + static_cast<size_t>(x);
+                UINT uLastQuery = std::min<UINT>(m_aColumnOffsets[uColumnIdx + 1u], uNumBruteForceInstances);
+                for (UINT i = m_aColumnOffsets[uColumnIdx]; i < uLastQuery; ++i)
+                {
+                    const Query& query = m_aQueries[i];
+                    const InstanceHorizonData& horizon = m_aaHorizons[query.uVoxelIdx][query.uInstanceIdx];
+                    for (UINT uDirection = 0u; uDirection < NUM_DIRECTIONS; ++uDirection)
+                    {
+                        if (marchHorizon(uDirection, x, z, query.uHeight) != horizon.aElevations[uDirection])
+                        {
+                            m_stats.bIdentical = FALSE;
+                        }
+                    }
+                }
+            }
+        }
+        m_stats.BruteForceMilliseconds = timer.GetMilliseconds();
+
+        for (UINT uVoxelIdx = 0u; uVoxelIdx < voxels.size(); ++uVoxelIdx)
+        {
+            voxels[uVoxelIdx]->SetInstanceHorizons(std::move(m_aaHorizons[uVoxelIdx]));
+        }
+
+        // Edits are rebaked from the editor, only the heights are kept
+        std::vector<UINT>().swap(m_aColumnOffsets);
+        std::vector<Query>().swap(m_aQueries);
+        std::vector<std::vector<InstanceHorizonData>>().swap(m_aaHorizons);
+        m_stats.ullMemoryBytes = GetMemoryUsage() + static_cast<UINT64>(m_stats.uNumInstances) * sizeof(InstanceHorizonData);
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"HorizonBaker: %u instances, %u lines in %.2f ms on %u workers, %.1f KB, brute force %u instances in %.2f ms, %s\n",
+            m_stats.uNumInstances,
+            m_stats.uNumLines,
+            m_stats.BakeMilliseconds,
+            m_stats.uNumWorkers,
+            static_cast<FLOAT>(m_stats.ullMemoryBytes) / 1024.0f,
+            m_stats.uNumBruteForceInstances,
+            m_stats.BruteForceMilliseconds,
+            m_stats.bIdentical ? L"identical" : L"MISMATCH"
+        );
+        OutputDebugString(szReport);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::Rebake
+
+      Summary:  Bakes again the horizons the edits of a rectangle of
+                columns may have changed, those of the instances on the
+                lines through the rectangle in every direction. The
+                instances are found through the editor, and their
+                horizons are set one at a time so that the next flush
+                uploads only them. Instances the edits added start with
+                the open sky and are baked here since they lie in the
+                rectangle. The rectangle should cover the neighbours of
+                the edited cells, whose faces the edits open or close
+
+      Args:     const VoxelEditor& editor
+                  Editor whose voxels were baked
+                INT iMinX
+                  Lowest index of the rectangle along the x-axis
+                INT iMinZ
+                  Lowest index of the rectangle along the z-axis
+                INT iMaxX
+                  Highest index of the rectangle along the x-axis
+                INT iMaxZ
+                  Highest index of the rectangle along the z-axis
+
+      Modifies: [m_aHeights, m_stats].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HorizonBaker::Rebake(_In_ const VoxelEditor& editor, _In_ INT iMinX, _In_ INT iMinZ, _In_ INT iMaxX, _In_ INT iMaxZ)
+    {
+        const INT iWidth = static_cast<INT>(m_occupancyGrid->GetWidth());
+        const INT iDepth = static_cast<INT>(m_occupancyGrid->GetDepth());
+        if (m_aHeights.size() != static_cast<size_t>(iWidth) * static_cast<size_t>(iDepth))
+        {
+            return E_FAIL;
+        }
+
+        iMinX = std::max<INT>(iMinX, 0);
+        iMinZ = std::max<INT>(iMinZ, 0);
+        iMaxX = std::min<INT>(iMaxX, iWidth - 1);
+        iMaxZ = std::min<INT>(iMaxZ, iDepth - 1);
+        if (iMinX > iMaxX || iMinZ > iMaxZ)
+        {
+            return S_OK;
+        }
+
+        BenchmarkTimer timer;
+
+        refreshHeights(iMinX, iMinZ, iMaxX, iMaxZ);
+
+        std::vector<Line> aLines;
+        for (UINT uDirection = 0u; uDirection < NUM_DIRECTIONS; ++uDirection)
+        {
+            for (INT z = iMinZ; z <= iMaxZ; ++z)
+            {
+                for (INT x = iMinX; x <= iMaxX; ++x)
+                {
+                    aLines.push_back(getLineStart(uDirection, x, z));
+                }
+            }
+        }
+        std::sort(aLines.begin(), aLines.end(), [](const Line& a, const Line& b)
+            {
+                return a.uDirection != b.uDirection ? a.uDirection < b.uDirection : (a.z != b.z ? a.z < b.z : a.x < b.x);
+            }
+        );
+        aLines.erase(
+            std::unique(aLines.begin(), aLines.end(), [](const Line& a, const Line& b)
+                {
+                    return a.uDirection == b.uDirection && a.z == b.z && a.x == b.x;
+                }
+            ),
+            aLines.end()
+        );
+
+        const std::vector<std::shared_ptr<Voxel>>& voxels = editor.GetVoxels();
+        std::vector<HullPoint> aHull;
+        std::vector<Query> aResults;
+        UINT uNumInstances = 0u;
+        for (const Line& line : aLines)
+        {
+            sweepLine(line, &editor, aHull, aResults);
+            for (const Query& result : aResults)
+            {
+                const std::vector<InstanceHorizonData>& aHorizons = voxels[result.uVoxelIdx]->GetInstanceHorizons();
+                if (result.uInstanceIdx < aHorizons.size() && aHorizons[result.uInstanceIdx].aElevations[line.uDirection] != result.uElevation)
+                {
+                    InstanceHorizonData horizon = aHorizons[result.uInstanceIdx];
+                    horizon.aElevations[line.uDirection] = result.uElevation;
+                    voxels[result.uVoxelIdx]->SetInstanceHorizon(result.uInstanceIdx, horizon);
+                }
+            }
+            uNumInstances += static_cast<UINT>(aResults.size());
+        }
+
+        FLOAT milliseconds = timer.GetMilliseconds();
+        ++m_stats.uNumRebakes;
+        m_stats.uLastRebakeLines = static_cast<UINT>(aLines.size());
+        m_stats.uLastRebakeInstances = uNumInstances;
+        m_stats.LastRebakeMilliseconds = milliseconds;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::GetSunVisibility
+
+      Summary:  Returns how much of a light a horizon lets through, as
+                VSVoxelHorizon computes it. The horizon is interpolated
+                between the two directions around the light and the
+                light fades in over PENUMBRA radians above it
+
+      Args:     const InstanceHorizonData& horizon
+                  Horizon of an instance
+                const XMFLOAT3& toLight
+                  Direction from the instance to the light
+
+      Returns:  FLOAT
+                  Visibility between 0 and 1
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT HorizonBaker::GetSunVisibility(_In_ const InstanceHorizonData& horizon, _In_ const XMFLOAT3& toLight)
+    {
+        FLOAT elevation = atan2f(toLight.y, sqrtf(toLight.x * toLight.x + toLight.z * toLight.z));
+        FLOAT azimuth = atan2f(toLight.z, toLight.x) / XM_2PI * static_cast<FLOAT>(NUM_DIRECTIONS);
+        azimuth = azimuth < 0.0f ? azimuth + static_cast<FLOAT>(NUM_DIRECTIONS) : azimuth;
+
+        UINT uFirst = std::min<UINT>(static_cast<UINT>(azimuth), NUM_DIRECTIONS - 1u);
+        UINT uSecond = (uFirst + 1u) % NUM_DIRECTIONS;
+        FLOAT t = azimuth - static_cast<FLOAT>(uFirst);
+        FLOAT horizonElevation = (static_cast<FLOAT>(horizon.aElevations[uFirst]) * (1.0f - t) + static_cast<FLOAT>(horizon.aElevations[uSecond]) * t) / 255.0f * XM_PIDIV2;
+
+        return std::clamp<FLOAT>((elevation - horizonElevation) / PENUMBRA, 0.0f, 1.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::GetAmbientOcclusion
+
+      Summary:  Returns the fraction of the sky a horizon leaves open,
+                as VSVoxelHorizon computes it: the mean over the
+                directions of one minus the sine of the elevation
+
+      Args:     const InstanceHorizonData& horizon
+                  Horizon of an instance
+
+      Returns:  FLOAT
+                  1 under the open sky, toward 0 in a pit
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT HorizonBaker::GetAmbientOcclusion(_In_ const InstanceHorizonData& horizon)
+    {
+        FLOAT ambientOcclusion = 0.0f;
+        for (UINT uDirection = 0u; uDirection < NUM_DIRECTIONS; ++uDirection)
+        {
+            ambientOcclusion += 1.0f - sinf(static_cast<FLOAT>(horizon.aElevations[uDirection]) / 255.0f * XM_PIDIV2);
+        }
+
+        return ambientOcclusion / static_cast<FLOAT>(NUM_DIRECTIONS);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::GetMemoryUsage
+
+      Summary:  Returns the memory kept between bakes, the height of
+                every column. The horizons live in the voxels
+
+      Returns:  UINT64
+                  Size in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 HorizonBaker::GetMemoryUsage() const
+    {
+        return static_cast<UINT64>(m_aHeights.capacity() * sizeof(WORD) + m_aColumnOffsets.capacity() * sizeof(UINT) + m_aQueries.capacity() * sizeof(Query));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::GetStats
+
+      Summary:  Returns the statistics of the bakes
+
+      Returns:  const HorizonBakeStats&
+                  Statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const HorizonBakeStats& HorizonBaker::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::refreshHeights
+
+      Summary:  Reads the heights of a rectangle of columns from the
+                occupancy grid, one above their highest solid cell
+
+      Args:     INT iMinX
+                  Lowest index of the rectangle along the x-axis
+                INT iMinZ
+                  Lowest index of the rectangle along the z-axis
+                INT iMaxX
+                  Highest index of the rectangle along the x-axis
+                INT iMaxZ
+                  Highest index of the rectangle along the z-axis
+
+      Modifies: [m_aHeights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HorizonBaker::refreshHeights(_In_ INT iMinX, _In_ INT iMinZ, _In_ INT iMaxX, _In_ INT iMaxZ)
+    {
+        const UINT uWidth = m_occupancyGrid->GetWidth();
+        const UINT uWordsPerColumn = m_occupancyGrid->GetWordsPerColumn();
+        for (INT z = iMinZ; z <= iMaxZ; ++z)
+        {
+            for (INT x = iMinX; x <= iMaxX; ++x)
+            {
+                const UINT64* pWords = m_occupancyGrid->GetColumnWords(x, z);
+                WORD uHeight = 0u;
+                for (UINT uWordIdx = uWordsPerColumn; uWordIdx > 0u; --uWordIdx)
+                {
+                    if (pWords[uWordIdx - 1u] != 0ull)
+                    {
+                        uHeight = static_cast<WORD>(uWordIdx * OccupancyGrid::BITS_PER_WORD - static_cast<UINT>(std::countl_zero(pWords[uWordIdx - 1u])));
+                        break;
+                    }
+                }
+                m_aHeights[static_cast<size_t>(z) * uWidth + static_cast<size_t>(x)] = uHeight;
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::getLineStart
+
+      Summary:  Returns the line along a direction through a column,
+                starting from its last column along the direction,
+                which is where the sweep begins
+
+      Args:     UINT uDirection
+                  Index of the direction
+                INT x
+                  Index of the column along the x-axis
+                INT z
+                  Index of the column along the z-axis
+
+      Returns:  Line
+                  Line through the column
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HorizonBaker::Line HorizonBaker::getLineStart(_In_ UINT uDirection, _In_ INT x, _In_ INT z) const
+    {
+        const INT iDirectionX = DIRECTIONS[uDirection][0];
+        const INT iDirectionZ = DIRECTIONS[uDirection][1];
+        INT iStepsX = iDirectionX > 0 ? static_cast<INT>(m_occupancyGrid->GetWidth()) - 1 - x : (iDirectionX < 0 ? x : INT_MAX);
+        INT iStepsZ = iDirectionZ > 0 ? static_cast<INT>(m_occupancyGrid->GetDepth()) - 1 - z : (iDirectionZ < 0 ? z : INT_MAX);
+        INT iSteps = std::min<INT>(iStepsX, iStepsZ);
+
+        return Line{ .uDirection = uDirection, .x = x + iSteps * iDirectionX, .z = z + iSteps * iDirectionZ };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::sweepLine
+
+      Summary:  Walks a line against its direction from its last
+                column, so that the columns already passed are those
+                the instances look at. They are kept as the upper
+                convex hull of their steps and heights, on which the
+                highest point seen from an instance is where the hull
+                turns away from it. An instance does not look at its
+                own column. The instances of a column come from the
+                queries of the bake, or from the exposed cells of the
+                column and the editor when there is one
+
+      Args:     const Line& line
+                  Line to sweep
+                const VoxelEditor* pEditor
+                  Editor the instances are found through, or nullptr
+                std::vector<HullPoint>& aHull
+                  Storage of the hull
+                std::vector<Query>& aResults
+                  Receives the instances with their elevation
+
+      Modifies: [aHull, aResults].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HorizonBaker::sweepLine(_In_ const Line& line, _In_opt_ const VoxelEditor* pEditor, _Inout_ std::vector<HullPoint>& aHull, _Inout_ std::vector<Query>& aResults) const
+    {
+        const INT iWidth = static_cast<INT>(m_occupancyGrid->GetWidth());
+        const INT iDepth = static_cast<INT>(m_occupancyGrid->GetDepth());
+        const INT iDirectionX = DIRECTIONS[line.uDirection][0];
+        const INT iDirectionZ = DIRECTIONS[line.uDirection][1];
+        const FLOAT inverseStepLength = iDirectionX != 0 && iDirectionZ != 0 ? 1.0f / sqrtf(2.0f) : 1.0f;
+
+        aHull.clear();
+        aResults.clear();
+        INT64 iStep = 0;
+        for (INT x = line.x, z = line.z; x >= 0 && x < iWidth && z >= 0 && z < iDepth; x -= iDirectionX, z -= iDirectionZ, ++iStep)
+        {
+            size_t uColumnIdx = static_cast<size_t>(z) * static_cast<size_t>(iWidth) + static_cast<size_t>(x);
+            size_t uFirstResult = aResults.size();
+            if (pEditor)
+            {
+                for (UINT uWordIdx = 0u; uWordIdx < m_occupancyGrid->GetWordsPerColumn(); ++uWordIdx)
+                {
+                    UINT64 ullExposed = m_occupancyGrid->GetExposedWord(static_cast<UINT>(x), static_cast<UINT>(z), uWordIdx);
+                    while (ullExposed)
+                    {
+                        UINT y = uWordIdx * OccupancyGrid::BITS_PER_WORD + static_cast<UINT>(std::countr_zero(ullExposed));
+                        ullExposed &= ullExposed - 1ull;
+
+                        Query query = { .uVoxelIdx = 0u, .uInstanceIdx = 0u, .uHeight = y + 1u, .uElevation = 0u };
+                        if (pEditor->GetInstanceLocation(static_cast<UINT>(x), y, static_cast<UINT>(z), query.uVoxelIdx, query.uInstanceIdx))
+                        {
+                            aResults.push_back(query);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                aResults.insert(aResults.end(), m_aQueries.begin() + m_aColumnOffsets[uColumnIdx], m_aQueries.begin() + m_aColumnOffsets[uColumnIdx + 1u]);
+            }
+
+            for (size_t i = uFirstResult; i < aResults.size() && !aHull.empty(); ++i)
+            {
+                // The hull point after the tangent lies below the line
+                // from the tangent to the instance
+                const INT64 iQueryHeight = static_cast<INT64>(aResults[i].uHeight);
+                size_t uLow = 0u;
+                size_t uHigh = aHull.size() - 1u;
+                while (uLow < uHigh)
+                {
+                    size_t uMid = (uLow + uHigh) / 2u;
+                    const HullPoint& a = aHull[uMid];
+                    const HullPoint& b = aHull[uMid + 1u];
+                    if ((iStep - a.iStep) * (b.iHeight - a.iHeight) - (iQueryHeight - a.iHeight) * (b.iStep - a.iStep) > 0)
+                    {
+                        uLow = uMid + 1u;
+                    }
+                    else
+                    {
+                        uHigh = uMid;
+                    }
+                }
+
+                const HullPoint& tangent = aHull[uLow];
+                FLOAT slope = static_cast<FLOAT>(tangent.iHeight - iQueryHeight) / static_cast<FLOAT>(iStep - tangent.iStep) * inverseStepLength;
+                aResults[i].uElevation = encodeSlope(slope);
+            }
+
+            HullPoint point = { .iStep = iStep, .iHeight = static_cast<INT64>(m_aHeights[uColumnIdx]) };
+            while (aHull.size() >= 2u)
+            {
+                const HullPoint& a = aHull[aHull.size() - 2u];
+                const HullPoint& b = aHull.back();
+                if ((b.iStep - a.iStep) * (point.iHeight - a.iHeight) - (b.iHeight - a.iHeight) * (point.iStep - a.iStep) < 0)
+                {
+                    break;
+                }
+                aHull.pop_back();
+            }
+            aHull.push_back(point);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::bakeLines
+
+      Summary:  Sweeps the batches of lines taken by one worker and
+                writes the elevations into the horizons of the bake.
+                Every direction of an instance lies on a single line,
+                so the workers never write the same byte
+
+      Args:     std::atomic<UINT>& uNextBatch
+                  Index of the next batch to take
+                const std::vector<Line>& aLines
+                  Lines of every direction
+
+      Modifies: [m_aaHorizons].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HorizonBaker::bakeLines(_Inout_ std::atomic<UINT>& uNextBatch, _In_ const std::vector<Line>& aLines)
+    {
+        std::vector<HullPoint> aHull;
+        std::vector<Query> aResults;
+        for (;;)
+        {
+            UINT uFirst = uNextBatch.fetch_add(1u) * LINES_PER_BATCH;
+            if (uFirst >= aLines.size())
+            {
+                break;
+            }
+
+            UINT uLast = std::min<UINT>(uFirst + LINES_PER_BATCH, static_cast<UINT>(aLines.size()));
+            for (UINT i = uFirst; i < uLast; ++i)
+            {
+                sweepLine(aLines[i], nullptr, aHull, aResults);
+                for (const Query& result : aResults)
+                {
+                    m_aaHorizons[result.uVoxelIdx][result.uInstanceIdx].aElevations[aLines[i].uDirection] = result.uElevation;
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::marchHorizon
+
+      Summary:  Returns the horizon of a point in a direction by
+                visiting every column along it, which the sweep is
+                checked against
+
+      Args:     UINT uDirection
+                  Index of the direction
+                INT x
+                  Index of the column along the x-axis
+                INT z
+                  Index of the column along the z-axis
+                UINT uHeight
+                  Height of the point in cells
+
+      Returns:  BYTE
+                  Elevation of the horizon
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE HorizonBaker::marchHorizon(_In_ UINT uDirection, _In_ INT x, _In_ INT z, _In_ UINT uHeight) const
+    {
+        const INT iWidth = static_cast<INT>(m_occupancyGrid->GetWidth());
+        const INT iDepth = static_cast<INT>(m_occupancyGrid->GetDepth());
+        const INT iDirectionX = DIRECTIONS[uDirection][0];
+        const INT iDirectionZ = DIRECTIONS[uDirection][1];
+        const FLOAT inverseStepLength = iDirectionX != 0 && iDirectionZ != 0 ? 1.0f / sqrtf(2.0f) : 1.0f;
+
+        FLOAT maxSlope = 0.0f;
+        INT64 iStep = 1;
+        for (INT iX = x + iDirectionX, iZ = z + iDirectionZ; iX >= 0 && iX < iWidth && iZ >= 0 && iZ < iDepth; iX += iDirectionX, iZ += iDirectionZ, ++iStep)
+        {
+            INT64 iColumnHeight = static_cast<INT64>(m_aHeights[static_cast<size_t>(iZ) * static_cast<size_t>(iWidth) + static_cast<size_t>(iX)]);
+            FLOAT slope = static_cast<FLOAT>(iColumnHeight - static_cast<INT64>(uHeight)) / static_cast<FLOAT>(iStep) * inverseStepLength;
+            maxSlope = std::max<FLOAT>(maxSlope, slope);
+        }
+
+        return encodeSlope(maxSlope);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HorizonBaker::encodeSlope
+
+      Summary:  Returns the byte of the elevation of a slope, a quarter
+                turn mapped to 255. Slopes below the horizontal are
+                the open sky
+
+      Args:     FLOAT slope
+                  Rise over run, both in cells
+
+      Returns:  BYTE
+                  Elevation
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE HorizonBaker::encodeSlope(_In_ FLOAT slope)
+    {
+        if (slope <= 0.0f)
+        {
+            return 0u;
+        }
+
+        return static_cast<BYTE>(std::min<FLOAT>(atanf(slope) / XM_PIDIV2 * 255.0f + 0.5f, 255.0f));
+    }
+}
\ No newline at end of file
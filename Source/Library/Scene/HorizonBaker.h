@@ -0,0 +1,170 @@
+/*+===================================================================
+  File:      HORIZONBAKER.H
+
+  Summary:   HorizonBaker header file contains declarations of
+             HorizonBaker class that bakes the horizons of the voxel
+             instances for their sun visibility and ambient occlusion.
+
+  Classes: HorizonBaker
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <bit>
+#include <thread>
+
+#include "Game/Benchmark.h"
+#include "Renderer/DataTypes.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/Voxel.h"
+#include "Scene/VoxelEditor.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   HorizonBakeStats
+
+        Summary:  Instances and lines of columns swept by the last bake
+                  and the time it took across its workers, the memory
+                  kept between bakes, the time brute-force marches took
+                  for the first instances and whether they found the
+                  same horizons, and the lines, instances and time of
+                  the last rebake after an edit
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct HorizonBakeStats
+    {
+        UINT uNumInstances;
+        UINT uNumLines;
+        UINT uNumWorkers;
+        UINT64 ullMemoryBytes;
+        FLOAT BakeMilliseconds;
+        UINT uNumBruteForceInstances;
+        FLOAT BruteForceMilliseconds;
+        UINT uNumRebakes;
+        UINT uLastRebakeLines;
+        UINT uLastRebakeInstances;
+        FLOAT LastRebakeMilliseconds;
+        BOOL bIdentical;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    HorizonBaker
+
+      Summary:  Bakes, for every voxel instance, the elevation of the
+                terrain horizon in eight directions seen from the top
+                of its highest cell. The vertex shader tells from them
+                whether a light stands above the horizon and how much
+                sky is open, which stands for a shadow map pass and
+                ambient occlusion. The terrain is taken as the
+                heightfield of the highest solid cell of each column, so
+                overhangs cast no horizon. Each direction is baked by
+                sweeping the lines of columns along it while keeping
+                the upper convex hull of the columns already passed, on
+                which the horizon of a point is the tangent found by a
+                binary search, so a bake costs a few steps per instance
+                and per direction. After an edit only the lines through
+                the edited columns are swept again
+
+      Methods:  Bake
+                  Bakes the horizons of every instance of the voxels
+                Rebake
+                  Bakes again the lines through edited columns
+                GetSunVisibility
+                  Returns how much of a light a horizon lets through
+                GetAmbientOcclusion
+                  Returns the fraction of the sky a horizon leaves open
+                GetMemoryUsage
+                  Returns the memory kept between bakes in bytes
+                GetStats
+                  Returns the statistics of the bakes
+                refreshHeights
+                  Reads the heights of columns from the occupancy grid
+                getLineStart
+                  Returns the last column of a line along a direction
+                sweepLine
+                  Bakes the horizons of the instances along a line
+                bakeLines
+                  Sweeps the batches of lines taken by one worker
+                marchHorizon
+                  Returns a horizon by visiting every column
+                encodeSlope
+                  Returns the byte of the elevation of a slope
+                HorizonBaker
+                  Constructor.
+                ~HorizonBaker
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class HorizonBaker
+    {
+    public:
+        static constexpr const UINT NUM_DIRECTIONS = 8u;
+        static constexpr const UINT LINES_PER_BATCH = 16u;
+        static constexpr const FLOAT PENUMBRA = 0.1f;
+
+        HorizonBaker(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid);
+        HorizonBaker(const HorizonBaker& other) = delete;
+        HorizonBaker(HorizonBaker&& other) = delete;
+        HorizonBaker& operator=(const HorizonBaker& other) = delete;
+        HorizonBaker& operator=(HorizonBaker&& other) = delete;
+        ~HorizonBaker() = default;
+
+        HRESULT Bake(_In_ const std::vector<std::shared_ptr<Voxel>>& voxels, _In_ UINT uNumBruteForceInstances = 0u, _In_ UINT uNumWorkers = 0u);
+        HRESULT Rebake(_In_ const VoxelEditor& editor, _In_ INT iMinX, _In_ INT iMinZ, _In_ INT iMaxX, _In_ INT iMaxZ);
+
+        static FLOAT GetSunVisibility(_In_ const InstanceHorizonData& horizon, _In_ const XMFLOAT3& toLight);
+        static FLOAT GetAmbientOcclusion(_In_ const InstanceHorizonData& horizon);
+
+        UINT64 GetMemoryUsage() const;
+        const HorizonBakeStats& GetStats() const;
+
+    private:
+        static constexpr const INT DIRECTIONS[NUM_DIRECTIONS][2] =
+        {
+            { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+        };
+
+        struct Line
+        {
+            UINT uDirection;
+            INT x;
+            INT z;
+        };
+
+        struct Query
+        {
+            UINT uVoxelIdx;
+            UINT uInstanceIdx;
+            UINT uHeight;
+            BYTE uElevation;
+        };
+
+        struct HullPoint
+        {
+            INT64 iStep;
+            INT64 iHeight;
+        };
+
+        void refreshHeights(_In_ INT iMinX, _In_ INT iMinZ, _In_ INT iMaxX, _In_ INT iMaxZ);
+        Line getLineStart(_In_ UINT uDirection, _In_ INT x, _In_ INT z) const;
+        void sweepLine(_In_ const Line& line, _In_opt_ const VoxelEditor* pEditor, _Inout_ std::vector<HullPoint>& aHull, _Inout_ std::vector<Query>& aResults) const;
+        void bakeLines(_Inout_ std::atomic<UINT>& uNextBatch, _In_ const std::vector<Line>& aLines);
+        BYTE marchHorizon(_In_ UINT uDirection, _In_ INT x, _In_ INT z, _In_ UINT uHeight) const;
+
+        static BYTE encodeSlope(_In_ FLOAT slope);
+
+    private:
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        XMFLOAT3 m_gridOrigin;
+        std::vector<WORD> m_aHeights;
+        std::vector<UINT> m_aColumnOffsets;
+        std::vector<Query> m_aQueries;
+        std::vector<std::vector<InstanceHorizonData>> m_aaHorizons;
+        HorizonBakeStats m_stats;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include "Scene/OccupancyGrid.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::OccupancyGrid
+
+      Summary:  Constructor. Allocates an empty grid
+
+      Args:     UINT uWidth
+                  Number of columns along x
+                UINT uHeight
+                  Number of cells along y
+                UINT uDepth
+                  Number of columns along z
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_uWordsPerColumn,
+                 m_uNumChunksX, m_aWords].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    OccupancyGrid::OccupancyGrid(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth)
+        : m_uWidth(uWidth)
+        , m_uHeight(uHeight)
+        , m_uDepth(uDepth)
+        , m_uWordsPerColumn((uHeight + BITS_PER_WORD - 1u) / BITS_PER_WORD)
+        , m_uNumChunksX((uWidth + CHUNK_SIZE - 1u) / CHUNK_SIZE)
+        , m_aWords()
+    {
+        size_t uNumChunksZ = (static_cast<size_t>(uDepth) + CHUNK_SIZE - 1u) / CHUNK_SIZE;
+        m_aWords.assign(static_cast<size_t>(m_uNumChunksX) * uNumChunksZ * CHUNK_SIZE * CHUNK_SIZE * m_uWordsPerColumn, 0ull);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::FillFromHeightMap
+
+      Summary:  Marks the cells from the ground up to the height of each
+                column of a height map with a known block type
+
+      Args:     const HeightMap& heightMap
+                  Height map of the same dimensions as the grid
+
+      Modifies: [m_aWords].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void OccupancyGrid::FillFromHeightMap(_In_ const HeightMap& heightMap)
+    {
+        assert(heightMap.GetWidth() == m_uWidth && heightMap.GetDepth() == m_uDepth);
+
+        size_t uNumColors = heightMap.GetPalette().size();
+        for (UINT z = 0u; z < m_uDepth; ++z)
+        {
+            for (UINT x = 0u; x < m_uWidth; ++x)
+            {
+                const HeightMapColumn& column = heightMap.GetColumn(x, z);
+                size_t uColorIdx = static_cast<size_t>(column.BlockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+                if (column.BlockType < static_cast<CHAR>(eBlockType::GRASSLAND) || uColorIdx >= uNumColors)
+                {
+                    continue;
+                }
+
+                UINT64* pWords = m_aWords.data() + getColumnOffset(x, z);
+                UINT uHeight = std::min<UINT>(column.uHeight, m_uHeight);
+                UINT uNumFullWords = uHeight / BITS_PER_WORD;
+                std::fill(pWords, pWords + uNumFullWords, ~0ull);
+                if (uHeight % BITS_PER_WORD != 0u)
+                {
+                    pWords[uNumFullWords] = (1ull << (uHeight % BITS_PER_WORD)) - 1ull;
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::CopyFrom
+
+      Summary:  Copies the cells of a grid of the same size, so that
+                the copy can be edited without touching the original
+
+      Args:     const OccupancyGrid& other
+                  Grid to copy
+
+      Modifies: [m_aWords].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if the sizes differ
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT OccupancyGrid::CopyFrom(_In_ const OccupancyGrid& other)
+    {
+        if (other.m_uWidth != m_uWidth || other.m_uHeight != m_uHeight || other.m_uDepth != m_uDepth)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_aWords = other.m_aWords;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::IsOccupied
+
+      Summary:  Returns whether a cell is solid. Cells outside of the
+                grid are empty
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  BOOL
+                  TRUE if the cell is solid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL OccupancyGrid::IsOccupied(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        const UINT64* pWords = GetColumnWords(x, z);
+        if (!pWords || y < 0 || static_cast<UINT>(y) >= m_uHeight)
+        {
+            return FALSE;
+        }
+
+        return (pWords[static_cast<UINT>(y) / BITS_PER_WORD] >> (static_cast<UINT>(y) % BITS_PER_WORD)) & 1ull;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::IsExposed
+
+      Summary:  Returns whether a cell is solid and has at least one of
+                its six neighbours empty, the single-cell counterpart
+                of GetExposedWord
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  BOOL
+                  TRUE if the cell is solid with an open face
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL OccupancyGrid::IsExposed(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        if (!IsOccupied(x, y, z))
+        {
+            return FALSE;
+        }
+
+        return !IsOccupied(x - 1, y, z) || !IsOccupied(x + 1, y, z)
+            || !IsOccupied(x, y - 1, z) || !IsOccupied(x, y + 1, z)
+            || !IsOccupied(x, y, z - 1) || !IsOccupied(x, y, z + 1);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::SetOccupied
+
+      Summary:  Sets whether a cell is solid
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+                BOOL bOccupied
+                  Whether the cell is solid
+
+      Modifies: [m_aWords].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void OccupancyGrid::SetOccupied(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BOOL bOccupied)
+    {
+        assert(x < m_uWidth && y < m_uHeight && z < m_uDepth);
+
+        UINT64& word = m_aWords[getColumnOffset(x, z) + y / BITS_PER_WORD];
+        UINT64 uBit = 1ull << (y % BITS_PER_WORD);
+        word = bOccupied ? (word | uBit) : (word & ~uBit);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::GetColumnWords
+
+      Summary:  Returns the words of a column, bit y of the column being
+                bit (y % 64) of word (y / 64)
+
+      Args:     INT x
+                  Index along the x-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  const UINT64*
+                  Words of the column, nullptr outside of the grid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const UINT64* OccupancyGrid::GetColumnWords(_In_ INT x, _In_ INT z) const
+    {
+        if (x < 0 || z < 0 || static_cast<UINT>(x) >= m_uWidth || static_cast<UINT>(z) >= m_uDepth)
+        {
+            return nullptr;
+        }
+
+        return m_aWords.data() + getColumnOffset(static_cast<UINT>(x), static_cast<UINT>(z));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::GetExposedWord
+
+      Summary:  Returns the solid cells of a word of a column that have
+                at least one of their six neighbours empty. Cells
+                outside of the grid count as empty
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT z
+                  Index along the z-axis
+                UINT uWordIdx
+                  Index of the word in the column
+
+      Returns:  UINT64
+                  Bits of the exposed cells
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 OccupancyGrid::GetExposedWord(_In_ UINT x, _In_ UINT z, _In_ UINT uWordIdx) const
+    {
+        const UINT64* pColumn = GetColumnWords(static_cast<INT>(x), static_cast<INT>(z));
+        UINT64 uOccupied = pColumn[uWordIdx];
+        if (uOccupied == 0ull)
+        {
+            return 0ull;
+        }
+
+        // Bit y of uAbove is the cell at y + 1, bit y of uBelow the cell
+        // at y - 1
+        UINT64 uAbove = uOccupied >> 1u;
+        if (uWordIdx + 1u < m_uWordsPerColumn)
+        {
+            uAbove |= pColumn[uWordIdx + 1u] << (BITS_PER_WORD - 1u);
+        }
+        UINT64 uBelow = uOccupied << 1u;
+        if (uWordIdx > 0u)
+        {
+            uBelow |= pColumn[uWordIdx - 1u] >> (BITS_PER_WORD - 1u);
+        }
+
+        UINT64 uCovered = uAbove & uBelow;
+
+        const INT aNeighbors[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+        for (const INT (&neighbor)[2] : aNeighbors)
+        {
+            const UINT64* pNeighbor = GetColumnWords(static_cast<INT>(x) + neighbor[0], static_cast<INT>(z) + neighbor[1]);
+            uCovered &= pNeighbor ? pNeighbor[uWordIdx] : 0ull;
+        }
+
+        return uOccupied & ~uCovered;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::GetWidth
+
+      Summary:  Returns the number of columns along x
+
+      Returns:  UINT
+                  Width of the grid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OccupancyGrid::GetWidth() const
+    {
+        return m_uWidth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::GetHeight
+
+      Summary:  Returns the number of cells along y
+
+      Returns:  UINT
+                  Height of the grid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OccupancyGrid::GetHeight() const
+    {
+        return m_uHeight;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::GetDepth
+
+      Summary:  Returns the number of columns along z
+
+      Returns:  UINT
+                  Depth of the grid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OccupancyGrid::GetDepth() const
+    {
+        return m_uDepth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::GetWordsPerColumn
+
+      Summary:  Returns the number of words of a column
+
+      Returns:  UINT
+                  Number of words of a column
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OccupancyGrid::GetWordsPerColumn() const
+    {
+        return m_uWordsPerColumn;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::GetMemoryUsage
+
+      Summary:  Returns the size of the bitmasks
+
+      Returns:  size_t
+                  Size of the bitmasks in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t OccupancyGrid::GetMemoryUsage() const
+    {
+        return m_aWords.size() * sizeof(UINT64);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OccupancyGrid::getColumnOffset
+
+      Summary:  Returns the offset of the first word of a column. The
+                columns of a chunk are stored contiguously
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT z
+                  Index along the z-axis
+
+      Returns:  size_t
+                  Offset into m_aWords
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t OccupancyGrid::getColumnOffset(_In_ UINT x, _In_ UINT z) const
+    {
+        size_t uChunkIdx = static_cast<size_t>(z / CHUNK_SIZE) * m_uNumChunksX + x / CHUNK_SIZE;
+        size_t uColumnIdx = static_cast<size_t>(z % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE;
+
+        return (uChunkIdx * CHUNK_SIZE * CHUNK_SIZE + uColumnIdx) * m_uWordsPerColumn;
+    }
+}
\ No newline at end of file
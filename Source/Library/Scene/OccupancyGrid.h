@@ -0,0 +1,99 @@
+/*+===================================================================
+  File:      OCCUPANCYGRID.H
+
+  Summary:   OccupancyGrid header file contains declarations of
+             OccupancyGrid class that stores which cells of the voxel
+             world are solid as bit-packed chunks.
+
+  Classes: OccupancyGrid
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <bit>
+
+#include "Scene/HeightMap.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    OccupancyGrid
+
+      Summary:  Bit-packed occupancy of a voxel grid. Columns are split
+                into chunks of CHUNK_SIZE x CHUNK_SIZE columns and every
+                column stores one bit per cell along the y-axis, 64
+                cells to a word, so vertical and horizontal neighbours
+                can be tested a word at a time
+
+      Methods:  FillFromHeightMap
+                  Marks the cells below the height of each column
+                CopyFrom
+                  Copies the cells of a grid of the same size
+                IsOccupied
+                  Returns whether a cell is solid
+                IsExposed
+                  Returns whether a cell is solid with an open face
+                SetOccupied
+                  Sets whether a cell is solid
+                GetColumnWords
+                  Returns the words of a column
+                GetExposedWord
+                  Returns the solid cells of a word with an open face
+                GetWidth
+                  Returns the number of columns along x
+                GetHeight
+                  Returns the number of cells along y
+                GetDepth
+                  Returns the number of columns along z
+                GetWordsPerColumn
+                  Returns the number of words of a column
+                GetMemoryUsage
+                  Returns the size of the bitmasks in bytes
+                OccupancyGrid
+                  Constructor.
+                ~OccupancyGrid
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class OccupancyGrid
+    {
+    public:
+        static constexpr const UINT CHUNK_SIZE = 16u;
+        static constexpr const UINT BITS_PER_WORD = 64u;
+
+        OccupancyGrid(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth);
+        OccupancyGrid(const OccupancyGrid& other) = delete;
+        OccupancyGrid(OccupancyGrid&& other) = delete;
+        OccupancyGrid& operator=(const OccupancyGrid& other) = delete;
+        OccupancyGrid& operator=(OccupancyGrid&& other) = delete;
+        ~OccupancyGrid() = default;
+
+        void FillFromHeightMap(_In_ const HeightMap& heightMap);
+        HRESULT CopyFrom(_In_ const OccupancyGrid& other);
+
+        BOOL IsOccupied(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        BOOL IsExposed(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        void SetOccupied(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BOOL bOccupied);
+        const UINT64* GetColumnWords(_In_ INT x, _In_ INT z) const;
+        UINT64 GetExposedWord(_In_ UINT x, _In_ UINT z, _In_ UINT uWordIdx) const;
+
+        UINT GetWidth() const;
+        UINT GetHeight() const;
+        UINT GetDepth() const;
+        UINT GetWordsPerColumn() const;
+        size_t GetMemoryUsage() const;
+
+    private:
+        size_t getColumnOffset(_In_ UINT x, _In_ UINT z) const;
+
+    private:
+        UINT m_uWidth;
+        UINT m_uHeight;
+        UINT m_uDepth;
+        UINT m_uWordsPerColumn;
+        UINT m_uNumChunksX;
+        std::vector<UINT64> m_aWords;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "Scene/PackedVoxel.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PackedVoxel::PackedVoxel
+
+      Summary:  Constructor
+
+      Args:     std::vector<PackedInstanceData>&& aInstanceData
+                  Packed instances
+                const XMMATRIX& gridTransform
+                  Transform from grid to world space
+                const XMFLOAT4& outputColor
+                  Color of the voxel
+
+      Modifies: [m_aPackedInstanceData, m_world].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    PackedVoxel::PackedVoxel(_In_ std::vector<PackedInstanceData>&& aInstanceData, _In_ const XMMATRIX& gridTransform, _In_ const XMFLOAT4& outputColor)
+        : Voxel(outputColor)
+        , m_aPackedInstanceData(std::move(aInstanceData))
+    {
+        m_world = gridTransform;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PackedVoxel::GetPackedInstanceData
+
+      Summary:  Returns the packed instances
+
+      Returns:  const std::vector<PackedInstanceData>&
+                  Packed instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<PackedInstanceData>& PackedVoxel::GetPackedInstanceData() const
+    {
+        return m_aPackedInstanceData;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PackedVoxel::GetNumInstances
+
+      Summary:  Returns the number of instances
+
+      Returns:  UINT
+                  Number of instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT PackedVoxel::GetNumInstances() const
+    {
+        return static_cast<UINT>(m_aPackedInstanceData.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PackedVoxel::GetInstanceStride
+
+      Summary:  Returns the size of a packed instance
+
+      Returns:  UINT
+                  Size of an instance in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT PackedVoxel::GetInstanceStride() const
+    {
+        return static_cast<UINT>(sizeof(PackedInstanceData));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PackedVoxel::initializeInstance
+
+      Summary:  Creates the instance buffer from the packed instances
+
+      Args:     ID3D11Device* pDevice
+                  Pointer to a Direct3D 11 device
+
+      Modifies: [m_instanceBuffer].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT PackedVoxel::initializeInstance(_In_ ID3D11Device* pDevice)
+    {
+        D3D11_BUFFER_DESC bd =
+        {
+            .ByteWidth = static_cast<UINT>(sizeof(PackedInstanceData)) * GetNumInstances(),
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = 0
+        };
+
+        D3D11_SUBRESOURCE_DATA initData =
+        {
+            .pSysMem = m_aPackedInstanceData.data()
+        };
+
+        return pDevice->CreateBuffer(
+            &bd,
+            &initData,
+            m_instanceBuffer.GetAddressOf()
+        );
+    }
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+/*+===================================================================
+  File:      PACKEDVOXEL.H
+
+  Summary:   PackedVoxel header file contains declarations of
+             PackedVoxel class, a voxel whose instances are stored in
+             the packed 8-byte format.
+
+  Classes: PackedVoxel
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/DataTypes.h"
+#include "Scene/Voxel.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    PackedVoxel
+
+      Summary:  Voxel instanced from grid coordinates instead of
+                transformation matrices. The world matrix holds the
+                transform from grid to world space, and VSVoxelPacked
+                rebuilds the translation of each instance from its
+                coordinates
+
+      Methods:  GetPackedInstanceData
+                  Returns the packed instances
+                GetNumInstances
+                  Returns the number of instances
+                GetInstanceStride
+                  Returns the size of a packed instance
+                initializeInstance
+                  Creates the instance buffer from the packed instances
+                PackedVoxel
+                  Constructor.
+                ~PackedVoxel
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class PackedVoxel : public Voxel
+    {
+    public:
+        PackedVoxel(_In_ std::vector<PackedInstanceData>&& aInstanceData, _In_ const XMMATRIX& gridTransform, _In_ const XMFLOAT4& outputColor);
+        PackedVoxel(const PackedVoxel& other) = delete;
+        PackedVoxel(PackedVoxel&& other) = delete;
+        PackedVoxel& operator=(const PackedVoxel& other) = delete;
+        PackedVoxel& operator=(PackedVoxel&& other) = delete;
+        ~PackedVoxel() = default;
+
+        const std::vector<PackedInstanceData>& GetPackedInstanceData() const;
+        UINT GetNumInstances() const override;
+        UINT GetInstanceStride() const override;
+
+    protected:
+        HRESULT initializeInstance(_In_ ID3D11Device* pDevice) override;
+
+    protected:
+        std::vector<PackedInstanceData> m_aPackedInstanceData;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,533 @@
+#include "Scene/RunLengthColumns.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::RunLengthColumns
+
+      Summary:  Constructor. The columns start out empty
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aOffsets,
+                 m_aRuns, m_ullNumSolidVoxels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    RunLengthColumns::RunLengthColumns()
+        : m_uWidth(0u)
+        , m_uHeight(0u)
+        , m_uDepth(0u)
+        , m_aPalette()
+        , m_aOffsets(1u, 0u)
+        , m_aRuns()
+        , m_ullNumSolidVoxels(0ull)
+    { }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::BuildFromHeightMap
+
+      Summary:  Replaces the columns with those of a height map, each
+                being a single run from the ground up to its height.
+                Columns of an unknown block type are left empty
+
+      Args:     const HeightMap& heightMap
+                  Height map giving the columns
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aOffsets,
+                 m_aRuns, m_ullNumSolidVoxels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RunLengthColumns::BuildFromHeightMap(_In_ const HeightMap& heightMap)
+    {
+        size_t uNumColors = heightMap.GetPalette().size();
+        UINT uHeight = heightMap.GetHeight();
+        for (size_t i = 0u; i < heightMap.GetNumColumns(); ++i)
+        {
+            uHeight = std::max<UINT>(uHeight, heightMap.GetColumns()[i].uHeight);
+        }
+
+        reset(heightMap.GetWidth(), uHeight, heightMap.GetDepth());
+        m_aPalette = heightMap.GetPalette();
+        m_aRuns.reserve(heightMap.GetNumColumns());
+
+        for (size_t i = 0u; i < heightMap.GetNumColumns(); ++i)
+        {
+            const HeightMapColumn& column = heightMap.GetColumns()[i];
+            size_t uColorIdx = static_cast<size_t>(column.BlockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+            if (column.BlockType >= static_cast<CHAR>(eBlockType::GRASSLAND) && uColorIdx < uNumColors)
+            {
+                appendRun(column.BlockType, column.uHeight);
+            }
+            m_aOffsets[i + 1u] = static_cast<UINT>(m_aRuns.size());
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::BuildFromBrickMap
+
+      Summary:  Replaces the columns with those of a brick map, which
+                may hold caves, overhangs and several block types per
+                column. Each column is walked bottom-up and a run ends
+                wherever the block type changes
+
+      Args:     const VoxelBrickMap& brickMap
+                  Brick map giving the cells
+                const std::vector<XMFLOAT4>& aPalette
+                  Colors of the block types
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aOffsets,
+                 m_aRuns, m_ullNumSolidVoxels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RunLengthColumns::BuildFromBrickMap(_In_ const VoxelBrickMap& brickMap, _In_ const std::vector<XMFLOAT4>& aPalette)
+    {
+        reset(brickMap.GetWidth(), brickMap.GetHeight(), brickMap.GetDepth());
+        m_aPalette = aPalette;
+
+        for (UINT z = 0u; z < m_uDepth; ++z)
+        {
+            for (UINT x = 0u; x < m_uWidth; ++x)
+            {
+                CHAR runBlockType = 0;
+                UINT uRunLength = 0u;
+                UINT uNumEmpty = 0u;
+                for (UINT y = 0u; y < m_uHeight; ++y)
+                {
+                    CHAR blockType = brickMap.GetBlockType(static_cast<INT>(x), static_cast<INT>(y), static_cast<INT>(z));
+                    if (blockType == runBlockType)
+                    {
+                        ++uRunLength;
+                        continue;
+                    }
+
+                    // Empty runs are held back until a solid run follows
+                    // them, which drops the empty cells above the top
+                    if (runBlockType == 0)
+                    {
+                        uNumEmpty = uRunLength;
+                    }
+                    else
+                    {
+                        appendRun(0, uNumEmpty);
+                        appendRun(runBlockType, uRunLength);
+                        uNumEmpty = 0u;
+                    }
+                    runBlockType = blockType;
+                    uRunLength = 1u;
+                }
+
+                if (runBlockType != 0)
+                {
+                    appendRun(0, uNumEmpty);
+                    appendRun(runBlockType, uRunLength);
+                }
+                m_aOffsets[static_cast<size_t>(z) * m_uWidth + x + 1u] = static_cast<UINT>(m_aRuns.size());
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::LoadFromFile
+
+      Summary:  Reads columns written by SaveToFile, checking that every
+                offset stays within the runs
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the run-length column file
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aOffsets,
+                 m_aRuns, m_ullNumSolidVoxels].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT RunLengthColumns::LoadFromFile(_In_ const std::filesystem::path& filePath)
+    {
+        std::ifstream inputFile(filePath, std::ios::binary);
+        if (!inputFile.is_open())
+        {
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+        }
+
+        RunLengthColumnsFileHeader header = {};
+        inputFile.read(reinterpret_cast<CHAR*>(&header), sizeof(header));
+        if (inputFile.fail() || header.uMagic != FILE_MAGIC || header.uVersion != FILE_VERSION || header.ullNumRuns > UINT_MAX)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        std::vector<XMFLOAT3> aColors(header.uNumColors);
+        std::vector<UINT> aOffsets(static_cast<size_t>(header.uWidth) * header.uDepth + 1u);
+        std::vector<ColumnRun> aRuns(static_cast<size_t>(header.ullNumRuns));
+        inputFile.seekg(static_cast<std::streamoff>(header.ullPaletteOffset));
+        inputFile.read(reinterpret_cast<CHAR*>(aColors.data()), static_cast<std::streamsize>(aColors.size() * sizeof(XMFLOAT3)));
+        inputFile.seekg(static_cast<std::streamoff>(header.ullOffsetsOffset));
+        inputFile.read(reinterpret_cast<CHAR*>(aOffsets.data()), static_cast<std::streamsize>(aOffsets.size() * sizeof(UINT)));
+        inputFile.seekg(static_cast<std::streamoff>(header.ullRunsOffset));
+        inputFile.read(reinterpret_cast<CHAR*>(aRuns.data()), static_cast<std::streamsize>(aRuns.size() * sizeof(ColumnRun)));
+        if (inputFile.fail() || aOffsets.front() != 0u || aOffsets.back() != aRuns.size() || !std::is_sorted(aOffsets.begin(), aOffsets.end()))
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        reset(header.uWidth, header.uHeight, header.uDepth);
+        for (const XMFLOAT3& color : aColors)
+        {
+            m_aPalette.push_back(XMFLOAT4(color.x, color.y, color.z, 1.0f));
+        }
+        m_aOffsets = std::move(aOffsets);
+        m_aRuns = std::move(aRuns);
+        for (const ColumnRun& run : m_aRuns)
+        {
+            m_ullNumSolidVoxels += run.BlockType != 0 ? run.uLength : 0u;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::SaveToFile
+
+      Summary:  Writes the palette, the run offsets and the runs in the
+                binary format, each array aligned to 16 bytes
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the run-length column file
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT RunLengthColumns::SaveToFile(_In_ const std::filesystem::path& filePath) const
+    {
+        std::ofstream outputFile(filePath, std::ios::binary | std::ios::trunc);
+        if (!outputFile.is_open())
+        {
+            return E_FAIL;
+        }
+
+        UINT64 ullPaletteSize = static_cast<UINT64>(m_aPalette.size()) * sizeof(XMFLOAT3);
+        UINT64 ullOffsetsSize = static_cast<UINT64>(m_aOffsets.size()) * sizeof(UINT);
+        RunLengthColumnsFileHeader header =
+        {
+            .uMagic = FILE_MAGIC,
+            .uVersion = FILE_VERSION,
+            .uWidth = m_uWidth,
+            .uHeight = m_uHeight,
+            .uDepth = m_uDepth,
+            .uNumColors = static_cast<UINT>(m_aPalette.size()),
+            .ullNumRuns = m_aRuns.size(),
+            .ullPaletteOffset = sizeof(RunLengthColumnsFileHeader),
+            .ullOffsetsOffset = (sizeof(RunLengthColumnsFileHeader) + ullPaletteSize + 15ull) & ~15ull,
+            .ullRunsOffset = 0ull
+        };
+        header.ullRunsOffset = (header.ullOffsetsOffset + ullOffsetsSize + 15ull) & ~15ull;
+        outputFile.write(reinterpret_cast<const CHAR*>(&header), sizeof(header));
+
+        for (const XMFLOAT4& color : m_aPalette)
+        {
+            XMFLOAT3 rgb(color.x, color.y, color.z);
+            outputFile.write(reinterpret_cast<const CHAR*>(&rgb), sizeof(rgb));
+        }
+
+        const CHAR aPadding[16] = { 0, };
+        outputFile.write(aPadding, static_cast<std::streamsize>(header.ullOffsetsOffset - header.ullPaletteOffset - ullPaletteSize));
+        outputFile.write(reinterpret_cast<const CHAR*>(m_aOffsets.data()), static_cast<std::streamsize>(ullOffsetsSize));
+        outputFile.write(aPadding, static_cast<std::streamsize>(header.ullRunsOffset - header.ullOffsetsOffset - ullOffsetsSize));
+        outputFile.write(reinterpret_cast<const CHAR*>(m_aRuns.data()), static_cast<std::streamsize>(m_aRuns.size() * sizeof(ColumnRun)));
+
+        if (outputFile.fail())
+        {
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetColumnRuns
+
+      Summary:  Returns the runs of a column, bottom-up
+
+      Args:     UINT x
+                  Column along the x-axis
+                UINT z
+                  Column along the z-axis
+                UINT& uNumRuns
+                  Receives the number of runs
+
+      Returns:  const ColumnRun*
+                  First run of the column, nullptr outside of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const ColumnRun* RunLengthColumns::GetColumnRuns(_In_ UINT x, _In_ UINT z, _Out_ UINT& uNumRuns) const
+    {
+        uNumRuns = 0u;
+        if (x >= m_uWidth || z >= m_uDepth)
+        {
+            return nullptr;
+        }
+
+        size_t uColumnIdx = static_cast<size_t>(z) * m_uWidth + x;
+        uNumRuns = m_aOffsets[uColumnIdx + 1u] - m_aOffsets[uColumnIdx];
+        return m_aRuns.data() + m_aOffsets[uColumnIdx];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetBlockType
+
+      Summary:  Returns the block type of a cell by walking the runs of
+                its column
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  CHAR
+                  Block type of the cell, 0 if it is empty
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    CHAR RunLengthColumns::GetBlockType(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        if (x < 0 || y < 0 || z < 0)
+        {
+            return 0;
+        }
+
+        UINT uNumRuns = 0u;
+        const ColumnRun* pRuns = GetColumnRuns(static_cast<UINT>(x), static_cast<UINT>(z), uNumRuns);
+        UINT uTop = 0u;
+        for (UINT uRunIdx = 0u; uRunIdx < uNumRuns; ++uRunIdx)
+        {
+            uTop += pRuns[uRunIdx].uLength;
+            if (static_cast<UINT>(y) < uTop)
+            {
+                return pRuns[uRunIdx].BlockType;
+            }
+        }
+
+        return 0;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::ExpandRegion
+
+      Summary:  Appends one packed instance per solid run of a
+                rectangle of columns, split at
+                VoxelPacker::MAX_RUN_LENGTH, into buckets indexed by
+                block type. Runs are drawn as whole, buried cells
+                included, and runs that do not fit the packed format
+                are skipped
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                std::vector<std::vector<PackedInstanceData>>& aInstanceData
+                  Buckets of packed instances, one per color of the
+                  palette
+
+      Modifies: [aInstanceData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RunLengthColumns::ExpandRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<PackedInstanceData>>& aInstanceData) const
+    {
+        ForEachRun(
+            uBeginX,
+            uEndX,
+            uBeginZ,
+            uEndZ,
+            [&aInstanceData](UINT x, UINT y, UINT z, UINT uLength, CHAR blockType)
+            {
+                size_t uVoxelIdx = static_cast<size_t>(blockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+                if (blockType < static_cast<CHAR>(eBlockType::GRASSLAND) || uVoxelIdx >= aInstanceData.size())
+                {
+                    return;
+                }
+
+                for (UINT uOffset = 0u; uOffset < uLength; uOffset += VoxelPacker::MAX_RUN_LENGTH)
+                {
+                    PackedInstanceData packed;
+                    UINT uPieceLength = std::min<UINT>(uLength - uOffset, VoxelPacker::MAX_RUN_LENGTH);
+                    if (SUCCEEDED(VoxelPacker::PackRun(static_cast<INT>(x), static_cast<INT>(y + uOffset), static_cast<INT>(z), uPieceLength, blockType, packed)))
+                    {
+                        aInstanceData[uVoxelIdx].push_back(packed);
+                    }
+                }
+            }
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::FillOccupancyGrid
+
+      Summary:  Marks the cells of every solid run in an occupancy
+                grid, which then feeds the instance builder and the
+                mesher. Cells above the grid are dropped
+
+      Args:     OccupancyGrid& occupancyGrid
+                  Grid of the same width and depth, left empty
+
+      Modifies: [occupancyGrid].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RunLengthColumns::FillOccupancyGrid(_Inout_ OccupancyGrid& occupancyGrid) const
+    {
+        ForEachRun(
+            0u,
+            std::min<UINT>(m_uWidth, occupancyGrid.GetWidth()),
+            0u,
+            std::min<UINT>(m_uDepth, occupancyGrid.GetDepth()),
+            [&occupancyGrid](UINT x, UINT y, UINT z, UINT uLength, CHAR)
+            {
+                UINT uEnd = std::min<UINT>(y + uLength, occupancyGrid.GetHeight());
+                for (UINT uCell = y; uCell < uEnd; ++uCell)
+                {
+                    occupancyGrid.SetOccupied(x, uCell, z, TRUE);
+                }
+            }
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetWidth
+
+      Summary:  Returns the number of columns along x
+
+      Returns:  UINT
+                  Width of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT RunLengthColumns::GetWidth() const
+    {
+        return m_uWidth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetHeight
+
+      Summary:  Returns the number of cells of a column
+
+      Returns:  UINT
+                  Height of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT RunLengthColumns::GetHeight() const
+    {
+        return m_uHeight;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetDepth
+
+      Summary:  Returns the number of columns along z
+
+      Returns:  UINT
+                  Depth of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT RunLengthColumns::GetDepth() const
+    {
+        return m_uDepth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetPalette
+
+      Summary:  Returns the colors of the block types
+
+      Returns:  const std::vector<XMFLOAT4>&
+                  Palette, indexed by block type - GRASSLAND
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<XMFLOAT4>& RunLengthColumns::GetPalette() const
+    {
+        return m_aPalette;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetNumRuns
+
+      Summary:  Returns the number of stored runs, empty runs included
+
+      Returns:  UINT64
+                  Number of runs
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 RunLengthColumns::GetNumRuns() const
+    {
+        return m_aRuns.size();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetNumSolidVoxels
+
+      Summary:  Returns the number of solid cells
+
+      Returns:  UINT64
+                  Number of solid cells
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 RunLengthColumns::GetNumSolidVoxels() const
+    {
+        return m_ullNumSolidVoxels;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::GetMemoryUsage
+
+      Summary:  Returns the size of the run offsets and the runs
+
+      Returns:  size_t
+                  Size of the columns in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t RunLengthColumns::GetMemoryUsage() const
+    {
+        return m_aOffsets.size() * sizeof(UINT) + m_aRuns.size() * sizeof(ColumnRun);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::reset
+
+      Summary:  Empties every column of a map of the given size
+
+      Args:     UINT uWidth
+                  Number of columns along x
+                UINT uHeight
+                  Number of cells of a column
+                UINT uDepth
+                  Number of columns along z
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette, m_aOffsets,
+                 m_aRuns, m_ullNumSolidVoxels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RunLengthColumns::reset(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth)
+    {
+        m_uWidth = uWidth;
+        m_uHeight = uHeight;
+        m_uDepth = uDepth;
+        m_aPalette.clear();
+        m_aOffsets.assign(static_cast<size_t>(uWidth) * uDepth + 1u, 0u);
+        m_aRuns.clear();
+        m_ullNumSolidVoxels = 0ull;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::appendRun
+
+      Summary:  Appends a run to the column being built, split into
+                runs of at most MAX_RUN_LENGTH cells
+
+      Args:     CHAR blockType
+                  Block type of the run, 0 for empty cells
+                UINT uLength
+                  Number of cells of the run
+
+      Modifies: [m_aRuns, m_ullNumSolidVoxels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RunLengthColumns::appendRun(_In_ CHAR blockType, _In_ UINT uLength)
+    {
+        if (blockType != 0)
+        {
+            m_ullNumSolidVoxels += uLength;
+        }
+
+        while (uLength > 0u)
+        {
+            UINT uPieceLength = std::min<UINT>(uLength, MAX_RUN_LENGTH);
+            m_aRuns.push_back(ColumnRun{ .BlockType = blockType, .Reserved = 0u, .uLength = static_cast<WORD>(uPieceLength) });
+            uLength -= uPieceLength;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+/*+===================================================================
+  File:      RUNLENGTHCOLUMNS.H
+
+  Summary:   RunLengthColumns header file contains declarations of
+             RunLengthColumns class that stores every voxel column as
+             runs of one block type, in memory and on disk.
+
+  Classes: RunLengthColumns
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <fstream>
+
+#include "Renderer/DataTypes.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/VoxelBrickMap.h"
+#include "Scene/VoxelPacker.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   ColumnRun
+
+        Summary:  Vertical run of cells of one block type, a block type
+                  of 0 standing for empty cells
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ColumnRun
+    {
+        CHAR BlockType;
+        BYTE Reserved;
+        WORD uLength;
+    };
+    static_assert(sizeof(ColumnRun) == 4u);
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   RunLengthColumnsFileHeader
+
+        Summary:  Header of the run-length column file. The palette
+                  (uNumColors XMFLOAT3), the run offsets (uWidth *
+                  uDepth + 1 UINT, row by row along z) and the runs
+                  (ullNumRuns ColumnRun) follow at the given offsets
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct RunLengthColumnsFileHeader
+    {
+        DWORD uMagic;
+        DWORD uVersion;
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+        UINT uNumColors;
+        UINT64 ullNumRuns;
+        UINT64 ullPaletteOffset;
+        UINT64 ullOffsetsOffset;
+        UINT64 ullRunsOffset;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    RunLengthColumns
+
+      Summary:  Voxel columns stored bottom-up as runs of one block
+                type, the runs of all columns packed in one array and
+                indexed by column, so any column is reached with one
+                offset lookup. Empty cells above the last solid run are
+                not stored. A height map column is a single run, and a
+                column with caves or several layers costs one run per
+                change of block type
+
+      Methods:  BuildFromHeightMap
+                  Makes one run per column of a height map
+                BuildFromBrickMap
+                  Encodes the columns of a brick map
+                LoadFromFile
+                  Reads the columns from the binary format
+                SaveToFile
+                  Writes the columns in the binary format
+                GetColumnRuns
+                  Returns the runs of a column
+                GetBlockType
+                  Returns the block type of a cell
+                ForEachRun
+                  Visits the solid runs of a rectangle of columns
+                ExpandRegion
+                  Expands the runs of a rectangle of columns into
+                  packed instances
+                FillOccupancyGrid
+                  Expands the runs into an occupancy grid
+                GetWidth
+                  Returns the number of columns along x
+                GetHeight
+                  Returns the number of cells of a column
+                GetDepth
+                  Returns the number of columns along z
+                GetPalette
+                  Returns the colors of the block types
+                GetNumRuns
+                  Returns the number of stored runs
+                GetNumSolidVoxels
+                  Returns the number of solid cells
+                GetMemoryUsage
+                  Returns the size of the columns in bytes
+                RunLengthColumns
+                  Constructor.
+                ~RunLengthColumns
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class RunLengthColumns
+    {
+    public:
+        static constexpr const DWORD FILE_MAGIC = 0x43454C52u; // "RLEC"
+        static constexpr const DWORD FILE_VERSION = 1u;
+        static constexpr const UINT MAX_RUN_LENGTH = USHRT_MAX;
+
+        RunLengthColumns();
+        RunLengthColumns(const RunLengthColumns& other) = delete;
+        RunLengthColumns(RunLengthColumns&& other) = delete;
+        RunLengthColumns& operator=(const RunLengthColumns& other) = delete;
+        RunLengthColumns& operator=(RunLengthColumns&& other) = delete;
+        ~RunLengthColumns() = default;
+
+        void BuildFromHeightMap(_In_ const HeightMap& heightMap);
+        void BuildFromBrickMap(_In_ const VoxelBrickMap& brickMap, _In_ const std::vector<XMFLOAT4>& aPalette);
+        HRESULT LoadFromFile(_In_ const std::filesystem::path& filePath);
+        HRESULT SaveToFile(_In_ const std::filesystem::path& filePath) const;
+
+        const ColumnRun* GetColumnRuns(_In_ UINT x, _In_ UINT z, _Out_ UINT& uNumRuns) const;
+        CHAR GetBlockType(_In_ INT x, _In_ INT y, _In_ INT z) const;
+
+        template <class Visitor>
+        void ForEachRun(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _In_ Visitor visitor) const;
+
+        void ExpandRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<PackedInstanceData>>& aInstanceData) const;
+        void FillOccupancyGrid(_Inout_ OccupancyGrid& occupancyGrid) const;
+
+        UINT GetWidth() const;
+        UINT GetHeight() const;
+        UINT GetDepth() const;
+        const std::vector<XMFLOAT4>& GetPalette() const;
+        UINT64 GetNumRuns() const;
+        UINT64 GetNumSolidVoxels() const;
+        size_t GetMemoryUsage() const;
+
+    private:
+        void reset(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth);
+        void appendRun(_In_ CHAR blockType, _In_ UINT uLength);
+
+    private:
+        UINT m_uWidth;
+        UINT m_uHeight;
+        UINT m_uDepth;
+        std::vector<XMFLOAT4> m_aPalette;
+        std::vector<UINT> m_aOffsets;
+        std::vector<ColumnRun> m_aRuns;
+        UINT64 m_ullNumSolidVoxels;
+    };
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RunLengthColumns::ForEachRun
+
+      Summary:  Calls the visitor with the lowest cell, the length and
+                the block type of every solid run of a rectangle of
+                columns, row by row along z and bottom-up in a column
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                Visitor visitor
+                  Callable taking (UINT, UINT, UINT, UINT, CHAR)
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class Visitor>
+    void RunLengthColumns::ForEachRun(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _In_ Visitor visitor) const
+    {
+        uEndX = std::min<UINT>(uEndX, m_uWidth);
+        uEndZ = std::min<UINT>(uEndZ, m_uDepth);
+
+        for (UINT z = uBeginZ; z < uEndZ; ++z)
+        {
+            for (UINT x = uBeginX; x < uEndX; ++x)
+            {
+                size_t uColumnIdx = static_cast<size_t>(z) * m_uWidth + x;
+                UINT y = 0u;
+                for (UINT uRunIdx = m_aOffsets[uColumnIdx]; uRunIdx < m_aOffsets[uColumnIdx + 1u]; ++uRunIdx)
+                {
+                    const ColumnRun& run = m_aRuns[uRunIdx];
+                    if (run.BlockType != 0)
+                    {
+                        visitor(x, y, z, static_cast<UINT>(run.uLength), run.BlockType);
+                    }
+                    y += run.uLength;
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
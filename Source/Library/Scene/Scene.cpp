@@ -1,7 +1,15 @@
 #include "Scene/Scene.h"
 
+#include "Scene/SceneLoadHandle.h"
+#include "Scene/SceneSnapshot.h"
 #include "Shader/SkyMapVertexShader.h"
 
+#include <immintrin.h>
+#include <intrin.h>
+#include <psapi.h>
+
+#pragma comment(lib, "psapi.lib")
+
 namespace library
 {
     FLOAT Scene::GetPerlin2d(FLOAT x, FLOAT y, FLOAT frequency, UINT uDepth)
@@ -24,143 +32,336 @@ namespace library
         return fin / div;
     }
 
-    Scene::Scene(const std::filesystem::path& filePath)
-        : m_filePath(filePath)
-        , m_voxels()
-        , m_renderables()
-        , m_aPointLights{ nullptr }
-        , m_vertexShaders()
-        , m_pixelShaders()
-        , m_skyBox()
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetPerlin2dBatch
+
+      Summary:  Evaluates GetPerlin2d at many points, 8 at a time with
+                AVX2 or 4 at a time with SSE2, the remaining points one
+                at a time. Every kernel performs the same float
+                operations in the same order as GetPerlin2d, so the
+                results are identical bit for bit. Coordinates times
+                the frequency must lie in [0, 2^31)
+
+      Args:     const FLOAT* pX
+                  Coordinates along x
+                const FLOAT* pY
+                  Coordinates along y
+                FLOAT frequency
+                  Frequency of the first octave
+                UINT uDepth
+                  Number of octaves
+                UINT uCount
+                  Number of points
+                FLOAT* pResults
+                  Receives the noise at each point
+                eNoiseKernel kernel
+                  Implementation to use, lowered to the best one the
+                  processor supports
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::GetPerlin2dBatch(_In_reads_(uCount) const FLOAT* pX, _In_reads_(uCount) const FLOAT* pY, _In_ FLOAT frequency, _In_ UINT uDepth, _In_ UINT uCount, _Out_writes_(uCount) FLOAT* pResults, _In_ eNoiseKernel kernel)
     {
-        std::ifstream inputFile;
-        inputFile.open(m_filePath.string());
+        kernel = std::min<eNoiseKernel>(kernel, GetBestNoiseKernel());
 
-        std::string trash;
-        UINT aDimension[4] = { 0u, };
-        UINT uDimensionIdx = 0u;
-        while (!inputFile.eof() && uDimensionIdx < ARRAYSIZE(aDimension))
+        UINT i = 0u;
+        if (kernel == eNoiseKernel::AVX2)
         {
-            inputFile >> aDimension[uDimensionIdx];
-
-            if (inputFile.fail())
+            for (; i + 8u <= uCount; i += 8u)
             {
-                if (inputFile.eof())
-                {
-                    break;
-                }
-                inputFile.clear();
-                inputFile >> trash;
+                getPerlin2dAvx2(pX + i, pY + i, frequency, uDepth, pResults + i);
             }
-            else
+        }
+        if (kernel >= eNoiseKernel::SSE2)
+        {
+            for (; i + 4u <= uCount; i += 4u)
             {
-                ++uDimensionIdx;
+                getPerlin2dSse2(pX + i, pY + i, frequency, uDepth, pResults + i);
             }
         }
-
-        UINT uColorIdx = 0u;
-        XMFLOAT4 color;
-        while (!inputFile.eof() && uColorIdx < aDimension[3])
+        for (; i < uCount; ++i)
         {
-            inputFile >> color.x >> color.y >> color.z;
+            pResults[i] = GetPerlin2d(pX[i], pY[i], frequency, uDepth);
+        }
+    }
 
-            if (inputFile.fail())
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetBestNoiseKernel
+
+      Summary:  Returns the fastest batch noise kernel the processor
+                and the operating system support. SSE2 is part of x64
+
+      Returns:  eNoiseKernel
+                  AVX2 when available, SSE2 otherwise
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eNoiseKernel Scene::GetBestNoiseKernel()
+    {
+        static const eNoiseKernel s_bestKernel = []()
+        {
+            INT aCpuInfo[4] = { 0, };
+            __cpuid(aCpuInfo, 0);
+            if (aCpuInfo[0] < 7)
             {
-                if (inputFile.eof())
-                {
-                    break;
-                }
-                inputFile.clear();
-                inputFile >> trash;
+                return eNoiseKernel::SSE2;
             }
-            else
+
+            // AVX2 also needs the OS to save the upper halves of the YMM
+            // registers
+            __cpuid(aCpuInfo, 1);
+            BOOL bOsxsave = (aCpuInfo[2] & (1 << 27)) != 0;
+            BOOL bAvx = (aCpuInfo[2] & (1 << 28)) != 0;
+            if (!bOsxsave || !bAvx || (_xgetbv(0) & 0x6ull) != 0x6ull)
             {
-                color.w = 1.0f;
-                m_voxels.push_back(std::make_shared<Voxel>(color));
-                ++uColorIdx;
+                return eNoiseKernel::SSE2;
             }
+
+            __cpuidex(aCpuInfo, 7, 0);
+            return (aCpuInfo[1] & (1 << 5)) != 0 ? eNoiseKernel::AVX2 : eNoiseKernel::SSE2;
+        }();
+
+        return s_bestKernel;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::BenchmarkPerlin2dBatch
+
+      Summary:  Measures the throughput of the noise one point at a
+                time and with every batch kernel the processor
+                supports, and checks that the kernels agree with the
+                scalar noise
+
+      Args:     UINT uNumSamples
+                  Number of points to evaluate per kernel
+                UINT uDepth
+                  Number of octaves
+
+      Returns:  NoiseBenchmarkStats
+                  Throughput of each kernel
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    NoiseBenchmarkStats Scene::BenchmarkPerlin2dBatch(_In_ UINT uNumSamples, _In_ UINT uDepth)
+    {
+        NoiseBenchmarkStats stats =
+        {
+            .uNumSamples = uNumSamples,
+            .uDepth = uDepth,
+            .ScalarMegaSamplesPerSecond = 0.0f,
+            .Sse2MegaSamplesPerSecond = 0.0f,
+            .Avx2MegaSamplesPerSecond = 0.0f,
+            .BestKernel = GetBestNoiseKernel(),
+            .bIdentical = TRUE
+        };
+
+        // Points spread over a 1024 wide grid with fractional steps, so
+        // every lattice cell and interpolation weight gets exercised
+        std::vector<FLOAT> aX(uNumSamples);
+        std::vector<FLOAT> aY(uNumSamples);
+        for (UINT i = 0u; i < uNumSamples; ++i)
+        {
+            aX[i] = static_cast<FLOAT>(i % 1024u) * 0.37f;
+            aY[i] = static_cast<FLOAT>(i / 1024u) * 0.53f;
         }
 
-        std::vector<std::vector<InstanceData>> aInstanceData;
-        aInstanceData.reserve(m_voxels.size());
-        for (UINT renderableIdx = 0u; renderableIdx < m_voxels.size(); ++renderableIdx)
+        BenchmarkTimer timer;
+        std::vector<FLOAT> aScalarResults(uNumSamples);
+        timer.Start();
+        for (UINT i = 0u; i < uNumSamples; ++i)
         {
-            aInstanceData.push_back(std::vector<InstanceData>());
-            aInstanceData.back().reserve(
-                static_cast<size_t>(aDimension[0]) * static_cast<size_t>(aDimension[1]) * static_cast<size_t>(aDimension[2])
-            );
+            aScalarResults[i] = GetPerlin2d(aX[i], aY[i], 0.1f, uDepth);
         }
+        stats.ScalarMegaSamplesPerSecond = timer.GetMegaPerSecond(uNumSamples);
 
-        UINT uDepthIdx = 0u;
-        UINT uWidthIdx = 0u;
-        CHAR voxelType;
-        FLOAT height;
-        while (!inputFile.eof())
+        std::vector<FLOAT> aBatchResults(uNumSamples);
+        for (eNoiseKernel kernel : { eNoiseKernel::SSE2, eNoiseKernel::AVX2 })
         {
-            inputFile >> voxelType >> height;
+            if (kernel > stats.BestKernel)
+            {
+                continue;
+            }
 
-            if (inputFile.fail())
+            timer.Start();
+            GetPerlin2dBatch(aX.data(), aY.data(), 0.1f, uDepth, uNumSamples, aBatchResults.data(), kernel);
+            FLOAT megaSamplesPerSecond = timer.GetMegaPerSecond(uNumSamples);
+            if (kernel == eNoiseKernel::AVX2)
             {
-                if (inputFile.eof())
-                {
-                    break;
-                }
-                inputFile.clear();
-                inputFile >> trash;
+                stats.Avx2MegaSamplesPerSecond = megaSamplesPerSecond;
             }
-            else if (static_cast<CHAR>(eBlockType::GRASSLAND) <= voxelType && voxelType < static_cast<CHAR>(eBlockType::COUNT))
+            else
             {
-                for (UINT heightIdx = 0; heightIdx < static_cast<UINT>(static_cast<float>(aDimension[1]) * height); ++heightIdx)
-                {
-                    aInstanceData[static_cast<size_t>(voxelType) - static_cast<size_t>(eBlockType::GRASSLAND)].push_back(
-                        InstanceData
-                        {
-                            .Transformation = XMMatrixTranslation(
-                                2.0f * (static_cast<FLOAT>(uWidthIdx) - static_cast<FLOAT>(aDimension[0]) / 2.0f),
-                                2.0f * (static_cast<FLOAT>(heightIdx) - static_cast<FLOAT>(aDimension[1])) + (static_cast<FLOAT>(aDimension[1]) * 0.75f),
-                                2.0f * (static_cast<FLOAT>(uDepthIdx) - static_cast<FLOAT>(aDimension[2]) / 2.0f)
-                                )
-                        }
-                    );
-                }
-                ++uWidthIdx;
-                if (uWidthIdx >= aDimension[0])
-                {
-                    uWidthIdx -= aDimension[0];
-                    ++uDepthIdx;
+                stats.Sse2MegaSamplesPerSecond = megaSamplesPerSecond;
+            }
 
-                    if (uDepthIdx >= aDimension[2])
-                    {
-                        uDepthIdx -= aDimension[2];
-                    }
-                }
+            if (memcmp(aBatchResults.data(), aScalarResults.data(), aScalarResults.size() * sizeof(FLOAT)) != 0)
+            {
+                stats.bIdentical = FALSE;
             }
         }
 
-        inputFile.close();
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"Scene: Perlin noise of depth %u over %u points, scalar %.2f M/s, SSE2 %.2f M/s, AVX2 %.2f M/s, %s\n",
+            stats.uDepth,
+            stats.uNumSamples,
+            stats.ScalarMegaSamplesPerSecond,
+            stats.Sse2MegaSamplesPerSecond,
+            stats.Avx2MegaSamplesPerSecond,
+            stats.bIdentical ? L"identical" : L"MISMATCH"
+        );
+        OutputDebugString(szReport);
+
+        return stats;
+    }
+
+    Scene::Scene(const std::filesystem::path& filePath, _In_opt_ const VoxelStreamingDesc* pStreamingDesc, _In_opt_ SceneLoadHandle* pLoadHandle)
+        : Scene(filePath, nullptr, nullptr, pStreamingDesc, pLoadHandle)
+    {
+    }
 
-        UINT uVoxelIdx = 0u;
-        auto it = m_voxels.begin();
-        while (it != m_voxels.end())
+    Scene::Scene(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_opt_ const VoxelStreamingDesc* pStreamingDesc, _In_opt_ SceneLoadHandle* pLoadHandle)
+        : Scene(std::filesystem::path(), heightMap, nullptr, pStreamingDesc, pLoadHandle)
+    {
+    }
+
+    Scene::Scene(_In_ const std::shared_ptr<SceneSnapshot>& snapshot, _In_opt_ SceneLoadHandle* pLoadHandle)
+        : Scene(std::filesystem::path(), nullptr, snapshot, nullptr, pLoadHandle)
+    {
+    }
+
+    Scene::Scene(_In_ const std::filesystem::path& filePath, _In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<SceneSnapshot>& snapshot, _In_opt_ const VoxelStreamingDesc* pStreamingDesc, _In_opt_ SceneLoadHandle* pLoadHandle)
+        : m_filePath(filePath)
+        , m_heightMap(heightMap ? heightMap : std::make_shared<HeightMap>())
+        , m_loadStats()
+        , m_hrLoadStatus(S_OK)
+        , m_occupancyGrid()
+        , m_heightPyramid()
+        , m_voxelStats()
+        , m_voxels()
+        , m_voxelChunkMeshes()
+        , m_mesherStats()
+        , m_voxelStreamer()
+        , m_voxelEditor()
+        , m_voxelBrickMap()
+        , m_brickMapStats()
+        , m_runLengthColumns()
+        , m_runLengthColumnStats()
+        , m_voxelRayCaster()
+        , m_voxelCollider()
+        , m_horizonBaker()
+        , m_horizonDirtyColumns(INT_MAX, INT_MAX, INT_MIN, INT_MIN)
+        , m_voxelLightMap()
+        , m_snapshot(snapshot && snapshot->IsLoaded() ? snapshot : nullptr)
+        , m_snapshotFilePath()
+        , m_ullSnapshotInputHash(0ull)
+        , m_voxelVertexShader()
+        , m_voxelPixelShader()
+        , m_renderables()
+        , m_models()
+        , m_bModelsLoaded(FALSE)
+        , m_bSnapshotStale(FALSE)
+        , m_aPointLights{ nullptr }
+        , m_vertexShaders()
+        , m_pixelShaders()
+        , m_skyBox()
+    {
+        BenchmarkTimer timer;
+
+        if (pLoadHandle)
         {
-            if (aInstanceData[uVoxelIdx].size() <= 0)
+            pLoadHandle->ReportProgress(eSceneLoadStage::PARSING, 0.0f);
+        }
+        // A height map built in memory is used as is, a snapshot holds
+        // its own copy
+        if (m_snapshot)
+        {
+            m_hrLoadStatus = m_snapshot->RestoreHeightMap(*m_heightMap);
+            if (FAILED(m_hrLoadStatus))
             {
-                it = m_voxels.erase(it);
+                OutputDebugString(L"Scene: failed to restore the height map\n");
             }
-            else
+        }
+        else if (!heightMap)
+        {
+            m_hrLoadStatus = m_heightMap->LoadFromFile(m_filePath);
+            if (FAILED(m_hrLoadStatus))
             {
-                (*it)->SetInstanceData(std::move(aInstanceData[uVoxelIdx]));
-                ++it;
+                OutputDebugString(L"Scene: failed to load the height map\n");
             }
-            ++uVoxelIdx;
         }
+        FLOAT parseMilliseconds = timer.GetMilliseconds();
+        timer.Start();
+
+        // A canceled load stops between stages and leaves the scene
+        // without voxels, the handle discards it anyway
+        if (pLoadHandle && pLoadHandle->IsCancelRequested())
+        {
+            return;
+        }
+
+        // A streamed world builds its instances chunk by chunk around the
+        // camera instead of all at once
+        if (pLoadHandle)
+        {
+            pLoadHandle->ReportProgress(eSceneLoadStage::BUILDING, 0.3f);
+        }
+        buildOccupancyGrid();
+        if (pLoadHandle)
+        {
+            if (pLoadHandle->IsCancelRequested())
+            {
+                return;
+            }
+            pLoadHandle->ReportProgress(eSceneLoadStage::BUILDING, 0.4f);
+        }
+        if (pStreamingDesc)
+        {
+            m_voxelStreamer = std::make_unique<VoxelStreamer>(m_heightMap, m_occupancyGrid, *pStreamingDesc);
+        }
+        else if (!m_snapshot || FAILED(m_snapshot->RestoreVoxels(m_voxels, m_voxelStats)))
+        {
+            buildVoxels();
+        }
+        FLOAT buildMilliseconds = timer.GetMilliseconds();
+
+        PROCESS_MEMORY_COUNTERS memoryCounters = {};
+        memoryCounters.cb = sizeof(memoryCounters);
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+        {
+            m_loadStats.uPeakWorkingSetBytes = memoryCounters.PeakWorkingSetSize;
+        }
+        m_loadStats.ParseMilliseconds = parseMilliseconds;
+        m_loadStats.BuildMilliseconds = buildMilliseconds;
+        m_loadStats.ParseMegabytesPerSecond = m_loadStats.ParseMilliseconds > 0.0f
+            ? static_cast<FLOAT>(static_cast<double>(m_heightMap->GetFileSize()) / (1024.0 * 1024.0) / (static_cast<double>(m_loadStats.ParseMilliseconds) / 1000.0))
+            : 0.0f;
+        m_loadStats.bMapped = m_heightMap->IsMapped();
+
+        WCHAR szReport[512];
+        swprintf_s(
+            szReport,
+            L"Scene: %s loaded in %.2f ms (%s, %.1f MB/s), voxels built in %.2f ms, %llu of %llu voxels instanced (%.2f MB of instances instead of %.2f MB, an estimated %.2f MB at peak while building), peak working set %.2f MB\n",
+            m_snapshot ? L"snapshot" : m_filePath.empty() ? L"terrain" : m_filePath.filename().c_str(),
+            m_loadStats.ParseMilliseconds,
+            m_loadStats.bMapped ? L"mapped" : L"parsed",
+            m_loadStats.ParseMegabytesPerSecond,
+            m_loadStats.BuildMilliseconds,
+            m_voxelStats.ullNumInstances,
+            m_voxelStats.ullNumSolidVoxels,
+            static_cast<double>(m_voxelStats.ullInstanceBytes) / (1024.0 * 1024.0),
+            static_cast<double>(m_voxelStats.ullSolidInstanceBytes) / (1024.0 * 1024.0),
+            static_cast<double>(m_voxelStats.ullEstimatedPeakBuildBytes) / (1024.0 * 1024.0),
+            static_cast<double>(m_loadStats.uPeakWorkingSetBytes) / (1024.0 * 1024.0)
+        );
+        OutputDebugString(szReport);
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Scene::Initialize
 
       Summary:  Initializes the voxels, shaders, renderables, models,
-                and skybox
+                and skybox, loading the models first unless LoadModels
+                was called beforehand. Once everything is initialized,
+                the snapshot is written if a cache was set and the
+                scene was not restored from it
+
+      Modifies: [m_models, m_skyBox, m_snapshot].
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
@@ -205,6 +406,13 @@ namespace library
             }
         }
 
+        HRESULT hrModels = LoadModels();
+        if (FAILED(hrModels))
+        {
+            return hrModels;
+        }
+
+        BOOL bSaveSnapshot = !m_snapshot || m_bSnapshotStale;
         for (auto it = m_models.begin(); it != m_models.end(); ++it)
         {
             HRESULT hr = it->second->Initialize(pDevice, pImmediateContext);
@@ -235,9 +443,41 @@ namespace library
                 return hr;
             }
         }
+
+        // A snapshot that cannot be written only costs the next launch
+        // a full build
+        if (bSaveSnapshot && !m_snapshotFilePath.empty() && !m_voxelStreamer)
+        {
+            SceneSnapshot snapshot;
+            if (FAILED(snapshot.Save(m_snapshotFilePath, m_ullSnapshotInputHash, *m_heightMap, m_voxels, m_models)))
+            {
+                OutputDebugString(L"Scene: failed to save the snapshot\n");
+            }
+        }
+        m_snapshot.reset();
+
         return S_OK;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SetSnapshotCache
+
+      Summary:  Sets the file Initialize writes the built scene to, and
+                the hash of the inputs the scene was built from
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the snapshot file
+                UINT64 ullInputHash
+                  Hash of the inputs of the scene
+
+      Modifies: [m_snapshotFilePath, m_ullSnapshotInputHash].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::SetSnapshotCache(_In_ const std::filesystem::path& filePath, _In_ UINT64 ullInputHash)
+    {
+        m_snapshotFilePath = filePath;
+        m_ullSnapshotInputHash = ullInputHash;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Scene::AddVoxel
 
@@ -431,132 +671,1303 @@ namespace library
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::Update
+      Method:   Scene::BuildVoxelChunkMeshes
 
-      Summary:  Update the renderables, models, point lights, skybox
-                each frame
+      Summary:  Replaces the instanced voxels with greedy meshes built
+                per chunk and block type. The meshes are added as
+                renderables, so this must be called before Initialize
 
-      Args:     FLOAT deltaTime
-                  Time difference of a frame
+      Args:     UINT uChunkSize
+                  Number of columns along a chunk side
+
+      Modifies: [m_voxels, m_voxelChunkMeshes, m_renderables,
+                 m_mesherStats].
+
+      Returns:  HRESULT
+                  Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Scene::Update(_In_ FLOAT deltaTime)
+    HRESULT Scene::BuildVoxelChunkMeshes(_In_ UINT uChunkSize)
     {
-    }
+        if (!m_occupancyGrid || m_voxelStreamer || uChunkSize == 0u)
+        {
+            return E_INVALIDARG;
+        }
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetVoxels
+        const std::vector<XMFLOAT4>& aPalette = m_heightMap->GetPalette();
+        VoxelMesher mesher(m_heightMap, m_occupancyGrid, uChunkSize);
 
-      Summary:  Returns the vector of voxels
+        std::vector<VoxelMeshData> aMeshes;
+        for (UINT uChunkZ = 0u; uChunkZ < mesher.GetNumChunksZ(); ++uChunkZ)
+        {
+            for (UINT uChunkX = 0u; uChunkX < mesher.GetNumChunksX(); ++uChunkX)
+            {
+                mesher.MeshChunk(uChunkX, uChunkZ, aMeshes);
 
-      Returns:  std::vector<std::shared_ptr<Voxel>>&
-                  Voxels
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    std::vector<std::shared_ptr<Voxel>>& Scene::GetVoxels()
-    {
-        return m_voxels;
-    }
+                for (size_t uColorIdx = 0u; uColorIdx < aMeshes.size(); ++uColorIdx)
+                {
+                    if (aMeshes[uColorIdx].aIndices.empty())
+                    {
+                        continue;
+                    }
 
+                    std::shared_ptr<VoxelChunkMesh> chunkMesh = std::make_shared<VoxelChunkMesh>(std::move(aMeshes[uColorIdx]), aPalette[uColorIdx]);
+                    std::wstring szName = L"VoxelChunk_" + std::to_wstring(uChunkX) + L"_" + std::to_wstring(uChunkZ) + L"_" + std::to_wstring(uColorIdx);
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetRenderables
+                    HRESULT hr = AddRenderable(szName.c_str(), chunkMesh);
+                    if (FAILED(hr))
+                    {
+                        return hr;
+                    }
+                    m_voxelChunkMeshes.push_back(chunkMesh);
+                }
+            }
+        }
 
-      Summary:  Returns the vector of renderables
+        m_voxels.clear();
+        m_mesherStats = mesher.GetStats();
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"Scene: %u chunks meshed into %llu triangles (%llu with instanced cubes) in %.2f ms, %.3f ms per chunk, %.3f ms at most\n",
+            m_mesherStats.uNumChunks,
+            m_mesherStats.ullNumTriangles,
+            m_voxelStats.ullNumInstances * 12ull,
+            m_mesherStats.TotalMilliseconds,
+            m_mesherStats.uNumChunks > 0u ? m_mesherStats.TotalMilliseconds / static_cast<FLOAT>(m_mesherStats.uNumChunks) : 0.0f,
+            m_mesherStats.MaxChunkMilliseconds
+        );
+        OutputDebugString(szReport);
 
-      Returns:  std::unordered_map<std::wstring, std::shared_ptr<Renderable>>&
-                  Renderables
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    std::unordered_map<std::wstring, std::shared_ptr<Renderable>>& Scene::GetRenderables()
-    {
-        return m_renderables;
+        return S_OK;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetModels
+      Method:   Scene::BuildPackedVoxels
 
-      Summary:  Returns the vector of models
+      Summary:  Replaces the instanced voxels with voxels whose
+                instances are packed into 8 bytes instead of a 64-byte
+                matrix. This must be called before Initialize, and the
+                voxels must then be drawn with VSVoxelPacked
 
-      Returns:  std::unordered_map<std::wstring, std::shared_ptr<Model>>&
-                  Models
+      Args:     BOOL bCollapseRuns
+                  Whether each vertical run of exposed voxels is packed
+                  as a single instance
+
+      Modifies: [m_voxels, m_voxelEditor, m_voxelStats].
+
+      Returns:  HRESULT
+                  Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    std::unordered_map<std::wstring, std::shared_ptr<Model>>& Scene::GetModels()
+    HRESULT Scene::BuildPackedVoxels(_In_ BOOL bCollapseRuns)
     {
-        return m_models;
-    }
+        if (!m_occupancyGrid || m_voxelStreamer)
+        {
+            return E_INVALIDARG;
+        }
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetPointLight
+        if (!VoxelPacker::IsInRange(
+            static_cast<INT>(m_occupancyGrid->GetWidth()) - 1,
+            static_cast<INT>(m_occupancyGrid->GetHeight()) - 1,
+            static_cast<INT>(m_occupancyGrid->GetDepth()) - 1))
+        {
+            return E_FAIL;
+        }
 
-      Summary:  Returns a point light according to the given index
+        const std::vector<XMFLOAT4>& aPalette = m_heightMap->GetPalette();
+        std::vector<std::vector<PackedInstanceData>> aInstanceData(aPalette.size());
+        m_voxels.clear();
+        m_voxelEditor.reset();
+        m_voxelStats.InstanceBuildMilliseconds = buildInstanceData(bCollapseRuns, aInstanceData, &m_voxelStats.ullEstimatedPeakBuildBytes);
+        m_voxelStats.bCollapsedRuns = bCollapseRuns;
+        m_voxelStats.bPackedInstances = TRUE;
 
-      Args:     size_t index
-                  Index of the point light
+        m_voxelStats.ullNumInstances = 0ull;
+        for (size_t uVoxelIdx = 0u; uVoxelIdx < aInstanceData.size(); ++uVoxelIdx)
+        {
+            if (aInstanceData[uVoxelIdx].empty())
+            {
+                continue;
+            }
 
-      Returns:  std::shared_ptr<PointLight>&
-                  Point light
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    std::shared_ptr<PointLight>& Scene::GetPointLight(_In_ size_t index)
-    {
-        assert(index < NUM_LIGHTS);
+            m_voxelStats.ullNumInstances += aInstanceData[uVoxelIdx].size();
+            m_voxels.push_back(std::make_shared<PackedVoxel>(std::move(aInstanceData[uVoxelIdx]), m_heightMap->GetGridTransform(), aPalette[uVoxelIdx]));
+        }
+        m_voxelStats.ullInstanceBytes = m_voxelStats.ullNumInstances * sizeof(PackedInstanceData);
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"Scene: %llu instances packed into %.2f MB (%.2f MB as matrices)\n",
+            m_voxelStats.ullNumInstances,
+            static_cast<double>(m_voxelStats.ullInstanceBytes) / (1024.0 * 1024.0),
+            static_cast<double>(m_voxelStats.ullNumInstances * sizeof(InstanceData)) / (1024.0 * 1024.0)
+        );
+        OutputDebugString(szReport);
 
-        return m_aPointLights[index];
+        return S_OK;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetVertexShaders
+      Method:   Scene::BuildVoxelRuns
 
-      Summary:  Returns a hash map of vertex shaders
+      Summary:  Replaces the instanced voxels with one instance per
+                vertical run of exposed voxels, the cube being stretched
+                along y over the run. VSVoxel repeats the texture of the
+                side faces once per voxel of the run. Reports the
+                instance counts and build times against the voxels it
+                replaces. This must be called before Initialize
 
-      Returns:  std::unordered_map<std::wstring, std::shared_ptr<VertexShader>>&
-                  Vertex shaders
+      Modifies: [m_voxels, m_voxelEditor, m_voxelStats].
+
+      Returns:  HRESULT
+                  Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    std::unordered_map<std::wstring, std::shared_ptr<VertexShader>>& Scene::GetVertexShaders()
+    HRESULT Scene::BuildVoxelRuns()
     {
-        return m_vertexShaders;
-    }
+        if (!m_occupancyGrid || m_voxelStreamer)
+        {
+            return E_INVALIDARG;
+        }
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetPixelShaders
+        UINT64 ullNumVoxelInstances = m_voxelStats.ullNumInstances;
+        FLOAT voxelBuildMilliseconds = m_voxelStats.InstanceBuildMilliseconds;
 
-      Summary:  Returns a hash map of pixel shaders
+        const std::vector<XMFLOAT4>& aPalette = m_heightMap->GetPalette();
+        std::vector<std::vector<InstanceData>> aInstanceData(aPalette.size());
+        m_voxels.clear();
+        m_voxelEditor.reset();
+        m_voxelStats.InstanceBuildMilliseconds = buildInstanceData(TRUE, aInstanceData, &m_voxelStats.ullEstimatedPeakBuildBytes);
+        m_voxelStats.bCollapsedRuns = TRUE;
+        m_voxelStats.bPackedInstances = FALSE;
 
-      Returns:  std::unordered_map<std::wstring, std::shared_ptr<PixelShader>>&
-                  Pixel shaders
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    std::unordered_map<std::wstring, std::shared_ptr<PixelShader>>& Scene::GetPixelShaders()
-    {
-        return m_pixelShaders;
+        m_voxelStats.ullNumInstances = 0ull;
+        for (size_t uVoxelIdx = 0u; uVoxelIdx < aInstanceData.size(); ++uVoxelIdx)
+        {
+            if (aInstanceData[uVoxelIdx].empty())
+            {
+                continue;
+            }
+
+            m_voxelStats.ullNumInstances += aInstanceData[uVoxelIdx].size();
+            m_voxels.push_back(std::make_shared<Voxel>(std::move(aInstanceData[uVoxelIdx]), aPalette[uVoxelIdx]));
+        }
+        m_voxelStats.ullInstanceBytes = m_voxelStats.ullNumInstances * sizeof(InstanceData);
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"Scene: %llu vertical runs instead of %llu voxel instances (%.2fx fewer, %.2f MB), built in %.2f ms instead of %.2f ms\n",
+            m_voxelStats.ullNumInstances,
+            ullNumVoxelInstances,
+            m_voxelStats.ullNumInstances > 0ull ? static_cast<double>(ullNumVoxelInstances) / static_cast<double>(m_voxelStats.ullNumInstances) : 0.0,
+            static_cast<double>(m_voxelStats.ullInstanceBytes) / (1024.0 * 1024.0),
+            m_voxelStats.InstanceBuildMilliseconds,
+            voxelBuildMilliseconds
+        );
+        OutputDebugString(szReport);
+
+        return S_OK;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetSkyBox
+      Method:   Scene::EnableVoxelEditing
 
-      Summary:  Returns a sky box
+      Summary:  Replaces the voxels with those of a VoxelEditor, one
+                per color of the palette, so that blocks can be placed
+                and removed without rebuilding the instances. This must
+                be called before Initialize. The editor keeps one plain
+                instance per exposed voxel, so it does not replace
+                packed instances or vertical runs
 
-      Returns:  std::shared_ptr<Skybox>&
-                  Sky box
+      Modifies: [m_voxels, m_voxelEditor, m_voxelStats].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if the voxels are streamed,
+                  meshed, packed or collapsed into runs
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    std::shared_ptr<Skybox>& Scene::GetSkyBox()
+    HRESULT Scene::EnableVoxelEditing()
     {
-        return m_skyBox;
-    }
+        if (!m_occupancyGrid || m_voxelStreamer || !m_voxelChunkMeshes.empty() || m_voxelStats.bPackedInstances || m_voxelStats.bCollapsedRuns)
+        {
+            return E_INVALIDARG;
+        }
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetFilePath
+        std::vector<std::vector<XMUINT3>> aCells(m_heightMap->GetPalette().size());
+        m_voxels.clear();
+        m_voxelStats.InstanceBuildMilliseconds = buildInstanceData(FALSE, aCells, &m_voxelStats.ullEstimatedPeakBuildBytes);
+        m_voxelStats.bCollapsedRuns = FALSE;
+        m_voxelStats.bPackedInstances = FALSE;
 
-      Summary:  Returns the file path to the height map
+        m_voxelStats.ullNumInstances = 0ull;
+        for (const std::vector<XMUINT3>& aBucket : aCells)
+        {
+            m_voxelStats.ullNumInstances += aBucket.size();
+        }
+        m_voxelStats.ullInstanceBytes = m_voxelStats.ullNumInstances * sizeof(InstanceData);
 
-      Returns:  const std::filesystem::path&
-                  File path to the height map
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    const std::filesystem::path& Scene::GetFilePath() const
-    {
-        return m_filePath;
+        m_voxelEditor = std::make_unique<VoxelEditor>(m_heightMap, m_occupancyGrid, std::move(aCells));
+        m_voxels = m_voxelEditor->GetVoxels();
+
+        return S_OK;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Scene::GetFileName
+      Method:   Scene::PlaceBlock
+
+      Summary:  Places a block into a cell of the grid. The instances
+                change on the CPU at once and reach the GPU with the
+                next FlushVoxelEdits, which also bakes again the
+                horizons around the cell. The light map is relit and
+                the column of the height pyramid refreshed at once
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+                CHAR blockType
+                  Block type of the new block
+
+      Modifies: [m_voxelEditor, m_horizonDirtyColumns, m_voxelLightMap,
+                 m_heightPyramid].
 
-      Summary:  Returns the file name of the height map
+      Returns:  HRESULT
+                  E_FAIL unless voxel editing is enabled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::PlaceBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ CHAR blockType)
+    {
+        if (!m_voxelEditor)
+        {
+            return E_FAIL;
+        }
+
+        HRESULT hr = m_voxelEditor->PlaceBlock(x, y, z, blockType);
+        if (SUCCEEDED(hr))
+        {
+            markHorizonsDirty(x, z);
+            if (m_voxelLightMap)
+            {
+                m_voxelLightMap->OnCellChanged(x, y, z);
+            }
+            if (m_heightPyramid)
+            {
+                m_heightPyramid->UpdateColumn(x, z);
+            }
+        }
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::RemoveBlock
+
+      Summary:  Removes the block of a cell of the grid. The instances
+                change on the CPU at once and reach the GPU with the
+                next FlushVoxelEdits, which also bakes again the
+                horizons around the cell. The light map is relit and
+                the column of the height pyramid refreshed at once
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+
+      Modifies: [m_voxelEditor, m_horizonDirtyColumns, m_voxelLightMap,
+                 m_heightPyramid].
+
+      Returns:  HRESULT
+                  E_FAIL unless voxel editing is enabled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::RemoveBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z)
+    {
+        if (!m_voxelEditor)
+        {
+            return E_FAIL;
+        }
+
+        HRESULT hr = m_voxelEditor->RemoveBlock(x, y, z);
+        if (SUCCEEDED(hr))
+        {
+            markHorizonsDirty(x, z);
+            if (m_voxelLightMap)
+            {
+                m_voxelLightMap->OnCellChanged(x, y, z);
+            }
+            if (m_heightPyramid)
+            {
+                m_heightPyramid->UpdateColumn(x, z);
+            }
+        }
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::BuildVoxelBrickMap
+
+      Summary:  Builds a brick map holding every solid voxel of the
+                height map with its block type and reports its size.
+                When uNumBenchmarkQueries is not 0, its memory and query
+                latency are also benchmarked against flat per-type
+                vectors of the same voxels and reported; the vectors
+                hold every solid voxel of the world, so the benchmark
+                is left out by default. The voxels rendered are left as
+                they are
+
+      Args:     UINT uNumBenchmarkQueries
+                  Number of point queries of the benchmark, 0 to skip
+                  it
+
+      Modifies: [m_voxelBrickMap, m_brickMapStats].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::BuildVoxelBrickMap(_In_ UINT uNumBenchmarkQueries)
+    {
+        if (!m_occupancyGrid)
+        {
+            return E_INVALIDARG;
+        }
+
+        BenchmarkTimer timer;
+        m_voxelBrickMap = std::make_unique<VoxelBrickMap>(m_occupancyGrid->GetWidth(), m_occupancyGrid->GetHeight(), m_occupancyGrid->GetDepth());
+        m_voxelBrickMap->BuildFromHeightMap(*m_heightMap);
+        FLOAT buildMilliseconds = timer.GetMilliseconds();
+
+        m_brickMapStats = VoxelBrickMapStats();
+        m_brickMapStats.ullNumBricks = m_voxelBrickMap->GetNumBricks();
+        m_brickMapStats.ullNumSolidVoxels = m_voxelBrickMap->GetNumSolidVoxels();
+        m_brickMapStats.ullMemoryBytes = m_voxelBrickMap->GetMemoryUsage();
+        m_brickMapStats.BuildMilliseconds = buildMilliseconds;
+        m_brickMapStats.BytesPerSolidVoxel = m_brickMapStats.ullNumSolidVoxels > 0ull
+            ? static_cast<FLOAT>(m_brickMapStats.ullMemoryBytes) / static_cast<FLOAT>(m_brickMapStats.ullNumSolidVoxels)
+            : 0.0f;
+
+        WCHAR szReport[512];
+        swprintf_s(
+            szReport,
+            L"Scene: brick map of %llu bricks holds %llu solid voxels in %.2f MB (%.2f bytes per voxel, built in %.2f ms)\n",
+            m_brickMapStats.ullNumBricks,
+            m_brickMapStats.ullNumSolidVoxels,
+            static_cast<double>(m_brickMapStats.ullMemoryBytes) / (1024.0 * 1024.0),
+            m_brickMapStats.BytesPerSolidVoxel,
+            m_brickMapStats.BuildMilliseconds
+        );
+        OutputDebugString(szReport);
+
+        if (uNumBenchmarkQueries == 0u)
+        {
+            return S_OK;
+        }
+
+        benchmarkVoxelBrickMap(uNumBenchmarkQueries);
+
+        swprintf_s(
+            szReport,
+            L"Scene: flat vectors hold %llu voxels in %.2f MB (%.2f bytes per voxel); "
+            L"point query %.1f ns against %.1f ns, box range %.3f ms against %.3f ms\n",
+            m_brickMapStats.ullNumFlatVoxels,
+            static_cast<double>(m_brickMapStats.ullFlatMemoryBytes) / (1024.0 * 1024.0),
+            m_brickMapStats.FlatBytesPerVoxel,
+            m_brickMapStats.PointQueryNanoseconds,
+            m_brickMapStats.FlatPointQueryNanoseconds,
+            m_brickMapStats.RangeMilliseconds,
+            m_brickMapStats.FlatRangeMilliseconds
+        );
+        OutputDebugString(szReport);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::BuildVoxelRayCaster
+
+      Summary:  Creates the ray caster that picks blocks and answers
+                visibility queries over the occupancy grid. Edits made
+                through the voxel editor are seen at once since both
+                share the grid. When uNumBenchmarkRays is not 0, the
+                traversal is benchmarked against a brute-force test of
+                the exposed cells and reported
+
+      Args:     UINT uNumBenchmarkRays
+                  Number of rays of the benchmark, 0 to skip it
+
+      Modifies: [m_voxelRayCaster].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::BuildVoxelRayCaster(_In_ UINT uNumBenchmarkRays)
+    {
+        if (!m_occupancyGrid)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_voxelRayCaster = std::make_unique<VoxelRayCaster>(m_heightMap, m_occupancyGrid);
+        if (uNumBenchmarkRays > 0u)
+        {
+            m_voxelRayCaster->Benchmark(uNumBenchmarkRays, std::min<UINT>(uNumBenchmarkRays, VoxelRayCaster::BENCHMARK_BRUTE_FORCE_RAYS));
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::BuildHeightPyramid
+
+      Summary:  Creates the min/max height pyramid that answers ray,
+                shadow and occlusion queries over the columns. Blocks
+                placed and removed through the scene refresh the column
+                they are in. When uNumBenchmarkQueries is not 0, the
+                queries are benchmarked against a column-by-column march
+                and reported
+
+      Args:     UINT uNumBenchmarkQueries
+                  Number of queries of each kind of the benchmark, 0 to
+                  skip it
+
+      Modifies: [m_heightPyramid].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::BuildHeightPyramid(_In_ UINT uNumBenchmarkQueries)
+    {
+        if (!m_occupancyGrid)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_heightPyramid = std::make_unique<HeightPyramid>(m_heightMap, m_occupancyGrid);
+        if (uNumBenchmarkQueries > 0u)
+        {
+            m_heightPyramid->Benchmark(uNumBenchmarkQueries, std::min<UINT>(uNumBenchmarkQueries, HeightPyramid::BENCHMARK_BRUTE_FORCE_QUERIES));
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::BuildVoxelCollider
+
+      Summary:  Creates the collider that keeps the camera out of the
+                terrain. It shares the occupancy grid, so edits made
+                through the voxel editor collide at once. When
+                uNumBenchmarkMoves is not 0, the sweep is benchmarked
+                against a brute-force sweep of the exposed cells and
+                reported
+
+      Args:     UINT uNumBenchmarkMoves
+                  Number of moves of the benchmark, 0 to skip it
+
+      Modifies: [m_voxelCollider].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::BuildVoxelCollider(_In_ UINT uNumBenchmarkMoves)
+    {
+        if (!m_occupancyGrid)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_voxelCollider = std::make_shared<VoxelCollider>(m_heightMap, m_occupancyGrid);
+        if (uNumBenchmarkMoves > 0u)
+        {
+            m_voxelCollider->Benchmark(uNumBenchmarkMoves, std::min<UINT>(uNumBenchmarkMoves, VoxelCollider::BENCHMARK_BRUTE_FORCE_MOVES));
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::BuildHorizonLighting
+
+      Summary:  Bakes the horizons of the instances of the voxels, from
+                which VSVoxelHorizon shadows the lights and darkens the
+                ambient light without a shadow map pass. Build the
+                voxels, and enable editing if it is wanted, before.
+                When voxel editing is enabled, the columns around the
+                edits are baked again by FlushVoxelEdits. When
+                uNumBruteForceInstances is not 0, that many instances
+                are checked against a brute-force march
+
+      Args:     UINT uNumBruteForceInstances
+                  Number of instances checked, 0 to skip the check
+
+      Modifies: [m_horizonBaker, m_horizonDirtyColumns].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::BuildHorizonLighting(_In_ UINT uNumBruteForceInstances)
+    {
+        if (!m_occupancyGrid || m_voxels.empty())
+        {
+            return E_INVALIDARG;
+        }
+
+        m_horizonBaker = std::make_unique<HorizonBaker>(m_heightMap, m_occupancyGrid);
+        m_horizonDirtyColumns = XMINT4(INT_MAX, INT_MAX, INT_MIN, INT_MIN);
+
+        return m_horizonBaker->Bake(m_voxels, uNumBruteForceInstances);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::BuildVoxelLighting
+
+      Summary:  Floods block light and sky light through the occupancy
+                grid, so that caves and emissive blocks can be lit per
+                cell instead of looping over the point lights. Blocks
+                placed or removed through the scene relight only the
+                region they affect. The instances of the voxels take
+                the light of their faces, which VSVoxelLight passes to
+                PSVoxel, unless they are packed; FlushVoxelEdits lights
+                again those around the edits. Build the voxels, and
+                enable editing if it is wanted, before. When
+                uNumBenchmarkEdits is not 0, the relighting of that
+                many edits is benchmarked on a copy of the grid against
+                a full build and reported
+
+      Args:     UINT uNumBenchmarkEdits
+                  Number of edits of the benchmark, 0 to skip it
+
+      Modifies: [m_voxelLightMap, m_voxels].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::BuildVoxelLighting(_In_ UINT uNumBenchmarkEdits)
+    {
+        if (!m_occupancyGrid)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_voxelLightMap = std::make_unique<VoxelLightMap>(m_heightMap, m_occupancyGrid);
+        m_voxelLightMap->Build();
+        if (!m_voxels.empty() && !m_voxelStats.bPackedInstances)
+        {
+            HRESULT hr = m_voxelLightMap->LightInstances(m_voxels);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+        if (uNumBenchmarkEdits > 0u)
+        {
+            m_voxelLightMap->Benchmark(uNumBenchmarkEdits);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::BuildRunLengthColumns
+
+      Summary:  Encodes the voxel columns as runs of one block type,
+                from the brick map when there is one so that carved
+                cells are kept, or else from the height map. The
+                columns are written to a file, read back to check the
+                round trip, and expanded to packed instances once to
+                time it. Reports the compression ratios
+
+      Args:     const std::filesystem::path& filePath
+                  Path to write the run-length column file to
+
+      Modifies: [m_runLengthColumns, m_runLengthColumnStats].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::BuildRunLengthColumns(_In_ const std::filesystem::path& filePath)
+    {
+        BenchmarkTimer timer;
+
+        m_runLengthColumns = std::make_unique<RunLengthColumns>();
+        if (m_voxelBrickMap)
+        {
+            m_runLengthColumns->BuildFromBrickMap(*m_voxelBrickMap, m_heightMap->GetPalette());
+        }
+        else
+        {
+            m_runLengthColumns->BuildFromHeightMap(*m_heightMap);
+        }
+        FLOAT buildMilliseconds = timer.GetMilliseconds();
+        timer.Start();
+
+        std::vector<std::vector<PackedInstanceData>> aInstanceData(m_heightMap->GetPalette().size());
+        m_runLengthColumns->ExpandRegion(0u, m_runLengthColumns->GetWidth(), 0u, m_runLengthColumns->GetDepth(), aInstanceData);
+        FLOAT expandMilliseconds = timer.GetMilliseconds();
+
+        HRESULT hr = m_runLengthColumns->SaveToFile(filePath);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        RunLengthColumns loadedColumns;
+        hr = loadedColumns.LoadFromFile(filePath);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        if (loadedColumns.GetNumRuns() != m_runLengthColumns->GetNumRuns() || loadedColumns.GetNumSolidVoxels() != m_runLengthColumns->GetNumSolidVoxels())
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        m_runLengthColumnStats.ullNumRuns = m_runLengthColumns->GetNumRuns();
+        m_runLengthColumnStats.ullNumSolidVoxels = m_runLengthColumns->GetNumSolidVoxels();
+        m_runLengthColumnStats.ullMemoryBytes = m_runLengthColumns->GetMemoryUsage();
+        m_runLengthColumnStats.ullFileBytes = static_cast<UINT64>(std::filesystem::file_size(filePath));
+        m_runLengthColumnStats.ullDenseBytes = static_cast<UINT64>(m_runLengthColumns->GetWidth()) * m_runLengthColumns->GetHeight() * m_runLengthColumns->GetDepth();
+        m_runLengthColumnStats.ullSolidInstanceBytes = m_runLengthColumnStats.ullNumSolidVoxels * sizeof(InstanceData);
+        m_runLengthColumnStats.DenseCompressionRatio = m_runLengthColumnStats.ullMemoryBytes > 0ull
+            ? static_cast<FLOAT>(static_cast<double>(m_runLengthColumnStats.ullDenseBytes) / static_cast<double>(m_runLengthColumnStats.ullMemoryBytes))
+            : 0.0f;
+        m_runLengthColumnStats.InstanceCompressionRatio = m_runLengthColumnStats.ullMemoryBytes > 0ull
+            ? static_cast<FLOAT>(static_cast<double>(m_runLengthColumnStats.ullSolidInstanceBytes) / static_cast<double>(m_runLengthColumnStats.ullMemoryBytes))
+            : 0.0f;
+        m_runLengthColumnStats.BuildMilliseconds = buildMilliseconds;
+        m_runLengthColumnStats.ExpandMilliseconds = expandMilliseconds;
+
+        WCHAR szReport[512];
+        swprintf_s(
+            szReport,
+            L"Scene: %llu solid voxels in %llu runs, %.2f MB in memory and %.2f MB on disk (%.1fx smaller than a dense grid, %.1fx smaller than one instance per voxel), encoded in %.2f ms, expanded in %.2f ms\n",
+            m_runLengthColumnStats.ullNumSolidVoxels,
+            m_runLengthColumnStats.ullNumRuns,
+            static_cast<double>(m_runLengthColumnStats.ullMemoryBytes) / (1024.0 * 1024.0),
+            static_cast<double>(m_runLengthColumnStats.ullFileBytes) / (1024.0 * 1024.0),
+            m_runLengthColumnStats.DenseCompressionRatio,
+            m_runLengthColumnStats.InstanceCompressionRatio,
+            m_runLengthColumnStats.BuildMilliseconds,
+            m_runLengthColumnStats.ExpandMilliseconds
+        );
+        OutputDebugString(szReport);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::CompileShaders
+
+      Summary:  Compiles every vertex and pixel shader of the scene
+                without creating the shader objects, so an asynchronous
+                load can do it off the thread owning the device
+
+      Modifies: [m_vertexShaders, m_pixelShaders].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::CompileShaders()
+    {
+        for (auto it = m_vertexShaders.begin(); it != m_vertexShaders.end(); ++it)
+        {
+            HRESULT hr = it->second->Compile();
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        for (auto it = m_pixelShaders.begin(); it != m_pixelShaders.end(); ++it)
+        {
+            HRESULT hr = it->second->Compile();
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::LoadModels
+
+      Summary:  Imports the models and the skybox and decodes their
+                textures without the device, so an asynchronous load
+                can do it off the thread owning the device. Models
+                found in the snapshot take their geometry from it
+                instead of importing their file
+
+      Modifies: [m_models, m_skyBox, m_bModelsLoaded,
+                 m_bSnapshotStale].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::LoadModels()
+    {
+        if (m_bModelsLoaded)
+        {
+            return S_OK;
+        }
+
+        for (auto it = m_models.begin(); it != m_models.end(); ++it)
+        {
+            // A model file changed since the snapshot was written makes
+            // the snapshot worth writing again
+            if (m_snapshot && m_snapshot->RestoreModel(*it->second) == E_CHANGED_STATE)
+            {
+                m_bSnapshotStale = TRUE;
+            }
+
+            HRESULT hr = it->second->Load();
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+        if (m_skyBox)
+        {
+            HRESULT hr = m_skyBox->Load();
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+        m_bModelsLoaded = TRUE;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::Update
+
+      Summary:  Update the renderables, models, point lights, skybox
+                each frame
+
+      Args:     FLOAT deltaTime
+                  Time difference of a frame
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::Update(_In_ FLOAT deltaTime)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::UpdateVoxelStreaming
+
+      Summary:  Streams the voxel chunks around the camera and replaces
+                the voxels with those of the resident chunks. Does
+                nothing unless the scene was created with streaming
+
+      Args:     const XMVECTOR& eye
+                  Position of the camera
+                ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+
+      Modifies: [m_voxelStreamer, m_voxels].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::UpdateVoxelStreaming(_In_ const XMVECTOR& eye, _In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (!m_voxelStreamer)
+        {
+            return S_OK;
+        }
+
+        HRESULT hr = m_voxelStreamer->Update(eye, pDevice, pImmediateContext, m_voxelVertexShader, m_voxelPixelShader);
+        m_voxelStreamer->GetVoxels(m_voxels);
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::FlushVoxelEdits
+
+      Summary:  Uploads the instances changed by the block edits since
+                the last flush, after baking again the horizons of the
+                columns around the edits when they were baked and
+                lighting again the instances around the relit cells
+                when the light map was built. Does nothing unless voxel
+                editing is enabled
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to grow the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to update the buffers
+
+      Modifies: [m_voxelEditor, m_horizonBaker, m_horizonDirtyColumns,
+                 m_voxelLightMap].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::FlushVoxelEdits(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (!m_voxelEditor)
+        {
+            return S_OK;
+        }
+
+        if (m_horizonBaker && m_horizonDirtyColumns.x <= m_horizonDirtyColumns.z)
+        {
+            HRESULT hr = m_horizonBaker->Rebake(*m_voxelEditor, m_horizonDirtyColumns.x, m_horizonDirtyColumns.y, m_horizonDirtyColumns.z, m_horizonDirtyColumns.w);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+        m_horizonDirtyColumns = XMINT4(INT_MAX, INT_MAX, INT_MIN, INT_MIN);
+
+        if (m_voxelLightMap && !m_voxelStats.bPackedInstances)
+        {
+            HRESULT hr = m_voxelLightMap->RelightInstances(*m_voxelEditor);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        return m_voxelEditor->Flush(pDevice, pImmediateContext);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::CastRay
+
+      Summary:  Returns the first solid block along a ray. When voxel
+                editing is enabled the block type is the one placed in
+                the cell rather than that of the column
+
+      Args:     const VoxelRay& ray
+                  Ray in world space
+                VoxelRayHit& hit
+                  Receives the hit
+
+      Returns:  BOOL
+                  TRUE if the ray hits a block, FALSE as well when there
+                  is no ray caster
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL Scene::CastRay(_In_ const VoxelRay& ray, _Out_ VoxelRayHit& hit) const
+    {
+        if (!m_voxelRayCaster)
+        {
+            hit = {};
+            return FALSE;
+        }
+
+        if (!m_voxelRayCaster->CastRay(ray, hit))
+        {
+            return FALSE;
+        }
+
+        if (m_voxelEditor)
+        {
+            hit.BlockType = m_voxelEditor->GetBlockType(hit.Cell.x, hit.Cell.y, hit.Cell.z);
+        }
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::CastRays
+
+      Summary:  Casts a batch of rays across the worker threads, with
+                the block types of the voxel editor like CastRay
+
+      Args:     const VoxelRay* pRays
+                  Rays to cast
+                UINT uNumRays
+                  Number of rays
+                VoxelRayHit* pHits
+                  Receives the hit of each ray
+
+      Returns:  UINT
+                  Number of rays that hit a block
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT Scene::CastRays(_In_reads_(uNumRays) const VoxelRay* pRays, _In_ UINT uNumRays, _Out_writes_(uNumRays) VoxelRayHit* pHits) const
+    {
+        if (!m_voxelRayCaster)
+        {
+            for (UINT i = 0u; i < uNumRays; ++i)
+            {
+                pHits[i] = {};
+            }
+            return 0u;
+        }
+
+        UINT uNumHits = m_voxelRayCaster->CastRays(pRays, uNumRays, pHits);
+        if (m_voxelEditor)
+        {
+            for (UINT i = 0u; i < uNumRays; ++i)
+            {
+                if (pHits[i].bHit)
+                {
+                    pHits[i].BlockType = m_voxelEditor->GetBlockType(pHits[i].Cell.x, pHits[i].Cell.y, pHits[i].Cell.z);
+                }
+            }
+        }
+
+        return uNumHits;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxels
+
+      Summary:  Returns the vector of voxels
+
+      Returns:  std::vector<std::shared_ptr<Voxel>>&
+                  Voxels
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::vector<std::shared_ptr<Voxel>>& Scene::GetVoxels()
+    {
+        return m_voxels;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetRenderables
+
+      Summary:  Returns the vector of renderables
+
+      Returns:  std::unordered_map<std::wstring, std::shared_ptr<Renderable>>&
+                  Renderables
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::unordered_map<std::wstring, std::shared_ptr<Renderable>>& Scene::GetRenderables()
+    {
+        return m_renderables;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetModels
+
+      Summary:  Returns the vector of models
+
+      Returns:  std::unordered_map<std::wstring, std::shared_ptr<Model>>&
+                  Models
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::unordered_map<std::wstring, std::shared_ptr<Model>>& Scene::GetModels()
+    {
+        return m_models;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetPointLight
+
+      Summary:  Returns a point light according to the given index
+
+      Args:     size_t index
+                  Index of the point light
+
+      Returns:  std::shared_ptr<PointLight>&
+                  Point light
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::shared_ptr<PointLight>& Scene::GetPointLight(_In_ size_t index)
+    {
+        assert(index < NUM_LIGHTS);
+
+        return m_aPointLights[index];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVertexShaders
+
+      Summary:  Returns a hash map of vertex shaders
+
+      Returns:  std::unordered_map<std::wstring, std::shared_ptr<VertexShader>>&
+                  Vertex shaders
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::unordered_map<std::wstring, std::shared_ptr<VertexShader>>& Scene::GetVertexShaders()
+    {
+        return m_vertexShaders;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetPixelShaders
+
+      Summary:  Returns a hash map of pixel shaders
+
+      Returns:  std::unordered_map<std::wstring, std::shared_ptr<PixelShader>>&
+                  Pixel shaders
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::unordered_map<std::wstring, std::shared_ptr<PixelShader>>& Scene::GetPixelShaders()
+    {
+        return m_pixelShaders;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetSkyBox
+
+      Summary:  Returns a sky box
+
+      Returns:  std::shared_ptr<Skybox>&
+                  Sky box
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::shared_ptr<Skybox>& Scene::GetSkyBox()
+    {
+        return m_skyBox;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetHeightMap
+
+      Summary:  Returns the height map the voxels were built from
+
+      Returns:  const std::shared_ptr<HeightMap>&
+                  Height map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::shared_ptr<HeightMap>& Scene::GetHeightMap() const
+    {
+        return m_heightMap;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetLoadStats
+
+      Summary:  Returns the timings and the peak memory of the load
+
+      Returns:  const SceneLoadStats&
+                  Load statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const SceneLoadStats& Scene::GetLoadStats() const
+    {
+        return m_loadStats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetLoadStatus
+
+      Summary:  Returns whether the height map was read. The voxels of
+                a scene whose height map failed to load are not usable
+
+      Returns:  HRESULT
+                  Status of loading or restoring the height map, S_OK
+                  for a height map built in memory
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::GetLoadStatus() const
+    {
+        return m_hrLoadStatus;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetOccupancyGrid
+
+      Summary:  Returns the occupancy of the voxel world
+
+      Returns:  const std::shared_ptr<OccupancyGrid>&
+                  Occupancy grid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::shared_ptr<OccupancyGrid>& Scene::GetOccupancyGrid() const
+    {
+        return m_occupancyGrid;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetHeightPyramid
+
+      Summary:  Returns the min/max height pyramid of the terrain
+
+      Returns:  const std::unique_ptr<HeightPyramid>&
+                  Height pyramid, null until BuildHeightPyramid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::unique_ptr<HeightPyramid>& Scene::GetHeightPyramid() const
+    {
+        return m_heightPyramid;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxelStats
+
+      Summary:  Returns the number of solid voxels and of instanced
+                voxels, and the size of their instance data
+
+      Returns:  const SceneVoxelStats&
+                  Voxel statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const SceneVoxelStats& Scene::GetVoxelStats() const
+    {
+        return m_voxelStats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxelChunkMeshes
+
+      Summary:  Returns the greedy meshes of the voxel chunks
+
+      Returns:  std::vector<std::shared_ptr<VoxelChunkMesh>>&
+                  Chunk meshes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::vector<std::shared_ptr<VoxelChunkMesh>>& Scene::GetVoxelChunkMeshes()
+    {
+        return m_voxelChunkMeshes;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetMesherStats
+
+      Summary:  Returns the triangles and the time of the chunk meshing
+
+      Returns:  const VoxelMesherStats&
+                  Mesher statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelMesherStats& Scene::GetMesherStats() const
+    {
+        return m_mesherStats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxelStreamer
+
+      Summary:  Returns the streamer of the voxel chunks, null unless
+                the scene was created with streaming
+
+      Returns:  const std::unique_ptr<VoxelStreamer>&
+                  Voxel streamer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::unique_ptr<VoxelStreamer>& Scene::GetVoxelStreamer() const
+    {
+        return m_voxelStreamer;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxelEditor
+
+      Summary:  Returns the voxel editor
+
+      Returns:  const std::unique_ptr<VoxelEditor>&
+                  Voxel editor, empty unless voxel editing is enabled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::unique_ptr<VoxelEditor>& Scene::GetVoxelEditor() const
+    {
+        return m_voxelEditor;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxelBrickMap
+
+      Summary:  Returns the voxel brick map
+
+      Returns:  const std::unique_ptr<VoxelBrickMap>&
+                  Voxel brick map, empty until BuildVoxelBrickMap
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::unique_ptr<VoxelBrickMap>& Scene::GetVoxelBrickMap() const
+    {
+        return m_voxelBrickMap;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetBrickMapStats
+
+      Summary:  Returns the benchmark of the voxel brick map
+
+      Returns:  const VoxelBrickMapStats&
+                  Brick map statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelBrickMapStats& Scene::GetBrickMapStats() const
+    {
+        return m_brickMapStats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetRunLengthColumns
+
+      Summary:  Returns the run-length columns
+
+      Returns:  const std::unique_ptr<RunLengthColumns>&
+                  Run-length columns, empty until BuildRunLengthColumns
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::unique_ptr<RunLengthColumns>& Scene::GetRunLengthColumns() const
+    {
+        return m_runLengthColumns;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetRunLengthColumnStats
+
+      Summary:  Returns the compression report of the run-length columns
+
+      Returns:  const RunLengthColumnStats&
+                  Run-length column statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const RunLengthColumnStats& Scene::GetRunLengthColumnStats() const
+    {
+        return m_runLengthColumnStats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxelRayCaster
+
+      Summary:  Returns the voxel ray caster
+
+      Returns:  const std::unique_ptr<VoxelRayCaster>&
+                  Voxel ray caster, empty until BuildVoxelRayCaster
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::unique_ptr<VoxelRayCaster>& Scene::GetVoxelRayCaster() const
+    {
+        return m_voxelRayCaster;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxelCollider
+
+      Summary:  Returns the voxel collider
+
+      Returns:  const std::shared_ptr<VoxelCollider>&
+                  Voxel collider, empty until BuildVoxelCollider
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::shared_ptr<VoxelCollider>& Scene::GetVoxelCollider() const
+    {
+        return m_voxelCollider;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetHorizonBaker
+
+      Summary:  Returns the horizon baker
+
+      Returns:  const std::unique_ptr<HorizonBaker>&
+                  Horizon baker, empty until BuildHorizonLighting
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::unique_ptr<HorizonBaker>& Scene::GetHorizonBaker() const
+    {
+        return m_horizonBaker;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetVoxelLightMap
+
+      Summary:  Returns the voxel light map
+
+      Returns:  const std::unique_ptr<VoxelLightMap>&
+                  Voxel light map, empty until BuildVoxelLighting
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::unique_ptr<VoxelLightMap>& Scene::GetVoxelLightMap() const
+    {
+        return m_voxelLightMap;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetFilePath
+
+      Summary:  Returns the file path to the height map
+
+      Returns:  const std::filesystem::path&
+                  File path to the height map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::filesystem::path& Scene::GetFilePath() const
+    {
+        return m_filePath;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetFileName
+
+      Summary:  Returns the file name of the height map
 
       Returns:  PCWSTR
                   File name of the height map
@@ -684,7 +2095,7 @@ namespace library
                 PCWSTR pszVertexShaderName
                   Key of the vertex shader
 
-      Modifies: [m_scenes].
+      Modifies: [m_voxels, m_voxelVertexShader].
 
       Returns:  HRESULT
                   Status code
@@ -696,6 +2107,8 @@ namespace library
             return E_FAIL;
         }
 
+        m_voxelVertexShader = m_vertexShaders[pszVertexShaderName];
+
         for (std::shared_ptr<Voxel>& voxel : m_voxels)
         {
             voxel->SetVertexShader(m_vertexShaders[pszVertexShaderName]);
@@ -714,7 +2127,7 @@ namespace library
                 PCWSTR pszPixelShaderName
                   Key of the pixel shader
 
-      Modifies: [m_renderables].
+      Modifies: [m_voxels, m_voxelPixelShader].
 
       Returns:  HRESULT
                   Status code
@@ -726,6 +2139,8 @@ namespace library
             return E_FAIL;
         }
 
+        m_voxelPixelShader = m_pixelShaders[pszPixelShaderName];
+
         for (std::shared_ptr<Voxel>& voxel : m_voxels)
         {
             voxel->SetPixelShader(m_pixelShaders[pszPixelShaderName]);
@@ -734,6 +2149,401 @@ namespace library
         return S_OK;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SetVertexShaderOfVoxelChunkMeshes
+
+      Summary:  Sets the vertex shader for the voxel chunk meshes
+
+      Args:     PCWSTR pszVertexShaderName
+                  Key of the vertex shader
+
+      Modifies: [m_voxelChunkMeshes].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::SetVertexShaderOfVoxelChunkMeshes(_In_ PCWSTR pszVertexShaderName)
+    {
+        if (!m_vertexShaders.contains(pszVertexShaderName))
+        {
+            return E_FAIL;
+        }
+
+        for (std::shared_ptr<VoxelChunkMesh>& chunkMesh : m_voxelChunkMeshes)
+        {
+            chunkMesh->SetVertexShader(m_vertexShaders[pszVertexShaderName]);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SetPixelShaderOfVoxelChunkMeshes
+
+      Summary:  Sets the pixel shader for the voxel chunk meshes
+
+      Args:     PCWSTR pszPixelShaderName
+                  Key of the pixel shader
+
+      Modifies: [m_voxelChunkMeshes].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::SetPixelShaderOfVoxelChunkMeshes(_In_ PCWSTR pszPixelShaderName)
+    {
+        if (!m_pixelShaders.contains(pszPixelShaderName))
+        {
+            return E_FAIL;
+        }
+
+        for (std::shared_ptr<VoxelChunkMesh>& chunkMesh : m_voxelChunkMeshes)
+        {
+            chunkMesh->SetPixelShader(m_pixelShaders[pszPixelShaderName]);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::buildOccupancyGrid
+
+      Summary:  Counts the solid voxels of the height map and marks
+                them in the occupancy grid
+
+      Modifies: [m_occupancyGrid, m_voxelStats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::buildOccupancyGrid()
+    {
+        const std::vector<XMFLOAT4>& aPalette = m_heightMap->GetPalette();
+
+        // Columns may rise above the nominal height of the map
+        UINT uGridHeight = m_heightMap->GetHeight();
+        m_voxelStats.ullNumSolidVoxels = 0ull;
+        for (size_t i = 0u; i < m_heightMap->GetNumColumns(); ++i)
+        {
+            const HeightMapColumn& column = m_heightMap->GetColumns()[i];
+            size_t uVoxelIdx = static_cast<size_t>(column.BlockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+            if (column.BlockType >= static_cast<CHAR>(eBlockType::GRASSLAND) && uVoxelIdx < aPalette.size())
+            {
+                uGridHeight = std::max<UINT>(uGridHeight, column.uHeight);
+                m_voxelStats.ullNumSolidVoxels += column.uHeight;
+            }
+        }
+
+        m_occupancyGrid = std::make_shared<OccupancyGrid>(m_heightMap->GetWidth(), uGridHeight, m_heightMap->GetDepth());
+        m_occupancyGrid->FillFromHeightMap(*m_heightMap);
+
+        m_voxelStats.ullSolidInstanceBytes = m_voxelStats.ullNumSolidVoxels * sizeof(InstanceData);
+        m_voxelStats.ullOccupancyBytes = m_occupancyGrid->GetMemoryUsage();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::buildVoxels
+
+      Summary:  Creates a voxel for each color of the palette and fills
+                its instances from the columns of the height map, with
+                the rows split across worker threads. Only the voxels
+                with an exposed face are instanced. Voxels without any
+                instance are removed
+
+      Modifies: [m_voxels, m_voxelStats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::buildVoxels()
+    {
+        const std::vector<XMFLOAT4>& aPalette = m_heightMap->GetPalette();
+        for (const XMFLOAT4& color : aPalette)
+        {
+            m_voxels.push_back(std::make_shared<Voxel>(color));
+        }
+
+        std::vector<std::vector<InstanceData>> aInstanceData(aPalette.size());
+        m_voxelStats.InstanceBuildMilliseconds = buildInstanceData(FALSE, aInstanceData, &m_voxelStats.ullEstimatedPeakBuildBytes);
+        m_voxelStats.bCollapsedRuns = FALSE;
+        m_voxelStats.bPackedInstances = FALSE;
+
+        m_voxelStats.ullNumInstances = 0ull;
+        for (const std::vector<InstanceData>& aInstances : aInstanceData)
+        {
+            m_voxelStats.ullNumInstances += aInstances.size();
+        }
+        m_voxelStats.ullInstanceBytes = m_voxelStats.ullNumInstances * sizeof(InstanceData);
+
+        UINT uVoxelIdx = 0u;
+        auto it = m_voxels.begin();
+        while (it != m_voxels.end())
+        {
+            if (aInstanceData[uVoxelIdx].size() <= 0)
+            {
+                it = m_voxels.erase(it);
+            }
+            else
+            {
+                (*it)->SetInstanceData(std::move(aInstanceData[uVoxelIdx]));
+                ++it;
+            }
+            ++uVoxelIdx;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::benchmarkVoxelBrickMap
+
+      Summary:  Measures the brick map against flat per-type vectors
+                holding the cells of the same solid voxels. Their size
+                is the memory they actually take. A point query on the
+                flat vectors scans the buckets until the cell is found,
+                so at most MAX_FLAT_POINT_QUERIES of them are timed.
+                The range query gathers the solid voxels of a box of
+                32 x 32 columns at the center of the map
+
+      Args:     UINT uNumQueries
+                  Number of point queries on the brick map
+
+      Modifies: [m_brickMapStats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::benchmarkVoxelBrickMap(_In_ UINT uNumQueries)
+    {
+        static constexpr const UINT MAX_FLAT_POINT_QUERIES = 256u;
+        static constexpr const UINT RANGE_SIZE = 32u;
+
+        UINT uWidth = m_voxelBrickMap->GetWidth();
+        UINT uHeight = m_voxelBrickMap->GetHeight();
+        UINT uDepth = m_voxelBrickMap->GetDepth();
+
+        // The flat vectors are filled from the brick map itself so that
+        // both layouts hold exactly the same voxels
+        std::vector<std::vector<XMUINT3>> aCells(m_heightMap->GetPalette().size());
+        m_voxelBrickMap->ForEachSolid(
+            0u,
+            0u,
+            0u,
+            uWidth,
+            uHeight,
+            uDepth,
+            [&aCells](UINT x, UINT y, UINT z, CHAR blockType)
+            {
+                size_t uColorIdx = static_cast<size_t>(blockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+                if (uColorIdx < aCells.size())
+                {
+                    aCells[uColorIdx].push_back(XMUINT3(x, y, z));
+                }
+            }
+        );
+
+        m_brickMapStats.ullNumFlatVoxels = 0ull;
+        m_brickMapStats.ullFlatMemoryBytes = aCells.capacity() * sizeof(std::vector<XMUINT3>);
+        for (const std::vector<XMUINT3>& aBucket : aCells)
+        {
+            m_brickMapStats.ullNumFlatVoxels += aBucket.size();
+            m_brickMapStats.ullFlatMemoryBytes += aBucket.capacity() * sizeof(XMUINT3);
+        }
+        m_brickMapStats.FlatBytesPerVoxel = m_brickMapStats.ullNumFlatVoxels > 0ull
+            ? static_cast<FLOAT>(m_brickMapStats.ullFlatMemoryBytes) / static_cast<FLOAT>(m_brickMapStats.ullNumFlatVoxels)
+            : 0.0f;
+
+        // Both layouts answer the same pseudo-random cells, drawn from a
+        // fixed seed so that runs are comparable
+        if (uWidth == 0u || uHeight == 0u || uDepth == 0u)
+        {
+            return;
+        }
+
+        const UINT uNumFlatQueries = std::min<UINT>(uNumQueries, MAX_FLAT_POINT_QUERIES);
+        std::vector<XMUINT3> aQueries(uNumQueries);
+        BenchmarkRandom random;
+        for (XMUINT3& query : aQueries)
+        {
+            query.x = random.GetUint(uWidth);
+            query.y = random.GetUint(uHeight);
+            query.z = random.GetUint(uDepth);
+        }
+
+        BenchmarkTimer timer;
+        UINT64 ullNumHits = 0ull;
+        timer.Start();
+        for (const XMUINT3& query : aQueries)
+        {
+            ullNumHits += m_voxelBrickMap->GetBlockType(static_cast<INT>(query.x), static_cast<INT>(query.y), static_cast<INT>(query.z)) != 0;
+        }
+        m_brickMapStats.PointQueryNanoseconds = timer.GetSeconds() * 1.0e9f / static_cast<FLOAT>(uNumQueries);
+
+        timer.Start();
+        for (UINT uQueryIdx = 0u; uQueryIdx < uNumFlatQueries; ++uQueryIdx)
+        {
+            const XMUINT3& query = aQueries[uQueryIdx];
+            BOOL bFound = FALSE;
+            for (size_t uVoxelIdx = 0u; uVoxelIdx < aCells.size() && !bFound; ++uVoxelIdx)
+            {
+                for (const XMUINT3& cell : aCells[uVoxelIdx])
+                {
+                    if (cell.x == query.x && cell.y == query.y && cell.z == query.z)
+                    {
+                        bFound = TRUE;
+                        break;
+                    }
+                }
+            }
+            ullNumHits += bFound;
+        }
+        m_brickMapStats.FlatPointQueryNanoseconds = timer.GetSeconds() * 1.0e9f / static_cast<FLOAT>(uNumFlatQueries);
+
+        UINT uBeginX = uWidth > RANGE_SIZE ? (uWidth - RANGE_SIZE) / 2u : 0u;
+        UINT uBeginZ = uDepth > RANGE_SIZE ? (uDepth - RANGE_SIZE) / 2u : 0u;
+        UINT uEndX = std::min<UINT>(uBeginX + RANGE_SIZE, uWidth);
+        UINT uEndZ = std::min<UINT>(uBeginZ + RANGE_SIZE, uDepth);
+
+        timer.Start();
+        m_voxelBrickMap->ForEachSolid(
+            uBeginX,
+            0u,
+            uBeginZ,
+            uEndX,
+            uHeight,
+            uEndZ,
+            [&ullNumHits](UINT, UINT, UINT, CHAR)
+            {
+                ++ullNumHits;
+            }
+        );
+        m_brickMapStats.RangeMilliseconds = timer.GetMilliseconds();
+
+        timer.Start();
+        for (const std::vector<XMUINT3>& aBucket : aCells)
+        {
+            for (const XMUINT3& cell : aBucket)
+            {
+                ullNumHits += cell.x >= uBeginX && cell.x < uEndX && cell.z >= uBeginZ && cell.z < uEndZ;
+            }
+        }
+        m_brickMapStats.FlatRangeMilliseconds = timer.GetMilliseconds();
+
+        // Keeps the queries from being optimized away
+        if (ullNumHits == ULLONG_MAX)
+        {
+            OutputDebugString(L"Scene: unexpected number of hits\n");
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::markHorizonsDirty
+
+      Summary:  Extends the columns whose horizons the next
+                FlushVoxelEdits bakes again by an edited column and its
+                neighbours, whose faces the edit may open or close
+
+      Args:     UINT x
+                  Index of the edited column along the x-axis
+                UINT z
+                  Index of the edited column along the z-axis
+
+      Modifies: [m_horizonDirtyColumns].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::markHorizonsDirty(_In_ UINT x, _In_ UINT z)
+    {
+        if (!m_horizonBaker)
+        {
+            return;
+        }
+
+        m_horizonDirtyColumns.x = std::min<INT>(m_horizonDirtyColumns.x, static_cast<INT>(x) - 1);
+        m_horizonDirtyColumns.y = std::min<INT>(m_horizonDirtyColumns.y, static_cast<INT>(z) - 1);
+        m_horizonDirtyColumns.z = std::max<INT>(m_horizonDirtyColumns.z, static_cast<INT>(x) + 1);
+        m_horizonDirtyColumns.w = std::max<INT>(m_horizonDirtyColumns.w, static_cast<INT>(z) + 1);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::buildInstanceData
+
+      Summary:  Fills the instances of the exposed voxels into buckets
+                indexed by block type in two passes over bands of rows
+                split across worker threads. The first pass counts the
+                instances of every band per block type, which sizes
+                each bucket exactly and gives every band its offset
+                into it, so the second pass writes the instances in
+                place with no growth and no merge
+
+      Args:     BOOL bCollapseRuns
+                  Whether each vertical run of exposed voxels becomes a
+                  single instance
+                std::vector<std::vector<T>>& aInstanceData
+                  Buckets of instances, one per color of the palette,
+                  of either InstanceData, PackedInstanceData or XMUINT3
+                UINT64* pullEstimatedPeakBytes
+                  Receives the most memory held by the build at once,
+                  estimated from the instances and the band offsets
+
+      Modifies: [aInstanceData].
+
+      Returns:  FLOAT
+                  Time spent filling the instances in milliseconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class T>
+    FLOAT Scene::buildInstanceData(_In_ BOOL bCollapseRuns, _Inout_ std::vector<std::vector<T>>& aInstanceData, _Out_opt_ UINT64* pullEstimatedPeakBytes) const
+    {
+        BenchmarkTimer timer;
+
+        VoxelInstanceBuilder instanceBuilder(m_heightMap, m_occupancyGrid, bCollapseRuns);
+        UINT uNumWorkers = std::clamp(std::thread::hardware_concurrency(), 1u, std::max<UINT>(m_heightMap->GetDepth(), 1u));
+        size_t uNumColors = aInstanceData.size();
+        auto runBands = [this, uNumWorkers](auto buildBand)
+        {
+            std::vector<std::thread> aWorkers;
+            aWorkers.reserve(uNumWorkers - 1u);
+            for (UINT uWorkerIdx = 1u; uWorkerIdx < uNumWorkers; ++uWorkerIdx)
+            {
+                aWorkers.emplace_back(buildBand, uWorkerIdx, m_heightMap->GetDepth() * uWorkerIdx / uNumWorkers, m_heightMap->GetDepth() * (uWorkerIdx + 1u) / uNumWorkers);
+            }
+            buildBand(0u, 0u, m_heightMap->GetDepth() / uNumWorkers);
+
+            for (std::thread& worker : aWorkers)
+            {
+                worker.join();
+            }
+        };
+
+        // Every band counts its instances of each block type
+        std::vector<std::vector<size_t>> aBandOffsets(uNumWorkers, std::vector<size_t>(uNumColors, 0u));
+        runBands(
+            [this, &instanceBuilder, &aBandOffsets](UINT uWorkerIdx, UINT uBeginZ, UINT uEndZ)
+            {
+                instanceBuilder.CountRegion<T>(0u, m_heightMap->GetWidth(), uBeginZ, uEndZ, aBandOffsets[uWorkerIdx]);
+            }
+        );
+
+        // Bands are laid out in row order after the instances already in
+        // the bucket, which keeps the instances in the same order as a
+        // serial build
+        UINT64 ullNumInstances = 0ull;
+        for (size_t uVoxelIdx = 0u; uVoxelIdx < uNumColors; ++uVoxelIdx)
+        {
+            size_t uOffset = aInstanceData[uVoxelIdx].size();
+            for (std::vector<size_t>& aOffsets : aBandOffsets)
+            {
+                size_t uCount = aOffsets[uVoxelIdx];
+                aOffsets[uVoxelIdx] = uOffset;
+                uOffset += uCount;
+            }
+
+            aInstanceData[uVoxelIdx].resize(uOffset);
+            ullNumInstances += aInstanceData[uVoxelIdx].size();
+        }
+
+        runBands(
+            [this, &instanceBuilder, &aBandOffsets, &aInstanceData](UINT uWorkerIdx, UINT uBeginZ, UINT uEndZ)
+            {
+                instanceBuilder.FillRegion(0u, m_heightMap->GetWidth(), uBeginZ, uEndZ, aBandOffsets[uWorkerIdx], aInstanceData);
+            }
+        );
+
+        if (pullEstimatedPeakBytes)
+        {
+            *pullEstimatedPeakBytes = ullNumInstances * sizeof(T) + static_cast<UINT64>(uNumWorkers) * uNumColors * sizeof(size_t);
+        }
+
+        return timer.GetMilliseconds();
+    }
+
     FLOAT Scene::getNoise2(UINT x, UINT y)
     {
         UINT temp = ms_aHashes[y % 256u];
@@ -768,4 +2578,146 @@ namespace library
     {
         return lerp(x, y, s * s * (3.0f - 2.0f * s));
     }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::getPerlin2dSse2
+
+      Summary:  GetPerlin2d on 4 points at once. SSE2 has no gather, so
+                the lattice indices are spilled and hashed one lane at
+                a time while the interpolation runs on the 4 lanes
+
+      Args:     const FLOAT* pX
+                  4 coordinates along x
+                const FLOAT* pY
+                  4 coordinates along y
+                FLOAT frequency
+                  Frequency of the first octave
+                UINT uDepth
+                  Number of octaves
+                FLOAT* pResults
+                  Receives the 4 noise values
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::getPerlin2dSse2(_In_reads_(4) const FLOAT* pX, _In_reads_(4) const FLOAT* pY, _In_ FLOAT frequency, _In_ UINT uDepth, _Out_writes_(4) FLOAT* pResults)
+    {
+        const __m128 three = _mm_set1_ps(3.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+
+        __m128 xa = _mm_mul_ps(_mm_loadu_ps(pX), _mm_set1_ps(frequency));
+        __m128 ya = _mm_mul_ps(_mm_loadu_ps(pY), _mm_set1_ps(frequency));
+        __m128 fin = _mm_setzero_ps();
+        FLOAT amp = 1.0f;
+        FLOAT div = 0.0f;
+
+        for (UINT i = 0; i < uDepth; ++i)
+        {
+            div += 256.0f * amp;
+
+            __m128i uX = _mm_cvttps_epi32(xa);
+            __m128i uY = _mm_cvttps_epi32(ya);
+            __m128 xFrac = _mm_sub_ps(xa, _mm_cvtepi32_ps(uX));
+            __m128 yFrac = _mm_sub_ps(ya, _mm_cvtepi32_ps(uY));
+
+            alignas(16) UINT aX[4];
+            alignas(16) UINT aY[4];
+            alignas(16) INT aS[4];
+            alignas(16) INT aT[4];
+            alignas(16) INT aU[4];
+            alignas(16) INT aV[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(aX), uX);
+            _mm_store_si128(reinterpret_cast<__m128i*>(aY), uY);
+            for (UINT uLane = 0u; uLane < 4u; ++uLane)
+            {
+                UINT uLow = ms_aHashes[aY[uLane] % 256u];
+                UINT uHigh = ms_aHashes[(aY[uLane] + 1u) % 256u];
+                aS[uLane] = static_cast<INT>(ms_aHashes[(uLow + aX[uLane]) % 256u]);
+                aT[uLane] = static_cast<INT>(ms_aHashes[(uLow + aX[uLane] + 1u) % 256u]);
+                aU[uLane] = static_cast<INT>(ms_aHashes[(uHigh + aX[uLane]) % 256u]);
+                aV[uLane] = static_cast<INT>(ms_aHashes[(uHigh + aX[uLane] + 1u) % 256u]);
+            }
+            __m128 s = _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(aS)));
+            __m128 t = _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(aT)));
+            __m128 u = _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(aU)));
+            __m128 v = _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(aV)));
+
+            // smoothLerp, term by term in the order of the scalar code
+            __m128 xWeight = _mm_mul_ps(_mm_mul_ps(xFrac, xFrac), _mm_sub_ps(three, _mm_mul_ps(two, xFrac)));
+            __m128 yWeight = _mm_mul_ps(_mm_mul_ps(yFrac, yFrac), _mm_sub_ps(three, _mm_mul_ps(two, yFrac)));
+            __m128 low = _mm_add_ps(s, _mm_mul_ps(xWeight, _mm_sub_ps(t, s)));
+            __m128 high = _mm_add_ps(u, _mm_mul_ps(xWeight, _mm_sub_ps(v, u)));
+            __m128 noise = _mm_add_ps(low, _mm_mul_ps(yWeight, _mm_sub_ps(high, low)));
+
+            fin = _mm_add_ps(fin, _mm_mul_ps(noise, _mm_set1_ps(amp)));
+            amp /= 2.0f;
+            xa = _mm_mul_ps(xa, two);
+            ya = _mm_mul_ps(ya, two);
+        }
+
+        _mm_storeu_ps(pResults, _mm_div_ps(fin, _mm_set1_ps(div)));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::getPerlin2dAvx2
+
+      Summary:  GetPerlin2d on 8 points at once, with the four hashes
+                of every lattice cell gathered from the hash table
+
+      Args:     const FLOAT* pX
+                  8 coordinates along x
+                const FLOAT* pY
+                  8 coordinates along y
+                FLOAT frequency
+                  Frequency of the first octave
+                UINT uDepth
+                  Number of octaves
+                FLOAT* pResults
+                  Receives the 8 noise values
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::getPerlin2dAvx2(_In_reads_(8) const FLOAT* pX, _In_reads_(8) const FLOAT* pY, _In_ FLOAT frequency, _In_ UINT uDepth, _Out_writes_(8) FLOAT* pResults)
+    {
+        const __m256 three = _mm256_set1_ps(3.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i hashMask = _mm256_set1_epi32(255);
+        const INT* pHashes = reinterpret_cast<const INT*>(ms_aHashes);
+
+        __m256 xa = _mm256_mul_ps(_mm256_loadu_ps(pX), _mm256_set1_ps(frequency));
+        __m256 ya = _mm256_mul_ps(_mm256_loadu_ps(pY), _mm256_set1_ps(frequency));
+        __m256 fin = _mm256_setzero_ps();
+        FLOAT amp = 1.0f;
+        FLOAT div = 0.0f;
+
+        for (UINT i = 0; i < uDepth; ++i)
+        {
+            div += 256.0f * amp;
+
+            __m256i uX = _mm256_cvttps_epi32(xa);
+            __m256i uY = _mm256_cvttps_epi32(ya);
+            __m256 xFrac = _mm256_sub_ps(xa, _mm256_cvtepi32_ps(uX));
+            __m256 yFrac = _mm256_sub_ps(ya, _mm256_cvtepi32_ps(uY));
+
+            // Unsigned wrap-around and % 256 both reduce to the low byte
+            __m256i low = _mm256_i32gather_epi32(pHashes, _mm256_and_si256(uY, hashMask), 4);
+            __m256i high = _mm256_i32gather_epi32(pHashes, _mm256_and_si256(_mm256_add_epi32(uY, one), hashMask), 4);
+            __m256i lowX = _mm256_add_epi32(low, uX);
+            __m256i highX = _mm256_add_epi32(high, uX);
+            __m256 s = _mm256_cvtepi32_ps(_mm256_i32gather_epi32(pHashes, _mm256_and_si256(lowX, hashMask), 4));
+            __m256 t = _mm256_cvtepi32_ps(_mm256_i32gather_epi32(pHashes, _mm256_and_si256(_mm256_add_epi32(lowX, one), hashMask), 4));
+            __m256 u = _mm256_cvtepi32_ps(_mm256_i32gather_epi32(pHashes, _mm256_and_si256(highX, hashMask), 4));
+            __m256 v = _mm256_cvtepi32_ps(_mm256_i32gather_epi32(pHashes, _mm256_and_si256(_mm256_add_epi32(highX, one), hashMask), 4));
+
+            // smoothLerp, term by term in the order of the scalar code
+            __m256 xWeight = _mm256_mul_ps(_mm256_mul_ps(xFrac, xFrac), _mm256_sub_ps(three, _mm256_mul_ps(two, xFrac)));
+            __m256 yWeight = _mm256_mul_ps(_mm256_mul_ps(yFrac, yFrac), _mm256_sub_ps(three, _mm256_mul_ps(two, yFrac)));
+            __m256 lowNoise = _mm256_add_ps(s, _mm256_mul_ps(xWeight, _mm256_sub_ps(t, s)));
+            __m256 highNoise = _mm256_add_ps(u, _mm256_mul_ps(xWeight, _mm256_sub_ps(v, u)));
+            __m256 noise = _mm256_add_ps(lowNoise, _mm256_mul_ps(yWeight, _mm256_sub_ps(highNoise, lowNoise)));
+
+            fin = _mm256_add_ps(fin, _mm256_mul_ps(noise, _mm256_set1_ps(amp)));
+            amp /= 2.0f;
+            xa = _mm256_mul_ps(xa, two);
+            ya = _mm256_mul_ps(ya, two);
+        }
+
+        _mm256_storeu_ps(pResults, _mm256_div_ps(fin, _mm256_set1_ps(div)));
+    }
 }
\ No newline at end of file
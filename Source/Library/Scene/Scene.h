@@ -13,22 +13,166 @@
 
 #include "Common.h"
 
+#include <bit>
 #include <fstream>
+#include <thread>
 
+#include "Game/Benchmark.h"
 #include "Model/Model.h"
 #include "Light/PointLight.h"
 #include "Renderer/Skybox.h"
 #include "Renderer/Renderable.h"
+#include "Scene/HeightMap.h"
+#include "Scene/HeightPyramid.h"
+#include "Scene/HorizonBaker.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/PackedVoxel.h"
+#include "Scene/RunLengthColumns.h"
+#include "Scene/VoxelBrickMap.h"
+#include "Scene/VoxelChunkMesh.h"
+#include "Scene/VoxelEditor.h"
+#include "Scene/VoxelLightMap.h"
+#include "Scene/VoxelInstanceBuilder.h"
+#include "Scene/VoxelMesher.h"
+#include "Scene/VoxelCollider.h"
+#include "Scene/VoxelRayCaster.h"
+#include "Scene/VoxelStreamer.h"
 #include "Scene/Voxel.h"
 
 namespace library
 {
+    class SceneLoadHandle;
+    class SceneSnapshot;
+
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+        Enum:     eNoiseKernel
+
+        Summary:  Implementations of the batch Perlin noise
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eNoiseKernel : UINT
+    {
+        SCALAR = 0u,
+        SSE2,
+        AVX2,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   NoiseBenchmarkStats
+
+        Summary:  Throughput of the Perlin noise in millions of samples
+                  per second, one sample at a time and with each batch
+                  kernel, and whether every kernel matched the scalar
+                  noise bit for bit. The AVX2 throughput stays 0 on a
+                  processor without AVX2
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct NoiseBenchmarkStats
+    {
+        UINT uNumSamples;
+        UINT uDepth;
+        FLOAT ScalarMegaSamplesPerSecond;
+        FLOAT Sse2MegaSamplesPerSecond;
+        FLOAT Avx2MegaSamplesPerSecond;
+        eNoiseKernel BestKernel;
+        BOOL bIdentical;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   SceneLoadStats
+
+        Summary:  Time spent loading the height map and building the
+                  voxels, the throughput of the load, and the peak
+                  working set of the process after the load
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct SceneLoadStats
+    {
+        FLOAT ParseMilliseconds;
+        FLOAT ParseMegabytesPerSecond;
+        FLOAT BuildMilliseconds;
+        SIZE_T uPeakWorkingSetBytes;
+        BOOL bMapped;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   SceneVoxelStats
+
+        Summary:  Number of solid voxels against the number of instanced
+                  voxels, the size of the instance buffers of both, an
+                  estimate of the most memory held while filling the
+                  instances, counted from the sizes of the buckets and
+                  not measured, the time it took, and whether the
+                  instances are packed or collapsed into vertical runs
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct SceneVoxelStats
+    {
+        UINT64 ullNumSolidVoxels;
+        UINT64 ullNumInstances;
+        UINT64 ullSolidInstanceBytes;
+        UINT64 ullInstanceBytes;
+        UINT64 ullOccupancyBytes;
+        UINT64 ullEstimatedPeakBuildBytes;
+        FLOAT InstanceBuildMilliseconds;
+        BOOL bCollapsedRuns;
+        BOOL bPackedInstances;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelBrickMapStats
+
+        Summary:  Size and build time of the brick map, then, when it
+                  was benchmarked, the size of flat per-type vectors of
+                  the cells of the same voxels, the average latency of
+                  a point query, and the time spent gathering the solid
+                  voxels of a box, both measured on the two layouts
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelBrickMapStats
+    {
+        UINT64 ullNumBricks;
+        UINT64 ullNumSolidVoxels;
+        UINT64 ullMemoryBytes;
+        UINT64 ullNumFlatVoxels;
+        UINT64 ullFlatMemoryBytes;
+        FLOAT BuildMilliseconds;
+        FLOAT BytesPerSolidVoxel;
+        FLOAT FlatBytesPerVoxel;
+        FLOAT PointQueryNanoseconds;
+        FLOAT FlatPointQueryNanoseconds;
+        FLOAT RangeMilliseconds;
+        FLOAT FlatRangeMilliseconds;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   RunLengthColumnStats
+
+        Summary:  Size of the run-length columns in memory and on disk
+                  against a dense grid of one byte per cell and against
+                  one instance per solid voxel, with the time spent
+                  encoding the columns and expanding them to instances
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct RunLengthColumnStats
+    {
+        UINT64 ullNumRuns;
+        UINT64 ullNumSolidVoxels;
+        UINT64 ullMemoryBytes;
+        UINT64 ullFileBytes;
+        UINT64 ullDenseBytes;
+        UINT64 ullSolidInstanceBytes;
+        FLOAT DenseCompressionRatio;
+        FLOAT InstanceCompressionRatio;
+        FLOAT BuildMilliseconds;
+        FLOAT ExpandMilliseconds;
+    };
+
     class Scene
     {
     public:
         static FLOAT GetPerlin2d(FLOAT x, FLOAT y, FLOAT frequency, UINT uDepth);
+        static void GetPerlin2dBatch(_In_reads_(uCount) const FLOAT* pX, _In_reads_(uCount) const FLOAT* pY, _In_ FLOAT frequency, _In_ UINT uDepth, _In_ UINT uCount, _Out_writes_(uCount) FLOAT* pResults, _In_ eNoiseKernel kernel = GetBestNoiseKernel());
+        static eNoiseKernel GetBestNoiseKernel();
+        static NoiseBenchmarkStats BenchmarkPerlin2dBatch(_In_ UINT uNumSamples, _In_ UINT uDepth);
 
-        Scene(const std::filesystem::path& filePath);
+        Scene(const std::filesystem::path& filePath, _In_opt_ const VoxelStreamingDesc* pStreamingDesc = nullptr, _In_opt_ SceneLoadHandle* pLoadHandle = nullptr);
+        Scene(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_opt_ const VoxelStreamingDesc* pStreamingDesc = nullptr, _In_opt_ SceneLoadHandle* pLoadHandle = nullptr);
+        Scene(_In_ const std::shared_ptr<SceneSnapshot>& snapshot, _In_opt_ SceneLoadHandle* pLoadHandle = nullptr);
         Scene(const Scene& other) = delete;
         Scene(Scene&& other) = delete;
         Scene& operator=(const Scene& other) = delete;
@@ -45,8 +189,28 @@ namespace library
         HRESULT AddPixelShader(_In_ PCWSTR pszPixelShaderName, _In_ const std::shared_ptr<PixelShader>& pixelShader);
         HRESULT AddMaterial(_In_ const std::shared_ptr<Material>& material);
         HRESULT AddSkyBox(_In_ const std::shared_ptr<Skybox>& skybox);
+        HRESULT BuildVoxelChunkMeshes(_In_ UINT uChunkSize);
+        HRESULT BuildPackedVoxels(_In_ BOOL bCollapseRuns = FALSE);
+        HRESULT BuildVoxelRuns();
+        HRESULT EnableVoxelEditing();
+        HRESULT PlaceBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ CHAR blockType);
+        HRESULT RemoveBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z);
+        HRESULT BuildVoxelBrickMap(_In_ UINT uNumBenchmarkQueries = 0u);
+        HRESULT BuildRunLengthColumns(_In_ const std::filesystem::path& filePath);
+        HRESULT BuildVoxelRayCaster(_In_ UINT uNumBenchmarkRays = 0u);
+        HRESULT BuildHeightPyramid(_In_ UINT uNumBenchmarkQueries = 0u);
+        HRESULT BuildVoxelCollider(_In_ UINT uNumBenchmarkMoves = 0u);
+        HRESULT BuildHorizonLighting(_In_ UINT uNumBruteForceInstances = 0u);
+        HRESULT BuildVoxelLighting(_In_ UINT uNumBenchmarkEdits = 0u);
+        HRESULT CompileShaders();
+        HRESULT LoadModels();
+        void SetSnapshotCache(_In_ const std::filesystem::path& filePath, _In_ UINT64 ullInputHash);
 
         void Update(_In_ FLOAT deltaTime);
+        HRESULT UpdateVoxelStreaming(_In_ const XMVECTOR& eye, _In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+        HRESULT FlushVoxelEdits(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+        BOOL CastRay(_In_ const VoxelRay& ray, _Out_ VoxelRayHit& hit) const;
+        UINT CastRays(_In_reads_(uNumRays) const VoxelRay* pRays, _In_ UINT uNumRays, _Out_writes_(uNumRays) VoxelRayHit* pHits) const;
 
         std::vector<std::shared_ptr<Voxel>>& GetVoxels();
         std::unordered_map<std::wstring, std::shared_ptr<Renderable>>& GetRenderables();
@@ -55,6 +219,24 @@ namespace library
         std::unordered_map<std::wstring, std::shared_ptr<VertexShader>>& GetVertexShaders();
         std::unordered_map<std::wstring, std::shared_ptr<PixelShader>>& GetPixelShaders();
         std::shared_ptr<Skybox>& GetSkyBox();
+        const std::shared_ptr<HeightMap>& GetHeightMap() const;
+        const SceneLoadStats& GetLoadStats() const;
+        HRESULT GetLoadStatus() const;
+        const std::shared_ptr<OccupancyGrid>& GetOccupancyGrid() const;
+        const std::unique_ptr<HeightPyramid>& GetHeightPyramid() const;
+        const SceneVoxelStats& GetVoxelStats() const;
+        std::vector<std::shared_ptr<VoxelChunkMesh>>& GetVoxelChunkMeshes();
+        const VoxelMesherStats& GetMesherStats() const;
+        const std::unique_ptr<VoxelStreamer>& GetVoxelStreamer() const;
+        const std::unique_ptr<VoxelEditor>& GetVoxelEditor() const;
+        const std::unique_ptr<VoxelBrickMap>& GetVoxelBrickMap() const;
+        const VoxelBrickMapStats& GetBrickMapStats() const;
+        const std::unique_ptr<RunLengthColumns>& GetRunLengthColumns() const;
+        const RunLengthColumnStats& GetRunLengthColumnStats() const;
+        const std::unique_ptr<VoxelRayCaster>& GetVoxelRayCaster() const;
+        const std::shared_ptr<VoxelCollider>& GetVoxelCollider() const;
+        const std::unique_ptr<HorizonBaker>& GetHorizonBaker() const;
+        const std::unique_ptr<VoxelLightMap>& GetVoxelLightMap() const;
 
         const std::filesystem::path& GetFilePath() const;
         PCWSTR GetFileName() const;
@@ -65,12 +247,27 @@ namespace library
         HRESULT SetPixelShaderOfModel(_In_ PCWSTR pszModelName, _In_ PCWSTR pszPixelShaderName);
         HRESULT SetVertexShaderOfVoxel(_In_ PCWSTR pszVertexShaderName);
         HRESULT SetPixelShaderOfVoxel(_In_ PCWSTR pszPixelShaderName);
+        HRESULT SetVertexShaderOfVoxelChunkMeshes(_In_ PCWSTR pszVertexShaderName);
+        HRESULT SetPixelShaderOfVoxelChunkMeshes(_In_ PCWSTR pszPixelShaderName);
+
+    private:
+        Scene(_In_ const std::filesystem::path& filePath, _In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<SceneSnapshot>& snapshot, _In_opt_ const VoxelStreamingDesc* pStreamingDesc, _In_opt_ SceneLoadHandle* pLoadHandle);
+
+        void buildOccupancyGrid();
+        void buildVoxels();
+        void benchmarkVoxelBrickMap(_In_ UINT uNumQueries);
+        void markHorizonsDirty(_In_ UINT x, _In_ UINT z);
+
+        template <class T>
+        FLOAT buildInstanceData(_In_ BOOL bCollapseRuns, _Inout_ std::vector<std::vector<T>>& aInstanceData, _Out_opt_ UINT64* pullEstimatedPeakBytes = nullptr) const;
 
     private:
         static FLOAT getNoise2(UINT x, UINT y);
         static FLOAT getNoise2d(FLOAT x, FLOAT y);
         static FLOAT lerp(FLOAT x, FLOAT y, FLOAT s);
         static FLOAT smoothLerp(FLOAT x, FLOAT y, FLOAT s);
+        static void getPerlin2dSse2(_In_reads_(4) const FLOAT* pX, _In_reads_(4) const FLOAT* pY, _In_ FLOAT frequency, _In_ UINT uDepth, _Out_writes_(4) FLOAT* pResults);
+        static void getPerlin2dAvx2(_In_reads_(8) const FLOAT* pX, _In_reads_(8) const FLOAT* pY, _In_ FLOAT frequency, _In_ UINT uDepth, _Out_writes_(8) FLOAT* pResults);
 
     private:
         static constexpr const UINT ms_aHashes[] =
@@ -91,9 +288,35 @@ namespace library
 
     private:
         std::filesystem::path m_filePath;
+        std::shared_ptr<HeightMap> m_heightMap;
+        SceneLoadStats m_loadStats;
+        HRESULT m_hrLoadStatus;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        std::unique_ptr<HeightPyramid> m_heightPyramid;
+        SceneVoxelStats m_voxelStats;
         std::vector<std::shared_ptr<Voxel>> m_voxels;
+        std::vector<std::shared_ptr<VoxelChunkMesh>> m_voxelChunkMeshes;
+        VoxelMesherStats m_mesherStats;
+        std::unique_ptr<VoxelStreamer> m_voxelStreamer;
+        std::unique_ptr<VoxelEditor> m_voxelEditor;
+        std::unique_ptr<VoxelBrickMap> m_voxelBrickMap;
+        VoxelBrickMapStats m_brickMapStats;
+        std::unique_ptr<RunLengthColumns> m_runLengthColumns;
+        RunLengthColumnStats m_runLengthColumnStats;
+        std::unique_ptr<VoxelRayCaster> m_voxelRayCaster;
+        std::shared_ptr<VoxelCollider> m_voxelCollider;
+        std::unique_ptr<HorizonBaker> m_horizonBaker;
+        XMINT4 m_horizonDirtyColumns;
+        std::unique_ptr<VoxelLightMap> m_voxelLightMap;
+        std::shared_ptr<SceneSnapshot> m_snapshot;
+        std::filesystem::path m_snapshotFilePath;
+        UINT64 m_ullSnapshotInputHash;
+        std::shared_ptr<VertexShader> m_voxelVertexShader;
+        std::shared_ptr<PixelShader> m_voxelPixelShader;
         std::unordered_map<std::wstring, std::shared_ptr<Renderable>> m_renderables;
         std::unordered_map<std::wstring, std::shared_ptr<Model>> m_models;
+        BOOL m_bModelsLoaded;
+        BOOL m_bSnapshotStale;
         std::shared_ptr<PointLight> m_aPointLights[NUM_LIGHTS];
         std::unordered_map<std::wstring, std::shared_ptr<VertexShader>> m_vertexShaders;
         std::unordered_map<std::wstring, std::shared_ptr<PixelShader>> m_pixelShaders;
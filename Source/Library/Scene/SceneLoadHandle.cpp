@@ -0,0 +1,412 @@
+#include "Scene/SceneLoadHandle.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::Start
+
+      Summary:  Starts loading a scene on a worker thread. The worker
+                builds the scene, runs the prepare callback on it and
+                compiles its shaders, and the owner finishes the load
+                by polling the returned handle
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the height map
+                const VoxelStreamingDesc* pStreamingDesc
+                  Streaming parameters, copied, or nullptr to build
+                  every voxel
+                std::function<HRESULT(Scene&)> prepare
+                  Adds the shaders, lights and renderables to the
+                  scene on the worker, may be empty
+                SceneLoadCallbacks callbacks
+                  Progress and completion callbacks
+
+      Returns:  std::shared_ptr<SceneLoadHandle>
+                  Handle to the load
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::shared_ptr<SceneLoadHandle> SceneLoadHandle::Start(_In_ const std::filesystem::path& filePath, _In_opt_ const VoxelStreamingDesc* pStreamingDesc, _In_ std::function<HRESULT(Scene&)> prepare, _In_ SceneLoadCallbacks callbacks)
+    {
+        std::shared_ptr<SceneLoadHandle> loadHandle = std::make_shared<SceneLoadHandle>(std::move(callbacks));
+
+        // The worker only sees the handle through a raw pointer, the
+        // destructor joins it before the handle goes away
+        VoxelStreamingDesc streamingDesc = pStreamingDesc ? *pStreamingDesc : VoxelStreamingDesc();
+        loadHandle->m_worker = std::thread(&SceneLoadHandle::run, loadHandle.get(), filePath, std::shared_ptr<HeightMap>(), pStreamingDesc != nullptr, streamingDesc, std::move(prepare));
+
+        return loadHandle;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::Start
+
+      Summary:  Starts building a scene on a worker thread from a height
+                map already in memory
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map of the scene, not modified
+                const VoxelStreamingDesc* pStreamingDesc
+                  Streaming parameters, copied, or nullptr to build
+                  every voxel
+                std::function<HRESULT(Scene&)> prepare
+                  Adds the shaders, lights and renderables to the
+                  scene on the worker, may be empty
+                SceneLoadCallbacks callbacks
+                  Progress and completion callbacks
+
+      Returns:  std::shared_ptr<SceneLoadHandle>
+                  Handle to the load
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::shared_ptr<SceneLoadHandle> SceneLoadHandle::Start(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_opt_ const VoxelStreamingDesc* pStreamingDesc, _In_ std::function<HRESULT(Scene&)> prepare, _In_ SceneLoadCallbacks callbacks)
+    {
+        std::shared_ptr<SceneLoadHandle> loadHandle = std::make_shared<SceneLoadHandle>(std::move(callbacks));
+
+        VoxelStreamingDesc streamingDesc = pStreamingDesc ? *pStreamingDesc : VoxelStreamingDesc();
+        loadHandle->m_worker = std::thread(&SceneLoadHandle::run, loadHandle.get(), std::filesystem::path(), heightMap, pStreamingDesc != nullptr, streamingDesc, std::move(prepare));
+
+        return loadHandle;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::SceneLoadHandle
+
+      Summary:  Constructor
+
+      Args:     SceneLoadCallbacks callbacks
+                  Progress and completion callbacks
+
+      Modifies: [m_callbacks, m_worker, m_bCancelRequested,
+                 m_bWorkerDone, m_mutex, m_stage, m_progress,
+                 m_hrWorkerStatus, m_hrStatus, m_reportedStage,
+                 m_reportedProgress, m_scene].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    SceneLoadHandle::SceneLoadHandle(_In_ SceneLoadCallbacks callbacks)
+        : m_callbacks(std::move(callbacks))
+        , m_worker()
+        , m_bCancelRequested(FALSE)
+        , m_bWorkerDone(FALSE)
+        , m_mutex()
+        , m_stage(eSceneLoadStage::QUEUED)
+        , m_progress(0.0f)
+        , m_hrWorkerStatus(S_OK)
+        , m_hrStatus(S_FALSE)
+        , m_reportedStage(eSceneLoadStage::QUEUED)
+        , m_reportedProgress(-1.0f)
+        , m_scene()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::~SceneLoadHandle
+
+      Summary:  Destructor. Cancels the load and waits for the worker
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    SceneLoadHandle::~SceneLoadHandle()
+    {
+        m_bCancelRequested = TRUE;
+        if (m_worker.joinable())
+        {
+            m_worker.join();
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::Poll
+
+      Summary:  Calls the progress callback if the worker moved on
+                since the last poll. Once the worker is done, creates
+                the buffers, shaders and textures of the scene and ends
+                the load. Must be called on the thread owning the
+                immediate context
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+
+      Modifies: [m_worker, m_reportedStage, m_reportedProgress].
+
+      Returns:  HRESULT
+                  S_FALSE while the load is running, S_OK once the
+                  scene is ready, E_ABORT if the load was canceled, or
+                  the error that failed the load
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneLoadHandle::Poll(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (IsDone())
+        {
+            return GetStatus();
+        }
+
+        eSceneLoadStage stage;
+        FLOAT progress;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stage = m_stage;
+            progress = m_progress;
+        }
+        if (stage != m_reportedStage || progress != m_reportedProgress)
+        {
+            m_reportedStage = stage;
+            m_reportedProgress = progress;
+            if (m_callbacks.OnProgress)
+            {
+                m_callbacks.OnProgress(stage, progress);
+            }
+        }
+
+        if (!m_bWorkerDone)
+        {
+            return S_FALSE;
+        }
+        m_worker.join();
+
+        if (m_bCancelRequested)
+        {
+            return finish(eSceneLoadStage::CANCELED, E_ABORT);
+        }
+        if (FAILED(m_hrWorkerStatus))
+        {
+            return finish(eSceneLoadStage::FAILED, m_hrWorkerStatus);
+        }
+
+        ReportProgress(eSceneLoadStage::UPLOADING, 0.9f);
+        if (m_callbacks.OnProgress)
+        {
+            m_callbacks.OnProgress(eSceneLoadStage::UPLOADING, 0.9f);
+        }
+        HRESULT hr = m_scene->Initialize(pDevice, pImmediateContext);
+        if (FAILED(hr))
+        {
+            return finish(eSceneLoadStage::FAILED, hr);
+        }
+
+        return finish(eSceneLoadStage::COMPLETED, S_OK);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::Cancel
+
+      Summary:  Asks the load to stop. The worker stops at the next
+                stage and the next poll reports the cancellation.
+                Has no effect on a load that is over
+
+      Modifies: [m_bCancelRequested].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void SceneLoadHandle::Cancel()
+    {
+        m_bCancelRequested = TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::ReportProgress
+
+      Summary:  Records the stage and the fraction done of the load,
+                callable from any thread. The callbacks only see it at
+                the next poll
+
+      Args:     eSceneLoadStage stage
+                  Current stage
+                FLOAT progress
+                  Fraction of the whole load done, in [0, 1]
+
+      Modifies: [m_stage, m_progress].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void SceneLoadHandle::ReportProgress(_In_ eSceneLoadStage stage, _In_ FLOAT progress)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stage = stage;
+        m_progress = std::clamp(progress, 0.0f, 1.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::IsCancelRequested
+
+      Summary:  Returns whether the load was asked to stop
+
+      Returns:  BOOL
+                  TRUE once Cancel was called
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL SceneLoadHandle::IsCancelRequested() const
+    {
+        return m_bCancelRequested;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::IsDone
+
+      Summary:  Returns whether the load is over
+
+      Returns:  BOOL
+                  TRUE once the load completed, failed or was canceled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL SceneLoadHandle::IsDone() const
+    {
+        return GetStage() >= eSceneLoadStage::COMPLETED;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::GetStage
+
+      Summary:  Returns the current stage
+
+      Returns:  eSceneLoadStage
+                  Current stage
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eSceneLoadStage SceneLoadHandle::GetStage() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stage;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::GetProgress
+
+      Summary:  Returns the fraction of the load done
+
+      Returns:  FLOAT
+                  Fraction in [0, 1]
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT SceneLoadHandle::GetProgress() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_progress;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::GetStatus
+
+      Summary:  Returns the status of the load
+
+      Returns:  HRESULT
+                  S_FALSE while the load is running, otherwise the
+                  value the last poll returned
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneLoadHandle::GetStatus() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hrStatus;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::GetScene
+
+      Summary:  Returns the loaded scene
+
+      Returns:  const std::shared_ptr<Scene>&
+                  The scene once the load completed, nullptr otherwise
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::shared_ptr<Scene>& SceneLoadHandle::GetScene() const
+    {
+        return m_scene;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::run
+
+      Summary:  Body of the worker thread. Builds the scene, prepares
+                it, imports its models, decodes their textures and
+                compiles its shaders, checking for cancellation between
+                stages. A height map that failed to load fails the load
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the height map
+                const std::shared_ptr<HeightMap>& heightMap
+                  Height map built in memory, or nullptr to load it
+                  from filePath
+                BOOL bStreaming
+                  Whether the scene streams its voxels
+                const VoxelStreamingDesc& streamingDesc
+                  Streaming parameters
+                const std::function<HRESULT(Scene&)>& prepare
+                  Adds the shaders, lights and renderables to the scene
+
+      Modifies: [m_scene, m_hrWorkerStatus, m_bWorkerDone].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void SceneLoadHandle::run(_In_ const std::filesystem::path& filePath, _In_ const std::shared_ptr<HeightMap>& heightMap, _In_ BOOL bStreaming, _In_ const VoxelStreamingDesc& streamingDesc, _In_ const std::function<HRESULT(Scene&)>& prepare)
+    {
+        // Textures are decoded through WIC
+        HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        HRESULT hr = S_OK;
+        std::shared_ptr<Scene> scene = heightMap
+            ? std::make_shared<Scene>(heightMap, bStreaming ? &streamingDesc : nullptr, this)
+            : std::make_shared<Scene>(filePath, bStreaming ? &streamingDesc : nullptr, this);
+        hr = scene->GetLoadStatus();
+
+        if (SUCCEEDED(hr) && !m_bCancelRequested && prepare)
+        {
+            ReportProgress(eSceneLoadStage::PREPARING, 0.7f);
+            hr = prepare(*scene);
+        }
+
+        if (SUCCEEDED(hr) && !m_bCancelRequested)
+        {
+            ReportProgress(eSceneLoadStage::PREPARING, 0.75f);
+            hr = scene->LoadModels();
+        }
+
+        if (SUCCEEDED(hr) && !m_bCancelRequested)
+        {
+            ReportProgress(eSceneLoadStage::COMPILING, 0.8f);
+            hr = scene->CompileShaders();
+        }
+
+        if (SUCCEEDED(hr) && !m_bCancelRequested)
+        {
+            m_scene = std::move(scene);
+        }
+        if (SUCCEEDED(hrCom))
+        {
+            CoUninitialize();
+        }
+        m_hrWorkerStatus = hr;
+        m_bWorkerDone = TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneLoadHandle::finish
+
+      Summary:  Ends the load in its final stage and calls the progress
+                and completion callbacks
+
+      Args:     eSceneLoadStage stage
+                  COMPLETED, CANCELED or FAILED
+                HRESULT hr
+                  Status of the load
+
+      Modifies: [m_stage, m_progress, m_hrStatus, m_scene].
+
+      Returns:  HRESULT
+                  The status of the load
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneLoadHandle::finish(_In_ eSceneLoadStage stage, _In_ HRESULT hr)
+    {
+        if (stage != eSceneLoadStage::COMPLETED)
+        {
+            m_scene.reset();
+        }
+
+        FLOAT progress;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stage = stage;
+            if (stage == eSceneLoadStage::COMPLETED)
+            {
+                m_progress = 1.0f;
+            }
+            progress = m_progress;
+            m_hrStatus = hr;
+        }
+
+        if (m_callbacks.OnProgress)
+        {
+            m_callbacks.OnProgress(stage, progress);
+        }
+        if (m_callbacks.OnCompleted)
+        {
+            m_callbacks.OnCompleted(hr, m_scene);
+        }
+
+        return hr;
+    }
+}
\ No newline at end of file
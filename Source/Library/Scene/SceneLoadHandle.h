@@ -0,0 +1,146 @@
+/*+===================================================================
+  File:      SCENELOADHANDLE.H
+
+  Summary:   SceneLoadHandle header file contains declarations of
+             SceneLoadHandle class that loads a scene on a worker
+             thread and reports its progress.
+
+  Classes: SceneLoadHandle
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Scene/Scene.h"
+
+namespace library
+{
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+        Enum:     eSceneLoadStage
+
+        Summary:  Stages of an asynchronous scene load, in order. The
+                  last three are final
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eSceneLoadStage : UINT
+    {
+        QUEUED = 0u,
+        PARSING,
+        BUILDING,
+        PREPARING,
+        COMPILING,
+        UPLOADING,
+        COMPLETED,
+        CANCELED,
+        FAILED,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   SceneLoadCallbacks
+
+        Summary:  Callbacks of an asynchronous scene load, both called
+                  on the thread polling the handle. OnProgress receives
+                  the stage and the fraction done in [0, 1], and
+                  OnCompleted the status once the load is over, with
+                  the scene unless it failed or was canceled
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct SceneLoadCallbacks
+    {
+        std::function<void(eSceneLoadStage, FLOAT)> OnProgress;
+        std::function<void(HRESULT, const std::shared_ptr<Scene>&)> OnCompleted;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    SceneLoadHandle
+
+      Summary:  Handle to a scene being loaded. A worker thread parses
+                the height map, unless it was built in memory, and
+                builds the voxels, runs the prepare
+                callback that adds the shaders, lights and renderables,
+                imports the models, decodes their textures and compiles
+                the shaders. Everything that needs the device is left
+                to Poll, which the thread owning the
+                immediate context calls once per frame: it forwards the
+                progress, initializes the scene once the worker is done
+                and reports the completion. Cancel stops the worker at
+                the next stage
+
+      Methods:  Start
+                  Starts loading a scene on a worker thread
+                Poll
+                  Reports progress and finishes the load on the
+                  calling thread
+                Cancel
+                  Asks the load to stop
+                ReportProgress
+                  Records the stage and progress of the worker
+                IsCancelRequested
+                  Returns whether the load was asked to stop
+                IsDone
+                  Returns whether the load is over
+                GetStage
+                  Returns the current stage
+                GetProgress
+                  Returns the fraction of the load done
+                GetStatus
+                  Returns the status of the load
+                GetScene
+                  Returns the loaded scene
+                run
+                  Loads the scene on the worker thread
+                finish
+                  Ends the load and calls the completion callback
+                SceneLoadHandle
+                  Constructor.
+                ~SceneLoadHandle
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class SceneLoadHandle
+    {
+    public:
+        static std::shared_ptr<SceneLoadHandle> Start(_In_ const std::filesystem::path& filePath, _In_opt_ const VoxelStreamingDesc* pStreamingDesc, _In_ std::function<HRESULT(Scene&)> prepare, _In_ SceneLoadCallbacks callbacks);
+        static std::shared_ptr<SceneLoadHandle> Start(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_opt_ const VoxelStreamingDesc* pStreamingDesc, _In_ std::function<HRESULT(Scene&)> prepare, _In_ SceneLoadCallbacks callbacks);
+
+        SceneLoadHandle(_In_ SceneLoadCallbacks callbacks);
+        SceneLoadHandle(const SceneLoadHandle& other) = delete;
+        SceneLoadHandle(SceneLoadHandle&& other) = delete;
+        SceneLoadHandle& operator=(const SceneLoadHandle& other) = delete;
+        SceneLoadHandle& operator=(SceneLoadHandle&& other) = delete;
+        ~SceneLoadHandle();
+
+        HRESULT Poll(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+        void Cancel();
+        void ReportProgress(_In_ eSceneLoadStage stage, _In_ FLOAT progress);
+
+        BOOL IsCancelRequested() const;
+        BOOL IsDone() const;
+        eSceneLoadStage GetStage() const;
+        FLOAT GetProgress() const;
+        HRESULT GetStatus() const;
+        const std::shared_ptr<Scene>& GetScene() const;
+
+    private:
+        void run(_In_ const std::filesystem::path& filePath, _In_ const std::shared_ptr<HeightMap>& heightMap, _In_ BOOL bStreaming, _In_ const VoxelStreamingDesc& streamingDesc, _In_ const std::function<HRESULT(Scene&)>& prepare);
+        HRESULT finish(_In_ eSceneLoadStage stage, _In_ HRESULT hr);
+
+    private:
+        SceneLoadCallbacks m_callbacks;
+        std::thread m_worker;
+        std::atomic<BOOL> m_bCancelRequested;
+        std::atomic<BOOL> m_bWorkerDone;
+        mutable std::mutex m_mutex;
+        eSceneLoadStage m_stage;
+        FLOAT m_progress;
+        HRESULT m_hrWorkerStatus;
+        HRESULT m_hrStatus;
+        eSceneLoadStage m_reportedStage;
+        FLOAT m_reportedProgress;
+        std::shared_ptr<Scene> m_scene;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,712 @@
+#include "Scene/SceneSnapshot.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::HashBytes
+
+      Summary:  Folds bytes into a 64-bit FNV-1a hash. Chaining calls
+                through ullHash hashes several inputs as one
+
+      Args:     const void* pData
+                  Bytes to hash
+                size_t uSize
+                  Number of bytes
+                UINT64 ullHash
+                  Hash to continue from
+
+      Returns:  UINT64
+                  Hash of the bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 SceneSnapshot::HashBytes(_In_reads_bytes_(uSize) const void* pData, _In_ size_t uSize, _In_ UINT64 ullHash)
+    {
+        static constexpr const UINT64 FNV_PRIME = 0x00000100000001B3ull;
+
+        const BYTE* pBytes = static_cast<const BYTE*>(pData);
+        for (size_t i = 0u; i < uSize; ++i)
+        {
+            ullHash ^= pBytes[i];
+            ullHash *= FNV_PRIME;
+        }
+        return ullHash;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::HashTerrainDesc
+
+      Summary:  Folds the fields of a terrain that shape the generated
+                height map into the hash. The tile size and the number
+                of workers are left out, since the output is the same
+                for any of them
+
+      Args:     const TerrainDesc& terrainDesc
+                  Terrain to hash
+                UINT64 ullHash
+                  Hash to continue from
+
+      Returns:  UINT64
+                  Hash of the terrain
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 SceneSnapshot::HashTerrainDesc(_In_ const TerrainDesc& terrainDesc, _In_ UINT64 ullHash)
+    {
+        ullHash = HashBytes(&terrainDesc.uWidth, sizeof(terrainDesc.uWidth), ullHash);
+        ullHash = HashBytes(&terrainDesc.uHeight, sizeof(terrainDesc.uHeight), ullHash);
+        ullHash = HashBytes(&terrainDesc.uDepth, sizeof(terrainDesc.uDepth), ullHash);
+        ullHash = HashBytes(&terrainDesc.uNumOctaves, sizeof(terrainDesc.uNumOctaves), ullHash);
+        ullHash = HashBytes(&terrainDesc.uNoiseDepth, sizeof(terrainDesc.uNoiseDepth), ullHash);
+        ullHash = HashBytes(&terrainDesc.Frequency, sizeof(terrainDesc.Frequency), ullHash);
+        return HashBytes(&terrainDesc.MoistureOffset, sizeof(terrainDesc.MoistureOffset), ullHash);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::SceneSnapshot
+
+      Summary:  Constructor
+
+      Modifies: [m_hFile, m_hFileMapping, m_pView, m_ullFileBytes,
+                 m_pHeader, m_pPalette, m_pColumns, m_apVoxels,
+                 m_models, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    SceneSnapshot::SceneSnapshot()
+        : m_hFile(INVALID_HANDLE_VALUE)
+        , m_hFileMapping(nullptr)
+        , m_pView(nullptr)
+        , m_ullFileBytes(0ull)
+        , m_pHeader(nullptr)
+        , m_pPalette(nullptr)
+        , m_pColumns(nullptr)
+        , m_apVoxels()
+        , m_models()
+        , m_stats()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::~SceneSnapshot
+
+      Summary:  Destructor. Unmaps the snapshot file if it is mapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    SceneSnapshot::~SceneSnapshot()
+    {
+        reset();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::Save
+
+      Summary:  Writes the height map, the instances of every voxel and
+                the geometry of the static models. The header is
+                written last with the final size, so a write that stops
+                midway leaves a file that Load rejects
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the snapshot file
+                UINT64 ullInputHash
+                  Hash of the inputs the scene was built from
+                const HeightMap& heightMap
+                  Height map of the scene
+                const std::vector<std::shared_ptr<Voxel>>& aVoxels
+                  Instanced voxels of the scene
+                const std::unordered_map<std::wstring, std::shared_ptr<Model>>& models
+                  Models of the scene, already initialized
+
+      Modifies: [m_stats].
+
+      Returns:  HRESULT
+                  Status code, E_NOTIMPL if the voxels hold packed
+                  instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneSnapshot::Save(
+        _In_ const std::filesystem::path& filePath,
+        _In_ UINT64 ullInputHash,
+        _In_ const HeightMap& heightMap,
+        _In_ const std::vector<std::shared_ptr<Voxel>>& aVoxels,
+        _In_ const std::unordered_map<std::wstring, std::shared_ptr<Model>>& models
+    )
+    {
+        BenchmarkTimer timer;
+
+        // Packed instances are rebuilt from the height map instead
+        for (const std::shared_ptr<Voxel>& voxel : aVoxels)
+        {
+            if (voxel->GetInstanceStride() != sizeof(InstanceData))
+            {
+                return E_NOTIMPL;
+            }
+        }
+
+        std::ofstream outputFile(filePath, std::ios::binary | std::ios::trunc);
+        if (!outputFile.is_open())
+        {
+            return E_FAIL;
+        }
+
+        SceneSnapshotHeader header =
+        {
+            .uMagic = FILE_MAGIC,
+            .uVersion = FILE_VERSION,
+            .ullInputHash = ullInputHash,
+            .ullFileBytes = 0ull,
+            .uWidth = heightMap.GetWidth(),
+            .uHeight = heightMap.GetHeight(),
+            .uDepth = heightMap.GetDepth(),
+            .uNumColors = static_cast<UINT>(heightMap.GetPalette().size()),
+            .uNumVoxels = static_cast<UINT>(aVoxels.size()),
+            .uNumModels = 0u
+        };
+        writeAligned(outputFile, &header, sizeof(header));
+
+        writeAligned(outputFile, heightMap.GetPalette().data(), heightMap.GetPalette().size() * sizeof(XMFLOAT4));
+        writeAligned(outputFile, heightMap.GetColumns(), heightMap.GetNumColumns() * sizeof(HeightMapColumn));
+
+        m_stats.ullNumInstances = 0ull;
+        for (const std::shared_ptr<Voxel>& voxel : aVoxels)
+        {
+            const std::vector<InstanceData>& aInstanceData = voxel->GetInstanceData();
+            SceneSnapshotVoxel record =
+            {
+                .Color = voxel->GetOutputColor(),
+                .ullNumInstances = aInstanceData.size(),
+                .ullReserved = 0ull
+            };
+            writeAligned(outputFile, &record, sizeof(record));
+            writeAligned(outputFile, aInstanceData.data(), aInstanceData.size() * sizeof(InstanceData));
+            m_stats.ullNumInstances += aInstanceData.size();
+        }
+
+        for (auto it = models.begin(); it != models.end(); ++it)
+        {
+            ModelGeometry geometry;
+            if (it->second->ExportGeometry(geometry) != S_OK)
+            {
+                continue;
+            }
+
+            std::wstring szPath = it->second->GetFilePath().wstring();
+            SceneSnapshotModel record =
+            {
+                .llWriteTime = 0ll,
+                .ullFileBytes = 0ull,
+                .uPathLength = static_cast<UINT>(szPath.size()),
+                .uNumVertices = static_cast<UINT>(geometry.aVertices.size()),
+                .uNumNormals = static_cast<UINT>(geometry.aNormalData.size()),
+                .uNumIndices = static_cast<UINT>(geometry.aIndices.size()),
+                .uNumMeshes = static_cast<UINT>(geometry.aMeshes.size()),
+                .uNumMaterials = static_cast<UINT>(geometry.aMaterials.size()),
+                .bHasNormalMap = geometry.bHasNormalMap,
+                .uReserved = 0u
+            };
+            if (!getFileStamp(it->second->GetFilePath(), record.llWriteTime, record.ullFileBytes))
+            {
+                continue;
+            }
+
+            writeAligned(outputFile, &record, sizeof(record));
+            writeAligned(outputFile, szPath.c_str(), record.uPathLength * sizeof(WCHAR));
+            writeAligned(outputFile, geometry.aVertices.data(), geometry.aVertices.size() * sizeof(SimpleVertex));
+            writeAligned(outputFile, geometry.aAnimationData.data(), geometry.aAnimationData.size() * sizeof(AnimationData));
+            writeAligned(outputFile, geometry.aNormalData.data(), geometry.aNormalData.size() * sizeof(NormalData));
+            writeAligned(outputFile, geometry.aIndices.data(), geometry.aIndices.size() * sizeof(WORD));
+            writeAligned(outputFile, geometry.aMeshes.data(), geometry.aMeshes.size() * sizeof(ModelMeshEntry));
+            for (const ModelMaterialTextures& textures : geometry.aMaterials)
+            {
+                for (const std::filesystem::path* pPath : { &textures.DiffusePath, &textures.SpecularPath, &textures.NormalPath })
+                {
+                    std::wstring szTexturePath = pPath->wstring();
+                    UINT uLength = static_cast<UINT>(szTexturePath.size());
+                    writeAligned(outputFile, &uLength, sizeof(uLength));
+                    writeAligned(outputFile, szTexturePath.c_str(), uLength * sizeof(WCHAR));
+                }
+            }
+            ++header.uNumModels;
+        }
+
+        header.ullFileBytes = static_cast<UINT64>(outputFile.tellp());
+        outputFile.seekp(0);
+        outputFile.write(reinterpret_cast<const CHAR*>(&header), sizeof(header));
+        if (outputFile.fail())
+        {
+            return E_FAIL;
+        }
+
+        FLOAT milliseconds = timer.GetMilliseconds();
+        m_stats.ullFileBytes = header.ullFileBytes;
+        m_stats.uNumVoxels = header.uNumVoxels;
+        m_stats.uNumModels = header.uNumModels;
+        m_stats.Milliseconds = milliseconds;
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"SceneSnapshot: saved %u voxels (%llu instances) and %u models, %.2f MB in %.2f ms\n",
+            m_stats.uNumVoxels,
+            m_stats.ullNumInstances,
+            m_stats.uNumModels,
+            static_cast<double>(m_stats.ullFileBytes) / (1024.0 * 1024.0),
+            m_stats.Milliseconds
+        );
+        OutputDebugString(szReport);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::Load
+
+      Summary:  Maps a snapshot file and checks it against the inputs.
+                The instances stay in the mapping until the voxels are
+                restored, the model geometry is read right away
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the snapshot file
+                UINT64 ullInputHash
+                  Hash of the inputs the scene would be built from
+
+      Modifies: [m_hFile, m_hFileMapping, m_pView, m_ullFileBytes,
+                 m_pHeader, m_pPalette, m_pColumns, m_apVoxels,
+                 m_models, m_stats].
+
+      Returns:  HRESULT
+                  S_OK if the snapshot can be used, S_FALSE if there is
+                  no snapshot or it was built from other inputs, an
+                  error if the file is damaged
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneSnapshot::Load(_In_ const std::filesystem::path& filePath, _In_ UINT64 ullInputHash)
+    {
+        reset();
+
+        BenchmarkTimer timer;
+
+        m_hFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+        {
+            DWORD dwError = GetLastError();
+            reset();
+            return dwError == ERROR_FILE_NOT_FOUND || dwError == ERROR_PATH_NOT_FOUND ? S_FALSE : HRESULT_FROM_WIN32(dwError);
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(m_hFile, &fileSize))
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            reset();
+            return hr;
+        }
+        if (static_cast<UINT64>(fileSize.QuadPart) < sizeof(SceneSnapshotHeader))
+        {
+            reset();
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        m_hFileMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+        if (!m_hFileMapping)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            reset();
+            return hr;
+        }
+
+        m_pView = MapViewOfFile(m_hFileMapping, FILE_MAP_READ, 0u, 0u, 0u);
+        if (!m_pView)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            reset();
+            return hr;
+        }
+        m_ullFileBytes = static_cast<UINT64>(fileSize.QuadPart);
+
+        m_pHeader = static_cast<const SceneSnapshotHeader*>(m_pView);
+        if (m_pHeader->uMagic != FILE_MAGIC || m_pHeader->uVersion != FILE_VERSION || m_pHeader->ullInputHash != ullInputHash)
+        {
+            reset();
+            return S_FALSE;
+        }
+        if (m_pHeader->ullFileBytes != m_ullFileBytes)
+        {
+            reset();
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        UINT64 ullOffset = sizeof(SceneSnapshotHeader);
+        m_pPalette = reinterpret_cast<const XMFLOAT4*>(readAligned(ullOffset, static_cast<UINT64>(m_pHeader->uNumColors) * sizeof(XMFLOAT4)));
+        m_pColumns = reinterpret_cast<const HeightMapColumn*>(readAligned(ullOffset, static_cast<UINT64>(m_pHeader->uWidth) * m_pHeader->uDepth * sizeof(HeightMapColumn)));
+        if (!m_pPalette || !m_pColumns)
+        {
+            reset();
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        m_stats.ullNumInstances = 0ull;
+        m_apVoxels.reserve(m_pHeader->uNumVoxels);
+        for (UINT i = 0u; i < m_pHeader->uNumVoxels; ++i)
+        {
+            const SceneSnapshotVoxel* pVoxel = reinterpret_cast<const SceneSnapshotVoxel*>(readAligned(ullOffset, sizeof(SceneSnapshotVoxel)));
+            if (!pVoxel || pVoxel->ullNumInstances > (m_ullFileBytes - ullOffset) / sizeof(InstanceData) || !readAligned(ullOffset, pVoxel->ullNumInstances * sizeof(InstanceData)))
+            {
+                reset();
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+            m_apVoxels.push_back(pVoxel);
+            m_stats.ullNumInstances += pVoxel->ullNumInstances;
+        }
+
+        for (UINT i = 0u; i < m_pHeader->uNumModels; ++i)
+        {
+            HRESULT hr = parseModel(ullOffset);
+            if (FAILED(hr))
+            {
+                reset();
+                return hr;
+            }
+        }
+
+        FLOAT milliseconds = timer.GetMilliseconds();
+        m_stats.ullFileBytes = m_ullFileBytes;
+        m_stats.uNumVoxels = m_pHeader->uNumVoxels;
+        m_stats.uNumModels = m_pHeader->uNumModels;
+        m_stats.Milliseconds = milliseconds;
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"SceneSnapshot: mapped %u voxels (%llu instances) and %u models, %.2f MB in %.2f ms\n",
+            m_stats.uNumVoxels,
+            m_stats.ullNumInstances,
+            m_stats.uNumModels,
+            static_cast<double>(m_stats.ullFileBytes) / (1024.0 * 1024.0),
+            m_stats.Milliseconds
+        );
+        OutputDebugString(szReport);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::RestoreHeightMap
+
+      Summary:  Fills a height map with the columns and palette of the
+                snapshot
+
+      Args:     HeightMap& heightMap
+                  Height map to fill
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneSnapshot::RestoreHeightMap(_Inout_ HeightMap& heightMap) const
+    {
+        if (!m_pHeader)
+        {
+            return E_FAIL;
+        }
+
+        std::vector<XMFLOAT4> aPalette(m_pPalette, m_pPalette + m_pHeader->uNumColors);
+        std::vector<HeightMapColumn> aColumns(m_pColumns, m_pColumns + static_cast<size_t>(m_pHeader->uWidth) * m_pHeader->uDepth);
+        return heightMap.Assign(m_pHeader->uWidth, m_pHeader->uHeight, m_pHeader->uDepth, aPalette, std::move(aColumns));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::RestoreVoxels
+
+      Summary:  Creates one voxel per record of the snapshot, its
+                instances copied out of the mapping
+
+      Args:     std::vector<std::shared_ptr<Voxel>>& aVoxels
+                  Receives the voxels
+                SceneVoxelStats& voxelStats
+                  Receives the number and size of the instances
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneSnapshot::RestoreVoxels(_Inout_ std::vector<std::shared_ptr<Voxel>>& aVoxels, _Inout_ SceneVoxelStats& voxelStats) const
+    {
+        if (!m_pHeader)
+        {
+            return E_FAIL;
+        }
+
+        aVoxels.clear();
+        aVoxels.reserve(m_apVoxels.size());
+        for (const SceneSnapshotVoxel* pVoxel : m_apVoxels)
+        {
+            // Instances follow their record, which keeps them aligned
+            const InstanceData* pInstances = reinterpret_cast<const InstanceData*>(pVoxel + 1);
+            std::vector<InstanceData> aInstanceData(pInstances, pInstances + pVoxel->ullNumInstances);
+            aVoxels.push_back(std::make_shared<Voxel>(std::move(aInstanceData), pVoxel->Color));
+        }
+
+        voxelStats.ullNumInstances = m_stats.ullNumInstances;
+        voxelStats.ullInstanceBytes = m_stats.ullNumInstances * sizeof(InstanceData);
+        voxelStats.ullEstimatedPeakBuildBytes = 0ull;
+        voxelStats.InstanceBuildMilliseconds = 0.0f;
+        voxelStats.bCollapsedRuns = FALSE;
+        voxelStats.bPackedInstances = FALSE;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::RestoreModel
+
+      Summary:  Hands the saved geometry to a model whose file has not
+                changed since the snapshot was written. Each record is
+                handed out once
+
+      Args:     Model& model
+                  Model to restore
+
+      Modifies: [m_models].
+
+      Returns:  HRESULT
+                  S_OK if the model was restored, S_FALSE if the
+                  snapshot has no record of it, E_CHANGED_STATE if its
+                  file changed since the snapshot was written
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneSnapshot::RestoreModel(_Inout_ Model& model)
+    {
+        auto it = m_models.find(model.GetFilePath().wstring());
+        if (it == m_models.end())
+        {
+            return S_FALSE;
+        }
+
+        INT64 llWriteTime = 0ll;
+        UINT64 ullFileBytes = 0ull;
+        if (!getFileStamp(model.GetFilePath(), llWriteTime, ullFileBytes) ||
+            llWriteTime != it->second.llWriteTime ||
+            ullFileBytes != it->second.ullFileBytes)
+        {
+            m_models.erase(it);
+            return E_CHANGED_STATE;
+        }
+
+        model.RestoreGeometry(std::move(it->second.Geometry));
+        m_models.erase(it);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::IsLoaded
+
+      Summary:  Returns whether a snapshot is mapped
+
+      Returns:  BOOL
+                  TRUE if a snapshot is mapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL SceneSnapshot::IsLoaded() const
+    {
+        return m_pHeader != nullptr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::GetInputHash
+
+      Summary:  Returns the input hash of the mapped snapshot
+
+      Returns:  UINT64
+                  Input hash, 0 if no snapshot is mapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 SceneSnapshot::GetInputHash() const
+    {
+        return m_pHeader ? m_pHeader->ullInputHash : 0ull;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::GetStats
+
+      Summary:  Returns the statistics of the last save or load
+
+      Returns:  const SceneSnapshotStats&
+                  Statistics of the snapshot
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const SceneSnapshotStats& SceneSnapshot::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::getFileStamp
+
+      Summary:  Reads the last write time and the size of a file
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the file
+                INT64& llWriteTime
+                  Receives the last write time
+                UINT64& ullFileBytes
+                  Receives the size of the file
+
+      Returns:  BOOL
+                  TRUE if the file exists
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL SceneSnapshot::getFileStamp(_In_ const std::filesystem::path& filePath, _Out_ INT64& llWriteTime, _Out_ UINT64& ullFileBytes)
+    {
+        std::error_code error;
+        llWriteTime = static_cast<INT64>(std::filesystem::last_write_time(filePath, error).time_since_epoch().count());
+        if (error)
+        {
+            ullFileBytes = 0ull;
+            return FALSE;
+        }
+        ullFileBytes = static_cast<UINT64>(std::filesystem::file_size(filePath, error));
+        return !error;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::writeAligned
+
+      Summary:  Writes bytes followed by zeros up to the next multiple
+                of 16 bytes
+
+      Args:     std::ofstream& outputFile
+                  File to write to
+                const void* pData
+                  Bytes to write
+                UINT64 ullSize
+                  Number of bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void SceneSnapshot::writeAligned(_Inout_ std::ofstream& outputFile, _In_reads_bytes_(ullSize) const void* pData, _In_ UINT64 ullSize)
+    {
+        const CHAR aPadding[16] = { 0, };
+
+        if (ullSize > 0ull)
+        {
+            outputFile.write(static_cast<const CHAR*>(pData), static_cast<std::streamsize>(ullSize));
+        }
+        outputFile.write(aPadding, static_cast<std::streamsize>(((ullSize + 15ull) & ~15ull) - ullSize));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::readAligned
+
+      Summary:  Returns the bytes at an offset of the mapping and moves
+                the offset past them and their padding
+
+      Args:     UINT64& ullOffset
+                  Offset of the bytes, moved past them
+                UINT64 ullSize
+                  Number of bytes
+
+      Returns:  const BYTE*
+                  Bytes in the mapping, nullptr if they run past the
+                  end of the file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const BYTE* SceneSnapshot::readAligned(_Inout_ UINT64& ullOffset, _In_ UINT64 ullSize) const
+    {
+        if (ullOffset > m_ullFileBytes || ullSize > m_ullFileBytes - ullOffset)
+        {
+            return nullptr;
+        }
+
+        const BYTE* pData = static_cast<const BYTE*>(m_pView) + ullOffset;
+        ullOffset = std::min<UINT64>(ullOffset + ((ullSize + 15ull) & ~15ull), m_ullFileBytes);
+        return pData;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::parseModel
+
+      Summary:  Reads the record of a model and its geometry
+
+      Args:     UINT64& ullOffset
+                  Offset of the record, moved past the model
+
+      Modifies: [m_models].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT SceneSnapshot::parseModel(_Inout_ UINT64& ullOffset)
+    {
+        const SceneSnapshotModel* pRecord = reinterpret_cast<const SceneSnapshotModel*>(readAligned(ullOffset, sizeof(SceneSnapshotModel)));
+        if (!pRecord)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        const WCHAR* pszPath = reinterpret_cast<const WCHAR*>(readAligned(ullOffset, static_cast<UINT64>(pRecord->uPathLength) * sizeof(WCHAR)));
+        const SimpleVertex* pVertices = reinterpret_cast<const SimpleVertex*>(readAligned(ullOffset, static_cast<UINT64>(pRecord->uNumVertices) * sizeof(SimpleVertex)));
+        const AnimationData* pAnimationData = reinterpret_cast<const AnimationData*>(readAligned(ullOffset, static_cast<UINT64>(pRecord->uNumVertices) * sizeof(AnimationData)));
+        const NormalData* pNormalData = reinterpret_cast<const NormalData*>(readAligned(ullOffset, static_cast<UINT64>(pRecord->uNumNormals) * sizeof(NormalData)));
+        const WORD* pIndices = reinterpret_cast<const WORD*>(readAligned(ullOffset, static_cast<UINT64>(pRecord->uNumIndices) * sizeof(WORD)));
+        const ModelMeshEntry* pMeshes = reinterpret_cast<const ModelMeshEntry*>(readAligned(ullOffset, static_cast<UINT64>(pRecord->uNumMeshes) * sizeof(ModelMeshEntry)));
+        if (!pszPath || !pVertices || !pAnimationData || !pNormalData || !pIndices || !pMeshes)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        ModelEntry entry =
+        {
+            .llWriteTime = pRecord->llWriteTime,
+            .ullFileBytes = pRecord->ullFileBytes,
+            .Geometry =
+            {
+                .aVertices = std::vector<SimpleVertex>(pVertices, pVertices + pRecord->uNumVertices),
+                .aAnimationData = std::vector<AnimationData>(pAnimationData, pAnimationData + pRecord->uNumVertices),
+                .aNormalData = std::vector<NormalData>(pNormalData, pNormalData + pRecord->uNumNormals),
+                .aIndices = std::vector<WORD>(pIndices, pIndices + pRecord->uNumIndices),
+                .aMeshes = std::vector<ModelMeshEntry>(pMeshes, pMeshes + pRecord->uNumMeshes),
+                .aMaterials = std::vector<ModelMaterialTextures>(pRecord->uNumMaterials),
+                .bHasNormalMap = pRecord->bHasNormalMap
+            }
+        };
+
+        for (ModelMaterialTextures& textures : entry.Geometry.aMaterials)
+        {
+            for (std::filesystem::path* pPath : { &textures.DiffusePath, &textures.SpecularPath, &textures.NormalPath })
+            {
+                const UINT* puLength = reinterpret_cast<const UINT*>(readAligned(ullOffset, sizeof(UINT)));
+                if (!puLength)
+                {
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+                const WCHAR* pszTexturePath = reinterpret_cast<const WCHAR*>(readAligned(ullOffset, static_cast<UINT64>(*puLength) * sizeof(WCHAR)));
+                if (!pszTexturePath)
+                {
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+                *pPath = std::wstring(pszTexturePath, *puLength);
+            }
+        }
+
+        m_models.insert_or_assign(std::wstring(pszPath, pRecord->uPathLength), std::move(entry));
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SceneSnapshot::reset
+
+      Summary:  Unmaps the snapshot file and forgets what was read
+
+      Modifies: [m_hFile, m_hFileMapping, m_pView, m_ullFileBytes,
+                 m_pHeader, m_pPalette, m_pColumns, m_apVoxels,
+                 m_models].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void SceneSnapshot::reset()
+    {
+        if (m_pView)
+        {
+            UnmapViewOfFile(m_pView);
+            m_pView = nullptr;
+        }
+        if (m_hFileMapping)
+        {
+            CloseHandle(m_hFileMapping);
+            m_hFileMapping = nullptr;
+        }
+        if (m_hFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_hFile);
+            m_hFile = INVALID_HANDLE_VALUE;
+        }
+        m_ullFileBytes = 0ull;
+        m_pHeader = nullptr;
+        m_pPalette = nullptr;
+        m_pColumns = nullptr;
+        m_apVoxels.clear();
+        m_models.clear();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+/*+===================================================================
+  File:      SCENESNAPSHOT.H
+
+  Summary:   SceneSnapshot header file contains declarations of
+             SceneSnapshot class that caches the built CPU side state
+             of a scene in a single binary file.
+
+  Classes: SceneSnapshot
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <fstream>
+
+#include "Game/Benchmark.h"
+#include "Model/Model.h"
+#include "Scene/HeightMap.h"
+#include "Scene/Scene.h"
+#include "Scene/TerrainGenerator.h"
+#include "Scene/Voxel.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   SceneSnapshotHeader
+
+        Summary:  Header at the start of a snapshot file. The file is
+                  only used when its version and input hash match and
+                  its size is the one recorded, so a stale or truncated
+                  file falls back to building the scene
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct SceneSnapshotHeader
+    {
+        DWORD uMagic;
+        DWORD uVersion;
+        UINT64 ullInputHash;
+        UINT64 ullFileBytes;
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+        UINT uNumColors;
+        UINT uNumVoxels;
+        UINT uNumModels;
+    };
+    static_assert(sizeof(SceneSnapshotHeader) == 48u);
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   SceneSnapshotVoxel
+
+        Summary:  Record of one instanced voxel, followed in the file by
+                  its instances
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct SceneSnapshotVoxel
+    {
+        XMFLOAT4 Color;
+        UINT64 ullNumInstances;
+        UINT64 ullReserved;
+    };
+    static_assert(sizeof(SceneSnapshotVoxel) == 32u);
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   SceneSnapshotModel
+
+        Summary:  Record of one static model, followed in the file by
+                  its path, vertices, bone weights, tangent frames,
+                  indices, meshes and texture paths. The write time and
+                  size of the model file tell whether the record is
+                  still current
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct SceneSnapshotModel
+    {
+        INT64 llWriteTime;
+        UINT64 ullFileBytes;
+        UINT uPathLength;
+        UINT uNumVertices;
+        UINT uNumNormals;
+        UINT uNumIndices;
+        UINT uNumMeshes;
+        UINT uNumMaterials;
+        BOOL bHasNormalMap;
+        UINT uReserved;
+    };
+    static_assert(sizeof(SceneSnapshotModel) == 48u);
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   SceneSnapshotStats
+
+        Summary:  Size of the last snapshot saved or loaded, what it
+                  holds, and the time spent writing or reading it
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct SceneSnapshotStats
+    {
+        UINT64 ullFileBytes;
+        UINT64 ullNumInstances;
+        UINT uNumVoxels;
+        UINT uNumModels;
+        FLOAT Milliseconds;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    SceneSnapshot
+
+      Summary:  Cache of a built scene: the height map, the instances of
+                every voxel, and the geometry and texture paths of the
+                static models. The file is memory-mapped on load and
+                the instances are copied straight out of the mapping,
+                so a warm start skips the terrain generation, the
+                instance build and the model import. Every array is
+                aligned to 16 bytes in the file
+
+      Methods:  HashBytes
+                  Folds bytes into a 64-bit FNV-1a hash
+                HashTerrainDesc
+                  Folds the fields of a terrain that shape its output
+                  into the hash
+                Save
+                  Writes the state of a built scene
+                Load
+                  Maps a snapshot file and checks it against the
+                  inputs
+                RestoreHeightMap
+                  Fills a height map from the snapshot
+                RestoreVoxels
+                  Creates the voxels from the snapshot
+                RestoreModel
+                  Hands the saved geometry to a model
+                IsLoaded
+                  Returns whether a snapshot is mapped
+                GetInputHash
+                  Returns the input hash of the snapshot
+                GetStats
+                  Returns the statistics of the last save or load
+                SceneSnapshot
+                  Constructor.
+                ~SceneSnapshot
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class SceneSnapshot
+    {
+    public:
+        static constexpr const DWORD FILE_MAGIC = 0x50414E53u; // "SNAP"
+        static constexpr const DWORD FILE_VERSION = 1u;
+        static constexpr const UINT64 HASH_SEED = 0xCBF29CE484222325ull;
+
+        static UINT64 HashBytes(_In_reads_bytes_(uSize) const void* pData, _In_ size_t uSize, _In_ UINT64 ullHash = HASH_SEED);
+        static UINT64 HashTerrainDesc(_In_ const TerrainDesc& terrainDesc, _In_ UINT64 ullHash = HASH_SEED);
+
+        SceneSnapshot();
+        SceneSnapshot(const SceneSnapshot& other) = delete;
+        SceneSnapshot(SceneSnapshot&& other) = delete;
+        SceneSnapshot& operator=(const SceneSnapshot& other) = delete;
+        SceneSnapshot& operator=(SceneSnapshot&& other) = delete;
+        ~SceneSnapshot();
+
+        HRESULT Save(
+            _In_ const std::filesystem::path& filePath,
+            _In_ UINT64 ullInputHash,
+            _In_ const HeightMap& heightMap,
+            _In_ const std::vector<std::shared_ptr<Voxel>>& aVoxels,
+            _In_ const std::unordered_map<std::wstring, std::shared_ptr<Model>>& models
+        );
+        HRESULT Load(_In_ const std::filesystem::path& filePath, _In_ UINT64 ullInputHash);
+
+        HRESULT RestoreHeightMap(_Inout_ HeightMap& heightMap) const;
+        HRESULT RestoreVoxels(_Inout_ std::vector<std::shared_ptr<Voxel>>& aVoxels, _Inout_ SceneVoxelStats& voxelStats) const;
+        HRESULT RestoreModel(_Inout_ Model& model);
+
+        BOOL IsLoaded() const;
+        UINT64 GetInputHash() const;
+        const SceneSnapshotStats& GetStats() const;
+
+    private:
+        static BOOL getFileStamp(_In_ const std::filesystem::path& filePath, _Out_ INT64& llWriteTime, _Out_ UINT64& ullFileBytes);
+        static void writeAligned(_Inout_ std::ofstream& outputFile, _In_reads_bytes_(ullSize) const void* pData, _In_ UINT64 ullSize);
+
+        const BYTE* readAligned(_Inout_ UINT64& ullOffset, _In_ UINT64 ullSize) const;
+        HRESULT parseModel(_Inout_ UINT64& ullOffset);
+        void reset();
+
+    private:
+        struct ModelEntry
+        {
+            INT64 llWriteTime;
+            UINT64 ullFileBytes;
+            ModelGeometry Geometry;
+        };
+
+        HANDLE m_hFile;
+        HANDLE m_hFileMapping;
+        LPVOID m_pView;
+        UINT64 m_ullFileBytes;
+        const SceneSnapshotHeader* m_pHeader;
+        const XMFLOAT4* m_pPalette;
+        const HeightMapColumn* m_pColumns;
+        std::vector<const SceneSnapshotVoxel*> m_apVoxels;
+        std::unordered_map<std::wstring, ModelEntry> m_models;
+        SceneSnapshotStats m_stats;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,307 @@
+#include "Scene/TerrainGenerator.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::ClassifyBiome
+
+      Summary:  Returns the block type of a column. The height picks a
+                row of the biome table and the moisture a block type
+                in it, both by counting thresholds instead of walking
+                a chain of branches
+
+      Args:     FLOAT height
+                  Normalized height of the column
+                FLOAT moisture
+                  Normalized moisture of the column
+
+      Returns:  eBlockType
+                  Block type of the column
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eBlockType TerrainGenerator::ClassifyBiome(_In_ FLOAT height, _In_ FLOAT moisture)
+    {
+        // The two lowest bands include their upper bound and the others
+        // exclude it
+        UINT uHeightBand = static_cast<UINT>(height >= 0.1f)
+            + static_cast<UINT>(height >= 0.12f)
+            + static_cast<UINT>(height > 0.3f)
+            + static_cast<UINT>(height > 0.6f)
+            + static_cast<UINT>(height > 0.8f);
+
+        const BiomeBand& band = ms_aBiomeBands[uHeightBand];
+        UINT uMoistureBand = static_cast<UINT>(moisture >= band.aMoistureThresholds[0])
+            + static_cast<UINT>(moisture >= band.aMoistureThresholds[1])
+            + static_cast<UINT>(moisture >= band.aMoistureThresholds[2]);
+
+        return band.aBlockTypes[uMoistureBand];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::TerrainGenerator
+
+      Summary:  Constructor
+
+      Args:     const TerrainDesc& desc
+                  Size of the world and parameters of the noise
+
+      Modifies: [m_desc, m_aHeights, m_aMoistures, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TerrainGenerator::TerrainGenerator(_In_ const TerrainDesc& desc)
+        : m_desc(desc)
+        , m_aHeights()
+        , m_aMoistures()
+        , m_stats()
+    {
+        m_desc.uNumOctaves = std::max<UINT>(m_desc.uNumOctaves, 1u);
+        m_desc.uTileSize = std::max<UINT>(m_desc.uTileSize, 1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::Generate
+
+      Summary:  Generates the height and moisture of every column tile
+                by tile on the workers, classifies the columns and
+                hands them to the height map without going through a
+                file
+
+      Args:     const std::vector<XMFLOAT4>& aPalette
+                  Colors indexed from eBlockType::GRASSLAND
+                HeightMap& heightMap
+                  Receives the generated columns
+
+      Modifies: [m_aHeights, m_aMoistures, m_stats].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TerrainGenerator::Generate(_In_ const std::vector<XMFLOAT4>& aPalette, _Inout_ HeightMap& heightMap)
+    {
+        BenchmarkTimer timer;
+
+        size_t uNumColumns = static_cast<size_t>(m_desc.uWidth) * static_cast<size_t>(m_desc.uDepth);
+        m_aHeights.assign(uNumColumns, 0.0f);
+        m_aMoistures.assign(uNumColumns, 0.0f);
+        std::vector<HeightMapColumn> aColumns(uNumColumns);
+
+        UINT uNumTilesX = (m_desc.uWidth + m_desc.uTileSize - 1u) / m_desc.uTileSize;
+        UINT uNumTilesZ = (m_desc.uDepth + m_desc.uTileSize - 1u) / m_desc.uTileSize;
+        UINT uNumTiles = uNumTilesX * uNumTilesZ;
+        UINT uNumWorkers = m_desc.uNumWorkers > 0u ? m_desc.uNumWorkers : std::thread::hardware_concurrency();
+        uNumWorkers = std::clamp<UINT>(uNumWorkers, 1u, std::max<UINT>(uNumTiles, 1u));
+
+        // Workers take the next tile as they finish one, so tiles of
+        // uneven cost do not leave cores idle. Each column is written
+        // by exactly one worker
+        std::atomic<UINT> uNextTile(0u);
+        {
+            std::vector<std::thread> aWorkers;
+            aWorkers.reserve(uNumWorkers - 1u);
+            for (UINT i = 1u; i < uNumWorkers; ++i)
+            {
+                aWorkers.emplace_back(&TerrainGenerator::generateTiles, this, std::ref(uNextTile), uNumTilesX, uNumTiles, std::ref(aColumns));
+            }
+            generateTiles(uNextTile, uNumTilesX, uNumTiles, aColumns);
+
+            for (std::thread& worker : aWorkers)
+            {
+                worker.join();
+            }
+        }
+
+        HRESULT hr = heightMap.Assign(m_desc.uWidth, m_desc.uHeight, m_desc.uDepth, aPalette, std::move(aColumns));
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        FLOAT milliseconds = timer.GetMilliseconds();
+
+        m_stats.uNumTiles = uNumTiles;
+        m_stats.uNumWorkers = uNumWorkers;
+        m_stats.GenerateMilliseconds = milliseconds;
+        m_stats.MegaColumnsPerSecond = m_stats.GenerateMilliseconds > 0.0f
+            ? static_cast<FLOAT>(static_cast<double>(uNumColumns) / 1000.0 / static_cast<double>(m_stats.GenerateMilliseconds))
+            : 0.0f;
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"TerrainGenerator: %u x %u columns generated in %.2f ms (%u tiles on %u workers, %.2f M columns/s)\n",
+            m_desc.uWidth,
+            m_desc.uDepth,
+            m_stats.GenerateMilliseconds,
+            m_stats.uNumTiles,
+            m_stats.uNumWorkers,
+            m_stats.MegaColumnsPerSecond
+        );
+        OutputDebugString(szReport);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::GetDesc
+
+      Summary:  Returns the generation parameters
+
+      Returns:  const TerrainDesc&
+                  Generation parameters
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const TerrainDesc& TerrainGenerator::GetDesc() const
+    {
+        return m_desc;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::GetHeights
+
+      Summary:  Returns the height field of the last generation
+
+      Returns:  const std::vector<FLOAT>&
+                  Normalized heights, row by row along z
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<FLOAT>& TerrainGenerator::GetHeights() const
+    {
+        return m_aHeights;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::GetMoistures
+
+      Summary:  Returns the moisture field of the last generation
+
+      Returns:  const std::vector<FLOAT>&
+                  Normalized moistures, row by row along z
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<FLOAT>& TerrainGenerator::GetMoistures() const
+    {
+        return m_aMoistures;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::GetStats
+
+      Summary:  Returns the statistics of the last generation
+
+      Returns:  const TerrainGenerationStats&
+                  Generation statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const TerrainGenerationStats& TerrainGenerator::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::generateTiles
+
+      Summary:  Body of a worker. Takes tiles until none is left and
+                computes the height, moisture and column of each of
+                their cells, row by row
+
+      Args:     std::atomic<UINT>& uNextTile
+                  Index of the next tile to take
+                UINT uNumTilesX
+                  Number of tiles along x
+                UINT uNumTiles
+                  Number of tiles
+                std::vector<HeightMapColumn>& aColumns
+                  Receives the columns
+
+      Modifies: [m_aHeights, m_aMoistures, aColumns].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TerrainGenerator::generateTiles(_Inout_ std::atomic<UINT>& uNextTile, _In_ UINT uNumTilesX, _In_ UINT uNumTiles, _Inout_ std::vector<HeightMapColumn>& aColumns)
+    {
+        std::vector<FLOAT> aScratch;
+        for (UINT uTileIdx = uNextTile++; uTileIdx < uNumTiles; uTileIdx = uNextTile++)
+        {
+            UINT uBeginX = (uTileIdx % uNumTilesX) * m_desc.uTileSize;
+            UINT uBeginZ = (uTileIdx / uNumTilesX) * m_desc.uTileSize;
+            UINT uEndX = std::min<UINT>(uBeginX + m_desc.uTileSize, m_desc.uWidth);
+            UINT uEndZ = std::min<UINT>(uBeginZ + m_desc.uTileSize, m_desc.uDepth);
+
+            for (UINT z = uBeginZ; z < uEndZ; ++z)
+            {
+                size_t uRowIdx = static_cast<size_t>(z) * m_desc.uWidth + uBeginX;
+                sampleRow(uBeginX, uEndX, z, 0.0f, &m_aHeights[uRowIdx], aScratch);
+                if (m_desc.MoistureOffset == 0.0f)
+                {
+                    // Same samples as the height, so the field is copied
+                    std::copy_n(&m_aHeights[uRowIdx], uEndX - uBeginX, &m_aMoistures[uRowIdx]);
+                }
+                else
+                {
+                    sampleRow(uBeginX, uEndX, z, m_desc.MoistureOffset, &m_aMoistures[uRowIdx], aScratch);
+                }
+
+                for (size_t uColumnIdx = uRowIdx; uColumnIdx < uRowIdx + (uEndX - uBeginX); ++uColumnIdx)
+                {
+                    FLOAT height = m_aHeights[uColumnIdx];
+
+                    // Quantized the same way as the height map parser
+                    FLOAT numVoxels = std::clamp(static_cast<FLOAT>(m_desc.uHeight) * height, 0.0f, 65535.0f);
+                    aColumns[uColumnIdx] = HeightMapColumn
+                    {
+                        .BlockType = static_cast<CHAR>(ClassifyBiome(height, m_aMoistures[uColumnIdx])),
+                        .Reserved = 0u,
+                        .uHeight = static_cast<WORD>(numVoxels)
+                    };
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::sampleRow
+
+      Summary:  Evaluates the field along a run of a row, octave by
+                octave with the batch noise. Each octave has twice the
+                frequency and half the weight of the previous one, and
+                the sum is shaped at the end
+
+      Args:     UINT uBeginX
+                  First column of the run
+                UINT uEndX
+                  Column following the run
+                UINT z
+                  Row of the run
+                FLOAT offset
+                  Offset added to both coordinates before sampling
+                FLOAT* pValues
+                  Receives the normalized values of the run
+                std::vector<FLOAT>& aScratch
+                  Scratch memory of the worker
+
+      Modifies: [aScratch].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TerrainGenerator::sampleRow(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT z, _In_ FLOAT offset, _Out_writes_(uEndX - uBeginX) FLOAT* pValues, _Inout_ std::vector<FLOAT>& aScratch) const
+    {
+        UINT uCount = uEndX - uBeginX;
+        aScratch.resize(static_cast<size_t>(uCount) * 3u);
+        FLOAT* pX = aScratch.data();
+        FLOAT* pZ = pX + uCount;
+        FLOAT* pNoise = pZ + uCount;
+
+        std::fill(pValues, pValues + uCount, 0.0f);
+        FLOAT frequencySum = 0.0f;
+        for (UINT i = 0u; i < m_desc.uNumOctaves; ++i)
+        {
+            FLOAT frequency = pow(2.0f, static_cast<FLOAT>(i));
+            frequencySum += 1.0f / frequency;
+            for (UINT k = 0u; k < uCount; ++k)
+            {
+                pX[k] = frequency * (static_cast<FLOAT>(uBeginX + k) + offset);
+                pZ[k] = frequency * (static_cast<FLOAT>(z) + offset);
+            }
+
+            Scene::GetPerlin2dBatch(pX, pZ, m_desc.Frequency, m_desc.uNoiseDepth, uCount, pNoise);
+            for (UINT k = 0u; k < uCount; ++k)
+            {
+                pValues[k] += pNoise[k] / frequency;
+            }
+        }
+
+        for (UINT k = 0u; k < uCount; ++k)
+        {
+            pValues[k] = pow(pValues[k] / frequencySum * 1.2f, 1.25f);
+        }
+    }
+}
\ No newline at end of file
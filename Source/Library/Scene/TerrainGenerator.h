@@ -0,0 +1,156 @@
+/*+===================================================================
+  File:      TERRAINGENERATOR.H
+
+  Summary:   TerrainGenerator header file contains declarations of
+             TerrainGenerator class that builds the height map of the
+             voxel world in memory from noise.
+
+  Classes: TerrainGenerator
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <cfloat>
+#include <thread>
+
+#include "Game/Benchmark.h"
+#include "Scene/HeightMap.h"
+#include "Scene/Scene.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   TerrainDesc
+
+        Summary:  Size of the generated world and parameters of its
+                  noise. The moisture field samples the same noise as
+                  the height field, shifted by MoistureOffset. An
+                  offset of 0 makes the moisture equal the height, as
+                  the original terrain did. A uNumWorkers of 0 uses
+                  every hardware thread
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct TerrainDesc
+    {
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+        UINT uNumOctaves;
+        UINT uNoiseDepth;
+        FLOAT Frequency;
+        FLOAT MoistureOffset;
+        UINT uTileSize;
+        UINT uNumWorkers;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   TerrainGenerationStats
+
+        Summary:  Number of tiles and workers of the last generation,
+                  its duration and its throughput in millions of
+                  columns per second
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct TerrainGenerationStats
+    {
+        UINT uNumTiles;
+        UINT uNumWorkers;
+        FLOAT GenerateMilliseconds;
+        FLOAT MegaColumnsPerSecond;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   BiomeBand
+
+        Summary:  Row of the biome table for one band of heights. The
+                  block type is aBlockTypes[i], where i counts the
+                  moisture thresholds at or below the moisture
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct BiomeBand
+    {
+        FLOAT aMoistureThresholds[3];
+        eBlockType aBlockTypes[4];
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TerrainGenerator
+
+      Summary:  Generates the height and moisture fields of the world
+                from fractal Perlin noise and classifies every column
+                into a biome through a table indexed by height band
+                and moisture band. The map is cut into square tiles
+                that the workers take in turn. Every column depends
+                only on its coordinates, so the result is the same bit
+                for bit whatever the number of workers
+
+      Methods:  ClassifyBiome
+                  Returns the block type of a height and a moisture
+                Generate
+                  Fills a height map with the generated columns
+                GetDesc
+                  Returns the generation parameters
+                GetHeights
+                  Returns the height field of the last generation
+                GetMoistures
+                  Returns the moisture field of the last generation
+                GetStats
+                  Returns the statistics of the last generation
+                TerrainGenerator
+                  Constructor.
+                ~TerrainGenerator
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TerrainGenerator
+    {
+    public:
+        static constexpr const UINT DEFAULT_NUM_OCTAVES = 4u;
+        static constexpr const UINT DEFAULT_NOISE_DEPTH = 4u;
+        static constexpr const FLOAT DEFAULT_FREQUENCY = 0.1f;
+        static constexpr const FLOAT DEFAULT_MOISTURE_OFFSET = 0.0f;
+        static constexpr const UINT DEFAULT_TILE_SIZE = 64u;
+
+        static eBlockType ClassifyBiome(_In_ FLOAT height, _In_ FLOAT moisture);
+
+        TerrainGenerator(_In_ const TerrainDesc& desc);
+        TerrainGenerator(const TerrainGenerator& other) = delete;
+        TerrainGenerator(TerrainGenerator&& other) = delete;
+        TerrainGenerator& operator=(const TerrainGenerator& other) = delete;
+        TerrainGenerator& operator=(TerrainGenerator&& other) = delete;
+        ~TerrainGenerator() = default;
+
+        HRESULT Generate(_In_ const std::vector<XMFLOAT4>& aPalette, _Inout_ HeightMap& heightMap);
+
+        const TerrainDesc& GetDesc() const;
+        const std::vector<FLOAT>& GetHeights() const;
+        const std::vector<FLOAT>& GetMoistures() const;
+        const TerrainGenerationStats& GetStats() const;
+
+    private:
+        void generateTiles(_Inout_ std::atomic<UINT>& uNextTile, _In_ UINT uNumTilesX, _In_ UINT uNumTiles, _Inout_ std::vector<HeightMapColumn>& aColumns);
+        void sampleRow(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT z, _In_ FLOAT offset, _Out_writes_(uEndX - uBeginX) FLOAT* pValues, _Inout_ std::vector<FLOAT>& aScratch) const;
+
+    private:
+        static constexpr const BiomeBand ms_aBiomeBands[] =
+        {
+            // Below 0.1
+            { { FLT_MAX, FLT_MAX, FLT_MAX }, { eBlockType::OCEAN, eBlockType::OCEAN, eBlockType::OCEAN, eBlockType::OCEAN } },
+            // Below 0.12
+            { { FLT_MAX, FLT_MAX, FLT_MAX }, { eBlockType::SAND, eBlockType::SAND, eBlockType::SAND, eBlockType::SAND } },
+            // Up to 0.3
+            { { 0.16f, 0.33f, 0.66f }, { eBlockType::SUBTROPICAL_DESERT, eBlockType::GRASSLAND, eBlockType::TROPICAL_SEASONAL_FOREST, eBlockType::TROPICAL_RAIN_FOREST } },
+            // Up to 0.6
+            { { 0.16f, 0.5f, 0.83f }, { eBlockType::TEMPERATE_DESERT, eBlockType::GRASSLAND, eBlockType::TEMPERATE_DECIDUOUS_FOREST, eBlockType::TEMPERATE_RAIN_FOREST } },
+            // Up to 0.8
+            { { 0.33f, 0.66f, FLT_MAX }, { eBlockType::TEMPERATE_DESERT, eBlockType::SHRUBLAND, eBlockType::TAIGA, eBlockType::TAIGA } },
+            // Above 0.8
+            { { 0.1f, 0.2f, 0.5f }, { eBlockType::SCORCHED, eBlockType::BARE, eBlockType::TUNDRA, eBlockType::SNOW } },
+        };
+
+        TerrainDesc m_desc;
+        std::vector<FLOAT> m_aHeights;
+        std::vector<FLOAT> m_aMoistures;
+        TerrainGenerationStats m_stats;
+    };
+}
\ No newline at end of file
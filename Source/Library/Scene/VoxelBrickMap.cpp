@@ -0,0 +1,586 @@
+#include "Scene/VoxelBrickMap.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::VoxelBrickMap
+
+      Summary:  Constructor. Every brick starts empty
+
+      Args:     UINT uWidth
+                  Number of cells along x
+                UINT uHeight
+                  Number of cells along y
+                UINT uDepth
+                  Number of cells along z
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_uNumBricksX,
+                 m_uNumBricksY, m_uNumBricksZ, m_aBrickIndices,
+                 m_aBricks, m_aBlockTypes, m_aFreeBricks,
+                 m_aFreeBlockTypeOffsets, m_ullNumSolidVoxels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelBrickMap::VoxelBrickMap(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth)
+        : m_uWidth(uWidth)
+        , m_uHeight(uHeight)
+        , m_uDepth(uDepth)
+        , m_uNumBricksX((uWidth + BRICK_SIZE - 1u) / BRICK_SIZE)
+        , m_uNumBricksY((uHeight + BRICK_SIZE - 1u) / BRICK_SIZE)
+        , m_uNumBricksZ((uDepth + BRICK_SIZE - 1u) / BRICK_SIZE)
+        , m_aBrickIndices(static_cast<size_t>(m_uNumBricksX) * m_uNumBricksY * m_uNumBricksZ, EMPTY_BRICK)
+        , m_aBricks()
+        , m_aBlockTypes()
+        , m_aFreeBricks()
+        , m_aFreeBlockTypeOffsets()
+        , m_ullNumSolidVoxels(0ull)
+    { }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::BuildFromHeightMap
+
+      Summary:  Replaces the bricks with the cells from the ground up
+                to the height of each column of a height map with a
+                known block type. Bands of brick rows are filled on
+                worker threads into their own arrays, which are then
+                concatenated in row order
+
+      Args:     const HeightMap& heightMap
+                  Height map of the same width and depth as the map
+
+      Modifies: [m_aBrickIndices, m_aBricks, m_aBlockTypes,
+                 m_aFreeBricks, m_aFreeBlockTypeOffsets,
+                 m_ullNumSolidVoxels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelBrickMap::BuildFromHeightMap(_In_ const HeightMap& heightMap)
+    {
+        assert(heightMap.GetWidth() == m_uWidth && heightMap.GetDepth() == m_uDepth);
+
+        std::fill(m_aBrickIndices.begin(), m_aBrickIndices.end(), EMPTY_BRICK);
+        m_aBricks.clear();
+        m_aBlockTypes.clear();
+        m_aFreeBricks.clear();
+        m_aFreeBlockTypeOffsets.clear();
+
+        UINT uNumWorkers = std::clamp(std::thread::hardware_concurrency(), 1u, std::max<UINT>(m_uNumBricksZ, 1u));
+        std::vector<std::vector<VoxelBrick>> aWorkerBricks(uNumWorkers);
+        std::vector<std::vector<CHAR>> aWorkerBlockTypes(uNumWorkers);
+        {
+            std::vector<std::thread> aWorkers;
+            aWorkers.reserve(uNumWorkers - 1u);
+            for (UINT uWorkerIdx = 1u; uWorkerIdx < uNumWorkers; ++uWorkerIdx)
+            {
+                aWorkers.emplace_back(
+                    [this, &heightMap, &aWorkerBricks, &aWorkerBlockTypes, uWorkerIdx, uNumWorkers]()
+                    {
+                        buildBrickColumns(
+                            heightMap,
+                            m_uNumBricksZ * uWorkerIdx / uNumWorkers,
+                            m_uNumBricksZ * (uWorkerIdx + 1u) / uNumWorkers,
+                            m_uNumBricksX,
+                            m_uNumBricksY,
+                            m_aBrickIndices,
+                            aWorkerBricks[uWorkerIdx],
+                            aWorkerBlockTypes[uWorkerIdx]
+                        );
+                    }
+                );
+            }
+            buildBrickColumns(heightMap, 0u, m_uNumBricksZ / uNumWorkers, m_uNumBricksX, m_uNumBricksY, m_aBrickIndices, aWorkerBricks[0], aWorkerBlockTypes[0]);
+
+            for (std::thread& worker : aWorkers)
+            {
+                worker.join();
+            }
+        }
+
+        // Workers numbered their bricks and block types from zero, so
+        // shift them past those of the bands before
+        size_t uNumBricks = 0u;
+        size_t uNumBlockTypes = 0u;
+        for (UINT uWorkerIdx = 0u; uWorkerIdx < uNumWorkers; ++uWorkerIdx)
+        {
+            uNumBricks += aWorkerBricks[uWorkerIdx].size();
+            uNumBlockTypes += aWorkerBlockTypes[uWorkerIdx].size();
+        }
+        m_aBricks.reserve(uNumBricks);
+        m_aBlockTypes.reserve(uNumBlockTypes);
+
+        for (UINT uWorkerIdx = 0u; uWorkerIdx < uNumWorkers; ++uWorkerIdx)
+        {
+            UINT uBrickOffset = static_cast<UINT>(m_aBricks.size());
+            UINT uBlockTypeOffset = static_cast<UINT>(m_aBlockTypes.size());
+            size_t uBegin = static_cast<size_t>(m_uNumBricksZ * uWorkerIdx / uNumWorkers) * m_uNumBricksY * m_uNumBricksX;
+            size_t uEnd = static_cast<size_t>(m_uNumBricksZ * (uWorkerIdx + 1u) / uNumWorkers) * m_uNumBricksY * m_uNumBricksX;
+            for (size_t i = uBegin; i < uEnd; ++i)
+            {
+                if (m_aBrickIndices[i] != EMPTY_BRICK)
+                {
+                    m_aBrickIndices[i] += uBrickOffset;
+                }
+            }
+
+            for (VoxelBrick& brick : aWorkerBricks[uWorkerIdx])
+            {
+                if (brick.uBlockTypeOffset != UNIFORM_BLOCK_TYPE)
+                {
+                    brick.uBlockTypeOffset += uBlockTypeOffset;
+                }
+            }
+
+            m_aBricks.insert(m_aBricks.end(), aWorkerBricks[uWorkerIdx].begin(), aWorkerBricks[uWorkerIdx].end());
+            m_aBlockTypes.insert(m_aBlockTypes.end(), aWorkerBlockTypes[uWorkerIdx].begin(), aWorkerBlockTypes[uWorkerIdx].end());
+            std::vector<VoxelBrick>().swap(aWorkerBricks[uWorkerIdx]);
+            std::vector<CHAR>().swap(aWorkerBlockTypes[uWorkerIdx]);
+        }
+
+        m_ullNumSolidVoxels = 0ull;
+        for (const VoxelBrick& brick : m_aBricks)
+        {
+            for (UINT64 ullWord : brick.aOccupancy)
+            {
+                m_ullNumSolidVoxels += static_cast<UINT64>(std::popcount(ullWord));
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::IsSolid
+
+      Summary:  Returns whether a cell is solid. Cells outside of the
+                map are empty
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  BOOL
+                  TRUE if the cell is solid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelBrickMap::IsSolid(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        if (x < 0 || y < 0 || z < 0 || static_cast<UINT>(x) >= m_uWidth || static_cast<UINT>(y) >= m_uHeight || static_cast<UINT>(z) >= m_uDepth)
+        {
+            return FALSE;
+        }
+
+        UINT uBrickIdx = getBrickIndex(static_cast<UINT>(x) / BRICK_SIZE, static_cast<UINT>(y) / BRICK_SIZE, static_cast<UINT>(z) / BRICK_SIZE);
+        if (uBrickIdx == EMPTY_BRICK)
+        {
+            return FALSE;
+        }
+
+        UINT uBitIdx = (static_cast<UINT>(y) % BRICK_SIZE) * BRICK_SIZE + static_cast<UINT>(x) % BRICK_SIZE;
+        return (m_aBricks[uBrickIdx].aOccupancy[static_cast<UINT>(z) % BRICK_SIZE] >> uBitIdx) & 1ull;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::GetBlockType
+
+      Summary:  Returns the block type of a cell
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  CHAR
+                  Block type of the cell, 0 if it is empty
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    CHAR VoxelBrickMap::GetBlockType(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        if (!IsSolid(x, y, z))
+        {
+            return 0;
+        }
+
+        const VoxelBrick& brick = m_aBricks[getBrickIndex(static_cast<UINT>(x) / BRICK_SIZE, static_cast<UINT>(y) / BRICK_SIZE, static_cast<UINT>(z) / BRICK_SIZE)];
+        if (brick.uBlockTypeOffset == UNIFORM_BLOCK_TYPE)
+        {
+            return brick.UniformBlockType;
+        }
+
+        UINT uCellIdx = ((static_cast<UINT>(z) % BRICK_SIZE) * BRICK_SIZE + static_cast<UINT>(y) % BRICK_SIZE) * BRICK_SIZE + static_cast<UINT>(x) % BRICK_SIZE;
+        return m_aBlockTypes[brick.uBlockTypeOffset + uCellIdx];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::SetBlockType
+
+      Summary:  Fills a cell with a block type, or empties it. A brick
+                is allocated for the first solid cell and released with
+                the last one, and a brick gets its own block types once
+                a second type enters it
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+                CHAR blockType
+                  Block type of the cell, 0 to empty it
+
+      Modifies: [m_aBrickIndices, m_aBricks, m_aBlockTypes,
+                 m_aFreeBricks, m_aFreeBlockTypeOffsets,
+                 m_ullNumSolidVoxels].
+
+      Returns:  HRESULT
+                  E_INVALIDARG if the cell is outside of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelBrickMap::SetBlockType(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ CHAR blockType)
+    {
+        if (x >= m_uWidth || y >= m_uHeight || z >= m_uDepth)
+        {
+            return E_INVALIDARG;
+        }
+
+        size_t uIndexIdx = (static_cast<size_t>(z / BRICK_SIZE) * m_uNumBricksY + y / BRICK_SIZE) * m_uNumBricksX + x / BRICK_SIZE;
+        UINT uBitIdx = (y % BRICK_SIZE) * BRICK_SIZE + x % BRICK_SIZE;
+        UINT uCellIdx = (z % BRICK_SIZE) * BRICK_SIZE * BRICK_SIZE + uBitIdx;
+        UINT64 ullBit = 1ull << uBitIdx;
+
+        if (blockType == 0)
+        {
+            if (m_aBrickIndices[uIndexIdx] == EMPTY_BRICK)
+            {
+                return S_OK;
+            }
+
+            VoxelBrick& brick = m_aBricks[m_aBrickIndices[uIndexIdx]];
+            UINT64& ullWord = brick.aOccupancy[z % BRICK_SIZE];
+            if (ullWord & ullBit)
+            {
+                ullWord &= ~ullBit;
+                --m_ullNumSolidVoxels;
+            }
+
+            BOOL bEmpty = TRUE;
+            for (UINT64 ullOccupancy : brick.aOccupancy)
+            {
+                bEmpty = bEmpty && ullOccupancy == 0ull;
+            }
+            if (bEmpty)
+            {
+                if (brick.uBlockTypeOffset != UNIFORM_BLOCK_TYPE)
+                {
+                    m_aFreeBlockTypeOffsets.push_back(brick.uBlockTypeOffset);
+                }
+                m_aFreeBricks.push_back(m_aBrickIndices[uIndexIdx]);
+                m_aBrickIndices[uIndexIdx] = EMPTY_BRICK;
+            }
+
+            return S_OK;
+        }
+
+        if (m_aBrickIndices[uIndexIdx] == EMPTY_BRICK)
+        {
+            UINT uBrickIdx = allocateBrick();
+            m_aBricks[uBrickIdx].UniformBlockType = blockType;
+            m_aBrickIndices[uIndexIdx] = uBrickIdx;
+        }
+
+        VoxelBrick& brick = m_aBricks[m_aBrickIndices[uIndexIdx]];
+        if (brick.uBlockTypeOffset == UNIFORM_BLOCK_TYPE && brick.UniformBlockType != blockType)
+        {
+            makeMixed(brick);
+        }
+        if (brick.uBlockTypeOffset != UNIFORM_BLOCK_TYPE)
+        {
+            m_aBlockTypes[brick.uBlockTypeOffset + uCellIdx] = blockType;
+        }
+
+        UINT64& ullWord = brick.aOccupancy[z % BRICK_SIZE];
+        if (!(ullWord & ullBit))
+        {
+            ullWord |= ullBit;
+            ++m_ullNumSolidVoxels;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::GetWidth
+
+      Summary:  Returns the number of cells along x
+
+      Returns:  UINT
+                  Width of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelBrickMap::GetWidth() const
+    {
+        return m_uWidth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::GetHeight
+
+      Summary:  Returns the number of cells along y
+
+      Returns:  UINT
+                  Height of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelBrickMap::GetHeight() const
+    {
+        return m_uHeight;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::GetDepth
+
+      Summary:  Returns the number of cells along z
+
+      Returns:  UINT
+                  Depth of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelBrickMap::GetDepth() const
+    {
+        return m_uDepth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::GetNumBricks
+
+      Summary:  Returns the number of allocated bricks
+
+      Returns:  UINT
+                  Bricks holding at least one solid cell
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelBrickMap::GetNumBricks() const
+    {
+        return static_cast<UINT>(m_aBricks.size() - m_aFreeBricks.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::GetNumSolidVoxels
+
+      Summary:  Returns the number of solid cells
+
+      Returns:  UINT64
+                  Number of solid cells
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 VoxelBrickMap::GetNumSolidVoxels() const
+    {
+        return m_ullNumSolidVoxels;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::GetMemoryUsage
+
+      Summary:  Returns the size of the brick indices, the bricks and
+                the block types in bytes
+
+      Returns:  size_t
+                  Size of the storage in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t VoxelBrickMap::GetMemoryUsage() const
+    {
+        return m_aBrickIndices.size() * sizeof(UINT)
+            + m_aBricks.size() * sizeof(VoxelBrick)
+            + m_aBlockTypes.size() * sizeof(CHAR)
+            + (m_aFreeBricks.size() + m_aFreeBlockTypeOffsets.size()) * sizeof(UINT);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::getBrickIndex
+
+      Summary:  Returns the index of a brick into m_aBricks
+
+      Args:     UINT uBrickX
+                  Index of the brick along x
+                UINT uBrickY
+                  Index of the brick along y
+                UINT uBrickZ
+                  Index of the brick along z
+
+      Returns:  UINT
+                  Index of the brick, EMPTY_BRICK if it holds nothing
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelBrickMap::getBrickIndex(_In_ UINT uBrickX, _In_ UINT uBrickY, _In_ UINT uBrickZ) const
+    {
+        return m_aBrickIndices[(static_cast<size_t>(uBrickZ) * m_uNumBricksY + uBrickY) * m_uNumBricksX + uBrickX];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::allocateBrick
+
+      Summary:  Returns an empty uniform brick, reusing a released one
+                when there is any
+
+      Modifies: [m_aBricks, m_aFreeBricks].
+
+      Returns:  UINT
+                  Index of the brick
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelBrickMap::allocateBrick()
+    {
+        UINT uBrickIdx = 0u;
+        if (m_aFreeBricks.empty())
+        {
+            uBrickIdx = static_cast<UINT>(m_aBricks.size());
+            m_aBricks.emplace_back();
+        }
+        else
+        {
+            uBrickIdx = m_aFreeBricks.back();
+            m_aFreeBricks.pop_back();
+        }
+
+        m_aBricks[uBrickIdx] = VoxelBrick{ .aOccupancy = {}, .uBlockTypeOffset = UNIFORM_BLOCK_TYPE, .UniformBlockType = 0, .aReserved = {} };
+        return uBrickIdx;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::makeMixed
+
+      Summary:  Gives a uniform brick its own block types, all set to
+                its uniform block type
+
+      Args:     VoxelBrick& brick
+                  Uniform brick
+
+      Modifies: [brick, m_aBlockTypes, m_aFreeBlockTypeOffsets].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelBrickMap::makeMixed(_Inout_ VoxelBrick& brick)
+    {
+        if (m_aFreeBlockTypeOffsets.empty())
+        {
+            brick.uBlockTypeOffset = static_cast<UINT>(m_aBlockTypes.size());
+            m_aBlockTypes.resize(m_aBlockTypes.size() + CELLS_PER_BRICK);
+        }
+        else
+        {
+            brick.uBlockTypeOffset = m_aFreeBlockTypeOffsets.back();
+            m_aFreeBlockTypeOffsets.pop_back();
+        }
+
+        std::fill_n(m_aBlockTypes.begin() + brick.uBlockTypeOffset, CELLS_PER_BRICK, brick.UniformBlockType);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::buildBrickColumns
+
+      Summary:  Fills the bricks of the brick rows [uBeginBrickZ,
+                uEndBrickZ) from a height map into local arrays. The
+                brick indices written are local to aBricks, and the
+                block type offsets local to aBlockTypes
+
+      Args:     const HeightMap& heightMap
+                  Height map giving the columns
+                UINT uBeginBrickZ
+                  First brick row
+                UINT uEndBrickZ
+                  Brick row following the last one
+                UINT uNumBricksX
+                  Number of bricks along x
+                UINT uNumBricksY
+                  Number of bricks along y
+                std::vector<UINT>& aBrickIndices
+                  Brick indices of the whole map
+                std::vector<VoxelBrick>& aBricks
+                  Receives the bricks of the rows
+                std::vector<CHAR>& aBlockTypes
+                  Receives the block types of the mixed bricks
+
+      Modifies: [aBrickIndices, aBricks, aBlockTypes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelBrickMap::buildBrickColumns(_In_ const HeightMap& heightMap, _In_ UINT uBeginBrickZ, _In_ UINT uEndBrickZ, _In_ UINT uNumBricksX, _In_ UINT uNumBricksY, _Inout_ std::vector<UINT>& aBrickIndices, _Inout_ std::vector<VoxelBrick>& aBricks, _Inout_ std::vector<CHAR>& aBlockTypes)
+    {
+        size_t uNumColors = heightMap.GetPalette().size();
+        UINT uMapHeight = uNumBricksY * BRICK_SIZE;
+
+        // Heights and block types of the 8 x 8 columns under a brick
+        // column, with unknown block types read as empty columns
+        UINT aHeights[BRICK_SIZE * BRICK_SIZE];
+        CHAR aColumnTypes[BRICK_SIZE * BRICK_SIZE];
+
+        for (UINT uBrickZ = uBeginBrickZ; uBrickZ < uEndBrickZ; ++uBrickZ)
+        {
+            for (UINT uBrickX = 0u; uBrickX < uNumBricksX; ++uBrickX)
+            {
+                UINT uMaxHeight = 0u;
+                for (UINT uLocalZ = 0u; uLocalZ < BRICK_SIZE; ++uLocalZ)
+                {
+                    for (UINT uLocalX = 0u; uLocalX < BRICK_SIZE; ++uLocalX)
+                    {
+                        UINT x = uBrickX * BRICK_SIZE + uLocalX;
+                        UINT z = uBrickZ * BRICK_SIZE + uLocalZ;
+                        UINT uColumnIdx = uLocalZ * BRICK_SIZE + uLocalX;
+                        aHeights[uColumnIdx] = 0u;
+                        aColumnTypes[uColumnIdx] = 0;
+                        if (x >= heightMap.GetWidth() || z >= heightMap.GetDepth())
+                        {
+                            continue;
+                        }
+
+                        const HeightMapColumn& column = heightMap.GetColumn(x, z);
+                        size_t uColorIdx = static_cast<size_t>(column.BlockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+                        if (column.BlockType < static_cast<CHAR>(eBlockType::GRASSLAND) || uColorIdx >= uNumColors)
+                        {
+                            continue;
+                        }
+
+                        aHeights[uColumnIdx] = std::min<UINT>(column.uHeight, uMapHeight);
+                        aColumnTypes[uColumnIdx] = column.BlockType;
+                        uMaxHeight = std::max<UINT>(uMaxHeight, aHeights[uColumnIdx]);
+                    }
+                }
+
+                for (UINT uBrickY = 0u; uBrickY * BRICK_SIZE < uMaxHeight; ++uBrickY)
+                {
+                    VoxelBrick brick = { .aOccupancy = {}, .uBlockTypeOffset = UNIFORM_BLOCK_TYPE, .UniformBlockType = 0, .aReserved = {} };
+                    BOOL bMixed = FALSE;
+                    for (UINT uLocalZ = 0u; uLocalZ < BRICK_SIZE; ++uLocalZ)
+                    {
+                        for (UINT uLocalX = 0u; uLocalX < BRICK_SIZE; ++uLocalX)
+                        {
+                            UINT uColumnIdx = uLocalZ * BRICK_SIZE + uLocalX;
+                            UINT uBottom = uBrickY * BRICK_SIZE;
+                            if (aHeights[uColumnIdx] <= uBottom)
+                            {
+                                continue;
+                            }
+
+                            // Set the bits of the cells below the top of
+                            // the column in this brick, one per row
+                            UINT uNumCells = std::min<UINT>(aHeights[uColumnIdx] - uBottom, BRICK_SIZE);
+                            for (UINT uLocalY = 0u; uLocalY < uNumCells; ++uLocalY)
+                            {
+                                brick.aOccupancy[uLocalZ] |= 1ull << (uLocalY * BRICK_SIZE + uLocalX);
+                            }
+
+                            if (brick.UniformBlockType == 0)
+                            {
+                                brick.UniformBlockType = aColumnTypes[uColumnIdx];
+                            }
+                            bMixed = bMixed || brick.UniformBlockType != aColumnTypes[uColumnIdx];
+                        }
+                    }
+
+                    if (bMixed)
+                    {
+                        brick.uBlockTypeOffset = static_cast<UINT>(aBlockTypes.size());
+                        aBlockTypes.resize(aBlockTypes.size() + CELLS_PER_BRICK, 0);
+                        for (UINT uLocalZ = 0u; uLocalZ < BRICK_SIZE; ++uLocalZ)
+                        {
+                            for (UINT uLocalY = 0u; uLocalY < BRICK_SIZE; ++uLocalY)
+                            {
+                                for (UINT uLocalX = 0u; uLocalX < BRICK_SIZE; ++uLocalX)
+                                {
+                                    aBlockTypes[brick.uBlockTypeOffset + (uLocalZ * BRICK_SIZE + uLocalY) * BRICK_SIZE + uLocalX] = aColumnTypes[uLocalZ * BRICK_SIZE + uLocalX];
+                                }
+                            }
+                        }
+                    }
+
+                    aBrickIndices[(static_cast<size_t>(uBrickZ) * uNumBricksY + uBrickY) * uNumBricksX + uBrickX] = static_cast<UINT>(aBricks.size());
+                    aBricks.push_back(brick);
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+/*+===================================================================
+  File:      VOXELBRICKMAP.H
+
+  Summary:   VoxelBrickMap header file contains declarations of
+             VoxelBrickMap class, a sparse two-level storage of the
+             solid voxels and their block types.
+
+  Classes: VoxelBrickMap
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <bit>
+#include <thread>
+
+#include "Scene/HeightMap.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelBrick
+
+        Summary:  8 x 8 x 8 cells of the brick map. Word z of the
+                  occupancy holds the cells of slice z, bit y * 8 + x
+                  for cell (x, y). A brick whose solid cells share one
+                  block type keeps it in UniformBlockType, any other
+                  brick keeps 512 block types, one per cell, at
+                  uBlockTypeOffset
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelBrick
+    {
+        UINT64 aOccupancy[8];
+        UINT uBlockTypeOffset;
+        CHAR UniformBlockType;
+        BYTE aReserved[3];
+    };
+    static_assert(sizeof(VoxelBrick) == 72u);
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelBrickMap
+
+      Summary:  Sparse voxel storage made of a coarse grid of brick
+                indices over bricks of 8 x 8 x 8 cells. Empty bricks
+                take four bytes, bricks of a single block type 72, and
+                mixed bricks 584, so caves and overhangs cost only the
+                bricks they touch. Point queries read one index and
+                one bit, and range iteration skips empty bricks and
+                walks the set bits of the others
+
+      Methods:  BuildFromHeightMap
+                  Fills the bricks from the columns of a height map
+                IsSolid
+                  Returns whether a cell is solid
+                GetBlockType
+                  Returns the block type of a cell
+                SetBlockType
+                  Fills or empties a cell
+                ForEachSolid
+                  Visits the solid cells of a box
+                GetWidth
+                  Returns the number of cells along x
+                GetHeight
+                  Returns the number of cells along y
+                GetDepth
+                  Returns the number of cells along z
+                GetNumBricks
+                  Returns the number of allocated bricks
+                GetNumSolidVoxels
+                  Returns the number of solid cells
+                GetMemoryUsage
+                  Returns the size of the storage in bytes
+                VoxelBrickMap
+                  Constructor.
+                ~VoxelBrickMap
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelBrickMap
+    {
+    public:
+        static constexpr const UINT BRICK_SIZE = 8u;
+        static constexpr const UINT CELLS_PER_BRICK = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+        static constexpr const UINT EMPTY_BRICK = UINT_MAX;
+        static constexpr const UINT UNIFORM_BLOCK_TYPE = UINT_MAX;
+
+        VoxelBrickMap(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth);
+        VoxelBrickMap(const VoxelBrickMap& other) = delete;
+        VoxelBrickMap(VoxelBrickMap&& other) = delete;
+        VoxelBrickMap& operator=(const VoxelBrickMap& other) = delete;
+        VoxelBrickMap& operator=(VoxelBrickMap&& other) = delete;
+        ~VoxelBrickMap() = default;
+
+        void BuildFromHeightMap(_In_ const HeightMap& heightMap);
+
+        BOOL IsSolid(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        CHAR GetBlockType(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        HRESULT SetBlockType(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ CHAR blockType);
+
+        template <class Visitor>
+        void ForEachSolid(_In_ UINT uBeginX, _In_ UINT uBeginY, _In_ UINT uBeginZ, _In_ UINT uEndX, _In_ UINT uEndY, _In_ UINT uEndZ, _In_ Visitor visitor) const;
+
+        UINT GetWidth() const;
+        UINT GetHeight() const;
+        UINT GetDepth() const;
+        UINT GetNumBricks() const;
+        UINT64 GetNumSolidVoxels() const;
+        size_t GetMemoryUsage() const;
+
+    private:
+        UINT getBrickIndex(_In_ UINT uBrickX, _In_ UINT uBrickY, _In_ UINT uBrickZ) const;
+        UINT allocateBrick();
+        void makeMixed(_Inout_ VoxelBrick& brick);
+
+        static void buildBrickColumns(_In_ const HeightMap& heightMap, _In_ UINT uBeginBrickZ, _In_ UINT uEndBrickZ, _In_ UINT uNumBricksX, _In_ UINT uNumBricksY, _Inout_ std::vector<UINT>& aBrickIndices, _Inout_ std::vector<VoxelBrick>& aBricks, _Inout_ std::vector<CHAR>& aBlockTypes);
+
+    private:
+        UINT m_uWidth;
+        UINT m_uHeight;
+        UINT m_uDepth;
+        UINT m_uNumBricksX;
+        UINT m_uNumBricksY;
+        UINT m_uNumBricksZ;
+        std::vector<UINT> m_aBrickIndices;
+        std::vector<VoxelBrick> m_aBricks;
+        std::vector<CHAR> m_aBlockTypes;
+        std::vector<UINT> m_aFreeBricks;
+        std::vector<UINT> m_aFreeBlockTypeOffsets;
+        UINT64 m_ullNumSolidVoxels;
+    };
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelBrickMap::ForEachSolid
+
+      Summary:  Calls the visitor with the cell and the block type of
+                every solid cell of the box [uBeginX, uEndX) x
+                [uBeginY, uEndY) x [uBeginZ, uEndZ), brick by brick.
+                Empty bricks are skipped without touching their cells
+
+      Args:     UINT uBeginX
+                  First cell of the box along x
+                UINT uBeginY
+                  First cell of the box along y
+                UINT uBeginZ
+                  First cell of the box along z
+                UINT uEndX
+                  Cell following the box along x
+                UINT uEndY
+                  Cell following the box along y
+                UINT uEndZ
+                  Cell following the box along z
+                Visitor visitor
+                  Callable taking (UINT, UINT, UINT, CHAR)
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class Visitor>
+    void VoxelBrickMap::ForEachSolid(_In_ UINT uBeginX, _In_ UINT uBeginY, _In_ UINT uBeginZ, _In_ UINT uEndX, _In_ UINT uEndY, _In_ UINT uEndZ, _In_ Visitor visitor) const
+    {
+        uEndX = std::min<UINT>(uEndX, m_uWidth);
+        uEndY = std::min<UINT>(uEndY, m_uHeight);
+        uEndZ = std::min<UINT>(uEndZ, m_uDepth);
+        if (uBeginX >= uEndX || uBeginY >= uEndY || uBeginZ >= uEndZ)
+        {
+            return;
+        }
+
+        for (UINT uBrickZ = uBeginZ / BRICK_SIZE; uBrickZ <= (uEndZ - 1u) / BRICK_SIZE; ++uBrickZ)
+        {
+            for (UINT uBrickY = uBeginY / BRICK_SIZE; uBrickY <= (uEndY - 1u) / BRICK_SIZE; ++uBrickY)
+            {
+                for (UINT uBrickX = uBeginX / BRICK_SIZE; uBrickX <= (uEndX - 1u) / BRICK_SIZE; ++uBrickX)
+                {
+                    UINT uBrickIdx = getBrickIndex(uBrickX, uBrickY, uBrickZ);
+                    if (uBrickIdx == EMPTY_BRICK)
+                    {
+                        continue;
+                    }
+                    const VoxelBrick& brick = m_aBricks[uBrickIdx];
+
+                    // Clip the box to the brick, then mask the rows of
+                    // every slice to the clipped x and y ranges
+                    UINT uOriginX = uBrickX * BRICK_SIZE;
+                    UINT uOriginY = uBrickY * BRICK_SIZE;
+                    UINT uOriginZ = uBrickZ * BRICK_SIZE;
+                    UINT uLocalBeginX = std::max<UINT>(uBeginX, uOriginX) - uOriginX;
+                    UINT uLocalEndX = std::min<UINT>(uEndX, uOriginX + BRICK_SIZE) - uOriginX;
+                    UINT uLocalBeginY = std::max<UINT>(uBeginY, uOriginY) - uOriginY;
+                    UINT uLocalEndY = std::min<UINT>(uEndY, uOriginY + BRICK_SIZE) - uOriginY;
+                    UINT uLocalBeginZ = std::max<UINT>(uBeginZ, uOriginZ) - uOriginZ;
+                    UINT uLocalEndZ = std::min<UINT>(uEndZ, uOriginZ + BRICK_SIZE) - uOriginZ;
+
+                    UINT64 ullRowMask = ((1ull << (uLocalEndX - uLocalBeginX)) - 1ull) << uLocalBeginX;
+                    UINT64 ullMask = 0ull;
+                    for (UINT uLocalY = uLocalBeginY; uLocalY < uLocalEndY; ++uLocalY)
+                    {
+                        ullMask |= ullRowMask << (uLocalY * BRICK_SIZE);
+                    }
+
+                    for (UINT uLocalZ = uLocalBeginZ; uLocalZ < uLocalEndZ; ++uLocalZ)
+                    {
+                        UINT64 ullSolid = brick.aOccupancy[uLocalZ] & ullMask;
+                        while (ullSolid != 0ull)
+                        {
+                            UINT uBitIdx = static_cast<UINT>(std::countr_zero(ullSolid));
+                            ullSolid &= ullSolid - 1ull;
+
+                            CHAR blockType = brick.uBlockTypeOffset == UNIFORM_BLOCK_TYPE
+                                ? brick.UniformBlockType
+                                : m_aBlockTypes[brick.uBlockTypeOffset + uLocalZ * BRICK_SIZE * BRICK_SIZE + uBitIdx];
+                            visitor(uOriginX + uBitIdx % BRICK_SIZE, uOriginY + uBitIdx / BRICK_SIZE, uOriginZ + uLocalZ, blockType);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "Scene/VoxelChunkMesh.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::VoxelChunkMesh
+
+      Summary:  Constructor
+
+      Args:     VoxelMeshData&& meshData
+                  Vertices, tangent frames and indices of the mesh
+                const XMFLOAT4& outputColor
+                  Default color of the mesh
+
+      Modifies: [m_aVertices, m_aIndices, m_aNormalData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelChunkMesh::VoxelChunkMesh(_In_ VoxelMeshData&& meshData, _In_ const XMFLOAT4& outputColor)
+        : Renderable(outputColor)
+        , m_aVertices(std::move(meshData.aVertices))
+        , m_aIndices(std::move(meshData.aIndices))
+    {
+        m_aNormalData = std::move(meshData.aNormalData);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::Initialize
+
+      Summary:  Initializes the buffers of the mesh
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+
+      Modifies: [m_aMeshes].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelChunkMesh::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        BasicMeshEntry basicMeshEntry;
+        basicMeshEntry.uNumIndices = GetNumIndices();
+
+        m_aMeshes.push_back(basicMeshEntry);
+
+        return initialize(pDevice, pImmediateContext);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::Update
+      Summary:  Updates the mesh every frame
+      Args:     FLOAT deltaTime
+                  Elapsed time
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelChunkMesh::Update(_In_ FLOAT deltaTime)
+    {
+        //Does nothing
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::GetNumVertices
+      Summary:  Returns the number of vertices in the mesh
+
+      Returns:  UINT
+                  Number of vertices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelChunkMesh::GetNumVertices() const
+    {
+        return static_cast<UINT>(m_aVertices.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::GetNumIndices
+      Summary:  Returns the number of indices in the mesh
+
+      Returns:  UINT
+                  Number of indices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelChunkMesh::GetNumIndices() const
+    {
+        return static_cast<UINT>(m_aIndices.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::GetIndexFormat
+      Summary:  Returns the format of the index buffer
+
+      Returns:  DXGI_FORMAT
+                  DXGI_FORMAT_R32_UINT
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    DXGI_FORMAT VoxelChunkMesh::GetIndexFormat() const
+    {
+        return DXGI_FORMAT_R32_UINT;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::getVertices
+      Summary:  Returns the pointer to the vertices data
+
+      Returns:  const library::SimpleVertex*
+                  Pointer to the vertices data
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const SimpleVertex* VoxelChunkMesh::getVertices() const
+    {
+        return m_aVertices.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::getIndices
+      Summary:  The indices are 32-bit and are not available as WORDs
+
+      Returns:  const WORD*
+                  nullptr
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const WORD* VoxelChunkMesh::getIndices() const
+    {
+        return nullptr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelChunkMesh::initialize
+
+      Summary:  Initializes the vertex, normal, 32-bit index and
+                constant buffers
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+
+      Modifies: [m_vertexBuffer, m_normalBuffer, m_indexBuffer
+                 m_constantBuffer].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelChunkMesh::initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (m_aVertices.empty() || m_aIndices.empty())
+        {
+            return E_INVALIDARG;
+        }
+
+        HRESULT hr = S_OK;
+
+        //Create the vertex buffer
+        D3D11_BUFFER_DESC bd =
+        {
+            .ByteWidth = static_cast<UINT>(sizeof(SimpleVertex)) * GetNumVertices(),
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = 0,
+            .MiscFlags = 0
+        };
+
+        D3D11_SUBRESOURCE_DATA initData =
+        {
+            .pSysMem = m_aVertices.data(),
+            .SysMemPitch = 0,
+            .SysMemSlicePitch = 0
+        };
+
+        hr = pDevice->CreateBuffer(&bd, &initData, m_vertexBuffer.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        bd =
+        {
+            .ByteWidth = static_cast<UINT>(sizeof(NormalData)) * static_cast<UINT>(m_aNormalData.size()),
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = 0,
+            .MiscFlags = 0
+        };
+
+        initData =
+        {
+            .pSysMem = m_aNormalData.data(),
+            .SysMemPitch = 0,
+            .SysMemSlicePitch = 0
+        };
+
+        hr = pDevice->CreateBuffer(&bd, &initData, m_normalBuffer.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        //Create the 32-bit index buffer
+        bd =
+        {
+            .ByteWidth = static_cast<UINT>(sizeof(UINT)) * GetNumIndices(),
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_INDEX_BUFFER,
+            .CPUAccessFlags = 0,
+            .MiscFlags = 0
+        };
+
+        initData =
+        {
+            .pSysMem = m_aIndices.data(),
+            .SysMemPitch = 0,
+            .SysMemSlicePitch = 0
+        };
+
+        hr = pDevice->CreateBuffer(&bd, &initData, m_indexBuffer.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        //Create the CBChangesEveryFrame constant buffer
+        bd =
+        {
+            .ByteWidth = sizeof(CBChangesEveryFrame),
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_CONSTANT_BUFFER,
+            .CPUAccessFlags = 0,
+            .MiscFlags = 0,
+            .StructureByteStride = 0
+        };
+
+        return pDevice->CreateBuffer(&bd, nullptr, m_constantBuffer.GetAddressOf());
+    }
+}
\ No newline at end of file
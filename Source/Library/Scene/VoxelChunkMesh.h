@@ -0,0 +1,69 @@
+/*+===================================================================
+  File:      VOXELCHUNKMESH.H
+
+  Summary:   VoxelChunkMesh header file contains declarations of
+             VoxelChunkMesh class, the renderable greedy mesh of one
+             block type in a chunk of the voxel world.
+
+  Classes: VoxelChunkMesh
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/DataTypes.h"
+#include "Renderer/Renderable.h"
+#include "Scene/VoxelMesher.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelChunkMesh
+
+      Summary:  Renderable mesh built by VoxelMesher. Its vertices are
+                in world space and it uses 32-bit indices
+
+      Methods:  Initialize
+                  Initializes the buffers of the mesh
+                Update
+                  Does nothing
+                GetNumVertices
+                  Returns the number of vertices
+                GetNumIndices
+                  Returns the number of indices
+                GetIndexFormat
+                  Returns the 32-bit index format
+                VoxelChunkMesh
+                  Constructor.
+                ~VoxelChunkMesh
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelChunkMesh : public Renderable
+    {
+    public:
+        VoxelChunkMesh(_In_ VoxelMeshData&& meshData, _In_ const XMFLOAT4& outputColor);
+        VoxelChunkMesh(const VoxelChunkMesh& other) = delete;
+        VoxelChunkMesh(VoxelChunkMesh&& other) = delete;
+        VoxelChunkMesh& operator=(const VoxelChunkMesh& other) = delete;
+        VoxelChunkMesh& operator=(VoxelChunkMesh&& other) = delete;
+        ~VoxelChunkMesh() = default;
+
+        virtual HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext) override;
+        virtual void Update(_In_ FLOAT deltaTime) override;
+
+        UINT GetNumVertices() const override;
+        UINT GetNumIndices() const override;
+        DXGI_FORMAT GetIndexFormat() const override;
+
+    protected:
+        const SimpleVertex* getVertices() const override;
+        const WORD* getIndices() const override;
+        HRESULT initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext) override;
+
+    private:
+        std::vector<SimpleVertex> m_aVertices;
+        std::vector<UINT> m_aIndices;
+    };
+}
\ No newline at end of file
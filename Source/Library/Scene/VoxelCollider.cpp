@@ -0,0 +1,494 @@
+#include "Scene/VoxelCollider.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelCollider::VoxelCollider
+
+      Summary:  Constructor. The grid origin is the world position of
+                the lower corner of the cell (0, 0, 0), one cell spans
+                two world units
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map the grid was filled from
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Occupancy of the cells
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_gridOrigin, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelCollider::VoxelCollider(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_gridOrigin()
+        , m_stats()
+    {
+        XMFLOAT3 firstCell = m_heightMap->GetVoxelPosition(0u, 0u, 0u);
+        m_gridOrigin = XMFLOAT3(firstCell.x - 1.0f, firstCell.y - 1.0f, firstCell.z - 1.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelCollider::MoveBox
+
+      Summary:  Sweeps a box along a displacement. On a hit the box
+                stops SKIN short of the surface and the rest of the
+                displacement goes on along it, up to MAX_SLIDES times,
+                so that walking into a wall or a slope glides instead
+                of sticking
+
+      Args:     const XMFLOAT3& center
+                  Center of the box in world space
+                const XMFLOAT3& halfExtents
+                  Half of the size of the box in world units
+                const XMFLOAT3& displacement
+                  Desired movement in world units
+                VoxelCollision& collision
+                  Receives the resolved position and contacts
+                UINT* puNumCells
+                  Receives the number of cells tested
+
+      Returns:  BOOL
+                  TRUE if the box hit a solid cell
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelCollider::MoveBox(_In_ const XMFLOAT3& center, _In_ const XMFLOAT3& halfExtents, _In_ const XMFLOAT3& displacement, _Out_ VoxelCollision& collision, _Out_opt_ UINT* puNumCells) const
+    {
+        // Grid space, where a cell spans one unit
+        const FLOAT aCenter[3] =
+        {
+            (center.x - m_gridOrigin.x) * 0.5f,
+            (center.y - m_gridOrigin.y) * 0.5f,
+            (center.z - m_gridOrigin.z) * 0.5f
+        };
+        const FLOAT aHalfExtents[3] = { halfExtents.x * 0.5f, halfExtents.y * 0.5f, halfExtents.z * 0.5f };
+        const FLOAT aDisplacement[3] = { displacement.x * 0.5f, displacement.y * 0.5f, displacement.z * 0.5f };
+
+        BOOL bCollided = moveBox(aCenter, aHalfExtents, aDisplacement, FALSE, collision, puNumCells);
+        collision.Position = XMFLOAT3(
+            m_gridOrigin.x + collision.Position.x * 2.0f,
+            m_gridOrigin.y + collision.Position.y * 2.0f,
+            m_gridOrigin.z + collision.Position.z * 2.0f
+        );
+        return bCollided;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelCollider::IsBoxFree
+
+      Summary:  Returns whether a box overlaps no solid cell. Touching
+                a face is not an overlap
+
+      Args:     const XMFLOAT3& center
+                  Center of the box in world space
+                const XMFLOAT3& halfExtents
+                  Half of the size of the box in world units
+
+      Returns:  BOOL
+                  TRUE if the box is free
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelCollider::IsBoxFree(_In_ const XMFLOAT3& center, _In_ const XMFLOAT3& halfExtents) const
+    {
+        const FLOAT aMin[3] =
+        {
+            (center.x - halfExtents.x - m_gridOrigin.x) * 0.5f,
+            (center.y - halfExtents.y - m_gridOrigin.y) * 0.5f,
+            (center.z - halfExtents.z - m_gridOrigin.z) * 0.5f
+        };
+        const FLOAT aMax[3] =
+        {
+            (center.x + halfExtents.x - m_gridOrigin.x) * 0.5f,
+            (center.y + halfExtents.y - m_gridOrigin.y) * 0.5f,
+            (center.z + halfExtents.z - m_gridOrigin.z) * 0.5f
+        };
+        const INT aSize[3] =
+        {
+            static_cast<INT>(m_occupancyGrid->GetWidth()),
+            static_cast<INT>(m_occupancyGrid->GetHeight()),
+            static_cast<INT>(m_occupancyGrid->GetDepth())
+        };
+
+        INT aFirst[3];
+        INT aLast[3];
+        for (INT a = 0; a < 3; ++a)
+        {
+            aFirst[a] = std::max<INT>(static_cast<INT>(floorf(aMin[a])), 0);
+            aLast[a] = std::min<INT>(static_cast<INT>(ceilf(aMax[a])) - 1, aSize[a] - 1);
+        }
+
+        for (INT z = aFirst[2]; z <= aLast[2]; ++z)
+        {
+            for (INT x = aFirst[0]; x <= aLast[0]; ++x)
+            {
+                for (INT y = aFirst[1]; y <= aLast[1]; ++y)
+                {
+                    if (m_occupancyGrid->IsOccupied(x, y, z))
+                    {
+                        return FALSE;
+                    }
+                }
+            }
+        }
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelCollider::Benchmark
+
+      Summary:  Moves a box of the size of a standing viewer from
+                pseudo-random free spots just above the terrain in
+                pseudo-random directions, mostly downwards so that most
+                moves hit, and measures the cost of a move. The first
+                uNumBruteForceMoves moves are also swept against every
+                exposed cell, which is what testing the instances one
+                by one amounts to, and their end positions compared
+
+      Args:     UINT uNumMoves
+                  Number of moves
+                UINT uNumBruteForceMoves
+                  Number of moves swept by brute force
+
+      Modifies: [m_stats].
+
+      Returns:  const VoxelCollisionStats&
+                  Statistics of the benchmark
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelCollisionStats& VoxelCollider::Benchmark(_In_ UINT uNumMoves, _In_ UINT uNumBruteForceMoves)
+    {
+        static constexpr const UINT MAX_PLACEMENT_ATTEMPTS = 16u;
+
+        m_stats = {};
+        UINT uWidth = m_occupancyGrid->GetWidth();
+        UINT uHeight = m_occupancyGrid->GetHeight();
+        UINT uDepth = m_occupancyGrid->GetDepth();
+        if (uNumMoves == 0u || uWidth == 0u || uHeight == 0u || uDepth == 0u)
+        {
+            return m_stats;
+        }
+
+        // Moves use a fixed seed so that runs are comparable
+        const XMFLOAT3 halfExtents(0.4f, 0.9f, 0.4f);
+        std::vector<XMFLOAT3> aCenters;
+        std::vector<XMFLOAT3> aDisplacements;
+        aCenters.reserve(uNumMoves);
+        aDisplacements.reserve(uNumMoves);
+        BenchmarkRandom random;
+        for (UINT i = 0u; i < uNumMoves * MAX_PLACEMENT_ATTEMPTS && aCenters.size() < uNumMoves; ++i)
+        {
+            UINT x = std::min<UINT>(static_cast<UINT>(random.GetFloat() * static_cast<FLOAT>(uWidth)), uWidth - 1u);
+            UINT z = std::min<UINT>(static_cast<UINT>(random.GetFloat() * static_cast<FLOAT>(uDepth)), uDepth - 1u);
+            FLOAT y = static_cast<FLOAT>(std::min<UINT>(m_heightMap->GetColumn(x, z).uHeight, uHeight)) + 2.0f * random.GetFloat();
+            XMFLOAT3 center(
+                m_gridOrigin.x + 2.0f * (static_cast<FLOAT>(x) + random.GetFloat()),
+                m_gridOrigin.y + 2.0f * y + halfExtents.y,
+                m_gridOrigin.z + 2.0f * (static_cast<FLOAT>(z) + random.GetFloat())
+            );
+            if (!IsBoxFree(center, halfExtents))
+            {
+                continue;
+            }
+
+            aCenters.push_back(center);
+            aDisplacements.push_back(XMFLOAT3(4.0f * random.GetFloat() - 2.0f, -3.0f * random.GetFloat() + 0.5f, 4.0f * random.GetFloat() - 2.0f));
+        }
+        uNumMoves = static_cast<UINT>(aCenters.size());
+        uNumBruteForceMoves = std::min<UINT>(uNumBruteForceMoves, uNumMoves);
+        if (uNumMoves == 0u)
+        {
+            return m_stats;
+        }
+
+        BenchmarkTimer timer;
+        std::vector<VoxelCollision> aCollisions(uNumMoves);
+        UINT64 ullNumCells = 0ull;
+        timer.Start();
+        for (UINT i = 0u; i < uNumMoves; ++i)
+        {
+            UINT uNumCells = 0u;
+            m_stats.uNumCollisions += MoveBox(aCenters[i], halfExtents, aDisplacements[i], aCollisions[i], &uNumCells) ? 1u : 0u;
+            ullNumCells += uNumCells;
+        }
+        FLOAT seconds = timer.GetSeconds();
+        m_stats.MicrosecondsPerMove = seconds * 1.0e6f / static_cast<FLOAT>(uNumMoves);
+        m_stats.uNumMoves = uNumMoves;
+        m_stats.AverageCellsPerMove = static_cast<FLOAT>(static_cast<double>(ullNumCells) / static_cast<double>(uNumMoves));
+        m_stats.bIdentical = TRUE;
+
+        timer.Start();
+        for (UINT i = 0u; i < uNumBruteForceMoves; ++i)
+        {
+            const FLOAT aCenter[3] =
+            {
+                (aCenters[i].x - m_gridOrigin.x) * 0.5f,
+                (aCenters[i].y - m_gridOrigin.y) * 0.5f,
+                (aCenters[i].z - m_gridOrigin.z) * 0.5f
+            };
+            const FLOAT aHalfExtents[3] = { halfExtents.x * 0.5f, halfExtents.y * 0.5f, halfExtents.z * 0.5f };
+            const FLOAT aDisplacement[3] = { aDisplacements[i].x * 0.5f, aDisplacements[i].y * 0.5f, aDisplacements[i].z * 0.5f };
+
+            VoxelCollision bruteForceCollision;
+            moveBox(aCenter, aHalfExtents, aDisplacement, TRUE, bruteForceCollision, nullptr);
+            const XMFLOAT3& position = aCollisions[i].Position;
+            if (bruteForceCollision.bCollided != aCollisions[i].bCollided ||
+                fabsf(m_gridOrigin.x + bruteForceCollision.Position.x * 2.0f - position.x) > 1.0e-3f ||
+                fabsf(m_gridOrigin.y + bruteForceCollision.Position.y * 2.0f - position.y) > 1.0e-3f ||
+                fabsf(m_gridOrigin.z + bruteForceCollision.Position.z * 2.0f - position.z) > 1.0e-3f)
+            {
+                m_stats.bIdentical = FALSE;
+            }
+        }
+        seconds = timer.GetSeconds();
+        m_stats.uNumBruteForceMoves = uNumBruteForceMoves;
+        m_stats.BruteForceMicrosecondsPerMove = uNumBruteForceMoves > 0u ? seconds * 1.0e6f / static_cast<FLOAT>(uNumBruteForceMoves) : 0.0f;
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"VoxelCollider: %u moves, %u collisions, %.1f cells per move, %.3f us per move, brute force %.1f us per move, %s\n",
+            m_stats.uNumMoves,
+            m_stats.uNumCollisions,
+            m_stats.AverageCellsPerMove,
+            m_stats.MicrosecondsPerMove,
+            m_stats.BruteForceMicrosecondsPerMove,
+            m_stats.bIdentical ? L"identical" : L"MISMATCH"
+        );
+        OutputDebugString(szReport);
+
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelCollider::GetStats
+
+      Summary:  Returns the statistics of the last benchmark
+
+      Returns:  const VoxelCollisionStats&
+                  Statistics of the last benchmark
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelCollisionStats& VoxelCollider::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelCollider::moveBox
+
+      Summary:  Sweeps a box in grid space and slides it along the
+                cells it hits
+
+      Args:     const FLOAT* pCenter
+                  Center of the box in grid space
+                const FLOAT* pHalfExtents
+                  Half of the size of the box in cells
+                const FLOAT* pDisplacement
+                  Desired movement in cells
+                BOOL bBruteForce
+                  Whether to test every exposed cell of the grid
+                VoxelCollision& collision
+                  Receives the resolved position in grid space and the
+                  contacts
+                UINT* puNumCells
+                  Receives the number of cells tested
+
+      Returns:  BOOL
+                  TRUE if the box hit a solid cell
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelCollider::moveBox(_In_reads_(3) const FLOAT* pCenter, _In_reads_(3) const FLOAT* pHalfExtents, _In_reads_(3) const FLOAT* pDisplacement, _In_ BOOL bBruteForce, _Out_ VoxelCollision& collision, _Out_opt_ UINT* puNumCells) const
+    {
+        collision = {};
+
+        FLOAT aCenter[3] = { pCenter[0], pCenter[1], pCenter[2] };
+        FLOAT aDisplacement[3] = { pDisplacement[0], pDisplacement[1], pDisplacement[2] };
+        UINT uNumCells = 0u;
+        for (UINT uSlide = 0u; uSlide <= MAX_SLIDES; ++uSlide)
+        {
+            if (aDisplacement[0] == 0.0f && aDisplacement[1] == 0.0f && aDisplacement[2] == 0.0f)
+            {
+                break;
+            }
+
+            FLOAT t = 1.0f;
+            INT iAxis = findContact(aCenter, pHalfExtents, aDisplacement, bBruteForce, t, uNumCells);
+            if (iAxis < 0)
+            {
+                aCenter[0] += aDisplacement[0];
+                aCenter[1] += aDisplacement[1];
+                aCenter[2] += aDisplacement[2];
+                break;
+            }
+
+            if (!collision.bCollided)
+            {
+                FLOAT aNormal[3] = { 0.0f, 0.0f, 0.0f };
+                aNormal[iAxis] = aDisplacement[iAxis] > 0.0f ? -1.0f : 1.0f;
+                collision.Normal = XMFLOAT3(aNormal[0], aNormal[1], aNormal[2]);
+                collision.bCollided = TRUE;
+            }
+
+            // Stop short of the face so that the next sweep starts
+            // outside of the cell, then keep what is left along it
+            t = std::max<FLOAT>(t - SKIN / fabsf(aDisplacement[iAxis]), 0.0f);
+            for (INT a = 0; a < 3; ++a)
+            {
+                aCenter[a] += aDisplacement[a] * t;
+                aDisplacement[a] *= 1.0f - t;
+            }
+            aDisplacement[iAxis] = 0.0f;
+            ++collision.uNumContacts;
+        }
+
+        collision.Position = XMFLOAT3(aCenter[0], aCenter[1], aCenter[2]);
+        if (puNumCells)
+        {
+            *puNumCells = uNumCells;
+        }
+
+        return collision.bCollided;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelCollider::findContact
+
+      Summary:  Returns the earliest solid cell a box hits along a
+                displacement. Only the cells of the box bounding the
+                start and the end of the sweep can be hit, and their
+                occupancy is read a column at a time. Among hits at the
+                same time the lowest axis wins, so that both ways of
+                gathering the cells agree
+
+      Args:     const FLOAT* pCenter
+                  Center of the box in grid space
+                const FLOAT* pHalfExtents
+                  Half of the size of the box in cells
+                const FLOAT* pDisplacement
+                  Movement in cells
+                BOOL bBruteForce
+                  Whether to test every exposed cell of the grid
+                FLOAT& t
+                  Receives the fraction of the displacement before the
+                  hit
+                UINT& uNumCells
+                  Incremented by the number of cells tested
+
+      Returns:  INT
+                  Axis of the face hit, -1 if none
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    INT VoxelCollider::findContact(_In_reads_(3) const FLOAT* pCenter, _In_reads_(3) const FLOAT* pHalfExtents, _In_reads_(3) const FLOAT* pDisplacement, _In_ BOOL bBruteForce, _Out_ FLOAT& t, _Inout_ UINT& uNumCells) const
+    {
+        const INT aSize[3] =
+        {
+            static_cast<INT>(m_occupancyGrid->GetWidth()),
+            static_cast<INT>(m_occupancyGrid->GetHeight()),
+            static_cast<INT>(m_occupancyGrid->GetDepth())
+        };
+
+        INT aFirst[3] = { 0, 0, 0 };
+        INT aLast[3] = { aSize[0] - 1, aSize[1] - 1, aSize[2] - 1 };
+        if (!bBruteForce)
+        {
+            for (INT a = 0; a < 3; ++a)
+            {
+                FLOAT lower = pCenter[a] - pHalfExtents[a] + std::min<FLOAT>(pDisplacement[a], 0.0f);
+                FLOAT upper = pCenter[a] + pHalfExtents[a] + std::max<FLOAT>(pDisplacement[a], 0.0f);
+                aFirst[a] = std::max<INT>(static_cast<INT>(floorf(lower)), 0);
+                aLast[a] = std::min<INT>(static_cast<INT>(ceilf(upper)) - 1, aSize[a] - 1);
+            }
+        }
+
+        t = 1.0f;
+        INT iAxis = -1;
+        for (INT z = aFirst[2]; z <= aLast[2]; ++z)
+        {
+            for (INT x = aFirst[0]; x <= aLast[0]; ++x)
+            {
+                const UINT64* pWords = m_occupancyGrid->GetColumnWords(x, z);
+                for (INT y = aFirst[1]; y <= aLast[1]; ++y)
+                {
+                    ++uNumCells;
+                    if (bBruteForce)
+                    {
+                        if (!m_occupancyGrid->IsExposed(x, y, z))
+                        {
+                            continue;
+                        }
+                    }
+                    else if (!((pWords[static_cast<UINT>(y) / OccupancyGrid::BITS_PER_WORD] >> (static_cast<UINT>(y) % OccupancyGrid::BITS_PER_WORD)) & 1ull))
+                    {
+                        continue;
+                    }
+
+                    const INT aCell[3] = { x, y, z };
+                    FLOAT tCell;
+                    INT iCellAxis = sweepCell(pCenter, pHalfExtents, pDisplacement, aCell, tCell);
+                    if (iCellAxis >= 0 && (tCell < t || (tCell == t && (iAxis < 0 || iCellAxis < iAxis))))
+                    {
+                        t = tCell;
+                        iAxis = iCellAxis;
+                    }
+                }
+            }
+        }
+
+        return iAxis;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelCollider::sweepCell
+
+      Summary:  Sweeps a box against one cell: the box enters the cell
+                when it has entered the slab of the cell along every
+                axis. A box already overlapping the cell, or merely
+                touching it along an axis it does not move on, does not
+                hit it
+
+      Args:     const FLOAT* pCenter
+                  Center of the box in grid space
+                const FLOAT* pHalfExtents
+                  Half of the size of the box in cells
+                const FLOAT* pDisplacement
+                  Movement in cells
+                const INT* pCell
+                  Cell to sweep against
+                FLOAT& t
+                  Receives the fraction of the displacement at the hit
+
+      Returns:  INT
+                  Axis of the face hit, -1 if none
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    INT VoxelCollider::sweepCell(_In_reads_(3) const FLOAT* pCenter, _In_reads_(3) const FLOAT* pHalfExtents, _In_reads_(3) const FLOAT* pDisplacement, _In_reads_(3) const INT* pCell, _Out_ FLOAT& t)
+    {
+        FLOAT tEnter = -FLT_MAX;
+        FLOAT tExit = FLT_MAX;
+        INT iAxis = -1;
+        for (INT a = 0; a < 3; ++a)
+        {
+            FLOAT boxMin = pCenter[a] - pHalfExtents[a];
+            FLOAT boxMax = pCenter[a] + pHalfExtents[a];
+            FLOAT cellMin = static_cast<FLOAT>(pCell[a]);
+            FLOAT cellMax = static_cast<FLOAT>(pCell[a] + 1);
+            if (pDisplacement[a] == 0.0f)
+            {
+                if (boxMax <= cellMin || boxMin >= cellMax)
+                {
+                    return -1;
+                }
+                continue;
+            }
+
+            FLOAT t0 = pDisplacement[a] > 0.0f ? (cellMin - boxMax) / pDisplacement[a] : (cellMax - boxMin) / pDisplacement[a];
+            FLOAT t1 = pDisplacement[a] > 0.0f ? (cellMax - boxMin) / pDisplacement[a] : (cellMin - boxMax) / pDisplacement[a];
+            if (t0 > tEnter)
+            {
+                tEnter = t0;
+                iAxis = a;
+            }
+            tExit = std::min<FLOAT>(tExit, t1);
+        }
+
+        t = tEnter;
+        if (iAxis < 0 || tEnter >= tExit || tEnter < 0.0f || tEnter > 1.0f)
+        {
+            return -1;
+        }
+
+        return iAxis;
+    }
+}
\ No newline at end of file
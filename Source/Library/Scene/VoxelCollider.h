@@ -0,0 +1,125 @@
+/*+===================================================================
+  File:      VOXELCOLLIDER.H
+
+  Summary:   VoxelCollider header file contains declarations of
+             VoxelCollider class that sweeps boxes through the voxel
+             occupancy grid and slides them along the surfaces they
+             hit.
+
+  Classes: VoxelCollider
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <cfloat>
+
+#include "Game/Benchmark.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelCollision
+
+        Summary:  Outcome of a move: the center the box ends at, the
+                  normal of the first surface it hit, the number of
+                  surfaces it slid along, and whether it hit any
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelCollision
+    {
+        XMFLOAT3 Position;
+        XMFLOAT3 Normal;
+        UINT uNumContacts;
+        BOOL bCollided;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelCollisionStats
+
+        Summary:  Cost of a move in microseconds, sweeping only the
+                  cells around the path against sweeping every exposed
+                  cell as a test of the instances would, the average
+                  number of cells tested by a move, and whether both
+                  end every move at the same place
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelCollisionStats
+    {
+        UINT uNumMoves;
+        UINT uNumBruteForceMoves;
+        UINT uNumCollisions;
+        FLOAT AverageCellsPerMove;
+        FLOAT MicrosecondsPerMove;
+        FLOAT BruteForceMicrosecondsPerMove;
+        BOOL bIdentical;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelCollider
+
+      Summary:  Moves axis-aligned boxes through the occupancy grid. The
+                box is swept along its displacement against the solid
+                cells of the box around its path only, so a move costs
+                a handful of cells whatever the size of the world. On a
+                hit the box stops short of the surface and the rest of
+                the displacement goes on along it with the component
+                into the surface removed. Cells the box already
+                overlaps are ignored so that it can always leave them.
+                The class holds no device state and can be tested on
+                its own
+
+      Methods:  MoveBox
+                  Sweeps a box and slides it along what it hits
+                IsBoxFree
+                  Returns whether a box overlaps no solid cell
+                Benchmark
+                  Measures the moves against a brute-force sweep
+                GetStats
+                  Returns the statistics of the last benchmark
+                moveBox
+                  Sweeps a box in grid space
+                findContact
+                  Returns the earliest cell a box hits
+                sweepCell
+                  Sweeps a box against one cell
+                VoxelCollider
+                  Constructor.
+                ~VoxelCollider
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelCollider
+    {
+    public:
+        static constexpr const UINT MAX_SLIDES = 3u;
+        static constexpr const FLOAT SKIN = 1.0e-3f;
+        static constexpr const UINT BENCHMARK_BRUTE_FORCE_MOVES = 16u;
+
+        VoxelCollider(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid);
+        VoxelCollider(const VoxelCollider& other) = delete;
+        VoxelCollider(VoxelCollider&& other) = delete;
+        VoxelCollider& operator=(const VoxelCollider& other) = delete;
+        VoxelCollider& operator=(VoxelCollider&& other) = delete;
+        ~VoxelCollider() = default;
+
+        BOOL MoveBox(_In_ const XMFLOAT3& center, _In_ const XMFLOAT3& halfExtents, _In_ const XMFLOAT3& displacement, _Out_ VoxelCollision& collision, _Out_opt_ UINT* puNumCells = nullptr) const;
+        BOOL IsBoxFree(_In_ const XMFLOAT3& center, _In_ const XMFLOAT3& halfExtents) const;
+        const VoxelCollisionStats& Benchmark(_In_ UINT uNumMoves, _In_ UINT uNumBruteForceMoves);
+
+        const VoxelCollisionStats& GetStats() const;
+
+    private:
+        BOOL moveBox(_In_reads_(3) const FLOAT* pCenter, _In_reads_(3) const FLOAT* pHalfExtents, _In_reads_(3) const FLOAT* pDisplacement, _In_ BOOL bBruteForce, _Out_ VoxelCollision& collision, _Out_opt_ UINT* puNumCells) const;
+        INT findContact(_In_reads_(3) const FLOAT* pCenter, _In_reads_(3) const FLOAT* pHalfExtents, _In_reads_(3) const FLOAT* pDisplacement, _In_ BOOL bBruteForce, _Out_ FLOAT& t, _Inout_ UINT& uNumCells) const;
+
+        static INT sweepCell(_In_reads_(3) const FLOAT* pCenter, _In_reads_(3) const FLOAT* pHalfExtents, _In_reads_(3) const FLOAT* pDisplacement, _In_reads_(3) const INT* pCell, _Out_ FLOAT& t);
+
+    private:
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        XMFLOAT3 m_gridOrigin;
+        VoxelCollisionStats m_stats;
+    };
+}
\ No newline at end of file
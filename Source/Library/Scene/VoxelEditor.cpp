@@ -0,0 +1,506 @@
+#include "Scene/VoxelEditor.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::VoxelEditor
+
+      Summary:  Constructor. Creates a voxel per color of the palette
+                with an instance per exposed cell
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map giving the block type of each column
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Solid cells of the world, edited in place
+                std::vector<std::vector<XMUINT3>>&& aCells
+                  Exposed cells, one bucket per color of the palette,
+                  as filled by VoxelInstanceBuilder
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_voxels,
+                 m_aInstanceKeys, m_instanceLocations,
+                 m_placedBlockTypes, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelEditor::VoxelEditor(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid, _In_ std::vector<std::vector<XMUINT3>>&& aCells)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_voxels()
+        , m_aInstanceKeys()
+        , m_instanceLocations()
+        , m_placedBlockTypes()
+        , m_stats()
+    {
+        const std::vector<XMFLOAT4>& aPalette = m_heightMap->GetPalette();
+        m_voxels.reserve(aPalette.size());
+        m_aInstanceKeys.resize(aPalette.size());
+
+        size_t uNumInstances = 0u;
+        for (size_t uVoxelIdx = 0u; uVoxelIdx < aCells.size() && uVoxelIdx < aPalette.size(); ++uVoxelIdx)
+        {
+            uNumInstances += aCells[uVoxelIdx].size();
+        }
+        m_instanceLocations.reserve(uNumInstances);
+
+        for (size_t uVoxelIdx = 0u; uVoxelIdx < aPalette.size(); ++uVoxelIdx)
+        {
+            std::vector<InstanceData> aInstanceData;
+            if (uVoxelIdx < aCells.size())
+            {
+                aInstanceData.reserve(aCells[uVoxelIdx].size());
+                m_aInstanceKeys[uVoxelIdx].reserve(aCells[uVoxelIdx].size());
+                for (const XMUINT3& cell : aCells[uVoxelIdx])
+                {
+                    XMFLOAT3 position = m_heightMap->GetVoxelPosition(cell.x, cell.y, cell.z);
+                    UINT64 ullKey = getKey(cell.x, cell.y, cell.z);
+
+                    m_instanceLocations.emplace(ullKey, InstanceLocation{ .uVoxelIdx = static_cast<UINT>(uVoxelIdx), .uInstanceIdx = static_cast<UINT>(aInstanceData.size()) });
+                    m_aInstanceKeys[uVoxelIdx].push_back(ullKey);
+                    aInstanceData.push_back(InstanceData{ .Transformation = XMMatrixTranslation(position.x, position.y, position.z) });
+                }
+                std::vector<XMUINT3>().swap(aCells[uVoxelIdx]);
+            }
+
+            m_voxels.push_back(std::make_shared<Voxel>(std::move(aInstanceData), aPalette[uVoxelIdx]));
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::PlaceBlock
+
+      Summary:  Makes a cell solid with the given block type and
+                updates the instances of the cell and its neighbours
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+                CHAR blockType
+                  Block type of the new block
+
+      Modifies: [m_occupancyGrid, m_voxels, m_aInstanceKeys,
+                 m_instanceLocations, m_placedBlockTypes, m_stats].
+
+      Returns:  HRESULT
+                  S_FALSE if the cell already holds that block,
+                  E_INVALIDARG if the cell is outside of the grid or
+                  the block type is not in the palette
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelEditor::PlaceBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ CHAR blockType)
+    {
+        if (x >= m_occupancyGrid->GetWidth() || y >= m_occupancyGrid->GetHeight() || z >= m_occupancyGrid->GetDepth()
+            || getVoxelIdx(blockType) == INVALID_VOXEL_IDX)
+        {
+            return E_INVALIDARG;
+        }
+
+        INT iX = static_cast<INT>(x);
+        INT iY = static_cast<INT>(y);
+        INT iZ = static_cast<INT>(z);
+        if (m_occupancyGrid->IsOccupied(iX, iY, iZ) && GetBlockType(iX, iY, iZ) == blockType)
+        {
+            return S_FALSE;
+        }
+
+        UINT64 ullKey = getKey(x, y, z);
+        if (blockType == m_heightMap->GetColumn(x, z).BlockType)
+        {
+            m_placedBlockTypes.erase(ullKey);
+        }
+        else
+        {
+            m_placedBlockTypes[ullKey] = blockType;
+        }
+
+        m_occupancyGrid->SetOccupied(x, y, z, TRUE);
+        refreshCell(iX, iY, iZ);
+        refreshCell(iX - 1, iY, iZ);
+        refreshCell(iX + 1, iY, iZ);
+        refreshCell(iX, iY - 1, iZ);
+        refreshCell(iX, iY + 1, iZ);
+        refreshCell(iX, iY, iZ - 1);
+        refreshCell(iX, iY, iZ + 1);
+
+        ++m_stats.ullNumPlacedBlocks;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::RemoveBlock
+
+      Summary:  Makes a cell empty and updates the instances of the
+                cell and its neighbours, which may now be exposed
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+
+      Modifies: [m_occupancyGrid, m_voxels, m_aInstanceKeys,
+                 m_instanceLocations, m_placedBlockTypes, m_stats].
+
+      Returns:  HRESULT
+                  S_FALSE if the cell was already empty, E_INVALIDARG
+                  if it is outside of the grid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelEditor::RemoveBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z)
+    {
+        if (x >= m_occupancyGrid->GetWidth() || y >= m_occupancyGrid->GetHeight() || z >= m_occupancyGrid->GetDepth())
+        {
+            return E_INVALIDARG;
+        }
+
+        INT iX = static_cast<INT>(x);
+        INT iY = static_cast<INT>(y);
+        INT iZ = static_cast<INT>(z);
+        if (!m_occupancyGrid->IsOccupied(iX, iY, iZ))
+        {
+            return S_FALSE;
+        }
+
+        m_placedBlockTypes.erase(getKey(x, y, z));
+        m_occupancyGrid->SetOccupied(x, y, z, FALSE);
+        refreshCell(iX, iY, iZ);
+        refreshCell(iX - 1, iY, iZ);
+        refreshCell(iX + 1, iY, iZ);
+        refreshCell(iX, iY - 1, iZ);
+        refreshCell(iX, iY + 1, iZ);
+        refreshCell(iX, iY, iZ - 1);
+        refreshCell(iX, iY, iZ + 1);
+
+        ++m_stats.ullNumRemovedBlocks;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::GetBlockType
+
+      Summary:  Returns the block type of a cell, the one it was placed
+                with or else the one of its column
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  CHAR
+                  Block type of the cell, 0 if it is empty
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    CHAR VoxelEditor::GetBlockType(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        if (!m_occupancyGrid->IsOccupied(x, y, z))
+        {
+            return 0;
+        }
+
+        auto it = m_placedBlockTypes.find(getKey(static_cast<UINT>(x), static_cast<UINT>(y), static_cast<UINT>(z)));
+        if (it != m_placedBlockTypes.end())
+        {
+            return it->second;
+        }
+
+        return m_heightMap->GetColumn(static_cast<UINT>(x), static_cast<UINT>(z)).BlockType;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::HasInstance
+
+      Summary:  Returns whether a cell is instanced
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+
+      Returns:  BOOL
+                  TRUE if one of the voxels draws the cell
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelEditor::HasInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        return m_instanceLocations.contains(getKey(x, y, z));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::GetInstanceLocation
+
+      Summary:  Returns the voxel and the instance that draw a cell.
+                The instance index changes when an instance after it is
+                removed, so it only holds until the next edit
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+                UINT& uVoxelIdx
+                  Receives the index of the voxel
+                UINT& uInstanceIdx
+                  Receives the index of the instance in the voxel
+
+      Returns:  BOOL
+                  TRUE if one of the voxels draws the cell
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelEditor::GetInstanceLocation(_In_ UINT x, _In_ UINT y, _In_ UINT z, _Out_ UINT& uVoxelIdx, _Out_ UINT& uInstanceIdx) const
+    {
+        uVoxelIdx = INVALID_VOXEL_IDX;
+        uInstanceIdx = 0u;
+
+        auto it = m_instanceLocations.find(getKey(x, y, z));
+        if (it == m_instanceLocations.end())
+        {
+            return FALSE;
+        }
+
+        uVoxelIdx = it->second.uVoxelIdx;
+        uInstanceIdx = it->second.uInstanceIdx;
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::Flush
+
+      Summary:  Uploads the dirty instance ranges of every voxel
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to grow the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to update the buffers
+
+      Modifies: [m_voxels, m_stats].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelEditor::Flush(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        UINT uNumDirty = GetNumDirtyInstances();
+        if (uNumDirty == 0u)
+        {
+            return S_OK;
+        }
+
+        BenchmarkTimer timer;
+
+        for (const std::shared_ptr<Voxel>& voxel : m_voxels)
+        {
+            HRESULT hr = voxel->UpdateInstanceBuffer(pDevice, pImmediateContext);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        m_stats.LastFlushMilliseconds = timer.GetMilliseconds();
+        m_stats.ullNumUploadedInstances += uNumDirty;
+        ++m_stats.ullNumFlushes;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::GetVoxels
+
+      Summary:  Returns the voxels, one per color of the palette. Empty
+                ones are kept so that blocks of any type can be placed
+
+      Returns:  const std::vector<std::shared_ptr<Voxel>>&
+                  Voxels indexed by color
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<std::shared_ptr<Voxel>>& VoxelEditor::GetVoxels() const
+    {
+        return m_voxels;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::GetNumDirtyInstances
+
+      Summary:  Returns the number of instances the next flush uploads
+
+      Returns:  UINT
+                  Number of dirty instances over every voxel
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelEditor::GetNumDirtyInstances() const
+    {
+        UINT uNumDirty = 0u;
+        for (const std::shared_ptr<Voxel>& voxel : m_voxels)
+        {
+            uNumDirty += voxel->GetDirtyInstances().GetNumDirty();
+        }
+
+        return uNumDirty;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::GetStats
+
+      Summary:  Returns the edit statistics
+
+      Returns:  const VoxelEditStats&
+                  Edit statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelEditStats& VoxelEditor::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::refreshCell
+
+      Summary:  Brings the instance of a cell in line with the grid: an
+                exposed cell is instanced by the voxel of its block
+                type, any other cell is not
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Modifies: [m_voxels, m_aInstanceKeys, m_instanceLocations,
+                 m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelEditor::refreshCell(_In_ INT x, _In_ INT y, _In_ INT z)
+    {
+        if (x < 0 || y < 0 || z < 0
+            || static_cast<UINT>(x) >= m_occupancyGrid->GetWidth()
+            || static_cast<UINT>(y) >= m_occupancyGrid->GetHeight()
+            || static_cast<UINT>(z) >= m_occupancyGrid->GetDepth())
+        {
+            return;
+        }
+
+        UINT uVoxelIdx = m_occupancyGrid->IsExposed(x, y, z) ? getVoxelIdx(GetBlockType(x, y, z)) : INVALID_VOXEL_IDX;
+        UINT64 ullKey = getKey(static_cast<UINT>(x), static_cast<UINT>(y), static_cast<UINT>(z));
+
+        auto it = m_instanceLocations.find(ullKey);
+        if (it != m_instanceLocations.end())
+        {
+            if (it->second.uVoxelIdx == uVoxelIdx)
+            {
+                return;
+            }
+            removeInstance(ullKey);
+        }
+
+        if (uVoxelIdx != INVALID_VOXEL_IDX)
+        {
+            addInstance(uVoxelIdx, static_cast<UINT>(x), static_cast<UINT>(y), static_cast<UINT>(z));
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::addInstance
+
+      Summary:  Appends the instance of a cell to a voxel
+
+      Args:     UINT uVoxelIdx
+                  Index of the voxel
+                UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+
+      Modifies: [m_voxels, m_aInstanceKeys, m_instanceLocations,
+                 m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelEditor::addInstance(_In_ UINT uVoxelIdx, _In_ UINT x, _In_ UINT y, _In_ UINT z)
+    {
+        XMFLOAT3 position = m_heightMap->GetVoxelPosition(x, y, z);
+        UINT uInstanceIdx = m_voxels[uVoxelIdx]->AddInstance(InstanceData{ .Transformation = XMMatrixTranslation(position.x, position.y, position.z) });
+
+        UINT64 ullKey = getKey(x, y, z);
+        m_aInstanceKeys[uVoxelIdx].push_back(ullKey);
+        m_instanceLocations[ullKey] = InstanceLocation{ .uVoxelIdx = uVoxelIdx, .uInstanceIdx = uInstanceIdx };
+
+        ++m_stats.ullNumAddedInstances;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::removeInstance
+
+      Summary:  Removes the instance of a cell. The last instance of
+                the voxel moves into the freed slot, and its location
+                follows
+
+      Args:     UINT64 ullKey
+                  Key of the instanced cell
+
+      Modifies: [m_voxels, m_aInstanceKeys, m_instanceLocations,
+                 m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelEditor::removeInstance(_In_ UINT64 ullKey)
+    {
+        auto it = m_instanceLocations.find(ullKey);
+        assert(it != m_instanceLocations.end());
+
+        InstanceLocation location = it->second;
+        m_instanceLocations.erase(it);
+
+        std::vector<UINT64>& aKeys = m_aInstanceKeys[location.uVoxelIdx];
+        m_voxels[location.uVoxelIdx]->RemoveInstance(location.uInstanceIdx);
+        if (location.uInstanceIdx + 1u != aKeys.size())
+        {
+            aKeys[location.uInstanceIdx] = aKeys.back();
+            m_instanceLocations[aKeys[location.uInstanceIdx]].uInstanceIdx = location.uInstanceIdx;
+        }
+        aKeys.pop_back();
+
+        ++m_stats.ullNumRemovedInstances;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::getVoxelIdx
+
+      Summary:  Returns the voxel drawing a block type
+
+      Args:     CHAR blockType
+                  Block type
+
+      Returns:  UINT
+                  Index of the voxel, INVALID_VOXEL_IDX if the block
+                  type is not in the palette
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelEditor::getVoxelIdx(_In_ CHAR blockType) const
+    {
+        size_t uVoxelIdx = static_cast<size_t>(blockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+        if (blockType < static_cast<CHAR>(eBlockType::GRASSLAND) || uVoxelIdx >= m_voxels.size())
+        {
+            return INVALID_VOXEL_IDX;
+        }
+
+        return static_cast<UINT>(uVoxelIdx);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelEditor::getKey
+
+      Summary:  Packs the indices of a cell into a 64-bit key, 21 bits
+                per axis
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+
+      Returns:  UINT64
+                  Key of the cell
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 VoxelEditor::getKey(_In_ UINT x, _In_ UINT y, _In_ UINT z)
+    {
+        return (static_cast<UINT64>(x) << 42u) | (static_cast<UINT64>(y) << 21u) | static_cast<UINT64>(z);
+    }
+}
\ No newline at end of file
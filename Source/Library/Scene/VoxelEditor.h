@@ -0,0 +1,124 @@
+/*+===================================================================
+  File:      VOXELEDITOR.H
+
+  Summary:   VoxelEditor header file contains declarations of
+             VoxelEditor class that places and removes blocks of the
+             instanced voxels in place.
+
+  Classes: VoxelEditor
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Game/Benchmark.h"
+#include "Renderer/DataTypes.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/Voxel.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelEditStats
+
+        Summary:  Blocks placed and removed, instances added and removed
+                  as a consequence, and the instances uploaded by the
+                  flushes with the time the last flush took
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelEditStats
+    {
+        UINT64 ullNumPlacedBlocks;
+        UINT64 ullNumRemovedBlocks;
+        UINT64 ullNumAddedInstances;
+        UINT64 ullNumRemovedInstances;
+        UINT64 ullNumUploadedInstances;
+        UINT64 ullNumFlushes;
+        FLOAT LastFlushMilliseconds;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelEditor
+
+      Summary:  Owns one voxel per color of the palette and keeps their
+                instances in step with the occupancy grid as blocks are
+                placed and removed. An edit only revisits the cell and
+                its six neighbours: instances are appended or removed
+                by moving the last instance into the freed slot, and
+                the touched slots are marked dirty so that Flush
+                uploads those ranges alone. Everything but Flush works
+                without a device
+
+      Methods:  PlaceBlock
+                  Makes a cell solid with the given block type
+                RemoveBlock
+                  Makes a cell empty
+                GetBlockType
+                  Returns the block type of a cell
+                HasInstance
+                  Returns whether a cell is instanced
+                GetInstanceLocation
+                  Returns the voxel and the instance that draw a cell
+                Flush
+                  Uploads the dirty instance ranges of every voxel
+                GetVoxels
+                  Returns the voxels, one per color of the palette
+                GetNumDirtyInstances
+                  Returns the number of instances waiting for upload
+                GetStats
+                  Returns the edit statistics
+                VoxelEditor
+                  Constructor.
+                ~VoxelEditor
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelEditor
+    {
+    public:
+        VoxelEditor(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid, _In_ std::vector<std::vector<XMUINT3>>&& aCells);
+        VoxelEditor(const VoxelEditor& other) = delete;
+        VoxelEditor(VoxelEditor&& other) = delete;
+        VoxelEditor& operator=(const VoxelEditor& other) = delete;
+        VoxelEditor& operator=(VoxelEditor&& other) = delete;
+        ~VoxelEditor() = default;
+
+        HRESULT PlaceBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ CHAR blockType);
+        HRESULT RemoveBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z);
+        CHAR GetBlockType(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        BOOL HasInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+        BOOL GetInstanceLocation(_In_ UINT x, _In_ UINT y, _In_ UINT z, _Out_ UINT& uVoxelIdx, _Out_ UINT& uInstanceIdx) const;
+
+        HRESULT Flush(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+
+        const std::vector<std::shared_ptr<Voxel>>& GetVoxels() const;
+        UINT GetNumDirtyInstances() const;
+        const VoxelEditStats& GetStats() const;
+
+    private:
+        struct InstanceLocation
+        {
+            UINT uVoxelIdx;
+            UINT uInstanceIdx;
+        };
+
+        void refreshCell(_In_ INT x, _In_ INT y, _In_ INT z);
+        void addInstance(_In_ UINT uVoxelIdx, _In_ UINT x, _In_ UINT y, _In_ UINT z);
+        void removeInstance(_In_ UINT64 ullKey);
+        UINT getVoxelIdx(_In_ CHAR blockType) const;
+
+        static UINT64 getKey(_In_ UINT x, _In_ UINT y, _In_ UINT z);
+
+    private:
+        static constexpr const UINT INVALID_VOXEL_IDX = UINT_MAX;
+
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        std::vector<std::shared_ptr<Voxel>> m_voxels;
+        std::vector<std::vector<UINT64>> m_aInstanceKeys;
+        std::unordered_map<UINT64, InstanceLocation> m_instanceLocations;
+        std::unordered_map<UINT64, CHAR> m_placedBlockTypes;
+        VoxelEditStats m_stats;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,455 @@
+#include "Scene/VoxelInstanceBuilder.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::VoxelInstanceBuilder
+
+      Summary:  Constructor
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map giving the block type of each column
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Solid cells of the world
+                BOOL bCollapseRuns
+                  Whether each vertical run of exposed voxels becomes a
+                  single instance
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_bCollapseRuns].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelInstanceBuilder::VoxelInstanceBuilder(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid, _In_ BOOL bCollapseRuns)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_bCollapseRuns(bCollapseRuns)
+    { }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::getMaxRunLength
+
+      Summary:  Returns the longest run a single instance can hold. A
+                matrix stretches over any run of the grid
+
+      Returns:  UINT
+                  Maximum number of voxels of a run, 1 when runs are
+                  not collapsed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class T>
+    UINT VoxelInstanceBuilder::getMaxRunLength() const
+    {
+        return m_bCollapseRuns ? m_occupancyGrid->GetHeight() : 1u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::getMaxRunLength
+
+      Summary:  Returns the longest run a packed instance can hold,
+                runs being split at VoxelPacker::MAX_RUN_LENGTH
+
+      Returns:  UINT
+                  Maximum number of voxels of a run, 1 when runs are
+                  not collapsed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <>
+    UINT VoxelInstanceBuilder::getMaxRunLength<PackedInstanceData>() const
+    {
+        return m_bCollapseRuns ? VoxelPacker::MAX_RUN_LENGTH : 1u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::BuildRegion
+
+      Summary:  Appends the instances of the exposed voxels of a
+                rectangle of columns, row by row along z, into buckets
+                indexed by block type
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                std::vector<std::vector<InstanceData>>& aInstanceData
+                  Buckets of instances, one per color of the palette
+
+      Modifies: [aInstanceData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelInstanceBuilder::BuildRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<InstanceData>>& aInstanceData) const
+    {
+        appendRegion(uBeginX, uEndX, uBeginZ, uEndZ, aInstanceData);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::BuildRegion
+
+      Summary:  Appends the packed instances of the exposed voxels of a
+                rectangle of columns, row by row along z, into buckets
+                indexed by block type
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                std::vector<std::vector<PackedInstanceData>>& aInstanceData
+                  Buckets of packed instances, one per color of the
+                  palette
+
+      Modifies: [aInstanceData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelInstanceBuilder::BuildRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<PackedInstanceData>>& aInstanceData) const
+    {
+        appendRegion(uBeginX, uEndX, uBeginZ, uEndZ, aInstanceData);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::BuildRegion
+
+      Summary:  Appends the lowest cell of every instance the other
+                overloads would emit, in the same order, into buckets
+                indexed by block type
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                std::vector<std::vector<XMUINT3>>& aCells
+                  Buckets of cells, one per color of the palette
+
+      Modifies: [aCells].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelInstanceBuilder::BuildRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<XMUINT3>>& aCells) const
+    {
+        appendRegion(uBeginX, uEndX, uBeginZ, uEndZ, aCells);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::CountRegion
+
+      Summary:  Adds the number of instances of type T that BuildRegion
+                would emit for a rectangle of columns to the count of
+                each block type, without storing any of them
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                std::vector<size_t>& aCounts
+                  Counts of instances, one per color of the palette
+
+      Modifies: [aCounts].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class T>
+    void VoxelInstanceBuilder::CountRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<size_t>& aCounts) const
+    {
+        forEachExposedRun(
+            uBeginX,
+            uEndX,
+            uBeginZ,
+            uEndZ,
+            aCounts.size(),
+            getMaxRunLength<T>(),
+            [this, &aCounts](size_t uVoxelIdx, UINT x, UINT y, UINT z, UINT uRunLength, CHAR blockType)
+            {
+                T instance;
+                if (makeInstance(x, y, z, uRunLength, blockType, instance))
+                {
+                    ++aCounts[uVoxelIdx];
+                }
+            }
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::FillRegion
+
+      Summary:  Writes the instances of a rectangle of columns into
+                buckets already sized by CountRegion, each at the
+                cursor of its block type. Regions given disjoint slots
+                can be filled on several threads at once
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                std::vector<size_t>& aCursors
+                  Next slot of each bucket, advanced past the instances
+                  written
+                std::vector<std::vector<T>>& aInstanceData
+                  Buckets of instances, one per color of the palette
+
+      Modifies: [aCursors, aInstanceData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class T>
+    void VoxelInstanceBuilder::FillRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<size_t>& aCursors, _Inout_ std::vector<std::vector<T>>& aInstanceData) const
+    {
+        forEachExposedRun(
+            uBeginX,
+            uEndX,
+            uBeginZ,
+            uEndZ,
+            aInstanceData.size(),
+            getMaxRunLength<T>(),
+            [this, &aCursors, &aInstanceData](size_t uVoxelIdx, UINT x, UINT y, UINT z, UINT uRunLength, CHAR blockType)
+            {
+                T instance;
+                if (makeInstance(x, y, z, uRunLength, blockType, instance))
+                {
+                    aInstanceData[uVoxelIdx][aCursors[uVoxelIdx]++] = instance;
+                }
+            }
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::IsCollapsingRuns
+
+      Summary:  Returns whether vertical runs become one instance
+
+      Returns:  BOOL
+                  TRUE if runs of exposed voxels are collapsed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelInstanceBuilder::IsCollapsingRuns() const
+    {
+        return m_bCollapseRuns;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::appendRegion
+
+      Summary:  Appends the instances of the exposed voxels of a
+                rectangle of columns, row by row along z, into buckets
+                indexed by block type
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                std::vector<std::vector<T>>& aInstanceData
+                  Buckets of instances, one per color of the palette
+
+      Modifies: [aInstanceData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class T>
+    void VoxelInstanceBuilder::appendRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<T>>& aInstanceData) const
+    {
+        forEachExposedRun(
+            uBeginX,
+            uEndX,
+            uBeginZ,
+            uEndZ,
+            aInstanceData.size(),
+            getMaxRunLength<T>(),
+            [this, &aInstanceData](size_t uVoxelIdx, UINT x, UINT y, UINT z, UINT uRunLength, CHAR blockType)
+            {
+                T instance;
+                if (makeInstance(x, y, z, uRunLength, blockType, instance))
+                {
+                    aInstanceData[uVoxelIdx].push_back(instance);
+                }
+            }
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::makeInstance
+
+      Summary:  Makes the transformation of a vertical run: a cube
+                scaled along y by the length of the run and centered on
+                it
+
+      Args:     UINT x
+                  Column of the run along x
+                UINT y
+                  Lowest cell of the run
+                UINT z
+                  Column of the run along z
+                UINT uRunLength
+                  Number of voxels of the run
+                CHAR blockType
+                  Block type of the run
+                InstanceData& instance
+                  Receives the instance
+
+      Returns:  BOOL
+                  TRUE
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelInstanceBuilder::makeInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ UINT uRunLength, _In_ CHAR, _Out_ InstanceData& instance) const
+    {
+        // Cells are two units tall, so the center of the run is one
+        // unit above the lowest cell per extra voxel
+        XMFLOAT3 position = m_heightMap->GetVoxelPosition(x, y, z);
+        FLOAT runLength = static_cast<FLOAT>(uRunLength);
+        instance.Transformation = XMMatrixScaling(1.0f, runLength, 1.0f) * XMMatrixTranslation(position.x, position.y + runLength - 1.0f, position.z);
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::makeInstance
+
+      Summary:  Packs a vertical run. Runs whose coordinates do not fit
+                the packed format are skipped
+
+      Args:     UINT x
+                  Column of the run along x
+                UINT y
+                  Lowest cell of the run
+                UINT z
+                  Column of the run along z
+                UINT uRunLength
+                  Number of voxels of the run
+                CHAR blockType
+                  Block type of the run
+                PackedInstanceData& instance
+                  Receives the packed instance
+
+      Returns:  BOOL
+                  TRUE if the run could be packed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelInstanceBuilder::makeInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ UINT uRunLength, _In_ CHAR blockType, _Out_ PackedInstanceData& instance) const
+    {
+        return SUCCEEDED(VoxelPacker::PackRun(static_cast<INT>(x), static_cast<INT>(y), static_cast<INT>(z), uRunLength, blockType, instance));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::makeInstance
+
+      Summary:  Returns the lowest cell of a vertical run
+
+      Args:     UINT x
+                  Column of the run along x
+                UINT y
+                  Lowest cell of the run
+                UINT z
+                  Column of the run along z
+                UINT uRunLength
+                  Number of voxels of the run
+                CHAR blockType
+                  Block type of the run
+                XMUINT3& instance
+                  Receives the cell
+
+      Returns:  BOOL
+                  TRUE
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelInstanceBuilder::makeInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ UINT, _In_ CHAR, _Out_ XMUINT3& instance) const
+    {
+        instance = XMUINT3(x, y, z);
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelInstanceBuilder::forEachExposedRun
+
+      Summary:  Calls the visitor with the bucket, the lowest cell, the
+                length and the block type of every vertical run of
+                exposed voxels of a rectangle of columns, row by row
+                along z and bottom-up in a column. Runs longer than the
+                maximum length are split, so a maximum of one visits
+                every exposed voxel on its own
+
+      Args:     UINT uBeginX
+                  First column of the region along x
+                UINT uEndX
+                  Column following the last column along x
+                UINT uBeginZ
+                  First row of the region
+                UINT uEndZ
+                  Row following the last row of the region
+                size_t uNumColors
+                  Number of buckets
+                UINT uMaxRunLength
+                  Maximum number of voxels of a run
+                Visitor visitor
+                  Callable taking (size_t, UINT, UINT, UINT, UINT, CHAR)
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class Visitor>
+    void VoxelInstanceBuilder::forEachExposedRun(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _In_ size_t uNumColors, _In_ UINT uMaxRunLength, _In_ Visitor visitor) const
+    {
+        uEndX = std::min<UINT>(uEndX, m_heightMap->GetWidth());
+        uEndZ = std::min<UINT>(uEndZ, m_heightMap->GetDepth());
+        uMaxRunLength = std::max<UINT>(uMaxRunLength, 1u);
+
+        for (UINT uDepthIdx = uBeginZ; uDepthIdx < uEndZ; ++uDepthIdx)
+        {
+            for (UINT uWidthIdx = uBeginX; uWidthIdx < uEndX; ++uWidthIdx)
+            {
+                const HeightMapColumn& column = m_heightMap->GetColumn(uWidthIdx, uDepthIdx);
+                size_t uVoxelIdx = static_cast<size_t>(column.BlockType) - static_cast<size_t>(eBlockType::GRASSLAND);
+                if (column.BlockType < static_cast<CHAR>(eBlockType::GRASSLAND) || uVoxelIdx >= uNumColors)
+                {
+                    continue;
+                }
+
+                // A column holds a single block type, so a run only ends
+                // where a voxel is buried or missing
+                UINT uRunBegin = 0u;
+                UINT uRunLength = 0u;
+                auto flushRun = [&]()
+                {
+                    while (uRunLength > 0u)
+                    {
+                        UINT uLength = std::min<UINT>(uRunLength, uMaxRunLength);
+                        visitor(uVoxelIdx, uWidthIdx, uRunBegin, uDepthIdx, uLength, column.BlockType);
+                        uRunBegin += uLength;
+                        uRunLength -= uLength;
+                    }
+                };
+
+                for (UINT uWordIdx = 0u; uWordIdx < m_occupancyGrid->GetWordsPerColumn(); ++uWordIdx)
+                {
+                    UINT64 uExposed = m_occupancyGrid->GetExposedWord(uWidthIdx, uDepthIdx, uWordIdx);
+                    while (uExposed != 0ull)
+                    {
+                        UINT uBitIdx = static_cast<UINT>(std::countr_zero(uExposed));
+                        UINT uLength = static_cast<UINT>(std::countr_one(uExposed >> uBitIdx));
+                        UINT heightIdx = uWordIdx * OccupancyGrid::BITS_PER_WORD + uBitIdx;
+                        uExposed = uBitIdx + uLength < OccupancyGrid::BITS_PER_WORD ? uExposed & ~(((1ull << uLength) - 1ull) << uBitIdx) : 0ull;
+
+                        // Runs crossing a word boundary continue the pending run
+                        if (uRunLength > 0u && uRunBegin + uRunLength == heightIdx)
+                        {
+                            uRunLength += uLength;
+                        }
+                        else
+                        {
+                            flushRun();
+                            uRunBegin = heightIdx;
+                            uRunLength = uLength;
+                        }
+                    }
+                }
+                flushRun();
+            }
+        }
+    }
+
+    template void VoxelInstanceBuilder::CountRegion<InstanceData>(_In_ UINT, _In_ UINT, _In_ UINT, _In_ UINT, _Inout_ std::vector<size_t>&) const;
+    template void VoxelInstanceBuilder::CountRegion<PackedInstanceData>(_In_ UINT, _In_ UINT, _In_ UINT, _In_ UINT, _Inout_ std::vector<size_t>&) const;
+    template void VoxelInstanceBuilder::CountRegion<XMUINT3>(_In_ UINT, _In_ UINT, _In_ UINT, _In_ UINT, _Inout_ std::vector<size_t>&) const;
+    template void VoxelInstanceBuilder::FillRegion<InstanceData>(_In_ UINT, _In_ UINT, _In_ UINT, _In_ UINT, _Inout_ std::vector<size_t>&, _Inout_ std::vector<std::vector<InstanceData>>&) const;
+    template void VoxelInstanceBuilder::FillRegion<PackedInstanceData>(_In_ UINT, _In_ UINT, _In_ UINT, _In_ UINT, _Inout_ std::vector<size_t>&, _Inout_ std::vector<std::vector<PackedInstanceData>>&) const;
+    template void VoxelInstanceBuilder::FillRegion<XMUINT3>(_In_ UINT, _In_ UINT, _In_ UINT, _In_ UINT, _Inout_ std::vector<size_t>&, _Inout_ std::vector<std::vector<XMUINT3>>&) const;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+/*+===================================================================
+  File:      VOXELINSTANCEBUILDER.H
+
+  Summary:   VoxelInstanceBuilder header file contains declarations of
+             VoxelInstanceBuilder class that fills the instance data of
+             the exposed voxels of a region of the height map, one per
+             voxel or one per vertical run of voxels.
+
+  Classes: VoxelInstanceBuilder
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <bit>
+
+#include "Renderer/DataTypes.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/VoxelPacker.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelInstanceBuilder
+
+      Summary:  Emits one instance per solid voxel with an open face,
+                bucketed by block type, either as a transformation
+                matrix or packed into 8 bytes. When runs are collapsed,
+                each contiguous vertical run of exposed voxels of a
+                column becomes one instance stretched along y instead.
+                The builder only reads
+                the height map and the occupancy grid, so disjoint
+                regions can be built on several threads at once
+
+      Methods:  BuildRegion
+                  Fills the instances, or the cells of the instances,
+                  of a rectangle of columns
+                CountRegion
+                  Counts the instances of a rectangle of columns per
+                  block type
+                FillRegion
+                  Writes the instances of a rectangle of columns at the
+                  slots reserved for them
+                IsCollapsingRuns
+                  Returns whether vertical runs become one instance
+                appendRegion
+                  Appends the instances of a rectangle of columns
+                makeInstance
+                  Makes the instance of a vertical run
+                getMaxRunLength
+                  Returns the longest run an instance can hold
+                forEachExposedRun
+                  Visits the vertical runs of exposed voxels of a
+                  rectangle of columns
+                VoxelInstanceBuilder
+                  Constructor.
+                ~VoxelInstanceBuilder
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelInstanceBuilder
+    {
+    public:
+        VoxelInstanceBuilder(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid, _In_ BOOL bCollapseRuns = FALSE);
+        VoxelInstanceBuilder(const VoxelInstanceBuilder& other) = delete;
+        VoxelInstanceBuilder(VoxelInstanceBuilder&& other) = delete;
+        VoxelInstanceBuilder& operator=(const VoxelInstanceBuilder& other) = delete;
+        VoxelInstanceBuilder& operator=(VoxelInstanceBuilder&& other) = delete;
+        ~VoxelInstanceBuilder() = default;
+
+        void BuildRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<InstanceData>>& aInstanceData) const;
+        void BuildRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<PackedInstanceData>>& aInstanceData) const;
+        void BuildRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<XMUINT3>>& aCells) const;
+
+        template <class T>
+        void CountRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<size_t>& aCounts) const;
+        template <class T>
+        void FillRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<size_t>& aCursors, _Inout_ std::vector<std::vector<T>>& aInstanceData) const;
+
+        BOOL IsCollapsingRuns() const;
+
+    private:
+        template <class T>
+        void appendRegion(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _Inout_ std::vector<std::vector<T>>& aInstanceData) const;
+
+        BOOL makeInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ UINT uRunLength, _In_ CHAR blockType, _Out_ InstanceData& instance) const;
+        BOOL makeInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ UINT uRunLength, _In_ CHAR blockType, _Out_ PackedInstanceData& instance) const;
+        BOOL makeInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ UINT uRunLength, _In_ CHAR blockType, _Out_ XMUINT3& instance) const;
+
+        template <class T>
+        UINT getMaxRunLength() const;
+
+        template <class Visitor>
+        void forEachExposedRun(_In_ UINT uBeginX, _In_ UINT uEndX, _In_ UINT uBeginZ, _In_ UINT uEndZ, _In_ size_t uNumColors, _In_ UINT uMaxRunLength, _In_ Visitor visitor) const;
+
+    private:
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        BOOL m_bCollapseRuns;
+    };
+}
\ No newline at end of file
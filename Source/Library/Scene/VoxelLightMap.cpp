@@ -0,0 +1,905 @@
+#include "Scene/VoxelLightMap.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::VoxelLightMap
+
+      Summary:  Constructor. The map stays dark until Build. The grid
+                origin is the world position of the lower corner of the
+                cell (0, 0, 0), one cell spans two world units
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map the voxels are placed with
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Occupancy of the cells
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_gridOrigin, m_aLight,
+                 m_emitters, m_aAddQueue, m_aRemoveQueue, m_dirtyMin,
+                 m_dirtyMax, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelLightMap::VoxelLightMap(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_gridOrigin()
+        , m_aLight(static_cast<size_t>(occupancyGrid->GetWidth()) * occupancyGrid->GetHeight() * occupancyGrid->GetDepth(), 0u)
+        , m_emitters()
+        , m_aAddQueue()
+        , m_aRemoveQueue()
+        , m_dirtyMin(INT_MAX, INT_MAX, INT_MAX)
+        , m_dirtyMax(INT_MIN, INT_MIN, INT_MIN)
+        , m_stats()
+    {
+        XMFLOAT3 firstCell = m_heightMap->GetVoxelPosition(0u, 0u, 0u);
+        m_gridOrigin = XMFLOAT3(firstCell.x - 1.0f, firstCell.y - 1.0f, firstCell.z - 1.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::Build
+
+      Summary:  Floods the light of the whole grid. Sky light first
+                falls down every column at full level until the first
+                solid cell, then the cells of those runs next to an
+                empty cell the sky does not reach flood sideways along
+                with the emitters, so the open air above the terrain is
+                filled without a queue. The instances are lit again as
+                a whole by LightInstances, so no cell is left relit
+
+      Modifies: [m_aLight, m_aAddQueue, m_dirtyMin, m_dirtyMax,
+                 m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::Build()
+    {
+        BenchmarkTimer timer;
+
+        UINT uWidth = m_occupancyGrid->GetWidth();
+        UINT uHeight = m_occupancyGrid->GetHeight();
+        UINT uDepth = m_occupancyGrid->GetDepth();
+        std::fill(m_aLight.begin(), m_aLight.end(), static_cast<BYTE>(0u));
+
+        // Lowest cell of every column the sky falls to
+        std::vector<WORD> aSkyFloors(static_cast<size_t>(uWidth) * uDepth);
+        for (UINT z = 0u; z < uDepth; ++z)
+        {
+            for (UINT x = 0u; x < uWidth; ++x)
+            {
+                UINT y = uHeight;
+                while (y > 0u && !m_occupancyGrid->IsOccupied(static_cast<INT>(x), static_cast<INT>(y - 1u), static_cast<INT>(z)))
+                {
+                    --y;
+                    setLight(getIndex(x, y, z), eLightChannel::SKY, MAX_LIGHT);
+                }
+                aSkyFloors[static_cast<size_t>(z) * uWidth + x] = static_cast<WORD>(y);
+            }
+        }
+
+        m_aAddQueue.clear();
+        for (UINT z = 0u; z < uDepth; ++z)
+        {
+            for (UINT x = 0u; x < uWidth; ++x)
+            {
+                UINT uFloor = aSkyFloors[static_cast<size_t>(z) * uWidth + x];
+                for (UINT y = uFloor; y < uHeight; ++y)
+                {
+                    for (UINT i = 0u; i < 6u; ++i)
+                    {
+                        if (NEIGHBOURS[i][1] != 0)
+                        {
+                            continue;
+                        }
+
+                        INT nx = static_cast<INT>(x) + NEIGHBOURS[i][0];
+                        INT nz = static_cast<INT>(z) + NEIGHBOURS[i][2];
+                        if (nx < 0 || nz < 0 || nx >= static_cast<INT>(uWidth) || nz >= static_cast<INT>(uDepth) ||
+                            y >= aSkyFloors[static_cast<size_t>(nz) * uWidth + static_cast<UINT>(nx)] ||
+                            m_occupancyGrid->IsOccupied(nx, static_cast<INT>(y), nz))
+                        {
+                            continue;
+                        }
+
+                        m_aAddQueue.push_back({ static_cast<WORD>(x), static_cast<WORD>(y), static_cast<WORD>(z), MAX_LIGHT });
+                        break;
+                    }
+                }
+            }
+        }
+        floodAdd(eLightChannel::SKY);
+
+        m_aAddQueue.clear();
+        for (const auto& [uIndex, uLevel] : m_emitters)
+        {
+            UINT y = static_cast<UINT>(uIndex % uHeight);
+            UINT x = static_cast<UINT>((uIndex / uHeight) % uWidth);
+            UINT z = static_cast<UINT>(uIndex / (static_cast<size_t>(uHeight) * uWidth));
+            setLight(uIndex, eLightChannel::BLOCK, uLevel);
+            m_aAddQueue.push_back({ static_cast<WORD>(x), static_cast<WORD>(y), static_cast<WORD>(z), uLevel });
+        }
+        floodAdd(eLightChannel::BLOCK);
+        m_dirtyMin = XMINT3(INT_MAX, INT_MAX, INT_MAX);
+        m_dirtyMax = XMINT3(INT_MIN, INT_MIN, INT_MIN);
+
+        m_stats.BuildMilliseconds = timer.GetMilliseconds();
+        m_stats.ullMemoryBytes = GetMemoryUsage();
+        m_stats.uNumEmitters = static_cast<UINT>(m_emitters.size());
+        m_stats.ullNumLitCells = 0ull;
+        for (BYTE uLight : m_aLight)
+        {
+            m_stats.ullNumLitCells += uLight != 0u ? 1ull : 0ull;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::LightInstances
+
+      Summary:  Hands the light of their faces to every instance of the
+                voxels, which upload it with their instances. The cell
+                of an instance is read back from its transform, and a
+                run of cells is lit from its highest cell as the
+                horizons are. Call after Build
+
+      Args:     const std::vector<std::shared_ptr<Voxel>>& voxels
+                  Voxels whose instances are lit
+
+      Modifies: [m_dirtyMin, m_dirtyMax, m_stats].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelLightMap::LightInstances(_In_ const std::vector<std::shared_ptr<Voxel>>& voxels)
+    {
+        BenchmarkTimer timer;
+
+        UINT uNumInstances = 0u;
+        for (const std::shared_ptr<Voxel>& voxel : voxels)
+        {
+            const std::vector<InstanceData>& aInstanceData = voxel->GetInstanceData();
+            std::vector<InstanceLightData> aInstanceLights(aInstanceData.size());
+            for (size_t i = 0u; i < aInstanceData.size(); ++i)
+            {
+                XMFLOAT4X4 transform;
+                XMStoreFloat4x4(&transform, aInstanceData[i].Transformation);
+
+                FLOAT runLength = std::max<FLOAT>(transform.m[1][1], 1.0f);
+                aInstanceLights[i] = getInstanceLight(
+                    static_cast<INT>(floorf((transform.m[3][0] - m_gridOrigin.x) * 0.5f)),
+                    static_cast<INT>(floorf((transform.m[3][1] + runLength - 1.0f - m_gridOrigin.y) * 0.5f)),
+                    static_cast<INT>(floorf((transform.m[3][2] - m_gridOrigin.z) * 0.5f))
+                );
+            }
+            uNumInstances += static_cast<UINT>(aInstanceLights.size());
+            voxel->SetInstanceLights(std::move(aInstanceLights));
+        }
+        m_dirtyMin = XMINT3(INT_MAX, INT_MAX, INT_MAX);
+        m_dirtyMax = XMINT3(INT_MIN, INT_MIN, INT_MIN);
+
+        m_stats.uNumInstances = uNumInstances;
+        m_stats.InstanceMilliseconds = timer.GetMilliseconds();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::RelightInstances
+
+      Summary:  Lights again the instances whose faces look at a cell
+                relit since the instances were last lit, those of the
+                exposed cells in the box of the relit cells grown by a
+                cell. The instances are found through the editor, and
+                only those whose light changed are set, so that the
+                next flush uploads only them. Instances the edits added
+                start dark and are lit here since their cell was
+                edited
+
+      Args:     const VoxelEditor& editor
+                  Editor whose voxels were lit
+
+      Modifies: [m_dirtyMin, m_dirtyMax, m_stats].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelLightMap::RelightInstances(_In_ const VoxelEditor& editor)
+    {
+        const INT iMinX = std::max<INT>(m_dirtyMin.x, 1) - 1;
+        const INT iMinY = std::max<INT>(m_dirtyMin.y, 1) - 1;
+        const INT iMinZ = std::max<INT>(m_dirtyMin.z, 1) - 1;
+        const INT iMaxX = std::min<INT>(m_dirtyMax.x, static_cast<INT>(m_occupancyGrid->GetWidth()) - 2) + 1;
+        const INT iMaxY = std::min<INT>(m_dirtyMax.y, static_cast<INT>(m_occupancyGrid->GetHeight()) - 2) + 1;
+        const INT iMaxZ = std::min<INT>(m_dirtyMax.z, static_cast<INT>(m_occupancyGrid->GetDepth()) - 2) + 1;
+        m_dirtyMin = XMINT3(INT_MAX, INT_MAX, INT_MAX);
+        m_dirtyMax = XMINT3(INT_MIN, INT_MIN, INT_MIN);
+
+        const std::vector<std::shared_ptr<Voxel>>& voxels = editor.GetVoxels();
+        UINT uNumInstances = 0u;
+        for (INT z = iMinZ; z <= iMaxZ; ++z)
+        {
+            for (INT x = iMinX; x <= iMaxX; ++x)
+            {
+                for (INT y = iMinY; y <= iMaxY; ++y)
+                {
+                    UINT uVoxelIdx = 0u;
+                    UINT uInstanceIdx = 0u;
+                    if (!m_occupancyGrid->IsExposed(x, y, z) ||
+                        !editor.GetInstanceLocation(static_cast<UINT>(x), static_cast<UINT>(y), static_cast<UINT>(z), uVoxelIdx, uInstanceIdx) ||
+                        uInstanceIdx >= voxels[uVoxelIdx]->GetInstanceLights().size())
+                    {
+                        continue;
+                    }
+
+                    InstanceLightData light = getInstanceLight(x, y, z);
+                    if (memcmp(&light, &voxels[uVoxelIdx]->GetInstanceLights()[uInstanceIdx], sizeof(InstanceLightData)) != 0)
+                    {
+                        voxels[uVoxelIdx]->SetInstanceLight(uInstanceIdx, light);
+                        ++uNumInstances;
+                    }
+                }
+            }
+        }
+        m_stats.uLastRelitInstances = uNumInstances;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::OnCellChanged
+
+      Summary:  Relights both channels around a cell after it was made
+                solid or empty in the occupancy grid
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+
+      Modifies: [m_aLight, m_aAddQueue, m_aRemoveQueue, m_dirtyMin,
+                 m_dirtyMax].
+
+      Returns:  UINT
+                  Number of cells visited
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelLightMap::OnCellChanged(_In_ UINT x, _In_ UINT y, _In_ UINT z)
+    {
+        if (x >= m_occupancyGrid->GetWidth() || y >= m_occupancyGrid->GetHeight() || z >= m_occupancyGrid->GetDepth())
+        {
+            return 0u;
+        }
+
+        return relight(x, y, z, eLightChannel::BLOCK) + relight(x, y, z, eLightChannel::SKY);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::SetEmitter
+
+      Summary:  Sets the block light a cell emits, solid or not, and
+                relights the block light around it
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+                BYTE uLevel
+                  Light emitted up to MAX_LIGHT, 0 to remove the
+                  emitter
+
+      Modifies: [m_emitters, m_aLight, m_aAddQueue, m_aRemoveQueue,
+                 m_dirtyMin, m_dirtyMax].
+
+      Returns:  UINT
+                  Number of cells visited
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelLightMap::SetEmitter(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE uLevel)
+    {
+        if (x >= m_occupancyGrid->GetWidth() || y >= m_occupancyGrid->GetHeight() || z >= m_occupancyGrid->GetDepth())
+        {
+            return 0u;
+        }
+
+        size_t uIndex = getIndex(x, y, z);
+        uLevel = std::min<BYTE>(uLevel, MAX_LIGHT);
+        if (uLevel == 0u)
+        {
+            m_emitters.erase(uIndex);
+        }
+        else
+        {
+            m_emitters[uIndex] = uLevel;
+        }
+
+        return relight(x, y, z, eLightChannel::BLOCK);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::GetLight
+
+      Summary:  Returns the light of a cell in a channel. Cells above
+                the grid are under the open sky, other cells outside it
+                are dark
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+                eLightChannel channel
+                  Channel to read
+
+      Returns:  BYTE
+                  Light from 0 to MAX_LIGHT
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE VoxelLightMap::GetLight(_In_ INT x, _In_ INT y, _In_ INT z, _In_ eLightChannel channel) const
+    {
+        if (x < 0 || y < 0 || z < 0 ||
+            x >= static_cast<INT>(m_occupancyGrid->GetWidth()) || z >= static_cast<INT>(m_occupancyGrid->GetDepth()))
+        {
+            return 0u;
+        }
+
+        if (y >= static_cast<INT>(m_occupancyGrid->GetHeight()))
+        {
+            return channel == eLightChannel::SKY ? MAX_LIGHT : static_cast<BYTE>(0u);
+        }
+
+        return getLight(getIndex(static_cast<UINT>(x), static_cast<UINT>(y), static_cast<UINT>(z)), channel);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::GetSurfaceLight
+
+      Summary:  Returns the brightest light of the cells around a cell,
+                which is the light falling on the faces of a solid one
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+                eLightChannel channel
+                  Channel to read
+
+      Returns:  BYTE
+                  Light from 0 to MAX_LIGHT
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE VoxelLightMap::GetSurfaceLight(_In_ INT x, _In_ INT y, _In_ INT z, _In_ eLightChannel channel) const
+    {
+        BYTE uLight = 0u;
+        for (UINT i = 0u; i < 6u; ++i)
+        {
+            uLight = std::max<BYTE>(uLight, GetLight(x + NEIGHBOURS[i][0], y + NEIGHBOURS[i][1], z + NEIGHBOURS[i][2], channel));
+        }
+
+        return uLight;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::Benchmark
+
+      Summary:  Measures the relighting of random edits on a scratch
+                copy of the occupancy grid and of the emitters, so the
+                grid the scene draws and edits is never touched while
+                it runs
+
+      Args:     UINT uNumEdits
+                  Number of edits
+
+      Modifies: [m_stats].
+
+      Returns:  const VoxelLightStats&
+                  Statistics of the benchmark
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelLightStats& VoxelLightMap::Benchmark(_In_ UINT uNumEdits)
+    {
+        std::shared_ptr<OccupancyGrid> scratchGrid = std::make_shared<OccupancyGrid>(m_occupancyGrid->GetWidth(), m_occupancyGrid->GetHeight(), m_occupancyGrid->GetDepth());
+        if (FAILED(scratchGrid->CopyFrom(*m_occupancyGrid)))
+        {
+            return m_stats;
+        }
+
+        VoxelLightMap scratchMap(m_heightMap, scratchGrid);
+        scratchMap.m_emitters = m_emitters;
+        scratchMap.benchmarkEdits(uNumEdits);
+
+        m_stats.uNumEdits = scratchMap.m_stats.uNumEdits;
+        m_stats.AverageCellsPerEdit = scratchMap.m_stats.AverageCellsPerEdit;
+        m_stats.MicrosecondsPerEdit = scratchMap.m_stats.MicrosecondsPerEdit;
+        m_stats.MaxMicrosecondsPerEdit = scratchMap.m_stats.MaxMicrosecondsPerEdit;
+        m_stats.bIdentical = scratchMap.m_stats.bIdentical;
+        m_stats.ullMemoryBytes = GetMemoryUsage();
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"VoxelLightMap: %llu lit cells, %llu bytes, build %.2f ms, %u instances lit in %.2f ms, %u edits, %.1f cells per edit, %.2f us per edit, max %.2f us, %s\n",
+            m_stats.ullNumLitCells,
+            m_stats.ullMemoryBytes,
+            m_stats.BuildMilliseconds,
+            m_stats.uNumInstances,
+            m_stats.InstanceMilliseconds,
+            m_stats.uNumEdits,
+            m_stats.AverageCellsPerEdit,
+            m_stats.MicrosecondsPerEdit,
+            m_stats.MaxMicrosecondsPerEdit,
+            m_stats.bIdentical ? L"identical" : L"MISMATCH"
+        );
+        OutputDebugString(szReport);
+
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::GetMemoryUsage
+
+      Summary:  Returns the size of the light map, the emitters and the
+                queues in bytes
+
+      Returns:  UINT64
+                  Size in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 VoxelLightMap::GetMemoryUsage() const
+    {
+        return static_cast<UINT64>(m_aLight.capacity()) +
+            static_cast<UINT64>(m_emitters.size()) * (sizeof(std::pair<const size_t, BYTE>) + sizeof(void*)) +
+            static_cast<UINT64>(m_emitters.bucket_count()) * sizeof(void*) +
+            static_cast<UINT64>(m_aAddQueue.capacity() + m_aRemoveQueue.capacity()) * sizeof(LightNode);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::GetStats
+
+      Summary:  Returns the statistics of the last build and benchmark
+
+      Returns:  const VoxelLightStats&
+                  Statistics of the last build and benchmark
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelLightStats& VoxelLightMap::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::benchmarkEdits
+
+      Summary:  Places BENCHMARK_EMITTERS pseudo-random emitters above
+                the terrain, then makes pseudo-random cells around the
+                surface solid or empty one at a time and measures the
+                relighting of each edit. The relit map is compared with
+                a full build, then the edits and the emitters are undone
+                and the map compared with the one before the edits. The
+                edits go to the occupancy grid of this map, which
+                Benchmark makes a scratch copy for
+
+      Args:     UINT uNumEdits
+                  Number of edits
+
+      Modifies: [m_occupancyGrid, m_aLight, m_emitters, m_aAddQueue,
+                 m_aRemoveQueue, m_dirtyMin, m_dirtyMax, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::benchmarkEdits(_In_ UINT uNumEdits)
+    {
+        UINT uWidth = m_occupancyGrid->GetWidth();
+        UINT uHeight = m_occupancyGrid->GetHeight();
+        UINT uDepth = m_occupancyGrid->GetDepth();
+        if (uNumEdits == 0u || uWidth == 0u || uHeight == 0u || uDepth == 0u)
+        {
+            return;
+        }
+
+        // Edits use a fixed seed so that runs are comparable
+        BenchmarkRandom random;
+        auto findSurface = [this, uHeight](UINT x, UINT z)
+        {
+            UINT y = uHeight;
+            while (y > 0u && !m_occupancyGrid->IsOccupied(static_cast<INT>(x), static_cast<INT>(y - 1u), static_cast<INT>(z)))
+            {
+                --y;
+            }
+            return y;
+        };
+
+        Build();
+        std::vector<BYTE> aOriginalLight = m_aLight;
+        std::unordered_map<size_t, BYTE> originalEmitters = m_emitters;
+
+        std::vector<size_t> aEmitters;
+        for (UINT i = 0u; i < BENCHMARK_EMITTERS; ++i)
+        {
+            UINT x = random.GetUint(uWidth);
+            UINT z = random.GetUint(uDepth);
+            UINT y = std::min<UINT>(findSurface(x, z) + random.GetUint(3u), uHeight - 1u);
+            if (m_emitters.contains(getIndex(x, y, z)))
+            {
+                continue;
+            }
+
+            SetEmitter(x, y, z, static_cast<BYTE>(8u + random.GetUint(8u)));
+            aEmitters.push_back(getIndex(x, y, z));
+        }
+
+        BenchmarkTimer timer;
+        std::vector<XMUINT3> aEdits;
+        aEdits.reserve(uNumEdits);
+        UINT64 ullNumCells = 0ull;
+        FLOAT totalSeconds = 0.0f;
+        FLOAT maxSeconds = 0.0f;
+        for (UINT i = 0u; i < uNumEdits; ++i)
+        {
+            UINT x = random.GetUint(uWidth);
+            UINT z = random.GetUint(uDepth);
+            UINT uSurface = findSurface(x, z);
+            UINT y = std::min<UINT>(uSurface + random.GetUint(5u) - std::min<UINT>(uSurface, 2u), uHeight - 1u);
+            BOOL bOccupied = m_occupancyGrid->IsOccupied(static_cast<INT>(x), static_cast<INT>(y), static_cast<INT>(z));
+
+            timer.Start();
+            m_occupancyGrid->SetOccupied(x, y, z, !bOccupied);
+            ullNumCells += OnCellChanged(x, y, z);
+            FLOAT seconds = timer.GetSeconds();
+            totalSeconds += seconds;
+            maxSeconds = std::max<FLOAT>(maxSeconds, seconds);
+            aEdits.push_back(XMUINT3(x, y, z));
+        }
+        m_stats.uNumEdits = uNumEdits;
+        m_stats.AverageCellsPerEdit = static_cast<FLOAT>(static_cast<double>(ullNumCells) / static_cast<double>(uNumEdits));
+        m_stats.MicrosecondsPerEdit = totalSeconds * 1.0e6f / static_cast<FLOAT>(uNumEdits);
+        m_stats.MaxMicrosecondsPerEdit = maxSeconds * 1.0e6f;
+
+        std::vector<BYTE> aRelitLight = m_aLight;
+        Build();
+        m_stats.bIdentical = aRelitLight == m_aLight;
+
+        for (auto it = aEdits.rbegin(); it != aEdits.rend(); ++it)
+        {
+            BOOL bOccupied = m_occupancyGrid->IsOccupied(static_cast<INT>(it->x), static_cast<INT>(it->y), static_cast<INT>(it->z));
+            m_occupancyGrid->SetOccupied(it->x, it->y, it->z, !bOccupied);
+            OnCellChanged(it->x, it->y, it->z);
+        }
+        for (size_t uIndex : aEmitters)
+        {
+            UINT y = static_cast<UINT>(uIndex % uHeight);
+            UINT x = static_cast<UINT>((uIndex / uHeight) % uWidth);
+            UINT z = static_cast<UINT>(uIndex / (static_cast<size_t>(uHeight) * uWidth));
+            SetEmitter(x, y, z, 0u);
+        }
+        m_stats.bIdentical = m_stats.bIdentical && m_aLight == aOriginalLight && m_emitters == originalEmitters;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::getInstanceLight
+
+      Summary:  Returns the light of the faces of a cell, for each face
+                the light of the cell in front of it, in the order of
+                NEIGHBOURS: -x, +x, -y, +y, -z, +z. A byte holds the
+                block light in its low nibble and the sky light in its
+                high one, as the map does; the last two are unused
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  InstanceLightData
+                  Light of the faces
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    InstanceLightData VoxelLightMap::getInstanceLight(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        InstanceLightData light = {};
+        for (UINT i = 0u; i < 6u; ++i)
+        {
+            INT nx = x + NEIGHBOURS[i][0];
+            INT ny = y + NEIGHBOURS[i][1];
+            INT nz = z + NEIGHBOURS[i][2];
+            light.aFaceLights[i] = static_cast<BYTE>((GetLight(nx, ny, nz, eLightChannel::SKY) << 4u) | GetLight(nx, ny, nz, eLightChannel::BLOCK));
+        }
+
+        return light;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::markDirty
+
+      Summary:  Grows the box of the cells relit since the instances
+                were last lit to hold a cell
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Modifies: [m_dirtyMin, m_dirtyMax].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::markDirty(_In_ INT x, _In_ INT y, _In_ INT z)
+    {
+        m_dirtyMin = XMINT3(std::min<INT>(m_dirtyMin.x, x), std::min<INT>(m_dirtyMin.y, y), std::min<INT>(m_dirtyMin.z, z));
+        m_dirtyMax = XMINT3(std::max<INT>(m_dirtyMax.x, x), std::max<INT>(m_dirtyMax.y, y), std::max<INT>(m_dirtyMax.z, z));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::relight
+
+      Summary:  Relights a channel around a cell whose occupancy or
+                emission changed. The cell is darkened and the light it
+                passed on removed, then the cell emits again and the
+                lit cells around it flood back into it
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+                eLightChannel channel
+                  Channel to relight
+
+      Modifies: [m_aLight, m_aAddQueue, m_aRemoveQueue, m_dirtyMin,
+                 m_dirtyMax].
+
+      Returns:  UINT
+                  Number of cells visited
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelLightMap::relight(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ eLightChannel channel)
+    {
+        m_aAddQueue.clear();
+        m_aRemoveQueue.clear();
+        markDirty(static_cast<INT>(x), static_cast<INT>(y), static_cast<INT>(z));
+
+        size_t uIndex = getIndex(x, y, z);
+        BYTE uOldLevel = getLight(uIndex, channel);
+        if (uOldLevel > 0u)
+        {
+            setLight(uIndex, channel, 0u);
+            m_aRemoveQueue.push_back({ static_cast<WORD>(x), static_cast<WORD>(y), static_cast<WORD>(z), uOldLevel });
+        }
+        UINT uNumCells = floodRemove(channel);
+
+        BYTE uEmission = getEmission(static_cast<INT>(x), static_cast<INT>(y), static_cast<INT>(z), channel);
+        if (uEmission > getLight(uIndex, channel))
+        {
+            setLight(uIndex, channel, uEmission);
+            m_aAddQueue.push_back({ static_cast<WORD>(x), static_cast<WORD>(y), static_cast<WORD>(z), uEmission });
+        }
+
+        if (!m_occupancyGrid->IsOccupied(static_cast<INT>(x), static_cast<INT>(y), static_cast<INT>(z)))
+        {
+            for (UINT i = 0u; i < 6u; ++i)
+            {
+                INT nx = static_cast<INT>(x) + NEIGHBOURS[i][0];
+                INT ny = static_cast<INT>(y) + NEIGHBOURS[i][1];
+                INT nz = static_cast<INT>(z) + NEIGHBOURS[i][2];
+                BYTE uLevel = GetLight(nx, ny, nz, channel);
+                if (uLevel > 0u && ny < static_cast<INT>(m_occupancyGrid->GetHeight()))
+                {
+                    m_aAddQueue.push_back({ static_cast<WORD>(nx), static_cast<WORD>(ny), static_cast<WORD>(nz), uLevel });
+                }
+            }
+        }
+
+        return uNumCells + floodAdd(channel);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::floodAdd
+
+      Summary:  Spreads the light of the cells of the add queue through
+                the empty cells around them, a level lower per cell,
+                except full sky light falling down
+
+      Args:     eLightChannel channel
+                  Channel to spread
+
+      Modifies: [m_aLight, m_aAddQueue, m_dirtyMin, m_dirtyMax].
+
+      Returns:  UINT
+                  Number of cells visited
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelLightMap::floodAdd(_In_ eLightChannel channel)
+    {
+        const INT iWidth = static_cast<INT>(m_occupancyGrid->GetWidth());
+        const INT iHeight = static_cast<INT>(m_occupancyGrid->GetHeight());
+        const INT iDepth = static_cast<INT>(m_occupancyGrid->GetDepth());
+
+        size_t uHead = 0u;
+        for (; uHead < m_aAddQueue.size(); ++uHead)
+        {
+            LightNode node = m_aAddQueue[uHead];
+            markDirty(node.x, node.y, node.z);
+
+            // A cell queued more than once spreads its final level
+            BYTE uLevel = getLight(getIndex(node.x, node.y, node.z), channel);
+            if (uLevel <= 1u)
+            {
+                continue;
+            }
+
+            for (UINT i = 0u; i < 6u; ++i)
+            {
+                INT nx = static_cast<INT>(node.x) + NEIGHBOURS[i][0];
+                INT ny = static_cast<INT>(node.y) + NEIGHBOURS[i][1];
+                INT nz = static_cast<INT>(node.z) + NEIGHBOURS[i][2];
+                if (nx < 0 || ny < 0 || nz < 0 || nx >= iWidth || ny >= iHeight || nz >= iDepth ||
+                    m_occupancyGrid->IsOccupied(nx, ny, nz))
+                {
+                    continue;
+                }
+
+                BYTE uNewLevel = channel == eLightChannel::SKY && uLevel == MAX_LIGHT && NEIGHBOURS[i][1] < 0 ? MAX_LIGHT : static_cast<BYTE>(uLevel - 1u);
+                size_t uNeighbourIndex = getIndex(static_cast<UINT>(nx), static_cast<UINT>(ny), static_cast<UINT>(nz));
+                if (getLight(uNeighbourIndex, channel) < uNewLevel)
+                {
+                    setLight(uNeighbourIndex, channel, uNewLevel);
+                    m_aAddQueue.push_back({ static_cast<WORD>(nx), static_cast<WORD>(ny), static_cast<WORD>(nz), uNewLevel });
+                }
+            }
+        }
+        m_aAddQueue.clear();
+
+        return static_cast<UINT>(uHead);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::floodRemove
+
+      Summary:  Darkens the cells lit by the cells of the removal queue.
+                A neighbour dimmer than the removed light, or full sky
+                light under full sky light, may have been lit by it and
+                is darkened in turn, emitting again if it is a source.
+                A neighbour at least as bright is lit from elsewhere and
+                goes to the add queue to flood back into the dark
+
+      Args:     eLightChannel channel
+                  Channel to darken
+
+      Modifies: [m_aLight, m_aAddQueue, m_aRemoveQueue, m_dirtyMin,
+                 m_dirtyMax].
+
+      Returns:  UINT
+                  Number of cells visited
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelLightMap::floodRemove(_In_ eLightChannel channel)
+    {
+        const INT iWidth = static_cast<INT>(m_occupancyGrid->GetWidth());
+        const INT iHeight = static_cast<INT>(m_occupancyGrid->GetHeight());
+        const INT iDepth = static_cast<INT>(m_occupancyGrid->GetDepth());
+
+        size_t uHead = 0u;
+        for (; uHead < m_aRemoveQueue.size(); ++uHead)
+        {
+            LightNode node = m_aRemoveQueue[uHead];
+            markDirty(node.x, node.y, node.z);
+            for (UINT i = 0u; i < 6u; ++i)
+            {
+                INT nx = static_cast<INT>(node.x) + NEIGHBOURS[i][0];
+                INT ny = static_cast<INT>(node.y) + NEIGHBOURS[i][1];
+                INT nz = static_cast<INT>(node.z) + NEIGHBOURS[i][2];
+                if (nx < 0 || ny < 0 || nz < 0 || nx >= iWidth || ny >= iHeight || nz >= iDepth)
+                {
+                    continue;
+                }
+
+                size_t uNeighbourIndex = getIndex(static_cast<UINT>(nx), static_cast<UINT>(ny), static_cast<UINT>(nz));
+                BYTE uLevel = getLight(uNeighbourIndex, channel);
+                if (uLevel == 0u)
+                {
+                    continue;
+                }
+
+                BOOL bFalling = channel == eLightChannel::SKY && node.uLevel == MAX_LIGHT && NEIGHBOURS[i][1] < 0;
+                if (uLevel < node.uLevel || (bFalling && uLevel == MAX_LIGHT))
+                {
+                    setLight(uNeighbourIndex, channel, 0u);
+                    m_aRemoveQueue.push_back({ static_cast<WORD>(nx), static_cast<WORD>(ny), static_cast<WORD>(nz), uLevel });
+
+                    BYTE uEmission = getEmission(nx, ny, nz, channel);
+                    if (uEmission > 0u)
+                    {
+                        setLight(uNeighbourIndex, channel, uEmission);
+                        m_aAddQueue.push_back({ static_cast<WORD>(nx), static_cast<WORD>(ny), static_cast<WORD>(nz), uEmission });
+                    }
+                }
+                else
+                {
+                    m_aAddQueue.push_back({ static_cast<WORD>(nx), static_cast<WORD>(ny), static_cast<WORD>(nz), uLevel });
+                }
+            }
+        }
+        m_aRemoveQueue.clear();
+
+        return static_cast<UINT>(uHead);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::getEmission
+
+      Summary:  Returns the light a cell emits. Empty cells of the top
+                layer emit full sky light, emitters their block light
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+                eLightChannel channel
+                  Channel of the light
+
+      Returns:  BYTE
+                  Light emitted from 0 to MAX_LIGHT
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE VoxelLightMap::getEmission(_In_ INT x, _In_ INT y, _In_ INT z, _In_ eLightChannel channel) const
+    {
+        if (channel == eLightChannel::SKY)
+        {
+            return y == static_cast<INT>(m_occupancyGrid->GetHeight()) - 1 && !m_occupancyGrid->IsOccupied(x, y, z) ? MAX_LIGHT : static_cast<BYTE>(0u);
+        }
+
+        auto it = m_emitters.find(getIndex(static_cast<UINT>(x), static_cast<UINT>(y), static_cast<UINT>(z)));
+        return it != m_emitters.end() ? it->second : static_cast<BYTE>(0u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::getLight
+
+      Summary:  Reads the nibble of a channel
+
+      Args:     size_t uIndex
+                  Index of the cell
+                eLightChannel channel
+                  Channel to read
+
+      Returns:  BYTE
+                  Light from 0 to MAX_LIGHT
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE VoxelLightMap::getLight(_In_ size_t uIndex, _In_ eLightChannel channel) const
+    {
+        return channel == eLightChannel::SKY ? static_cast<BYTE>(m_aLight[uIndex] >> 4u) : static_cast<BYTE>(m_aLight[uIndex] & 0x0Fu);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::setLight
+
+      Summary:  Writes the nibble of a channel
+
+      Args:     size_t uIndex
+                  Index of the cell
+                eLightChannel channel
+                  Channel to write
+                BYTE uLevel
+                  Light from 0 to MAX_LIGHT
+
+      Modifies: [m_aLight].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::setLight(_In_ size_t uIndex, _In_ eLightChannel channel, _In_ BYTE uLevel)
+    {
+        m_aLight[uIndex] = channel == eLightChannel::SKY ?
+            static_cast<BYTE>((m_aLight[uIndex] & 0x0Fu) | (uLevel << 4u)) :
+            static_cast<BYTE>((m_aLight[uIndex] & 0xF0u) | uLevel);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::getIndex
+
+      Summary:  Returns the index of a cell. Cells of a column are
+                contiguous, as in the occupancy grid
+
+      Args:     UINT x
+                  Index along the x-axis
+                UINT y
+                  Index along the y-axis
+                UINT z
+                  Index along the z-axis
+
+      Returns:  size_t
+                  Index of the cell in the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t VoxelLightMap::getIndex(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        return (static_cast<size_t>(z) * m_occupancyGrid->GetWidth() + x) * m_occupancyGrid->GetHeight() + y;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+/*+===================================================================
+  File:      VOXELLIGHTMAP.H
+
+  Summary:   VoxelLightMap header file contains declarations of
+             VoxelLightMap class that floods block light and sky light
+             through the empty cells of the voxel occupancy grid and
+             hands the light of their faces to the voxel instances.
+
+  Classes: VoxelLightMap
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Game/Benchmark.h"
+#include "Renderer/DataTypes.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/Voxel.h"
+#include "Scene/VoxelEditor.h"
+
+namespace library
+{
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+        Enum:     eLightChannel
+
+        Summary:  Light stored for every cell. Block light comes from
+                  the emitters, sky light from the top of the grid
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eLightChannel : UINT
+    {
+        BLOCK = 0u,
+        SKY,
+        COUNT,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelLightStats
+
+        Summary:  Size and build time of the light map, the lit cells,
+                  the cost of relighting after an edit in microseconds
+                  and in cells visited, against building the map again,
+                  and whether the relit map matches a full build after
+                  the edits and once they are undone. Then the number
+                  of instances lit and the time to light them, and the
+                  number of instances lit again by the last relight
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelLightStats
+    {
+        UINT64 ullMemoryBytes;
+        UINT64 ullNumLitCells;
+        FLOAT BuildMilliseconds;
+        UINT uNumEmitters;
+        UINT uNumEdits;
+        FLOAT AverageCellsPerEdit;
+        FLOAT MicrosecondsPerEdit;
+        FLOAT MaxMicrosecondsPerEdit;
+        BOOL bIdentical;
+        UINT uNumInstances;
+        FLOAT InstanceMilliseconds;
+        UINT uLastRelitInstances;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelLightMap
+
+      Summary:  Light level from 0 to MAX_LIGHT of every cell, block
+                light in the low nibble of a byte and sky light in the
+                high one. Light floods breadth-first through the empty
+                cells and loses a level per cell, except sky light at
+                full level, which falls straight down unchanged. Solid
+                cells stay dark unless they emit. An edit relights only
+                the region it affects: a removal queue first darkens
+                the cells the old light reached, handing the brighter
+                cells met on its border to an add queue that floods
+                the light back in. The face of an instance takes the
+                light of the cell in front of it, and the cells relit
+                since the instances were last lit are kept as a box so
+                that only the instances around them are lit again
+
+      Methods:  Build
+                  Floods the light of the whole grid
+                LightInstances
+                  Hands the light of their faces to every instance
+                RelightInstances
+                  Lights again the instances around the relit cells
+                OnCellChanged
+                  Relights after a cell was made solid or empty
+                SetEmitter
+                  Sets the block light a cell emits
+                GetLight
+                  Returns the light of a cell in a channel
+                GetSurfaceLight
+                  Returns the brightest light around a cell
+                Benchmark
+                  Measures the relighting of random edits
+                GetMemoryUsage
+                  Returns the size of the light map in bytes
+                GetStats
+                  Returns the statistics of the build and the last
+                  benchmark
+                benchmarkEdits
+                  Measures the relighting of random edits of the grid
+                getInstanceLight
+                  Returns the light of the faces of a cell
+                markDirty
+                  Extends the box of the relit cells by a cell
+                relight
+                  Relights a channel around a cell
+                floodAdd
+                  Spreads the light of the add queue
+                floodRemove
+                  Darkens the cells of the removal queue
+                getEmission
+                  Returns the light a cell emits in a channel
+                getLight
+                  Reads a level of the map
+                setLight
+                  Writes a level of the map
+                getIndex
+                  Returns the index of a cell
+                VoxelLightMap
+                  Constructor.
+                ~VoxelLightMap
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelLightMap
+    {
+    public:
+        static constexpr const BYTE MAX_LIGHT = 15u;
+        static constexpr const UINT BENCHMARK_EMITTERS = 64u;
+
+        VoxelLightMap(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid);
+        VoxelLightMap(const VoxelLightMap& other) = delete;
+        VoxelLightMap(VoxelLightMap&& other) = delete;
+        VoxelLightMap& operator=(const VoxelLightMap& other) = delete;
+        VoxelLightMap& operator=(VoxelLightMap&& other) = delete;
+        ~VoxelLightMap() = default;
+
+        void Build();
+        HRESULT LightInstances(_In_ const std::vector<std::shared_ptr<Voxel>>& voxels);
+        HRESULT RelightInstances(_In_ const VoxelEditor& editor);
+        UINT OnCellChanged(_In_ UINT x, _In_ UINT y, _In_ UINT z);
+        UINT SetEmitter(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE uLevel);
+        BYTE GetLight(_In_ INT x, _In_ INT y, _In_ INT z, _In_ eLightChannel channel) const;
+        BYTE GetSurfaceLight(_In_ INT x, _In_ INT y, _In_ INT z, _In_ eLightChannel channel) const;
+        const VoxelLightStats& Benchmark(_In_ UINT uNumEdits);
+
+        UINT64 GetMemoryUsage() const;
+        const VoxelLightStats& GetStats() const;
+
+    private:
+        struct LightNode
+        {
+            WORD x;
+            WORD y;
+            WORD z;
+            BYTE uLevel;
+        };
+
+        void benchmarkEdits(_In_ UINT uNumEdits);
+        InstanceLightData getInstanceLight(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        void markDirty(_In_ INT x, _In_ INT y, _In_ INT z);
+        UINT relight(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ eLightChannel channel);
+        UINT floodAdd(_In_ eLightChannel channel);
+        UINT floodRemove(_In_ eLightChannel channel);
+        BYTE getEmission(_In_ INT x, _In_ INT y, _In_ INT z, _In_ eLightChannel channel) const;
+        BYTE getLight(_In_ size_t uIndex, _In_ eLightChannel channel) const;
+        void setLight(_In_ size_t uIndex, _In_ eLightChannel channel, _In_ BYTE uLevel);
+        size_t getIndex(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+
+    private:
+        static constexpr const INT NEIGHBOURS[6][3] =
+        {
+            { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 }
+        };
+
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        XMFLOAT3 m_gridOrigin;
+        std::vector<BYTE> m_aLight;
+        std::unordered_map<size_t, BYTE> m_emitters;
+        std::vector<LightNode> m_aAddQueue;
+        std::vector<LightNode> m_aRemoveQueue;
+        XMINT3 m_dirtyMin;
+        XMINT3 m_dirtyMax;
+        VoxelLightStats m_stats;
+    };
+}
\ No newline at end of file
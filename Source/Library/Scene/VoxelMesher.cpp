@@ -0,0 +1,315 @@
+#include "Scene/VoxelMesher.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesher::VoxelMesher
+
+      Summary:  Constructor
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map giving the block type of each column
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Solid cells of the world
+                UINT uChunkSize
+                  Number of columns along a chunk side
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_uChunkSize, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelMesher::VoxelMesher(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid, _In_ UINT uChunkSize)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_uChunkSize(std::max<UINT>(uChunkSize, 1u))
+        , m_stats()
+    { }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesher::MeshChunk
+
+      Summary:  Builds the meshes of a chunk. For each of the six face
+                directions, every slice of the chunk is turned into a
+                mask of visible faces which is then covered greedily by
+                rectangles of the same block type
+
+      Args:     UINT uChunkX
+                  Index of the chunk along x
+                UINT uChunkZ
+                  Index of the chunk along z
+                std::vector<VoxelMeshData>& aMeshes
+                  Receives one mesh per color of the palette
+
+      Modifies: [m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelMesher::MeshChunk(_In_ UINT uChunkX, _In_ UINT uChunkZ, _Out_ std::vector<VoxelMeshData>& aMeshes)
+    {
+        BenchmarkTimer timer;
+
+        aMeshes.clear();
+        aMeshes.resize(m_heightMap->GetPalette().size());
+
+        const INT aLow[3] =
+        {
+            static_cast<INT>(uChunkX * m_uChunkSize),
+            0,
+            static_cast<INT>(uChunkZ * m_uChunkSize)
+        };
+        const INT aHigh[3] =
+        {
+            static_cast<INT>(std::min<UINT>((uChunkX + 1u) * m_uChunkSize, m_occupancyGrid->GetWidth())),
+            static_cast<INT>(m_occupancyGrid->GetHeight()),
+            static_cast<INT>(std::min<UINT>((uChunkZ + 1u) * m_uChunkSize, m_occupancyGrid->GetDepth()))
+        };
+
+        UINT64 ullNumQuads = 0ull;
+        std::vector<INT> aMask;
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            UINT uAxisU = (uAxis + 1u) % 3u;
+            UINT uAxisV = (uAxis + 2u) % 3u;
+            INT iSizeU = aHigh[uAxisU] - aLow[uAxisU];
+            INT iSizeV = aHigh[uAxisV] - aLow[uAxisV];
+            if (iSizeU <= 0 || iSizeV <= 0)
+            {
+                continue;
+            }
+            aMask.resize(static_cast<size_t>(iSizeU) * static_cast<size_t>(iSizeV));
+
+            for (INT iSign = -1; iSign <= 1; iSign += 2)
+            {
+                for (INT iSlice = aLow[uAxis]; iSlice < aHigh[uAxis]; ++iSlice)
+                {
+                    // Mask of the faces of this slice that look into an
+                    // empty cell, holding the color index plus one
+                    for (INT v = 0; v < iSizeV; ++v)
+                    {
+                        for (INT u = 0; u < iSizeU; ++u)
+                        {
+                            INT aCell[3];
+                            aCell[uAxis] = iSlice;
+                            aCell[uAxisU] = aLow[uAxisU] + u;
+                            aCell[uAxisV] = aLow[uAxisV] + v;
+
+                            INT aNeighbor[3] = { aCell[0], aCell[1], aCell[2] };
+                            aNeighbor[uAxis] += iSign;
+
+                            BOOL bVisible = m_occupancyGrid->IsOccupied(aCell[0], aCell[1], aCell[2]) &&
+                                !m_occupancyGrid->IsOccupied(aNeighbor[0], aNeighbor[1], aNeighbor[2]);
+                            aMask[static_cast<size_t>(v) * iSizeU + u] = bVisible ? getColorIndex(aCell) + 1 : 0;
+                        }
+                    }
+
+                    // Cover the mask with rectangles, growing along u
+                    // first and then along v
+                    for (INT v = 0; v < iSizeV; ++v)
+                    {
+                        for (INT u = 0; u < iSizeU;)
+                        {
+                            INT iColor = aMask[static_cast<size_t>(v) * iSizeU + u];
+                            if (iColor <= 0)
+                            {
+                                ++u;
+                                continue;
+                            }
+
+                            INT iWidth = 1;
+                            while (u + iWidth < iSizeU && aMask[static_cast<size_t>(v) * iSizeU + u + iWidth] == iColor)
+                            {
+                                ++iWidth;
+                            }
+
+                            INT iHeight = 1;
+                            while (v + iHeight < iSizeV)
+                            {
+                                const INT* pRow = aMask.data() + static_cast<size_t>(v + iHeight) * iSizeU + u;
+                                if (std::any_of(pRow, pRow + iWidth, [iColor](INT iOther) { return iOther != iColor; }))
+                                {
+                                    break;
+                                }
+                                ++iHeight;
+                            }
+
+                            for (INT h = 0; h < iHeight; ++h)
+                            {
+                                INT* pRow = aMask.data() + static_cast<size_t>(v + h) * iSizeU + u;
+                                std::fill(pRow, pRow + iWidth, 0);
+                            }
+
+                            INT aCorner[3];
+                            aCorner[uAxis] = iSlice + (iSign > 0 ? 1 : 0);
+                            aCorner[uAxisU] = aLow[uAxisU] + u;
+                            aCorner[uAxisV] = aLow[uAxisV] + v;
+                            addQuad(aCorner, uAxis, iSign, static_cast<UINT>(iWidth), static_cast<UINT>(iHeight), aMeshes[static_cast<size_t>(iColor - 1)]);
+                            ++ullNumQuads;
+
+                            u += iWidth;
+                        }
+                    }
+                }
+            }
+        }
+
+        FLOAT elapsedMilliseconds = timer.GetMilliseconds();
+
+        ++m_stats.uNumChunks;
+        m_stats.ullNumQuads += ullNumQuads;
+        m_stats.ullNumTriangles += ullNumQuads * 2ull;
+        m_stats.TotalMilliseconds += elapsedMilliseconds;
+        m_stats.MaxChunkMilliseconds = std::max<FLOAT>(m_stats.MaxChunkMilliseconds, elapsedMilliseconds);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesher::GetChunkSize
+
+      Summary:  Returns the number of columns along a chunk side
+
+      Returns:  UINT
+                  Size of a chunk
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelMesher::GetChunkSize() const
+    {
+        return m_uChunkSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesher::GetNumChunksX
+
+      Summary:  Returns the number of chunks along x
+
+      Returns:  UINT
+                  Number of chunks along x
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelMesher::GetNumChunksX() const
+    {
+        return (m_occupancyGrid->GetWidth() + m_uChunkSize - 1u) / m_uChunkSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesher::GetNumChunksZ
+
+      Summary:  Returns the number of chunks along z
+
+      Returns:  UINT
+                  Number of chunks along z
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelMesher::GetNumChunksZ() const
+    {
+        return (m_occupancyGrid->GetDepth() + m_uChunkSize - 1u) / m_uChunkSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesher::GetStats
+
+      Summary:  Returns the statistics of the chunks meshed so far
+
+      Returns:  const VoxelMesherStats&
+                  Mesher statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelMesherStats& VoxelMesher::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesher::getColorIndex
+
+      Summary:  Returns the palette index of the block type of a cell
+
+      Args:     const INT (&aCell)[3]
+                  Cell inside the grid
+
+      Returns:  INT
+                  Index into the palette
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    INT VoxelMesher::getColorIndex(_In_ const INT (&aCell)[3]) const
+    {
+        const HeightMapColumn& column = m_heightMap->GetColumn(static_cast<UINT>(aCell[0]), static_cast<UINT>(aCell[2]));
+
+        return static_cast<INT>(column.BlockType) - static_cast<INT>(eBlockType::GRASSLAND);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesher::addQuad
+
+      Summary:  Appends a rectangle of faces to a mesh
+
+      Args:     const INT (&aCorner)[3]
+                  Grid corner of the rectangle with the lowest u and v
+                UINT uAxis
+                  Axis the faces look along
+                INT iSign
+                  Whether the faces look toward +uAxis or -uAxis
+                UINT uWidth
+                  Number of faces along the axis following uAxis
+                UINT uHeight
+                  Number of faces along the axis after that
+                VoxelMeshData& mesh
+                  Mesh to append to
+
+      Modifies: [mesh].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelMesher::addQuad(_In_ const INT (&aCorner)[3], _In_ UINT uAxis, _In_ INT iSign, _In_ UINT uWidth, _In_ UINT uHeight, _Inout_ VoxelMeshData& mesh) const
+    {
+        // Cells are two units wide and centred on GetVoxelPosition
+        XMFLOAT3 origin = m_heightMap->GetVoxelPosition(0u, 0u, 0u);
+        const FLOAT aOrigin[3] = { origin.x - 1.0f, origin.y - 1.0f, origin.z - 1.0f };
+
+        UINT uAxisU = (uAxis + 1u) % 3u;
+        UINT uAxisV = (uAxis + 2u) % 3u;
+
+        FLOAT aNormal[3] = { 0.0f, 0.0f, 0.0f };
+        FLOAT aTangent[3] = { 0.0f, 0.0f, 0.0f };
+        FLOAT aBitangent[3] = { 0.0f, 0.0f, 0.0f };
+        aNormal[uAxis] = static_cast<FLOAT>(iSign);
+        aTangent[uAxisU] = 1.0f;
+        aBitangent[uAxisV] = 1.0f;
+
+        const UINT aCornerU[4] = { 0u, uWidth, uWidth, 0u };
+        const UINT aCornerV[4] = { 0u, 0u, uHeight, uHeight };
+
+        UINT uBaseVertex = static_cast<UINT>(mesh.aVertices.size());
+        for (UINT i = 0u; i < 4u; ++i)
+        {
+            FLOAT aPosition[3];
+            for (UINT uComponent = 0u; uComponent < 3u; ++uComponent)
+            {
+                INT iCell = aCorner[uComponent];
+                if (uComponent == uAxisU)
+                {
+                    iCell += static_cast<INT>(aCornerU[i]);
+                }
+                else if (uComponent == uAxisV)
+                {
+                    iCell += static_cast<INT>(aCornerV[i]);
+                }
+                aPosition[uComponent] = aOrigin[uComponent] + 2.0f * static_cast<FLOAT>(iCell);
+            }
+
+            mesh.aVertices.push_back(
+                SimpleVertex
+                {
+                    .Position = XMFLOAT3(aPosition[0], aPosition[1], aPosition[2]),
+                    .TexCoord = XMFLOAT2(static_cast<FLOAT>(aCornerU[i]), static_cast<FLOAT>(aCornerV[i])),
+                    .Normal = XMFLOAT3(aNormal[0], aNormal[1], aNormal[2])
+                }
+            );
+            mesh.aNormalData.push_back(
+                NormalData
+                {
+                    .Tangent = XMFLOAT3(aTangent[0], aTangent[1], aTangent[2]),
+                    .Bitangent = XMFLOAT3(aBitangent[0], aBitangent[1], aBitangent[2])
+                }
+            );
+        }
+
+        // u x v points along +uAxis, so the corners are clockwise when
+        // seen from the front only for faces looking toward +uAxis
+        if (iSign > 0)
+        {
+            mesh.aIndices.insert(mesh.aIndices.end(), { uBaseVertex, uBaseVertex + 1u, uBaseVertex + 2u, uBaseVertex, uBaseVertex + 2u, uBaseVertex + 3u });
+        }
+        else
+        {
+            mesh.aIndices.insert(mesh.aIndices.end(), { uBaseVertex, uBaseVertex + 2u, uBaseVertex + 1u, uBaseVertex, uBaseVertex + 3u, uBaseVertex + 2u });
+        }
+    }
+}
\ No newline at end of file
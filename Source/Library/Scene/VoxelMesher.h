@@ -0,0 +1,102 @@
+/*+===================================================================
+  File:      VOXELMESHER.H
+
+  Summary:   VoxelMesher header file contains declarations of
+             VoxelMesher class that builds greedy-merged meshes of the
+             voxel world chunk by chunk.
+
+  Classes: VoxelMesher
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Game/Benchmark.h"
+#include "Renderer/DataTypes.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelMeshData
+
+        Summary:  Vertices, tangent frames and 32-bit indices of the
+                  mesh of one block type in a chunk
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelMeshData
+    {
+        std::vector<SimpleVertex> aVertices;
+        std::vector<NormalData> aNormalData;
+        std::vector<UINT> aIndices;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelMesherStats
+
+        Summary:  Number of chunks meshed, the triangles they produced
+                  and the time spent meshing them
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelMesherStats
+    {
+        UINT uNumChunks;
+        UINT64 ullNumQuads;
+        UINT64 ullNumTriangles;
+        FLOAT TotalMilliseconds;
+        FLOAT MaxChunkMilliseconds;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelMesher
+
+      Summary:  Splits the voxel world into chunks of columns and builds
+                one mesh per chunk and block type, merging coplanar
+                faces of the same block type into rectangles
+
+      Methods:  MeshChunk
+                  Builds the meshes of a chunk
+                GetChunkSize
+                  Returns the number of columns along a chunk side
+                GetNumChunksX
+                  Returns the number of chunks along x
+                GetNumChunksZ
+                  Returns the number of chunks along z
+                GetStats
+                  Returns the statistics of the chunks meshed so far
+                VoxelMesher
+                  Constructor.
+                ~VoxelMesher
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelMesher
+    {
+    public:
+        static constexpr const UINT DEFAULT_CHUNK_SIZE = 32u;
+
+        VoxelMesher(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid, _In_ UINT uChunkSize);
+        VoxelMesher(const VoxelMesher& other) = delete;
+        VoxelMesher(VoxelMesher&& other) = delete;
+        VoxelMesher& operator=(const VoxelMesher& other) = delete;
+        VoxelMesher& operator=(VoxelMesher&& other) = delete;
+        ~VoxelMesher() = default;
+
+        void MeshChunk(_In_ UINT uChunkX, _In_ UINT uChunkZ, _Out_ std::vector<VoxelMeshData>& aMeshes);
+
+        UINT GetChunkSize() const;
+        UINT GetNumChunksX() const;
+        UINT GetNumChunksZ() const;
+        const VoxelMesherStats& GetStats() const;
+
+    private:
+        INT getColorIndex(_In_ const INT (&aCell)[3]) const;
+        void addQuad(_In_ const INT (&aCorner)[3], _In_ UINT uAxis, _In_ INT iSign, _In_ UINT uWidth, _In_ UINT uHeight, _Inout_ VoxelMeshData& mesh) const;
+
+    private:
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        UINT m_uChunkSize;
+        VoxelMesherStats m_stats;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "Scene/VoxelPacker.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelPacker::IsInRange
+
+      Summary:  Returns whether grid coordinates fit the 16-bit fields
+                of a packed instance
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+
+      Returns:  BOOL
+                  TRUE if the coordinates can be packed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelPacker::IsInRange(_In_ INT x, _In_ INT y, _In_ INT z)
+    {
+        return x >= MIN_COORDINATE && x <= MAX_COORDINATE
+            && y >= MIN_COORDINATE && y <= MAX_COORDINATE
+            && z >= MIN_COORDINATE && z <= MAX_COORDINATE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelPacker::Pack
+
+      Summary:  Packs the grid coordinates and the block type of a
+                voxel
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index along the y-axis
+                INT z
+                  Index along the z-axis
+                CHAR blockType
+                  Block type of the voxel
+                PackedInstanceData& packed
+                  Receives the packed instance
+
+      Modifies: [packed].
+
+      Returns:  HRESULT
+                  E_INVALIDARG if a coordinate does not fit in 16 bits
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelPacker::Pack(_In_ INT x, _In_ INT y, _In_ INT z, _In_ CHAR blockType, _Out_ PackedInstanceData& packed)
+    {
+        return PackRun(x, y, z, 1u, blockType, packed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelPacker::PackRun
+
+      Summary:  Packs a vertical run of voxels of the same block type,
+                starting at the given cell and going up
+
+      Args:     INT x
+                  Index along the x-axis
+                INT y
+                  Index of the lowest voxel of the run along the y-axis
+                INT z
+                  Index along the z-axis
+                UINT uRunLength
+                  Number of voxels of the run
+                CHAR blockType
+                  Block type of the voxels
+                PackedInstanceData& packed
+                  Receives the packed instance
+
+      Modifies: [packed].
+
+      Returns:  HRESULT
+                  E_INVALIDARG if a coordinate does not fit in 16 bits
+                  or the run is empty or longer than MAX_RUN_LENGTH
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelPacker::PackRun(_In_ INT x, _In_ INT y, _In_ INT z, _In_ UINT uRunLength, _In_ CHAR blockType, _Out_ PackedInstanceData& packed)
+    {
+        packed = PackedInstanceData();
+        if (uRunLength == 0u || uRunLength > MAX_RUN_LENGTH || !IsInRange(x, y, z) || !IsInRange(x, y + static_cast<INT>(uRunLength) - 1, z))
+        {
+            return E_INVALIDARG;
+        }
+
+        packed.X = static_cast<INT16>(x);
+        packed.Y = static_cast<INT16>(y);
+        packed.Z = static_cast<INT16>(z);
+        packed.BlockType = static_cast<BYTE>(blockType);
+        packed.RunLength = static_cast<BYTE>(uRunLength);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelPacker::Unpack
+
+      Summary:  Unpacks the grid coordinates and the block type of a
+                voxel
+
+      Args:     const PackedInstanceData& packed
+                  Packed instance
+                INT& x
+                  Receives the index along the x-axis
+                INT& y
+                  Receives the index along the y-axis
+                INT& z
+                  Receives the index along the z-axis
+                CHAR& blockType
+                  Receives the block type
+
+      Modifies: [x, y, z, blockType].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelPacker::Unpack(_In_ const PackedInstanceData& packed, _Out_ INT& x, _Out_ INT& y, _Out_ INT& z, _Out_ CHAR& blockType)
+    {
+        x = packed.X;
+        y = packed.Y;
+        z = packed.Z;
+        blockType = static_cast<CHAR>(packed.BlockType);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelPacker::GetRunLength
+
+      Summary:  Returns the number of voxels covered by a packed
+                instance. Instances packed before runs existed hold 0,
+                which counts as a single voxel
+
+      Args:     const PackedInstanceData& packed
+                  Packed instance
+
+      Returns:  UINT
+                  Number of voxels of the run
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelPacker::GetRunLength(_In_ const PackedInstanceData& packed)
+    {
+        return std::max<UINT>(packed.RunLength, 1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelPacker::UnpackTransformation
+
+      Summary:  Returns the transform VSVoxelPacked applies to the cube
+                of a packed instance: the cube is halved to span one
+                cell, stretched along y over the run, moved to the
+                center of the run, then taken to world space by the
+                grid transform. With HeightMap::GetGridTransform this
+                equals the transform of the unpacked InstanceData
+
+      Args:     const PackedInstanceData& packed
+                  Packed instance
+                const XMMATRIX& gridTransform
+                  Transform from grid to world space
+
+      Returns:  XMMATRIX
+                  Instance transform
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMMATRIX VoxelPacker::UnpackTransformation(_In_ const PackedInstanceData& packed, _In_ const XMMATRIX& gridTransform)
+    {
+        FLOAT runLength = static_cast<FLOAT>(GetRunLength(packed));
+        return XMMatrixScaling(0.5f, 0.5f * runLength, 0.5f)
+            * XMMatrixTranslation(static_cast<FLOAT>(packed.X), static_cast<FLOAT>(packed.Y) + 0.5f * (runLength - 1.0f), static_cast<FLOAT>(packed.Z))
+            * gridTransform;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+/*+===================================================================
+  File:      VOXELPACKER.H
+
+  Summary:   VoxelPacker header file contains declarations of
+             VoxelPacker class that converts voxel instances to and
+             from the packed 8-byte format.
+
+  Classes: VoxelPacker
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/DataTypes.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelPacker
+
+      Summary:  Packs the grid coordinates, the block type and the
+                length of a vertical run of voxels into a
+                PackedInstanceData and back. It does not
+                touch the device, so the conversions can be checked
+                without a window
+
+      Methods:  IsInRange
+                  Returns whether grid coordinates can be packed
+                Pack
+                  Packs the grid coordinates and block type of a voxel
+                PackRun
+                  Packs the lowest cell, run length and block type of a
+                  vertical run of voxels
+                Unpack
+                  Unpacks the grid coordinates and block type
+                GetRunLength
+                  Returns the number of voxels covered by an instance
+                UnpackTransformation
+                  Returns the instance transform rebuilt by the vertex
+                  shader
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelPacker
+    {
+    public:
+        static constexpr const INT MIN_COORDINATE = -32768;
+        static constexpr const INT MAX_COORDINATE = 32767;
+        static constexpr const UINT MAX_RUN_LENGTH = 255u;
+
+        static BOOL IsInRange(_In_ INT x, _In_ INT y, _In_ INT z);
+        static HRESULT Pack(_In_ INT x, _In_ INT y, _In_ INT z, _In_ CHAR blockType, _Out_ PackedInstanceData& packed);
+        static HRESULT PackRun(_In_ INT x, _In_ INT y, _In_ INT z, _In_ UINT uRunLength, _In_ CHAR blockType, _Out_ PackedInstanceData& packed);
+        static void Unpack(_In_ const PackedInstanceData& packed, _Out_ INT& x, _Out_ INT& y, _Out_ INT& z, _Out_ CHAR& blockType);
+        static UINT GetRunLength(_In_ const PackedInstanceData& packed);
+        static XMMATRIX UnpackTransformation(_In_ const PackedInstanceData& packed, _In_ const XMMATRIX& gridTransform);
+
+        VoxelPacker() = delete;
+        VoxelPacker(const VoxelPacker& other) = delete;
+        VoxelPacker(VoxelPacker&& other) = delete;
+        VoxelPacker& operator=(const VoxelPacker& other) = delete;
+        VoxelPacker& operator=(VoxelPacker&& other) = delete;
+    };
+}
\ No newline at end of file
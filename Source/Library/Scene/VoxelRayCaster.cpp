@@ -0,0 +1,487 @@
+#include "Scene/VoxelRayCaster.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRayCaster::VoxelRayCaster
+
+      Summary:  Constructor. The grid origin is the world position of
+                the lower corner of the cell (0, 0, 0), one cell spans
+                two world units
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map the block types are read from
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Occupancy of the cells
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_gridOrigin, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelRayCaster::VoxelRayCaster(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_gridOrigin()
+        , m_stats()
+    {
+        XMFLOAT3 firstCell = m_heightMap->GetVoxelPosition(0u, 0u, 0u);
+        m_gridOrigin = XMFLOAT3(firstCell.x - 1.0f, firstCell.y - 1.0f, firstCell.z - 1.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRayCaster::CastRay
+
+      Summary:  Returns the first solid cell along a ray. The ray is
+                clipped to the bounds of the grid first, so a ray that
+                starts outside costs nothing until it enters. The
+                column of the current cell is only looked up again when
+                the ray steps along x or z
+
+      Args:     const VoxelRay& ray
+                  Ray in world space
+                VoxelRayHit& hit
+                  Receives the hit
+                UINT* puNumCells
+                  Receives the number of cells visited
+
+      Returns:  BOOL
+                  TRUE if the ray hits a solid cell within its maximum
+                  distance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelRayCaster::CastRay(_In_ const VoxelRay& ray, _Out_ VoxelRayHit& hit, _Out_opt_ UINT* puNumCells) const
+    {
+        static constexpr const eVoxelFace NEGATIVE_FACES[3] = { eVoxelFace::NEGATIVE_X, eVoxelFace::NEGATIVE_Y, eVoxelFace::NEGATIVE_Z };
+        static constexpr const eVoxelFace POSITIVE_FACES[3] = { eVoxelFace::POSITIVE_X, eVoxelFace::POSITIVE_Y, eVoxelFace::POSITIVE_Z };
+
+        hit = {};
+        if (puNumCells)
+        {
+            *puNumCells = 0u;
+        }
+
+        FLOAT length = sqrtf(ray.Direction.x * ray.Direction.x + ray.Direction.y * ray.Direction.y + ray.Direction.z * ray.Direction.z);
+        if (length <= 0.0f || ray.MaxDistance <= 0.0f)
+        {
+            return FALSE;
+        }
+
+        // Grid space, where a cell spans one unit
+        const FLOAT aOrigin[3] =
+        {
+            (ray.Origin.x - m_gridOrigin.x) * 0.5f,
+            (ray.Origin.y - m_gridOrigin.y) * 0.5f,
+            (ray.Origin.z - m_gridOrigin.z) * 0.5f
+        };
+        const FLOAT aDirection[3] = { ray.Direction.x / length, ray.Direction.y / length, ray.Direction.z / length };
+        const INT aSize[3] =
+        {
+            static_cast<INT>(m_occupancyGrid->GetWidth()),
+            static_cast<INT>(m_occupancyGrid->GetHeight()),
+            static_cast<INT>(m_occupancyGrid->GetDepth())
+        };
+
+        FLOAT tEnter = 0.0f;
+        FLOAT tExit = ray.MaxDistance * 0.5f;
+        INT iEnterAxis = -1;
+        for (INT a = 0; a < 3; ++a)
+        {
+            if (aDirection[a] == 0.0f)
+            {
+                if (aOrigin[a] < 0.0f || aOrigin[a] >= static_cast<FLOAT>(aSize[a]))
+                {
+                    return FALSE;
+                }
+                continue;
+            }
+
+            FLOAT t0 = -aOrigin[a] / aDirection[a];
+            FLOAT t1 = (static_cast<FLOAT>(aSize[a]) - aOrigin[a]) / aDirection[a];
+            if (t0 > t1)
+            {
+                std::swap(t0, t1);
+            }
+            if (t0 > tEnter)
+            {
+                tEnter = t0;
+                iEnterAxis = a;
+            }
+            tExit = std::min<FLOAT>(tExit, t1);
+        }
+        if (tEnter > tExit)
+        {
+            return FALSE;
+        }
+
+        INT aCell[3];
+        INT aStep[3];
+        FLOAT aMax[3];
+        FLOAT aDelta[3];
+        for (INT a = 0; a < 3; ++a)
+        {
+            FLOAT position = aOrigin[a] + aDirection[a] * tEnter;
+            aCell[a] = std::clamp<INT>(static_cast<INT>(floorf(position)), 0, aSize[a] - 1);
+            if (aDirection[a] > 0.0f)
+            {
+                aStep[a] = 1;
+                aDelta[a] = 1.0f / aDirection[a];
+                aMax[a] = (static_cast<FLOAT>(aCell[a] + 1) - aOrigin[a]) / aDirection[a];
+            }
+            else if (aDirection[a] < 0.0f)
+            {
+                aStep[a] = -1;
+                aDelta[a] = -1.0f / aDirection[a];
+                aMax[a] = (static_cast<FLOAT>(aCell[a]) - aOrigin[a]) / aDirection[a];
+            }
+            else
+            {
+                aStep[a] = 0;
+                aDelta[a] = FLT_MAX;
+                aMax[a] = FLT_MAX;
+            }
+        }
+
+        eVoxelFace face = eVoxelFace::NONE;
+        if (iEnterAxis >= 0)
+        {
+            face = aStep[iEnterAxis] > 0 ? NEGATIVE_FACES[iEnterAxis] : POSITIVE_FACES[iEnterAxis];
+        }
+
+        FLOAT t = tEnter;
+        UINT uNumCells = 0u;
+        const UINT64* pWords = m_occupancyGrid->GetColumnWords(aCell[0], aCell[2]);
+        for (;;)
+        {
+            ++uNumCells;
+            UINT y = static_cast<UINT>(aCell[1]);
+            if ((pWords[y / OccupancyGrid::BITS_PER_WORD] >> (y % OccupancyGrid::BITS_PER_WORD)) & 1ull)
+            {
+                break;
+            }
+
+            INT a = aMax[0] < aMax[1] ? (aMax[0] < aMax[2] ? 0 : 2) : (aMax[1] < aMax[2] ? 1 : 2);
+            t = aMax[a];
+            aCell[a] += aStep[a];
+            if (t > tExit || aCell[a] < 0 || aCell[a] >= aSize[a])
+            {
+                if (puNumCells)
+                {
+                    *puNumCells = uNumCells;
+                }
+                return FALSE;
+            }
+            aMax[a] += aDelta[a];
+            face = aStep[a] > 0 ? NEGATIVE_FACES[a] : POSITIVE_FACES[a];
+            if (a != 1)
+            {
+                pWords = m_occupancyGrid->GetColumnWords(aCell[0], aCell[2]);
+            }
+        }
+
+        if (puNumCells)
+        {
+            *puNumCells = uNumCells;
+        }
+
+        FLOAT distance = t * 2.0f;
+        hit =
+        {
+            .Cell = XMINT3(aCell[0], aCell[1], aCell[2]),
+            .Face = face,
+            .BlockType = m_heightMap->GetColumn(static_cast<UINT>(aCell[0]), static_cast<UINT>(aCell[2])).BlockType,
+            .Distance = distance,
+            .Position = XMFLOAT3(
+                ray.Origin.x + aDirection[0] * distance,
+                ray.Origin.y + aDirection[1] * distance,
+                ray.Origin.z + aDirection[2] * distance
+            ),
+            .bHit = TRUE
+        };
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRayCaster::CastRays
+
+      Summary:  Casts a batch of rays, for instance the sight lines of
+                many agents. Workers take RAYS_PER_BATCH rays at a time,
+                the first worker being the calling thread
+
+      Args:     const VoxelRay* pRays
+                  Rays to cast
+                UINT uNumRays
+                  Number of rays
+                VoxelRayHit* pHits
+                  Receives the hit of each ray
+                UINT uNumWorkers
+                  Number of workers, 0 for every hardware thread
+
+      Returns:  UINT
+                  Number of rays that hit a solid cell
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelRayCaster::CastRays(_In_reads_(uNumRays) const VoxelRay* pRays, _In_ UINT uNumRays, _Out_writes_(uNumRays) VoxelRayHit* pHits, _In_ UINT uNumWorkers) const
+    {
+        UINT uNumBatches = (uNumRays + RAYS_PER_BATCH - 1u) / RAYS_PER_BATCH;
+        uNumWorkers = uNumWorkers > 0u ? uNumWorkers : std::thread::hardware_concurrency();
+        uNumWorkers = std::clamp<UINT>(uNumWorkers, 1u, std::max<UINT>(uNumBatches, 1u));
+
+        std::atomic<UINT> uNextBatch(0u);
+        std::atomic<UINT> uNumHits(0u);
+        std::vector<std::thread> aWorkers;
+        aWorkers.reserve(uNumWorkers - 1u);
+        for (UINT i = 1u; i < uNumWorkers; ++i)
+        {
+            aWorkers.emplace_back(&VoxelRayCaster::castRays, this, std::ref(uNextBatch), pRays, uNumRays, pHits, std::ref(uNumHits));
+        }
+        castRays(uNextBatch, pRays, uNumRays, pHits, uNumHits);
+
+        for (std::thread& worker : aWorkers)
+        {
+            worker.join();
+        }
+
+        return uNumHits.load();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRayCaster::HasLineOfSight
+
+      Summary:  Returns whether no solid cell lies on the segment
+                between two points. A point inside a solid cell blocks
+                the segment
+
+      Args:     const XMFLOAT3& from
+                  Start of the segment in world space
+                const XMFLOAT3& to
+                  End of the segment in world space
+
+      Returns:  BOOL
+                  TRUE if the segment is clear
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelRayCaster::HasLineOfSight(_In_ const XMFLOAT3& from, _In_ const XMFLOAT3& to) const
+    {
+        XMFLOAT3 direction(to.x - from.x, to.y - from.y, to.z - from.z);
+        FLOAT length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        if (length <= 0.0f)
+        {
+            return TRUE;
+        }
+
+        VoxelRayHit hit;
+        return !CastRay(VoxelRay{ .Origin = from, .Direction = direction, .MaxDistance = length }, hit);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRayCaster::Benchmark
+
+      Summary:  Casts pseudo-random rays from above the terrain down
+                onto it, one at a time and then batched, and measures
+                the throughput of both. The first uNumBruteForceRays
+                rays are also tested against every exposed cell, which
+                is what picking through the instance matrices amounts
+                to, and their hits compared
+
+      Args:     UINT uNumRays
+                  Number of rays to cast
+                UINT uNumBruteForceRays
+                  Number of rays tested by brute force
+
+      Modifies: [m_stats].
+
+      Returns:  const VoxelRayCastStats&
+                  Statistics of the benchmark
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelRayCastStats& VoxelRayCaster::Benchmark(_In_ UINT uNumRays, _In_ UINT uNumBruteForceRays)
+    {
+        m_stats = {};
+        UINT uWidth = m_occupancyGrid->GetWidth();
+        UINT uHeight = m_occupancyGrid->GetHeight();
+        UINT uDepth = m_occupancyGrid->GetDepth();
+        if (uNumRays == 0u || uWidth == 0u || uHeight == 0u || uDepth == 0u)
+        {
+            return m_stats;
+        }
+        uNumBruteForceRays = std::min<UINT>(uNumBruteForceRays, uNumRays);
+
+        // Rays leave a fixed seed so that runs are comparable
+        std::vector<VoxelRay> aRays(uNumRays);
+        BenchmarkRandom random;
+        for (VoxelRay& ray : aRays)
+        {
+            ray.Origin = XMFLOAT3(
+                m_gridOrigin.x + 2.0f * random.GetFloat() * static_cast<FLOAT>(uWidth),
+                m_gridOrigin.y + 2.0f * static_cast<FLOAT>(uHeight) + 2.0f,
+                m_gridOrigin.z + 2.0f * random.GetFloat() * static_cast<FLOAT>(uDepth)
+            );
+            ray.Direction = XMFLOAT3(random.GetFloat() * 2.0f - 1.0f, -0.25f - random.GetFloat(), random.GetFloat() * 2.0f - 1.0f);
+            ray.MaxDistance = 4.0f * static_cast<FLOAT>(uWidth + uHeight + uDepth);
+        }
+        std::vector<VoxelRayHit> aHits(uNumRays);
+
+        BenchmarkTimer timer;
+        UINT64 ullNumCells = 0ull;
+        timer.Start();
+        for (UINT i = 0u; i < uNumRays; ++i)
+        {
+            UINT uNumCells = 0u;
+            m_stats.uNumHits += CastRay(aRays[i], aHits[i], &uNumCells) ? 1u : 0u;
+            ullNumCells += uNumCells;
+        }
+        m_stats.MegaRaysPerSecond = timer.GetMegaPerSecond(uNumRays);
+
+        std::vector<VoxelRayHit> aBatchHits(uNumRays);
+        m_stats.uNumWorkers = std::clamp<UINT>(std::thread::hardware_concurrency(), 1u, std::max<UINT>((uNumRays + RAYS_PER_BATCH - 1u) / RAYS_PER_BATCH, 1u));
+        timer.Start();
+        UINT uNumBatchHits = CastRays(aRays.data(), uNumRays, aBatchHits.data(), m_stats.uNumWorkers);
+        m_stats.BatchMegaRaysPerSecond = timer.GetMegaPerSecond(uNumRays);
+
+        m_stats.uNumRays = uNumRays;
+        m_stats.AverageCellsPerRay = static_cast<FLOAT>(static_cast<double>(ullNumCells) / static_cast<double>(uNumRays));
+        m_stats.bIdentical = uNumBatchHits == m_stats.uNumHits;
+
+        timer.Start();
+        for (UINT i = 0u; i < uNumBruteForceRays; ++i)
+        {
+            VoxelRayHit bruteForceHit;
+            castRayBruteForce(aRays[i], bruteForceHit);
+            if (bruteForceHit.bHit != aHits[i].bHit ||
+                (aHits[i].bHit && (bruteForceHit.Cell.x != aHits[i].Cell.x || bruteForceHit.Cell.y != aHits[i].Cell.y || bruteForceHit.Cell.z != aHits[i].Cell.z)))
+            {
+                m_stats.bIdentical = FALSE;
+            }
+        }
+        FLOAT seconds = timer.GetSeconds();
+        m_stats.BruteForceRaysPerSecond = seconds > 0.0f ? static_cast<FLOAT>(uNumBruteForceRays) / seconds : 0.0f;
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"VoxelRayCaster: %u rays, %u hits, %.1f cells per ray, %.2f M rays/s, %.2f M rays/s on %u workers, brute force %.1f rays/s, %s\n",
+            m_stats.uNumRays,
+            m_stats.uNumHits,
+            m_stats.AverageCellsPerRay,
+            m_stats.MegaRaysPerSecond,
+            m_stats.BatchMegaRaysPerSecond,
+            m_stats.uNumWorkers,
+            m_stats.BruteForceRaysPerSecond,
+            m_stats.bIdentical ? L"identical" : L"MISMATCH"
+        );
+        OutputDebugString(szReport);
+
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRayCaster::GetStats
+
+      Summary:  Returns the statistics of the last benchmark
+
+      Returns:  const VoxelRayCastStats&
+                  Statistics of the last benchmark
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelRayCastStats& VoxelRayCaster::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRayCaster::castRays
+
+      Summary:  Casts the batches of rays taken by one worker
+
+      Args:     std::atomic<UINT>& uNextBatch
+                  Index of the next batch to take
+                const VoxelRay* pRays
+                  Rays to cast
+                UINT uNumRays
+                  Number of rays
+                VoxelRayHit* pHits
+                  Receives the hit of each ray
+                std::atomic<UINT>& uNumHits
+                  Number of rays that hit, shared by the workers
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelRayCaster::castRays(_Inout_ std::atomic<UINT>& uNextBatch, _In_reads_(uNumRays) const VoxelRay* pRays, _In_ UINT uNumRays, _Out_writes_(uNumRays) VoxelRayHit* pHits, _Inout_ std::atomic<UINT>& uNumHits) const
+    {
+        UINT uNumLocalHits = 0u;
+        for (UINT uBegin = uNextBatch.fetch_add(1u) * RAYS_PER_BATCH; uBegin < uNumRays; uBegin = uNextBatch.fetch_add(1u) * RAYS_PER_BATCH)
+        {
+            UINT uEnd = std::min<UINT>(uBegin + RAYS_PER_BATCH, uNumRays);
+            for (UINT i = uBegin; i < uEnd; ++i)
+            {
+                uNumLocalHits += CastRay(pRays[i], pHits[i]) ? 1u : 0u;
+            }
+        }
+        uNumHits.fetch_add(uNumLocalHits);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRayCaster::castRayBruteForce
+
+      Summary:  Tests a ray against the box of every exposed cell and
+                keeps the nearest, the reference the traversal is
+                measured against
+
+      Args:     const VoxelRay& ray
+                  Ray in world space
+                VoxelRayHit& hit
+                  Receives the cell hit, only Cell, Distance and bHit
+                  are set
+
+      Returns:  BOOL
+                  TRUE if the ray hits a solid cell within its maximum
+                  distance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelRayCaster::castRayBruteForce(_In_ const VoxelRay& ray, _Out_ VoxelRayHit& hit) const
+    {
+        hit = {};
+
+        FLOAT length = sqrtf(ray.Direction.x * ray.Direction.x + ray.Direction.y * ray.Direction.y + ray.Direction.z * ray.Direction.z);
+        if (length <= 0.0f)
+        {
+            return FALSE;
+        }
+
+        const FLOAT aOrigin[3] =
+        {
+            (ray.Origin.x - m_gridOrigin.x) * 0.5f,
+            (ray.Origin.y - m_gridOrigin.y) * 0.5f,
+            (ray.Origin.z - m_gridOrigin.z) * 0.5f
+        };
+        const FLOAT aInverse[3] = { length / ray.Direction.x, length / ray.Direction.y, length / ray.Direction.z };
+
+        FLOAT nearest = ray.MaxDistance * 0.5f;
+        INT uWidth = static_cast<INT>(m_occupancyGrid->GetWidth());
+        INT uHeight = static_cast<INT>(m_occupancyGrid->GetHeight());
+        INT uDepth = static_cast<INT>(m_occupancyGrid->GetDepth());
+        for (INT z = 0; z < uDepth; ++z)
+        {
+            for (INT x = 0; x < uWidth; ++x)
+            {
+                for (INT y = 0; y < uHeight; ++y)
+                {
+                    if (!m_occupancyGrid->IsExposed(x, y, z))
+                    {
+                        continue;
+                    }
+
+                    const INT aCell[3] = { x, y, z };
+                    FLOAT tEnter = 0.0f;
+                    FLOAT tExit = nearest;
+                    for (INT a = 0; a < 3 && tEnter <= tExit; ++a)
+                    {
+                        FLOAT t0 = (static_cast<FLOAT>(aCell[a]) - aOrigin[a]) * aInverse[a];
+                        FLOAT t1 = (static_cast<FLOAT>(aCell[a] + 1) - aOrigin[a]) * aInverse[a];
+                        tEnter = std::max<FLOAT>(tEnter, std::min<FLOAT>(t0, t1));
+                        tExit = std::min<FLOAT>(tExit, std::max<FLOAT>(t0, t1));
+                    }
+                    if (tEnter <= tExit && (!hit.bHit || tEnter < nearest))
+                    {
+                        nearest = tEnter;
+                        hit.Cell = XMINT3(x, y, z);
+                        hit.Distance = tEnter * 2.0f;
+                        hit.bHit = TRUE;
+                    }
+                }
+            }
+        }
+
+        return hit.bHit;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+/*+===================================================================
+  File:      VOXELRAYCASTER.H
+
+  Summary:   VoxelRayCaster header file contains declarations of
+             VoxelRayCaster class that casts rays through the voxel
+             occupancy grid for picking and visibility queries.
+
+  Classes: VoxelRayCaster
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <cfloat>
+#include <thread>
+
+#include "Game/Benchmark.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+
+namespace library
+{
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+        Enum:     eVoxelFace
+
+        Summary:  Face of a voxel a ray enters through. NONE is reported
+                  when the ray starts inside the voxel it hits
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eVoxelFace : UINT
+    {
+        NONE = 0u,
+        NEGATIVE_X,
+        POSITIVE_X,
+        NEGATIVE_Y,
+        POSITIVE_Y,
+        NEGATIVE_Z,
+        POSITIVE_Z,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelRay
+
+        Summary:  Ray in world space. The direction does not need to be
+                  normalized, distances are measured in world units
+                  along its normalized form
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelRay
+    {
+        XMFLOAT3 Origin;
+        XMFLOAT3 Direction;
+        FLOAT MaxDistance;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelRayHit
+
+        Summary:  First solid cell along a ray, the face the ray enters
+                  it through, its block type, and the distance and world
+                  position of the entry point. Only bHit is set when the
+                  ray misses
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelRayHit
+    {
+        XMINT3 Cell;
+        eVoxelFace Face;
+        CHAR BlockType;
+        FLOAT Distance;
+        XMFLOAT3 Position;
+        BOOL bHit;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelRayCastStats
+
+        Summary:  Throughput of the traversal in millions of rays per
+                  second, one ray at a time and batched across workers,
+                  against testing every exposed cell as the instances
+                  would, the average number of cells visited by a ray,
+                  and whether both methods hit the same cells
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelRayCastStats
+    {
+        UINT uNumRays;
+        UINT uNumHits;
+        UINT uNumWorkers;
+        FLOAT AverageCellsPerRay;
+        FLOAT MegaRaysPerSecond;
+        FLOAT BatchMegaRaysPerSecond;
+        FLOAT BruteForceRaysPerSecond;
+        BOOL bIdentical;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelRayCaster
+
+      Summary:  Casts rays through the occupancy grid with the
+                Amanatides-Woo traversal: the ray is clipped to the
+                grid, then steps from cell to cell along the axis whose
+                next boundary is nearest, so a ray costs one step per
+                cell it crosses whatever the size of the world. Block
+                types are read from the columns of the height map
+
+      Methods:  CastRay
+                  Returns the first solid cell along a ray
+                CastRays
+                  Casts a batch of rays across worker threads
+                HasLineOfSight
+                  Returns whether no solid cell lies between two points
+                Benchmark
+                  Measures the traversal against a brute-force test
+                GetStats
+                  Returns the statistics of the last benchmark
+                castRays
+                  Casts the batches taken by one worker
+                castRayBruteForce
+                  Tests a ray against every exposed cell
+                VoxelRayCaster
+                  Constructor.
+                ~VoxelRayCaster
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelRayCaster
+    {
+    public:
+        static constexpr const UINT RAYS_PER_BATCH = 256u;
+        static constexpr const UINT BENCHMARK_BRUTE_FORCE_RAYS = 256u;
+
+        VoxelRayCaster(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid);
+        VoxelRayCaster(const VoxelRayCaster& other) = delete;
+        VoxelRayCaster(VoxelRayCaster&& other) = delete;
+        VoxelRayCaster& operator=(const VoxelRayCaster& other) = delete;
+        VoxelRayCaster& operator=(VoxelRayCaster&& other) = delete;
+        ~VoxelRayCaster() = default;
+
+        BOOL CastRay(_In_ const VoxelRay& ray, _Out_ VoxelRayHit& hit, _Out_opt_ UINT* puNumCells = nullptr) const;
+        UINT CastRays(_In_reads_(uNumRays) const VoxelRay* pRays, _In_ UINT uNumRays, _Out_writes_(uNumRays) VoxelRayHit* pHits, _In_ UINT uNumWorkers = 0u) const;
+        BOOL HasLineOfSight(_In_ const XMFLOAT3& from, _In_ const XMFLOAT3& to) const;
+        const VoxelRayCastStats& Benchmark(_In_ UINT uNumRays, _In_ UINT uNumBruteForceRays);
+
+        const VoxelRayCastStats& GetStats() const;
+
+    private:
+        void castRays(_Inout_ std::atomic<UINT>& uNextBatch, _In_reads_(uNumRays) const VoxelRay* pRays, _In_ UINT uNumRays, _Out_writes_(uNumRays) VoxelRayHit* pHits, _Inout_ std::atomic<UINT>& uNumHits) const;
+        BOOL castRayBruteForce(_In_ const VoxelRay& ray, _Out_ VoxelRayHit& hit) const;
+
+    private:
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        XMFLOAT3 m_gridOrigin;
+        VoxelRayCastStats m_stats;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,500 @@
+#include "Scene/VoxelStreamer.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::VoxelStreamer
+
+      Summary:  Constructor. Starts the worker threads
+
+      Args:     const std::shared_ptr<HeightMap>& heightMap
+                  Height map giving the block type of each column
+                const std::shared_ptr<OccupancyGrid>& occupancyGrid
+                  Solid cells of the world
+                const VoxelStreamingDesc& desc
+                  Streaming parameters
+
+      Modifies: [m_heightMap, m_occupancyGrid, m_instanceBuilder,
+                 m_desc, m_uNumChunksX, m_uNumChunksZ, m_frequency,
+                 m_residentChunks, m_requestedKeys,
+                 m_ullBudgetDistanceSquared, m_totalLoadMilliseconds,
+                 m_stats, m_requestQueue, m_completedChunks,
+                 m_bStopping, m_aWorkers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelStreamer::VoxelStreamer(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid, _In_ const VoxelStreamingDesc& desc)
+        : m_heightMap(heightMap)
+        , m_occupancyGrid(occupancyGrid)
+        , m_instanceBuilder(heightMap, occupancyGrid, desc.bCollapseRuns)
+        , m_desc(desc)
+        , m_uNumChunksX(0u)
+        , m_uNumChunksZ(0u)
+        , m_frequency()
+        , m_residentChunks()
+        , m_requestedKeys()
+        , m_ullBudgetDistanceSquared(UINT64_MAX)
+        , m_totalLoadMilliseconds(0.0)
+        , m_stats()
+        , m_mutex()
+        , m_condition()
+        , m_requestQueue()
+        , m_completedChunks()
+        , m_bStopping(FALSE)
+        , m_aWorkers()
+    {
+        m_desc.uChunkSize = std::max<UINT>(m_desc.uChunkSize, 1u);
+        m_desc.bPackedInstances = m_desc.bPackedInstances && VoxelPacker::IsInRange(
+            static_cast<INT>(m_occupancyGrid->GetWidth()) - 1,
+            static_cast<INT>(m_occupancyGrid->GetHeight()) - 1,
+            static_cast<INT>(m_occupancyGrid->GetDepth()) - 1
+        );
+        if (m_desc.uNumWorkers == 0u)
+        {
+            m_desc.uNumWorkers = std::max<UINT>(std::thread::hardware_concurrency(), 2u) - 1u;
+        }
+
+        m_uNumChunksX = (m_heightMap->GetWidth() + m_desc.uChunkSize - 1u) / m_desc.uChunkSize;
+        m_uNumChunksZ = (m_heightMap->GetDepth() + m_desc.uChunkSize - 1u) / m_desc.uChunkSize;
+        QueryPerformanceFrequency(&m_frequency);
+
+        m_aWorkers.reserve(m_desc.uNumWorkers);
+        for (UINT uWorkerIdx = 0u; uWorkerIdx < m_desc.uNumWorkers; ++uWorkerIdx)
+        {
+            m_aWorkers.emplace_back(&VoxelStreamer::workerMain, this);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::~VoxelStreamer
+
+      Summary:  Destructor. Stops the worker threads and reports the
+                streaming statistics
+
+      Modifies: [m_bStopping, m_aWorkers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelStreamer::~VoxelStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStopping = TRUE;
+        }
+        m_condition.notify_all();
+
+        for (std::thread& worker : m_aWorkers)
+        {
+            worker.join();
+        }
+
+        WCHAR szReport[256];
+        swprintf_s(
+            szReport,
+            L"VoxelStreamer: %llu chunks loaded, %llu released, load latency %.2f ms on average, %.2f ms at most\n",
+            m_stats.ullNumLoadedChunks,
+            m_stats.ullNumReleasedChunks,
+            m_stats.AverageLoadMilliseconds,
+            m_stats.MaxLoadMilliseconds
+        );
+        OutputDebugString(szReport);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::Update
+
+      Summary:  Queues the missing chunks of the ring around the
+                camera, drops queued chunks that left it, creates the
+                voxels of the chunks built since the last update, then
+                releases the chunks out of the ring and evicts the
+                farthest ones while over the memory budget. Chunks are
+                kept one chunk beyond the load radius so that a camera
+                moving back and forth across a chunk border does not
+                reload them
+
+      Args:     const XMVECTOR& eye
+                  Position of the camera
+                ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+                const std::shared_ptr<VertexShader>& vertexShader
+                  Vertex shader of the streamed voxels
+                const std::shared_ptr<PixelShader>& pixelShader
+                  Pixel shader of the streamed voxels
+
+      Modifies: [m_residentChunks, m_requestedKeys,
+                 m_ullBudgetDistanceSquared, m_totalLoadMilliseconds,
+                 m_stats, m_requestQueue, m_completedChunks].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelStreamer::Update(
+        _In_ const XMVECTOR& eye,
+        _In_ ID3D11Device* pDevice,
+        _In_ ID3D11DeviceContext* pImmediateContext,
+        _In_ const std::shared_ptr<VertexShader>& vertexShader,
+        _In_ const std::shared_ptr<PixelShader>& pixelShader
+    )
+    {
+        // Inverse of HeightMap::GetVoxelPosition on the xz-plane
+        XMFLOAT3 eyePosition;
+        XMStoreFloat3(&eyePosition, eye);
+        INT iCenterX = static_cast<INT>(std::floor((eyePosition.x * 0.5f + static_cast<FLOAT>(m_heightMap->GetWidth()) * 0.5f) / static_cast<FLOAT>(m_desc.uChunkSize)));
+        INT iCenterZ = static_cast<INT>(std::floor((eyePosition.z * 0.5f + static_cast<FLOAT>(m_heightMap->GetDepth()) * 0.5f) / static_cast<FLOAT>(m_desc.uChunkSize)));
+
+        INT iRadius = static_cast<INT>(m_desc.uLoadRadius);
+        UINT64 ullLoadDistanceSquared = static_cast<UINT64>(m_desc.uLoadRadius) * m_desc.uLoadRadius;
+        UINT64 ullKeepDistanceSquared = static_cast<UINT64>(m_desc.uLoadRadius + 1u) * (m_desc.uLoadRadius + 1u);
+
+        std::vector<std::unique_ptr<Chunk>> aCompletedChunks;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            aCompletedChunks.swap(m_completedChunks);
+
+            auto it = m_requestQueue.begin();
+            while (it != m_requestQueue.end())
+            {
+                UINT64 ullDistanceSquared = getDistanceSquared((*it)->uChunkX, (*it)->uChunkZ, iCenterX, iCenterZ);
+                if (ullDistanceSquared > ullLoadDistanceSquared || ullDistanceSquared >= m_ullBudgetDistanceSquared)
+                {
+                    m_requestedKeys.erase(getKey((*it)->uChunkX, (*it)->uChunkZ));
+                    it = m_requestQueue.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            LARGE_INTEGER requestTime;
+            QueryPerformanceCounter(&requestTime);
+            for (INT iChunkZ = std::max<INT>(iCenterZ - iRadius, 0); iChunkZ <= std::min<INT>(iCenterZ + iRadius, static_cast<INT>(m_uNumChunksZ) - 1); ++iChunkZ)
+            {
+                for (INT iChunkX = std::max<INT>(iCenterX - iRadius, 0); iChunkX <= std::min<INT>(iCenterX + iRadius, static_cast<INT>(m_uNumChunksX) - 1); ++iChunkX)
+                {
+                    UINT64 ullDistanceSquared = getDistanceSquared(static_cast<UINT>(iChunkX), static_cast<UINT>(iChunkZ), iCenterX, iCenterZ);
+                    UINT64 ullKey = getKey(static_cast<UINT>(iChunkX), static_cast<UINT>(iChunkZ));
+                    if (ullDistanceSquared > ullLoadDistanceSquared || ullDistanceSquared >= m_ullBudgetDistanceSquared
+                        || m_residentChunks.contains(ullKey) || m_requestedKeys.contains(ullKey))
+                    {
+                        continue;
+                    }
+
+                    std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>();
+                    chunk->uChunkX = static_cast<UINT>(iChunkX);
+                    chunk->uChunkZ = static_cast<UINT>(iChunkZ);
+                    chunk->llRequestTicks = requestTime.QuadPart;
+                    chunk->ullBytes = 0ull;
+                    m_requestQueue.push_back(std::move(chunk));
+                    m_requestedKeys.insert(ullKey);
+                }
+            }
+
+            // Nearest chunks are built first
+            std::stable_sort(
+                m_requestQueue.begin(),
+                m_requestQueue.end(),
+                [iCenterX, iCenterZ](const std::unique_ptr<Chunk>& a, const std::unique_ptr<Chunk>& b)
+                {
+                    return getDistanceSquared(a->uChunkX, a->uChunkZ, iCenterX, iCenterZ) < getDistanceSquared(b->uChunkX, b->uChunkZ, iCenterX, iCenterZ);
+                }
+            );
+        }
+        m_condition.notify_all();
+
+        HRESULT hrUpload = S_OK;
+        LARGE_INTEGER uploadTime;
+        QueryPerformanceCounter(&uploadTime);
+        for (std::unique_ptr<Chunk>& chunk : aCompletedChunks)
+        {
+            UINT64 ullKey = getKey(chunk->uChunkX, chunk->uChunkZ);
+            m_requestedKeys.erase(ullKey);
+            if (getDistanceSquared(chunk->uChunkX, chunk->uChunkZ, iCenterX, iCenterZ) > ullKeepDistanceSquared)
+            {
+                continue;
+            }
+
+            const std::vector<XMFLOAT4>& aPalette = m_heightMap->GetPalette();
+            HRESULT hr = S_OK;
+            for (size_t uColorIdx = 0u; uColorIdx < aPalette.size() && SUCCEEDED(hr); ++uColorIdx)
+            {
+                std::shared_ptr<Voxel> voxel;
+                if (uColorIdx < chunk->aPackedInstanceData.size() && !chunk->aPackedInstanceData[uColorIdx].empty())
+                {
+                    voxel = std::make_shared<PackedVoxel>(std::move(chunk->aPackedInstanceData[uColorIdx]), m_heightMap->GetGridTransform(), aPalette[uColorIdx]);
+                }
+                else if (uColorIdx < chunk->aInstanceData.size() && !chunk->aInstanceData[uColorIdx].empty())
+                {
+                    voxel = std::make_shared<Voxel>(std::move(chunk->aInstanceData[uColorIdx]), aPalette[uColorIdx]);
+                }
+                else
+                {
+                    continue;
+                }
+
+                if (vertexShader)
+                {
+                    voxel->SetVertexShader(vertexShader);
+                }
+                if (pixelShader)
+                {
+                    voxel->SetPixelShader(pixelShader);
+                }
+
+                hr = voxel->Initialize(pDevice, pImmediateContext);
+                chunk->voxels.push_back(voxel);
+            }
+
+            // A chunk that failed to upload is requested again
+            if (FAILED(hr))
+            {
+                hrUpload = hr;
+                continue;
+            }
+            std::vector<std::vector<InstanceData>>().swap(chunk->aInstanceData);
+            std::vector<std::vector<PackedInstanceData>>().swap(chunk->aPackedInstanceData);
+
+            FLOAT loadMilliseconds = static_cast<FLOAT>(uploadTime.QuadPart - chunk->llRequestTicks) * 1000.0f / static_cast<FLOAT>(m_frequency.QuadPart);
+            m_totalLoadMilliseconds += loadMilliseconds;
+            ++m_stats.ullNumLoadedChunks;
+            m_stats.LastLoadMilliseconds = loadMilliseconds;
+            m_stats.AverageLoadMilliseconds = static_cast<FLOAT>(m_totalLoadMilliseconds / static_cast<DOUBLE>(m_stats.ullNumLoadedChunks));
+            m_stats.MaxLoadMilliseconds = std::max<FLOAT>(m_stats.MaxLoadMilliseconds, loadMilliseconds);
+            m_stats.ullResidentBytes += chunk->ullBytes;
+
+            m_residentChunks.emplace(ullKey, std::move(chunk));
+        }
+
+        std::vector<UINT64> aReleasedKeys;
+        for (const auto& [ullKey, chunk] : m_residentChunks)
+        {
+            if (getDistanceSquared(chunk->uChunkX, chunk->uChunkZ, iCenterX, iCenterZ) > ullKeepDistanceSquared)
+            {
+                aReleasedKeys.push_back(ullKey);
+            }
+        }
+        for (UINT64 ullKey : aReleasedKeys)
+        {
+            release(ullKey);
+        }
+
+        // Over budget, the ring shrinks to the farthest evicted chunk. It
+        // grows back once a quarter of the budget is free again
+        if (m_stats.ullResidentBytes > m_desc.ullMemoryBudgetBytes)
+        {
+            while (m_stats.ullResidentBytes > m_desc.ullMemoryBudgetBytes && !m_residentChunks.empty())
+            {
+                auto farthest = std::max_element(
+                    m_residentChunks.begin(),
+                    m_residentChunks.end(),
+                    [iCenterX, iCenterZ](const auto& a, const auto& b)
+                    {
+                        return getDistanceSquared(a.second->uChunkX, a.second->uChunkZ, iCenterX, iCenterZ) < getDistanceSquared(b.second->uChunkX, b.second->uChunkZ, iCenterX, iCenterZ);
+                    }
+                );
+                m_ullBudgetDistanceSquared = getDistanceSquared(farthest->second->uChunkX, farthest->second->uChunkZ, iCenterX, iCenterZ);
+                release(farthest->first);
+            }
+        }
+        else if (m_stats.ullResidentBytes < m_desc.ullMemoryBudgetBytes / 4ull * 3ull)
+        {
+            m_ullBudgetDistanceSquared = UINT64_MAX;
+        }
+
+        m_stats.uNumResidentChunks = static_cast<UINT>(m_residentChunks.size());
+        m_stats.uNumPendingChunks = static_cast<UINT>(m_requestedKeys.size());
+
+        return hrUpload;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::GetVoxels
+
+      Summary:  Returns the voxels of the resident chunks
+
+      Args:     std::vector<std::shared_ptr<Voxel>>& aVoxels
+                  Receives the voxels
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelStreamer::GetVoxels(_Out_ std::vector<std::shared_ptr<Voxel>>& aVoxels) const
+    {
+        aVoxels.clear();
+        for (const auto& [ullKey, chunk] : m_residentChunks)
+        {
+            aVoxels.insert(aVoxels.end(), chunk->voxels.begin(), chunk->voxels.end());
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::GetDesc
+
+      Summary:  Returns the streaming parameters
+
+      Returns:  const VoxelStreamingDesc&
+                  Streaming parameters
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelStreamingDesc& VoxelStreamer::GetDesc() const
+    {
+        return m_desc;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::GetNumChunksX
+
+      Summary:  Returns the number of chunks along x
+
+      Returns:  UINT
+                  Number of chunks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelStreamer::GetNumChunksX() const
+    {
+        return m_uNumChunksX;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::GetNumChunksZ
+
+      Summary:  Returns the number of chunks along z
+
+      Returns:  UINT
+                  Number of chunks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelStreamer::GetNumChunksZ() const
+    {
+        return m_uNumChunksZ;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::GetStats
+
+      Summary:  Returns the resident chunks and the load latency as of
+                the last update
+
+      Returns:  const VoxelStreamingStats&
+                  Streaming statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelStreamingStats& VoxelStreamer::GetStats() const
+    {
+        return m_stats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::workerMain
+
+      Summary:  Builds the instances of the queued chunks until the
+                streamer is destroyed. The memory of a chunk counts its
+                instances twice, once on the CPU and once in the
+                instance buffer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelStreamer::workerMain()
+    {
+        for (;;)
+        {
+            std::unique_ptr<Chunk> chunk;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_bStopping || !m_requestQueue.empty(); });
+                if (m_bStopping)
+                {
+                    return;
+                }
+
+                chunk = std::move(m_requestQueue.front());
+                m_requestQueue.pop_front();
+            }
+
+            UINT uBeginX = chunk->uChunkX * m_desc.uChunkSize;
+            UINT uBeginZ = chunk->uChunkZ * m_desc.uChunkSize;
+            UINT64 ullNumInstances = 0ull;
+            if (m_desc.bPackedInstances)
+            {
+                chunk->aPackedInstanceData.resize(m_heightMap->GetPalette().size());
+                m_instanceBuilder.BuildRegion(uBeginX, uBeginX + m_desc.uChunkSize, uBeginZ, uBeginZ + m_desc.uChunkSize, chunk->aPackedInstanceData);
+                for (const std::vector<PackedInstanceData>& aInstances : chunk->aPackedInstanceData)
+                {
+                    ullNumInstances += aInstances.size();
+                }
+                chunk->ullBytes = ullNumInstances * sizeof(PackedInstanceData) * 2ull;
+            }
+            else
+            {
+                chunk->aInstanceData.resize(m_heightMap->GetPalette().size());
+                m_instanceBuilder.BuildRegion(uBeginX, uBeginX + m_desc.uChunkSize, uBeginZ, uBeginZ + m_desc.uChunkSize, chunk->aInstanceData);
+                for (const std::vector<InstanceData>& aInstances : chunk->aInstanceData)
+                {
+                    ullNumInstances += aInstances.size();
+                }
+                chunk->ullBytes = ullNumInstances * sizeof(InstanceData) * 2ull;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_completedChunks.push_back(std::move(chunk));
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::release
+
+      Summary:  Releases a resident chunk
+
+      Args:     UINT64 ullKey
+                  Key of the chunk
+
+      Modifies: [m_residentChunks, m_stats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelStreamer::release(_In_ UINT64 ullKey)
+    {
+        auto it = m_residentChunks.find(ullKey);
+        if (it == m_residentChunks.end())
+        {
+            return;
+        }
+
+        m_stats.ullResidentBytes -= it->second->ullBytes;
+        ++m_stats.ullNumReleasedChunks;
+        m_residentChunks.erase(it);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::getKey
+
+      Summary:  Returns the key of a chunk
+
+      Args:     UINT uChunkX
+                  Index of the chunk along x
+                UINT uChunkZ
+                  Index of the chunk along z
+
+      Returns:  UINT64
+                  Key of the chunk
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 VoxelStreamer::getKey(_In_ UINT uChunkX, _In_ UINT uChunkZ)
+    {
+        return (static_cast<UINT64>(uChunkZ) << 32ull) | static_cast<UINT64>(uChunkX);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelStreamer::getDistanceSquared
+
+      Summary:  Returns the squared distance in chunks between a chunk
+                and the chunk of the camera
+
+      Args:     UINT uChunkX
+                  Index of the chunk along x
+                UINT uChunkZ
+                  Index of the chunk along z
+                INT iCenterX
+                  Index of the chunk of the camera along x
+                INT iCenterZ
+                  Index of the chunk of the camera along z
+
+      Returns:  UINT64
+                  Squared distance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 VoxelStreamer::getDistanceSquared(_In_ UINT uChunkX, _In_ UINT uChunkZ, _In_ INT iCenterX, _In_ INT iCenterZ)
+    {
+        INT64 iDeltaX = static_cast<INT64>(uChunkX) - iCenterX;
+        INT64 iDeltaZ = static_cast<INT64>(uChunkZ) - iCenterZ;
+
+        return static_cast<UINT64>(iDeltaX * iDeltaX + iDeltaZ * iDeltaZ);
+    }
+}
\ No newline at end of file
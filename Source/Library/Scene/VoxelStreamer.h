@@ -0,0 +1,175 @@
+/*+===================================================================
+  File:      VOXELSTREAMER.H
+
+  Summary:   VoxelStreamer header file contains declarations of
+             VoxelStreamer class that keeps the chunks of the voxel
+             world around the camera resident, building them on
+             background threads.
+
+  Classes: VoxelStreamer
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/PackedVoxel.h"
+#include "Scene/Voxel.h"
+#include "Scene/VoxelInstanceBuilder.h"
+#include "Shader/PixelShader.h"
+#include "Shader/VertexShader.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelStreamingDesc
+
+        Summary:  Size of the chunks, radius of the ring of chunks kept
+                  around the camera, memory budget of the resident
+                  chunks, number of background builders, whether the
+                  instances are packed into 8 bytes and whether each
+                  vertical run of exposed voxels is a single instance.
+                  Zero workers picks one per spare hardware thread
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelStreamingDesc
+    {
+        UINT uChunkSize;
+        UINT uLoadRadius;
+        UINT64 ullMemoryBudgetBytes;
+        UINT uNumWorkers;
+        BOOL bPackedInstances;
+        BOOL bCollapseRuns;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+        Struct:   VoxelStreamingStats
+
+        Summary:  Resident and pending chunks, memory held by the
+                  resident chunks, and the latency from requesting a
+                  chunk to drawing it
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelStreamingStats
+    {
+        UINT uNumResidentChunks;
+        UINT uNumPendingChunks;
+        UINT64 ullResidentBytes;
+        UINT64 ullNumLoadedChunks;
+        UINT64 ullNumReleasedChunks;
+        FLOAT LastLoadMilliseconds;
+        FLOAT AverageLoadMilliseconds;
+        FLOAT MaxLoadMilliseconds;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelStreamer
+
+      Summary:  Streams square chunks of columns in a ring around the
+                camera. Missing chunks are queued nearest first and
+                their instances are built by worker threads; the
+                instance buffers are created on the rendering thread
+                when the chunk is picked up. Chunks leaving the ring
+                are released, and the farthest chunks are evicted while
+                the resident chunks exceed the memory budget
+
+      Methods:  Update
+                  Requests, uploads and releases chunks for a camera
+                GetVoxels
+                  Returns the voxels of the resident chunks
+                GetDesc
+                  Returns the streaming parameters
+                GetNumChunksX
+                  Returns the number of chunks along x
+                GetNumChunksZ
+                  Returns the number of chunks along z
+                GetStats
+                  Returns the streaming statistics
+                VoxelStreamer
+                  Constructor.
+                ~VoxelStreamer
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelStreamer
+    {
+    public:
+        static constexpr const UINT DEFAULT_CHUNK_SIZE = 32u;
+        static constexpr const UINT DEFAULT_LOAD_RADIUS = 8u;
+        static constexpr const UINT64 DEFAULT_MEMORY_BUDGET_BYTES = 256ull * 1024ull * 1024ull;
+
+        VoxelStreamer(_In_ const std::shared_ptr<HeightMap>& heightMap, _In_ const std::shared_ptr<OccupancyGrid>& occupancyGrid, _In_ const VoxelStreamingDesc& desc);
+        VoxelStreamer(const VoxelStreamer& other) = delete;
+        VoxelStreamer(VoxelStreamer&& other) = delete;
+        VoxelStreamer& operator=(const VoxelStreamer& other) = delete;
+        VoxelStreamer& operator=(VoxelStreamer&& other) = delete;
+        ~VoxelStreamer();
+
+        HRESULT Update(
+            _In_ const XMVECTOR& eye,
+            _In_ ID3D11Device* pDevice,
+            _In_ ID3D11DeviceContext* pImmediateContext,
+            _In_ const std::shared_ptr<VertexShader>& vertexShader,
+            _In_ const std::shared_ptr<PixelShader>& pixelShader
+        );
+
+        void GetVoxels(_Out_ std::vector<std::shared_ptr<Voxel>>& aVoxels) const;
+        const VoxelStreamingDesc& GetDesc() const;
+        UINT GetNumChunksX() const;
+        UINT GetNumChunksZ() const;
+        const VoxelStreamingStats& GetStats() const;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+            Struct:   Chunk
+
+            Summary:  Chunk travelling from the request queue through a
+                      worker to the resident set
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct Chunk
+        {
+            UINT uChunkX;
+            UINT uChunkZ;
+            LONGLONG llRequestTicks;
+            UINT64 ullBytes;
+            std::vector<std::vector<InstanceData>> aInstanceData;
+            std::vector<std::vector<PackedInstanceData>> aPackedInstanceData;
+            std::vector<std::shared_ptr<Voxel>> voxels;
+        };
+
+        void workerMain();
+        void release(_In_ UINT64 ullKey);
+
+        static UINT64 getKey(_In_ UINT uChunkX, _In_ UINT uChunkZ);
+        static UINT64 getDistanceSquared(_In_ UINT uChunkX, _In_ UINT uChunkZ, _In_ INT iCenterX, _In_ INT iCenterZ);
+
+    private:
+        std::shared_ptr<HeightMap> m_heightMap;
+        std::shared_ptr<OccupancyGrid> m_occupancyGrid;
+        VoxelInstanceBuilder m_instanceBuilder;
+        VoxelStreamingDesc m_desc;
+        UINT m_uNumChunksX;
+        UINT m_uNumChunksZ;
+        LARGE_INTEGER m_frequency;
+
+        std::unordered_map<UINT64, std::unique_ptr<Chunk>> m_residentChunks;
+        std::unordered_set<UINT64> m_requestedKeys;
+        UINT64 m_ullBudgetDistanceSquared;
+        DOUBLE m_totalLoadMilliseconds;
+        VoxelStreamingStats m_stats;
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<std::unique_ptr<Chunk>> m_requestQueue;
+        std::vector<std::unique_ptr<Chunk>> m_completedChunks;
+        BOOL m_bStopping;
+        std::vector<std::thread> m_aWorkers;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+/*+===================================================================
+  File:      HORIZONVOXELVERTEXSHADER.H
+
+  Summary:   HorizonVoxelVertexShader header file contains declarations
+             of HorizonVoxelVertexShader class, the vertex shader of the
+             voxels lit through the baked horizons of their instances.
+
+  Classes: HorizonVoxelVertexShader
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Shader/VertexShader.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    HorizonVoxelVertexShader
+
+      Summary:  Vertex shader whose input layout reads the horizons of
+                the instances from a fourth vertex buffer along with
+                their transformation matrices
+
+      Methods:  Initialize
+                  Initializes the vertex shader and the input layout
+                HorizonVoxelVertexShader
+                  Constructor.
+                ~HorizonVoxelVertexShader
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class HorizonVoxelVertexShader : public VertexShader
+    {
+    public:
+        HorizonVoxelVertexShader() = delete;
+        HorizonVoxelVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        HorizonVoxelVertexShader(const HorizonVoxelVertexShader& other) = delete;
+        HorizonVoxelVertexShader(HorizonVoxelVertexShader&& other) = delete;
+        HorizonVoxelVertexShader& operator=(const HorizonVoxelVertexShader& other) = delete;
+        HorizonVoxelVertexShader& operator=(HorizonVoxelVertexShader&& other) = delete;
+        virtual ~HorizonVoxelVertexShader() = default;
+
+        virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
+    };
+}
\ No newline at end of file
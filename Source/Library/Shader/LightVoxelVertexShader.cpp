@@ -0,0 +1,82 @@
+#include "Shader/LightVoxelVertexShader.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   LightVoxelVertexShader::LightVoxelVertexShader
+
+      Summary:  Constructor
+
+      Args:     PCWSTR pszFileName
+                  Name of the file that contains the shader code
+                PCSTR pszEntryPoint
+                  Name of the shader entry point function where shader
+                  execution begins
+                PCSTR pszShaderModel
+                  Specifies the shader target or set of shader features
+                  to compile against
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    LightVoxelVertexShader::LightVoxelVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel)
+        : VertexShader(pszFileName, pszEntryPoint, pszShaderModel)
+    { }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   LightVoxelVertexShader::Initialize
+
+      Summary:  Initializes the vertex shader and the input layout. The
+                instance slot holds the transformation matrices, and the
+                fifth slot one InstanceLightData per instance, read as
+                two vectors of four unsigned bytes. The fourth slot of
+                the horizons is left out
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the vertex shader
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT LightVoxelVertexShader::Initialize(_In_ ID3D11Device* pDevice)
+    {
+        ComPtr<ID3DBlob> pVSBlob = nullptr;
+        HRESULT hr = compile(pVSBlob.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        hr = pDevice->CreateVertexShader(
+            pVSBlob->GetBufferPointer(),
+            pVSBlob->GetBufferSize(),
+            nullptr,
+            m_vertexShader.GetAddressOf()
+        );
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        D3D11_INPUT_ELEMENT_DESC aLayouts[] =
+        {
+            { "POSITION", 0u, DXGI_FORMAT_R32G32B32_FLOAT, 0u, 0u, D3D11_INPUT_PER_VERTEX_DATA, 0u },
+            { "TEXCOORD", 0u, DXGI_FORMAT_R32G32_FLOAT, 0u, 12u, D3D11_INPUT_PER_VERTEX_DATA, 0u },
+            { "NORMAL", 0u, DXGI_FORMAT_R32G32B32_FLOAT, 0u, 20u, D3D11_INPUT_PER_VERTEX_DATA, 0u },
+            { "TANGENT", 0u, DXGI_FORMAT_R32G32B32_FLOAT, 1u, 0u, D3D11_INPUT_PER_INSTANCE_DATA, 0u },
+            { "BITANGENT", 0u, DXGI_FORMAT_R32G32B32_FLOAT, 1u, 12u, D3D11_INPUT_PER_INSTANCE_DATA, 0u },
+            { "INSTANCE_TRANSFORM", 0u, DXGI_FORMAT_R32G32B32A32_FLOAT, 2u, 0u, D3D11_INPUT_PER_INSTANCE_DATA, 1u },
+            { "INSTANCE_TRANSFORM", 1u, DXGI_FORMAT_R32G32B32A32_FLOAT, 2u, 16u, D3D11_INPUT_PER_INSTANCE_DATA, 1u },
+            { "INSTANCE_TRANSFORM", 2u, DXGI_FORMAT_R32G32B32A32_FLOAT, 2u, 32u, D3D11_INPUT_PER_INSTANCE_DATA, 1u },
+            { "INSTANCE_TRANSFORM", 3u, DXGI_FORMAT_R32G32B32A32_FLOAT, 2u, 48u, D3D11_INPUT_PER_INSTANCE_DATA, 1u },
+            { "INSTANCE_LIGHT", 0u, DXGI_FORMAT_R8G8B8A8_UINT, 4u, 0u, D3D11_INPUT_PER_INSTANCE_DATA, 1u },
+            { "INSTANCE_LIGHT", 1u, DXGI_FORMAT_R8G8B8A8_UINT, 4u, 4u, D3D11_INPUT_PER_INSTANCE_DATA, 1u }
+        };
+        UINT uNumElements = ARRAYSIZE(aLayouts);
+
+        return pDevice->CreateInputLayout(
+            aLayouts,
+            uNumElements,
+            pVSBlob->GetBufferPointer(),
+            pVSBlob->GetBufferSize(),
+            m_vertexLayout.GetAddressOf()
+        );
+    }
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*+===================================================================
+  File:      LIGHTVOXELVERTEXSHADER.H
+
+  Summary:   LightVoxelVertexShader header file contains declarations
+             of LightVoxelVertexShader class, the vertex shader of the
+             voxels lit by the light flooded through the cells of the
+             voxel grid.
+
+  Classes: LightVoxelVertexShader
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Shader/VertexShader.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    LightVoxelVertexShader
+
+      Summary:  Vertex shader whose input layout reads the light of the
+                faces of the instances from a fifth vertex buffer along
+                with their transformation matrices
+
+      Methods:  Initialize
+                  Initializes the vertex shader and the input layout
+                LightVoxelVertexShader
+                  Constructor.
+                ~LightVoxelVertexShader
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class LightVoxelVertexShader : public VertexShader
+    {
+    public:
+        LightVoxelVertexShader() = delete;
+        LightVoxelVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        LightVoxelVertexShader(const LightVoxelVertexShader& other) = delete;
+        LightVoxelVertexShader(LightVoxelVertexShader&& other) = delete;
+        LightVoxelVertexShader& operator=(const LightVoxelVertexShader& other) = delete;
+        LightVoxelVertexShader& operator=(LightVoxelVertexShader&& other) = delete;
+        virtual ~LightVoxelVertexShader() = default;
+
+        virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
+    };
+}
\ No newline at end of file
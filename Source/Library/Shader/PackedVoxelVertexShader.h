@@ -0,0 +1,46 @@
+/*+===================================================================
+  File:      PACKEDVOXELVERTEXSHADER.H
+
+  Summary:   PackedVoxelVertexShader header file contains declarations
+             of PackedVoxelVertexShader class, the vertex shader of the
+             voxels with packed instances.
+
+  Classes: PackedVoxelVertexShader
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Shader/VertexShader.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    PackedVoxelVertexShader
+
+      Summary:  Vertex shader whose input layout reads the instances as
+                PackedInstanceData instead of transformation matrices
+
+      Methods:  Initialize
+                  Initializes the vertex shader and the input layout
+                PackedVoxelVertexShader
+                  Constructor.
+                ~PackedVoxelVertexShader
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class PackedVoxelVertexShader : public VertexShader
+    {
+    public:
+        PackedVoxelVertexShader() = delete;
+        PackedVoxelVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        PackedVoxelVertexShader(const PackedVoxelVertexShader& other) = delete;
+        PackedVoxelVertexShader(PackedVoxelVertexShader&& other) = delete;
+        PackedVoxelVertexShader& operator=(const PackedVoxelVertexShader& other) = delete;
+        PackedVoxelVertexShader& operator=(PackedVoxelVertexShader&& other) = delete;
+        virtual ~PackedVoxelVertexShader() = default;
+
+        virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
+    };
+}
\ No newline at end of file
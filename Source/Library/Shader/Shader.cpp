@@ -16,12 +16,14 @@ namespace library
                   Specifies the shader target or set of shader features
                   to compile against
 
-      Modifies: [m_pszFileName, m_pszEntryPoint, m_pszShaderModel].
+      Modifies: [m_pszFileName, m_pszEntryPoint, m_pszShaderModel,
+                 m_compiledBlob].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Shader::Shader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel)
         : m_pszFileName(pszFileName),
         m_pszEntryPoint(pszEntryPoint),
-        m_pszShaderModel(pszShaderModel)
+        m_pszShaderModel(pszShaderModel),
+        m_compiledBlob(nullptr)
     { }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -37,6 +39,33 @@ namespace library
         return m_pszFileName;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Shader::Compile
+
+      Summary:  Compiles the shader file and keeps the byte code for
+                Initialize, so that the compilation can run on a worker
+                thread and only the creation of the shader object is
+                left to the thread owning the device
+
+      Modifies: [m_compiledBlob].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Shader::Compile()
+    {
+        ComPtr<ID3DBlob> compiledBlob = nullptr;
+        HRESULT hr = compile(compiledBlob.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        m_compiledBlob = compiledBlob;
+
+        return S_OK;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Shader::compile
 
@@ -53,6 +82,12 @@ namespace library
     {
         HRESULT hr = S_OK;
 
+        // Byte code compiled ahead by Compile is handed out as is
+        if (m_compiledBlob)
+        {
+            return m_compiledBlob.CopyTo(ppOutBlob);
+        }
+
         //Compile the shader
         DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
 #if defined(DEBUG) || defined(_DEBUG)
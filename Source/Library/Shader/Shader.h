@@ -24,6 +24,8 @@ namespace library
                   Pure virtual function that initializes the shader
                 GetFileName
                   Returns the name of the shader file to be compiled
+                Compile
+                  Compiles the shader ahead of Initialize
                 compile
                   Compiles the given shader file
                 Game
@@ -44,6 +46,7 @@ namespace library
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) = 0;
         PCWSTR GetFileName() const;
+        HRESULT Compile();
 
     protected:
         HRESULT compile(_Outptr_ ID3DBlob** ppOutBlob);
@@ -51,5 +54,6 @@ namespace library
         PCWSTR m_pszFileName;
         PCSTR m_pszEntryPoint;
         PCSTR m_pszShaderModel;
+        ComPtr<ID3DBlob> m_compiledBlob;
     };
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Texture.h"
 
+#include <fstream>
+
 #include "Texture/DDSTextureLoader.h"
 #include "Texture/WICTextureLoader.h"
 
@@ -17,35 +19,95 @@ namespace library
                 eTextureSamplerType textureSamplerType
                   Texture sampler type of this texture
 
-      Modifies: [m_filePath, m_textureRV, m_textureSamplerType].
+      Modifies: [m_filePath, m_textureRV, m_textureSamplerType,
+                 m_image, m_aFileData].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Texture::Texture(_In_ const std::filesystem::path& filePath, _In_opt_ eTextureSamplerType textureSamplerType)
         : m_filePath(filePath),
         m_textureRV(nullptr),
-        m_textureSamplerType(textureSamplerType)
+        m_textureSamplerType(textureSamplerType),
+        m_image(),
+        m_aFileData()
     { }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::Load
+
+      Summary:  Decodes the texture file without the device, so that
+                Initialize only creates the resource. Images WIC cannot
+                decode are read as they are and parsed as DDS by
+                Initialize. Needs COM initialized on the calling thread
+
+      Modifies: [m_image, m_aFileData].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Texture::Load()
+    {
+        HRESULT hr = DecodeWICImageFromFile(m_filePath.c_str(), m_image);
+        if (SUCCEEDED(hr))
+        {
+            return hr;
+        }
+        m_image = WICImage();
+
+        std::ifstream inputFile(m_filePath, std::ios::binary | std::ios::ate);
+        if (!inputFile.is_open())
+        {
+            OutputDebugString(L"Can't load texture from \"");
+            OutputDebugString(m_filePath.c_str());
+            OutputDebugString(L"\n");
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+        }
+
+        m_aFileData.resize(static_cast<size_t>(inputFile.tellg()));
+        inputFile.seekg(0);
+        inputFile.read(reinterpret_cast<CHAR*>(m_aFileData.data()), static_cast<std::streamsize>(m_aFileData.size()));
+
+        return S_OK;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Texture::Initialize
 
-      Summary:  Initializes the texture and samplers if not initialized
+      Summary:  Initializes the texture and samplers if not initialized.
+                A texture loaded beforehand is created from the decoded
+                image, otherwise the file is read here
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
                 ID3D11DeviceContext* pImmediateContext
                   The Direct3D context to set buffers
 
-      Modifies: [m_textureRV].
+      Modifies: [m_textureRV, m_image, m_aFileData].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Texture::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
 		{
-        HRESULT hr = CreateWICTextureFromFile(
-            pDevice,
-            pImmediateContext,
-            m_filePath.c_str(),
-            nullptr,
-            m_textureRV.GetAddressOf()
-        );
+        HRESULT hr = E_FAIL;
+        if (!m_image.pixels.empty())
+        {
+            hr = CreateWICTextureFromImage(pDevice, pImmediateContext, m_image, nullptr, m_textureRV.GetAddressOf());
+        }
+        else if (!m_aFileData.empty())
+        {
+            hr = CreateDDSTextureFromMemory(pDevice, m_aFileData.data(), m_aFileData.size(), nullptr, m_textureRV.GetAddressOf());
+        }
+        m_image = WICImage();
+        m_aFileData = std::vector<uint8_t>();
+
+        // Also taken when the device does not support the format the
+        // image was decoded to
+        if (FAILED(hr))
+        {
+            hr = CreateWICTextureFromFile(
+                pDevice,
+                pImmediateContext,
+                m_filePath.c_str(),
+                nullptr,
+                m_textureRV.GetAddressOf()
+            );
+        }
         if (FAILED(hr))
         {
             hr = CreateDDSTextureFromFile(pDevice, m_filePath.c_str(), nullptr, m_textureRV.GetAddressOf());
@@ -126,4 +188,17 @@ namespace library
 		{
 			return m_textureSamplerType;
 		}
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::GetFilePath
+
+      Summary:  Returns the path of the texture file
+
+      Returns:  const std::filesystem::path&
+                  Path of the texture file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::filesystem::path& Texture::GetFilePath() const
+    {
+        return m_filePath;
+    }
 }
\ No newline at end of file
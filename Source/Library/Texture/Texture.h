@@ -12,6 +12,8 @@
 
 #include "Common.h"
 
+#include "Texture/WICTextureLoader.h"
+
 namespace library
 {
     enum class eTextureSamplerType : size_t
@@ -32,11 +34,14 @@ namespace library
         Texture& operator=(Texture&& other) = delete;
         virtual ~Texture() = default;
 
+        // May be called beforehand on any thread to read the file
+        HRESULT Load();
         // Should be called once to load the texture
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
 
         ComPtr<ID3D11ShaderResourceView>& GetTextureResourceView();
         eTextureSamplerType GetSamplerType() const;
+        const std::filesystem::path& GetFilePath() const;
 
     public:
         static ComPtr<ID3D11SamplerState> s_samplers[static_cast<size_t>(eTextureSamplerType::COUNT)];
@@ -45,5 +50,7 @@ namespace library
         std::filesystem::path m_filePath;
         ComPtr<ID3D11ShaderResourceView> m_textureRV;
         eTextureSamplerType m_textureSamplerType;
+        WICImage m_image;
+        std::vector<uint8_t> m_aFileData;
     };
 }
\ No newline at end of file
@@ -236,9 +236,8 @@ static DXGI_FORMAT _WICToDXGI(const GUID& guid)
 }
 
 //---------------------------------------------------------------------------------
-static size_t _WICBitsPerPixel(REFGUID targetGuid)
+static size_t _WICBitsPerPixel(_In_opt_ IWICImagingFactory* pWIC, REFGUID targetGuid)
 {
-    IWICImagingFactory* pWIC = _GetWIC();
     if (!pWIC)
         return 0;
 
@@ -265,11 +264,10 @@ static size_t _WICBitsPerPixel(REFGUID targetGuid)
 }
 
 //---------------------------------------------------------------------------------
-static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
-    _In_opt_ ID3D11DeviceContext* d3dContext,
+static HRESULT DecodeWICFrame(_In_opt_ IWICImagingFactory* pWIC,
+    _In_opt_ ID3D11Device* d3dDevice,
     _In_ IWICBitmapFrameDecode* frame,
-    _Out_opt_ ID3D11Resource** texture,
-    _Out_opt_ ID3D11ShaderResourceView** textureView,
+    _Out_ WICImage& image,
     _In_ size_t maxsize)
 {
     UINT width, height;
@@ -279,7 +277,13 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
 
     assert(width > 0 && height > 0);
 
-    if (!maxsize)
+    if (!maxsize && !d3dDevice)
+    {
+        // Without a device the image is decoded for the feature level
+        // the renderer requires
+        maxsize = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+    }
+    else if (!maxsize)
     {
         // This is a bit conservative because the hardware could support larger textures than
         // the Feature Level defined minimums, but doing it this way is much easier and more
@@ -353,7 +357,7 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
 
                 format = _WICToDXGI(g_WICConvert[i].target);
                 assert(format != DXGI_FORMAT_UNKNOWN);
-                bpp = _WICBitsPerPixel(convertGUID);
+                bpp = _WICBitsPerPixel(pWIC, convertGUID);
                 break;
             }
         }
@@ -363,7 +367,7 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
     }
     else
     {
-        bpp = _WICBitsPerPixel(pixelFormat);
+        bpp = _WICBitsPerPixel(pWIC, pixelFormat);
     }
 
     if (!bpp)
@@ -371,9 +375,13 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
 
     // Verify our target format is supported by the current device
     // (handles WDDM 1.0 or WDDM 1.1 device driver cases as well as DirectX 11.0 Runtime without 16bpp format support)
+    // Without a device the check is left to CreateWICTextureFromImage
     UINT support = 0;
-    hr = d3dDevice->CheckFormatSupport(format, &support);
-    if (FAILED(hr) || !(support & D3D11_FORMAT_SUPPORT_TEXTURE2D))
+    if (d3dDevice)
+    {
+        hr = d3dDevice->CheckFormatSupport(format, &support);
+    }
+    if (d3dDevice && (FAILED(hr) || !(support & D3D11_FORMAT_SUPPORT_TEXTURE2D)))
     {
         // Fallback to RGBA 32-bit format which is supported by all devices
         memcpy(&convertGUID, &GUID_WICPixelFormat32bppRGBA, sizeof(WICPixelFormatGUID));
@@ -385,7 +393,8 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
     size_t rowPitch = (twidth * bpp + 7) / 8;
     size_t imageSize = rowPitch * theight;
 
-    std::unique_ptr<uint8_t[]> temp(new uint8_t[imageSize]);
+    image.pixels.resize(imageSize);
+    uint8_t* temp = image.pixels.data();
 
     // Load image data
     if (memcmp(&convertGUID, &pixelFormat, sizeof(GUID)) == 0
@@ -393,14 +402,13 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
         && theight == height)
     {
         // No format conversion or resize needed
-        hr = frame->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp.get());
+        hr = frame->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp);
         if (FAILED(hr))
             return hr;
     }
     else if (twidth != width || theight != height)
     {
         // Resize
-        IWICImagingFactory* pWIC = _GetWIC();
         if (!pWIC)
             return E_NOINTERFACE;
 
@@ -421,7 +429,7 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
         if (memcmp(&convertGUID, &pfScaler, sizeof(GUID)) == 0)
         {
             // No format conversion needed
-            hr = scaler->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp.get());
+            hr = scaler->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp);
             if (FAILED(hr))
                 return hr;
         }
@@ -436,7 +444,7 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
             if (FAILED(hr))
                 return hr;
 
-            hr = FC->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp.get());
+            hr = FC->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp);
             if (FAILED(hr))
                 return hr;
         }
@@ -444,7 +452,6 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
     else
     {
         // Format conversion but no resize
-        IWICImagingFactory* pWIC = _GetWIC();
         if (!pWIC)
             return E_NOINTERFACE;
 
@@ -457,11 +464,44 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
         if (FAILED(hr))
             return hr;
 
-        hr = FC->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp.get());
+        hr = FC->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp);
         if (FAILED(hr))
             return hr;
     }
 
+    image.width = twidth;
+    image.height = theight;
+    image.format = format;
+    image.rowPitch = rowPitch;
+
+    return S_OK;
+}
+
+//---------------------------------------------------------------------------------
+HRESULT CreateWICTextureFromImage(_In_ ID3D11Device* d3dDevice,
+    _In_opt_ ID3D11DeviceContext* d3dContext,
+    _In_ const WICImage& image,
+    _Out_opt_ ID3D11Resource** texture,
+    _Out_opt_ ID3D11ShaderResourceView** textureView)
+{
+    if (!d3dDevice || image.pixels.empty() || (!texture && !textureView))
+    {
+        return E_INVALIDARG;
+    }
+
+    UINT twidth = image.width;
+    UINT theight = image.height;
+    DXGI_FORMAT format = image.format;
+    size_t rowPitch = image.rowPitch;
+    size_t imageSize = image.pixels.size();
+    const uint8_t* temp = image.pixels.data();
+
+    // An image decoded without a device may not suit this one
+    UINT support = 0;
+    HRESULT hr = d3dDevice->CheckFormatSupport(format, &support);
+    if (FAILED(hr) || !(support & D3D11_FORMAT_SUPPORT_TEXTURE2D))
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
     // See if format is supported for auto-gen mipmaps (varies by feature level)
     bool autogen = false;
     if (d3dContext != 0 && textureView != 0) // Must have context and shader-view to auto generate mipmaps
@@ -489,7 +529,7 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
     desc.MiscFlags = (autogen) ? D3D11_RESOURCE_MISC_GENERATE_MIPS : 0;
 
     D3D11_SUBRESOURCE_DATA initData;
-    initData.pSysMem = temp.get();
+    initData.pSysMem = temp;
     initData.SysMemPitch = static_cast<UINT>(rowPitch);
     initData.SysMemSlicePitch = static_cast<UINT>(imageSize);
 
@@ -515,7 +555,7 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
             if (autogen)
             {
                 assert(d3dContext != 0);
-                d3dContext->UpdateSubresource(tex, 0, nullptr, temp.get(), static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize));
+                d3dContext->UpdateSubresource(tex, 0, nullptr, temp, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize));
                 d3dContext->GenerateMips(*textureView);
             }
         }
@@ -539,6 +579,22 @@ static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
     return hr;
 }
 
+//---------------------------------------------------------------------------------
+static HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
+    _In_opt_ ID3D11DeviceContext* d3dContext,
+    _In_ IWICBitmapFrameDecode* frame,
+    _Out_opt_ ID3D11Resource** texture,
+    _Out_opt_ ID3D11ShaderResourceView** textureView,
+    _In_ size_t maxsize)
+{
+    WICImage image;
+    HRESULT hr = DecodeWICFrame(_GetWIC(), d3dDevice, frame, image, maxsize);
+    if (FAILED(hr))
+        return hr;
+
+    return CreateWICTextureFromImage(d3dDevice, d3dContext, image, texture, textureView);
+}
+
 //--------------------------------------------------------------------------------------
 HRESULT CreateWICTextureFromMemory(_In_ ID3D11Device* d3dDevice,
     _In_opt_ ID3D11DeviceContext* d3dContext,
@@ -688,4 +744,41 @@ HRESULT CreateWICTextureFromFile(_In_ ID3D11Device* d3dDevice,
 #endif
 
     return hr;
+}
+
+//--------------------------------------------------------------------------------------
+HRESULT DecodeWICImageFromFile(_In_z_ const wchar_t* fileName,
+    _Out_ WICImage& image,
+    _In_ size_t maxsize)
+{
+    if (!fileName)
+    {
+        return E_INVALIDARG;
+    }
+
+    // A factory of its own, the shared one belongs to the apartment of
+    // the thread that created it
+    ScopedObject<IWICImagingFactory> factory;
+    HRESULT hr = CoCreateInstance(
+        CLSID_WICImagingFactory,
+        nullptr,
+        CLSCTX_INPROC_SERVER,
+        __uuidof(IWICImagingFactory),
+        (LPVOID*)&factory
+    );
+    if (FAILED(hr))
+        return hr;
+
+    // Initialize WIC
+    ScopedObject<IWICBitmapDecoder> decoder;
+    hr = factory->CreateDecoderFromFilename(fileName, 0, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder);
+    if (FAILED(hr))
+        return hr;
+
+    ScopedObject<IWICBitmapFrameDecode> frame;
+    hr = decoder->GetFrame(0, &frame);
+    if (FAILED(hr))
+        return hr;
+
+    return DecodeWICFrame(factory.Get(), nullptr, frame.Get(), image, maxsize);
 }
\ No newline at end of file
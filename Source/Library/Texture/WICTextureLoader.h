@@ -36,6 +36,16 @@
 #include <stdint.h>
 #pragma warning(pop)
 
+// Image decoded without a device, uploaded later by CreateWICTextureFromImage
+struct WICImage
+{
+    UINT width;
+    UINT height;
+    DXGI_FORMAT format;
+    size_t rowPitch;
+    std::vector<uint8_t> pixels;
+};
+
 HRESULT CreateWICTextureFromMemory(
     _In_ ID3D11Device* d3dDevice,
     _In_opt_ ID3D11DeviceContext* d3dContext,
@@ -53,4 +63,19 @@ HRESULT CreateWICTextureFromFile(
     _Out_opt_ ID3D11Resource** texture,
     _Out_opt_ ID3D11ShaderResourceView** textureView,
     _In_ size_t maxsize = 0
+    );
+
+// Needs no device, COM must be initialized on the calling thread
+HRESULT DecodeWICImageFromFile(
+    _In_z_ const wchar_t* szFileName,
+    _Out_ WICImage& image,
+    _In_ size_t maxsize = 0
+    );
+
+HRESULT CreateWICTextureFromImage(
+    _In_ ID3D11Device* d3dDevice,
+    _In_opt_ ID3D11DeviceContext* d3dContext,
+    _In_ const WICImage& image,
+    _Out_opt_ ID3D11Resource** texture,
+    _Out_opt_ ID3D11ShaderResourceView** textureView
     );
\ No newline at end of file
@@ -0,0 +1,311 @@
+/*+===================================================================
+  File:      MAIN.CPP
+
+  Summary:   Console program that checks the parts of the library that
+             hold no device state: the merging of dirty ranges, the
+             sweeps of the voxel collider and the layers of the
+             animation player. Every failed check is reported and the
+             program exits with a nonzero status code.
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+
+#include "Common.h"
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+#include "Model/AnimationPlayer.h"
+#include "Renderer/DirtyRanges.h"
+#include "Scene/HeightMap.h"
+#include "Scene/OccupancyGrid.h"
+#include "Scene/VoxelCollider.h"
+
+namespace
+{
+    UINT s_uNumFailures = 0u;
+
+    /*F+F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F
+      Function: Expect
+
+      Summary:  Reports a check that failed
+
+      Args:     BOOL bCondition
+                  Outcome of the check
+                PCWSTR pszTest
+                  Name of the part of the library being checked
+                PCWSTR pszCheck
+                  Description of the check
+    F---F---F---F---F---F---F---F---F---F---F---F---F---F---F---F---F-F*/
+    void Expect(_In_ BOOL bCondition, _In_ PCWSTR pszTest, _In_ PCWSTR pszCheck)
+    {
+        if (!bCondition)
+        {
+            WCHAR szReport[256];
+            swprintf_s(szReport, L"%s: %s failed\n", pszTest, pszCheck);
+            OutputDebugString(szReport);
+            fwprintf(stderr, L"%s", szReport);
+            ++s_uNumFailures;
+        }
+    }
+
+    /*F+F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F
+      Function: TestDirtyRanges
+
+      Summary:  Checks that ranges marked out of order stay sorted,
+                that overlapping, adjacent and contained ranges merge,
+                that empty ranges are ignored, that one range past
+                MAX_RANGES collapses them into the span of all, and
+                that Clip cuts them
+    F---F---F---F---F---F---F---F---F---F---F---F---F---F---F---F---F-F*/
+    void TestDirtyRanges()
+    {
+        using library::DirtyRange;
+        using library::DirtyRanges;
+
+        constexpr const PCWSTR TEST = L"DirtyRanges";
+        constexpr const UINT MAX_RANGES = static_cast<UINT>(DirtyRanges::MAX_RANGES);
+
+        auto isRange = [](const DirtyRange& range, UINT uBegin, UINT uEnd)
+        {
+            return range.uBegin == uBegin && range.uEnd == uEnd;
+        };
+
+        DirtyRanges ranges;
+        ranges.Mark(100u, 110u);
+        ranges.Mark(0u, 10u);
+        ranges.Mark(50u, 60u);
+        Expect(ranges.GetRanges().size() == 3u && isRange(ranges.GetRanges()[0], 0u, 10u) && isRange(ranges.GetRanges()[1], 50u, 60u) && isRange(ranges.GetRanges()[2], 100u, 110u), TEST, L"sorted disjoint ranges");
+
+        ranges.Mark(10u, 50u);
+        Expect(ranges.GetRanges().size() == 2u && isRange(ranges.GetRanges()[0], 0u, 60u), TEST, L"merge of adjacent ranges");
+
+        ranges.Mark(55u, 105u);
+        Expect(ranges.GetRanges().size() == 1u && isRange(ranges.GetRanges()[0], 0u, 110u), TEST, L"merge of overlapping ranges");
+
+        ranges.Mark(20u, 30u);
+        ranges.Mark(70u, 70u);
+        Expect(ranges.GetRanges().size() == 1u && ranges.GetNumDirty() == 110u, TEST, L"contained and empty ranges");
+
+        ranges.Clear();
+        for (UINT i = 0u; i < MAX_RANGES; ++i)
+        {
+            ranges.Mark(i * 4u + 1u, i * 4u + 3u);
+        }
+        Expect(ranges.GetRanges().size() == MAX_RANGES && ranges.GetNumDirty() == MAX_RANGES * 2u, TEST, L"MAX_RANGES disjoint ranges");
+
+        ranges.Mark(MAX_RANGES * 4u + 1u, MAX_RANGES * 4u + 3u);
+        Expect(ranges.GetRanges().size() == 1u && isRange(ranges.GetRanges()[0], 1u, MAX_RANGES * 4u + 3u), TEST, L"collapse past MAX_RANGES");
+
+        ranges.Mark(0u, 1u);
+        Expect(ranges.GetRanges().size() == 1u && isRange(ranges.GetRanges()[0], 0u, MAX_RANGES * 4u + 3u), TEST, L"merge into the collapsed range");
+
+        ranges.Clip(10u);
+        Expect(ranges.GetRanges().size() == 1u && isRange(ranges.GetRanges()[0], 0u, 10u), TEST, L"clip of a range");
+
+        ranges.Clip(0u);
+        Expect(ranges.IsEmpty(), TEST, L"clip of every range");
+    }
+
+    /*F+F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F
+      Function: TestVoxelCollider
+
+      Summary:  Sweeps boxes through a small grid with a solid floor
+                and one solid cell above it. The sweeps check that a
+                box moving within one cell tests only that cell and
+                moves freely, that a box stops SKIN short of the floor,
+                that a box leaves a cell it overlaps, and that a box
+                hitting the corner of the cell exactly takes the lower
+                axis and slides along the other. A box grazing the
+                corner or touching the cell along an axis it does not
+                move on passes. The sweeps are given in cells and moved
+                into world space, where the empty height map puts the
+                lower corner of the grid at -1 and a cell spans two
+                units
+    F---F---F---F---F---F---F---F---F---F---F---F---F---F---F---F---F-F*/
+    void TestVoxelCollider()
+    {
+        using library::HeightMap;
+        using library::OccupancyGrid;
+        using library::VoxelCollider;
+        using library::VoxelCollision;
+
+        constexpr const PCWSTR TEST = L"VoxelCollider";
+        constexpr const UINT GRID_SIZE = 8u;
+        constexpr const FLOAT TOLERANCE = 1.0e-4f;
+        constexpr const FLOAT SKIN = VoxelCollider::SKIN;
+
+        std::shared_ptr<OccupancyGrid> occupancyGrid = std::make_shared<OccupancyGrid>(GRID_SIZE, GRID_SIZE, GRID_SIZE);
+        for (UINT z = 0u; z < GRID_SIZE; ++z)
+        {
+            for (UINT x = 0u; x < GRID_SIZE; ++x)
+            {
+                occupancyGrid->SetOccupied(x, 0u, z, TRUE);
+            }
+        }
+        occupancyGrid->SetOccupied(4u, 1u, 4u, TRUE);
+        VoxelCollider collider(std::make_shared<HeightMap>(), occupancyGrid);
+
+        auto isNear = [](const XMFLOAT3& a, FLOAT x, FLOAT y, FLOAT z)
+        {
+            return fabsf(a.x - x) < TOLERANCE && fabsf(a.y - y) < TOLERANCE && fabsf(a.z - z) < TOLERANCE;
+        };
+        auto sweep = [&collider](const XMFLOAT3& center, FLOAT halfExtent, const XMFLOAT3& displacement, VoxelCollision& collision, UINT& uNumCells)
+        {
+            collider.MoveBox(
+                XMFLOAT3(center.x * 2.0f - 1.0f, center.y * 2.0f - 1.0f, center.z * 2.0f - 1.0f),
+                XMFLOAT3(halfExtent * 2.0f, halfExtent * 2.0f, halfExtent * 2.0f),
+                XMFLOAT3(displacement.x * 2.0f, displacement.y * 2.0f, displacement.z * 2.0f),
+                collision,
+                &uNumCells
+            );
+            collision.Position = XMFLOAT3(
+                (collision.Position.x + 1.0f) * 0.5f,
+                (collision.Position.y + 1.0f) * 0.5f,
+                (collision.Position.z + 1.0f) * 0.5f
+            );
+        };
+
+        VoxelCollision collision;
+        UINT uNumCells = 0u;
+        sweep(XMFLOAT3(2.5f, 1.5f, 2.5f), 0.2f, XMFLOAT3(0.1f, -0.1f, 0.1f), collision, uNumCells);
+        Expect(!collision.bCollided && uNumCells == 1u && isNear(collision.Position, 2.6f, 1.4f, 2.6f), TEST, L"sweep within one cell");
+
+        sweep(XMFLOAT3(2.5f, 1.3f, 2.5f), 0.2f, XMFLOAT3(0.0f, -0.5f, 0.0f), collision, uNumCells);
+        Expect(collision.bCollided && collision.uNumContacts == 1u && collision.Normal.y == 1.0f && isNear(collision.Position, 2.5f, 1.2f + SKIN, 2.5f), TEST, L"sweep within one cell onto the floor");
+
+        sweep(XMFLOAT3(4.5f, 1.5f, 4.5f), 0.2f, XMFLOAT3(1.0f, 0.0f, 0.0f), collision, uNumCells);
+        Expect(!collision.bCollided && isNear(collision.Position, 5.5f, 1.5f, 4.5f), TEST, L"sweep out of an overlapped cell");
+
+        sweep(XMFLOAT3(3.5f, 1.5f, 3.5f), 0.25f, XMFLOAT3(1.0f, 0.0f, 1.0f), collision, uNumCells);
+        Expect(collision.bCollided && collision.uNumContacts == 1u && collision.Normal.x == -1.0f && isNear(collision.Position, 3.75f - SKIN, 1.5f, 4.5f), TEST, L"sweep into a corner");
+
+        sweep(XMFLOAT3(3.5f, 1.5f, 2.5f), 0.25f, XMFLOAT3(1.0f, 0.0f, 1.0f), collision, uNumCells);
+        Expect(!collision.bCollided && isNear(collision.Position, 4.5f, 1.5f, 3.5f), TEST, L"sweep past a corner");
+
+        sweep(XMFLOAT3(3.5f, 1.5f, 3.75f), 0.25f, XMFLOAT3(1.0f, 0.0f, 0.0f), collision, uNumCells);
+        Expect(!collision.bCollided && isNear(collision.Position, 4.5f, 1.5f, 3.75f), TEST, L"sweep along a face");
+    }
+
+    /*F+F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F+++F
+      Function: TestAnimationPlayer
+
+      Summary:  Plays clips of one block that hold the translation of
+                every node along x: 1 and 3 for two override clips, 0
+                to 2 for an additive one. It checks that override and
+                additive layers of weight 0 leave the pose as it was,
+                that a player with only a layer of weight 0 gives the
+                bind pose, that a cross-fade is halfway after half its
+                length, and that once complete the old layer is removed
+                and the new one plays alone at full weight, also when
+                one update oversteps the fade
+    F---F---F---F---F---F---F---F---F---F---F---F---F---F---F---F---F-F*/
+    void TestAnimationPlayer()
+    {
+        using library::AnimationPlayer;
+        using library::eAnimationBlendMode;
+        using library::ModelAnimation;
+        using library::ModelAnimationStream;
+
+        constexpr const PCWSTR TEST = L"AnimationPlayer";
+        constexpr const UINT P = ModelAnimationStream::POSITION;
+        constexpr const UINT R = ModelAnimationStream::ROTATION;
+        constexpr const UINT S = ModelAnimationStream::SCALING;
+        constexpr const UINT NUM_COMPONENTS = ModelAnimationStream::NUM_COMPONENTS;
+        constexpr const FLOAT TOLERANCE = 1.0e-5f;
+
+        std::vector<XMVECTOR> aBindPoses(NUM_COMPONENTS, XMVectorZero());
+        aBindPoses[R + 3u] = XMVectorSplatOne();
+        for (UINT i = 0u; i < 3u; ++i)
+        {
+            aBindPoses[S + i] = XMVectorSplatOne();
+        }
+
+        // Two keys ten ticks apart at one tick per second, the bind
+        // pose moved along x
+        auto makeClip = [&aBindPoses](FLOAT startX, FLOAT endX)
+        {
+            ModelAnimation animation = {};
+            animation.Duration = 10.0f;
+            animation.TicksPerSecond = 1.0f;
+            animation.Stream.aTimes = { 0.0f, 10.0f };
+            animation.Stream.uNumBlocks = 1u;
+            for (FLOAT x : { startX, endX })
+            {
+                animation.Stream.aKeys.insert(animation.Stream.aKeys.end(), aBindPoses.begin(), aBindPoses.end());
+                animation.Stream.aKeys[animation.Stream.aKeys.size() - NUM_COMPONENTS + P] = XMVectorReplicate(x);
+            }
+            return animation;
+        };
+        const std::vector<ModelAnimation> aAnimations = { makeClip(1.0f, 1.0f), makeClip(3.0f, 3.0f), makeClip(0.0f, 2.0f) };
+
+        auto isPose = [](const std::vector<XMVECTOR>& aPoses, FLOAT x)
+        {
+            return aPoses.size() == NUM_COMPONENTS &&
+                XMVector4NearEqual(aPoses[P], XMVectorReplicate(x), XMVectorReplicate(TOLERANCE)) &&
+                XMVector4NearEqual(aPoses[R + 3u], XMVectorSplatOne(), XMVectorReplicate(TOLERANCE)) &&
+                XMVector4NearEqual(aPoses[S], XMVectorSplatOne(), XMVectorReplicate(TOLERANCE));
+        };
+
+        std::vector<XMVECTOR> aPoses;
+        {
+            AnimationPlayer player(aAnimations);
+            player.SetBindPose(aBindPoses);
+            player.AddLayer(1u, eAnimationBlendMode::OVERRIDE, 0.0f, 0.0f, TRUE, nullptr);
+            player.Update(1.0f);
+            player.Evaluate(aPoses);
+            Expect(isPose(aPoses, 0.0f), TEST, L"bind pose under a layer of weight 0");
+
+            player.Play(0u, 0.0f, TRUE);
+            player.AddLayer(1u, eAnimationBlendMode::OVERRIDE, 0.0f, 0.0f, TRUE, nullptr);
+            player.Evaluate(aPoses);
+            Expect(player.GetLayers().size() == 2u && isPose(aPoses, 1.0f), TEST, L"override layer of weight 0");
+
+            UINT uAdditiveId = 0u;
+            player.AddLayer(2u, eAnimationBlendMode::ADDITIVE, 0.0f, 0.0f, TRUE, &uAdditiveId);
+            player.Update(5.0f);
+            player.Evaluate(aPoses);
+            Expect(isPose(aPoses, 1.0f), TEST, L"additive layer of weight 0");
+
+            player.SetLayerWeight(uAdditiveId, 1.0f, 0.0f);
+            player.Evaluate(aPoses);
+            Expect(isPose(aPoses, 2.0f), TEST, L"additive layer of weight 1");
+        }
+        {
+            AnimationPlayer player(aAnimations);
+            player.SetBindPose(aBindPoses);
+            player.Play(0u, 0.0f, TRUE);
+            player.Play(1u, 1.0f, TRUE);
+            player.Update(0.5f);
+            player.Evaluate(aPoses);
+            Expect(player.GetLayers().size() == 2u && isPose(aPoses, 2.0f), TEST, L"cross-fade halfway");
+
+            player.Update(0.5f);
+            player.Evaluate(aPoses);
+            Expect(player.GetLayers().size() == 1u && player.GetLayers()[0].uClip == 1u && player.GetLayers()[0].Weight == 1.0f && isPose(aPoses, 3.0f), TEST, L"cross-fade completion");
+
+            player.Play(0u, 0.25f, TRUE);
+            player.Update(1.0f);
+            player.Evaluate(aPoses);
+            Expect(player.GetLayers().size() == 1u && player.GetLayers()[0].uClip == 0u && player.GetLayers()[0].Weight == 1.0f && isPose(aPoses, 1.0f), TEST, L"cross-fade completion in one update");
+        }
+    }
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: wmain
+  Summary:  Entry point to the tests. Runs every check and reports
+            the number of failed ones.
+  Returns:  INT
+              Status code, 1 if a check failed.
+-----------------------------------------------------------------F-F*/
+INT wmain()
+{
+    TestDirtyRanges();
+    TestVoxelCollider();
+    TestAnimationPlayer();
+
+    fwprintf(s_uNumFailures > 0u ? stderr : stdout, L"%u checks failed\n", s_uNumFailures);
+    return s_uNumFailures > 0u ? 1 : 0;
+}